@@ -0,0 +1,567 @@
+/**
+ * @file arvore_bench.c
+ * @brief Cargas de trabalho reprodutíveis sobre a árvore em arquivo: vazão, latência e E/S.
+ *
+ * Uso:
+ * @code
+ *   arvore_bench [-n LIVROS] [-s SEMENTE] [-a ARQUIVO] [-i] [-j]
+ * @endcode
+ *
+ * Cria um arquivo de livros novo (por padrão em /tmp; `-a` escolhe o caminho, que não pode
+ * existir) e executa, nesta ordem:
+ *
+ * - insercao_sequencial: LIVROS/10 códigos crescentes num arquivo à parte (a árvore degenera
+ *   numa lista, por isso a carga é menor);
+ * - insercao_aleatoria: LIVROS códigos pares, numa permutação aleatória;
+ * - busca_acerto e busca_falha: LIVROS buscas de códigos pares e ímpares sorteados;
+ * - varredura: REPETICOES_VARREDURA percursos em ordem completos (cada um é uma operação);
+ * - mista: LIVROS operações, 80% buscas, 10% cadastros de códigos novos e 10% remoções;
+ * - remocao: metade dos códigos, na ordem em que foram cadastrados;
+ * - importacao: LIVROS linhas de um arquivo texto importadas num arquivo de livros vazio.
+ *
+ * Para cada carga são relatados as operações por segundo, os percentis 50, 99 e 99,9 da
+ * latência de cada operação (exatos, medidos pelo próprio bench) e os nós lidos e gravados por
+ * operação, contados por estatisticas.h quando o programa é compilado com ESTATISTICAS. Todas
+ * as chaves vêm de um gerador com a semente dada: duas execuções com os mesmos argumentos
+ * fazem exatamente as mesmas operações.
+ *
+ * `-i` associa o filtro (filtro.h) e o índice (indice.h) ao arquivo principal. `-j` troca a
+ * tabela por JSON Lines: uma linha com os parâmetros e uma por carga, para comparar versões.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/estatisticas.h"
+#include "../include/filtro.h"
+#include "../include/importacao.h"
+#include "../include/indice.h"
+#include "../include/livro.h"
+#include "../include/utils.h"
+
+/** Livros das cargas, se `-n` não for dado. */
+#define LIVROS_PADRAO 20000
+
+/** Semente do gerador, se `-s` não for dada. */
+#define SEMENTE_PADRAO 42
+
+/** Percursos completos da carga de varredura. */
+#define REPETICOES_VARREDURA 5
+
+/** Versão do formato da saída JSON; mude-a ao mudar os campos. */
+#define VERSAO_SAIDA 1
+
+/**
+ * Medidas de uma carga em andamento ou concluída.
+ */
+typedef struct {
+        const char* nome;                     /**< Nome da carga. */
+        uint64_t* latencias;                  /**< Duração de cada operação, em ns. */
+        size_t operacoes;                     /**< Operações medidas. */
+        size_t capacidade;                    /**< Espaço em `latencias`. */
+        size_t divergencias;                  /**< Resultados diferentes do esperado. */
+        uint64_t inicio;                      /**< Início da carga, em ns. */
+        uint64_t duracao;                     /**< Duração total, em ns. */
+        uint64_t eventos[QUANTIDADE_EVENTOS]; /**< Eventos de todas as operações. */
+} CARGA;
+
+/** Carga medida pelo cadastro da importação, que só recebe o arquivo e o livro. */
+static CARGA* carga_importacao = NULL;
+
+/**
+ * @brief Próximo número do gerador (splitmix64), a partir do estado dado.
+ */
+static uint64_t sortear(uint64_t* estado) {
+        *estado += 0x9E3779B97F4A7C15u;
+        return espalhar_codigo((size_t)*estado);
+}
+
+/**
+ * @brief Prepara a carga para `capacidade` operações e zera os contadores globais.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+static int iniciar_carga(CARGA* carga, const char* nome, size_t capacidade) {
+        memset(carga, 0, sizeof(*carga));
+        carga->nome = nome;
+        carga->capacidade = capacidade;
+        carga->latencias = malloc((capacidade > 0 ? capacidade : 1) * sizeof(uint64_t));
+        if (carga->latencias == NULL) return ERRO_MEMORIA;
+
+        zerar_estatisticas();
+        carga->inicio = agora_ns();
+        return SUCESSO;
+}
+
+/**
+ * @brief Registra uma operação iniciada em `inicio` e se o resultado foi o esperado.
+ */
+static void registrar_operacao(CARGA* carga, uint64_t inicio, int esperado) {
+        uint64_t fim = agora_ns();
+        if (carga->operacoes < carga->capacidade)
+                carga->latencias[carga->operacoes++] = fim - inicio;
+        if (!esperado) carga->divergencias++;
+}
+
+/**
+ * @brief Fecha a carga, somando os eventos atribuídos a todas as operações.
+ */
+static void concluir_carga(CARGA* carga) {
+        carga->duracao = agora_ns() - carga->inicio;
+
+        ESTATISTICAS_OPERACAO estatisticas[QUANTIDADE_OPERACOES];
+        ler_estatisticas(estatisticas);
+        for (int operacao = 0; operacao < QUANTIDADE_OPERACOES; operacao++)
+                for (int evento = 0; evento < QUANTIDADE_EVENTOS; evento++)
+                        carga->eventos[evento] += estatisticas[operacao].eventos[evento];
+}
+
+/**
+ * @brief Ordena crescentemente, para qsort().
+ */
+static int comparar_latencias(const void* a, const void* b) {
+        uint64_t x = *(const uint64_t*)a;
+        uint64_t y = *(const uint64_t*)b;
+        return (x > y) - (x < y);
+}
+
+/**
+ * @brief Latência, em microssegundos, abaixo da qual ficam `fracao` das operações.
+ *
+ * As latências precisam estar ordenadas.
+ */
+static double percentil_us(const CARGA* carga, double fracao) {
+        if (carga->operacoes == 0) return 0;
+
+        size_t indice = (size_t)(fracao * carga->operacoes + 0.999999);
+        if (indice > 0) indice--;
+        if (indice >= carga->operacoes) indice = carga->operacoes - 1;
+        return carga->latencias[indice] / 1e3;
+}
+
+/**
+ * @brief Eventos por operação, ou -1 sem instrumentação.
+ */
+static double por_operacao(const CARGA* carga, EVENTO_ESTATISTICA evento) {
+        if (!estatisticas_ativas()) return -1;
+        return carga->operacoes > 0 ? (double)carga->eventos[evento] / carga->operacoes : 0;
+}
+
+/**
+ * @brief Imprime um valor por operação na tabela, ou `-` sem instrumentação.
+ */
+static void imprimir_por_operacao(double valor) {
+        if (valor < 0)
+                printf(" %9s", "-");
+        else
+                printf(" %9.2f", valor);
+}
+
+/**
+ * @brief Imprime um valor por operação no JSON, ou `null` sem instrumentação.
+ */
+static void imprimir_por_operacao_json(const char* nome, double valor) {
+        if (valor < 0)
+                printf(",\"%s\":null", nome);
+        else
+                printf(",\"%s\":%.3f", nome, valor);
+}
+
+/**
+ * @brief Escreve a linha da carga e libera as latências.
+ */
+static void relatar_carga(CARGA* carga, int json) {
+        qsort(carga->latencias, carga->operacoes, sizeof(uint64_t), comparar_latencias);
+        double segundos = carga->duracao / 1e9;
+        double vazao = segundos > 0 ? carga->operacoes / segundos : 0;
+        double lidos = por_operacao(carga, EVENTO_LEITURA_NO);
+        double gravados = por_operacao(carga, EVENTO_ESCRITA_NO);
+        double seeks = por_operacao(carga, EVENTO_SEEK);
+
+        if (json) {
+                printf("{\"carga\":\"%s\",\"operacoes\":%zu,\"segundos\":%.6f,"
+                       "\"ops_por_segundo\":%.1f,\"latencia_us\":{\"p50\":%.3f,\"p99\":%.3f,"
+                       "\"p999\":%.3f,\"max\":%.3f}",
+                       carga->nome, carga->operacoes, segundos, vazao, percentil_us(carga, 0.50),
+                       percentil_us(carga, 0.99), percentil_us(carga, 0.999),
+                       percentil_us(carga, 1.0));
+                imprimir_por_operacao_json("nos_lidos_por_op", lidos);
+                imprimir_por_operacao_json("nos_gravados_por_op", gravados);
+                imprimir_por_operacao_json("seeks_por_op", seeks);
+                printf(",\"divergencias\":%zu}\n", carga->divergencias);
+        } else {
+                printf("%-20s %10zu %12.0f %9.2f %9.2f %9.2f", carga->nome, carga->operacoes,
+                       vazao, percentil_us(carga, 0.50), percentil_us(carga, 0.99),
+                       percentil_us(carga, 0.999));
+                imprimir_por_operacao(lidos);
+                imprimir_por_operacao(gravados);
+                imprimir_por_operacao(seeks);
+                printf("\n");
+        }
+
+        free(carga->latencias);
+        carga->latencias = NULL;
+}
+
+/**
+ * @brief Cadastra um livro com o código dado e um título derivado dele.
+ */
+static int cadastrar_codigo(FILE* arquivo, size_t codigo) {
+        LIVRO livro = {0};
+        livro.codigo = codigo;
+        snprintf(livro.titulo, sizeof(livro.titulo), "Livro %zu", codigo);
+        snprintf(livro.autor, sizeof(livro.autor), "Autor %zu", codigo % 977);
+        livro.ano = 1900 + codigo % 120;
+        livro.exemplares = codigo % 50;
+        return cadastrar_livro(arquivo, livro);
+}
+
+/**
+ * @brief Busca o código, liberando o resultado.
+ *
+ * @return O status de buscar_no_arvore().
+ */
+static int buscar_codigo(FILE* arquivo, size_t codigo) {
+        RESULTADO_BUSCA resultado;
+        int status = buscar_no_arvore(arquivo, codigo, &resultado);
+        free(resultado.no);
+        free(resultado.pai);
+        return status;
+}
+
+/**
+ * @brief Cadastra os códigos na ordem dada, medindo cada cadastro.
+ */
+static int carga_insercao(FILE* arquivo, const char* nome, const size_t* codigos, size_t n,
+                          int json) {
+        CARGA carga;
+        if (iniciar_carga(&carga, nome, n) != SUCESSO) return ERRO_MEMORIA;
+
+        for (size_t i = 0; i < n; i++) {
+                uint64_t inicio = agora_ns();
+                int status = cadastrar_codigo(arquivo, codigos[i]);
+                registrar_operacao(&carga, inicio, status == SUCESSO);
+        }
+
+        concluir_carga(&carga);
+        relatar_carga(&carga, json);
+        return carga.divergencias == 0 ? SUCESSO : ERRO_CADASTRAR_LIVRO;
+}
+
+/**
+ * @brief Busca `n` códigos sorteados entre 1 e n: pares (cadastrados) ou ímpares (ausentes).
+ */
+static int carga_busca(FILE* arquivo, const char* nome, size_t n, int acerto, uint64_t* estado,
+                       int json) {
+        CARGA carga;
+        if (iniciar_carga(&carga, nome, n) != SUCESSO) return ERRO_MEMORIA;
+
+        for (size_t i = 0; i < n; i++) {
+                size_t codigo = (sortear(estado) % n + 1) * 2 - (acerto ? 0 : 1);
+                uint64_t inicio = agora_ns();
+                int status = buscar_codigo(arquivo, codigo);
+                registrar_operacao(&carga, inicio, status == (acerto ? SUCESSO : ERRO_NO_NULO));
+        }
+
+        concluir_carga(&carga);
+        relatar_carga(&carga, json);
+        return carga.divergencias == 0 ? SUCESSO : ERRO_NO_NULO;
+}
+
+/**
+ * @brief Visitante da varredura: só conta os nós.
+ */
+static int contar_no(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)no;
+        (void)posicao;
+        (*(size_t*)contexto)++;
+        return SUCESSO;
+}
+
+/**
+ * @brief Percorre a árvore inteira REPETICOES_VARREDURA vezes, conferindo a quantidade de nós.
+ */
+static int carga_varredura(FILE* arquivo, size_t esperados, int json) {
+        CARGA carga;
+        if (iniciar_carga(&carga, "varredura", REPETICOES_VARREDURA) != SUCESSO)
+                return ERRO_MEMORIA;
+
+        for (int i = 0; i < REPETICOES_VARREDURA; i++) {
+                size_t visitados = 0;
+                uint64_t inicio = agora_ns();
+                int status = percorrer_em_ordem(arquivo, contar_no, &visitados);
+                registrar_operacao(&carga, inicio, status == SUCESSO && visitados == esperados);
+        }
+
+        concluir_carga(&carga);
+        relatar_carga(&carga, json);
+        return carga.divergencias == 0 ? SUCESSO : ERRO_NO_NULO;
+}
+
+/**
+ * @brief `n` operações sorteadas: 80% buscas, 10% cadastros de códigos novos e 10% remoções.
+ *
+ * Buscas e remoções podem não achar o código (removido antes); só erros de E/S divergem.
+ */
+static int carga_mista(FILE* arquivo, size_t n, uint64_t* estado, int json) {
+        CARGA carga;
+        if (iniciar_carga(&carga, "mista", n) != SUCESSO) return ERRO_MEMORIA;
+
+        size_t proximo_novo = 2 * n + 2;
+        for (size_t i = 0; i < n; i++) {
+                uint64_t sorteio = sortear(estado);
+                size_t codigo = (sorteio / 100 % n + 1) * 2;
+                uint64_t inicio = agora_ns();
+                int status;
+                if (sorteio % 100 < 80) {
+                        status = buscar_codigo(arquivo, codigo);
+                } else if (sorteio % 100 < 90) {
+                        status = cadastrar_codigo(arquivo, proximo_novo);
+                        proximo_novo += 2;
+                } else {
+                        status = remover_no_arvore(arquivo, codigo);
+                }
+                registrar_operacao(&carga, inicio, status == SUCESSO || status == ERRO_NO_NULO);
+        }
+
+        concluir_carga(&carga);
+        relatar_carga(&carga, json);
+        return carga.divergencias == 0 ? SUCESSO : ERRO_NO_NULO;
+}
+
+/**
+ * @brief Remove os `n` primeiros códigos, na ordem dada; códigos já removidos pela carga mista
+ * não divergem.
+ */
+static int carga_remocao(FILE* arquivo, const size_t* codigos, size_t n, int json) {
+        CARGA carga;
+        if (iniciar_carga(&carga, "remocao", n) != SUCESSO) return ERRO_MEMORIA;
+
+        for (size_t i = 0; i < n; i++) {
+                uint64_t inicio = agora_ns();
+                int status = remover_no_arvore(arquivo, codigos[i]);
+                registrar_operacao(&carga, inicio, status == SUCESSO || status == ERRO_NO_NULO);
+        }
+
+        concluir_carga(&carga);
+        relatar_carga(&carga, json);
+        return carga.divergencias == 0 ? SUCESSO : ERRO_NO_NULO;
+}
+
+/**
+ * @brief Cadastro usado pela importação: mede cada chamada na carga corrente.
+ */
+static int cadastrar_medindo(FILE* arquivo, LIVRO livro) {
+        uint64_t inicio = agora_ns();
+        int status = cadastrar_livro(arquivo, livro);
+        registrar_operacao(carga_importacao, inicio, status == SUCESSO);
+        return status;
+}
+
+/**
+ * @brief Grava um arquivo texto com os códigos dados e o importa num arquivo de livros vazio.
+ */
+static int carga_importacao_texto(const char* caminho, const size_t* codigos, size_t n, int json) {
+        char caminho_texto[128];
+        snprintf(caminho_texto, sizeof(caminho_texto), "%s.txt", caminho);
+        FILE* texto = fopen(caminho_texto, "w");
+        if (texto == NULL) return ERRO_ARQUIVO_TEXTO;
+        for (size_t i = 0; i < n; i++)
+                fprintf(texto, "%zu;Livro %zu;Autor %zu;Editora %zu;%zu;%zu;%zu;%zu,%02zu\n",
+                        codigos[i], codigos[i], codigos[i] % 977, codigos[i] % 31,
+                        codigos[i] % 9 + 1, 1900 + codigos[i] % 120, codigos[i] % 50,
+                        codigos[i] % 300, codigos[i] % 100);
+        if (fclose(texto) != 0) {
+                remove(caminho_texto);
+                return ERRO_ARQUIVO_WRITE;
+        }
+
+        remove(caminho);
+        abrir_ou_criar_arquivo(caminho);
+        FILE* arquivo = fopen(caminho, "rb+");
+        if (arquivo == NULL) {
+                remove(caminho_texto);
+                return ERRO_ARQUIVO_NULO;
+        }
+
+        CARGA carga;
+        int status = iniciar_carga(&carga, "importacao", n);
+        if (status == SUCESSO) {
+                carga_importacao = &carga;
+                RELATORIO_IMPORTACAO relatorio;
+                status = importar_texto(caminho_texto, arquivo, cadastrar_medindo, NULL,
+                                        &relatorio);
+                carga_importacao = NULL;
+                if (status == SUCESSO && relatorio.cadastrados != n) carga.divergencias++;
+                concluir_carga(&carga);
+                relatar_carga(&carga, json);
+                if (status == SUCESSO && carga.divergencias > 0) status = ERRO_CADASTRAR_LIVRO;
+        }
+
+        fclose(arquivo);
+        remove(caminho);
+        remove(caminho_texto);
+        return status;
+}
+
+/**
+ * @brief Cria um arquivo de livros vazio e o abre.
+ *
+ * @return Handle do arquivo, ou NULL.
+ */
+static FILE* criar_arquivo(const char* caminho) {
+        abrir_ou_criar_arquivo(caminho);
+        return fopen(caminho, "rb+");
+}
+
+/**
+ * @brief Apaga o arquivo de livros e os auxiliares que `-i` cria ao lado dele.
+ */
+static void apagar_arquivos(const char* caminho) {
+        char auxiliar[160];
+        remove(caminho);
+        snprintf(auxiliar, sizeof(auxiliar), "%s%s", caminho, SUFIXO_FILTRO);
+        remove(auxiliar);
+        snprintf(auxiliar, sizeof(auxiliar), "%s%s", caminho, SUFIXO_INDICE);
+        remove(auxiliar);
+}
+
+/**
+ * @brief Executa todas as cargas sobre `caminho`, na ordem do cabeçalho do arquivo.
+ *
+ * @return SUCESSO ou o primeiro erro.
+ */
+static int executar_cargas(const char* caminho, size_t n, uint64_t semente, int auxiliares,
+                           int json) {
+        size_t* codigos = malloc(n * sizeof(size_t));
+        if (codigos == NULL) return ERRO_MEMORIA;
+
+        // Sequencial, num arquivo à parte: cada cadastro desce a lista inteira.
+        char caminho_sequencial[128];
+        snprintf(caminho_sequencial, sizeof(caminho_sequencial), "%s.seq", caminho);
+        size_t sequenciais = n / 10 > 0 ? n / 10 : 1;
+        for (size_t i = 0; i < sequenciais; i++) codigos[i] = i + 1;
+        FILE* arquivo = criar_arquivo(caminho_sequencial);
+        int status = arquivo != NULL ? SUCESSO : ERRO_ARQUIVO_NULO;
+        if (status == SUCESSO) {
+                status = carga_insercao(arquivo, "insercao_sequencial", codigos, sequenciais,
+                                        json);
+                fclose(arquivo);
+        }
+        remove(caminho_sequencial);
+
+        // Permutação aleatória dos códigos pares 2..2n.
+        uint64_t estado = semente;
+        for (size_t i = 0; i < n; i++) codigos[i] = 2 * (i + 1);
+        for (size_t i = n; i > 1; i--) {
+                size_t j = sortear(&estado) % i;
+                size_t troca = codigos[i - 1];
+                codigos[i - 1] = codigos[j];
+                codigos[j] = troca;
+        }
+
+        arquivo = status == SUCESSO ? criar_arquivo(caminho) : NULL;
+        if (status == SUCESSO && arquivo == NULL) status = ERRO_ARQUIVO_NULO;
+        if (status == SUCESSO && auxiliares) {
+                status = abrir_filtro(arquivo, caminho);
+                if (status == SUCESSO) status = abrir_indice(arquivo, caminho);
+        }
+        if (status == SUCESSO)
+                status = carga_insercao(arquivo, "insercao_aleatoria", codigos, n, json);
+        if (status == SUCESSO) status = carga_busca(arquivo, "busca_acerto", n, 1, &estado, json);
+        if (status == SUCESSO) status = carga_busca(arquivo, "busca_falha", n, 0, &estado, json);
+        if (status == SUCESSO) status = carga_varredura(arquivo, n, json);
+        if (status == SUCESSO) status = carga_mista(arquivo, n, &estado, json);
+        if (status == SUCESSO) status = carga_remocao(arquivo, codigos, n / 2, json);
+        if (arquivo != NULL) {
+                fechar_indice(arquivo);
+                fechar_filtro(arquivo);
+                fclose(arquivo);
+        }
+        apagar_arquivos(caminho);
+
+        if (status == SUCESSO) status = carga_importacao_texto(caminho, codigos, n, json);
+
+        free(codigos);
+        return status;
+}
+
+/**
+ * @brief Imprime a forma de uso na saída de erro.
+ */
+static void imprimir_uso(const char* programa) {
+        fprintf(stderr,
+                "Uso: %s [-n LIVROS] [-s SEMENTE] [-a ARQUIVO] [-i] [-j]\n"
+                "  -n LIVROS   livros de cada carga (padrao %d)\n"
+                "  -s SEMENTE  semente do gerador de chaves (padrao %d)\n"
+                "  -a ARQUIVO  arquivo de livros a criar (nao pode existir)\n"
+                "  -i          associa o filtro e o indice ao arquivo\n"
+                "  -j          saida em JSON Lines\n",
+                programa, LIVROS_PADRAO, SEMENTE_PADRAO);
+}
+
+/**
+ * @brief Ponto de entrada do benchmark.
+ */
+int main(int argc, char* argv[]) {
+        size_t n = LIVROS_PADRAO;
+        uint64_t semente = SEMENTE_PADRAO;
+        const char* caminho = NULL;
+        int auxiliares = 0;
+        int json = 0;
+
+        for (int i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+                        n = strtoull(argv[++i], NULL, 10);
+                } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+                        semente = strtoull(argv[++i], NULL, 10);
+                } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+                        caminho = argv[++i];
+                } else if (strcmp(argv[i], "-i") == 0) {
+                        auxiliares = 1;
+                } else if (strcmp(argv[i], "-j") == 0) {
+                        json = 1;
+                } else {
+                        imprimir_uso(argv[0]);
+                        return 2;
+                }
+        }
+        if (n == 0) {
+                imprimir_uso(argv[0]);
+                return 2;
+        }
+
+        char temporario[64];
+        if (caminho == NULL) {
+                snprintf(temporario, sizeof(temporario), "/tmp/arvore_bench_%d.bin", getpid());
+                caminho = temporario;
+        } else if (access(caminho, F_OK) == 0) {
+                // O bench apaga o arquivo ao terminar: nunca use um catálogo existente.
+                fprintf(stderr, "%s ja existe\n", caminho);
+                return 1;
+        }
+
+        if (json) {
+                printf("{\"bench\":\"arvore\",\"versao\":%d,\"livros\":%zu,\"semente\":%llu,"
+                       "\"auxiliares\":%s,\"estatisticas\":%s}\n",
+                       VERSAO_SAIDA, n, (unsigned long long)semente,
+                       auxiliares ? "true" : "false", estatisticas_ativas() ? "true" : "false");
+        } else {
+                printf("livros: %zu, semente: %llu, auxiliares: %s%s\n", n,
+                       (unsigned long long)semente, auxiliares ? "filtro e indice" : "nenhum",
+                       estatisticas_ativas() ? "" : " (sem ESTATISTICAS: E/S nao contada)");
+                printf("%-20s %10s %12s %9s %9s %9s %9s %9s %9s\n", "carga", "operacoes", "ops/s",
+                       "p50_us", "p99_us", "p999_us", "lidos/op", "grav/op", "seeks/op");
+        }
+        fflush(stdout);
+
+        int status = executar_cargas(caminho, n, semente, auxiliares, json);
+        if (status != SUCESSO) fprintf(stderr, "Carga interrompida ou divergente (%d)\n", status);
+        return status == SUCESSO ? 0 : 1;
+}
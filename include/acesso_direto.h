@@ -0,0 +1,157 @@
+/**
+ * @file acesso_direto.h
+ * @brief Modo de E/S direta: as páginas de dados passam por um pool próprio, sem o cache do
+ * sistema.
+ *
+ * Em catálogos grandes, a mesma página fica em dois lugares: no cache de páginas do núcleo e
+ * nas cópias que cada leitura faz; e, sob pressão de memória de outros processos, o núcleo
+ * descarta justamente o topo da árvore, que toda busca toca. Com o acesso direto associado a
+ * um handle por abrir_acesso_direto(), ler_nos_arquivo() e escrever_nos() (arquivo.h) leem e
+ * gravam páginas inteiras por um descritor aberto com `O_DIRECT`, num pool de quadros
+ * alinhados a TAMANHO_PAGINA, com a política de substituição daqui:
+ *
+ * - o pool é um relógio (CLOCK): um acerto marca o quadro e a falta expulsa o primeiro quadro
+ *   não marcado e não fixado;
+ * - fixar_niveis_superiores() fixa as páginas dos primeiros nós da árvore em largura (até
+ *   NIVEIS_FIXOS níveis, sem passar de um quarto do pool), que nunca são expulsas;
+ * - entre iniciar_varredura() e terminar_varredura(), e nas leituras de mais de uma página, as
+ *   faltas vão para um anel de PAGINAS_ANEL_VARREDURA quadros, à parte, e os acertos no pool
+ *   não o marcam: um percurso completo da árvore não expulsa o conjunto quente.
+ *
+ * As gravações vão direto ao disco (write-through) e atualizam as cópias no pool; a página 0,
+ * com o cabeçalho, continua passando pelo `FILE*`. Handles do mesmo arquivo no mesmo processo
+ * compartilham um pool, então o escritor e os leitores do servidor continuam coerentes. Cada
+ * trava de escrita solta soma um ao contador de alterações da página 0 (contar_alteracao(),
+ * arquivo.h); se outro processo mudar o arquivo, travar_arquivo() (concorrencia.h) percebe pelo
+ * contador e esvazia o pool. Em sistemas de arquivos sem `O_DIRECT` (tmpfs,
+ * por exemplo), o descritor é aberto sem ele e o pool funciona igual, sobre o cache do sistema.
+ */
+
+#ifndef ACESSO_DIRETO_H
+#define ACESSO_DIRETO_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/** Quadros do pool com `--direto` (16 MiB). */
+#define PAGINAS_ACESSO_DIRETO 4096
+
+/** Quadros do anel das varreduras. */
+#define PAGINAS_ANEL_VARREDURA 16
+
+/** Níveis da árvore fixados por fixar_niveis_superiores(). */
+#define NIVEIS_FIXOS 10
+
+/**
+ * Situação do pool associado a um handle.
+ */
+typedef struct {
+        size_t paginas;          /**< Quadros do pool, sem o anel. */
+        size_t ocupadas;         /**< Quadros do pool com uma página. */
+        size_t fixadas;          /**< Quadros fixados. */
+        size_t handles;          /**< Handles que compartilham o pool. */
+        size_t acertos;          /**< Leituras atendidas pelo pool ou pelo anel. */
+        size_t faltas;           /**< Leituras que foram ao disco fora das varreduras. */
+        size_t faltas_varredura; /**< Leituras que foram ao disco para o anel. */
+        size_t expulsoes;        /**< Páginas expulsas do pool. */
+        size_t invalidacoes;     /**< Vezes em que o pool foi esvaziado por mudança externa. */
+        int direto;              /**< 1 se o descritor foi aberto com `O_DIRECT`. */
+} ESTADO_ACESSO_DIRETO;
+
+/**
+ * @brief Associa ao handle o pool do arquivo, criando-o se for o primeiro handle, e fixa os
+ * níveis superiores da árvore.
+ *
+ * @param arquivo Arquivo binário da árvore, já travado pelo chamador.
+ * @param caminho Caminho do mesmo arquivo, aberto de novo com `O_DIRECT`.
+ * @param paginas Quadros do pool (ignorado se o pool já existir); ao menos
+ *        PAGINAS_ANEL_VARREDURA.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO (caminho de outro arquivo ou impossível de abrir),
+ *         ERRO_MEMORIA, ou erros da leitura dos níveis fixados.
+ */
+int abrir_acesso_direto(FILE* arquivo, const char* caminho, size_t paginas);
+
+/**
+ * @brief Desfaz a associação; o último handle do arquivo libera o pool.
+ *
+ * Não faz nada se o handle não tiver pool. Como as gravações já foram ao disco, nada se perde.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_NULO sem pool.
+ */
+int fechar_acesso_direto(FILE* arquivo);
+
+/**
+ * @brief Lê os primeiros `bytes` da página de dados `pagina` pelo pool.
+ *
+ * Depois do fim do arquivo, a página é lida como zeros.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO se o handle não tiver pool (o chamador lê pelo `FILE*`) ou
+ *         ERRO_ARQUIVO_READ.
+ */
+int ler_pagina_direta(FILE* arquivo, size_t pagina, void* destino, size_t bytes);
+
+/**
+ * @brief Grava a página de dados `pagina` inteira (TAMANHO_PAGINA bytes) no disco e no pool.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO se o handle não tiver pool ou ERRO_ARQUIVO_WRITE.
+ */
+int gravar_pagina_direta(FILE* arquivo, size_t pagina, const void* conteudo);
+
+/**
+ * @brief Passa as faltas do handle para o anel das varreduras, até terminar_varredura().
+ *
+ * As chamadas podem ser aninhadas. Não faz nada se o handle não tiver pool.
+ */
+void iniciar_varredura(FILE* arquivo);
+
+/**
+ * @brief Encerra o iniciar_varredura() correspondente.
+ */
+void terminar_varredura(FILE* arquivo);
+
+/**
+ * @brief Refaz a fixação: solta as páginas fixadas e fixa as dos primeiros nós da árvore, em
+ * largura, a partir da raiz atual.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO sem pool, ERRO_CABECALHO_NULO, ERRO_MEMORIA ou
+ *         ERRO_NO_NULO.
+ */
+int fixar_niveis_superiores(FILE* arquivo);
+
+/**
+ * @brief Esvazia o pool se o contador de alterações do arquivo (arquivo.h) mudou desde a
+ * última gravação registrada, isto é, se outro processo gravou nele.
+ *
+ * Chamada por travar_arquivo() depois de obter a trava.
+ */
+void conferir_acesso_direto(FILE* arquivo);
+
+/**
+ * @brief Registra o contador de alterações depois de uma gravação deste processo, e refaz a
+ * fixação se a raiz mudou.
+ *
+ * Chamada por destravar_arquivo() ao soltar a trava de escrita, depois de descarregar o
+ * `FILE*` e de contar a alteração.
+ */
+void registrar_acesso_direto(FILE* arquivo);
+
+/**
+ * @brief Lê a situação do pool associado ao handle.
+ *
+ * @return SUCESSO, ou ERRO_ARQUIVO_NULO se o handle não tiver pool.
+ */
+int consultar_acesso_direto(FILE* arquivo, ESTADO_ACESSO_DIRETO* estado);
+
+/**
+ * @brief Liga o acesso direto nos modos que o aceitam (lote.h e servidor.h).
+ *
+ * @param paginas Quadros do pool, ou 0 para desligar.
+ */
+void definir_acesso_direto(size_t paginas);
+
+/**
+ * @brief Quadros do pool definidos por definir_acesso_direto(), ou 0 se desligado.
+ */
+size_t paginas_acesso_direto(void);
+
+#endif  // ACESSO_DIRETO_H
@@ -1,11 +1,24 @@
 /**
  * @file arquivo.h
  * @brief Estruturas e funções para manipular o arquivo binário que armazenará a árvore binária.
+ *
+ * O arquivo é dividido em páginas de TAMANHO_PAGINA bytes, alinhadas ao início do arquivo:
+ *
+ * - a página 0 guarda o CABECALHO e o FORMATO_ARQUIVO no início e, no fim, a lista de nós
+ *   aposentados do modo copy-on-write (versoes.h) e o contador de alterações
+ *   (ler_alteracoes()); o resto dela fica zerado;
+ * - cada página seguinte guarda METADADOS_PAGINA e NOS_POR_PAGINA nós; a posição `p` fica na
+ *   página `1 + p / NOS_POR_PAGINA`, vaga `p % NOS_POR_PAGINA`.
+ *
+ * Nenhum nó atravessa a divisa entre duas páginas, então ler ou gravar um nó toca uma página
+ * só. Os metadados de cada página trazem a soma de verificação de cada vaga, conferida a cada
+ * leitura; as posições continuam sendo índices de nós, e nada muda para quem usa a árvore.
  */
 
 #ifndef ARQUIVO_H
 #define ARQUIVO_H
 
+#include <stdint.h>
 #include <stdio.h>
 
 #include "arvore.h"
@@ -39,11 +52,62 @@ typedef struct {
         size_t quantidade_livros;
 } CABECALHO;
 
+/** Tamanho de cada página do arquivo, em bytes. */
+#define TAMANHO_PAGINA 4096
+
+/** Nós por página de dados; o que sobra da página (ao menos 64 bytes) vai para os metadados. */
+#define NOS_POR_PAGINA ((TAMANHO_PAGINA - 64) / sizeof(NO_ARVORE))
+
+/** Identifica o arquivo de livros ("ARVL" em little-endian). */
+#define MAGICA_ARQUIVO 0x4C565241u
+
+/** Versão do formato do arquivo de livros (a 1 era a sem páginas). */
+#define VERSAO_ARQUIVO 2u
+
+/** Identifica uma página de dados ("PAGN" em little-endian). */
+#define MAGICA_PAGINA 0x4E474150u
+
+/**
+ * Descrição do formato, gravada logo depois do CABECALHO. Arquivos sem ela, ou com outra
+ * geometria de página, são recusados por le_cabecalho().
+ */
+typedef struct {
+        uint32_t magica;         /**< MAGICA_ARQUIVO. */
+        uint32_t versao;         /**< VERSAO_ARQUIVO. */
+        uint32_t tamanho_pagina; /**< TAMANHO_PAGINA. */
+        uint32_t nos_por_pagina; /**< NOS_POR_PAGINA. */
+} FORMATO_ARQUIVO;
+
+/** Bytes do início de cada página de dados que não cabem num nó inteiro. */
+#define BYTES_METADADOS_PAGINA (TAMANHO_PAGINA - NOS_POR_PAGINA * sizeof(NO_ARVORE))
+
+/**
+ * Início de cada página de dados, seguido dos NOS_POR_PAGINA nós dela.
+ */
+typedef struct {
+        uint32_t magica;                /**< MAGICA_PAGINA. */
+        uint32_t numero;                /**< Índice da página de dados (0 para a página 1). */
+        uint32_t somas[NOS_POR_PAGINA]; /**< Soma de verificação do nó de cada vaga. */
+        /** Zerado. */
+        unsigned char reservado[BYTES_METADADOS_PAGINA - (2 + NOS_POR_PAGINA) * sizeof(uint32_t)];
+} METADADOS_PAGINA;
+
+_Static_assert(sizeof(METADADOS_PAGINA) + NOS_POR_PAGINA * sizeof(NO_ARVORE) == TAMANHO_PAGINA,
+               "a página de dados deve ocupar exatamente TAMANHO_PAGINA bytes");
+_Static_assert(sizeof(METADADOS_PAGINA) % 8 == 0, "os nós devem ficar alinhados a 8 bytes");
+
+/** Deslocamento do contador de alterações, nos últimos 8 bytes da página 0. */
+#define DESLOCAMENTO_ALTERACOES (TAMANHO_PAGINA - sizeof(uint64_t))
+
+/** Deslocamento da lista de aposentados (versoes.h), nos 8 bytes antes do contador. */
+#define DESLOCAMENTO_APOSENTADOS (DESLOCAMENTO_ALTERACOES - 2 * sizeof(int32_t))
+
 /**
  * @brief Lê cabeçalho inserido em arquivo binário.
  *
  * @param[in] arquivo Ponteiro para o arquivo aberto para leitura.
- * @return Ponteiro para CABECALHO lido do arquivo ou NULL em caso de erro.
+ * @return Ponteiro para CABECALHO lido do arquivo, ou NULL em caso de erro ou se o arquivo não
+ *         estiver no formato atual (FORMATO_ARQUIVO).
  *
  * @pre `arquivo` deve ser diferente de NULL.
  * @pre O ponteiro do arquivo deve estar posicionado corretamente ou a função irá reposicionar.
@@ -56,7 +120,8 @@ CABECALHO* le_cabecalho(FILE* arquivo);
 /**
  * @brief Escreve o cabeçalho em um arquivo binário.
  *
- * Esta função posiciona o ponteiro do arquivo no início e escreve a estrutura CABECALHO.
+ * Esta função posiciona o ponteiro do arquivo no início e escreve a estrutura CABECALHO,
+ * seguida do FORMATO_ARQUIVO atual.
  *
  * @param[in,out] arquivo Ponteiro para arquivo aberto em modo de escrita binária.
  * @param[in] cabecalho Ponteiro para estrutura CABECALHO a ser escrita.
@@ -95,6 +160,127 @@ int escreve_cabecalho(FILE* arquivo, const CABECALHO* cabecalho);
  */
 int escrever_no(FILE* arquivo, const NO_ARVORE* no, const int posicao);
 
+/**
+ * @brief Deslocamento, em bytes, do nó da posição `posicao` no arquivo.
+ *
+ * @return O deslocamento, ou -1 (recusado por fseek()) se `posicao` for negativa.
+ */
+long deslocamento_no(int posicao);
+
+/**
+ * @brief Deslocamento, em bytes, do início da página de dados `pagina`.
+ */
+long inicio_pagina(size_t pagina);
+
+/**
+ * @brief Copia o nó da posição `posicao` de uma página de dados lida inteira por quem não usa
+ * ler_nos_arquivo(), conferindo a identificação da página e a soma da vaga.
+ *
+ * @param[in] pagina Os TAMANHO_PAGINA bytes lidos a partir de
+ *            inicio_pagina(posicao / NOS_POR_PAGINA).
+ * @param[in] posicao Posição do nó.
+ * @param[out] no Nó copiado.
+ * @return SUCESSO, ERRO_NO_NULO (posição negativa) ou ERRO_SOMA_PAGINA.
+ */
+int extrair_no_pagina(const void* pagina, int posicao, NO_ARVORE* no);
+
+/**
+ * @brief Lê `quantidade` nós de posições consecutivas, a partir de `primeira`.
+ *
+ * Faz uma leitura por página tocada, do início dela até o último nó pedido (pelo pool do acesso
+ * direto, se o handle tiver um), e confere a soma de verificação de cada nó. Feita para as
+ * passadas sequenciais sobre o arquivo todo.
+ *
+ * @param[in] arquivo Ponteiro para arquivo aberto para leitura.
+ * @param[in] primeira Posição do primeiro nó.
+ * @param[in] quantidade Nós a ler.
+ * @param[out] nos Vetor com espaço para `quantidade` nós.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_NO_NULO, ERRO_ARQUIVO_SEEK, ERRO_ARQUIVO_READ ou
+ *         ERRO_SOMA_PAGINA.
+ */
+int ler_nos_arquivo(FILE* arquivo, int primeira, size_t quantidade, NO_ARVORE* nos);
+
+/**
+ * @brief Lê só os filhos das `posicoes` primeiras posições, em blocos, do início ao fim do
+ * arquivo.
+ *
+ * É a primeira passada do diagnóstico (diagnostico.h) e do rebalanceamento
+ * (rebalanceamento.h), que depois percorrem a árvore sem reler os nós.
+ *
+ * @param[in] arquivo Ponteiro para arquivo aberto para leitura.
+ * @param[in] posicoes Posições a ler (em geral o `topo` do cabeçalho).
+ * @param[out] esquerdo Vetor com espaço para `posicoes` filhos esquerdos.
+ * @param[out] direito Vetor com espaço para `posicoes` filhos direitos.
+ * @return SUCESSO, ERRO_MEMORIA ou erros de ler_nos_arquivo().
+ */
+int ler_filhos_arquivo(FILE* arquivo, size_t posicoes, int* esquerdo, int* direito);
+
+/**
+ * @brief Grava `quantidade` nós em posições consecutivas, a partir de `primeira`.
+ *
+ * Por página tocada, grava as somas de verificação dos nós (e a identificação da página, se a
+ * primeira vaga estiver entre as gravadas) e depois os nós, com uma escrita cada; com o acesso
+ * direto, grava a página inteira de uma vez.
+ *
+ * @param[in,out] arquivo Ponteiro para arquivo aberto em modo escrita.
+ * @param[in] nos Nós a gravar.
+ * @param[in] primeira Posição do primeiro nó.
+ * @param[in] quantidade Nós a gravar.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_NO_NULO, ERRO_ARQUIVO_SEEK ou ERRO_ARQUIVO_WRITE.
+ */
+int escrever_nos(FILE* arquivo, const NO_ARVORE* nos, int primeira, size_t quantidade);
+
+/**
+ * @brief Grava um nó em uma posição livre, sem gravar o cabeçalho.
+ *
+ * Usa a primeira posição da lista livre ou, se ela estiver vazia, o topo do arquivo, e atualiza
+ * apenas a cópia do cabeçalho em memória. Permite que várias alocações sejam publicadas com
+ * uma única escrita do cabeçalho (ver escreve_cabecalho()).
+ *
+ * @param[in,out] arquivo Ponteiro para arquivo aberto para leitura e escrita.
+ * @param[in,out] cabecalho Cópia em memória do cabeçalho, atualizada pela função.
+ * @param[in] no Nó a ser gravado.
+ * @param[out] posicao Posição em que o nó foi gravado.
+ * @return Código de retorno: SUCESSO (0) ou erro específico.
+ *
+ * @note `quantidade_livros` não é alterada; cabe ao chamador ajustá-la.
+ */
+int alocar_no_arquivo(FILE* arquivo, CABECALHO* cabecalho, const NO_ARVORE* no, int* posicao);
+
+/**
+ * @brief Como alocar_no_arquivo(), mas prefere uma posição perto de `dica`.
+ *
+ * Só faz diferença com um mapa do espaço livre associado ao handle (espaco_livre.h): a posição
+ * livre mais próxima da dica, no raio RAIO_LOCALIDADE, é tirada do meio da lista livre, ou o
+ * topo é usado se estiver nesse raio. Sem mapa, ou sem posição perto, é alocar_no_arquivo().
+ *
+ * @param[in,out] arquivo Ponteiro para arquivo aberto para leitura e escrita.
+ * @param[in,out] cabecalho Cópia em memória do cabeçalho, atualizada pela função.
+ * @param[in] no Nó a ser gravado.
+ * @param[in] dica Posição perto da qual alocar (em geral, a do pai), ou POSICAO_INVALIDA.
+ * @param[out] posicao Posição em que o nó foi gravado.
+ * @return Código de retorno: SUCESSO (0) ou erro específico.
+ *
+ * @note `quantidade_livros` não é alterada; cabe ao chamador ajustá-la.
+ */
+int alocar_no_arquivo_perto(FILE* arquivo, CABECALHO* cabecalho, const NO_ARVORE* no, int dica,
+                            int* posicao);
+
+/**
+ * @brief Devolve uma posição à lista livre, sem gravar o cabeçalho.
+ *
+ * Zera o livro armazenado na posição, encadeia-a no início da lista livre e atualiza apenas a
+ * cópia do cabeçalho em memória.
+ *
+ * @param[in,out] arquivo Ponteiro para arquivo aberto para leitura e escrita.
+ * @param[in,out] cabecalho Cópia em memória do cabeçalho, atualizada pela função.
+ * @param[in] posicao Posição a liberar.
+ * @return Código de retorno: SUCESSO (0) ou erro específico.
+ *
+ * @note `quantidade_livros` não é alterada; cabe ao chamador ajustá-la.
+ */
+int liberar_no_arquivo(FILE* arquivo, CABECALHO* cabecalho, const int posicao);
+
 /**
  * @brief Insere um nó na árvore no arquivo, utilizando lista livre se disponível.
  *
@@ -114,6 +300,19 @@ int escrever_no(FILE* arquivo, const NO_ARVORE* no, const int posicao);
  */
 int inserir_no_arquivo(FILE* arquivo, const NO_ARVORE* no_arvore, int* posicao_inserida);
 
+/**
+ * @brief Como inserir_no_arquivo(), preferindo uma posição perto de `dica` (ver
+ * alocar_no_arquivo_perto()).
+ *
+ * @param[in,out] arquivo Ponteiro para arquivo aberto para leitura e escrita.
+ * @param[in] no_arvore Ponteiro para o nó a ser inserido.
+ * @param[in] dica Posição perto da qual alocar, ou POSICAO_INVALIDA.
+ * @param[out] posicao_inserida Posição em que o nó foi inserido.
+ * @return Código de retorno: SUCESSO (0) ou erro específico.
+ */
+int inserir_no_arquivo_perto(FILE* arquivo, const NO_ARVORE* no_arvore, int dica,
+                             int* posicao_inserida);
+
 /**
  * @brief Remove um nó da árvore no arquivo e o adiciona à lista livre.
  *
@@ -177,8 +376,8 @@ void abrir_ou_criar_arquivo(const char* caminho);
  * @brief Inicializa o cabeçalho do arquivo binário se ele estiver vazio ou menor que o tamanho do
  * cabeçalho.
  *
- * Esta função verifica o tamanho do arquivo e, caso ele seja menor que o tamanho da estrutura
- * CABECALHO, inicializa o arquivo escrevendo uma estrutura CABECALHO zerada com valores padrão.
+ * Esta função verifica o tamanho do arquivo e, caso ele seja menor que o CABECALHO seguido do
+ * FORMATO_ARQUIVO, inicializa o arquivo escrevendo a página 0 com um CABECALHO de árvore vazia.
  *
  * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura/escrita ("rb+" ou "wb+").
  * @return int Código de status da operação:
@@ -191,4 +390,72 @@ void abrir_ou_criar_arquivo(const char* caminho);
  */
 int inicializar_arquivo_cabecalho(FILE* arquivo);
 
+/**
+ * @brief Diz se o arquivo está no formato da versão 1, anterior às páginas.
+ *
+ * Nesse formato o CABECALHO é seguido direto dos nós, sem FORMATO_ARQUIVO nem somas de
+ * verificação; le_cabecalho() recusa esses arquivos, e migrar_arquivo() (rebalanceamento.h) os
+ * converte.
+ *
+ * @param[in] arquivo Arquivo binário da árvore.
+ * @param[out] cabecalho Recebe o cabeçalho lido, se for da versão 1 (pode ser NULL).
+ * @return 1 se o arquivo parece da versão 1, 0 caso contrário (inclusive no formato atual).
+ */
+int arquivo_formato_v1(FILE* arquivo, CABECALHO* cabecalho);
+
+/**
+ * @brief Lê o contador de alterações da página 0.
+ *
+ * O contador fica fora da região gravada por escreve_cabecalho() e é lido direto do descritor,
+ * sem passar pelo buffer do `FILE*`.
+ *
+ * @param[in] arquivo Arquivo binário da árvore.
+ * @param[out] alteracoes Valor lido; 0 se o arquivo nunca foi alterado sob trava.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO ou ERRO_ARQUIVO_READ.
+ */
+int ler_alteracoes(FILE* arquivo, uint64_t* alteracoes);
+
+/**
+ * @brief Soma um ao contador de alterações da página 0.
+ *
+ * Chamada por destravar_arquivo() (concorrencia.h) ao soltar a trava de escrita, e a cada
+ * publicação do modo copy-on-write (versoes.h), que usa o contador como número de versão: quem
+ * guarda uma cópia do arquivo (o pool do acesso direto, por exemplo) percebe a mudança pelo
+ * contador mesmo quando o tamanho e a data de modificação continuam iguais.
+ *
+ * Num arquivo fora do formato atual, como o da versão 1, não grava nada.
+ *
+ * @param[in,out] arquivo Arquivo binário da árvore, aberto para escrita.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_READ ou ERRO_ARQUIVO_WRITE.
+ */
+int contar_alteracao(FILE* arquivo);
+
+/**
+ * Estado do arquivo de livros guardado pelos arquivos auxiliares (filtro.h, indice.h): se não
+ * conferir com o arquivo atual, o auxiliar foi gravado antes de alguma alteração e é refeito.
+ */
+typedef struct {
+        int64_t raiz;           /**< Raiz da árvore. */
+        int64_t topo;           /**< Topo da árvore. */
+        int64_t livre;          /**< Cabeça da lista livre. */
+        uint64_t quantidade;    /**< Livros da árvore. */
+        uint64_t inode;         /**< Inode do arquivo. */
+        uint64_t tamanho;       /**< Tamanho do arquivo em bytes. */
+        int64_t modificacao_s;  /**< Data de modificação (segundos). */
+        int64_t modificacao_ns; /**< Data de modificação (nanossegundos). */
+} IDENTIDADE_ARQUIVO;
+
+/**
+ * @brief Lê o cabeçalho da árvore e os metadados do arquivo de livros.
+ *
+ * As escritas pendentes no handle são enviadas antes, para que a data de modificação seja a
+ * da última escrita feita por ele.
+ *
+ * @param[in] arquivo Arquivo binário da árvore.
+ * @param[out] identidade Estado lido (sem bytes de preenchimento: pode ser comparado com
+ *             memcmp()).
+ * @return SUCESSO, ERRO_ARQUIVO_WRITE, ERRO_CABECALHO_NULO ou ERRO_ARQUIVO_READ.
+ */
+int identificar_arquivo(FILE* arquivo, IDENTIDADE_ARQUIVO* identidade);
+
 #endif  // ARQUIVO_H
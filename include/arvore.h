@@ -57,6 +57,25 @@ typedef struct {
         lado_filho lado; /**< Indica se o nó é filho esquerdo ou direito do pai */
 } RESULTADO_BUSCA;
 
+/**
+ * @brief Função chamada para cada nó visitado em um percurso da árvore.
+ *
+ * @param no Nó visitado (válido apenas durante a chamada).
+ * @param posicao Posição do nó no arquivo.
+ * @param contexto Ponteiro repassado sem alterações pelo percurso.
+ * @return SUCESSO para continuar o percurso ou outro código para interrompê-lo.
+ */
+typedef int (*VISITANTE_NO)(const NO_ARVORE* no, int posicao, void* contexto);
+
+/**
+ * @brief Fornece o próximo livro de uma sequência em ordem crescente de código.
+ *
+ * @param contexto Ponteiro repassado sem alterações pela construção.
+ * @param[out] livro Próximo livro.
+ * @return SUCESSO, ou outro código para interromper a construção.
+ */
+typedef int (*FONTE_LIVROS)(void* contexto, LIVRO* livro);
+
 /**
  * @brief Busca um nó na árvore binária de busca armazenada no arquivo.
  *
@@ -68,6 +87,10 @@ typedef struct {
  * Se o nó não for encontrado, a função retorna as informações do último nó
  * visitado (pai) e o lado onde a inserção deveria ocorrer.
  *
+ * Se o handle tiver um índice associado (indice.h), a posição do nó vem dele e a árvore não é
+ * descida: `pai`, `posicao_pai` e `lado` ficam vazios, tanto para nós encontrados quanto para
+ * ausentes. Um índice com erro é ignorado, e a busca desce a árvore.
+ *
  * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura/escrita ("rb+").
  * @param codigo Código único do livro a ser buscado.
  * @param resultado Ponteiro para estrutura RESULTADO_BUSCA onde os dados do nó
@@ -109,9 +132,36 @@ int buscar_no_arvore(FILE* arquivo, size_t codigo, RESULTADO_BUSCA* resultado);
  *
  * @note Esta função chama internamente `inserir_no_arquivo()` para decidir se
  *       utilizará a lista livre ou adicionar no final do arquivo.
+ *
+ * @note Com a reconstrução parcial ativa (definir_reconstrucao_parcial()), uma inserção mais
+ *       funda que ⌊1,5·log2 n⌋ reconstrói balanceada a subárvore do primeiro ancestral
+ *       desequilibrado (o "bode expiatório"), e pode devolver também ERRO_MEMORIA.
  */
 int inserir_no_arvore(FILE* arquivo, NO_ARVORE* novo);
 
+/**
+ * @brief Ativa ou desativa a reconstrução parcial nas inserções de inserir_no_arvore().
+ *
+ * É a estratégia das árvores bode expiatório: nenhum metadado novo por nó e nenhuma rotação.
+ * Quando a profundidade do nó inserido passa de ⌊1,5·log2 n⌋ (n é a `quantidade_livros` do
+ * cabeçalho), sobe-se pelo caminho até o primeiro ancestral cuja subárvore, com t nós, tenha o
+ * novo nó a mais de ⌊1,5·log2 t⌋ níveis abaixo; essa subárvore é lida em ordem e regravada
+ * perfeitamente balanceada nas mesmas posições, ordenadas, em trechos contíguos. O custo
+ * amortizado de cada inserção é O(log n) leituras; a reconstrução guarda em memória os nós da
+ * subárvore. Não se aplica a inserir_no_arvore_cow() (versoes.h), cujas versões antigas
+ * dependem das posições dos nós.
+ *
+ * @param ativa Diferente de zero para ativar.
+ */
+void definir_reconstrucao_parcial(int ativa);
+
+/**
+ * @brief Informa se a reconstrução parcial está ativa.
+ *
+ * @return 1 se ativa, 0 caso contrário.
+ */
+int reconstrucao_parcial_ativa(void);
+
 /**
  * @brief Imprime todos os livros da árvore binária armazenada no arquivo em ordem crescente.
  *
@@ -129,6 +179,56 @@ int inserir_no_arvore(FILE* arquivo, NO_ARVORE* novo);
  */
 int imprimir_in_ordem(FILE* arquivo);
 
+/**
+ * @brief Percorre a árvore em ordem crescente de código, chamando `visitar` para cada nó.
+ *
+ * O percurso é iterativo (pilha explícita), portanto não estoura a pilha de chamadas em árvores
+ * degeneradas, e lê cada nó do arquivo uma única vez.
+ *
+ * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura.
+ * @param visitar Função chamada para cada nó, em ordem crescente de código.
+ * @param contexto Ponteiro repassado a `visitar`.
+ * @return Código de retorno:
+ *         - SUCESSO se todos os nós foram visitados (ou a árvore está vazia);
+ *         - ERRO_ARQUIVO_NULO se o arquivo for NULL;
+ *         - ERRO_CABECALHO_NULO se o cabeçalho não puder ser lido;
+ *         - ERRO_NO_NULO se algum nó não puder ser lido;
+ *         - ERRO_MEMORIA se a pilha do percurso não puder crescer;
+ *         - o código diferente de SUCESSO devolvido por `visitar`, que interrompe o percurso.
+ */
+int percorrer_em_ordem(FILE* arquivo, VISITANTE_NO visitar, void* contexto);
+
+/**
+ * @brief Percorre em ordem crescente de código a subárvore enraizada em `raiz`.
+ *
+ * Igual a percorrer_em_ordem(), mas parte de uma posição informada em vez da raiz do
+ * cabeçalho (por exemplo, a raiz de uma versão antiga da árvore).
+ *
+ * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura.
+ * @param raiz Posição da raiz da subárvore (POSICAO_INVALIDA para subárvore vazia).
+ * @param visitar Função chamada para cada nó, em ordem crescente de código.
+ * @param contexto Ponteiro repassado a `visitar`.
+ * @return Os mesmos códigos de percorrer_em_ordem(), exceto ERRO_CABECALHO_NULO.
+ */
+int percorrer_subarvore_em_ordem(FILE* arquivo, int raiz, VISITANTE_NO visitar, void* contexto);
+
+/**
+ * @brief Percorre em ordem crescente apenas os nós com código em [`inicio`, `fim`].
+ *
+ * Subárvores que não podem conter códigos do intervalo não são lidas: à esquerda de um nó
+ * menor que `inicio` e à direita do primeiro nó maior que `fim` o percurso não desce.
+ *
+ * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura.
+ * @param raiz Posição da raiz da subárvore (POSICAO_INVALIDA para subárvore vazia).
+ * @param inicio Menor código visitado.
+ * @param fim Maior código visitado.
+ * @param visitar Função chamada para cada nó do intervalo.
+ * @param contexto Ponteiro repassado a `visitar`.
+ * @return Os mesmos códigos de percorrer_subarvore_em_ordem().
+ */
+int percorrer_intervalo_em_ordem(FILE* arquivo, int raiz, size_t inicio, size_t fim,
+                                 VISITANTE_NO visitar, void* contexto);
+
 /**
  * @brief Remove um nó da árvore binária de busca no arquivo.
  *
@@ -165,4 +265,28 @@ int remover_no_arvore(FILE* arquivo, size_t codigo);
  */
 int imprimir_arvore_por_niveis(FILE* arquivo);
 
+/**
+ * @brief Constrói uma árvore balanceada com `quantidade` livros já ordenados, numa única
+ * escrita sequencial.
+ *
+ * O livro `i` da sequência vai para a posição `topo + i`, e os filhos de cada nó são calculados
+ * pelas medianas dos intervalos, sem reler o arquivo. Os nós são gravados no fim do arquivo e
+ * só o cabeçalho, gravado por último, os torna visíveis: se a fonte ou a gravação falhar, a
+ * árvore continua vazia. A lista de livres não é tocada.
+ *
+ * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura/escrita.
+ * @param quantidade Livros da sequência; `fonte` é chamada exatamente esse número de vezes.
+ * @param fonte Fornece os livros em ordem estritamente crescente de código (não verificada).
+ * @param contexto Ponteiro repassado a `fonte`.
+ * @return Código de status da operação:
+ *         - SUCESSO se a árvore foi gravada;
+ *         - ERRO_ARQUIVO_NULO ou ERRO_CABECALHO_NULO;
+ *         - ERRO_ARVORE_NAO_VAZIA se a árvore já tiver uma raiz;
+ *         - ERRO_MEMORIA, ou se as posições não couberem em um int;
+ *         - ERRO_ARQUIVO_SEEK, ERRO_ARQUIVO_WRITE ou erros de escreve_cabecalho();
+ *         - o código diferente de SUCESSO devolvido por `fonte`.
+ */
+int construir_arvore_em_bloco(FILE* arquivo, size_t quantidade, FONTE_LIVROS fonte,
+                              void* contexto);
+
 #endif
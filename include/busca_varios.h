@@ -0,0 +1,98 @@
+/**
+ * @file busca_varios.h
+ * @brief Busca de vários códigos de uma vez, descendo a árvore um nível por vez.
+ *
+ * Feitas uma a uma, N buscas são N cadeias de leituras dependentes: cada nó só é lido depois
+ * do pai. buscar_varios() desce todas juntas. A cada nível, junta as páginas dos nós que as
+ * buscas ainda pendentes precisam, lê cada página distinta uma vez só (as primeiras são as
+ * mesmas para todas) e pede todas as leituras do nível de uma vez:
+ *
+ * - pelo io_uring, com as chamadas de sistema direto, sem a liburing;
+ * - se o núcleo recusar o io_uring, ou com definir_io_uring(0), por THREADS_BUSCA_VARIOS
+ *   threads fazendo pread();
+ * - se o handle tiver o pool do acesso direto (acesso_direto.h), pelo pool, em que as páginas
+ *   dos níveis de cima estão fixadas.
+ *
+ * O anel e as threads são do handle: montados por abrir_busca_varios() e desmontados por
+ * fechar_busca_varios(), servem a todas as chamadas entre as duas. Sem eles (ou enquanto outra
+ * chamada os usa), quem chama lê as páginas do nível com pread(), uma a uma. As páginas de um
+ * nível são lidas em levas de até PAGINAS_LEVA_BUSCA, o que limita a memória de uma chamada.
+ *
+ * Assim o tempo de N buscas fica perto do de uma busca funda. Como buscar_no_arvore() (arvore.h),
+ * usa o filtro (filtro.h) e o índice (indice.h) se estiverem associados ao handle, e confere a
+ * soma de verificação de cada nó lido. O chamador segura a trava do arquivo (concorrencia.h).
+ */
+
+#ifndef BUSCA_VARIOS_H
+#define BUSCA_VARIOS_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "livro.h"
+
+/** Threads que leem as páginas de um nível quando não há io_uring. */
+#define THREADS_BUSCA_VARIOS 8
+
+/** Leituras enviadas ao io_uring de cada vez. */
+#define ENTRADAS_IO_URING 256
+
+/** Páginas de um nível lidas de cada vez (256 KiB de buffer). */
+#define PAGINAS_LEVA_BUSCA 64
+
+/**
+ * Resultado da busca de um código.
+ */
+typedef struct {
+        int status;  /**< SUCESSO, ERRO_NO_NULO se o código não existe, ou erro de leitura. */
+        int posicao; /**< Posição do nó, ou POSICAO_INVALIDA. */
+        LIVRO livro; /**< Livro encontrado (só com status SUCESSO). */
+} RESULTADO_VARIOS;
+
+/**
+ * @brief Busca `quantidade` códigos, com as leituras de cada nível da árvore feitas juntas.
+ *
+ * Códigos repetidos são buscados uma vez por ocorrência, sem ler nada a mais.
+ *
+ * @param arquivo Arquivo binário da árvore, já travado pelo chamador.
+ * @param codigos Códigos buscados.
+ * @param quantidade Códigos em `codigos`.
+ * @param[out] resultados Um resultado por código, na mesma ordem.
+ * @return SUCESSO se todas as buscas terminaram (cada uma com o próprio status), ou
+ *         ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO ou ERRO_MEMORIA.
+ */
+int buscar_varios(FILE* arquivo, const size_t codigos[], size_t quantidade,
+                  RESULTADO_VARIOS resultados[]);
+
+/**
+ * @brief Associa ao handle um anel do io_uring ou, sem ele, THREADS_BUSCA_VARIOS - 1 threads de
+ * leitura, usados por buscar_varios() até fechar_busca_varios().
+ *
+ * Não faz nada se o handle já tiver o anel ou as threads.
+ *
+ * @param arquivo Arquivo binário da árvore.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO ou ERRO_MEMORIA.
+ */
+int abrir_busca_varios(FILE* arquivo);
+
+/**
+ * @brief Desmonta o anel ou as threads do handle, esperando a chamada que os estiver usando.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_NULO se o handle não os tiver.
+ */
+int fechar_busca_varios(FILE* arquivo);
+
+/**
+ * @brief Liga (padrão) ou desliga o uso do io_uring nos próximos abrir_busca_varios();
+ * desligado, as leituras vão pelas threads.
+ */
+void definir_io_uring(int ativo);
+
+/**
+ * @brief Informa se abrir_busca_varios() tenta o io_uring.
+ *
+ * @return 1 se ativo, 0 caso contrário.
+ */
+int io_uring_ativo(void);
+
+#endif  // BUSCA_VARIOS_H
@@ -0,0 +1,177 @@
+/**
+ * @file catalogo_compactado.h
+ * @brief Armazenamento compactado, somente leitura, para catálogos frios.
+ *
+ * Os livros são gravados em ordem de código, agrupados em blocos de LIVROS_POR_BLOCO registros,
+ * e cada bloco é comprimido com o codec de compressao.h. Um diretório de blocos no fim do arquivo
+ * guarda o primeiro código, a posição e o tamanho de cada bloco, de modo que um livro é
+ * endereçado por (bloco, slot). Blocos descomprimidos ficam em um pequeno cache LRU.
+ *
+ * Não é um modo de armazenamento da árvore: os nós continuam endereçados pela posição no
+ * arquivo de livros, e ler_nos_arquivo() não lê este formato. O catálogo é uma exportação
+ * somente leitura, gerada explicitamente (opção 9 do menu), para percorrer dados frios lendo
+ * menos bytes do disco; escritas na árvore não o alteram. Para que uma cópia antiga não seja
+ * lida como se fosse atual, o cabeçalho guarda o dispositivo e o inode do arquivo de origem e
+ * o seu contador de alterações (arquivo.h) no momento da exportação;
+ * catalogo_compactado_atual() compara esses valores com os do arquivo, e a listagem do menu
+ * recusa um catálogo desatualizado em vez de regravá-lo, o que leria a árvore inteira.
+ *
+ * @note O contador só avança em escritas feitas sob travar_arquivo() (concorrencia.h) ou pelo
+ *       modo copy-on-write; restaurar ou rebalancear o arquivo troca o inode.
+ */
+
+#ifndef CATALOGO_COMPACTADO_H
+#define CATALOGO_COMPACTADO_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arvore.h"
+#include "livro.h"
+
+#define MAGICA_COMPACTADO 0x54435A4Cu  //!< "LZCT" em little-endian
+#define VERSAO_COMPACTADO 2u
+#define LIVROS_POR_BLOCO 64  //!< Registros por bloco antes da compressão
+#define BLOCOS_EM_CACHE 8    //!< Blocos descomprimidos mantidos em memória
+
+/**
+ * Cabeçalho gravado no início do arquivo compactado.
+ */
+typedef struct {
+        uint32_t magica;             /**< Deve ser MAGICA_COMPACTADO. */
+        uint32_t versao;             /**< Versão do formato. */
+        uint64_t quantidade_livros;  /**< Total de livros no catálogo. */
+        uint32_t livros_por_bloco;   /**< Registros por bloco (o último pode ter menos). */
+        uint32_t quantidade_blocos;  /**< Entradas no diretório de blocos. */
+        uint64_t posicao_diretorio;  /**< Deslocamento do diretório de blocos no arquivo. */
+        uint64_t origem_dispositivo; /**< `st_dev` do arquivo de livros exportado. */
+        uint64_t origem_inode;       /**< `st_ino` do arquivo de livros exportado. */
+        uint64_t origem_alteracoes;  /**< Contador de alterações dele na exportação. */
+} CABECALHO_COMPACTADO;
+
+/**
+ * Entrada do diretório de blocos.
+ */
+typedef struct {
+        uint64_t primeiro_codigo;    /**< Menor código armazenado no bloco. */
+        uint64_t deslocamento;       /**< Posição do bloco comprimido no arquivo. */
+        uint32_t tamanho_comprimido; /**< Bytes ocupados pelo bloco no arquivo. */
+        uint32_t quantidade;         /**< Livros armazenados no bloco. */
+} ENTRADA_BLOCO;
+
+/**
+ * Endereço de um livro dentro do catálogo compactado.
+ */
+typedef struct {
+        int bloco; /**< Índice do bloco no diretório. */
+        int slot;  /**< Posição do livro dentro do bloco descomprimido. */
+} ENDERECO_COMPACTADO;
+
+/**
+ * Bloco descomprimido mantido em cache.
+ */
+typedef struct {
+        int bloco;         /**< Índice do bloco ou POSICAO_INVALIDA se a entrada está livre. */
+        unsigned long uso; /**< Momento do último acesso, para a política LRU. */
+        LIVRO* livros;     /**< LIVROS_POR_BLOCO registros descomprimidos. */
+} BLOCO_EM_CACHE;
+
+/**
+ * Catálogo compactado aberto para leitura.
+ */
+typedef struct {
+        FILE* arquivo;                         /**< Arquivo compactado (fechado pelo chamador). */
+        CABECALHO_COMPACTADO cabecalho;        /**< Cabeçalho lido na abertura. */
+        ENTRADA_BLOCO* diretorio;              /**< Diretório de blocos, inteiro em memória. */
+        BLOCO_EM_CACHE cache[BLOCOS_EM_CACHE]; /**< Blocos descomprimidos recentes. */
+        unsigned long relogio;                 /**< Contador de acessos do cache. */
+        unsigned char* buffer_comprimido;      /**< Área de leitura dos blocos comprimidos. */
+        size_t capacidade_buffer;              /**< Tamanho de `buffer_comprimido`. */
+        size_t bytes_lidos;                    /**< Bytes lidos do disco desde a abertura. */
+} CATALOGO_COMPACTADO;
+
+/**
+ * @brief Grava todos os livros da árvore em um arquivo compactado.
+ *
+ * Percorre a árvore em ordem de código, agrupa os livros em blocos de LIVROS_POR_BLOCO
+ * registros, comprime cada bloco e grava por último o diretório de blocos e o cabeçalho.
+ *
+ * @param arquivo Arquivo binário da árvore, aberto para leitura; deve estar travado para
+ *                leitura para que o contador gravado corresponda aos livros exportados.
+ * @param destino Arquivo que receberá o catálogo, aberto para escrita binária ("wb" ou "wb+").
+ * @return SUCESSO ou código de erro (ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_WRITE, ERRO_MEMORIA,
+ *         ERRO_COMPRESSAO ou erros do percurso da árvore).
+ */
+int compactar_catalogo(FILE* arquivo, FILE* destino);
+
+/**
+ * @brief Abre um catálogo compactado, lendo seu cabeçalho e diretório de blocos.
+ *
+ * @param arquivo Arquivo compactado aberto para leitura binária. Deve permanecer aberto até
+ *                fechar_catalogo_compactado() e é fechado pelo chamador.
+ * @return Catálogo alocado dinamicamente ou NULL se o arquivo for inválido.
+ */
+CATALOGO_COMPACTADO* abrir_catalogo_compactado(FILE* arquivo);
+
+/**
+ * @brief Libera o catálogo e seu cache. Não fecha o arquivo.
+ *
+ * @param catalogo Catálogo aberto (pode ser NULL).
+ */
+void fechar_catalogo_compactado(CATALOGO_COMPACTADO* catalogo);
+
+/**
+ * @brief Informa se o catálogo ainda corresponde ao arquivo de livros de que foi exportado.
+ *
+ * @param catalogo Catálogo aberto.
+ * @param arquivo Arquivo binário da árvore.
+ * @return 1 se o arquivo é o mesmo e não foi alterado desde a exportação; 0 caso contrário ou
+ *         se algum dos dois não puder ser consultado.
+ */
+int catalogo_compactado_atual(const CATALOGO_COMPACTADO* catalogo, FILE* arquivo);
+
+/**
+ * @brief Localiza o endereço (bloco, slot) de um livro pelo código.
+ *
+ * @param catalogo Catálogo aberto.
+ * @param codigo Código procurado.
+ * @param[out] endereco Endereço do livro, se encontrado.
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO se o código não existir ou erro de leitura.
+ */
+int localizar_livro_compactado(CATALOGO_COMPACTADO* catalogo, size_t codigo,
+                               ENDERECO_COMPACTADO* endereco);
+
+/**
+ * @brief Lê o livro armazenado em um endereço do catálogo, passando pelo cache de blocos.
+ *
+ * @param catalogo Catálogo aberto.
+ * @param endereco Endereço devolvido por localizar_livro_compactado().
+ * @param[out] livro Livro lido.
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO para endereço fora dos limites ou erro de leitura.
+ */
+int ler_livro_compactado(CATALOGO_COMPACTADO* catalogo, ENDERECO_COMPACTADO endereco,
+                         LIVRO* livro);
+
+/**
+ * @brief Busca um livro pelo código no catálogo compactado.
+ *
+ * @param catalogo Catálogo aberto.
+ * @param codigo Código procurado.
+ * @param[out] livro Livro encontrado.
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO ou erro de leitura.
+ */
+int buscar_livro_compactado(CATALOGO_COMPACTADO* catalogo, size_t codigo, LIVRO* livro);
+
+/**
+ * @brief Imprime todos os livros do catálogo em ordem de código, no mesmo formato de
+ * imprimir_in_ordem().
+ *
+ * Lê cada bloco uma única vez, em ordem, sem passar pelo cache (uma varredura completa não
+ * expulsa os blocos usados pelas buscas).
+ *
+ * @param catalogo Catálogo aberto.
+ * @return SUCESSO ou código de erro.
+ */
+int imprimir_compactado_em_ordem(CATALOGO_COMPACTADO* catalogo);
+
+#endif  // CATALOGO_COMPACTADO_H
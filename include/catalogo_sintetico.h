@@ -0,0 +1,115 @@
+/**
+ * @file catalogo_sintetico.h
+ * @brief Catálogos sintéticos reprodutíveis, em texto de importação ou direto em binário.
+ *
+ * Cada linha segue o formato de importação `codigo;titulo;autor;editora;edicao;ano;exemplares;
+ * preco`. A ordem dos códigos segue a distribuição:
+ *
+ * - ordenada e reversa: 1..linhas, crescente ou decrescente;
+ * - aleatoria: uma permutação de 1..linhas;
+ * - agrupada: grupos de `grupo` códigos consecutivos, com os grupos em ordem aleatória;
+ * - zipf: códigos sorteados de 1..linhas com popularidade Zipf de expoente theta e espalhados
+ *   pela permutação, como o "scrambled zipfian" do YCSB; códigos populares se repetem.
+ *
+ * `duplicatas` faz uma fração das linhas repetir o código de uma linha anterior (a importação
+ * as rejeita como duplicadas). Os campos de texto têm comprimento sorteado entre o mínimo e o
+ * máximo (limitado ao tamanho de cada campo), uniforme ou, com `cauda`, concentrado perto do
+ * mínimo.
+ *
+ * Tudo é função da semente e do número da linha, sem estado: os mesmos parâmetros geram sempre
+ * o mesmo texto, e a memória usada não depende do número de linhas (exceto no binário). Os
+ * campos de um livro só dependem do código, de modo que importar o texto e gravar o binário
+ * por escrever_catalogo_binario() dão o mesmo catálogo.
+ */
+
+#ifndef CATALOGO_SINTETICO_H
+#define CATALOGO_SINTETICO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** Rodadas da permutação de códigos. */
+#define RODADAS_PERMUTACAO 4
+
+/**
+ * Ordem em que os códigos aparecem no texto.
+ */
+typedef enum {
+        DISTRIBUICAO_ORDENADA,  /**< 1..n crescente. */
+        DISTRIBUICAO_REVERSA,   /**< n..1. */
+        DISTRIBUICAO_ALEATORIA, /**< Permutação de 1..n. */
+        DISTRIBUICAO_AGRUPADA,  /**< Grupos consecutivos em ordem aleatória. */
+        DISTRIBUICAO_ZIPF       /**< Sorteio Zipf espalhado pela permutação. */
+} DISTRIBUICAO_CATALOGO;
+
+/**
+ * Bijeção de [0, n) sobre si mesmo, para sortear ordens sem guardar a permutação.
+ */
+typedef struct {
+        uint64_t limite;                            /**< n. */
+        uint64_t mascara;                           /**< 2^bits - 1, com 2^bits >= n. */
+        unsigned deslocamento;                      /**< Metade dos bits, para o xorshift. */
+        uint64_t multiplicador[RODADAS_PERMUTACAO]; /**< Ímpares sorteados. */
+        uint64_t soma[RODADAS_PERMUTACAO];          /**< Constantes sorteadas. */
+} PERMUTACAO;
+
+/**
+ * Constantes do sorteio Zipf (Gray et al., "Quickly generating billion-record synthetic
+ * databases").
+ */
+typedef struct {
+        double theta; /**< Expoente, entre 0 e 1. */
+        double zetan; /**< zeta(n, theta). */
+        double alfa;  /**< 1 / (1 - theta). */
+        double eta;   /**< Correção da cauda. */
+} ZIPF;
+
+/**
+ * Parâmetros do catálogo.
+ */
+typedef struct {
+        size_t linhas;                      /**< Linhas do texto. */
+        uint64_t semente;                   /**< Semente de todos os sorteios. */
+        DISTRIBUICAO_CATALOGO distribuicao; /**< Ordem dos códigos. */
+        size_t grupo;                       /**< Códigos por grupo da agrupada. */
+        double duplicatas;                  /**< Fração das linhas com código anterior. */
+        size_t comprimento_minimo;          /**< Menor comprimento dos campos de texto. */
+        size_t comprimento_maximo;          /**< Maior comprimento dos campos de texto. */
+        int cauda;                          /**< Comprimentos concentrados perto do mínimo. */
+        PERMUTACAO permutacao;              /**< Preenchida por preparar_catalogo_sintetico(). */
+        ZIPF zipf;                          /**< Preenchido por preparar_catalogo_sintetico(). */
+} CATALOGO_SINTETICO;
+
+/**
+ * @brief Sorteia a permutação e, na distribuição zipf, calcula as constantes do sorteio.
+ *
+ * Deve ser chamada depois de preencher os demais parâmetros e antes de gerar o catálogo.
+ *
+ * @param theta Expoente da zipf, entre 0 e 1 (ignorado nas outras distribuições).
+ */
+void preparar_catalogo_sintetico(CATALOGO_SINTETICO* catalogo, double theta);
+
+/**
+ * @brief Escreve as linhas do catálogo no formato de importação.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_WRITE.
+ */
+int escrever_catalogo_texto(const CATALOGO_SINTETICO* catalogo, FILE* saida);
+
+/**
+ * @brief Grava os livros dos códigos distintos do catálogo num arquivo de livros vazio.
+ *
+ * É o caminho rápido: os livros vão em ordem para construir_arvore_em_bloco() (arvore.h), numa
+ * árvore balanceada escrita sequencialmente. O formato da árvore não depende da distribuição,
+ * só do conjunto de códigos. Usa um bit por código possível.
+ *
+ * @param caminho Arquivo de livros; é criado se não existir.
+ * @param[out] distintos Livros gravados.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_MEMORIA ou erros de construir_arvore_em_bloco()
+ *         (ERRO_ARVORE_NAO_VAZIA se o arquivo já tem livros).
+ */
+int escrever_catalogo_binario(const CATALOGO_SINTETICO* catalogo, const char* caminho,
+                              size_t* distintos);
+
+#endif  // CATALOGO_SINTETICO_H
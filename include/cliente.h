@@ -0,0 +1,153 @@
+/**
+ * @file cliente.h
+ * @brief Biblioteca cliente do servidor de consultas (servidor.h).
+ *
+ * Há duas formas de uso:
+ *  - funções síncronas (cliente_buscar(), cliente_inserir(), ...), que enviam um pedido e
+ *    esperam a resposta;
+ *  - pipelining: enfileirar_*() acumula pedidos, enviar_pedidos() os envia de uma vez e
+ *    receber_resposta() lê as respostas, que chegam na mesma ordem dos pedidos.
+ */
+
+#ifndef CLIENTE_H
+#define CLIENTE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "livro.h"
+#include "protocolo.h"
+
+/**
+ * Conexão com o servidor.
+ */
+typedef struct {
+        int descritor;        /**< Socket conectado. */
+        uint32_t proximo_id;  /**< Identificador do próximo pedido. */
+        BUFFER_BYTES entrada; /**< Bytes recebidos ainda não entregues. */
+        BUFFER_BYTES saida;   /**< Pedidos enfileirados ainda não enviados. */
+} CLIENTE;
+
+/**
+ * Resposta recebida do servidor.
+ */
+typedef struct {
+        uint32_t id;                /**< `id` do pedido respondido. */
+        int status;                 /**< SUCESSO ou o erro devolvido pelo servidor. */
+        const unsigned char* carga; /**< Válida até a próxima chamada a receber_resposta(). */
+        uint32_t tamanho;           /**< Bytes de carga. */
+} RESPOSTA_CLIENTE;
+
+/**
+ * @brief Conecta ao servidor pelo socket de domínio Unix.
+ *
+ * @param caminho_socket Caminho do socket do servidor.
+ * @return Cliente conectado, ou NULL em caso de erro.
+ */
+CLIENTE* conectar_servidor(const char* caminho_socket);
+
+/**
+ * @brief Fecha a conexão e libera o cliente.
+ */
+void desconectar_servidor(CLIENTE* cliente);
+
+/**
+ * @brief Enfileira uma busca por código.
+ *
+ * @param[out] id Identificador do pedido (opcional).
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+int enfileirar_busca(CLIENTE* cliente, size_t codigo, uint32_t* id);
+
+/**
+ * @brief Enfileira o cadastro de um livro.
+ *
+ * @param[out] id Identificador do pedido (opcional).
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+int enfileirar_insercao(CLIENTE* cliente, const LIVRO* livro, uint32_t* id);
+
+/**
+ * @brief Enfileira a remoção de um livro.
+ *
+ * @param[out] id Identificador do pedido (opcional).
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+int enfileirar_remocao(CLIENTE* cliente, size_t codigo, uint32_t* id);
+
+/**
+ * @brief Enfileira uma consulta pelos livros com código em [`inicio`, `fim`].
+ *
+ * @param limite Máximo de livros na resposta (0 ou acima de LIMITE_INTERVALO usa o máximo).
+ * @param[out] id Identificador do pedido (opcional).
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+int enfileirar_intervalo(CLIENTE* cliente, size_t inicio, size_t fim, uint32_t limite,
+                         uint32_t* id);
+
+/**
+ * @brief Enfileira um pedido de estatísticas.
+ *
+ * @param[out] id Identificador do pedido (opcional).
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+int enfileirar_estatisticas(CLIENTE* cliente, uint32_t* id);
+
+/**
+ * @brief Envia todos os pedidos enfileirados.
+ *
+ * Enquanto envia, guarda as respostas que já chegarem, para que o servidor nunca fique
+ * bloqueado esperando o cliente ler.
+ *
+ * @return SUCESSO ou ERRO_CONEXAO.
+ */
+int enviar_pedidos(CLIENTE* cliente);
+
+/**
+ * @brief Espera e devolve a próxima resposta.
+ *
+ * @param[out] resposta Resposta recebida.
+ * @return SUCESSO se uma resposta foi recebida (o resultado do pedido fica em
+ *         `resposta->status`), ERRO_CONEXAO ou ERRO_PROTOCOLO.
+ */
+int receber_resposta(CLIENTE* cliente, RESPOSTA_CLIENTE* resposta);
+
+/**
+ * @brief Busca um livro pelo código.
+ *
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO se não existir, ou erros de conexão.
+ */
+int cliente_buscar(CLIENTE* cliente, size_t codigo, LIVRO* livro);
+
+/**
+ * @brief Cadastra um livro.
+ *
+ * @return Os códigos de cadastrar_livro_concorrente(), ou erros de conexão.
+ */
+int cliente_inserir(CLIENTE* cliente, const LIVRO* livro);
+
+/**
+ * @brief Remove um livro.
+ *
+ * @return Os códigos de remover_no_arvore_concorrente(), ou erros de conexão.
+ */
+int cliente_remover(CLIENTE* cliente, size_t codigo);
+
+/**
+ * @brief Lista os livros com código em [`inicio`, `fim`], em ordem.
+ *
+ * @param[out] livros Vetor alocado com os livros (liberar com free()).
+ * @param[out] quantidade Quantidade de livros no vetor.
+ * @return SUCESSO, ERRO_MEMORIA ou erros de conexão.
+ */
+int cliente_intervalo(CLIENTE* cliente, size_t inicio, size_t fim, uint32_t limite,
+                      LIVRO** livros, size_t* quantidade);
+
+/**
+ * @brief Lê os contadores do servidor.
+ *
+ * @return SUCESSO ou erros de conexão.
+ */
+int cliente_estatisticas(CLIENTE* cliente, ESTATISTICAS_SERVIDOR* estatisticas);
+
+#endif  // CLIENTE_H
@@ -0,0 +1,58 @@
+/**
+ * @file compressao.h
+ * @brief Codec de compressão da família LZ (formato de bloco no estilo LZ4), sem dependências
+ * externas.
+ */
+
+#ifndef COMPRESSAO_H
+#define COMPRESSAO_H
+
+#include <stddef.h>
+
+/**
+ * @brief Calcula o tamanho máximo que um bloco de `tamanho` bytes pode ocupar após comprimido.
+ *
+ * Dados incompressíveis crescem no máximo um byte a cada 255 de literais, mais o token final.
+ *
+ * @param tamanho Quantidade de bytes da entrada.
+ * @return Capacidade de destino suficiente para qualquer entrada desse tamanho.
+ */
+size_t limite_comprimido_lz(size_t tamanho);
+
+/**
+ * @brief Comprime um bloco de memória.
+ *
+ * Produz uma sequência de tokens (quantidade de literais, literais, deslocamento de 16 bits e
+ * comprimento da repetição), procurando repetições de pelo menos 4 bytes em uma janela de 64 KiB
+ * por meio de uma tabela hash.
+ *
+ * @param[in] origem Bytes a comprimir.
+ * @param[in] tamanho Quantidade de bytes em `origem`.
+ * @param[out] destino Área que receberá o bloco comprimido.
+ * @param[in] capacidade Tamanho de `destino`; use limite_comprimido_lz() para não falhar.
+ * @param[out] tamanho_saida Quantidade de bytes escritos em `destino`.
+ * @return Código de retorno:
+ *         - SUCESSO se o bloco foi comprimido;
+ *         - ERRO_COMPRESSAO se `destino` não tiver capacidade suficiente ou algum ponteiro for
+ *           NULL.
+ */
+int comprimir_lz(const unsigned char* origem, size_t tamanho, unsigned char* destino,
+                 size_t capacidade, size_t* tamanho_saida);
+
+/**
+ * @brief Descomprime um bloco produzido por comprimir_lz().
+ *
+ * Todas as leituras e escritas são verificadas, então um bloco corrompido resulta em erro e
+ * nunca em acesso fora dos limites.
+ *
+ * @param[in] origem Bloco comprimido.
+ * @param[in] tamanho Quantidade de bytes em `origem`.
+ * @param[out] destino Área que receberá os bytes originais.
+ * @param[in] capacidade Tamanho de `destino`.
+ * @param[out] tamanho_saida Quantidade de bytes escritos em `destino`.
+ * @return SUCESSO ou ERRO_COMPRESSAO se o bloco for inválido ou não couber em `destino`.
+ */
+int descomprimir_lz(const unsigned char* origem, size_t tamanho, unsigned char* destino,
+                    size_t capacidade, size_t* tamanho_saida);
+
+#endif  // COMPRESSAO_H
@@ -0,0 +1,94 @@
+/**
+ * @file concorrencia.h
+ * @brief Coordenação de leitores e escritores sobre o arquivo binário de livros.
+ *
+ * Combina duas travas:
+ *  - um latch leitor/escritor (pthread_rwlock) entre threads do mesmo processo;
+ *  - uma trava consultiva `fcntl` sobre o arquivo inteiro entre processos.
+ *
+ * Leitores compartilham as duas travas e nunca bloqueiam uns aos outros. Onde existem, são usadas
+ * travas OFD (`F_OFD_SETLKW`), que pertencem à descrição aberta: cada `FILE*` tem a sua, e fechar
+ * outro descritor do mesmo arquivo não a desfaz. A trava compartilhada de um descritor é obtida
+ * pelo primeiro leitor que o usa e liberada pelo último. Sem travas OFD, a trava é do processo e
+ * a contagem passa a ser por inode; nesse caso, um fclose() de qualquer `FILE*` do arquivo libera
+ * a trava do processo inteiro.
+ */
+
+#ifndef CONCORRENCIA_H
+#define CONCORRENCIA_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include "livro.h"
+
+/**
+ * Fim da faixa de bytes travada por travar_arquivo(). Cada byte a partir daqui registra uma
+ * versão aberta do modo copy-on-write (versoes.h), fora do alcance da trava de escrita.
+ */
+#define INICIO_TRAVAS_VERSOES ((off_t)1 << 62)
+
+/**
+ * @enum modo_trava
+ * @brief Tipo de acesso pedido ao arquivo.
+ */
+typedef enum {
+        TRAVA_LEITURA = 0, /**< Acesso compartilhado, somente leitura. */
+        TRAVA_ESCRITA = 1  /**< Acesso exclusivo para modificar a árvore. */
+} modo_trava;
+
+/**
+ * @brief Obtém a trava do arquivo no modo pedido, bloqueando até conseguir.
+ *
+ * Ao obter a trava, descarta dados que o `FILE*` tenha em buffer, e o pool do acesso direto
+ * (acesso_direto.h) se o arquivo mudou, para que leituras seguintes vejam o que outros
+ * processos gravaram. Se o arquivo do handle tiver sido trocado por outro no mesmo caminho
+ * (rebalancear_arquivo(), rebalanceamento.h), o caminho é reaberto no mesmo descritor antes de
+ * a trava ser obtida de novo.
+ *
+ * @param arquivo Arquivo binário de livros.
+ * @param modo TRAVA_LEITURA ou TRAVA_ESCRITA.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_TRAVA se o sistema recusar a trava ou
+ *         ERRO_ARQUIVO_SUBSTITUIDO se o arquivo trocado não puder ser reaberto.
+ */
+int travar_arquivo(FILE* arquivo, modo_trava modo);
+
+/**
+ * @brief Libera a trava obtida com travar_arquivo() no mesmo modo.
+ *
+ * No modo de escrita, descarrega os buffers do `FILE*` e soma um ao contador de alterações da
+ * página 0 (arquivo.h) antes de liberar a trava, de modo que o próximo leitor de outro processo
+ * encontre os dados gravados e saiba que o arquivo mudou.
+ *
+ * @param arquivo Arquivo binário de livros.
+ * @param modo Modo usado em travar_arquivo().
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_WRITE ou ERRO_TRAVA.
+ */
+int destravar_arquivo(FILE* arquivo, modo_trava modo);
+
+/**
+ * @brief Cadastra um livro segurando a trava exclusiva apenas durante a gravação.
+ *
+ * A verificação de código duplicado é feita antes, sob trava compartilhada; a trava exclusiva
+ * cobre só a inserção (que refaz a busca do pai e repete a verificação, já que outro escritor
+ * pode ter cadastrado o mesmo código nesse intervalo).
+ *
+ * @param arquivo Arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param livro Livro a cadastrar.
+ * @return Os mesmos códigos de cadastrar_livro(), ou erros de trava.
+ */
+int cadastrar_livro_concorrente(FILE* arquivo, LIVRO livro);
+
+/**
+ * @brief Remove um livro segurando a trava exclusiva apenas durante a remoção.
+ *
+ * Códigos inexistentes são descartados sob trava compartilhada, sem bloquear leitores.
+ *
+ * @param arquivo Arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param codigo Código do livro a remover.
+ * @return Os mesmos códigos de remover_no_arvore(), ou erros de trava.
+ */
+int remover_no_arvore_concorrente(FILE* arquivo, size_t codigo);
+
+#endif  // CONCORRENCIA_H
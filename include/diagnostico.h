@@ -0,0 +1,99 @@
+/**
+ * @file diagnostico.h
+ * @brief Diagnóstico da forma da árvore e do uso do arquivo de livros, numa passada sequencial.
+ *
+ * diagnosticar_arvore() lê todas as posições do arquivo em blocos, do início ao fim, e guarda
+ * só os dois filhos de cada uma (ler_filhos_arquivo(), arquivo.h); o percurso da árvore e da
+ * lista livre é feito depois, em memória (cerca de 25 bytes por posição). O custo é o de ler o
+ * arquivo uma vez em ordem, e não o de um seek por nó, como em imprimir_arvore_por_niveis().
+ *
+ * O relatório traz a altura e o caminho médio de busca comparados ao de uma árvore
+ * perfeitamente balanceada com os mesmos livros, o histograma de profundidades, o desequilíbrio
+ * das subárvores, o tamanho e o espalhamento da lista livre e quantas posições estão vivas,
+ * livres, aposentadas pelo modo copy-on-write (versoes.h) ou perdidas (fora de todas essas).
+ * Com esses números, `rebalancear` e `compactar` dizem se vale reorganizar ou compactar o
+ * arquivo.
+ */
+
+#ifndef DIAGNOSTICO_H
+#define DIAGNOSTICO_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/** Razão entre o caminho médio e o ótimo acima da qual se recomenda rebalancear. */
+#define LIMITE_REBALANCEAR 1.5
+
+/** Fração de posições não vivas acima da qual se recomenda compactar. */
+#define LIMITE_COMPACTAR 0.25
+
+/**
+ * Formato da saída de imprimir_diagnostico().
+ */
+typedef enum {
+        DIAGNOSTICO_TEXTO, /**< Relatório legível. */
+        DIAGNOSTICO_JSON   /**< Um objeto JSON numa linha. */
+} FORMATO_DIAGNOSTICO;
+
+/**
+ * Resultado de diagnosticar_arvore().
+ */
+typedef struct {
+        size_t posicoes;                    /**< Posições gravadas (o `topo` do cabeçalho). */
+        size_t livros_cabecalho;            /**< `quantidade_livros` do cabeçalho. */
+        size_t vivas;                       /**< Nós alcançáveis a partir da raiz. */
+        size_t livres;                      /**< Posições na lista livre. */
+        size_t aposentadas;                 /**< Posições na lista de aposentados e seus blocos. */
+        size_t perdidas;                    /**< Posições fora da árvore e das duas listas. */
+        size_t ligacoes_invalidas;          /**< Elos fora do arquivo ou repetidos. */
+
+        size_t altura;                      /**< Nós no caminho mais longo (0 se vazia). */
+        size_t altura_minima;               /**< Altura de uma árvore perfeita. */
+        double caminho_medio;               /**< Nós lidos, em média, por busca com sucesso. */
+        double caminho_medio_minimo;        /**< O mesmo numa árvore perfeita. */
+        size_t* profundidades;              /**< `altura` contagens; 0 é a raiz. */
+
+        size_t maior_diferenca_altura;      /**< Maior diferença de altura entre irmãos. */
+        size_t nos_desbalanceados;          /**< Nós com diferença de altura maior que 1. */
+        int maior_desbalanceada;            /**< Raiz da maior subárvore desbalanceada, ou -1. */
+        size_t tamanho_maior_desbalanceada; /**< Nós nessa subárvore. */
+
+        int menor_livre;                    /**< Menor posição da lista livre, ou -1. */
+        int maior_livre;                    /**< Maior posição da lista livre, ou -1. */
+        double salto_medio_livres;          /**< Distância média entre elos seguidos. */
+        size_t livres_no_fim;               /**< Posições não vivas no fim do arquivo. */
+
+        int rebalancear;                    /**< Ver LIMITE_REBALANCEAR. */
+        int compactar;                      /**< Ver LIMITE_COMPACTAR. */
+} DIAGNOSTICO_ARVORE;
+
+/**
+ * @brief Diagnostica a árvore e o arquivo numa passada sequencial.
+ *
+ * @param arquivo Arquivo de livros aberto para leitura.
+ * @param[out] diagnostico Resultado; liberar com liberar_diagnostico().
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO, ERRO_ARQUIVO_SEEK, ERRO_ARQUIVO_READ
+ *         ou ERRO_MEMORIA.
+ */
+int diagnosticar_arvore(FILE* arquivo, DIAGNOSTICO_ARVORE* diagnostico);
+
+/**
+ * @brief Libera o histograma de profundidades do diagnóstico.
+ */
+void liberar_diagnostico(DIAGNOSTICO_ARVORE* diagnostico);
+
+/**
+ * @brief Escreve o diagnóstico.
+ *
+ * No texto, histogramas com mais de 32 profundidades são agrupados em faixas; o JSON traz
+ * sempre uma posição por profundidade.
+ *
+ * @param saida Destino do relatório.
+ * @param diagnostico Diagnóstico calculado por diagnosticar_arvore().
+ * @param formato Texto ou JSON.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO ou ERRO_ARQUIVO_WRITE.
+ */
+int imprimir_diagnostico(FILE* saida, const DIAGNOSTICO_ARVORE* diagnostico,
+                         FORMATO_DIAGNOSTICO formato);
+
+#endif  // DIAGNOSTICO_H
@@ -13,24 +13,44 @@
 typedef enum {
         SUCESSO = 0,
 
-        ERRO_ARQUIVO_NULO = -1,  /**< Handle para arquivo é nulo. */
-        ERRO_ARQUIVO_SEEK = -2,  /**< Erro na função fseek. */
-        ERRO_ARQUIVO_READ = -3,  /**< Erro na função fread. */
-        ERRO_ARQUIVO_WRITE = -4, /**< Erro na função fwrite. */
-        ERRO_ARQUIVO_TEXTO = -5, /**< Caminho para arquivo texto invalido. */
+        ERRO_ARQUIVO_NULO = -1,          /**< Handle para arquivo é nulo. */
+        ERRO_ARQUIVO_SEEK = -2,          /**< Erro na função fseek. */
+        ERRO_ARQUIVO_READ = -3,          /**< Erro na função fread. */
+        ERRO_ARQUIVO_WRITE = -4,         /**< Erro na função fwrite. */
+        ERRO_ARQUIVO_TEXTO = -5,         /**< Caminho para arquivo texto invalido. */
+        ERRO_MEMORIA = -6,               /**< Falha ao alocar memória. */
 
-        ERRO_CABECALHO_NULO = -10, /**< Cabeçalho não encontrado no arquivo binário. */
+        ERRO_CABECALHO_NULO = -10,       /**< Cabeçalho não encontrado no arquivo binário. */
 
         ERRO_NO_NULO = -20,              /**< Nó da árvore é nulo. */
         ERRO_CODIGO_DUPLICADO = -21,     /**< Já existe um nó com o código informado. */
         ERRO_RESULTADO_BUSCA_NULO = -22, /**< Estrutura RESULTADO_BUSCA é nulo. */
+        ERRO_ARVORE_NAO_VAZIA = -23,     /**< A operação exige a árvore vazia. */
 
-        ERRO_LIVRO_INVALIDO = -30,  /**< Não existe um nó com o livro buscado. */
-        ERRO_CADASTRAR_LIVRO = -31, /**< erro na tentativa de cadastrar livro na biblioteca. */
+        ERRO_LIVRO_INVALIDO = -30,       /**< Não existe um nó com o livro buscado. */
+        ERRO_CADASTRAR_LIVRO = -31,      /**< erro na tentativa de cadastrar livro na biblioteca. */
+        ERRO_CAMPO_TRUNCADO = -32,       /**< Campo de texto maior que o espaço no LIVRO. */
 
         ERRO_FILA_NULA = -40,
         ERRO_ITEM_FILA_NULO = -41,
-        ERRO_FILA_CHEIA = -42
+        ERRO_FILA_CHEIA = -42,
+
+        ERRO_COMPRESSAO = -50,           /**< Bloco não coube no destino ou dados corrompidos. */
+        ERRO_FORMATO_COMPACTADO = -51,   /**< Arquivo não é um catálogo compactado válido. */
+        ERRO_FORMATO_INSTANTANEO = -52,  /**< Instantâneo truncado, de outra versão ou inválido. */
+        ERRO_SOMA_INSTANTANEO = -53,     /**< Soma de verificação do instantâneo não confere. */
+        ERRO_FORMATO_RASTRO = -54,       /**< Arquivo não é um rastro de operações válido. */
+        ERRO_SOMA_PAGINA = -55,          /**< Página do arquivo de livros corrompida. */
+        ERRO_FORMATO_ARQUIVO = -56,      /**< Arquivo de livros de formato desconhecido. */
+        ERRO_COMPACTADO_ANTIGO = -57,    /**< Catálogo compactado anterior à última escrita. */
+
+        ERRO_TRAVA = -60,                /**< Falha ao obter ou liberar trava do arquivo. */
+        ERRO_ARQUIVO_SUBSTITUIDO = -61,  /**< O arquivo foi trocado e não pôde ser reaberto. */
+
+        ERRO_PROTOCOLO = -70,            /**< Mensagem malformada ou operação desconhecida. */
+        ERRO_CONEXAO = -71,              /**< Falha ao criar, conectar ou usar o socket. */
+
+        ERRO_COMANDO_INVALIDO = -80      /**< Comando desconhecido no modo em lote. */
 } codigo_erro;
 
 #endif  // ERROS_H
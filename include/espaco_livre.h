@@ -0,0 +1,124 @@
+/**
+ * @file espaco_livre.h
+ * @brief Mapa persistente das posições livres, para alocar nós perto do pai.
+ *
+ * Sem o mapa, alocar_no_arquivo() (arquivo.h) usa a cabeça da lista livre, onde quer que ela
+ * esteja, e um filho recém-inserido pode ir parar longe do pai: cada nível de uma busca
+ * posterior toca outra página. Com o mapa associado ao handle, inserir_no_arvore() (arvore.h)
+ * passa a posição do pai como dica e a alocação prefere, nesta ordem:
+ *
+ * 1. a posição livre mais próxima da dica, a até RAIO_LOCALIDADE posições dela;
+ * 2. o topo do arquivo, se ele estiver nesse raio;
+ * 3. a cabeça da lista livre, ou o topo, como antes.
+ *
+ * A lista livre do arquivo continua sendo a fonte da verdade, encadeada por `filho_esquerdo`,
+ * e nada muda no formato do arquivo de livros. Para tirar uma posição do meio da lista é
+ * preciso saber qual posição aponta para ela; por isso o mapa guarda, para cada posição, a
+ * anterior na lista livre (ou POSICAO_OCUPADA), em vez de um só bit.
+ *
+ * Como o filtro (filtro.h) e o índice (indice.h), o mapa é associado a um handle por
+ * abrir_mapa_livre(), mantido pelas alocações e liberações do arquivo.h enquanto associado, e
+ * gravado em `<caminho>SUFIXO_MAPA_LIVRE` por fechar_mapa_livre(), com a identidade do arquivo
+ * de livros; se ela não conferir na abertura, o mapa é refeito percorrendo a lista livre. A
+ * associação vale só enquanto o chamador segura a trava do arquivo (concorrencia.h).
+ */
+
+#ifndef ESPACO_LIVRE_H
+#define ESPACO_LIVRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arquivo.h"
+
+/** Sufixo do arquivo do mapa, acrescentado ao caminho do arquivo de livros. */
+#define SUFIXO_MAPA_LIVRE ".livres"
+
+/** Identifica o arquivo do mapa ("LIVR" em little-endian). */
+#define MAGICA_MAPA_LIVRE 0x5256494Cu
+
+/** Versão do formato do arquivo do mapa. */
+#define VERSAO_MAPA_LIVRE 1u
+
+/** Distância máxima, em posições, entre a dica e a posição escolhida (oito páginas de dados). */
+#define RAIO_LOCALIDADE 64
+
+/** Valor do mapa para posições que não estão na lista livre. */
+#define POSICAO_OCUPADA (-2)
+
+/**
+ * Cabeçalho do arquivo do mapa, seguido de `posicoes` inteiros de 32 bits.
+ */
+typedef struct {
+        uint32_t magica;           /**< MAGICA_MAPA_LIVRE. */
+        uint32_t versao;           /**< VERSAO_MAPA_LIVRE. */
+        uint64_t posicoes;         /**< Posições do mapa. */
+        uint64_t livres;           /**< Posições na lista livre. */
+        IDENTIDADE_ARQUIVO livros; /**< Arquivo de livros na gravação. */
+} CABECALHO_MAPA_LIVRE;
+
+/**
+ * Situação de um mapa associado.
+ */
+typedef struct {
+        size_t posicoes;      /**< Posições do mapa. */
+        size_t livres;        /**< Posições na lista livre. */
+        size_t proximas;      /**< Alocações feitas perto da dica desde a abertura. */
+        size_t reconstrucoes; /**< Reconstruções a partir da lista livre desde a abertura. */
+} ESTADO_MAPA_LIVRE;
+
+/**
+ * @brief Associa um mapa ao handle, lendo o arquivo do mapa ou refazendo-o pela lista livre.
+ *
+ * @param arquivo Arquivo binário da árvore, já travado pelo chamador.
+ * @param caminho Caminho do arquivo de livros (o mapa fica em `caminho` + SUFIXO_MAPA_LIVRE).
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO, ERRO_MEMORIA ou ERRO_NO_NULO (lista
+ *         livre com elos inválidos).
+ */
+int abrir_mapa_livre(FILE* arquivo, const char* caminho);
+
+/**
+ * @brief Grava o mapa ao lado do arquivo de livros e desfaz a associação.
+ *
+ * Não faz nada se o handle não tiver mapa associado.
+ *
+ * @param arquivo Handle passado a abrir_mapa_livre().
+ * @return SUCESSO ou ERRO_ARQUIVO_WRITE (a associação é desfeita mesmo em caso de erro).
+ */
+int fechar_mapa_livre(FILE* arquivo);
+
+/**
+ * @brief Escolhe uma posição perto da dica: a livre mais próxima ou o topo, no raio.
+ *
+ * @param arquivo Handle com o mapa.
+ * @param dica Posição perto da qual alocar (em geral, a do pai).
+ * @param topo `topo` atual do cabeçalho.
+ * @param[out] posicao Posição escolhida (`topo` para crescer o arquivo).
+ * @param[out] anterior Posição que aponta para a escolhida na lista livre, ou
+ *             POSICAO_INVALIDA se ela for a cabeça.
+ * @return SUCESSO, ou ERRO_NO_NULO sem mapa válido ou sem posição no raio.
+ */
+int escolher_posicao_livre(FILE* arquivo, int dica, int topo, int* posicao, int* anterior);
+
+/**
+ * @brief Registra no mapa que `posicao` saiu da lista livre (ou foi acrescentada no topo).
+ *
+ * @param anterior Posição que apontava para ela, ou POSICAO_INVALIDA se era a cabeça.
+ * @param proximo Posição seguinte na lista livre, ou POSICAO_INVALIDA.
+ */
+void registrar_alocacao_no_mapa(FILE* arquivo, int posicao, int anterior, int proximo);
+
+/**
+ * @brief Registra no mapa que `posicao` entrou na cabeça da lista livre, antes de `proximo`.
+ */
+void registrar_liberacao_no_mapa(FILE* arquivo, int posicao, int proximo);
+
+/**
+ * @brief Lê a situação do mapa associado ao handle.
+ *
+ * @return SUCESSO, ou ERRO_ARQUIVO_NULO se o handle não tiver mapa.
+ */
+int consultar_mapa_livre(FILE* arquivo, ESTADO_MAPA_LIVRE* estado);
+
+#endif  // ESPACO_LIVRE_H
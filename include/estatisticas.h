@@ -0,0 +1,187 @@
+/**
+ * @file estatisticas.h
+ * @brief Contadores de E/S e de alocações e histogramas de latência das operações da árvore.
+ *
+ * Com a macro ESTATISTICAS definida na compilação (`make ESTATISTICAS=1`, o padrão), arquivo.c e
+ * arvore.c contam cada leitura e escrita de nó e de cabeçalho, cada fseek() e cada alocação, e
+ * as operações públicas (cadastrar_livro(), inserir_no_arvore(), buscar_no_arvore(),
+ * remover_no_arvore(), as variantes copy-on-write e percorrer_em_ordem()) medem a própria
+ * duração. Sem a macro, as macros de instrumentação abaixo não geram código, e as funções de
+ * leitura devolvem zeros.
+ *
+ * Cada evento é atribuído à operação mais externa em andamento na thread: a busca feita por
+ * cadastrar_livro() para recusar códigos duplicados conta como parte do cadastro, e não como
+ * uma busca. Eventos fora de qualquer operação (percursos, exportações) ficam em
+ * OPERACAO_OUTRAS. Os contadores são globais e atualizados atomicamente, sem travas.
+ *
+ * Com um rastro aberto (rastro.h), cada operação medida também grava um registro com o código,
+ * o status, a duração e os nós lidos e gravados por ela.
+ */
+
+#ifndef ESTATISTICAS_H
+#define ESTATISTICAS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** Baldes do histograma de latência: 16 lineares e 8 por potência de 2 acima deles. */
+#define BALDES_LATENCIA 496
+
+/**
+ * Evento de E/S ou de memória contado pela instrumentação.
+ */
+typedef enum {
+        EVENTO_LEITURA_NO,        /**< Nó lido do arquivo. */
+        EVENTO_ESCRITA_NO,        /**< Nó gravado no arquivo. */
+        EVENTO_LEITURA_CABECALHO, /**< Cabeçalho lido. */
+        EVENTO_ESCRITA_CABECALHO, /**< Cabeçalho gravado. */
+        EVENTO_SEEK,              /**< Chamada a fseek(). */
+        EVENTO_ALOCACAO,          /**< Chamada a malloc() ou realloc(). */
+        QUANTIDADE_EVENTOS
+} EVENTO_ESTATISTICA;
+
+/**
+ * Operação à qual os eventos e a latência são atribuídos.
+ */
+typedef enum {
+        OPERACAO_OUTRAS,    /**< Eventos fora de uma operação medida. */
+        OPERACAO_CADASTRAR, /**< cadastrar_livro(). */
+        OPERACAO_INSERIR,   /**< inserir_no_arvore() e inserir_no_arvore_cow() chamados direto. */
+        OPERACAO_BUSCAR,    /**< buscar_no_arvore(). */
+        OPERACAO_REMOVER,   /**< remover_no_arvore() e remover_no_arvore_cow(). */
+        OPERACAO_PERCORRER, /**< percorrer_em_ordem(). */
+        QUANTIDADE_OPERACOES
+} OPERACAO_ESTATISTICA;
+
+/**
+ * Formato da saída de imprimir_estatisticas().
+ */
+typedef enum {
+        ESTATISTICAS_TEXTO, /**< Tabela legível. */
+        ESTATISTICAS_JSON   /**< Um objeto JSON numa linha. */
+} FORMATO_ESTATISTICAS;
+
+/**
+ * Contadores acumulados de uma operação.
+ */
+typedef struct {
+        uint64_t chamadas;                    /**< Chamadas concluídas. */
+        uint64_t eventos[QUANTIDADE_EVENTOS]; /**< Eventos atribuídos à operação. */
+        uint64_t soma_ns;                     /**< Soma das durações. */
+        uint64_t maximo_ns;                   /**< Maior duração. */
+        uint64_t histograma[BALDES_LATENCIA]; /**< Chamadas por faixa de duração. */
+} ESTATISTICAS_OPERACAO;
+
+/**
+ * Medição em andamento de uma operação.
+ */
+typedef struct {
+        int operacao;    /**< Operação medida, ou -1 se aninhada em outra. */
+        uint64_t codigo; /**< Código do livro da operação, para o rastro. */
+        uint64_t inicio; /**< Instante do início, em nanossegundos. */
+} MEDICAO_OPERACAO;
+
+#ifdef ESTATISTICAS
+/** Conta um evento para a operação em andamento na thread. */
+#define CONTAR_EVENTO(evento) contar_eventos((evento), 1)
+/** Conta `n` eventos de uma vez. */
+#define CONTAR_EVENTOS(evento, n) contar_eventos((evento), (n))
+/** Declara `medicao` e inicia a medição de `operacao` sobre o livro `codigo`. */
+#define INICIAR_MEDICAO(medicao, operacao, codigo) \
+        MEDICAO_OPERACAO medicao = iniciar_medicao((operacao), (codigo))
+/** Conclui a medição iniciada por INICIAR_MEDICAO(), com o status devolvido pela operação. */
+#define CONCLUIR_MEDICAO(medicao, status) concluir_medicao(&(medicao), (status))
+#else
+#define CONTAR_EVENTO(evento) ((void)0)
+#define CONTAR_EVENTOS(evento, n) ((void)0)
+#define INICIAR_MEDICAO(medicao, operacao, codigo) ((void)0)
+#define CONCLUIR_MEDICAO(medicao, status) ((void)0)
+#endif
+
+/**
+ * @brief Soma `n` ocorrências do evento à operação em andamento na thread.
+ *
+ * Use pela macro CONTAR_EVENTO(), que some quando ESTATISTICAS não está definida.
+ */
+void contar_eventos(EVENTO_ESTATISTICA evento, uint64_t n);
+
+/**
+ * @brief Inicia a medição de uma operação, se nenhuma outra estiver em andamento na thread.
+ *
+ * Use pela macro INICIAR_MEDICAO().
+ */
+MEDICAO_OPERACAO iniciar_medicao(OPERACAO_ESTATISTICA operacao, uint64_t codigo);
+
+/**
+ * @brief Registra a duração e a chamada da operação medida e a encerra, gravando-a no rastro
+ * se houver um aberto.
+ *
+ * Use pela macro CONCLUIR_MEDICAO().
+ */
+void concluir_medicao(MEDICAO_OPERACAO* medicao, int status);
+
+/**
+ * @brief Diz se o programa foi compilado com a instrumentação.
+ *
+ * @return 1 se ESTATISTICAS estava definida; 0 caso contrário.
+ */
+int estatisticas_ativas(void);
+
+/**
+ * @brief Copia os contadores de todas as operações.
+ *
+ * A cópia não é atômica como um todo: operações concluídas durante ela podem aparecer só em
+ * parte dos contadores.
+ *
+ * @param[out] destino Vetor com QUANTIDADE_OPERACOES posições, indexado por
+ *             OPERACAO_ESTATISTICA.
+ */
+void ler_estatisticas(ESTATISTICAS_OPERACAO* destino);
+
+/**
+ * @brief Zera todos os contadores.
+ */
+void zerar_estatisticas(void);
+
+/**
+ * @brief Latência abaixo da qual ficam `fracao` das chamadas da operação.
+ *
+ * @param estatisticas Contadores de uma operação.
+ * @param fracao Fração entre 0 e 1 (0.99 para o p99).
+ * @return Limite superior do balde do histograma que contém o percentil, em nanossegundos (no
+ *         máximo `maximo_ns`), ou 0 sem chamadas.
+ */
+uint64_t percentil_latencia(const ESTATISTICAS_OPERACAO* estatisticas, double fracao);
+
+/**
+ * @brief Nome curto da operação ("cadastrar", "buscar"...).
+ */
+const char* nome_operacao(OPERACAO_ESTATISTICA operacao);
+
+/**
+ * @brief Nome curto do evento ("leituras_no", "seeks"...).
+ */
+const char* nome_evento(EVENTO_ESTATISTICA evento);
+
+/**
+ * @brief Escreve os contadores atuais de todas as operações com chamadas ou eventos.
+ *
+ * @param saida Destino do relatório.
+ * @param formato Tabela de texto ou um objeto JSON numa linha.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO ou ERRO_ARQUIVO_WRITE.
+ */
+int imprimir_estatisticas(FILE* saida, FORMATO_ESTATISTICAS formato);
+
+/**
+ * @brief Cria uma thread que escreve as estatísticas em `saida` ao receber SIGUSR1 (texto) ou
+ * SIGUSR2 (JSON).
+ *
+ * Bloqueia os dois sinais na thread que chama, e portanto nas criadas depois dela: chame no
+ * início de main(), antes de criar outras threads.
+ *
+ * @param saida Destino dos relatórios (normalmente stderr).
+ * @return SUCESSO ou ERRO_MEMORIA se a thread não puder ser criada.
+ */
+int iniciar_despejo_por_sinal(FILE* saida);
+
+#endif  // ESTATISTICAS_H
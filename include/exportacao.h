@@ -0,0 +1,67 @@
+/**
+ * @file exportacao.h
+ * @brief Exportação do catálogo inteiro para texto (CSV ou JSON Lines), em ordem de código.
+ *
+ * A árvore é percorrida uma única vez com percorrer_em_ordem() e cada livro é formatado direto
+ * num buffer de TAMANHO_BUFFER_EXPORTACAO bytes, sem printf: os números são convertidos à mão
+ * e o buffer só vai para o arquivo quando enche, num único fwrite().
+ *
+ * O CSV usa o formato de entrada da importação (importacao.h),
+ * `codigo;titulo;autor;editora;edicao;ano;exemplares;preco`, para que o arquivo exportado
+ * possa ser importado de volta. Esse formato não tem escape: `;` e caracteres de controle
+ * dentro dos textos viram espaço (e são contados no relatório), e espaços nas pontas de um
+ * campo se perdem na volta, porque a importação os apara.
+ *
+ * No JSON Lines, cada linha é um objeto com os oito campos; os textos são escapados conforme
+ * o JSON e copiados byte a byte (espera-se UTF-8).
+ */
+
+#ifndef EXPORTACAO_H
+#define EXPORTACAO_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/** Tamanho do buffer de saída da exportação. */
+#define TAMANHO_BUFFER_EXPORTACAO (1 << 20)
+
+/**
+ * @enum formato_exportacao
+ * @brief Formatos de saída da exportação.
+ */
+typedef enum {
+        EXPORTACAO_CSV = 0,  /**< Uma linha por livro, no formato da importação. */
+        EXPORTACAO_JSONL = 1 /**< Um objeto JSON por linha. */
+} FORMATO_EXPORTACAO;
+
+/**
+ * Resultado de uma exportação.
+ */
+typedef struct {
+        size_t livros;           /**< Livros exportados. */
+        size_t bytes;            /**< Bytes gravados. */
+        size_t campos_alterados; /**< Campos de texto com caracteres trocados (só no CSV). */
+        double segundos;         /**< Tempo total da exportação. */
+} RELATORIO_EXPORTACAO;
+
+/**
+ * @brief Escolhe o formato pela extensão: `.json` e `.jsonl` dão JSON Lines, o resto CSV.
+ */
+FORMATO_EXPORTACAO formato_pelo_caminho(const char* caminho);
+
+/**
+ * @brief Exporta todos os livros, em ordem de código.
+ *
+ * O chamador deve segurar a trava de leitura do arquivo (concorrencia.h).
+ *
+ * @param arquivo Arquivo binário da árvore, aberto para leitura.
+ * @param destino Arquivo texto de saída, aberto para escrita.
+ * @param formato Formato de saída.
+ * @param[out] relatorio Contadores da exportação (opcional).
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_MEMORIA, ERRO_ARQUIVO_WRITE ou erros do percurso da
+ *         árvore.
+ */
+int exportar_catalogo(FILE* arquivo, FILE* destino, FORMATO_EXPORTACAO formato,
+                      RELATORIO_EXPORTACAO* relatorio);
+
+#endif  // EXPORTACAO_H
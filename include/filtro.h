@@ -0,0 +1,126 @@
+/**
+ * @file filtro.h
+ * @brief Filtro de Bloom persistente sobre os códigos do catálogo, para responder "não existe"
+ * sem descer a árvore.
+ *
+ * O filtro é dividido em blocos de 256 bits (oito palavras de 32 bits): cada código escolhe um
+ * bloco e marca um bit em cada palavra, de modo que uma consulta toca uma única linha de cache.
+ * Com BITS_POR_CODIGO_FILTRO bits por código, cerca de 1% das buscas por códigos ausentes ainda
+ * desce a árvore; códigos presentes nunca são descartados.
+ *
+ * O filtro é associado a um handle do arquivo de livros por abrir_filtro() e gravado ao lado
+ * dele, em `<caminho>SUFIXO_FILTRO`, por fechar_filtro(). Enquanto associado, as inserções
+ * (inserir_no_arvore(), inserir_no_arvore_cow() e construir_arvore_em_bloco()) registram os
+ * códigos novos; quando eles passam da capacidade, o filtro dobra e é refeito percorrendo a
+ * árvore. Remoções não apagam bits, que podem ser de outros códigos: só são contadas, e quando
+ * passam de um quarto dos códigos registrados o filtro é refeito ao ser fechado.
+ *
+ * O arquivo do filtro guarda a identidade do arquivo de livros (IDENTIDADE_ARQUIVO, arquivo.h)
+ * no momento em que foi gravado. Se ela não conferir na abertura (o catálogo foi alterado sem o
+ * filtro, por outro processo ou por uma restauração), o filtro é refeito. Por isso a associação
+ * vale só enquanto o chamador segura a trava do arquivo (concorrencia.h): abra o filtro depois
+ * de travar e feche-o antes de destravar e de fclose().
+ */
+
+#ifndef FILTRO_H
+#define FILTRO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arquivo.h"
+
+/** Sufixo do arquivo do filtro, acrescentado ao caminho do arquivo de livros. */
+#define SUFIXO_FILTRO ".bloom"
+
+/** Identifica o arquivo do filtro ("BLOM" em little-endian). */
+#define MAGICA_FILTRO 0x4D4F4C42u
+
+/** Versão do formato do arquivo do filtro. */
+#define VERSAO_FILTRO 1u
+
+/** Bits do filtro por código registrado, antes de ele precisar crescer. */
+#define BITS_POR_CODIGO_FILTRO 10
+
+/** Menor quantidade de blocos de 256 bits do filtro (2 KB). */
+#define BLOCOS_MINIMOS_FILTRO 64
+
+/**
+ * Cabeçalho do arquivo do filtro, seguido de `blocos` blocos de 32 bytes.
+ */
+typedef struct {
+        uint32_t magica;           /**< MAGICA_FILTRO. */
+        uint32_t versao;           /**< VERSAO_FILTRO. */
+        uint64_t blocos;           /**< Blocos de 256 bits (potência de 2). */
+        uint64_t registrados;      /**< Códigos registrados desde a última reconstrução. */
+        uint64_t removidos;        /**< Remoções desde a última reconstrução. */
+        IDENTIDADE_ARQUIVO livros; /**< Arquivo de livros na gravação. */
+} CABECALHO_FILTRO;
+
+/**
+ * Situação de um filtro associado.
+ */
+typedef struct {
+        size_t bits;          /**< Tamanho do filtro em bits. */
+        size_t registrados;   /**< Códigos registrados desde a última reconstrução. */
+        size_t removidos;     /**< Remoções desde a última reconstrução. */
+        size_t reconstrucoes; /**< Reconstruções a partir da árvore desde a abertura. */
+} ESTADO_FILTRO;
+
+/**
+ * @brief Associa um filtro ao handle, lendo o arquivo do filtro ou refazendo-o pela árvore.
+ *
+ * @param arquivo Arquivo binário da árvore, já travado pelo chamador.
+ * @param caminho Caminho do arquivo de livros (o filtro fica em `caminho` + SUFIXO_FILTRO).
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO, ERRO_MEMORIA ou erros do percurso.
+ */
+int abrir_filtro(FILE* arquivo, const char* caminho);
+
+/**
+ * @brief Grava o filtro ao lado do arquivo de livros e desfaz a associação.
+ *
+ * Não faz nada se o handle não tiver filtro associado.
+ *
+ * @param arquivo Handle passado a abrir_filtro().
+ * @return SUCESSO ou ERRO_ARQUIVO_WRITE (a associação é desfeita mesmo em caso de erro).
+ */
+int fechar_filtro(FILE* arquivo);
+
+/**
+ * @brief Diz se o código certamente não está na árvore.
+ *
+ * @return 1 se o filtro associado ao handle descarta o código; 0 se ele pode existir ou se o
+ *         handle não tiver filtro.
+ */
+int codigo_certamente_ausente(FILE* arquivo, size_t codigo);
+
+/**
+ * @brief Registra um código recém-inserido no filtro associado ao handle, se houver.
+ *
+ * Se o filtro precisar crescer e a reconstrução falhar, ele deixa de descartar códigos até ser
+ * fechado, e não é gravado.
+ */
+void registrar_codigo_no_filtro(FILE* arquivo, size_t codigo);
+
+/**
+ * @brief Conta uma remoção no filtro associado ao handle, se houver.
+ */
+void registrar_remocao_no_filtro(FILE* arquivo);
+
+/**
+ * @brief Refaz o filtro associado ao handle a partir dos códigos da árvore.
+ *
+ * @return SUCESSO (também sem filtro associado), ERRO_CABECALHO_NULO, ERRO_MEMORIA ou erros do
+ *         percurso.
+ */
+int reconstruir_filtro(FILE* arquivo);
+
+/**
+ * @brief Lê a situação do filtro associado ao handle.
+ *
+ * @return SUCESSO, ou ERRO_ARQUIVO_NULO se o handle não tiver filtro.
+ */
+int consultar_filtro(FILE* arquivo, ESTADO_FILTRO* estado);
+
+#endif  // FILTRO_H
@@ -0,0 +1,216 @@
+/**
+ * @file importacao.h
+ * @brief Importação do arquivo texto de livros a partir de um mapeamento em memória.
+ *
+ * O arquivo é mapeado com mmap() (ou lido de uma vez, se não for um arquivo regular) e as
+ * linhas e campos são delimitados direto sobre os bytes mapeados, com a varredura vetorizada
+ * de varredura.h: nenhum campo é copiado para um buffer intermediário antes de ir para o
+ * LIVRO, e não há limite de tamanho de linha.
+ *
+ * Formato de cada linha: `codigo;titulo;autor;editora;edicao;ano;exemplares;preco`.
+ *
+ * As linhas rejeitadas não são impressas uma a uma: a importação conta-as por motivo e, se
+ * pedido, grava-as ao final num arquivo à parte, uma por linha, no formato
+ * `numero_da_linha<TAB>motivo<TAB>linha original`.
+ */
+
+#ifndef IMPORTACAO_H
+#define IMPORTACAO_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "livro.h"
+
+/** Sufixo acrescentado ao caminho do texto para formar o arquivo de linhas rejeitadas. */
+#define SUFIXO_REJEITADAS ".rejeitados"
+
+/**
+ * Conteúdo de um arquivo texto disponível em memória.
+ */
+typedef struct {
+        const char* dados; /**< Primeiro byte do arquivo (NULL se vazio). */
+        size_t tamanho;    /**< Bytes do arquivo. */
+        int mapeado;       /**< 1 se `dados` veio de mmap(), 0 se de malloc(). */
+} TEXTO_MAPEADO;
+
+/**
+ * Cursor sobre as linhas de um texto em memória.
+ */
+typedef struct {
+        const char* atual;   /**< Início da próxima linha. */
+        const char* fim;     /**< Fim do texto. */
+        size_t numero_linha; /**< Número (a partir de 1) da última linha devolvida. */
+} LEITOR_LINHAS;
+
+/**
+ * Função que grava um livro importado (cadastrar_livro(), cadastrar_livro_concorrente(), ...).
+ */
+typedef int (*CADASTRO_LIVRO)(FILE* arquivo, LIVRO livro);
+
+/**
+ * @enum motivo_rejeicao
+ * @brief Motivos pelos quais uma linha do arquivo texto deixa de ser cadastrada.
+ */
+typedef enum {
+        REJEICAO_REPETIDO = 0, /**< Código já cadastrado ou repetido no próprio arquivo. */
+        REJEICAO_FORMATO = 1,  /**< Campo faltando ou número inválido. */
+        REJEICAO_TRUNCADO = 2, /**< Campo de texto maior que o espaço no LIVRO. */
+        REJEICAO_GRAVACAO = 3, /**< Erro de leitura ou gravação no arquivo binário. */
+        QUANTIDADE_MOTIVOS = 4 /**< Quantidade de motivos. */
+} MOTIVO_REJEICAO;
+
+/**
+ * Linha rejeitada, apontando para dentro do texto mapeado.
+ */
+typedef struct {
+        const char* linha;      /**< Primeiro byte da linha. */
+        size_t tamanho;         /**< Bytes da linha, sem o `\n`. */
+        MOTIVO_REJEICAO motivo; /**< Por que a linha foi rejeitada. */
+} LINHA_REJEITADA;
+
+/**
+ * Vetor crescente de linhas rejeitadas.
+ */
+typedef struct {
+        LINHA_REJEITADA* itens; /**< Linhas, na ordem em que foram rejeitadas. */
+        size_t quantidade;      /**< Linhas em `itens`. */
+        size_t capacidade;      /**< Espaço alocado em `itens`. */
+} LISTA_REJEITADAS;
+
+/**
+ * Resultado de uma importação.
+ */
+typedef struct {
+        size_t bytes;                          /**< Tamanho do arquivo texto. */
+        size_t linhas;                         /**< Linhas não vazias lidas. */
+        size_t cadastrados;                    /**< Livros gravados com sucesso. */
+        size_t rejeitados;                     /**< Linhas não cadastradas, por qualquer motivo. */
+        size_t por_motivo[QUANTIDADE_MOTIVOS]; /**< Linhas rejeitadas por motivo. */
+        double segundos;                       /**< Tempo total da importação. */
+} RELATORIO_IMPORTACAO;
+
+/**
+ * @brief Disponibiliza o arquivo texto em memória.
+ *
+ * Arquivos regulares são mapeados somente para leitura; pipes e afins são lidos por inteiro.
+ *
+ * @param caminho Caminho do arquivo texto.
+ * @param[out] texto Conteúdo, a liberar com liberar_texto().
+ * @return SUCESSO, ERRO_ARQUIVO_TEXTO se o arquivo não puder ser lido ou ERRO_MEMORIA.
+ */
+int mapear_texto(const char* caminho, TEXTO_MAPEADO* texto);
+
+/**
+ * @brief Desfaz o mapeamento (ou libera a cópia) feito por mapear_texto().
+ */
+void liberar_texto(TEXTO_MAPEADO* texto);
+
+/**
+ * @brief Posiciona o leitor no início de `tamanho` bytes em `dados`.
+ */
+void iniciar_leitor_linhas(LEITOR_LINHAS* leitor, const char* dados, size_t tamanho);
+
+/**
+ * @brief Avança para a próxima linha.
+ *
+ * A linha devolvida aponta para dentro do texto, sem o `\n` final e sem terminador nulo.
+ *
+ * @param[out] linha Primeiro byte da linha.
+ * @param[out] tamanho Bytes da linha.
+ * @return 1 se uma linha foi devolvida, 0 no fim do texto.
+ */
+int proxima_linha(LEITOR_LINHAS* leitor, const char** linha, size_t* tamanho);
+
+/**
+ * @brief Interpreta uma linha do arquivo texto, sem modificá-la.
+ *
+ * Espaços ao redor dos campos são ignorados e campos de texto maiores que o LIVRO são
+ * truncados. Os números passam por converter_size_t() e converter_preco() (utils.h), então o
+ * preço aceita vírgula ou ponto como separador decimal.
+ *
+ * @param linha Primeiro byte da linha (não precisa de terminador nulo).
+ * @param tamanho Bytes da linha.
+ * @param[out] livro Livro preenchido.
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO se faltar algum campo ou um campo numérico for
+ *         inválido, ou ERRO_CAMPO_TRUNCADO se um campo de texto não couber (o livro fica
+ *         preenchido com o campo truncado).
+ */
+int interpretar_livro(const char* linha, size_t tamanho, LIVRO* livro);
+
+/**
+ * @brief Motivo de rejeição correspondente ao status de interpretar_livro() ou da gravação.
+ */
+MOTIVO_REJEICAO motivo_rejeicao(int status);
+
+/**
+ * @brief Nome curto do motivo ("repetido", "formato", "truncado" ou "gravacao").
+ */
+const char* nome_motivo_rejeicao(MOTIVO_REJEICAO motivo);
+
+/**
+ * @brief Acrescenta uma linha rejeitada à lista.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+int adicionar_rejeitada(LISTA_REJEITADAS* lista, const char* linha, size_t tamanho,
+                        MOTIVO_REJEICAO motivo);
+
+/**
+ * @brief Preenche `rejeitados` e `por_motivo` do relatório a partir da lista.
+ */
+void contabilizar_rejeitadas(const LISTA_REJEITADAS* lista, RELATORIO_IMPORTACAO* relatorio);
+
+/**
+ * @brief Grava as linhas rejeitadas, com o número de cada uma, num único fluxo bufferizado.
+ *
+ * A lista é ordenada pela posição no texto e os números de linha são obtidos contando as
+ * quebras numa só passada, até a última linha rejeitada. Com a lista vazia, nenhum arquivo é
+ * criado.
+ *
+ * @param caminho Caminho do arquivo de rejeitadas (sobrescrito).
+ * @param texto Texto de onde as linhas vieram.
+ * @param lista Linhas rejeitadas; é reordenada.
+ * @return SUCESSO, ERRO_ARQUIVO_TEXTO se o arquivo não puder ser criado, ERRO_ARQUIVO_WRITE ou
+ *         ERRO_MEMORIA.
+ */
+int gravar_rejeitadas(const char* caminho, const TEXTO_MAPEADO* texto, LISTA_REJEITADAS* lista);
+
+/**
+ * @brief Libera os itens da lista e a deixa vazia.
+ */
+void liberar_rejeitadas(LISTA_REJEITADAS* lista);
+
+/**
+ * @brief Imprime as rejeições por motivo, numa linha.
+ */
+void imprimir_rejeicoes(FILE* saida, const RELATORIO_IMPORTACAO* relatorio);
+
+/**
+ * @brief Importa todas as linhas do arquivo texto.
+ *
+ * Linhas em branco são ignoradas; linhas mal formadas e livros recusados por `cadastrar`
+ * contam como rejeitados e não interrompem a importação.
+ *
+ * @param caminho Caminho do arquivo texto.
+ * @param arquivo Arquivo binário de livros, repassado a `cadastrar`.
+ * @param cadastrar Função que grava cada livro.
+ * @param rejeitadas Caminho do arquivo de linhas rejeitadas (NULL para não gravá-lo).
+ * @param[out] relatorio Contadores da importação (opcional).
+ * @return SUCESSO, os erros de mapear_texto(), ERRO_MEMORIA ou os de gravar_rejeitadas(); o
+ *         relatório é preenchido mesmo se só a gravação das rejeitadas falhar.
+ */
+int importar_texto(const char* caminho, FILE* arquivo, CADASTRO_LIVRO cadastrar,
+                   const char* rejeitadas, RELATORIO_IMPORTACAO* relatorio);
+
+/**
+ * @brief Interpreta todas as linhas do arquivo texto sem gravar nada.
+ *
+ * Mede a vazão do leitor isoladamente: `relatorio->cadastrados` conta as linhas válidas e os
+ * códigos repetidos não são detectados.
+ *
+ * @return SUCESSO, ou os erros de mapear_texto().
+ */
+int analisar_texto(const char* caminho, RELATORIO_IMPORTACAO* relatorio);
+
+#endif  // IMPORTACAO_H
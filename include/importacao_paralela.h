@@ -0,0 +1,72 @@
+/**
+ * @file importacao_paralela.h
+ * @brief Importação do arquivo texto em pipeline: leitura paralela, ordenação, intercalação e
+ * gravação ordenada.
+ *
+ * Etapas:
+ *  1. o texto mapeado (importacao.h) é dividido em N partes, cortadas em fins de linha;
+ *  2. N threads interpretam as partes; a cada REGISTROS_POR_CORRIDA livros, a thread os
+ *     ordena por código e grava-os como uma corrida no seu arquivo temporário (tmpfile());
+ *  3. as corridas são intercaladas (k-way merge) num outro temporário, descartando códigos
+ *     repetidos;
+ *  4. uma única etapa de gravação lê os livros em ordem desse temporário. Com a árvore vazia,
+ *     ela é construída já balanceada por construir_arvore_em_bloco() (arvore.h), numa escrita
+ *     sequencial; caso contrário, os livros são inseridos na ordem em que
+ *     a árvore balanceada dos novos códigos seria percorrida por níveis, para não degenerar.
+ *
+ * Os livros não ficam todos em memória: cada thread guarda só a corrida em formação, e a
+ * intercalação, alguns registros de cada corrida (cerca de 1/256 dos livros interpretados).
+ * Os temporários ocupam no disco cerca de duas vezes os livros interpretados. As linhas
+ * rejeitadas em qualquer etapa (mal formadas, com campo truncado, repetidas ou recusadas na
+ * gravação) são reunidas numa lista e gravadas de uma vez no fim, com gravar_rejeitadas().
+ */
+
+#ifndef IMPORTACAO_PARALELA_H
+#define IMPORTACAO_PARALELA_H
+
+#include <stdio.h>
+
+#include "importacao.h"
+
+/** Limite de threads de interpretação. */
+#define MAXIMO_THREADS_IMPORTACAO 64
+
+/** Livros que uma thread de interpretação ordena em memória antes de gravá-los no disco. */
+#define REGISTROS_POR_CORRIDA 4096
+
+/**
+ * Resultado de uma importação em pipeline.
+ */
+typedef struct {
+        RELATORIO_IMPORTACAO totais;  /**< Contadores e tempo total. */
+        int threads;                  /**< Threads usadas na interpretação. */
+        int construcao_em_bloco;      /**< 1 se a árvore foi construída de uma vez. */
+        double segundos_analise;      /**< Divisão, interpretação e ordenação dos lotes. */
+        double segundos_intercalacao; /**< Intercalação dos lotes. */
+        double segundos_gravacao;     /**< Gravação na árvore. */
+} RELATORIO_PIPELINE;
+
+/**
+ * @brief Importa o arquivo texto com o pipeline paralelo.
+ *
+ * O chamador deve segurar a trava de escrita do arquivo (concorrencia.h). Com o modo
+ * copy-on-write ativo, as inserções usam inserir_no_arvore_cow().
+ *
+ * @param caminho Caminho do arquivo texto.
+ * @param arquivo Arquivo binário de livros.
+ * @param threads Threads de interpretação (0 usa uma por CPU).
+ * @param rejeitadas Caminho do arquivo de linhas rejeitadas (NULL para não gravá-lo).
+ * @param[out] relatorio Contadores e tempos por etapa (opcional).
+ * @return SUCESSO, ERRO_MEMORIA, os erros de mapear_texto(), os de gravar_rejeitadas(),
+ *         ERRO_ARQUIVO_READ/ERRO_ARQUIVO_WRITE dos temporários ou, na construção em bloco,
+ *         erros de leitura e gravação do arquivo binário.
+ */
+int importar_texto_paralelo(const char* caminho, FILE* arquivo, int threads,
+                            const char* rejeitadas, RELATORIO_PIPELINE* relatorio);
+
+/**
+ * @brief Imprime os contadores, a vazão de cada etapa e, se houver, as rejeições por motivo.
+ */
+void imprimir_relatorio_pipeline(FILE* saida, const RELATORIO_PIPELINE* relatorio);
+
+#endif  // IMPORTACAO_PARALELA_H
@@ -0,0 +1,158 @@
+/**
+ * @file indice.h
+ * @brief Índice hash persistente de código para posição do nó, para buscas pontuais sem descer
+ * a árvore.
+ *
+ * O índice usa hashing extensível: os códigos ficam em baldes de TAMANHO_PAGINA_INDICE bytes,
+ * e um diretório de 2^profundidade_global entradas, mantido em memória, aponta cada prefixo do
+ * hash para o seu balde. Um balde cheio se divide em dois, e o diretório só dobra quando o
+ * balde dividido já usava todos os bits do prefixo; por isso uma busca lê no máximo uma página.
+ *
+ * O índice é associado a um handle do arquivo de livros por abrir_indice() e fica ao lado dele,
+ * em `<caminho>SUFIXO_INDICE`. Enquanto associado, buscar_no_arvore() (arvore.h) consulta o
+ * índice antes de descer a árvore, e as operações que gravam nós (inserção, remoção, as versões
+ * copy-on-write e a construção em bloco) o mantêm atualizado. A árvore continua sendo a fonte
+ * de verdade: percursos, intervalos e a inserção, que precisa do pai, descem por ela.
+ *
+ * O arquivo do índice é marcado como sujo na abertura e como limpo, junto com a identidade do
+ * arquivo de livros (IDENTIDADE_ARQUIVO, arquivo.h), em fechar_indice(). Se na abertura ele
+ * estiver sujo (o processo caiu com o índice aberto) ou a identidade não conferir, o índice é
+ * refeito pela árvore. Como no filtro (filtro.h), a associação vale só enquanto o chamador
+ * segura a trava do arquivo: abra o índice depois de travar e feche-o antes de destravar.
+ */
+
+#ifndef INDICE_H
+#define INDICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arquivo.h"
+
+/** Sufixo do arquivo do índice, acrescentado ao caminho do arquivo de livros. */
+#define SUFIXO_INDICE ".hash"
+
+/** Identifica o arquivo do índice ("INDX" em little-endian). */
+#define MAGICA_INDICE 0x58444E49u
+
+/** Versão do formato do arquivo do índice. */
+#define VERSAO_INDICE 1u
+
+/** Tamanho de cada página do arquivo do índice (cabeçalho e baldes). */
+#define TAMANHO_PAGINA_INDICE 4096
+
+/** Entradas que cabem num balde. */
+#define ENTRADAS_POR_BALDE_INDICE 255
+
+/** Maior profundidade do diretório: 2^24 baldes, ou 64 MB de diretório em memória. */
+#define PROFUNDIDADE_MAXIMA_INDICE 24
+
+/**
+ * Código de livro e a posição do seu nó no arquivo de livros.
+ */
+typedef struct {
+        uint64_t codigo; /**< Código do livro. */
+        int64_t posicao; /**< Posição do nó. */
+} ENTRADA_INDICE;
+
+/**
+ * Balde do índice, ocupando exatamente uma página.
+ */
+typedef struct {
+        uint32_t quantidade;                                /**< Entradas ocupadas. */
+        uint32_t profundidade_local;                        /**< Bits do hash comuns ao balde. */
+        uint64_t reservado;                                 /**< Zero. */
+        ENTRADA_INDICE entradas[ENTRADAS_POR_BALDE_INDICE]; /**< Entradas, sem ordem. */
+} BALDE_INDICE;
+
+_Static_assert(sizeof(BALDE_INDICE) == TAMANHO_PAGINA_INDICE, "balde deve ocupar uma página");
+
+/**
+ * Cabeçalho do arquivo do índice, no início da página 0.
+ *
+ * Os baldes ocupam as páginas 1 a `baldes`; o diretório, com 2^profundidade_global números de
+ * página de 32 bits, vem logo depois do último balde.
+ */
+typedef struct {
+        uint32_t magica;              /**< MAGICA_INDICE. */
+        uint32_t versao;              /**< VERSAO_INDICE. */
+        uint32_t profundidade_global; /**< Bits do hash usados pelo diretório. */
+        uint32_t limpo;               /**< 1 se o arquivo foi fechado por fechar_indice(). */
+        uint64_t baldes;              /**< Baldes gravados. */
+        uint64_t entradas;            /**< Códigos no índice. */
+        IDENTIDADE_ARQUIVO livros;    /**< Arquivo de livros no fechamento. */
+} CABECALHO_INDICE;
+
+/**
+ * Situação de um índice associado.
+ */
+typedef struct {
+        size_t entradas;           /**< Códigos no índice. */
+        size_t baldes;             /**< Baldes no arquivo do índice. */
+        unsigned profundidade;     /**< Profundidade global do diretório. */
+        size_t divisoes;           /**< Baldes divididos desde a abertura. */
+        size_t leituras_de_pagina; /**< Páginas lidas do arquivo do índice desde a abertura. */
+        size_t reconstrucoes;      /**< Reconstruções a partir da árvore desde a abertura. */
+} ESTADO_INDICE;
+
+/**
+ * @brief Associa um índice ao handle, abrindo o arquivo do índice ou refazendo-o pela árvore.
+ *
+ * @param arquivo Arquivo binário da árvore, já travado pelo chamador.
+ * @param caminho Caminho do arquivo de livros (o índice fica em `caminho` + SUFIXO_INDICE).
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_WRITE, ERRO_CABECALHO_NULO, ERRO_MEMORIA ou
+ *         erros do percurso.
+ */
+int abrir_indice(FILE* arquivo, const char* caminho);
+
+/**
+ * @brief Grava o diretório e o cabeçalho do índice e desfaz a associação.
+ *
+ * Não faz nada se o handle não tiver índice associado. Um índice que deixou de ser mantido
+ * (falha de escrita ou de memória durante a associação) tem o arquivo apagado.
+ *
+ * @param arquivo Handle passado a abrir_indice().
+ * @return SUCESSO ou ERRO_ARQUIVO_WRITE (a associação é desfeita mesmo em caso de erro).
+ */
+int fechar_indice(FILE* arquivo);
+
+/**
+ * @brief Procura a posição do nó de um código no índice associado ao handle.
+ *
+ * @param arquivo Arquivo binário da árvore.
+ * @param codigo Código procurado.
+ * @param[out] posicao Posição do nó, se encontrado.
+ * @return SUCESSO se o código está no índice; ERRO_NO_NULO se certamente não está na árvore;
+ *         ERRO_ARQUIVO_NULO se o handle não tiver um índice em condições de responder.
+ */
+int buscar_no_indice(FILE* arquivo, size_t codigo, int* posicao);
+
+/**
+ * @brief Registra (ou atualiza) a posição do nó de um código no índice associado, se houver.
+ *
+ * Se a gravação falhar, o índice deixa de responder até ser fechado, e seu arquivo é apagado.
+ */
+void registrar_posicao_no_indice(FILE* arquivo, size_t codigo, int posicao);
+
+/**
+ * @brief Retira um código do índice associado ao handle, se houver.
+ */
+void remover_do_indice(FILE* arquivo, size_t codigo);
+
+/**
+ * @brief Refaz o índice associado ao handle a partir dos nós da árvore.
+ *
+ * @return SUCESSO (também sem índice associado), ERRO_CABECALHO_NULO, ERRO_MEMORIA,
+ *         ERRO_ARQUIVO_WRITE ou erros do percurso.
+ */
+int reconstruir_indice(FILE* arquivo);
+
+/**
+ * @brief Lê a situação do índice associado ao handle.
+ *
+ * @return SUCESSO, ou ERRO_ARQUIVO_NULO se o handle não tiver índice.
+ */
+int consultar_indice(FILE* arquivo, ESTADO_INDICE* estado);
+
+#endif  // INDICE_H
@@ -0,0 +1,76 @@
+/**
+ * @file instantaneo.h
+ * @brief Instantâneo binário do catálogo, para copiá-lo entre máquinas sem passar por texto.
+ *
+ * Formato:
+ *  1. CABECALHO_INSTANTANEO, com a quantidade de livros e uma soma de verificação própria;
+ *  2. os livros (LIVRO, sem os ponteiros da árvore), em ordem crescente de código;
+ *  3. RODAPE_INSTANTANEO, com a quantidade repetida e a soma de verificação dos livros.
+ *
+ * A soma dos livros fica no rodapé para que a exportação seja uma única escrita sequencial,
+ * sem voltar ao início; assim o destino pode ser um pipe. Os registros são gravados como estão
+ * na memória: o instantâneo só é restaurado numa máquina com o mesmo sizeof(LIVRO) e a mesma
+ * ordem de bytes (conferidos pelo cabeçalho).
+ */
+
+#ifndef INSTANTANEO_H
+#define INSTANTANEO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define MAGICA_INSTANTANEO 0x54534E49u  //!< "INST" em little-endian
+#define VERSAO_INSTANTANEO 1u
+#define LIVROS_POR_BLOCO_INSTANTANEO 1024  //!< Registros por fread()/fwrite()
+
+/**
+ * Cabeçalho gravado no início do instantâneo.
+ */
+typedef struct {
+        uint32_t magica;            /**< Deve ser MAGICA_INSTANTANEO. */
+        uint32_t versao;            /**< Versão do formato. */
+        uint32_t tamanho_registro;  /**< sizeof(LIVRO) na máquina que exportou. */
+        uint32_t reservado;         /**< Zero. */
+        uint64_t quantidade_livros; /**< Registros que seguem o cabeçalho. */
+        uint64_t soma_cabecalho;    /**< Soma de verificação dos campos anteriores. */
+} CABECALHO_INSTANTANEO;
+
+/**
+ * Rodapé gravado depois do último registro.
+ */
+typedef struct {
+        uint64_t quantidade_livros; /**< Igual à do cabeçalho. */
+        uint64_t soma_livros;       /**< Soma de verificação de todos os registros. */
+} RODAPE_INSTANTANEO;
+
+/**
+ * @brief Grava o instantâneo do catálogo, percorrendo a árvore em ordem.
+ *
+ * O chamador deve segurar a trava de leitura do arquivo (concorrencia.h).
+ *
+ * @param arquivo Arquivo binário da árvore, aberto para leitura.
+ * @param destino Destino do instantâneo, aberto para escrita binária (pode ser um pipe).
+ * @param[out] exportados Livros gravados (opcional).
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO, ERRO_ARQUIVO_WRITE, ERRO_MEMORIA,
+ *         erros do percurso da árvore, ou ERRO_FORMATO_INSTANTANEO se a árvore não tiver a
+ *         quantidade de livros do cabeçalho.
+ */
+int exportar_instantaneo(FILE* arquivo, FILE* destino, size_t* exportados);
+
+/**
+ * @brief Restaura um instantâneo num catálogo vazio, com construir_arvore_em_bloco() (arvore.h).
+ *
+ * Os registros são lidos em sequência e gravados em sequência, já como árvore balanceada. A soma
+ * de verificação e a ordem dos códigos são conferidas durante a leitura; o cabeçalho do catálogo
+ * só é gravado se tudo conferir, então um instantâneo corrompido deixa o catálogo vazio.
+ *
+ * @param origem Instantâneo aberto para leitura binária (pode ser um pipe).
+ * @param arquivo Arquivo binário da árvore, vazio e aberto em modo leitura/escrita ("rb+").
+ * @param[out] restaurados Livros restaurados (opcional).
+ * @return SUCESSO, ERRO_FORMATO_INSTANTANEO (cabeçalho inválido, arquivo truncado ou códigos
+ *         fora de ordem), ERRO_SOMA_INSTANTANEO, ou os erros de construir_arvore_em_bloco().
+ */
+int restaurar_instantaneo(FILE* origem, FILE* arquivo, size_t* restaurados);
+
+#endif  // INSTANTANEO_H
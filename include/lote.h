@@ -0,0 +1,44 @@
+/**
+ * @file lote.h
+ * @brief Modo em lote: executa comandos de um arquivo (ou da entrada padrão) sem o menu.
+ *
+ * Cada linha é um comando:
+ *
+ * | Comando                                                         | Efeito                    |
+ * |-----------------------------------------------------------------|---------------------------|
+ * | `add codigo;titulo;autor;editora;edicao;ano;exemplares;preco`   | cadastra o livro          |
+ * | `get CODIGO`                                                    | imprime o livro na saída  |
+ * | `del CODIGO`                                                    | remove o livro            |
+ * | `load CAMINHO`                                                  | importa um arquivo texto* |
+ * | `export CAMINHO`                                                | exporta o catálogo**      |
+ * | `stats`                                                         | imprime contadores        |
+ * | `health`                                                        | diagnóstico em JSON***    |
+ *
+ * (*) As linhas rejeitadas vão para `CAMINHO.rejeitados` (importacao.h).
+ * (**) Em JSON Lines se `CAMINHO` terminar em `.json` ou `.jsonl`, senão em CSV (exportacao.h).
+ * (***) Forma da árvore e uso do arquivo, numa linha (diagnostico.h).
+ *
+ * Linhas vazias e começadas por `#` são ignoradas. Os resultados vão para a saída informada
+ * (bufferizada pelo chamador) e os erros para stderr, com o número da linha.
+ */
+
+#ifndef LOTE_H
+#define LOTE_H
+
+#include <stdio.h>
+
+/**
+ * @brief Executa todos os comandos de `comandos` sobre um único handle do arquivo de livros.
+ *
+ * O arquivo fica travado para escrita (concorrencia.h) durante todo o lote.
+ *
+ * @param comandos Arquivo de comandos, um por linha.
+ * @param caminho_livros Caminho do arquivo binário de livros.
+ * @param saida Destino dos resultados de `get`, `load`, `export`, `stats` e `health`.
+ * @param parar_no_erro Se diferente de zero, para no primeiro comando que falhar.
+ * @return SUCESSO se todos os comandos tiveram sucesso; caso contrário, o código do primeiro
+ *         erro (ERRO_ARQUIVO_NULO ou ERRO_TRAVA se o arquivo de livros não puder ser usado).
+ */
+int executar_lote(FILE* comandos, const char* caminho_livros, FILE* saida, int parar_no_erro);
+
+#endif  // LOTE_H
@@ -94,4 +94,87 @@ int opcao_carregar_txt(const char* caminho);
  */
 int opcao_imprimir_arvore_por_niveis(const char* caminho);
 
+/**
+ * @brief Grava o catálogo compactado (dados frios) a partir do arquivo binário de livros.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @param caminho_compactado Caminho do catálogo compactado que será (re)criado.
+ * @return int Código de status da operação.
+ */
+int opcao_compactar_catalogo(const char* caminho, const char* caminho_compactado);
+
+/**
+ * @brief Lista em ordem de código todos os livros do catálogo compactado.
+ *
+ * Lê só o catálogo, uma exportação somente leitura (catalogo_compactado.h); se ele tiver sido
+ * gerado antes da última escrita no arquivo de livros, a listagem é recusada e o catálogo
+ * deve ser gerado de novo com opcao_compactar_catalogo(). Ao final, informa quantos bytes
+ * foram lidos do disco e quantos bytes os mesmos livros ocupariam sem compressão.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @param caminho_compactado Caminho do catálogo compactado.
+ * @return int SUCESSO, ERRO_ARQUIVO_NULO, ERRO_FORMATO_COMPACTADO se o catálogo não existir
+ *         ou for inválido, ERRO_COMPACTADO_ANTIGO ou erros da leitura.
+ */
+int opcao_listar_catalogo_compactado(const char* caminho, const char* caminho_compactado);
+
+/**
+ * @brief Grava o instantâneo binário (instantaneo.h) do arquivo de livros.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @param caminho_instantaneo Caminho do instantâneo que será (re)criado.
+ * @return int Código de status da operação.
+ */
+int opcao_exportar_instantaneo(const char* caminho, const char* caminho_instantaneo);
+
+/**
+ * @brief Substitui o arquivo de livros pelo conteúdo de um instantâneo.
+ *
+ * O instantâneo é restaurado num arquivo novo ao lado do atual, que só é trocado (com rename())
+ * depois de a soma de verificação conferir; em caso de erro, o arquivo atual fica intacto.
+ *
+ * @param caminho Caminho do arquivo binário de livros.
+ * @param caminho_instantaneo Caminho do instantâneo.
+ * @return int Código de status da operação.
+ */
+int opcao_restaurar_instantaneo(const char* caminho, const char* caminho_instantaneo);
+
+/**
+ * @brief Solicita o nome do arquivo de saída e exporta todos os livros, em ordem de código, em
+ * CSV (formato da importação) ou JSON Lines, conforme a extensão.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @return int Código de status da operação.
+ */
+int opcao_exportar_texto(const char* caminho);
+
+/**
+ * @brief Mostra os contadores de E/S e as latências das operações desde o início do programa
+ * (estatisticas.h), em texto ou JSON, e oferece zerá-los.
+ *
+ * @return int Código de status da operação.
+ */
+int opcao_exibir_estatisticas(void);
+
+/**
+ * @brief Mostra a forma da árvore e o uso do arquivo de livros (diagnostico.h), em texto ou
+ * JSON.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @return int Código de status da operação.
+ */
+int opcao_diagnosticar_arvore(const char* caminho);
+
+/**
+ * @brief Reescreve o arquivo de livros como uma árvore perfeitamente balanceada
+ * (rebalanceamento.h) e mostra a altura antes e depois.
+ *
+ * Antes, avisa que o arquivo é trocado por uma cópia: outros processos passam a ela na próxima
+ * trava, e leituras copy-on-write já abertas continuam no arquivo antigo.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @return int Código de status da operação.
+ */
+int opcao_rebalancear_arquivo(const char* caminho);
+
 #endif  // MENU_H
\ No newline at end of file
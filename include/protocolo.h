@@ -0,0 +1,139 @@
+/**
+ * @file protocolo.h
+ * @brief Protocolo binário entre o servidor de consultas e seus clientes.
+ *
+ * Cada pedido é um CABECALHO_PEDIDO seguido de `tamanho` bytes de carga; cada resposta é um
+ * CABECALHO_RESPOSTA seguido de `tamanho` bytes. O servidor responde aos pedidos de uma conexão
+ * na ordem em que chegaram, repetindo o `id` do pedido, então o cliente pode enviar vários
+ * pedidos de uma vez (pipelining) e ler as respostas depois.
+ *
+ * O transporte é um socket de domínio Unix, portanto cliente e servidor estão na mesma máquina:
+ * os inteiros seguem a ordem de bytes do host e o LIVRO trafega com o mesmo layout gravado em
+ * livros.bin.
+ *
+ * | Operação            | Carga do pedido | Carga da resposta (status SUCESSO)       |
+ * |---------------------|-----------------|------------------------------------------|
+ * | PEDIDO_BUSCAR       | uint64_t codigo | LIVRO                                    |
+ * | PEDIDO_INSERIR      | LIVRO           | vazia                                    |
+ * | PEDIDO_REMOVER      | uint64_t codigo | vazia                                    |
+ * | PEDIDO_INTERVALO    | DADOS_INTERVALO | uint32_t quantidade + LIVRO[quantidade]  |
+ * | PEDIDO_ESTATISTICAS | vazia           | ESTATISTICAS_SERVIDOR                    |
+ *
+ * Um pedido com operação desconhecida ou carga de tamanho errado recebe status ERRO_PROTOCOLO;
+ * uma carga maior que TAMANHO_MAXIMO_CARGA encerra a conexão.
+ */
+
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TAMANHO_MAXIMO_CARGA (1u << 20)  //!< Maior carga aceita em um pedido ou resposta
+#define LIMITE_INTERVALO 1024            //!< Máximo de livros devolvidos por PEDIDO_INTERVALO
+
+/**
+ * @enum operacao_protocolo
+ * @brief Operações aceitas pelo servidor.
+ */
+typedef enum {
+        PEDIDO_BUSCAR = 1,      /**< Busca um livro pelo código. */
+        PEDIDO_INSERIR = 2,     /**< Cadastra um livro. */
+        PEDIDO_REMOVER = 3,     /**< Remove um livro pelo código. */
+        PEDIDO_INTERVALO = 4,   /**< Lista os livros com código em um intervalo. */
+        PEDIDO_ESTATISTICAS = 5 /**< Devolve contadores do servidor. */
+} operacao_protocolo;
+
+/**
+ * Cabeçalho de um pedido.
+ */
+typedef struct {
+        uint32_t id;        /**< Identificador escolhido pelo cliente, repetido na resposta. */
+        uint16_t operacao;  /**< Um valor de operacao_protocolo. */
+        uint16_t reservado; /**< Sempre zero. */
+        uint32_t tamanho;   /**< Bytes de carga que seguem o cabeçalho. */
+} CABECALHO_PEDIDO;
+
+/**
+ * Cabeçalho de uma resposta.
+ */
+typedef struct {
+        uint32_t id;      /**< `id` do pedido respondido. */
+        int32_t status;   /**< SUCESSO ou um codigo_erro. */
+        uint32_t tamanho; /**< Bytes de carga que seguem o cabeçalho. */
+} CABECALHO_RESPOSTA;
+
+/**
+ * Carga de PEDIDO_INTERVALO.
+ */
+typedef struct {
+        uint64_t inicio;    /**< Menor código incluído. */
+        uint64_t fim;       /**< Maior código incluído. */
+        uint32_t limite;    /**< Máximo de livros pedidos (limitado a LIMITE_INTERVALO). */
+        uint32_t reservado; /**< Sempre zero. */
+} DADOS_INTERVALO;
+
+/**
+ * Carga da resposta de PEDIDO_ESTATISTICAS.
+ */
+typedef struct {
+        uint64_t quantidade_livros; /**< Livros na árvore no momento do pedido. */
+        uint64_t conexoes_ativas;   /**< Clientes conectados. */
+        uint64_t conexoes_aceitas;  /**< Clientes atendidos desde o início. */
+        uint64_t pedidos_atendidos; /**< Pedidos respondidos desde o início. */
+        uint64_t pedidos_com_erro;  /**< Pedidos respondidos com status diferente de SUCESSO. */
+} ESTATISTICAS_SERVIDOR;
+
+/**
+ * Buffer de bytes que cresce conforme necessário, consumido a partir de `inicio`.
+ */
+typedef struct {
+        unsigned char* dados; /**< Área alocada. */
+        size_t inicio;        /**< Primeiro byte ainda não consumido. */
+        size_t tamanho;       /**< Fim dos bytes válidos. */
+        size_t capacidade;    /**< Bytes alocados. */
+} BUFFER_BYTES;
+
+/**
+ * @brief Garante espaço para mais `quantidade` bytes no fim do buffer.
+ *
+ * Antes de realocar, descarta os bytes já consumidos movendo o restante para o início.
+ *
+ * @param buffer Buffer a ampliar.
+ * @param quantidade Bytes que serão acrescentados.
+ * @return Ponteiro para o fim dos bytes válidos, ou NULL se faltar memória.
+ */
+unsigned char* reservar_buffer(BUFFER_BYTES* buffer, size_t quantidade);
+
+/**
+ * @brief Acrescenta bytes ao fim do buffer.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+int acrescentar_buffer(BUFFER_BYTES* buffer, const void* dados, size_t quantidade);
+
+/**
+ * @brief Quantidade de bytes ainda não consumidos.
+ */
+size_t pendentes_buffer(const BUFFER_BYTES* buffer);
+
+/**
+ * @brief Marca `quantidade` bytes do início como consumidos.
+ */
+void consumir_buffer(BUFFER_BYTES* buffer, size_t quantidade);
+
+/**
+ * @brief Libera a memória do buffer e o deixa vazio.
+ */
+void liberar_buffer(BUFFER_BYTES* buffer);
+
+/**
+ * @brief Informa o tamanho de carga que um pedido da operação deve ter.
+ *
+ * @param operacao Operação do pedido.
+ * @param[out] tamanho Tamanho exigido.
+ * @return SUCESSO, ou ERRO_PROTOCOLO se a operação for desconhecida.
+ */
+int tamanho_carga_pedido(uint16_t operacao, uint32_t* tamanho);
+
+#endif  // PROTOCOLO_H
@@ -0,0 +1,102 @@
+/**
+ * @file rastro.h
+ * @brief Rastro binário das operações da árvore, para reproduzir depois uma carga real.
+ *
+ * Com o rastro aberto, cada operação medida por estatisticas.h (cadastro, inserção, busca,
+ * remoção e percurso em ordem) grava ao concluir um REGISTRO_RASTRO com a operação, o código,
+ * o status, a duração e os nós lidos e gravados. Só a operação mais externa é registrada,
+ * como nas estatísticas; compilado sem ESTATISTICAS, o rastro fica vazio.
+ *
+ * O arquivo tem tamanho fixo: CABECALHO_RASTRO seguido de `capacidade` registros usados como
+ * um anel, em que o registro de sequência `s` ocupa a posição `(s - 1) % capacidade`. Ele é
+ * mapeado em memória, de modo que gravar um registro não faz chamada de sistema, e o que foi
+ * gravado sobrevive à queda do processo. Posições nunca usadas têm sequência 0.
+ *
+ * A ferramenta tools/reproduzir_rastro.c executa um rastro sobre uma cópia do arquivo de
+ * livros e compara as durações.
+ */
+
+#ifndef RASTRO_H
+#define RASTRO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAGICA_RASTRO 0x54534152u  //!< "RAST" em little-endian
+#define VERSAO_RASTRO 1u
+#define REGISTROS_RASTRO_PADRAO (1u << 20)  //!< 40 MB de anel
+
+/**
+ * Cabeçalho no início do arquivo do rastro.
+ */
+typedef struct {
+        uint32_t magica;     /**< MAGICA_RASTRO. */
+        uint32_t versao;     /**< VERSAO_RASTRO. */
+        uint64_t capacidade; /**< Registros no anel. */
+        uint64_t gravados;   /**< Registros gravados até fechar_rastro() (0 se não fechado). */
+} CABECALHO_RASTRO;
+
+/**
+ * Uma operação concluída.
+ */
+typedef struct {
+        uint64_t sequencia;  /**< Ordem de conclusão, a partir de 1; 0 em posição vazia. */
+        uint64_t codigo;     /**< Código do livro (0 no percurso). */
+        uint64_t inicio_us;  /**< Início, em microssegundos desde abrir_rastro(). */
+        uint32_t duracao_ns; /**< Duração, saturada em UINT32_MAX (cerca de 4 s). */
+        uint32_t leituras;   /**< Nós lidos. */
+        uint32_t escritas;   /**< Nós gravados. */
+        uint8_t operacao;    /**< OPERACAO_ESTATISTICA. */
+        int8_t status;       /**< Código de retorno (erros.h). */
+        uint16_t reservado;  /**< Zero. */
+} REGISTRO_RASTRO;
+
+_Static_assert(sizeof(REGISTRO_RASTRO) == 40, "registro do rastro deve ter 40 bytes");
+
+/**
+ * @brief Cria (ou sobrescreve) o arquivo do rastro e passa a registrar as operações.
+ *
+ * Um rastro já aberto é fechado antes.
+ *
+ * @param caminho Caminho do arquivo do rastro.
+ * @param capacidade Registros no anel (0 para REGISTROS_RASTRO_PADRAO).
+ * @return SUCESSO, ERRO_ARQUIVO_NULO se o arquivo não puder ser criado, ERRO_ARQUIVO_WRITE ou
+ *         ERRO_MEMORIA se não puder ser mapeado.
+ */
+int abrir_rastro(const char* caminho, size_t capacidade);
+
+/**
+ * @brief Para de registrar, grava o total no cabeçalho e desfaz o mapeamento.
+ *
+ * Chame depois que as operações em andamento terminarem. Não faz nada sem rastro aberto.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_WRITE.
+ */
+int fechar_rastro(void);
+
+/**
+ * @brief Diz se há um rastro aberto.
+ */
+int rastro_ativo(void);
+
+/**
+ * @brief Grava uma operação concluída no anel, se houver rastro aberto.
+ *
+ * Chamada por estatisticas.c; pode ser chamada de várias threads ao mesmo tempo.
+ *
+ * @param registro Registro a gravar; a sequência e o início relativo são preenchidos aqui.
+ * @param inicio_ns Início da operação, no relógio monotônico, em nanossegundos.
+ */
+void registrar_no_rastro(REGISTRO_RASTRO* registro, uint64_t inicio_ns);
+
+/**
+ * @brief Lê os registros ocupados de um arquivo de rastro, em ordem de sequência.
+ *
+ * @param caminho Caminho do arquivo do rastro.
+ * @param[out] registros Vetor alocado com os registros (liberar com free()).
+ * @param[out] quantidade Registros em `registros`.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_READ, ERRO_MEMORIA ou ERRO_FORMATO_RASTRO.
+ */
+int ler_rastro(const char* caminho, REGISTRO_RASTRO** registros, size_t* quantidade);
+
+#endif  // RASTRO_H
@@ -0,0 +1,84 @@
+/**
+ * @file rebalanceamento.h
+ * @brief Reescreve o arquivo de livros como uma árvore perfeitamente balanceada, fora de linha.
+ *
+ * Arquivos gerados por cadastros em ordem de código viram listas encadeadas, com altura igual à
+ * quantidade de livros. rebalancear_arquivo() os reescreve em O(n), sem recursão sobre a árvore
+ * antiga, com duas leituras sequenciais do arquivo original e uma escrita sequencial da cópia:
+ *
+ * 1. A primeira leitura guarda só os dois filhos de cada posição; o percurso em ordem, feito em
+ *    memória, dá a cada nó vivo a sua ordem (posto) entre os códigos.
+ * 2. Os nós vivos mantêm a ordem física do original, sem as posições livres e perdidas, e os
+ *    filhos de cada um são os da árvore balanceada pelas medianas dos postos, a mesma forma de
+ *    construir_arvore_em_bloco() (arvore.h).
+ * 3. A segunda leitura copia os livros para `<caminho>SUFIXO_REBALANCEAMENTO` na ordem em que
+ *    aparecem, já com os filhos novos; o cabeçalho vai por último, e a cópia substitui o original
+ *    com rename(), de modo que um leitor vê o arquivo antigo ou o novo, nunca uma mistura.
+ *
+ * O mapa das posições, cerca de 16 bytes por posição do original (contra os 464 bytes de cada
+ * nó), fica num arquivo temporário mapeado em memória, que o kernel pode devolver ao disco; os
+ * livros nunca ficam todos em memória. O filtro (filtro.h) e o índice (indice.h)
+ * percebem pela identidade do arquivo que ele mudou e se reconstroem na próxima abertura.
+ *
+ * migrar_arquivo() usa a mesma troca para converter um arquivo do formato da versão 1, sem
+ * páginas (arquivo_formato_v1(), arquivo.h), para o atual.
+ */
+
+#ifndef REBALANCEAMENTO_H
+#define REBALANCEAMENTO_H
+
+#include <stddef.h>
+
+/** Sufixo da cópia em construção, ao lado do arquivo de livros. */
+#define SUFIXO_REBALANCEAMENTO ".rebalanceando"
+
+/** Sufixo do arquivo temporário, já apagado ao ser usado, que guarda o mapa das posições. */
+#define SUFIXO_MAPA_REBALANCEAMENTO ".rebalanceando.mapa"
+
+/** Sufixo da cópia em construção durante a migração do formato. */
+#define SUFIXO_MIGRACAO ".migrando"
+
+/**
+ * Resultado de rebalancear_arquivo().
+ */
+typedef struct {
+        size_t livros;         /**< Livros regravados. */
+        size_t posicoes_antes; /**< Posições do arquivo original. */
+        size_t altura_antes;   /**< Altura da árvore original. */
+        size_t altura_depois;  /**< Altura da árvore balanceada. */
+        double segundos;       /**< Duração total. */
+} RELATORIO_REBALANCEAMENTO;
+
+/**
+ * @brief Reescreve o arquivo de livros como uma árvore perfeitamente balanceada e compacta.
+ *
+ * O arquivo fica travado para escrita (concorrencia.h) do início até a troca, e o diretório é
+ * sincronizado depois do rename(). Handles abertos antes da troca passam ao arquivo novo na
+ * próxima vez que obtêm a trava (travar_arquivo()); quem lê sem ela, como as versões
+ * copy-on-write abertas (versoes.h), continua no arquivo antigo até reabri-lo. Em caso de erro
+ * a cópia é apagada e o original não é alterado.
+ *
+ * @param caminho Caminho do arquivo de livros.
+ * @param[out] relatorio Contagens da reescrita (pode ser NULL).
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO, ERRO_TRAVA, ERRO_MEMORIA, erros de
+ *         leitura e gravação, ou ERRO_NO_NULO se a árvore tiver ligações inválidas.
+ */
+int rebalancear_arquivo(const char* caminho, RELATORIO_REBALANCEAMENTO* relatorio);
+
+/**
+ * @brief Converte um arquivo de livros da versão 1 (sem páginas) para o formato atual.
+ *
+ * Cada nó vai para a mesma posição na cópia, já com a soma de verificação da sua vaga, e o
+ * cabeçalho (raiz, topo, lista livre e quantidade) é mantido; só muda o arranjo no disco. A
+ * cópia é gravada em `<caminho>SUFIXO_MIGRACAO`, sincronizada e trocada pelo original com
+ * rename(), sob a trava de escrita, como em rebalancear_arquivo(). Em caso de erro a cópia é
+ * apagada e o original não é alterado.
+ *
+ * @param caminho Caminho do arquivo de livros.
+ * @param[out] livros Livros do arquivo migrado (pode ser NULL).
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_TRAVA, ERRO_MEMORIA, erros de leitura e gravação, ou
+ *         ERRO_FORMATO_ARQUIVO se o arquivo não for da versão 1 (inclusive se já for do atual).
+ */
+int migrar_arquivo(const char* caminho, size_t* livros);
+
+#endif  // REBALANCEAMENTO_H
@@ -0,0 +1,57 @@
+/**
+ * @file servidor.h
+ * @brief Servidor de consultas sobre um socket de domínio Unix.
+ *
+ * O servidor abre livros.bin uma única vez e atende buscas, cadastros, remoções, consultas por
+ * intervalo e estatísticas usando o protocolo de protocolo.h. Um laço de eventos `epoll` é
+ * compartilhado por várias threads: cada conexão é armada com `EPOLLONESHOT`, então só uma
+ * thread a atende por vez e as respostas saem na ordem dos pedidos.
+ *
+ * Cada thread lê a árvore com o seu próprio `FILE*`, sob trava compartilhada (ou sobre uma
+ * versão, no modo copy-on-write). Escritas passam por um único `FILE*` de escrita.
+ */
+
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#define CAMINHO_SOCKET_PADRAO "livros.sock"  //!< Socket usado quando nenhum é informado
+#define THREADS_SERVIDOR_PADRAO 4            //!< Threads do laço de eventos por padrão
+#define THREADS_SERVIDOR_MAXIMO 1024         //!< Maior valor aceito em `--threads`
+
+/**
+ * Servidor em execução (opaco).
+ */
+typedef struct SERVIDOR SERVIDOR;
+
+/**
+ * @brief Abre o arquivo de livros, cria o socket e inicia as threads do laço de eventos.
+ *
+ * Um socket antigo no mesmo caminho é removido.
+ *
+ * @param caminho_livros Caminho do arquivo binário de livros (já inicializado).
+ * @param caminho_socket Caminho do socket de domínio Unix a criar.
+ * @param quantidade_threads Threads que atendem conexões (no mínimo 1).
+ * @return Servidor em execução, ou NULL em caso de erro.
+ */
+SERVIDOR* iniciar_servidor(const char* caminho_livros, const char* caminho_socket,
+                           int quantidade_threads);
+
+/**
+ * @brief Encerra as threads, fecha as conexões e remove o socket.
+ *
+ * @param servidor Servidor devolvido por iniciar_servidor(); é liberado.
+ */
+void parar_servidor(SERVIDOR* servidor);
+
+/**
+ * @brief Executa o servidor até receber SIGINT ou SIGTERM.
+ *
+ * @param caminho_livros Caminho do arquivo binário de livros.
+ * @param caminho_socket Caminho do socket de domínio Unix.
+ * @param quantidade_threads Threads que atendem conexões.
+ * @return SUCESSO, ou ERRO_CONEXAO se o servidor não puder ser iniciado.
+ */
+int executar_servidor(const char* caminho_livros, const char* caminho_socket,
+                      int quantidade_threads);
+
+#endif  // SERVIDOR_H
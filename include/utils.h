@@ -8,6 +8,7 @@
 #define UTILS_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief Limpa a tela do terminal.
@@ -52,6 +53,34 @@ int ler_size_t_com_zero(size_t* saida);
  */
 double ler_double(void);
 
+/**
+ * @brief Converte um inteiro sem sinal escrito só com dígitos decimais.
+ *
+ * Não aceita sinal, espaços nem qualquer outro caractere, e rejeita valores que não cabem em
+ * size_t. Não depende de terminador nulo nem do locale.
+ *
+ * @param texto Primeiro caractere do número.
+ * @param tamanho Quantidade de caracteres.
+ * @param[out] valor Valor convertido (só alterado em caso de sucesso).
+ * @return int 1 se o texto é um número válido, 0 caso contrário.
+ */
+int converter_size_t(const char* texto, size_t tamanho, size_t* valor);
+
+/**
+ * @brief Converte um preço decimal não negativo, com vírgula ou ponto como separador.
+ *
+ * Aceita `123`, `123,45`, `123.45`, `,5` e `12.`; rejeita sinal, expoente, espaços, mais de
+ * um separador e partes inteiras com mais de 19 algarismos. Casas decimais além de 19
+ * algarismos significativos (ou da 22ª casa) são desprezadas; com até 15 algarismos o
+ * resultado é o double mais próximo. Não depende de terminador nulo nem do locale.
+ *
+ * @param texto Primeiro caractere do número.
+ * @param tamanho Quantidade de caracteres.
+ * @param[out] valor Valor convertido (só alterado em caso de sucesso).
+ * @return int 1 se o texto é um preço válido, 0 caso contrário.
+ */
+int converter_preco(const char* texto, size_t tamanho, double* valor);
+
 /**
  * @brief Remove espaços em branco no início e no fim de uma string.
  *
@@ -59,4 +88,27 @@ double ler_double(void);
  */
 void trim(char* str);
 
+/**
+ * @brief Espalha os bits de um código de livro por todo o resultado (finalizador do
+ * splitmix64), para que códigos sequenciais caiam em posições independentes de uma tabela.
+ *
+ * @param codigo Código do livro.
+ * @return Hash de 64 bits do código.
+ */
+uint64_t espalhar_codigo(size_t codigo);
+
+/**
+ * @brief Segundos de um relógio monotônico, para medir durações.
+ *
+ * @return Instante atual em segundos, a partir de uma origem arbitrária.
+ */
+double agora(void);
+
+/**
+ * @brief Nanossegundos do mesmo relógio de agora(), para durações curtas e histogramas.
+ *
+ * @return Instante atual em nanossegundos, a partir de uma origem arbitrária.
+ */
+uint64_t agora_ns(void);
+
 #endif  // UTILS_H
@@ -0,0 +1,67 @@
+/**
+ * @file varredura.h
+ * @brief Busca vetorizada de delimitadores e espaços no texto de importação.
+ *
+ * As funções examinam um bloco de bytes por vez (16 com SSE2, 32 com AVX2) em vez de um byte
+ * por iteração. A implementação é escolhida na primeira chamada, conforme a CPU; fora de x86
+ * só existe a escalar. O resultado nunca depende de bytes além de `fim`, e o último bloco só é
+ * lido inteiro quando não cruza uma página, então as funções servem sobre arquivos mapeados.
+ */
+
+#ifndef VARREDURA_H
+#define VARREDURA_H
+
+#include <stddef.h>
+
+/**
+ * @enum implementacao_varredura
+ * @brief Conjuntos de instruções usados pela varredura.
+ */
+typedef enum {
+        VARREDURA_ESCALAR = 0, /**< Um byte por vez; disponível em qualquer CPU. */
+        VARREDURA_SSE2 = 1,    /**< Blocos de 16 bytes. */
+        VARREDURA_AVX2 = 2,    /**< Blocos de 32 bytes. */
+} IMPLEMENTACAO_VARREDURA;
+
+/**
+ * @brief Primeira quebra de linha (`\n`) em [`inicio`, `fim`).
+ *
+ * @return Ponteiro para o byte encontrado, ou NULL.
+ */
+const char* buscar_quebra(const char* inicio, const char* fim);
+
+/**
+ * @brief Posições dos primeiros `;` em [`inicio`, `fim`), achadas numa só passada.
+ *
+ * @param[out] posicoes Recebe as posições, em ordem.
+ * @param maximo Capacidade de `posicoes`; a busca para ao enchê-la.
+ * @return Quantidade de posições gravadas.
+ */
+size_t buscar_separadores(const char* inicio, const char* fim, const char** posicoes,
+                          size_t maximo);
+
+/**
+ * @brief Primeiro byte que não é espaço (` `, `\t`, `\n`, `\v`, `\f`, `\r`) em [`inicio`, `fim`).
+ *
+ * @return Ponteiro para o byte encontrado, ou `fim` se só houver espaços.
+ */
+const char* pular_espacos(const char* inicio, const char* fim);
+
+/**
+ * @brief Implementação em uso.
+ */
+IMPLEMENTACAO_VARREDURA varredura_ativa(void);
+
+/**
+ * @brief Força uma implementação (para comparação e testes).
+ *
+ * @return 1 se a CPU suporta a implementação e ela passou a ser usada, 0 caso contrário.
+ */
+int definir_varredura(IMPLEMENTACAO_VARREDURA implementacao);
+
+/**
+ * @brief Nome legível da implementação ("escalar", "sse2" ou "avx2").
+ */
+const char* nome_varredura(IMPLEMENTACAO_VARREDURA implementacao);
+
+#endif  // VARREDURA_H
@@ -0,0 +1,170 @@
+/**
+ * @file versoes.h
+ * @brief Modo copy-on-write da árvore, com leituras sobre versões consistentes (MVCC).
+ *
+ * No modo copy-on-write, nenhum nó alcançável é alterado no lugar: inserções e remoções gravam
+ * novas cópias dos nós do caminho alterado, da folha até uma nova raiz, e publicam essa raiz
+ * com uma única escrita do CABECALHO. Um leitor que abriu uma versão continua percorrendo a
+ * raiz antiga, sem travas, enquanto escritores publicam versões novas.
+ *
+ * Os nós substituídos são guardados em uma lista de aposentados, gravada no próprio arquivo
+ * (em blocos que ocupam posições de nó, a partir da página 0), e só voltam à lista livre
+ * quando nenhuma versão aberta anterior à sua substituição continua ativa. Como a lista fica
+ * no arquivo, nós que ainda estavam em uso quando o processo terminou são recuperados pelo
+ * próximo escritor.
+ *
+ * Os números de versão são os do contador de alterações da página 0 (arquivo.h), e cada versão
+ * aberta é registrada com uma trava OFD compartilhada num byte próprio, além de
+ * INICIO_TRAVAS_VERSOES (concorrencia.h). Assim, escritores de qualquer processo enxergam os
+ * leitores de todos os outros, e leitores de versões nunca esperam por escritores.
+ *
+ * @note Escritores continuam precisando de travar_arquivo() em modo escrita entre si.
+ * @warning Não misture este modo com inserir_no_arvore()/remover_no_arvore() enquanto houver
+ *          versões abertas: essas funções alteram nós no lugar.
+ */
+
+#ifndef VERSOES_H
+#define VERSOES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arvore.h"
+#include "livro.h"
+
+/**
+ * Versão da árvore aberta para leitura.
+ */
+typedef struct {
+        int raiz;          /**< Raiz publicada no momento da abertura. */
+        size_t quantidade; /**< Quantidade de livros nessa versão. */
+        uint64_t numero;   /**< Número da versão, usado para recuperar nós antigos. */
+        int descritor;     /**< Descrição aberta que segura a trava da versão, ou -1. */
+} VERSAO_ARVORE;
+
+/**
+ * Função chamada por percorrer_aposentados() para cada posição da lista de aposentados.
+ *
+ * @param posicao Posição no arquivo.
+ * @param bloco Diferente de zero se a posição guarda um bloco da lista, e não um nó aposentado.
+ * @param contexto Ponteiro repassado pelo chamador.
+ */
+typedef void (*VISITANTE_APOSENTADO)(int posicao, int bloco, void* contexto);
+
+/**
+ * @brief Ativa ou desativa o modo copy-on-write para as operações do menu.
+ *
+ * @param ativo Diferente de zero para ativar.
+ */
+void definir_modo_cow(int ativo);
+
+/**
+ * @brief Informa se o modo copy-on-write está ativo.
+ *
+ * @return 1 se ativo, 0 caso contrário.
+ */
+int modo_cow_ativo(void);
+
+/**
+ * @brief Abre a versão publicada mais recente da árvore para leitura.
+ *
+ * Não espera por escritores: a versão é registrada com uma trava compartilhada que eles só
+ * consultam.
+ *
+ * @param arquivo Arquivo binário aberto para leitura (um `FILE*` próprio por thread leitora).
+ * @param[out] versao Versão aberta; deve ser fechada com fechar_versao().
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO, ERRO_ARQUIVO_READ ou ERRO_TRAVA.
+ */
+int abrir_versao(FILE* arquivo, VERSAO_ARVORE* versao);
+
+/**
+ * @brief Encerra a leitura de uma versão, permitindo recuperar os nós que só ela usava.
+ *
+ * @param versao Versão aberta com abrir_versao().
+ */
+void fechar_versao(VERSAO_ARVORE* versao);
+
+/**
+ * @brief Busca um livro pelo código dentro de uma versão.
+ *
+ * @param arquivo Arquivo binário aberto para leitura.
+ * @param versao Versão aberta.
+ * @param codigo Código procurado.
+ * @param[out] livro Livro encontrado.
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO se o código não existir na versão ou ERRO_NO_NULO.
+ */
+int buscar_na_versao(FILE* arquivo, const VERSAO_ARVORE* versao, size_t codigo, LIVRO* livro);
+
+/**
+ * @brief Percorre em ordem de código todos os livros de uma versão.
+ *
+ * @param arquivo Arquivo binário aberto para leitura.
+ * @param versao Versão aberta.
+ * @param visitar Função chamada para cada nó.
+ * @param contexto Ponteiro repassado a `visitar`.
+ * @return Os mesmos códigos de percorrer_subarvore_em_ordem().
+ */
+int percorrer_versao_em_ordem(FILE* arquivo, const VERSAO_ARVORE* versao, VISITANTE_NO visitar,
+                              void* contexto);
+
+/**
+ * @brief Insere um nó copiando o caminho da raiz até o ponto de inserção.
+ *
+ * Grava a nova folha e uma cópia de cada ancestral apontando para o filho novo, e então publica
+ * a nova raiz (e a quantidade de livros) com uma única escrita do cabeçalho.
+ *
+ * @param arquivo Arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param novo Nó a inserir (os filhos são ignorados).
+ * @return SUCESSO, ERRO_CODIGO_DUPLICADO, ERRO_MEMORIA ou erros de arquivo.
+ *
+ * @note Escritores devem ser serializados pelo chamador (ex.: travar_arquivo() em modo escrita).
+ */
+int inserir_no_arvore_cow(FILE* arquivo, NO_ARVORE* novo);
+
+/**
+ * @brief Remove um livro copiando o caminho alterado e publicando uma nova raiz.
+ *
+ * Um nó com dois filhos é substituído por uma cópia que recebe o livro do sucessor; o caminho
+ * até o sucessor também é copiado.
+ *
+ * @param arquivo Arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param codigo Código do livro a remover.
+ * @return SUCESSO, ERRO_NO_NULO se o código não existir, ERRO_MEMORIA ou erros de arquivo.
+ *
+ * @note Escritores devem ser serializados pelo chamador (ex.: travar_arquivo() em modo escrita).
+ */
+int remover_no_arvore_cow(FILE* arquivo, size_t codigo);
+
+/**
+ * @brief Devolve à lista livre os nós aposentados que nenhuma versão aberta alcança mais.
+ *
+ * É chamada automaticamente no início e no fim de cada escrita copy-on-write, e considera as
+ * versões abertas de todos os processos.
+ *
+ * @param arquivo Arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @return SUCESSO ou erros de arquivo.
+ *
+ * @note Como as escritas, deve ser serializada pelo chamador.
+ */
+int recuperar_versoes_antigas(FILE* arquivo);
+
+/**
+ * @brief Visita os blocos da lista de aposentados do arquivo e os nós guardados neles.
+ *
+ * @param arquivo Arquivo binário aberto para leitura.
+ * @param visitar Função chamada para cada posição.
+ * @param contexto Ponteiro repassado a `visitar`.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_READ ou ERRO_NO_NULO.
+ */
+int percorrer_aposentados(FILE* arquivo, VISITANTE_APOSENTADO visitar, void* contexto);
+
+/**
+ * @brief Quantidade de nós aposentados ainda aguardando recuperação.
+ *
+ * @param arquivo Arquivo binário aberto para leitura.
+ * @return Número de nós na lista de aposentados do arquivo.
+ */
+size_t quantidade_nos_aposentados(FILE* arquivo);
+
+#endif  // VERSOES_H
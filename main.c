@@ -1,27 +1,220 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "include/acesso_direto.h"
 #include "include/arquivo.h"
+#include "include/arvore.h"
 #include "include/erros.h"
+#include "include/estatisticas.h"
+#include "include/lote.h"
 #include "include/menu.h"
+#include "include/rastro.h"
+#include "include/rebalanceamento.h"
+#include "include/servidor.h"
 #include "include/utils.h"
+#include "include/versoes.h"
 
 #define CAMINHO_ARQUIVO "livros.bin"
+#define CAMINHO_COMPACTADO "livros.lz"
+#define CAMINHO_INSTANTANEO "livros.inst"
+
+/**
+ * @brief Fecha o rastro ao sair, por atexit().
+ */
+static void fechar_rastro_ao_sair(void) {
+        fechar_rastro();
+}
+
+/**
+ * @brief Lê o valor de `--threads`: um número de 1 a THREADS_SERVIDOR_MAXIMO.
+ *
+ * @return 1 se válido, 0 caso contrário.
+ */
+static int ler_threads(const char* texto, int* threads) {
+        size_t valor;
+        if (!converter_size_t(texto, strlen(texto), &valor) || valor == 0 ||
+            valor > THREADS_SERVIDOR_MAXIMO)
+                return 0;
+
+        *threads = (int)valor;
+        return 1;
+}
+
+/**
+ * @brief Diz se o arquivo de livros existe e está no formato da versão 1, sem páginas.
+ */
+static int precisa_migrar(const char* caminho) {
+        FILE* arquivo = fopen(caminho, "rb");
+        if (arquivo == NULL) return 0;
+        int v1 = arquivo_formato_v1(arquivo, NULL);
+        fclose(arquivo);
+        return v1;
+}
+
+/**
+ * @brief Converte o arquivo de livros da versão 1 para o formato atual (`--migrar`).
+ *
+ * @return Código de saída do programa.
+ */
+static int migrar(const char* caminho) {
+        size_t livros = 0;
+        int status = migrar_arquivo(caminho, &livros);
+        if (status == SUCESSO) {
+                printf("%s convertido para o formato atual: %zu livros\n", caminho, livros);
+                return 0;
+        }
+
+        FILE* arquivo = fopen(caminho, "rb");
+        CABECALHO* cabecalho = arquivo ? le_cabecalho(arquivo) : NULL;
+        int atual = cabecalho != NULL;
+        free(cabecalho);
+        if (arquivo) fclose(arquivo);
+
+        if (atual)
+                printf("%s ja esta no formato atual\n", caminho);
+        else
+                fprintf(stderr, "Erro ao converter %s (%d)\n", caminho, status);
+        return atual ? 0 : 1;
+}
 
 /**
  * @brief Função principal do programa de gerenciamento de livros.
  *
  * Esta função executa o loop principal do sistema, exibindo um menu com opções
  * para cadastrar, imprimir, listar, calcular total, remover livros, carregar
- * dados de arquivo texto, imprimir lista de registros livres e imprimir árvore
- * por níveis.
+ * dados de arquivo texto, imprimir lista de registros livres, imprimir árvore
+ * por níveis, gerar ou listar o catálogo compactado (uma exportação somente leitura, que a
+ * listagem recusa quando o arquivo de livros mudou depois dela), exportar ou restaurar o
+ * instantâneo binário do catálogo, exportá-lo em CSV ou JSON Lines, exibir as estatísticas
+ * das operações, diagnosticar a forma da árvore e rebalanceá-la.
  *
  * O programa continua executando até que o usuário escolha a opção de sair (0).
+ * Com `--cow`, cadastros e remoções gravam cópias dos nós (versoes.h) e a listagem lê uma
+ * versão consistente sem travar escritores. Com `--balancear`, os cadastros fora do modo
+ * `--cow` reconstroem as subárvores que ficarem fundas demais (definir_reconstrucao_parcial()).
  *
+ * Com `--servidor`, em vez do menu o programa atende clientes pelo socket de domínio Unix
+ * (servidor.h) até receber SIGINT/SIGTERM; `--socket CAMINHO` e `--threads N` ajustam o
+ * servidor. N vai de 1 a THREADS_SERVIDOR_MAXIMO; outro valor mostra o uso e encerra.
+ *
+ * Com `--lote ARQUIVO` (ou `--lote -` para a entrada padrão), executa os comandos do arquivo
+ * (lote.h) sobre um único handle e termina; `--parar-no-erro` interrompe no primeiro erro.
+ * Com `--direto`, o servidor e o lote leem e gravam as páginas de dados com `O_DIRECT`, por um
+ * pool de PAGINAS_ACESSO_DIRETO páginas (acesso_direto.h).
+ * Com `--rebalancear`, reescreve o arquivo como uma árvore balanceada (rebalanceamento.h) e
+ * termina; nenhum outro processo deve estar com o arquivo aberto. Com `--migrar`, converte um
+ * arquivo do formato da versão 1, sem páginas, para o atual (migrar_arquivo()) e termina; nos
+ * outros modos, um arquivo da versão 1 é recusado logo no início, com a indicação de migrá-lo.
+ *
+ * Em todos os modos, SIGUSR1 escreve as estatísticas (estatisticas.h) em texto na saída de
+ * erro, e SIGUSR2 em JSON. Com `--rastro CAMINHO`, as operações medidas são gravadas no rastro
+ * (rastro.h), que tools/reproduzir_rastro.c reproduz depois.
+ *
+ * @param argc Quantidade de argumentos.
+ * @param argv Argumentos da linha de comando.
  * @return int Retorna 0 ao finalizar a execução com sucesso.
  */
-int main(void) {
-        int opcao = -1;
+int main(int argc, char* argv[]) {
+        int servidor = 0;
+        const char* caminho_socket = CAMINHO_SOCKET_PADRAO;
+        int threads = THREADS_SERVIDOR_PADRAO;
+        const char* caminho_lote = NULL;
+        int parar_no_erro = 0;
+        const char* caminho_rastro = NULL;
+        int rebalancear = 0;
+        int migrar_formato = 0;
+
+        for (int i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "--cow") == 0) {
+                        definir_modo_cow(1);
+                } else if (strcmp(argv[i], "--balancear") == 0) {
+                        definir_reconstrucao_parcial(1);
+                } else if (strcmp(argv[i], "--servidor") == 0) {
+                        servidor = 1;
+                } else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+                        caminho_socket = argv[++i];
+                } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc &&
+                           ler_threads(argv[i + 1], &threads)) {
+                        i++;
+                } else if (strcmp(argv[i], "--lote") == 0 && i + 1 < argc) {
+                        caminho_lote = argv[++i];
+                } else if (strcmp(argv[i], "--parar-no-erro") == 0) {
+                        parar_no_erro = 1;
+                } else if (strcmp(argv[i], "--rastro") == 0 && i + 1 < argc) {
+                        caminho_rastro = argv[++i];
+                } else if (strcmp(argv[i], "--direto") == 0) {
+                        definir_acesso_direto(PAGINAS_ACESSO_DIRETO);
+                } else if (strcmp(argv[i], "--rebalancear") == 0) {
+                        rebalancear = 1;
+                } else if (strcmp(argv[i], "--migrar") == 0) {
+                        migrar_formato = 1;
+                } else {
+                        fprintf(stderr,
+                                "Uso: %s [--cow|--balancear] [--direto] [--rastro CAMINHO] "
+                                "[--servidor [--socket CAMINHO] [--threads N]]\n"
+                                "       %s [--cow|--balancear] [--direto] [--rastro CAMINHO] "
+                                "--lote ARQUIVO|- [--parar-no-erro]\n"
+                                "       %s --rebalancear\n"
+                                "       %s --migrar\n",
+                                argv[0], argv[0], argv[0], argv[0]);
+                        return 1;
+                }
+        }
+
+        // Antes de qualquer outra thread, para que todas herdem os sinais bloqueados.
+        iniciar_despejo_por_sinal(stderr);
+
+        if (caminho_rastro) {
+                if (abrir_rastro(caminho_rastro, 0) != SUCESSO) {
+                        fprintf(stderr, "Nao foi possivel criar o rastro %s\n", caminho_rastro);
+                        return 1;
+                }
+                atexit(fechar_rastro_ao_sair);
+                if (!estatisticas_ativas())
+                        fprintf(stderr,
+                                "Aviso: compilado sem ESTATISTICAS, o rastro ficara vazio\n");
+        }
+
+        if (migrar_formato) return migrar(CAMINHO_ARQUIVO);
+        if (precisa_migrar(CAMINHO_ARQUIVO)) {
+                fprintf(stderr,
+                        "%s esta no formato da versao 1, sem paginas; converta-o com --migrar\n",
+                        CAMINHO_ARQUIVO);
+                return 1;
+        }
+
         abrir_ou_criar_arquivo(CAMINHO_ARQUIVO);
+
+        if (rebalancear) {
+                int status = opcao_rebalancear_arquivo(CAMINHO_ARQUIVO);
+                if (status != SUCESSO) fprintf(stderr, "Erro ao rebalancear arvore.\n");
+                return status == SUCESSO ? 0 : 1;
+        }
+
+        if (caminho_lote) {
+                FILE* comandos = strcmp(caminho_lote, "-") == 0 ? stdin : fopen(caminho_lote, "r");
+                if (comandos == NULL) {
+                        fprintf(stderr, "Nao foi possivel abrir %s\n", caminho_lote);
+                        return 1;
+                }
+
+                // Saída totalmente bufferizada: o lote não interage com um terminal
+                setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+                int status = executar_lote(comandos, CAMINHO_ARQUIVO, stdout, parar_no_erro);
+                if (comandos != stdin) fclose(comandos);
+                return status == SUCESSO ? 0 : 1;
+        }
+
+        if (servidor) {
+                if (executar_servidor(CAMINHO_ARQUIVO, caminho_socket, threads) != SUCESSO) {
+                        fprintf(stderr, "Erro ao iniciar servidor em %s\n", caminho_socket);
+                        return 1;
+                }
+                return 0;
+        }
+
+        int opcao = -1;
         while (opcao != 0) {
                 exibir_menu();
 
@@ -70,6 +263,44 @@ int main(void) {
                         case 8:
                                 status = opcao_imprimir_arvore_por_niveis(CAMINHO_ARQUIVO);
                                 break;
+                        case 9:
+                                status = opcao_compactar_catalogo(CAMINHO_ARQUIVO,
+                                                                  CAMINHO_COMPACTADO);
+                                if (status != SUCESSO) printf("Erro ao compactar catalogo.\n\n");
+                                break;
+                        case 10:
+                                status = opcao_listar_catalogo_compactado(CAMINHO_ARQUIVO,
+                                                                          CAMINHO_COMPACTADO);
+                                if (status != SUCESSO)
+                                        printf("Erro ao listar catalogo compactado.\n\n");
+                                break;
+                        case 11:
+                                status = opcao_exportar_instantaneo(CAMINHO_ARQUIVO,
+                                                                    CAMINHO_INSTANTANEO);
+                                if (status != SUCESSO) printf("Erro ao exportar instantaneo.\n\n");
+                                break;
+                        case 12:
+                                status = opcao_restaurar_instantaneo(CAMINHO_ARQUIVO,
+                                                                     CAMINHO_INSTANTANEO);
+                                if (status != SUCESSO)
+                                        printf("Erro ao restaurar instantaneo.\n\n");
+                                break;
+                        case 13:
+                                status = opcao_exportar_texto(CAMINHO_ARQUIVO);
+                                if (status != SUCESSO) printf("Erro ao exportar catalogo.\n\n");
+                                break;
+                        case 14:
+                                status = opcao_exibir_estatisticas();
+                                if (status != SUCESSO) printf("Erro ao exibir estatisticas.\n\n");
+                                break;
+                        case 15:
+                                status = opcao_diagnosticar_arvore(CAMINHO_ARQUIVO);
+                                if (status != SUCESSO) printf("Erro ao diagnosticar arvore.\n\n");
+                                break;
+                        case 16:
+                                status = opcao_rebalancear_arquivo(CAMINHO_ARQUIVO);
+                                if (status != SUCESSO) printf("Erro ao rebalancear arvore.\n\n");
+                                break;
                         case 0:
                                 printf("Saindo do programa...");
                                 break;
@@ -0,0 +1,670 @@
+/**
+ * @file acesso_direto.c
+ * @brief Implementa o pool de páginas do modo de E/S direta.
+ */
+
+#define _GNU_SOURCE  // O_DIRECT
+
+#include "../include/acesso_direto.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/erros.h"
+
+/** Página sem quadro no pool. */
+#define SEM_QUADRO (-1)
+
+/**
+ * Quadro do pool ou do anel.
+ */
+typedef struct {
+        size_t pagina; /**< Página de dados no quadro. */
+        int ocupado;   /**< Zero se o quadro está vazio. */
+        int marcado;   /**< Bit de referência do relógio. */
+        int fixado;    /**< Nunca expulso enquanto diferente de zero. */
+} QUADRO;
+
+/**
+ * Pool de um arquivo, compartilhado pelos handles dele.
+ *
+ * Os quadros `[0, paginas)` são o pool, os PAGINAS_ANEL_VARREDURA seguintes são o anel e, na
+ * memória, mais um quadro serve de passagem para as gravações de páginas fora dos dois.
+ */
+typedef struct POOL_PAGINAS {
+        dev_t dispositivo;            /**< Dispositivo do arquivo. */
+        ino_t inode;                  /**< Inode do arquivo. */
+        int descritor;                /**< Descritor aberto com `O_DIRECT`, se possível. */
+        int direto;                   /**< 1 se `descritor` usa `O_DIRECT`. */
+        unsigned char* memoria;       /**< Quadros, alinhados a TAMANHO_PAGINA. */
+        QUADRO* quadros;              /**< Pool seguido do anel. */
+        size_t paginas;               /**< Quadros do pool. */
+        size_t ponteiro;              /**< Ponteiro do relógio. */
+        size_t proximo_anel;          /**< Próximo quadro do anel a reaproveitar. */
+        int* quadro_da_pagina;        /**< Quadro do pool de cada página, ou SEM_QUADRO. */
+        size_t mapeadas;              /**< Páginas em `quadro_da_pagina`. */
+        uint64_t alteracoes;          /**< Contador de alterações na última gravação registrada. */
+        int raiz_fixada;              /**< Raiz na última fixação. */
+        size_t fixadas;               /**< Quadros fixados. */
+        size_t handles;               /**< Handles associados. */
+        size_t acertos;               /**< Ver ESTADO_ACESSO_DIRETO. */
+        size_t faltas;                /**< Ver ESTADO_ACESSO_DIRETO. */
+        size_t faltas_varredura;      /**< Ver ESTADO_ACESSO_DIRETO. */
+        size_t expulsoes;             /**< Ver ESTADO_ACESSO_DIRETO. */
+        size_t invalidacoes;          /**< Ver ESTADO_ACESSO_DIRETO. */
+        struct POOL_PAGINAS* proximo; /**< Próximo pool. */
+} POOL_PAGINAS;
+
+/**
+ * Associação de um handle ao pool do arquivo.
+ */
+typedef struct ASSOCIACAO {
+        FILE* arquivo;              /**< Handle do arquivo de livros. */
+        POOL_PAGINAS* pool;         /**< Pool do arquivo. */
+        int varreduras;             /**< iniciar_varredura() sem terminar_varredura(). */
+        struct ASSOCIACAO* proximo; /**< Próxima associação. */
+} ASSOCIACAO;
+
+/// @brief Pools abertos, um por arquivo.
+static POOL_PAGINAS* pools = NULL;
+
+/// @brief Handles com pool.
+static ASSOCIACAO* associacoes = NULL;
+
+/// @brief Protege as duas listas e os pools. As faltas leem o disco com ele travado: os
+/// acertos, que são a maioria, só copiam uma página.
+static pthread_mutex_t mutex_pools = PTHREAD_MUTEX_INITIALIZER;
+
+/// @brief Quadros do pool com `--direto`, ou 0.
+static size_t paginas_modo = 0;
+
+/**
+ * @brief Associação do handle, ou NULL. Chamar com `mutex_pools` travado.
+ */
+static ASSOCIACAO* associacao_do_arquivo(FILE* arquivo) {
+        for (ASSOCIACAO* associacao = associacoes; associacao; associacao = associacao->proximo)
+                if (associacao->arquivo == arquivo) return associacao;
+        return NULL;
+}
+
+/**
+ * @brief Pool do arquivo descrito por `estado`, ou NULL. Chamar com `mutex_pools` travado.
+ */
+static POOL_PAGINAS* pool_do_arquivo(const struct stat* estado) {
+        for (POOL_PAGINAS* pool = pools; pool; pool = pool->proximo)
+                if (pool->dispositivo == estado->st_dev && pool->inode == estado->st_ino)
+                        return pool;
+        return NULL;
+}
+
+/**
+ * @brief Memória do quadro `quadro` (o quadro de passagem é o último).
+ */
+static unsigned char* dados_quadro(const POOL_PAGINAS* pool, size_t quadro) {
+        return pool->memoria + quadro * TAMANHO_PAGINA;
+}
+
+/**
+ * @brief Quadro do pool com a página, ou SEM_QUADRO.
+ */
+static int quadro_no_pool(const POOL_PAGINAS* pool, size_t pagina) {
+        return pagina < pool->mapeadas ? pool->quadro_da_pagina[pagina] : SEM_QUADRO;
+}
+
+/**
+ * @brief Quadro do anel com a página, ou SEM_QUADRO.
+ */
+static int quadro_no_anel(const POOL_PAGINAS* pool, size_t pagina) {
+        for (size_t i = 0; i < PAGINAS_ANEL_VARREDURA; i++) {
+                const QUADRO* quadro = &pool->quadros[pool->paginas + i];
+                if (quadro->ocupado && quadro->pagina == pagina) return (int)(pool->paginas + i);
+        }
+        return SEM_QUADRO;
+}
+
+/**
+ * @brief Garante espaço para `pagina` em `quadro_da_pagina`.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+static int mapear(POOL_PAGINAS* pool, size_t pagina) {
+        if (pagina < pool->mapeadas) return SUCESSO;
+        size_t nova = pool->mapeadas ? pool->mapeadas : 1024;
+        while (nova <= pagina) nova *= 2;
+        int* mapa = realloc(pool->quadro_da_pagina, nova * sizeof(int));
+        if (mapa == NULL) return ERRO_MEMORIA;
+        for (size_t i = pool->mapeadas; i < nova; i++) mapa[i] = SEM_QUADRO;
+        pool->quadro_da_pagina = mapa;
+        pool->mapeadas = nova;
+        return SUCESSO;
+}
+
+/**
+ * @brief Escolhe um quadro do pool pelo relógio, expulsando a página dele se houver.
+ *
+ * Termina porque no máximo um quarto dos quadros fica fixado.
+ */
+static size_t escolher_vitima(POOL_PAGINAS* pool) {
+        for (;;) {
+                size_t escolhido = pool->ponteiro;
+                pool->ponteiro = (pool->ponteiro + 1) % pool->paginas;
+                QUADRO* quadro = &pool->quadros[escolhido];
+                if (!quadro->ocupado) return escolhido;
+                if (quadro->fixado) continue;
+                if (quadro->marcado) {
+                        quadro->marcado = 0;
+                        continue;
+                }
+                pool->quadro_da_pagina[quadro->pagina] = SEM_QUADRO;
+                quadro->ocupado = 0;
+                pool->expulsoes++;
+                return escolhido;
+        }
+}
+
+/**
+ * @brief Lê a página do disco para o quadro; o que passar do fim do arquivo fica zerado.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_READ.
+ */
+static int carregar_quadro(POOL_PAGINAS* pool, size_t quadro, size_t pagina) {
+        unsigned char* dados = dados_quadro(pool, quadro);
+        ssize_t lidos = pread(pool->descritor, dados, TAMANHO_PAGINA, inicio_pagina(pagina));
+        if (lidos < 0) return ERRO_ARQUIVO_READ;
+        memset(dados + lidos, 0, TAMANHO_PAGINA - (size_t)lidos);
+        return SUCESSO;
+}
+
+/**
+ * @brief Reserva um quadro do pool para a página, sem lê-la.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+static int reservar_no_pool(POOL_PAGINAS* pool, size_t pagina, int* quadro) {
+        if (mapear(pool, pagina) != SUCESSO) return ERRO_MEMORIA;
+        size_t escolhido = escolher_vitima(pool);
+        pool->quadros[escolhido] = (QUADRO){.pagina = pagina, .ocupado = 1, .marcado = 1};
+        pool->quadro_da_pagina[pagina] = (int)escolhido;
+        *quadro = (int)escolhido;
+        return SUCESSO;
+}
+
+/**
+ * @brief Desfaz a reserva de um quadro do pool.
+ */
+static void soltar_do_pool(POOL_PAGINAS* pool, int quadro) {
+        QUADRO* solto = &pool->quadros[quadro];
+        pool->quadro_da_pagina[solto->pagina] = SEM_QUADRO;
+        if (solto->fixado) pool->fixadas--;
+        *solto = (QUADRO){0};
+}
+
+/**
+ * @brief Lê uma página ausente para um quadro do pool.
+ *
+ * @return SUCESSO, ERRO_MEMORIA ou ERRO_ARQUIVO_READ.
+ */
+static int trazer_para_pool(POOL_PAGINAS* pool, size_t pagina, int* quadro) {
+        int status = reservar_no_pool(pool, pagina, quadro);
+        if (status != SUCESSO) return status;
+        status = carregar_quadro(pool, (size_t)*quadro, pagina);
+        if (status != SUCESSO) {
+                soltar_do_pool(pool, *quadro);
+                return status;
+        }
+        pool->faltas++;
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê uma página ausente para o próximo quadro do anel.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_READ.
+ */
+static int trazer_para_anel(POOL_PAGINAS* pool, size_t pagina, int* quadro) {
+        size_t escolhido = pool->paginas + pool->proximo_anel;
+        pool->proximo_anel = (pool->proximo_anel + 1) % PAGINAS_ANEL_VARREDURA;
+        pool->quadros[escolhido].ocupado = 0;
+        int status = carregar_quadro(pool, escolhido, pagina);
+        if (status != SUCESSO) return status;
+        pool->quadros[escolhido] = (QUADRO){.pagina = pagina, .ocupado = 1};
+        pool->faltas_varredura++;
+        *quadro = (int)escolhido;
+        return SUCESSO;
+}
+
+/**
+ * @brief Esvazia o pool e o anel.
+ */
+static void esvaziar(POOL_PAGINAS* pool) {
+        memset(pool->quadros, 0, (pool->paginas + PAGINAS_ANEL_VARREDURA) * sizeof(QUADRO));
+        for (size_t i = 0; i < pool->mapeadas; i++) pool->quadro_da_pagina[i] = SEM_QUADRO;
+        pool->fixadas = 0;
+        pool->raiz_fixada = POSICAO_INVALIDA;
+}
+
+/**
+ * @brief Fecha o descritor e libera a memória do pool.
+ */
+static void liberar_pool(POOL_PAGINAS* pool) {
+        close(pool->descritor);
+        free(pool->memoria);
+        free(pool->quadros);
+        free(pool->quadro_da_pagina);
+        free(pool);
+}
+
+/**
+ * @brief Abre `caminho` de novo, de preferência com `O_DIRECT`, e cria o pool.
+ *
+ * O descritor tem de ser do mesmo arquivo que `estado` descreve. Um sistema de arquivos que
+ * aceita `O_DIRECT` na abertura mas recusa a leitura alinhada também cai no modo sem ele.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO ou ERRO_MEMORIA.
+ */
+static int criar_pool(const char* caminho, const struct stat* estado, uint64_t alteracoes,
+                      size_t paginas, POOL_PAGINAS** criado) {
+        POOL_PAGINAS* pool = calloc(1, sizeof(POOL_PAGINAS));
+        if (pool == NULL) return ERRO_MEMORIA;
+        size_t quadros = paginas + PAGINAS_ANEL_VARREDURA;
+        void* memoria = NULL;
+        if (posix_memalign(&memoria, TAMANHO_PAGINA, (quadros + 1) * TAMANHO_PAGINA) != 0) {
+                free(pool);
+                return ERRO_MEMORIA;
+        }
+        pool->memoria = memoria;
+        pool->quadros = calloc(quadros, sizeof(QUADRO));
+        if (pool->quadros == NULL) {
+                free(pool->memoria);
+                free(pool);
+                return ERRO_MEMORIA;
+        }
+
+        pool->direto = 1;
+        pool->descritor = open(caminho, O_RDWR | O_DIRECT);
+        if (pool->descritor >= 0 && pread(pool->descritor, memoria, TAMANHO_PAGINA, 0) < 0) {
+                close(pool->descritor);
+                pool->descritor = -1;
+        }
+        if (pool->descritor < 0) {
+                pool->direto = 0;
+                pool->descritor = open(caminho, O_RDWR);
+        }
+
+        struct stat aberto;
+        if (pool->descritor < 0 || fstat(pool->descritor, &aberto) != 0 ||
+            aberto.st_dev != estado->st_dev || aberto.st_ino != estado->st_ino) {
+                if (pool->descritor >= 0) close(pool->descritor);
+                free(pool->quadros);
+                free(pool->memoria);
+                free(pool);
+                return ERRO_ARQUIVO_NULO;
+        }
+
+        pool->dispositivo = estado->st_dev;
+        pool->inode = estado->st_ino;
+        pool->paginas = paginas;
+        pool->raiz_fixada = POSICAO_INVALIDA;
+        pool->alteracoes = alteracoes;
+        *criado = pool;
+        return SUCESSO;
+}
+
+/**
+ * @brief Associa ao handle o pool do arquivo e fixa os níveis superiores.
+ *
+ * @param arquivo Arquivo binário da árvore, já travado pelo chamador.
+ * @param caminho Caminho do mesmo arquivo.
+ * @param paginas Quadros do pool, se ele for criado agora.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_WRITE, ERRO_MEMORIA, ERRO_CABECALHO_NULO ou
+ *         ERRO_NO_NULO.
+ */
+int abrir_acesso_direto(FILE* arquivo, const char* caminho, size_t paginas) {
+        if (arquivo == NULL || caminho == NULL) return ERRO_ARQUIVO_NULO;
+        if (paginas < PAGINAS_ANEL_VARREDURA) paginas = PAGINAS_ANEL_VARREDURA;
+
+        // Daqui em diante as páginas de dados não passam pelo buffer do FILE*
+        if (fflush(arquivo) != 0) return ERRO_ARQUIVO_WRITE;
+        struct stat estado;
+        if (fstat(fileno(arquivo), &estado) != 0) return ERRO_ARQUIVO_NULO;
+        uint64_t alteracoes = 0;
+        if (ler_alteracoes(arquivo, &alteracoes) != SUCESSO) return ERRO_ARQUIVO_NULO;
+
+        ASSOCIACAO* associacao = calloc(1, sizeof(ASSOCIACAO));
+        if (associacao == NULL) return ERRO_MEMORIA;
+        associacao->arquivo = arquivo;
+
+        pthread_mutex_lock(&mutex_pools);
+        if (associacao_do_arquivo(arquivo) != NULL) {
+                pthread_mutex_unlock(&mutex_pools);
+                free(associacao);
+                return SUCESSO;
+        }
+        int status = SUCESSO;
+        POOL_PAGINAS* pool = pool_do_arquivo(&estado);
+        int novo = pool == NULL;
+        if (novo) {
+                status = criar_pool(caminho, &estado, alteracoes, paginas, &pool);
+                if (status == SUCESSO) {
+                        pool->proximo = pools;
+                        pools = pool;
+                }
+        }
+        if (status == SUCESSO) {
+                pool->handles++;
+                associacao->pool = pool;
+                associacao->proximo = associacoes;
+                associacoes = associacao;
+        }
+        pthread_mutex_unlock(&mutex_pools);
+        if (status != SUCESSO) {
+                free(associacao);
+                return status;
+        }
+
+        if (novo) status = fixar_niveis_superiores(arquivo);
+        if (status != SUCESSO) fechar_acesso_direto(arquivo);
+        return status;
+}
+
+/**
+ * @brief Desfaz a associação do handle; o último handle libera o pool.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_NULO.
+ */
+int fechar_acesso_direto(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_pools);
+        ASSOCIACAO** elo = &associacoes;
+        while (*elo && (*elo)->arquivo != arquivo) elo = &(*elo)->proximo;
+        ASSOCIACAO* associacao = *elo;
+        POOL_PAGINAS* liberado = NULL;
+        if (associacao) {
+                *elo = associacao->proximo;
+                POOL_PAGINAS* pool = associacao->pool;
+                if (--pool->handles == 0) {
+                        POOL_PAGINAS** anterior = &pools;
+                        while (*anterior != pool) anterior = &(*anterior)->proximo;
+                        *anterior = pool->proximo;
+                        liberado = pool;
+                }
+        }
+        pthread_mutex_unlock(&mutex_pools);
+
+        if (associacao == NULL) return ERRO_ARQUIVO_NULO;
+        free(associacao);
+        if (liberado) liberar_pool(liberado);
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê o começo de uma página de dados pelo pool, ou pelo anel durante as varreduras.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO sem pool, ERRO_MEMORIA ou ERRO_ARQUIVO_READ.
+ */
+int ler_pagina_direta(FILE* arquivo, size_t pagina, void* destino, size_t bytes) {
+        pthread_mutex_lock(&mutex_pools);
+        ASSOCIACAO* associacao = associacao_do_arquivo(arquivo);
+        if (associacao == NULL) {
+                pthread_mutex_unlock(&mutex_pools);
+                return ERRO_ARQUIVO_NULO;
+        }
+        POOL_PAGINAS* pool = associacao->pool;
+        int varrendo = associacao->varreduras > 0;
+
+        int status = SUCESSO;
+        int quadro = quadro_no_pool(pool, pagina);
+        if (quadro != SEM_QUADRO) {
+                // Um acerto da varredura não protege a página: ela pode ter sido lida uma vez só
+                if (!varrendo) pool->quadros[quadro].marcado = 1;
+                pool->acertos++;
+        } else if ((quadro = quadro_no_anel(pool, pagina)) != SEM_QUADRO) {
+                pool->acertos++;
+        } else if (varrendo) {
+                status = trazer_para_anel(pool, pagina, &quadro);
+        } else {
+                status = trazer_para_pool(pool, pagina, &quadro);
+        }
+        if (status == SUCESSO) memcpy(destino, dados_quadro(pool, (size_t)quadro), bytes);
+        pthread_mutex_unlock(&mutex_pools);
+        return status;
+}
+
+/**
+ * @brief Grava uma página de dados inteira no disco e atualiza as cópias do pool e do anel.
+ *
+ * Fora das varreduras, a página gravada entra no pool: quem grava costuma ler logo depois.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO sem pool, ERRO_MEMORIA ou ERRO_ARQUIVO_WRITE.
+ */
+int gravar_pagina_direta(FILE* arquivo, size_t pagina, const void* conteudo) {
+        pthread_mutex_lock(&mutex_pools);
+        ASSOCIACAO* associacao = associacao_do_arquivo(arquivo);
+        if (associacao == NULL) {
+                pthread_mutex_unlock(&mutex_pools);
+                return ERRO_ARQUIVO_NULO;
+        }
+        POOL_PAGINAS* pool = associacao->pool;
+
+        int quadro = quadro_no_pool(pool, pagina);
+        int no_anel = quadro_no_anel(pool, pagina);
+        if (quadro == SEM_QUADRO && no_anel == SEM_QUADRO && associacao->varreduras == 0 &&
+            reservar_no_pool(pool, pagina, &quadro) != SUCESSO) {
+                pthread_mutex_unlock(&mutex_pools);
+                return ERRO_MEMORIA;
+        }
+
+        // O pwrite() com O_DIRECT precisa de um buffer alinhado: grava de um dos quadros.
+        size_t origem = pool->paginas + PAGINAS_ANEL_VARREDURA;
+        if (no_anel != SEM_QUADRO) origem = (size_t)no_anel;
+        if (quadro != SEM_QUADRO) origem = (size_t)quadro;
+        memcpy(dados_quadro(pool, origem), conteudo, TAMANHO_PAGINA);
+        if (no_anel != SEM_QUADRO && (size_t)no_anel != origem)
+                memcpy(dados_quadro(pool, (size_t)no_anel), conteudo, TAMANHO_PAGINA);
+
+        int status = SUCESSO;
+        if (pwrite(pool->descritor, dados_quadro(pool, origem), TAMANHO_PAGINA,
+                   inicio_pagina(pagina)) != TAMANHO_PAGINA) {
+                // As cópias já têm o conteúdo novo, que não chegou ao disco
+                if (quadro != SEM_QUADRO) soltar_do_pool(pool, quadro);
+                if (no_anel != SEM_QUADRO) pool->quadros[no_anel].ocupado = 0;
+                status = ERRO_ARQUIVO_WRITE;
+        }
+        pthread_mutex_unlock(&mutex_pools);
+        return status;
+}
+
+/**
+ * @brief Passa as faltas do handle para o anel, até terminar_varredura().
+ */
+void iniciar_varredura(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_pools);
+        ASSOCIACAO* associacao = associacao_do_arquivo(arquivo);
+        if (associacao) associacao->varreduras++;
+        pthread_mutex_unlock(&mutex_pools);
+}
+
+/**
+ * @brief Encerra o iniciar_varredura() correspondente.
+ */
+void terminar_varredura(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_pools);
+        ASSOCIACAO* associacao = associacao_do_arquivo(arquivo);
+        if (associacao && associacao->varreduras > 0) associacao->varreduras--;
+        pthread_mutex_unlock(&mutex_pools);
+}
+
+/**
+ * @brief Traz a página para o pool, se preciso, e a fixa.
+ *
+ * @return 1 se a página ficou fixada; 0 sem pool, no limite de um quarto do pool ou em erro.
+ */
+static int fixar_pagina(FILE* arquivo, size_t pagina) {
+        pthread_mutex_lock(&mutex_pools);
+        ASSOCIACAO* associacao = associacao_do_arquivo(arquivo);
+        if (associacao == NULL) {
+                pthread_mutex_unlock(&mutex_pools);
+                return 0;
+        }
+        POOL_PAGINAS* pool = associacao->pool;
+        int quadro = quadro_no_pool(pool, pagina);
+        int fixada = quadro != SEM_QUADRO && pool->quadros[quadro].fixado;
+        if (!fixada && pool->fixadas < pool->paginas / 4 &&
+            (quadro != SEM_QUADRO || trazer_para_pool(pool, pagina, &quadro) == SUCESSO)) {
+                pool->quadros[quadro].fixado = 1;
+                pool->fixadas++;
+                fixada = 1;
+        }
+        pthread_mutex_unlock(&mutex_pools);
+        return fixada;
+}
+
+/**
+ * @brief Solta as páginas fixadas e fixa as dos primeiros nós da árvore, em largura.
+ *
+ * A fila guarda no máximo 2^NIVEIS_FIXOS - 1 posições, o que também limita o percurso numa
+ * árvore com ciclo.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO, ERRO_MEMORIA ou ERRO_NO_NULO.
+ */
+int fixar_niveis_superiores(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_pools);
+        ASSOCIACAO* associacao = associacao_do_arquivo(arquivo);
+        if (associacao) {
+                POOL_PAGINAS* pool = associacao->pool;
+                for (size_t i = 0; i < pool->paginas; i++) pool->quadros[i].fixado = 0;
+                pool->fixadas = 0;
+        }
+        pthread_mutex_unlock(&mutex_pools);
+        if (associacao == NULL) return ERRO_ARQUIVO_NULO;
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+        int raiz = cabecalho->raiz;
+        free(cabecalho);
+
+        size_t limite = ((size_t)1 << NIVEIS_FIXOS) - 1;
+        int* fila = malloc(limite * sizeof(int));
+        if (fila == NULL) return ERRO_MEMORIA;
+        size_t inicio = 0, fim = 0;
+        if (raiz != POSICAO_INVALIDA) fila[fim++] = raiz;
+
+        int status = SUCESSO;
+        while (inicio < fim) {
+                int posicao = fila[inicio++];
+                if (posicao < 0) {
+                        status = ERRO_NO_NULO;
+                        break;
+                }
+                if (!fixar_pagina(arquivo, (size_t)posicao / NOS_POR_PAGINA)) break;
+                NO_ARVORE* no = ler_no_arquivo(arquivo, posicao);
+                if (no == NULL) {
+                        status = ERRO_NO_NULO;
+                        break;
+                }
+                if (no->filho_esquerdo != POSICAO_INVALIDA && fim < limite)
+                        fila[fim++] = no->filho_esquerdo;
+                if (no->filho_direito != POSICAO_INVALIDA && fim < limite)
+                        fila[fim++] = no->filho_direito;
+                free(no);
+        }
+        free(fila);
+
+        pthread_mutex_lock(&mutex_pools);
+        associacao = associacao_do_arquivo(arquivo);
+        if (associacao) associacao->pool->raiz_fixada = raiz;
+        pthread_mutex_unlock(&mutex_pools);
+        return status;
+}
+
+/**
+ * @brief Esvazia o pool e refaz a fixação se o contador de alterações do arquivo mudou desde a
+ * última gravação registrada.
+ */
+void conferir_acesso_direto(FILE* arquivo) {
+        uint64_t alteracoes = 0;
+        if (ler_alteracoes(arquivo, &alteracoes) != SUCESSO) return;
+
+        int mudou = 0;
+        pthread_mutex_lock(&mutex_pools);
+        ASSOCIACAO* associacao = associacao_do_arquivo(arquivo);
+        if (associacao) {
+                POOL_PAGINAS* pool = associacao->pool;
+                mudou = alteracoes != pool->alteracoes;
+                if (mudou) {
+                        esvaziar(pool);
+                        pool->alteracoes = alteracoes;
+                        pool->invalidacoes++;
+                }
+        }
+        pthread_mutex_unlock(&mutex_pools);
+
+        if (mudou) fixar_niveis_superiores(arquivo);
+}
+
+/**
+ * @brief Registra o estado do arquivo depois de uma gravação e refaz a fixação se a raiz
+ * mudou.
+ */
+void registrar_acesso_direto(FILE* arquivo) {
+        uint64_t alteracoes = 0;
+        int lido = ler_alteracoes(arquivo, &alteracoes) == SUCESSO;
+
+        int raiz_fixada = POSICAO_INVALIDA;
+        pthread_mutex_lock(&mutex_pools);
+        ASSOCIACAO* associacao = associacao_do_arquivo(arquivo);
+        if (associacao) {
+                if (lido) associacao->pool->alteracoes = alteracoes;
+                raiz_fixada = associacao->pool->raiz_fixada;
+        }
+        pthread_mutex_unlock(&mutex_pools);
+        if (associacao == NULL) return;
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho && cabecalho->raiz != raiz_fixada) fixar_niveis_superiores(arquivo);
+        free(cabecalho);
+}
+
+/**
+ * @brief Lê a situação do pool associado ao handle.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_NULO.
+ */
+int consultar_acesso_direto(FILE* arquivo, ESTADO_ACESSO_DIRETO* estado) {
+        pthread_mutex_lock(&mutex_pools);
+        ASSOCIACAO* associacao = associacao_do_arquivo(arquivo);
+        if (associacao) {
+                const POOL_PAGINAS* pool = associacao->pool;
+                *estado = (ESTADO_ACESSO_DIRETO){.paginas = pool->paginas,
+                                                 .fixadas = pool->fixadas,
+                                                 .handles = pool->handles,
+                                                 .acertos = pool->acertos,
+                                                 .faltas = pool->faltas,
+                                                 .faltas_varredura = pool->faltas_varredura,
+                                                 .expulsoes = pool->expulsoes,
+                                                 .invalidacoes = pool->invalidacoes,
+                                                 .direto = pool->direto};
+                for (size_t i = 0; i < pool->paginas; i++)
+                        if (pool->quadros[i].ocupado) estado->ocupadas++;
+        }
+        pthread_mutex_unlock(&mutex_pools);
+        return associacao ? SUCESSO : ERRO_ARQUIVO_NULO;
+}
+
+/**
+ * @brief Liga (`paginas` > 0) ou desliga o acesso direto em lote.h e servidor.h.
+ */
+void definir_acesso_direto(size_t paginas) {
+        paginas_modo = paginas;
+}
+
+/**
+ * @brief Quadros do pool com o acesso direto ligado, ou 0.
+ */
+size_t paginas_acesso_direto(void) {
+        return paginas_modo;
+}
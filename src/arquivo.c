@@ -3,19 +3,76 @@
  * @brief Implementa as funções para manipular o arquivo binário que armazenará a árvore binária.
  */
 
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include "../include/acesso_direto.h"
 #include "../include/arquivo.h"
 #include "../include/arvore.h"
 #include "../include/erros.h"
+#include "../include/espaco_livre.h"
+#include "../include/estatisticas.h"
+
+/** Multiplicadores da soma de verificação dos nós (os mesmos do instantâneo). */
+#define PRIMO_SOMA_1 0x9E3779B185EBCA87ull
+#define PRIMO_SOMA_2 0xC2B2AE3D27D4EB4Full
+
+/** Nós lidos por chamada a ler_nos_arquivo() em ler_filhos_arquivo(). */
+#define NOS_POR_BLOCO_FILHOS 1024
+
+_Static_assert(sizeof(NO_ARVORE) % 8 == 0, "NO_ARVORE deve ocupar um múltiplo de 8 bytes");
+
+/**
+ * Início da página 0: o cabeçalho da árvore e a descrição do formato.
+ */
+typedef struct {
+        CABECALHO cabecalho;     /**< Cabeçalho da árvore. */
+        FORMATO_ARQUIVO formato; /**< Formato do arquivo. */
+} PAGINA_CABECALHO;
+
+_Static_assert(sizeof(PAGINA_CABECALHO) <= DESLOCAMENTO_APOSENTADOS,
+               "o fim da página 0 não pode sobrepor o cabeçalho");
+
+/**
+ * Página de dados inteira.
+ */
+typedef struct {
+        METADADOS_PAGINA metadados;    /**< Identificação e somas. */
+        NO_ARVORE nos[NOS_POR_PAGINA]; /**< Nós das vagas. */
+} PAGINA_DADOS;
+
+/**
+ * @brief Diz se `formato` é o deste programa (mesma versão e mesma geometria de página).
+ */
+static int formato_atual(const FORMATO_ARQUIVO* formato) {
+        return formato->magica == MAGICA_ARQUIVO && formato->versao == VERSAO_ARQUIVO &&
+               formato->tamanho_pagina == TAMANHO_PAGINA &&
+               formato->nos_por_pagina == NOS_POR_PAGINA;
+}
+
+/**
+ * @brief Preenche o início da página 0 com `cabecalho` e o formato atual.
+ */
+static void preencher_pagina_cabecalho(PAGINA_CABECALHO* pagina, const CABECALHO* cabecalho) {
+        memset(pagina, 0, sizeof(*pagina));
+        pagina->cabecalho = *cabecalho;
+        pagina->formato.magica = MAGICA_ARQUIVO;
+        pagina->formato.versao = VERSAO_ARQUIVO;
+        pagina->formato.tamanho_pagina = TAMANHO_PAGINA;
+        pagina->formato.nos_por_pagina = NOS_POR_PAGINA;
+}
 
 /**
  * @brief Lê cabeçalho inserido em arquivo binário.
  *
  * @param[in] arquivo Ponteiro para o arquivo aberto para leitura.
- * @return Ponteiro para CABECALHO lido do arquivo ou NULL em caso de erro.
+ * @return Ponteiro para CABECALHO lido do arquivo, ou NULL em caso de erro ou se o arquivo não
+ *         estiver no formato atual (FORMATO_ARQUIVO).
  *
  * @pre `arquivo` deve ser diferente de NULL.
  * @pre O ponteiro do arquivo deve estar posicionado corretamente ou a função irá reposicionar.
@@ -26,23 +83,30 @@
 CABECALHO* le_cabecalho(FILE* arquivo) {
         if (arquivo == NULL) return NULL;
 
+        CONTAR_EVENTO(EVENTO_SEEK);
         if (fseek(arquivo, 0, SEEK_SET) != 0) return NULL;
 
+        CONTAR_EVENTO(EVENTO_ALOCACAO);
         CABECALHO* cabecalho = malloc(sizeof(CABECALHO));
         if (cabecalho == NULL) return NULL;
 
-        if (fread(cabecalho, sizeof(CABECALHO), 1, arquivo) != 1) {
+        CONTAR_EVENTO(EVENTO_LEITURA_CABECALHO);
+
+        PAGINA_CABECALHO pagina;
+        if (fread(&pagina, sizeof(pagina), 1, arquivo) != 1 || !formato_atual(&pagina.formato)) {
                 free(cabecalho);
                 return NULL;
         }
 
+        *cabecalho = pagina.cabecalho;
         return cabecalho;
 }
 
 /**
  * @brief Escreve o cabeçalho em um arquivo binário.
  *
- * Esta função posiciona o ponteiro do arquivo no início e escreve a estrutura CABECALHO.
+ * Esta função posiciona o ponteiro do arquivo no início e escreve a estrutura CABECALHO,
+ * seguida do FORMATO_ARQUIVO atual.
  *
  * @param[in,out] arquivo Ponteiro para arquivo aberto em modo de escrita binária.
  * @param[in] cabecalho Ponteiro para estrutura CABECALHO a ser escrita.
@@ -62,8 +126,12 @@ CABECALHO* le_cabecalho(FILE* arquivo) {
  * @post Em caso de erro, o conteúdo do arquivo pode estar indefinido.
  */
 int escreve_cabecalho(FILE* arquivo, const CABECALHO* cabecalho) {
+        CONTAR_EVENTO(EVENTO_SEEK);
+        CONTAR_EVENTO(EVENTO_ESCRITA_CABECALHO);
         if (fseek(arquivo, 0, SEEK_SET) != 0) return ERRO_ARQUIVO_SEEK;
-        if (fwrite(cabecalho, sizeof(CABECALHO), 1, arquivo) != 1) return ERRO_ARQUIVO_WRITE;
+        PAGINA_CABECALHO pagina;
+        preencher_pagina_cabecalho(&pagina, cabecalho);
+        if (fwrite(&pagina, sizeof(pagina), 1, arquivo) != 1) return ERRO_ARQUIVO_WRITE;
 
         return SUCESSO;
 }
@@ -87,14 +155,13 @@ int escreve_cabecalho(FILE* arquivo, const CABECALHO* cabecalho) {
 NO_ARVORE* ler_no_arquivo(FILE* arquivo, const int posicao) {
         if (arquivo == NULL) return NULL;
 
+        CONTAR_EVENTO(EVENTO_ALOCACAO);
         NO_ARVORE* no = malloc(sizeof(NO_ARVORE));
         if (no == NULL) return NULL;
 
-        if (fseek(arquivo, sizeof(CABECALHO) + posicao * sizeof(NO_ARVORE), SEEK_SET) != 0) {
-                free(no);
-                return NULL;
-        }
-        if (fread(no, sizeof(NO_ARVORE), 1, arquivo) != 1) {
+        CONTAR_EVENTO(EVENTO_SEEK);
+        CONTAR_EVENTO(EVENTO_LEITURA_NO);
+        if (ler_nos_arquivo(arquivo, posicao, 1, no) != SUCESSO) {
                 free(no);
                 return NULL;
         }
@@ -122,9 +189,357 @@ int escrever_no(FILE* arquivo, const NO_ARVORE* no, const int posicao) {
         if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
         if (no == NULL) return ERRO_NO_NULO;
 
-        if (fseek(arquivo, sizeof(CABECALHO) + posicao * sizeof(NO_ARVORE), SEEK_SET) != 0)
+        CONTAR_EVENTO(EVENTO_SEEK);
+        CONTAR_EVENTO(EVENTO_ESCRITA_NO);
+        return escrever_nos(arquivo, no, posicao, 1);
+}
+
+/**
+ * @brief Deslocamento, em bytes, do início da página de dados `pagina`.
+ */
+long inicio_pagina(size_t pagina) {
+        return (long)(pagina + 1) * TAMANHO_PAGINA;
+}
+
+/**
+ * @brief Deslocamento, em bytes, do nó da posição `posicao` no arquivo.
+ *
+ * @return O deslocamento, ou -1 (recusado por fseek()) se `posicao` for negativa.
+ */
+long deslocamento_no(int posicao) {
+        if (posicao < 0) return -1L;
+        size_t vaga = (size_t)posicao % NOS_POR_PAGINA;
+        return inicio_pagina((size_t)posicao / NOS_POR_PAGINA) + (long)sizeof(METADADOS_PAGINA) +
+               (long)(vaga * sizeof(NO_ARVORE));
+}
+
+/**
+ * @brief Soma de verificação de um nó, 8 bytes por passo.
+ *
+ * Quatro acumuladores independentes, para que as multiplicações não esperem umas pelas outras:
+ * a soma é refeita a cada nó lido, no caminho de toda busca.
+ */
+static uint32_t somar_no(const NO_ARVORE* no) {
+        uint64_t palavras[sizeof(NO_ARVORE) / 8];
+        memcpy(palavras, no, sizeof(palavras));
+        uint64_t a = PRIMO_SOMA_1, b = PRIMO_SOMA_2, c = ~PRIMO_SOMA_1, d = ~PRIMO_SOMA_2;
+        size_t i = 0;
+        for (; i + 4 <= sizeof(palavras) / 8; i += 4) {
+                a = (a ^ palavras[i]) * PRIMO_SOMA_1;
+                b = (b ^ palavras[i + 1]) * PRIMO_SOMA_1;
+                c = (c ^ palavras[i + 2]) * PRIMO_SOMA_1;
+                d = (d ^ palavras[i + 3]) * PRIMO_SOMA_1;
+        }
+        for (; i < sizeof(palavras) / 8; i++) a = (a ^ palavras[i]) * PRIMO_SOMA_2;
+        uint64_t soma = a ^ (b << 16 | b >> 48) ^ (c << 32 | c >> 32) ^ (d << 48 | d >> 16);
+        soma = (soma ^ (soma >> 29)) * PRIMO_SOMA_2;
+        return (uint32_t)(soma ^ (soma >> 32));
+}
+
+/**
+ * @brief Copia e confere o nó da posição `posicao` de uma página de dados lida inteira.
+ *
+ * @return SUCESSO, ERRO_NO_NULO ou ERRO_SOMA_PAGINA.
+ */
+int extrair_no_pagina(const void* pagina, int posicao, NO_ARVORE* no) {
+        if (pagina == NULL || no == NULL || posicao < 0) return ERRO_NO_NULO;
+
+        const PAGINA_DADOS* dados = pagina;
+        size_t vaga = (size_t)posicao % NOS_POR_PAGINA;
+        if (dados->metadados.magica != MAGICA_PAGINA ||
+            dados->metadados.numero != (uint32_t)((size_t)posicao / NOS_POR_PAGINA))
+                return ERRO_SOMA_PAGINA;
+        memcpy(no, &dados->nos[vaga], sizeof(NO_ARVORE));
+        return dados->metadados.somas[vaga] == somar_no(no) ? SUCESSO : ERRO_SOMA_PAGINA;
+}
+
+/**
+ * @brief Lê `quantidade` nós de posições consecutivas, a partir de `primeira`.
+ *
+ * @return SUCESSO ou código de erro.
+ */
+int ler_nos_arquivo(FILE* arquivo, int primeira, size_t quantidade, NO_ARVORE* nos) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (nos == NULL || primeira < 0) return ERRO_NO_NULO;
+
+        // Leituras de mais de uma página são varreduras: no acesso direto, não passam pelo pool
+        int varredura = quantidade > NOS_POR_PAGINA;
+        if (varredura) iniciar_varredura(arquivo);
+
+        PAGINA_DADOS pagina_lida[1];
+        size_t posicao = (size_t)primeira;
+        int status = SUCESSO;
+        while (quantidade > 0 && status == SUCESSO) {
+                size_t pagina = posicao / NOS_POR_PAGINA, vaga = posicao % NOS_POR_PAGINA;
+                size_t pedir = NOS_POR_PAGINA - vaga;
+                if (pedir > quantidade) pedir = quantidade;
+
+                // Uma leitura só, do início da página até o último nó pedido: com as páginas
+                // alinhadas, ela cabe num único bloco do disco.
+                size_t bytes = sizeof(METADADOS_PAGINA) + (vaga + pedir) * sizeof(NO_ARVORE);
+                status = ler_pagina_direta(arquivo, pagina, pagina_lida, bytes);
+                if (status == ERRO_ARQUIVO_NULO) {
+                        status = SUCESSO;
+                        if (fseek(arquivo, inicio_pagina(pagina), SEEK_SET) != 0)
+                                status = ERRO_ARQUIVO_SEEK;
+                        else if (fread(pagina_lida, bytes, 1, arquivo) != 1)
+                                status = ERRO_ARQUIVO_READ;
+                }
+                if (status != SUCESSO) break;
+                memcpy(nos, &pagina_lida->nos[vaga], pedir * sizeof(NO_ARVORE));
+
+                const METADADOS_PAGINA* metadados = &pagina_lida->metadados;
+                if (metadados->magica != MAGICA_PAGINA || metadados->numero != (uint32_t)pagina)
+                        status = ERRO_SOMA_PAGINA;
+                for (size_t i = 0; i < pedir && status == SUCESSO; i++)
+                        if (metadados->somas[vaga + i] != somar_no(&nos[i]))
+                                status = ERRO_SOMA_PAGINA;
+
+                posicao += pedir;
+                nos += pedir;
+                quantidade -= pedir;
+        }
+
+        if (varredura) terminar_varredura(arquivo);
+        return status;
+}
+
+/**
+ * @brief Lê só os filhos das `posicoes` primeiras posições, em blocos de NOS_POR_BLOCO_FILHOS.
+ *
+ * @return SUCESSO, ERRO_MEMORIA ou erros de ler_nos_arquivo().
+ */
+int ler_filhos_arquivo(FILE* arquivo, size_t posicoes, int* esquerdo, int* direito) {
+        NO_ARVORE* bloco = malloc(NOS_POR_BLOCO_FILHOS * sizeof(NO_ARVORE));
+        if (bloco == NULL) return ERRO_MEMORIA;
+
+        int status = SUCESSO;
+        for (size_t inicio = 0; status == SUCESSO && inicio < posicoes;
+             inicio += NOS_POR_BLOCO_FILHOS) {
+                size_t pedir = posicoes - inicio;
+                if (pedir > NOS_POR_BLOCO_FILHOS) pedir = NOS_POR_BLOCO_FILHOS;
+                CONTAR_EVENTOS(EVENTO_LEITURA_NO, pedir);
+                status = ler_nos_arquivo(arquivo, (int)inicio, pedir, bloco);
+                for (size_t i = 0; status == SUCESSO && i < pedir; i++) {
+                        esquerdo[inicio + i] = bloco[i].filho_esquerdo;
+                        direito[inicio + i] = bloco[i].filho_direito;
+                }
+        }
+
+        free(bloco);
+        return status;
+}
+
+/**
+ * @brief Grava `gravar` nós a partir da vaga `vaga` da página, com a página inteira passando
+ * pelo pool do acesso direto.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO se o handle não tiver pool, ou erros do pool.
+ */
+static int escrever_nos_direto(FILE* arquivo, const NO_ARVORE* nos, size_t pagina, size_t vaga,
+                               size_t gravar) {
+        PAGINA_DADOS pagina_inteira[1];
+        int status = ler_pagina_direta(arquivo, pagina, pagina_inteira, sizeof(PAGINA_DADOS));
+        if (status != SUCESSO) return status;
+
+        pagina_inteira->metadados.magica = MAGICA_PAGINA;
+        pagina_inteira->metadados.numero = (uint32_t)pagina;
+        for (size_t i = 0; i < gravar; i++)
+                pagina_inteira->metadados.somas[vaga + i] = somar_no(&nos[i]);
+        memcpy(&pagina_inteira->nos[vaga], nos, gravar * sizeof(NO_ARVORE));
+        return gravar_pagina_direta(arquivo, pagina, pagina_inteira);
+}
+
+/**
+ * @brief Grava `gravar` nós a partir da vaga `vaga` da página pelo `FILE*`: as somas das vagas
+ * e depois os nós, sem ler a página.
+ *
+ * @return SUCESSO ou código de erro.
+ */
+static int escrever_nos_pagina(FILE* arquivo, const NO_ARVORE* nos, size_t pagina, size_t vaga,
+                               size_t gravar) {
+        // A identificação da página vai junto com a soma da vaga 0: como o topo cresce de uma
+        // posição por vez, ela é gravada antes de qualquer outra vaga da página.
+        METADADOS_PAGINA metadados;
+        metadados.magica = MAGICA_PAGINA;
+        metadados.numero = (uint32_t)pagina;
+        for (size_t i = 0; i < gravar; i++) metadados.somas[vaga + i] = somar_no(&nos[i]);
+        const char* inicio =
+            vaga == 0 ? (const char*)&metadados : (const char*)&metadados.somas[vaga];
+        size_t bytes = (size_t)((const char*)&metadados.somas[vaga + gravar] - inicio);
+
+        if (fseek(arquivo, inicio_pagina(pagina) + (inicio - (const char*)&metadados),
+                  SEEK_SET) != 0)
+                return ERRO_ARQUIVO_SEEK;
+        if (fwrite(inicio, bytes, 1, arquivo) != 1) return ERRO_ARQUIVO_WRITE;
+        if (fseek(arquivo, deslocamento_no((int)(pagina * NOS_POR_PAGINA + vaga)), SEEK_SET) != 0)
                 return ERRO_ARQUIVO_SEEK;
-        if (fwrite(no, sizeof(NO_ARVORE), 1, arquivo) != 1) return ERRO_ARQUIVO_WRITE;
+        if (fwrite(nos, sizeof(NO_ARVORE), gravar, arquivo) != gravar) return ERRO_ARQUIVO_WRITE;
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava `quantidade` nós em posições consecutivas, a partir de `primeira`.
+ *
+ * @return SUCESSO ou código de erro.
+ */
+int escrever_nos(FILE* arquivo, const NO_ARVORE* nos, int primeira, size_t quantidade) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (nos == NULL || primeira < 0) return ERRO_NO_NULO;
+
+        size_t posicao = (size_t)primeira;
+        while (quantidade > 0) {
+                size_t pagina = posicao / NOS_POR_PAGINA, vaga = posicao % NOS_POR_PAGINA;
+                size_t gravar = NOS_POR_PAGINA - vaga;
+                if (gravar > quantidade) gravar = quantidade;
+
+                int status = escrever_nos_direto(arquivo, nos, pagina, vaga, gravar);
+                if (status == ERRO_ARQUIVO_NULO)
+                        status = escrever_nos_pagina(arquivo, nos, pagina, vaga, gravar);
+                if (status != SUCESSO) return status;
+
+                posicao += gravar;
+                nos += gravar;
+                quantidade -= gravar;
+        }
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava o nó na posição livre `escolhida`, tirando-a do meio da lista livre.
+ *
+ * Confere antes, no arquivo, que `anterior` (ou o cabeçalho) aponta mesmo para ela.
+ *
+ * @return SUCESSO, ERRO_NO_NULO se o mapa não conferir com a lista, ou erros de gravação.
+ */
+static int ocupar_posicao_livre(FILE* arquivo, CABECALHO* cabecalho, const NO_ARVORE* no,
+                                int escolhida, int anterior) {
+        NO_ARVORE* no_anterior = NULL;
+        if (anterior == POSICAO_INVALIDA) {
+                if (cabecalho->livre != escolhida) return ERRO_NO_NULO;
+        } else {
+                no_anterior = ler_no_arquivo(arquivo, anterior);
+                if (no_anterior == NULL || no_anterior->filho_esquerdo != escolhida) {
+                        free(no_anterior);
+                        return ERRO_NO_NULO;
+                }
+        }
+
+        NO_ARVORE* no_livre = ler_no_arquivo(arquivo, escolhida);
+        if (no_livre == NULL) {
+                free(no_anterior);
+                return ERRO_NO_NULO;
+        }
+        int proximo = no_livre->filho_esquerdo;
+        free(no_livre);
+
+        int r = escrever_no(arquivo, no, escolhida);
+        if (r == SUCESSO && no_anterior != NULL) {
+                no_anterior->filho_esquerdo = proximo;
+                r = escrever_no(arquivo, no_anterior, anterior);
+        }
+        free(no_anterior);
+        if (r != SUCESSO) return r;
+
+        if (anterior == POSICAO_INVALIDA) cabecalho->livre = proximo;
+        registrar_alocacao_no_mapa(arquivo, escolhida, anterior, proximo);
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava um nó em uma posição livre, sem gravar o cabeçalho.
+ *
+ * Usa a primeira posição da lista livre ou, se ela estiver vazia, o topo do arquivo, e atualiza
+ * apenas a cópia do cabeçalho em memória. Permite que várias alocações sejam publicadas com
+ * uma única escrita do cabeçalho.
+ *
+ * @param[in,out] arquivo Ponteiro para arquivo aberto para leitura e escrita.
+ * @param[in,out] cabecalho Cópia em memória do cabeçalho, atualizada pela função.
+ * @param[in] no Nó a ser gravado.
+ * @param[out] posicao Posição em que o nó foi gravado.
+ * @return Código de retorno: SUCESSO (0) ou erro específico.
+ */
+int alocar_no_arquivo(FILE* arquivo, CABECALHO* cabecalho, const NO_ARVORE* no, int* posicao) {
+        return alocar_no_arquivo_perto(arquivo, cabecalho, no, POSICAO_INVALIDA, posicao);
+}
+
+/**
+ * @brief Como alocar_no_arquivo(), mas, com um mapa do espaço livre associado ao handle,
+ * prefere uma posição perto de `dica`.
+ *
+ * @param[in,out] arquivo Ponteiro para arquivo aberto para leitura e escrita.
+ * @param[in,out] cabecalho Cópia em memória do cabeçalho, atualizada pela função.
+ * @param[in] no Nó a ser gravado.
+ * @param[in] dica Posição perto da qual alocar, ou POSICAO_INVALIDA.
+ * @param[out] posicao Posição em que o nó foi gravado.
+ * @return Código de retorno: SUCESSO (0) ou erro específico.
+ */
+int alocar_no_arquivo_perto(FILE* arquivo, CABECALHO* cabecalho, const NO_ARVORE* no, int dica,
+                            int* posicao) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+        if (no == NULL) return ERRO_NO_NULO;
+
+        int escolhida, anterior;
+        int perto = escolher_posicao_livre(arquivo, dica, cabecalho->topo, &escolhida,
+                                           &anterior) == SUCESSO;
+        if (perto && escolhida != cabecalho->topo &&
+            ocupar_posicao_livre(arquivo, cabecalho, no, escolhida, anterior) == SUCESSO) {
+                *posicao = escolhida;
+                return SUCESSO;
+        }
+
+        if (cabecalho->livre != POSICAO_INVALIDA && !(perto && escolhida == cabecalho->topo)) {
+                NO_ARVORE* no_livre = ler_no_arquivo(arquivo, cabecalho->livre);
+                if (no_livre == NULL) return ERRO_NO_NULO;
+
+                int r = escrever_no(arquivo, no, cabecalho->livre);
+                if (r != SUCESSO) {
+                        free(no_livre);
+                        return r;
+                }
+
+                *posicao = cabecalho->livre;
+
+                cabecalho->livre = no_livre->filho_esquerdo;
+                free(no_livre);
+        } else {
+                int r = escrever_no(arquivo, no, cabecalho->topo);
+                if (r != SUCESSO) return r;
+
+                *posicao = cabecalho->topo;
+
+                cabecalho->topo++;
+        }
+
+        registrar_alocacao_no_mapa(arquivo, *posicao, POSICAO_INVALIDA, cabecalho->livre);
+        return SUCESSO;
+}
+
+/**
+ * @brief Devolve uma posição à lista livre, sem gravar o cabeçalho.
+ *
+ * Zera o livro armazenado na posição, encadeia-a no início da lista livre e atualiza apenas a
+ * cópia do cabeçalho em memória.
+ *
+ * @param[in,out] arquivo Ponteiro para arquivo aberto para leitura e escrita.
+ * @param[in,out] cabecalho Cópia em memória do cabeçalho, atualizada pela função.
+ * @param[in] posicao Posição a liberar.
+ * @return Código de retorno: SUCESSO (0) ou erro específico.
+ */
+int liberar_no_arquivo(FILE* arquivo, CABECALHO* cabecalho, const int posicao) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+
+        NO_ARVORE no_livre = {0};
+        no_livre.filho_direito = POSICAO_INVALIDA;
+        no_livre.filho_esquerdo = cabecalho->livre;
+
+        int r = escrever_no(arquivo, &no_livre, posicao);
+        if (r != SUCESSO) return r;
+
+        registrar_liberacao_no_mapa(arquivo, posicao, cabecalho->livre);
+        cabecalho->livre = posicao;
 
         return SUCESSO;
 }
@@ -147,6 +562,21 @@ int escrever_no(FILE* arquivo, const NO_ARVORE* no, const int posicao) {
  * @post Valor de posicao_inserida é alterado, refletindo a posição em que o nó foi inserido
  */
 int inserir_no_arquivo(FILE* arquivo, const NO_ARVORE* no_arvore, int* posicao_inserida) {
+        return inserir_no_arquivo_perto(arquivo, no_arvore, POSICAO_INVALIDA, posicao_inserida);
+}
+
+/**
+ * @brief Como inserir_no_arquivo(), preferindo uma posição perto de `dica` (ver
+ * alocar_no_arquivo_perto()).
+ *
+ * @param[in,out] arquivo Ponteiro para arquivo aberto para leitura e escrita.
+ * @param[in] no_arvore Ponteiro para o nó a ser inserido.
+ * @param[in] dica Posição perto da qual alocar, ou POSICAO_INVALIDA.
+ * @param[out] posicao_inserida Posição em que o nó foi inserido.
+ * @return Código de retorno: SUCESSO (0) ou erro específico.
+ */
+int inserir_no_arquivo_perto(FILE* arquivo, const NO_ARVORE* no_arvore, int dica,
+                             int* posicao_inserida) {
         if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
 
         if (no_arvore == NULL) return ERRO_NO_NULO;
@@ -154,38 +584,14 @@ int inserir_no_arquivo(FILE* arquivo, const NO_ARVORE* no_arvore, int* posicao_i
         CABECALHO* cabecalho = le_cabecalho(arquivo);
         if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
 
-        if (cabecalho->livre != POSICAO_INVALIDA) {
-                NO_ARVORE* no_livre = ler_no_arquivo(arquivo, cabecalho->livre);
-                if (no_livre == NULL) {
-                        free(cabecalho);
-                        return ERRO_NO_NULO;
-                }
-
-                int r = escrever_no(arquivo, no_arvore, cabecalho->livre);
-                if (r != SUCESSO) {
-                        free(cabecalho);
-                        free(no_livre);
-                        return r;
-                }
-
-                *posicao_inserida = cabecalho->livre;
-
-                cabecalho->livre = no_livre->filho_esquerdo;
-                free(no_livre);
-        } else {
-                int r = escrever_no(arquivo, no_arvore, cabecalho->topo);
-                if (r != SUCESSO) {
-                        free(cabecalho);
-                        return r;
-                }
-
-                *posicao_inserida = cabecalho->topo;
-
-                cabecalho->topo++;
+        int r = alocar_no_arquivo_perto(arquivo, cabecalho, no_arvore, dica, posicao_inserida);
+        if (r != SUCESSO) {
+                free(cabecalho);
+                return r;
         }
 
         cabecalho->quantidade_livros++;
-        int r = escreve_cabecalho(arquivo, cabecalho);
+        r = escreve_cabecalho(arquivo, cabecalho);
         if (r != SUCESSO) {
                 free(cabecalho);
                 return r;
@@ -217,35 +623,29 @@ int remover_no_arquivo(FILE* arquivo, const int posicao) {
         CABECALHO* cabecalho = le_cabecalho(arquivo);
         if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
 
+        // Garante que a posição existe antes de encadeá-la na lista livre
         NO_ARVORE* no_removido = ler_no_arquivo(arquivo, posicao);
         if (no_removido == NULL) {
                 free(cabecalho);
                 return ERRO_NO_NULO;
         }
+        free(no_removido);
 
-        memset(&no_removido->livro, 0, sizeof(LIVRO));
-        no_removido->filho_direito = POSICAO_INVALIDA;
-        no_removido->filho_esquerdo = cabecalho->livre;
-
-        cabecalho->livre = posicao;
-        cabecalho->quantidade_livros--;
-
-        int r = escrever_no(arquivo, no_removido, posicao);
+        int r = liberar_no_arquivo(arquivo, cabecalho, posicao);
         if (r != SUCESSO) {
                 free(cabecalho);
-                free(no_removido);
                 return r;
         }
 
+        cabecalho->quantidade_livros--;
+
         r = escreve_cabecalho(arquivo, cabecalho);
         if (r != SUCESSO) {
                 free(cabecalho);
-                free(no_removido);
                 return r;
         }
 
         free(cabecalho);
-        free(no_removido);
 
         return SUCESSO;
 }
@@ -315,17 +715,20 @@ int inicializar_arquivo_cabecalho(FILE* arquivo) {
         long tamanho = ftell(arquivo);
         if (tamanho == -1L) return ERRO_ARQUIVO_NULO;
 
-        if ((size_t)tamanho < sizeof(CABECALHO)) {
-                // Arquivo vazio ou menor que o cabeçalho: inicializa
+        if ((size_t)tamanho < sizeof(PAGINA_CABECALHO)) {
+                // Arquivo vazio ou menor que o cabeçalho: inicializa a página 0 inteira
                 CABECALHO cab = {0};
                 cab.quantidade_livros = 0;
                 cab.topo = 0;
                 cab.livre = POSICAO_INVALIDA;
                 cab.raiz = -1;
 
+                unsigned char pagina[TAMANHO_PAGINA] = {0};
+                preencher_pagina_cabecalho((PAGINA_CABECALHO*)pagina, &cab);
+
                 if (fseek(arquivo, 0, SEEK_SET) != 0) return ERRO_ARQUIVO_SEEK;
 
-                if (fwrite(&cab, sizeof(CABECALHO), 1, arquivo) != 1) return ERRO_ARQUIVO_WRITE;
+                if (fwrite(pagina, sizeof(pagina), 1, arquivo) != 1) return ERRO_ARQUIVO_WRITE;
 
                 fflush(arquivo);
         }
@@ -362,3 +765,113 @@ void abrir_ou_criar_arquivo(const char* caminho) {
 
         fclose(arquivo);
 }
+
+/**
+ * @brief Diz se o arquivo está no formato da versão 1: o CABECALHO seguido dos nós, sem páginas.
+ *
+ * Confere o que dá para conferir sem percorrer a árvore: a falta da FORMATO_ARQUIVO, o tamanho
+ * do arquivo e os limites do cabeçalho.
+ *
+ * @param[out] cabecalho Recebe o cabeçalho lido, se for da versão 1 (pode ser NULL).
+ * @return 1 se o arquivo parece da versão 1, 0 caso contrário.
+ */
+int arquivo_formato_v1(FILE* arquivo, CABECALHO* cabecalho) {
+        struct stat estado;
+        if (arquivo == NULL || fflush(arquivo) != 0 || fstat(fileno(arquivo), &estado) != 0)
+                return 0;
+        size_t tamanho = (size_t)estado.st_size;
+        if (tamanho < sizeof(CABECALHO)) return 0;
+
+        PAGINA_CABECALHO pagina;
+        memset(&pagina, 0, sizeof(pagina));
+        size_t ler = tamanho < sizeof(pagina) ? tamanho : sizeof(pagina);
+        if (pread(fileno(arquivo), &pagina, ler, 0) != (ssize_t)ler) return 0;
+        if (pagina.formato.magica == MAGICA_ARQUIVO) return 0;
+
+        const CABECALHO* lido = &pagina.cabecalho;
+        size_t nos = (tamanho - sizeof(CABECALHO)) / sizeof(NO_ARVORE);
+        if ((tamanho - sizeof(CABECALHO)) % sizeof(NO_ARVORE) != 0 || lido->topo < 0 ||
+            (size_t)lido->topo > nos || lido->quantidade_livros > (size_t)lido->topo)
+                return 0;
+        if (lido->raiz < POSICAO_INVALIDA || lido->raiz >= lido->topo ||
+            lido->livre < POSICAO_INVALIDA || lido->livre >= lido->topo)
+                return 0;
+
+        if (cabecalho != NULL) *cabecalho = *lido;
+        return 1;
+}
+
+/**
+ * @brief Lê o contador de alterações dos últimos 8 bytes da página 0.
+ *
+ * @param[in] arquivo Arquivo binário da árvore.
+ * @param[out] alteracoes Valor lido.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO ou ERRO_ARQUIVO_READ.
+ */
+int ler_alteracoes(FILE* arquivo, uint64_t* alteracoes) {
+        if (arquivo == NULL || alteracoes == NULL) return ERRO_ARQUIVO_NULO;
+
+        uint64_t valor = 0;
+        ssize_t lidos = pread(fileno(arquivo), &valor, sizeof(valor), DESLOCAMENTO_ALTERACOES);
+        if (lidos < 0) return ERRO_ARQUIVO_READ;
+
+        // Página 0 mais curta que TAMANHO_PAGINA: o contador ainda não foi gravado
+        *alteracoes = lidos == (ssize_t)sizeof(valor) ? valor : 0;
+        return SUCESSO;
+}
+
+/**
+ * @brief Soma um ao contador de alterações da página 0.
+ *
+ * @param[in,out] arquivo Arquivo binário da árvore.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_READ ou ERRO_ARQUIVO_WRITE.
+ */
+int contar_alteracao(FILE* arquivo) {
+        uint64_t alteracoes = 0;
+        int status = ler_alteracoes(arquivo, &alteracoes);
+        if (status != SUCESSO) return status;
+
+        // O buffer do FILE* vai antes, para não regravar a página 0 por cima do contador
+        if (fflush(arquivo) != 0) return ERRO_ARQUIVO_WRITE;
+
+        // Fora do formato atual (um arquivo da versão 1 à espera de migrar_arquivo(), por
+        // exemplo) não há contador: os últimos bytes da página 0 seriam de um nó.
+        FORMATO_ARQUIVO formato;
+        off_t deslocamento = offsetof(PAGINA_CABECALHO, formato);
+        if (pread(fileno(arquivo), &formato, sizeof(formato), deslocamento) !=
+                (ssize_t)sizeof(formato) ||
+            !formato_atual(&formato))
+                return SUCESSO;
+        alteracoes++;
+        if (pwrite(fileno(arquivo), &alteracoes, sizeof(alteracoes), DESLOCAMENTO_ALTERACOES) !=
+            (ssize_t)sizeof(alteracoes))
+                return ERRO_ARQUIVO_WRITE;
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê o cabeçalho da árvore e os metadados do arquivo de livros.
+ *
+ * @param[in] arquivo Arquivo binário da árvore.
+ * @param[out] identidade Estado lido.
+ * @return SUCESSO, ERRO_ARQUIVO_WRITE, ERRO_CABECALHO_NULO ou ERRO_ARQUIVO_READ.
+ */
+int identificar_arquivo(FILE* arquivo, IDENTIDADE_ARQUIVO* identidade) {
+        if (fflush(arquivo) != 0) return ERRO_ARQUIVO_WRITE;
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+        identidade->raiz = cabecalho->raiz;
+        identidade->topo = cabecalho->topo;
+        identidade->livre = cabecalho->livre;
+        identidade->quantidade = cabecalho->quantidade_livros;
+        free(cabecalho);
+
+        struct stat estado;
+        if (fstat(fileno(arquivo), &estado) != 0) return ERRO_ARQUIVO_READ;
+        identidade->inode = (uint64_t)estado.st_ino;
+        identidade->tamanho = (uint64_t)estado.st_size;
+        identidade->modificacao_s = (int64_t)estado.st_mtim.tv_sec;
+        identidade->modificacao_ns = (int64_t)estado.st_mtim.tv_nsec;
+        return SUCESSO;
+}
@@ -1,15 +1,62 @@
 #include "../include/arvore.h"
 
+#include <limits.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "../include/acesso_direto.h"
 #include "../include/arquivo.h"
 #include "../include/erros.h"
+#include "../include/estatisticas.h"
 #include "../include/fila.h"
+#include "../include/filtro.h"
+#include "../include/indice.h"
 #include "../include/livro.h"
 
+/** Nós acumulados antes de cada escrever_nos() da construção em bloco. */
+#define NOS_POR_ESCRITA 1024
+
+/** Intervalos pendentes ao ligar uma subárvore reconstruída; basta um por nível. */
+#define NIVEIS_RECONSTRUCAO 64
+
+/** Indica se inserir_no_arvore() reconstrói as subárvores fundas demais. */
+static int reconstrucao_parcial = 0;
+
+/**
+ * Caminho da raiz até o ponto de inserção, guardado por descer_arvore() na reconstrução
+ * parcial.
+ */
+typedef struct {
+        int* posicoes;     /**< Nós visitados, da raiz para baixo. */
+        int* irmaos;       /**< Filho não seguido em cada nó visitado. */
+        size_t tamanho;    /**< Nós visitados. */
+        size_t capacidade; /**< Espaço alocado nos dois vetores. */
+} CAMINHO;
+
+/**
+ * @brief Acrescenta um nó ao caminho, aumentando-o se necessário.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+static int adicionar_ao_caminho(CAMINHO* caminho, int posicao, int irmao) {
+        if (caminho->tamanho == caminho->capacidade) {
+                size_t nova = caminho->capacidade ? caminho->capacidade * 2 : 64;
+                CONTAR_EVENTOS(EVENTO_ALOCACAO, 2);
+                int* posicoes = realloc(caminho->posicoes, nova * sizeof(int));
+                if (posicoes == NULL) return ERRO_MEMORIA;
+                caminho->posicoes = posicoes;
+                int* irmaos = realloc(caminho->irmaos, nova * sizeof(int));
+                if (irmaos == NULL) return ERRO_MEMORIA;
+                caminho->irmaos = irmaos;
+                caminho->capacidade = nova;
+        }
+        caminho->posicoes[caminho->tamanho] = posicao;
+        caminho->irmaos[caminho->tamanho++] = irmao;
+        return SUCESSO;
+}
+
 /**
  * @brief Busca o nó com o menor valor a partir de uma posição inicial na árvore.
  *
@@ -86,7 +133,7 @@ static void liberar_resultado_busca(RESULTADO_BUSCA* resultado) {
 }
 
 /**
- * @brief Busca um nó na árvore binária de busca armazenada no arquivo.
+ * @brief Desce a árvore a partir da raiz até o nó do código, ou até onde ele seria inserido.
  *
  * Esta função percorre a árvore binária de busca persistida em arquivo,
  * a partir da raiz, até encontrar o nó cujo código do livro seja igual
@@ -100,16 +147,20 @@ static void liberar_resultado_busca(RESULTADO_BUSCA* resultado) {
  * @param codigo Código único do livro a ser buscado.
  * @param resultado Ponteiro para estrutura RESULTADO_BUSCA onde os dados do nó
  *        encontrado (ou informações para inserção) serão armazenados.
+ * @param[out] caminho Se não for NULL, recebe os nós visitados antes do nó do código (ou do
+ *        ponto de inserção).
  * @return
  * - `SUCESSO` se o nó foi encontrado.
  * - `ERRO_ARQUIVO_NULO` se o ponteiro de arquivo for nulo.
  * - `ERRO_CABECALHO_NULO` se o cabeçalho não puder ser lido.
  * - `ERRO_NO_NULO` se a árvore estiver vazia ou o nó não for encontrado.
+ * - `ERRO_MEMORIA` se o caminho não puder crescer.
  *
  * @note O chamador é responsável por liberar a memória alocada para `resultado->no`
  *       e `resultado->pai` quando não forem mais necessários.
  */
-int buscar_no_arvore(FILE* arquivo, size_t codigo, RESULTADO_BUSCA* resultado) {
+static int descer_arvore(FILE* arquivo, size_t codigo, RESULTADO_BUSCA* resultado,
+                         CAMINHO* caminho) {
         if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
 
         CABECALHO* cabecalho = le_cabecalho(arquivo);
@@ -163,6 +214,14 @@ int buscar_no_arvore(FILE* arquivo, size_t codigo, RESULTADO_BUSCA* resultado) {
                         posicao_atual = no_atual->filho_direito;
                         lado = LADO_DIREITO;
                 }
+
+                int irmao = lado == LADO_ESQUERDO ? no_atual->filho_direito
+                                                  : no_atual->filho_esquerdo;
+                if (caminho && adicionar_ao_caminho(caminho, posicao_pai, irmao) != SUCESSO) {
+                        free(cabecalho);
+                        free(no_pai);
+                        return ERRO_MEMORIA;
+                }
         }
 
         // Não encontrou, mas retornamos info para inserção
@@ -177,38 +236,61 @@ int buscar_no_arvore(FILE* arquivo, size_t codigo, RESULTADO_BUSCA* resultado) {
 }
 
 /**
- * @brief Insere um novo nó na árvore binária de busca armazenada no arquivo.
- *
- * Esta função insere um novo nó (representando um livro) na árvore binária
- * de busca persistida em arquivo. A função verifica se o código do livro já
- * existe na árvore e, caso exista, retorna erro.
- *
- * Caso a árvore esteja vazia, o novo nó será definido como raiz. Caso contrário,
- * ele será inserido como filho esquerdo ou direito do nó pai, de acordo com
- * a ordem binária de busca.
- *
- * @param arquivo Ponteiro para arquivo binário aberto em modo leitura/escrita ("rb+").
- * @param novo Ponteiro para estrutura NO_ARVORE a ser inserida.
- * @return
- * - `SUCESSO` em caso de inserção bem-sucedida.
- * - `ERRO_ARQUIVO_NULO` se o ponteiro de arquivo for nulo.
- * - `ERRO_NO_NULO` se o ponteiro para o novo nó for nulo.
- * - `ERRO_CODIGO_DUPLICADO` se já existir um livro com o mesmo código.
- * - Outros códigos de erro definidos em erros.h podem ser retornados
- *   dependendo do erro ocorrido durante gravação no arquivo.
+ * @brief Corpo de buscar_no_arvore(), sem a medição.
+ */
+static int buscar_no(FILE* arquivo, size_t codigo, RESULTADO_BUSCA* resultado) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        int posicao;
+        int status = buscar_no_indice(arquivo, codigo, &posicao);
+        if (status == SUCESSO || status == ERRO_NO_NULO) {
+                resultado->no = NULL;
+                resultado->pai = NULL;
+                resultado->posicao_no = POSICAO_INVALIDA;
+                resultado->posicao_pai = POSICAO_INVALIDA;
+                resultado->lado = LADO_INVALIDO;
+                if (status == ERRO_NO_NULO) return ERRO_NO_NULO;
+
+                NO_ARVORE* no = ler_no_arquivo(arquivo, posicao);
+                if (no && no->livro.codigo == codigo) {
+                        resultado->no = no;
+                        resultado->posicao_no = posicao;
+                        return SUCESSO;
+                }
+                free(no);
+        }
+
+        return descer_arvore(arquivo, codigo, resultado, NULL);
+}
+
+/**
+ * @brief Busca um nó na árvore binária de busca armazenada no arquivo.
  *
- * @warning Sempre feche (`fclose`) o arquivo após inserir um livro e reabra antes de
- * buscar ou verificar. Isso garante que os dados estejam sincronizados no disco.
+ * Com um índice associado ao handle, lê só o nó apontado por ele; caso contrário, ou se o nó
+ * lido não for o do código (índice com erro), desce a árvore com descer_arvore().
  *
- * @note Esta função chama internamente `inserir_no_arquivo()` para decidir se
- *       utilizará a lista livre ou adicionar no final do arquivo.
+ * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param codigo Código único do livro a ser buscado.
+ * @param resultado Estrutura onde o resultado é armazenado.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO ou ERRO_NO_NULO.
  */
-int inserir_no_arvore(FILE* arquivo, NO_ARVORE* novo) {
+int buscar_no_arvore(FILE* arquivo, size_t codigo, RESULTADO_BUSCA* resultado) {
+        INICIAR_MEDICAO(medicao, OPERACAO_BUSCAR, codigo);
+        int status = buscar_no(arquivo, codigo, resultado);
+        CONCLUIR_MEDICAO(medicao, status);
+        return status;
+}
+
+/**
+ * @brief Insere o novo nó como folha, guardando em `caminho` (se não for NULL) seus ancestrais.
+ */
+static int inserir_folha(FILE* arquivo, NO_ARVORE* novo, CAMINHO* caminho) {
         if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
         if (novo == NULL) return ERRO_NO_NULO;
 
         RESULTADO_BUSCA res;
-        int status = buscar_no_arvore(arquivo, novo->livro.codigo, &res);
+        int status = descer_arvore(arquivo, novo->livro.codigo, &res, caminho);
+        if (status == ERRO_MEMORIA) return status;
 
         if (status == SUCESSO) {
                 // Já existe um nó com este código
@@ -230,12 +312,16 @@ int inserir_no_arvore(FILE* arquivo, NO_ARVORE* novo) {
                 cab->raiz = pos_novo;
                 status = escreve_cabecalho(arquivo, cab);
                 free(cab);
+                if (status == SUCESSO) {
+                        registrar_codigo_no_filtro(arquivo, novo->livro.codigo);
+                        registrar_posicao_no_indice(arquivo, novo->livro.codigo, pos_novo);
+                }
                 return status;
         }
 
-        // Inserir o novo nó no arquivo
+        // Inserir o novo nó no arquivo, perto do pai se houver mapa do espaço livre
         int pos_novo;
-        status = inserir_no_arquivo(arquivo, novo, &pos_novo);
+        status = inserir_no_arquivo_perto(arquivo, novo, res.posicao_pai, &pos_novo);
         if (status != SUCESSO) {
                 if (res.pai) free(res.pai);
                 return status;
@@ -253,11 +339,290 @@ int inserir_no_arvore(FILE* arquivo, NO_ARVORE* novo) {
 
         // Gravar pai atualizado
         status = escrever_no(arquivo, res.pai, res.posicao_pai);
+        if (status == SUCESSO) {
+                registrar_codigo_no_filtro(arquivo, novo->livro.codigo);
+                registrar_posicao_no_indice(arquivo, novo->livro.codigo, pos_novo);
+        }
 
         if (res.pai) free(res.pai);
         return status;
 }
 
+/**
+ * @brief Maior profundidade aceita com `n` nós na reconstrução parcial: ⌊1,5·log2 n⌋.
+ *
+ * É o maior h com 4^h ≤ n³, calculado sem a libm.
+ */
+static size_t profundidade_aceita(size_t n) {
+        double cubo = (double)n * (double)n * (double)n;
+        size_t profundidade = 0;
+        for (double potencia = 4; potencia <= cubo; potencia *= 4) profundidade++;
+        return profundidade;
+}
+
+/**
+ * @brief Visitante que só conta os nós.
+ */
+static int contar_visitado(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)no;
+        (void)posicao;
+        (*(size_t*)contexto)++;
+        return SUCESSO;
+}
+
+/**
+ * Nós de uma subárvore, em ordem, para a reconstrução parcial.
+ */
+typedef struct {
+        NO_ARVORE* nos; /**< Nós lidos. */
+        int* posicoes;  /**< Posição de cada nó lido. */
+        size_t lidos;   /**< Nós lidos até agora. */
+        size_t espaco;  /**< Tamanho dos vetores. */
+} SUBARVORE;
+
+/**
+ * @brief Visitante que guarda o nó e a posição; recusa nós além do tamanho contado.
+ */
+static int guardar_visitado(const NO_ARVORE* no, int posicao, void* contexto) {
+        SUBARVORE* subarvore = contexto;
+        if (subarvore->lidos == subarvore->espaco) return ERRO_NO_NULO;
+        subarvore->nos[subarvore->lidos] = *no;
+        subarvore->posicoes[subarvore->lidos++] = posicao;
+        return SUCESSO;
+}
+
+/**
+ * @brief Compara posições para qsort().
+ */
+static int comparar_posicoes(const void* a, const void* b) {
+        int x = *(const int*)a, y = *(const int*)b;
+        return (x > y) - (x < y);
+}
+
+/**
+ * @brief Posição da raiz balanceada dos nós [`inicio`, `fim`) da subárvore reconstruída.
+ */
+static int mediana_posicoes(const SUBARVORE* subarvore, size_t inicio, size_t fim) {
+        if (inicio >= fim) return POSICAO_INVALIDA;
+        return subarvore->posicoes[inicio + (fim - inicio) / 2];
+}
+
+/**
+ * @brief Liga os nós (em ordem) na árvore balanceada pelas medianas, a mesma forma de
+ * construir_arvore_em_bloco(), com uma pilha explícita de intervalos.
+ */
+static void ligar_balanceada(SUBARVORE* subarvore) {
+        size_t pilha[NIVEIS_RECONSTRUCAO][2] = {{0, subarvore->lidos}};
+        size_t topo = subarvore->lidos > 0;
+        while (topo > 0) {
+                topo--;
+                size_t inicio = pilha[topo][0], fim = pilha[topo][1];
+                size_t meio = inicio + (fim - inicio) / 2;
+                subarvore->nos[meio].filho_esquerdo = mediana_posicoes(subarvore, inicio, meio);
+                subarvore->nos[meio].filho_direito = mediana_posicoes(subarvore, meio + 1, fim);
+                if (meio + 1 < fim) {
+                        pilha[topo][0] = meio + 1;
+                        pilha[topo++][1] = fim;
+                }
+                if (inicio < meio) {
+                        pilha[topo][0] = inicio;
+                        pilha[topo++][1] = meio;
+                }
+        }
+}
+
+/**
+ * @brief Grava os nós nas suas posições, uma chamada a escrever_nos() por trecho de posições
+ * consecutivas.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_SEEK ou ERRO_ARQUIVO_WRITE.
+ */
+static int gravar_trechos(FILE* arquivo, const SUBARVORE* subarvore) {
+        size_t inicio = 0;
+        while (inicio < subarvore->lidos) {
+                size_t fim = inicio + 1;
+                while (fim < subarvore->lidos &&
+                       subarvore->posicoes[fim] == subarvore->posicoes[fim - 1] + 1)
+                        fim++;
+
+                CONTAR_EVENTO(EVENTO_SEEK);
+                CONTAR_EVENTOS(EVENTO_ESCRITA_NO, fim - inicio);
+                int status = escrever_nos(arquivo, &subarvore->nos[inicio],
+                                          subarvore->posicoes[inicio], fim - inicio);
+                if (status != SUCESSO) return status;
+                inicio = fim;
+        }
+        return fflush(arquivo) == 0 ? SUCESSO : ERRO_ARQUIVO_WRITE;
+}
+
+/**
+ * @brief Reconstrói balanceada a subárvore de `caminho->posicoes[indice]`, com `quantidade`
+ * nós, e liga a nova raiz ao pai (ou ao cabeçalho).
+ *
+ * Os nós são lidos em ordem e regravados nas mesmas posições, ordenadas: o nó de posto r vai
+ * para a r-ésima menor posição, de modo que a ordem física da subárvore passa a ser a dos
+ * códigos e posições consecutivas viram uma única escrita.
+ *
+ * @return SUCESSO, ERRO_MEMORIA ou erros de leitura e gravação.
+ */
+static int reconstruir_subarvore(FILE* arquivo, const CAMINHO* caminho, size_t indice,
+                                 size_t quantidade) {
+        SUBARVORE subarvore = {0};
+        subarvore.espaco = quantidade;
+        CONTAR_EVENTOS(EVENTO_ALOCACAO, 3);
+        subarvore.nos = malloc(quantidade * sizeof(NO_ARVORE));
+        subarvore.posicoes = malloc(quantidade * sizeof(int));
+        int* antigas = malloc(quantidade * sizeof(int));
+        int status = subarvore.nos && subarvore.posicoes && antigas ? SUCESSO : ERRO_MEMORIA;
+
+        if (status == SUCESSO)
+                status = percorrer_subarvore_em_ordem(arquivo, caminho->posicoes[indice],
+                                                      guardar_visitado, &subarvore);
+        if (status == SUCESSO && subarvore.lidos != quantidade) status = ERRO_NO_NULO;
+
+        if (status == SUCESSO) {
+                memcpy(antigas, subarvore.posicoes, quantidade * sizeof(int));
+                qsort(subarvore.posicoes, quantidade, sizeof(int), comparar_posicoes);
+                ligar_balanceada(&subarvore);
+                status = gravar_trechos(arquivo, &subarvore);
+        }
+
+        int nova_raiz = mediana_posicoes(&subarvore, 0, quantidade);
+        if (status == SUCESSO && indice == 0) {
+                CABECALHO* cabecalho = le_cabecalho(arquivo);
+                if (cabecalho == NULL) {
+                        status = ERRO_CABECALHO_NULO;
+                } else {
+                        cabecalho->raiz = nova_raiz;
+                        status = escreve_cabecalho(arquivo, cabecalho);
+                        free(cabecalho);
+                }
+        } else if (status == SUCESSO) {
+                int posicao_pai = caminho->posicoes[indice - 1];
+                NO_ARVORE* pai = ler_no_arquivo(arquivo, posicao_pai);
+                if (pai == NULL) {
+                        status = ERRO_NO_NULO;
+                } else {
+                        if (pai->filho_esquerdo == caminho->posicoes[indice])
+                                pai->filho_esquerdo = nova_raiz;
+                        else
+                                pai->filho_direito = nova_raiz;
+                        status = escrever_no(arquivo, pai, posicao_pai);
+                        free(pai);
+                }
+        }
+
+        // Os códigos não mudam, então o filtro continua certo; o índice segue as posições.
+        if (status == SUCESSO)
+                for (size_t i = 0; i < quantidade; i++)
+                        if (subarvore.posicoes[i] != antigas[i])
+                                registrar_posicao_no_indice(arquivo,
+                                                            subarvore.nos[i].livro.codigo,
+                                                            subarvore.posicoes[i]);
+
+        free(subarvore.nos);
+        free(subarvore.posicoes);
+        free(antigas);
+        return status;
+}
+
+/**
+ * @brief Se o nó recém-inserido abaixo de `caminho` estiver fundo demais, reconstrói a
+ * subárvore do bode expiatório.
+ *
+ * Sobe a partir do pai do novo nó somando os tamanhos das subárvores irmãs, até o primeiro
+ * ancestral que tenha o novo nó a mais de profundidade_aceita() níveis abaixo.
+ *
+ * @return SUCESSO, ERRO_CABECALHO_NULO, ERRO_MEMORIA ou erros de leitura e gravação.
+ */
+static int reconstruir_se_fundo(FILE* arquivo, const CAMINHO* caminho) {
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+        size_t livros = cabecalho->quantidade_livros;
+        free(cabecalho);
+
+        size_t profundidade = caminho->tamanho;
+        if (profundidade <= profundidade_aceita(livros)) return SUCESSO;
+
+        size_t tamanho = 1;  // o novo nó
+        for (size_t i = profundidade; i-- > 0;) {
+                size_t irmaos = 0;
+                int status = percorrer_subarvore_em_ordem(arquivo, caminho->irmaos[i],
+                                                          contar_visitado, &irmaos);
+                if (status != SUCESSO) return status;
+                tamanho += 1 + irmaos;
+                if (profundidade - i > profundidade_aceita(tamanho))
+                        return reconstruir_subarvore(arquivo, caminho, i, tamanho);
+        }
+        return SUCESSO;
+}
+
+/**
+ * @brief Corpo de inserir_no_arvore(), sem a medição.
+ */
+static int inserir_no(FILE* arquivo, NO_ARVORE* novo) {
+        if (!reconstrucao_parcial) return inserir_folha(arquivo, novo, NULL);
+
+        CAMINHO caminho = {0};
+        int status = inserir_folha(arquivo, novo, &caminho);
+        if (status == SUCESSO) status = reconstruir_se_fundo(arquivo, &caminho);
+        free(caminho.posicoes);
+        free(caminho.irmaos);
+        return status;
+}
+
+/**
+ * @brief Ativa ou desativa a reconstrução parcial nas inserções de inserir_no_arvore().
+ *
+ * @param ativa Diferente de zero para ativar.
+ */
+void definir_reconstrucao_parcial(int ativa) {
+        reconstrucao_parcial = ativa != 0;
+}
+
+/**
+ * @brief Informa se a reconstrução parcial está ativa.
+ *
+ * @return 1 se ativa, 0 caso contrário.
+ */
+int reconstrucao_parcial_ativa(void) {
+        return reconstrucao_parcial;
+}
+
+/**
+ * @brief Insere um novo nó na árvore binária de busca armazenada no arquivo.
+ *
+ * Esta função insere um novo nó (representando um livro) na árvore binária
+ * de busca persistida em arquivo. A função verifica se o código do livro já
+ * existe na árvore e, caso exista, retorna erro.
+ *
+ * Caso a árvore esteja vazia, o novo nó será definido como raiz. Caso contrário,
+ * ele será inserido como filho esquerdo ou direito do nó pai, de acordo com
+ * a ordem binária de busca.
+ *
+ * @param arquivo Ponteiro para arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param novo Ponteiro para estrutura NO_ARVORE a ser inserida.
+ * @return
+ * - `SUCESSO` em caso de inserção bem-sucedida.
+ * - `ERRO_ARQUIVO_NULO` se o ponteiro de arquivo for nulo.
+ * - `ERRO_NO_NULO` se o ponteiro para o novo nó for nulo.
+ * - `ERRO_CODIGO_DUPLICADO` se já existir um livro com o mesmo código.
+ * - Outros códigos de erro definidos em erros.h podem ser retornados
+ *   dependendo do erro ocorrido durante gravação no arquivo.
+ *
+ * @warning Sempre feche (`fclose`) o arquivo após inserir um livro e reabra antes de
+ * buscar ou verificar. Isso garante que os dados estejam sincronizados no disco.
+ *
+ * @note Esta função chama internamente `inserir_no_arquivo()` para decidir se
+ *       utilizará a lista livre ou adicionar no final do arquivo.
+ */
+int inserir_no_arvore(FILE* arquivo, NO_ARVORE* novo) {
+        INICIAR_MEDICAO(medicao, OPERACAO_INSERIR, novo != NULL ? novo->livro.codigo : 0);
+        int status = inserir_no(arquivo, novo);
+        CONCLUIR_MEDICAO(medicao, status);
+        return status;
+}
+
 /**
  * @brief Função recursiva auxiliar para imprimir os livros da árvore em ordem crescente (in-order).
  *
@@ -320,10 +685,210 @@ int imprimir_in_ordem(FILE* arquivo) {
                 return SUCESSO;
         }
 
+        // Um percurso completo toca cada página uma vez: no acesso direto, vai pelo anel
+        iniciar_varredura(arquivo);
         imprimir_in_ordem_rec(arquivo, raiz);
+        terminar_varredura(arquivo);
         return SUCESSO;
 }
 
+/**
+ * @brief Corpo de percorrer_em_ordem(), sem a medição.
+ */
+static int percorrer(FILE* arquivo, VISITANTE_NO visitar, void* contexto) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+
+        int raiz = cabecalho->raiz;
+        free(cabecalho);
+
+        return percorrer_subarvore_em_ordem(arquivo, raiz, visitar, contexto);
+}
+
+/**
+ * @brief Percorre a árvore em ordem crescente de código, chamando `visitar` para cada nó.
+ *
+ * O percurso é iterativo (pilha explícita), portanto não estoura a pilha de chamadas em árvores
+ * degeneradas, e lê cada nó do arquivo uma única vez.
+ *
+ * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura.
+ * @param visitar Função chamada para cada nó, em ordem crescente de código.
+ * @param contexto Ponteiro repassado a `visitar`.
+ * @return SUCESSO, um código de erro ou o código que interrompeu o percurso.
+ */
+int percorrer_em_ordem(FILE* arquivo, VISITANTE_NO visitar, void* contexto) {
+        INICIAR_MEDICAO(medicao, OPERACAO_PERCORRER, 0);
+        int status = percorrer(arquivo, visitar, contexto);
+        CONCLUIR_MEDICAO(medicao, status);
+        return status;
+}
+
+/**
+ * @brief Corpo de percorrer_subarvore_em_ordem(), fora da varredura.
+ */
+static int percorrer_subarvore(FILE* arquivo, int raiz, VISITANTE_NO visitar, void* contexto) {
+        int posicao_atual = raiz;
+
+        // A pilha guarda o nó inteiro junto com a posição para não reler o nó ao desempilhar
+        typedef struct {
+                NO_ARVORE no;
+                int posicao;
+        } ITEM_PILHA;
+
+        ITEM_PILHA* pilha = NULL;
+        size_t topo = 0;
+        size_t capacidade = 0;
+        int status = SUCESSO;
+
+        while (status == SUCESSO && (posicao_atual != POSICAO_INVALIDA || topo > 0)) {
+                while (posicao_atual != POSICAO_INVALIDA) {
+                        if (topo == capacidade) {
+                                size_t nova_capacidade = capacidade ? capacidade * 2 : 64;
+                                CONTAR_EVENTO(EVENTO_ALOCACAO);
+                                ITEM_PILHA* nova =
+                                    realloc(pilha, nova_capacidade * sizeof(ITEM_PILHA));
+                                if (nova == NULL) {
+                                        free(pilha);
+                                        return ERRO_MEMORIA;
+                                }
+                                pilha = nova;
+                                capacidade = nova_capacidade;
+                        }
+
+                        NO_ARVORE* no = ler_no_arquivo(arquivo, posicao_atual);
+                        if (no == NULL) {
+                                free(pilha);
+                                return ERRO_NO_NULO;
+                        }
+
+                        pilha[topo].no = *no;
+                        pilha[topo].posicao = posicao_atual;
+                        topo++;
+
+                        posicao_atual = no->filho_esquerdo;
+                        free(no);
+                }
+
+                topo--;
+                status = visitar(&pilha[topo].no, pilha[topo].posicao, contexto);
+                posicao_atual = pilha[topo].no.filho_direito;
+        }
+
+        free(pilha);
+        return status;
+}
+
+/**
+ * @brief Percorre em ordem crescente de código a subárvore enraizada em `raiz`.
+ *
+ * No acesso direto (acesso_direto.h), as páginas lidas no percurso vão pelo anel das
+ * varreduras.
+ *
+ * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura.
+ * @param raiz Posição da raiz da subárvore (POSICAO_INVALIDA para subárvore vazia).
+ * @param visitar Função chamada para cada nó, em ordem crescente de código.
+ * @param contexto Ponteiro repassado a `visitar`.
+ * @return SUCESSO, um código de erro ou o código que interrompeu o percurso.
+ */
+int percorrer_subarvore_em_ordem(FILE* arquivo, int raiz, VISITANTE_NO visitar, void* contexto) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        iniciar_varredura(arquivo);
+        int status = percorrer_subarvore(arquivo, raiz, visitar, contexto);
+        terminar_varredura(arquivo);
+        return status;
+}
+
+/**
+ * @brief Corpo de percorrer_intervalo_em_ordem(), fora da varredura.
+ */
+static int percorrer_intervalo(FILE* arquivo, int raiz, size_t inicio, size_t fim,
+                               VISITANTE_NO visitar, void* contexto) {
+        typedef struct {
+                NO_ARVORE no;
+                int posicao;
+        } ITEM_PILHA;
+
+        ITEM_PILHA* pilha = NULL;
+        size_t topo = 0;
+        size_t capacidade = 0;
+        int status = SUCESSO;
+        int posicao_atual = raiz;
+
+        while (status == SUCESSO && (posicao_atual != POSICAO_INVALIDA || topo > 0)) {
+                while (posicao_atual != POSICAO_INVALIDA) {
+                        NO_ARVORE* no = ler_no_arquivo(arquivo, posicao_atual);
+                        if (no == NULL) {
+                                free(pilha);
+                                return ERRO_NO_NULO;
+                        }
+
+                        // Tudo à esquerda de um código menor que o início está fora do intervalo
+                        if (no->livro.codigo < inicio) {
+                                posicao_atual = no->filho_direito;
+                                free(no);
+                                continue;
+                        }
+
+                        if (topo == capacidade) {
+                                size_t nova_capacidade = capacidade ? capacidade * 2 : 64;
+                                CONTAR_EVENTO(EVENTO_ALOCACAO);
+                                ITEM_PILHA* nova =
+                                    realloc(pilha, nova_capacidade * sizeof(ITEM_PILHA));
+                                if (nova == NULL) {
+                                        free(pilha);
+                                        free(no);
+                                        return ERRO_MEMORIA;
+                                }
+                                pilha = nova;
+                                capacidade = nova_capacidade;
+                        }
+
+                        pilha[topo].no = *no;
+                        pilha[topo].posicao = posicao_atual;
+                        topo++;
+
+                        posicao_atual = no->filho_esquerdo;
+                        free(no);
+                }
+
+                if (topo == 0) break;
+                topo--;
+
+                // Em ordem, o primeiro código além do fim encerra o percurso
+                if (pilha[topo].no.livro.codigo > fim) break;
+
+                status = visitar(&pilha[topo].no, pilha[topo].posicao, contexto);
+                posicao_atual = pilha[topo].no.filho_direito;
+        }
+
+        free(pilha);
+        return status;
+}
+
+/**
+ * @brief Percorre em ordem crescente apenas os nós com código em [`inicio`, `fim`].
+ *
+ * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura.
+ * @param raiz Posição da raiz da subárvore.
+ * @param inicio Menor código visitado.
+ * @param fim Maior código visitado.
+ * @param visitar Função chamada para cada nó do intervalo.
+ * @param contexto Ponteiro repassado a `visitar`.
+ * @return Os mesmos códigos de percorrer_subarvore_em_ordem().
+ */
+int percorrer_intervalo_em_ordem(FILE* arquivo, int raiz, size_t inicio, size_t fim,
+                                 VISITANTE_NO visitar, void* contexto) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        iniciar_varredura(arquivo);
+        int status = percorrer_intervalo(arquivo, raiz, inicio, fim, visitar, contexto);
+        terminar_varredura(arquivo);
+        return status;
+}
+
 /**
  * @brief Atualiza o ponteiro do pai ou raiz para um novo filho.
  *
@@ -422,17 +987,24 @@ static int remover_no_interno(FILE* arquivo, RESULTADO_BUSCA* resultado) {
                 }
 
                 resultado->no->livro = res_sub.no->livro;
+                // Sucessor é o próprio filho direito: o nó herda a subárvore direita dele.
+                if (res_sub.pai == NULL) resultado->no->filho_direito = res_sub.no->filho_direito;
                 status = escrever_no(arquivo, resultado->no, resultado->posicao_no);
                 if (status != SUCESSO) {
                         liberar_resultado_busca(&res_sub);
                         return status;
                 }
-
-                int pos_filho_substituto = res_sub.no->filho_direito;
-                status = atualizar_pai_ou_raiz(arquivo, &res_sub, pos_filho_substituto);
-                if (status != SUCESSO) {
-                        liberar_resultado_busca(&res_sub);
-                        return status;
+                // O livro do sucessor mudou de nó.
+                registrar_posicao_no_indice(arquivo, res_sub.no->livro.codigo,
+                                            resultado->posicao_no);
+
+                if (res_sub.pai != NULL) {
+                        int pos_filho_substituto = res_sub.no->filho_direito;
+                        status = atualizar_pai_ou_raiz(arquivo, &res_sub, pos_filho_substituto);
+                        if (status != SUCESSO) {
+                                liberar_resultado_busca(&res_sub);
+                                return status;
+                        }
                 }
 
                 status = remover_no_arquivo(arquivo, res_sub.posicao_no);
@@ -444,15 +1016,9 @@ static int remover_no_interno(FILE* arquivo, RESULTADO_BUSCA* resultado) {
 }
 
 /**
- * @brief Remove um nó da árvore binária de busca no arquivo.
- *
- * Determina se o nó é folha ou interno e chama a função apropriada.
- *
- * @param arquivo Ponteiro para o arquivo da árvore.
- * @param codigo Código do livro a ser removido.
- * @return int Código de status da operação.
+ * @brief Corpo de remover_no_arvore(), sem a medição.
  */
-int remover_no_arvore(FILE* arquivo, size_t codigo) {
+static int remover_no(FILE* arquivo, size_t codigo) {
         if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
 
         CABECALHO* cabecalho = le_cabecalho(arquivo);
@@ -465,7 +1031,7 @@ int remover_no_arvore(FILE* arquivo, size_t codigo) {
 
         int status;
         RESULTADO_BUSCA resultado = {0};
-        status = buscar_no_arvore(arquivo, codigo, &resultado);
+        status = descer_arvore(arquivo, codigo, &resultado, NULL);
         if (status != SUCESSO) {
                 free(cabecalho);
                 liberar_resultado_busca(&resultado);
@@ -478,12 +1044,32 @@ int remover_no_arvore(FILE* arquivo, size_t codigo) {
         } else {
                 status = remover_no_interno(arquivo, &resultado);
         }
+        if (status == SUCESSO) {
+                registrar_remocao_no_filtro(arquivo);
+                remover_do_indice(arquivo, codigo);
+        }
 
         free(cabecalho);
         liberar_resultado_busca(&resultado);
         return status;
 }
 
+/**
+ * @brief Remove um nó da árvore binária de busca no arquivo.
+ *
+ * Determina se o nó é folha ou interno e chama a função apropriada.
+ *
+ * @param arquivo Ponteiro para o arquivo da árvore.
+ * @param codigo Código do livro a ser removido.
+ * @return int Código de status da operação.
+ */
+int remover_no_arvore(FILE* arquivo, size_t codigo) {
+        INICIAR_MEDICAO(medicao, OPERACAO_REMOVER, codigo);
+        int status = remover_no(arquivo, codigo);
+        CONCLUIR_MEDICAO(medicao, status);
+        return status;
+}
+
 /**
  * @brief Imprime a árvore binária armazenada em arquivo por níveis (ordem por largura).
  *
@@ -532,12 +1118,14 @@ int imprimir_arvore_por_niveis(FILE* arquivo) {
 
         int nivel_atual = 0;
 
+        iniciar_varredura(arquivo);
         while (!fila_vazia(fila)) {
                 ITEM_FILA item = desenfileirar(fila);
                 if (item.posicao == -1) break;  // fila vazia, segurança
 
                 NO_ARVORE* no = ler_no_arquivo(arquivo, item.posicao);
                 if (no == NULL) {
+                        terminar_varredura(arquivo);
                         destruir_fila(fila);
                         free(cabecalho);
                         return ERRO_NO_NULO;
@@ -558,9 +1146,132 @@ int imprimir_arvore_por_niveis(FILE* arquivo) {
 
                 free(no);
         }
+        terminar_varredura(arquivo);
 
         printf("\n");
         destruir_fila(fila);
         free(cabecalho);
         return SUCESSO;
 }
+
+/**
+ * Estado da construção em bloco.
+ */
+typedef struct {
+        FILE* arquivo;                     /**< Arquivo binário. */
+        FONTE_LIVROS fonte;                /**< Fornece os livros em ordem. */
+        void* contexto;                    /**< Repassado a `fonte`. */
+        int base;                          /**< Posição do primeiro nó gravado. */
+        NO_ARVORE buffer[NOS_POR_ESCRITA]; /**< Nós aguardando o próximo escrever_nos(). */
+        size_t pendentes;                  /**< Nós em `buffer`. */
+        size_t gravados;                   /**< Nós já enviados ao arquivo. */
+        int status;                        /**< Primeiro erro da fonte ou da gravação. */
+} CONSTRUCAO_BLOCO;
+
+/**
+ * @brief Posição da raiz da subárvore balanceada dos livros [`inicio`, `fim`).
+ */
+static int raiz_intervalo(const CONSTRUCAO_BLOCO* construcao, size_t inicio, size_t fim) {
+        if (inicio >= fim) return POSICAO_INVALIDA;
+        return construcao->base + (int)(inicio + (fim - inicio) / 2);
+}
+
+/**
+ * @brief Envia ao arquivo os nós acumulados.
+ */
+static void descarregar_nos(CONSTRUCAO_BLOCO* construcao) {
+        if (construcao->status != SUCESSO || construcao->pendentes == 0) return;
+
+        CONTAR_EVENTOS(EVENTO_ESCRITA_NO, construcao->pendentes);
+        construcao->status =
+            escrever_nos(construcao->arquivo, construcao->buffer,
+                         construcao->base + (int)construcao->gravados, construcao->pendentes);
+        construcao->gravados += construcao->pendentes;
+        construcao->pendentes = 0;
+}
+
+/**
+ * @brief Grava em ordem os nós da subárvore balanceada dos livros [`inicio`, `fim`).
+ *
+ * Como o percurso é em ordem, a fonte é consumida na sequência e o nó do livro `i` vai para a
+ * posição `base + i`: as posições são gravadas em sequência.
+ */
+static void gravar_intervalo(CONSTRUCAO_BLOCO* construcao, size_t inicio, size_t fim) {
+        if (inicio >= fim || construcao->status != SUCESSO) return;
+        size_t meio = inicio + (fim - inicio) / 2;
+
+        gravar_intervalo(construcao, inicio, meio);
+        if (construcao->status != SUCESSO) return;
+
+        NO_ARVORE* no = &construcao->buffer[construcao->pendentes];
+        construcao->status = construcao->fonte(construcao->contexto, &no->livro);
+        if (construcao->status != SUCESSO) return;
+        no->filho_esquerdo = raiz_intervalo(construcao, inicio, meio);
+        no->filho_direito = raiz_intervalo(construcao, meio + 1, fim);
+        if (++construcao->pendentes == NOS_POR_ESCRITA) descarregar_nos(construcao);
+
+        gravar_intervalo(construcao, meio + 1, fim);
+}
+
+/**
+ * @brief Constrói uma árvore balanceada com `quantidade` livros já ordenados, numa única
+ * escrita sequencial.
+ *
+ * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura/escrita.
+ * @param quantidade Livros da sequência; `fonte` é chamada exatamente esse número de vezes.
+ * @param fonte Fornece os livros em ordem estritamente crescente de código (não verificada).
+ * @param contexto Ponteiro repassado a `fonte`.
+ * @return SUCESSO, ERRO_ARVORE_NAO_VAZIA, erros de leitura e gravação do arquivo, ERRO_MEMORIA
+ *         ou o código devolvido por `fonte`.
+ */
+int construir_arvore_em_bloco(FILE* arquivo, size_t quantidade, FONTE_LIVROS fonte,
+                              void* contexto) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+        if (cabecalho->raiz != POSICAO_INVALIDA) {
+                free(cabecalho);
+                return ERRO_ARVORE_NAO_VAZIA;
+        }
+        if (quantidade > (size_t)(INT_MAX - cabecalho->topo)) {
+                free(cabecalho);
+                return ERRO_MEMORIA;
+        }
+
+        CONTAR_EVENTO(EVENTO_ALOCACAO);
+        CONSTRUCAO_BLOCO* construcao = malloc(sizeof(CONSTRUCAO_BLOCO));
+        if (construcao == NULL) {
+                free(cabecalho);
+                return ERRO_MEMORIA;
+        }
+        construcao->arquivo = arquivo;
+        construcao->fonte = fonte;
+        construcao->contexto = contexto;
+        construcao->base = cabecalho->topo;
+        construcao->pendentes = 0;
+        construcao->gravados = 0;
+        construcao->status = SUCESSO;
+
+        gravar_intervalo(construcao, 0, quantidade);
+        descarregar_nos(construcao);
+        int status = construcao->status;
+        if (status == SUCESSO && fflush(arquivo) != 0) status = ERRO_ARQUIVO_WRITE;
+
+        if (status == SUCESSO) {
+                cabecalho->raiz = raiz_intervalo(construcao, 0, quantidade);
+                cabecalho->topo += (int)quantidade;
+                cabecalho->quantidade_livros += quantidade;
+                status = escreve_cabecalho(arquivo, cabecalho);
+        }
+        // Sequencial, pois os nós acabaram de ser gravados em ordem; se falhar, o filtro só
+        // deixa de descartar códigos e o índice deixa de responder.
+        if (status == SUCESSO) {
+                reconstruir_filtro(arquivo);
+                reconstruir_indice(arquivo);
+        }
+
+        free(construcao);
+        free(cabecalho);
+        return status;
+}
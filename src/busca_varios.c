@@ -0,0 +1,665 @@
+/**
+ * @file busca_varios.c
+ * @brief Implementa a busca de vários códigos com as leituras de cada nível feitas juntas.
+ */
+
+#include "../include/busca_varios.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../include/acesso_direto.h"
+#include "../include/arquivo.h"
+#include "../include/erros.h"
+#include "../include/estatisticas.h"
+#include "../include/filtro.h"
+#include "../include/indice.h"
+
+/** Liga o io_uring nos leitores montados daqui em diante; ver definir_io_uring(). */
+static int io_uring_ligado = 1;
+
+/**
+ * Leitura de uma página de dados.
+ */
+typedef struct {
+        size_t pagina;        /**< Página de dados lida. */
+        unsigned char* dados; /**< Destino, TAMANHO_PAGINA bytes alinhados. */
+        int status;           /**< SUCESSO ou ERRO_ARQUIVO_READ. */
+} PEDIDO_PAGINA;
+
+/**
+ * Busca de um código em andamento.
+ */
+typedef struct {
+        int posicao;    /**< Nó a ler no próximo nível, ou POSICAO_INVALIDA se já terminou. */
+        int via_indice; /**< 1 se `posicao` veio do índice, e não da descida. */
+        size_t passos;  /**< Nós lidos até aqui. */
+        size_t pedido;  /**< Pedido, no nível atual, da página de `posicao`. */
+} BUSCA_PENDENTE;
+
+/**
+ * Anel do io_uring, montado com as chamadas de sistema.
+ */
+typedef struct {
+        int descritor;                   /**< Descritor do anel. */
+        unsigned entradas;               /**< Entradas da fila de envio. */
+        void* fila_envio;                /**< Mapeamento da fila de envio. */
+        size_t tamanho_fila_envio;       /**< Bytes de `fila_envio`. */
+        void* fila_conclusao;            /**< Mapeamento da fila de conclusão (pode ser o mesmo). */
+        size_t tamanho_fila_conclusao;   /**< Bytes de `fila_conclusao`. */
+        struct io_uring_sqe* sqes;       /**< Entradas de envio. */
+        unsigned* envio_cauda;           /**< Cauda da fila de envio. */
+        unsigned* envio_mascara;         /**< Máscara da fila de envio. */
+        unsigned* envio_indices;         /**< Vetor de índices da fila de envio. */
+        unsigned* conclusao_cabeca;      /**< Cabeça da fila de conclusão. */
+        unsigned* conclusao_cauda;       /**< Cauda da fila de conclusão. */
+        unsigned* conclusao_mascara;     /**< Máscara da fila de conclusão. */
+        struct io_uring_cqe* conclusoes; /**< Entradas de conclusão. */
+} ANEL_IO;
+
+/**
+ * Threads que leem as páginas de um nível quando não há io_uring.
+ *
+ * A cada nível, quem chama publica os pedidos e incrementa `geracao`; as threads e ela mesma
+ * pegam pedidos por `proximo` até acabarem.
+ */
+typedef struct {
+        int descritor;                               /**< Descritor do nível atual. */
+        PEDIDO_PAGINA* pedidos;                      /**< Pedidos do nível. */
+        size_t quantidade;                           /**< Pedidos em `pedidos`. */
+        atomic_size_t proximo;                       /**< Próximo pedido livre. */
+        unsigned long geracao;                       /**< Níveis publicados. */
+        size_t ocupadas;                             /**< Threads ainda no nível atual. */
+        int encerrar;                                /**< Pede que as threads terminem. */
+        pthread_mutex_t mutex;                       /**< Protege os campos acima. */
+        pthread_cond_t trabalho;                     /**< Sinaliza um nível novo. */
+        pthread_cond_t concluido;                    /**< Sinaliza `ocupadas` zerado. */
+        pthread_t threads[THREADS_BUSCA_VARIOS - 1]; /**< Threads além de quem chama. */
+        size_t criadas;                              /**< Threads criadas. */
+} GRUPO_LEITORES;
+
+/**
+ * Anel ou threads de leitura de um handle, de abrir_busca_varios() a fechar_busca_varios().
+ *
+ * Não guardam o descritor: cada chamada de buscar_varios() passa o do handle naquele momento.
+ */
+typedef struct LEITOR_PAGINAS {
+        FILE* arquivo;                  /**< Handle do arquivo de livros. */
+        pthread_mutex_t uso;            /**< Travado durante uma chamada de buscar_varios(). */
+        int com_anel;                   /**< 1 se `anel` está montado. */
+        ANEL_IO anel;                   /**< Anel do io_uring. */
+        int com_grupo;                  /**< 1 se `grupo` está montado. */
+        GRUPO_LEITORES grupo;           /**< Threads de leitura. */
+        struct LEITOR_PAGINAS* proximo; /**< Próximo leitor. */
+} LEITOR_PAGINAS;
+
+/**
+ * Caminho pelo qual as páginas de uma chamada de buscar_varios() são lidas.
+ */
+typedef struct {
+        FILE* arquivo;          /**< Arquivo da árvore. */
+        int descritor;          /**< Descritor de `arquivo`. */
+        int com_pool;           /**< 1 se o handle tem o pool do acesso direto. */
+        LEITOR_PAGINAS* leitor; /**< Anel ou threads do handle, travados aqui, ou NULL. */
+} LEITURA_PAGINAS;
+
+/// @brief Handles com anel ou threads de leitura.
+static LEITOR_PAGINAS* leitores = NULL;
+
+/// @brief Protege a lista `leitores`.
+static pthread_mutex_t mutex_leitores = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Completa o pedido com o resultado de uma leitura de `lidos` bytes; o que passou do
+ * fim do arquivo fica zerado.
+ */
+static void concluir_pedido(PEDIDO_PAGINA* pedido, ssize_t lidos) {
+        if (lidos < 0) {
+                pedido->status = ERRO_ARQUIVO_READ;
+                return;
+        }
+        if ((size_t)lidos < TAMANHO_PAGINA)
+                memset(pedido->dados + lidos, 0, TAMANHO_PAGINA - (size_t)lidos);
+        pedido->status = SUCESSO;
+}
+
+/**
+ * @brief Lê a página do pedido com pread().
+ */
+static void ler_com_pread(int descritor, PEDIDO_PAGINA* pedido) {
+        ssize_t lidos;
+        do {
+                lidos = pread(descritor, pedido->dados, TAMANHO_PAGINA,
+                              (off_t)inicio_pagina(pedido->pagina));
+        } while (lidos < 0 && errno == EINTR);
+        concluir_pedido(pedido, lidos);
+}
+
+/**
+ * @brief Desfaz os mapeamentos e fecha o anel.
+ */
+static void destruir_anel(ANEL_IO* anel) {
+        if (anel->sqes != NULL && anel->sqes != MAP_FAILED)
+                munmap(anel->sqes, anel->entradas * sizeof(struct io_uring_sqe));
+        if (anel->fila_conclusao != NULL && anel->fila_conclusao != MAP_FAILED &&
+            anel->fila_conclusao != anel->fila_envio)
+                munmap(anel->fila_conclusao, anel->tamanho_fila_conclusao);
+        if (anel->fila_envio != NULL && anel->fila_envio != MAP_FAILED)
+                munmap(anel->fila_envio, anel->tamanho_fila_envio);
+        close(anel->descritor);
+        memset(anel, 0, sizeof(*anel));
+}
+
+/**
+ * @brief Monta um anel do io_uring com `entradas` entradas.
+ *
+ * @return SUCESSO, ou ERRO_ARQUIVO_NULO se o núcleo não oferecer o io_uring.
+ */
+static int criar_anel(ANEL_IO* anel, unsigned entradas) {
+        struct io_uring_params parametros;
+        memset(&parametros, 0, sizeof(parametros));
+        memset(anel, 0, sizeof(*anel));
+        int descritor = (int)syscall(__NR_io_uring_setup, entradas, &parametros);
+        if (descritor < 0) return ERRO_ARQUIVO_NULO;
+        anel->descritor = descritor;
+        anel->entradas = parametros.sq_entries;
+
+        anel->tamanho_fila_envio =
+            parametros.sq_off.array + parametros.sq_entries * sizeof(unsigned);
+        anel->tamanho_fila_conclusao =
+            parametros.cq_off.cqes + parametros.cq_entries * sizeof(struct io_uring_cqe);
+        int mapa_unico = (parametros.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (mapa_unico && anel->tamanho_fila_conclusao > anel->tamanho_fila_envio)
+                anel->tamanho_fila_envio = anel->tamanho_fila_conclusao;
+
+        anel->fila_envio = mmap(NULL, anel->tamanho_fila_envio, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, descritor, IORING_OFF_SQ_RING);
+        if (anel->fila_envio == MAP_FAILED) {
+                destruir_anel(anel);
+                return ERRO_ARQUIVO_NULO;
+        }
+        anel->fila_conclusao =
+            mapa_unico ? anel->fila_envio
+                       : mmap(NULL, anel->tamanho_fila_conclusao, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, descritor, IORING_OFF_CQ_RING);
+        if (anel->fila_conclusao == MAP_FAILED) {
+                destruir_anel(anel);
+                return ERRO_ARQUIVO_NULO;
+        }
+        anel->sqes = mmap(NULL, parametros.sq_entries * sizeof(struct io_uring_sqe),
+                          PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descritor,
+                          IORING_OFF_SQES);
+        if (anel->sqes == MAP_FAILED) {
+                destruir_anel(anel);
+                return ERRO_ARQUIVO_NULO;
+        }
+
+        unsigned char* envio = anel->fila_envio;
+        unsigned char* conclusao = anel->fila_conclusao;
+        anel->envio_cauda = (unsigned*)(envio + parametros.sq_off.tail);
+        anel->envio_mascara = (unsigned*)(envio + parametros.sq_off.ring_mask);
+        anel->envio_indices = (unsigned*)(envio + parametros.sq_off.array);
+        anel->conclusao_cabeca = (unsigned*)(conclusao + parametros.cq_off.head);
+        anel->conclusao_cauda = (unsigned*)(conclusao + parametros.cq_off.tail);
+        anel->conclusao_mascara = (unsigned*)(conclusao + parametros.cq_off.ring_mask);
+        anel->conclusoes = (struct io_uring_cqe*)(conclusao + parametros.cq_off.cqes);
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê as páginas dos pedidos pelo anel, em levas de até `anel->entradas` leituras.
+ *
+ * Uma leitura que o núcleo recusa é refeita com pread().
+ *
+ * @return SUCESSO, ou ERRO_ARQUIVO_READ se io_uring_enter() falhar; aí quem chama relê tudo
+ *         por outro caminho.
+ */
+static int ler_com_anel(ANEL_IO* anel, int descritor, PEDIDO_PAGINA* pedidos, size_t quantidade) {
+        for (size_t inicio = 0; inicio < quantidade; inicio += anel->entradas) {
+                size_t leva = quantidade - inicio;
+                if (leva > anel->entradas) leva = anel->entradas;
+
+                // A fila está vazia entre as levas: a leva inteira cabe nela
+                unsigned cauda = *anel->envio_cauda;
+                for (size_t i = 0; i < leva; i++, cauda++) {
+                        PEDIDO_PAGINA* pedido = &pedidos[inicio + i];
+                        unsigned vaga = cauda & *anel->envio_mascara;
+                        struct io_uring_sqe* sqe = &anel->sqes[vaga];
+                        memset(sqe, 0, sizeof(*sqe));
+                        sqe->opcode = IORING_OP_READ;
+                        sqe->fd = descritor;
+                        sqe->addr = (uint64_t)(uintptr_t)pedido->dados;
+                        sqe->len = TAMANHO_PAGINA;
+                        sqe->off = (uint64_t)inicio_pagina(pedido->pagina);
+                        sqe->user_data = inicio + i;
+                        anel->envio_indices[vaga] = vaga;
+                }
+                __atomic_store_n(anel->envio_cauda, cauda, __ATOMIC_RELEASE);
+
+                size_t enviar = leva, colhidas = 0;
+                while (colhidas < leva) {
+                        int enviadas = (int)syscall(__NR_io_uring_enter, anel->descritor,
+                                                    (unsigned)enviar, 1u,
+                                                    IORING_ENTER_GETEVENTS, NULL, 0);
+                        if (enviadas < 0) {
+                                if (errno == EINTR) continue;
+                                return ERRO_ARQUIVO_READ;
+                        }
+                        enviar -= (size_t)enviadas;
+
+                        unsigned cabeca = *anel->conclusao_cabeca;
+                        unsigned fim = __atomic_load_n(anel->conclusao_cauda, __ATOMIC_ACQUIRE);
+                        for (; cabeca != fim; cabeca++, colhidas++) {
+                                struct io_uring_cqe* cqe =
+                                    &anel->conclusoes[cabeca & *anel->conclusao_mascara];
+                                PEDIDO_PAGINA* pedido = &pedidos[cqe->user_data];
+                                if (cqe->res < 0)
+                                        ler_com_pread(descritor, pedido);
+                                else
+                                        concluir_pedido(pedido, cqe->res);
+                        }
+                        __atomic_store_n(anel->conclusao_cabeca, cabeca, __ATOMIC_RELEASE);
+                }
+        }
+        return SUCESSO;
+}
+
+/**
+ * @brief Pega pedidos do nível atual até acabarem.
+ */
+static void ler_pedidos_do_grupo(GRUPO_LEITORES* grupo) {
+        size_t i;
+        while ((i = atomic_fetch_add(&grupo->proximo, 1)) < grupo->quantidade)
+                ler_com_pread(grupo->descritor, &grupo->pedidos[i]);
+}
+
+/**
+ * @brief Corpo das threads de leitura: espera um nível novo, lê e avisa ao terminar.
+ */
+static void* executar_leitor(void* argumento) {
+        GRUPO_LEITORES* grupo = argumento;
+        unsigned long vista = 0;
+        pthread_mutex_lock(&grupo->mutex);
+        for (;;) {
+                while (!grupo->encerrar && grupo->geracao == vista)
+                        pthread_cond_wait(&grupo->trabalho, &grupo->mutex);
+                if (grupo->encerrar) break;
+                vista = grupo->geracao;
+                pthread_mutex_unlock(&grupo->mutex);
+
+                ler_pedidos_do_grupo(grupo);
+
+                pthread_mutex_lock(&grupo->mutex);
+                if (--grupo->ocupadas == 0) pthread_cond_signal(&grupo->concluido);
+        }
+        pthread_mutex_unlock(&grupo->mutex);
+        return NULL;
+}
+
+/**
+ * @brief Cria até `threads` threads de leitura; o grupo funciona com as que conseguir criar.
+ */
+static void iniciar_grupo(GRUPO_LEITORES* grupo, size_t threads) {
+        memset(grupo, 0, sizeof(*grupo));
+        atomic_init(&grupo->proximo, 0);
+        pthread_mutex_init(&grupo->mutex, NULL);
+        pthread_cond_init(&grupo->trabalho, NULL);
+        pthread_cond_init(&grupo->concluido, NULL);
+        while (grupo->criadas < threads &&
+               pthread_create(&grupo->threads[grupo->criadas], NULL, executar_leitor, grupo) == 0)
+                grupo->criadas++;
+}
+
+/**
+ * @brief Encerra e espera as threads de leitura.
+ */
+static void encerrar_grupo(GRUPO_LEITORES* grupo) {
+        pthread_mutex_lock(&grupo->mutex);
+        grupo->encerrar = 1;
+        pthread_cond_broadcast(&grupo->trabalho);
+        pthread_mutex_unlock(&grupo->mutex);
+        for (size_t i = 0; i < grupo->criadas; i++) pthread_join(grupo->threads[i], NULL);
+        pthread_cond_destroy(&grupo->concluido);
+        pthread_cond_destroy(&grupo->trabalho);
+        pthread_mutex_destroy(&grupo->mutex);
+}
+
+/**
+ * @brief Lê as páginas dos pedidos com as threads do grupo; quem chama também lê.
+ */
+static void ler_com_grupo(GRUPO_LEITORES* grupo, int descritor, PEDIDO_PAGINA* pedidos,
+                          size_t quantidade) {
+        pthread_mutex_lock(&grupo->mutex);
+        grupo->descritor = descritor;
+        grupo->pedidos = pedidos;
+        grupo->quantidade = quantidade;
+        atomic_store(&grupo->proximo, 0);
+        grupo->ocupadas = grupo->criadas;
+        grupo->geracao++;
+        pthread_cond_broadcast(&grupo->trabalho);
+        pthread_mutex_unlock(&grupo->mutex);
+
+        ler_pedidos_do_grupo(grupo);
+
+        pthread_mutex_lock(&grupo->mutex);
+        while (grupo->ocupadas > 0) pthread_cond_wait(&grupo->concluido, &grupo->mutex);
+        pthread_mutex_unlock(&grupo->mutex);
+}
+
+/**
+ * @brief Monta o anel do io_uring ou, se ele não estiver disponível, as threads de leitura.
+ */
+static void montar_leitor(LEITOR_PAGINAS* leitor) {
+        leitor->com_anel =
+            io_uring_ligado && criar_anel(&leitor->anel, ENTRADAS_IO_URING) == SUCESSO;
+        if (!leitor->com_anel) {
+                iniciar_grupo(&leitor->grupo, THREADS_BUSCA_VARIOS - 1);
+                leitor->com_grupo = 1;
+        }
+}
+
+/**
+ * @brief Desmonta o anel ou as threads do leitor.
+ */
+static void desmontar_leitor(LEITOR_PAGINAS* leitor) {
+        if (leitor->com_anel) destruir_anel(&leitor->anel);
+        if (leitor->com_grupo) encerrar_grupo(&leitor->grupo);
+        leitor->com_anel = leitor->com_grupo = 0;
+}
+
+/**
+ * @brief Escolhe o caminho das leituras: o pool do handle, se houver; senão o anel ou as threads
+ * de abrir_busca_varios(), se estiverem livres; senão pread() por quem chama.
+ *
+ * Quando outra chamada está usando o anel do mesmo handle, esta não espera por ele.
+ */
+static void iniciar_leitura(LEITURA_PAGINAS* leitura, FILE* arquivo) {
+        memset(leitura, 0, sizeof(*leitura));
+        leitura->arquivo = arquivo;
+        leitura->descritor = fileno(arquivo);
+
+        ESTADO_ACESSO_DIRETO estado;
+        leitura->com_pool = consultar_acesso_direto(arquivo, &estado) == SUCESSO;
+        if (leitura->com_pool) return;
+
+        pthread_mutex_lock(&mutex_leitores);
+        for (LEITOR_PAGINAS* leitor = leitores; leitor; leitor = leitor->proximo)
+                if (leitor->arquivo == arquivo) {
+                        if (pthread_mutex_trylock(&leitor->uso) == 0) leitura->leitor = leitor;
+                        break;
+                }
+        pthread_mutex_unlock(&mutex_leitores);
+}
+
+/**
+ * @brief Devolve o anel ou as threads do handle.
+ */
+static void encerrar_leitura(LEITURA_PAGINAS* leitura) {
+        if (leitura->leitor) pthread_mutex_unlock(&leitura->leitor->uso);
+}
+
+/**
+ * @brief Lê as páginas de todos os pedidos de uma leva.
+ */
+static void ler_paginas(LEITURA_PAGINAS* leitura, PEDIDO_PAGINA* pedidos, size_t quantidade) {
+        if (leitura->com_pool) {
+                for (size_t i = 0; i < quantidade; i++)
+                        pedidos[i].status = ler_pagina_direta(leitura->arquivo, pedidos[i].pagina,
+                                                              pedidos[i].dados, TAMANHO_PAGINA);
+                return;
+        }
+        LEITOR_PAGINAS* leitor = leitura->leitor;
+        if (quantidade > 1 && leitor && leitor->com_anel) {
+                if (ler_com_anel(&leitor->anel, leitura->descritor, pedidos, quantidade) == SUCESSO)
+                        return;
+                // O anel pode ter ficado com leituras pela metade: o handle passa para as threads
+                destruir_anel(&leitor->anel);
+                leitor->com_anel = 0;
+                iniciar_grupo(&leitor->grupo, THREADS_BUSCA_VARIOS - 1);
+                leitor->com_grupo = 1;
+        }
+        if (quantidade > 1 && leitor && leitor->com_grupo && leitor->grupo.criadas > 0) {
+                ler_com_grupo(&leitor->grupo, leitura->descritor, pedidos, quantidade);
+                return;
+        }
+        for (size_t i = 0; i < quantidade; i++) ler_com_pread(leitura->descritor, &pedidos[i]);
+}
+
+/**
+ * @brief Compara duas páginas, para qsort() e bsearch().
+ */
+static int comparar_paginas(const void* a, const void* b) {
+        size_t x = *(const size_t*)a, y = *(const size_t*)b;
+        return (x > y) - (x < y);
+}
+
+/**
+ * @brief Monta os pedidos do nível: uma página distinta por pedido, em ordem crescente, e o
+ * pedido de cada busca pendente. O destino de cada pedido é dado por leva, em buscar_varios().
+ *
+ * @param paginas Área de trabalho com uma vaga por busca.
+ * @return Pedidos montados; 0 se não restar busca pendente.
+ */
+static size_t juntar_paginas(BUSCA_PENDENTE* buscas, size_t quantidade, size_t* paginas,
+                             PEDIDO_PAGINA* pedidos) {
+        size_t distintas = 0;
+        for (size_t i = 0; i < quantidade; i++)
+                if (buscas[i].posicao != POSICAO_INVALIDA)
+                        paginas[distintas++] = (size_t)buscas[i].posicao / NOS_POR_PAGINA;
+        if (distintas == 0) return 0;
+
+        qsort(paginas, distintas, sizeof(size_t), comparar_paginas);
+        size_t unicas = 1;
+        for (size_t i = 1; i < distintas; i++)
+                if (paginas[i] != paginas[unicas - 1]) paginas[unicas++] = paginas[i];
+
+        for (size_t k = 0; k < unicas; k++) {
+                pedidos[k].pagina = paginas[k];
+                pedidos[k].dados = NULL;
+                pedidos[k].status = SUCESSO;
+        }
+        for (size_t i = 0; i < quantidade; i++) {
+                if (buscas[i].posicao == POSICAO_INVALIDA) continue;
+                size_t pagina = (size_t)buscas[i].posicao / NOS_POR_PAGINA;
+                size_t* achada = bsearch(&pagina, paginas, unicas, sizeof(size_t),
+                                         comparar_paginas);
+                buscas[i].pedido = (size_t)(achada - paginas);
+        }
+        return unicas;
+}
+
+/**
+ * @brief Encerra a busca com `status`.
+ */
+static void terminar_busca(BUSCA_PENDENTE* busca, RESULTADO_VARIOS* resultado, int status) {
+        resultado->status = status;
+        busca->posicao = POSICAO_INVALIDA;
+}
+
+/**
+ * @brief Avança a busca um nível com o nó lido na página do pedido dela.
+ */
+static void avancar_busca(BUSCA_PENDENTE* busca, const PEDIDO_PAGINA* pedido, size_t codigo,
+                          int raiz, size_t limite, RESULTADO_VARIOS* resultado) {
+        if (pedido->status != SUCESSO) {
+                terminar_busca(busca, resultado, pedido->status);
+                return;
+        }
+        NO_ARVORE no;
+        int status = extrair_no_pagina(pedido->dados, busca->posicao, &no);
+        CONTAR_EVENTO(EVENTO_LEITURA_NO);
+        if (status != SUCESSO) {
+                terminar_busca(busca, resultado, status);
+                return;
+        }
+
+        if (no.livro.codigo == codigo) {
+                resultado->posicao = busca->posicao;
+                resultado->livro = no.livro;
+                terminar_busca(busca, resultado, SUCESSO);
+                return;
+        }
+        // Índice desatualizado: refaz a busca pela descida normal
+        if (busca->via_indice) {
+                busca->via_indice = 0;
+                busca->posicao = raiz;
+                return;
+        }
+        // Mais passos que nós no arquivo só acontece com um ciclo nas ligações
+        if (++busca->passos > limite) {
+                terminar_busca(busca, resultado, ERRO_NO_NULO);
+                return;
+        }
+        busca->posicao = codigo < no.livro.codigo ? no.filho_esquerdo : no.filho_direito;
+        if (busca->posicao == POSICAO_INVALIDA) terminar_busca(busca, resultado, ERRO_NO_NULO);
+}
+
+/**
+ * @brief Busca vários códigos, descendo a árvore um nível por vez.
+ *
+ * @return SUCESSO ou código de erro.
+ */
+int buscar_varios(FILE* arquivo, const size_t codigos[], size_t quantidade,
+                  RESULTADO_VARIOS resultados[]) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (quantidade == 0) return SUCESSO;
+        if (codigos == NULL || resultados == NULL) return ERRO_RESULTADO_BUSCA_NULO;
+
+        // As páginas são lidas pelo descritor: o que ainda está no buffer do FILE* vai antes
+        if (fflush(arquivo) != 0) return ERRO_ARQUIVO_WRITE;
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+        int raiz = cabecalho->raiz;
+        size_t limite = cabecalho->topo > 0 ? (size_t)cabecalho->topo : 0;
+        free(cabecalho);
+
+        BUSCA_PENDENTE* buscas = malloc(quantidade * sizeof(BUSCA_PENDENTE));
+        PEDIDO_PAGINA* pedidos = malloc(quantidade * sizeof(PEDIDO_PAGINA));
+        size_t* paginas = malloc(quantidade * sizeof(size_t));
+
+        // Um nível não pede mais páginas que as buscas nem que o arquivo tem; acima de
+        // PAGINAS_LEVA_BUSCA, elas são lidas em levas
+        size_t leva = quantidade < PAGINAS_LEVA_BUSCA ? quantidade : PAGINAS_LEVA_BUSCA;
+        if (leva > limite / NOS_POR_PAGINA + 1) leva = limite / NOS_POR_PAGINA + 1;
+        unsigned char* memoria = NULL;
+        if (buscas == NULL || pedidos == NULL || paginas == NULL ||
+            posix_memalign((void**)&memoria, TAMANHO_PAGINA, leva * TAMANHO_PAGINA) != 0) {
+                free(buscas);
+                free(pedidos);
+                free(paginas);
+                return ERRO_MEMORIA;
+        }
+
+        for (size_t i = 0; i < quantidade; i++) {
+                memset(&resultados[i], 0, sizeof(RESULTADO_VARIOS));
+                resultados[i].status = ERRO_NO_NULO;
+                resultados[i].posicao = POSICAO_INVALIDA;
+                buscas[i].posicao = POSICAO_INVALIDA;
+                buscas[i].via_indice = 0;
+                buscas[i].passos = 0;
+                if (raiz == POSICAO_INVALIDA || codigo_certamente_ausente(arquivo, codigos[i]))
+                        continue;
+
+                int posicao;
+                int status = buscar_no_indice(arquivo, codigos[i], &posicao);
+                if (status == ERRO_NO_NULO) continue;
+                buscas[i].via_indice = status == SUCESSO;
+                buscas[i].posicao = status == SUCESSO ? posicao : raiz;
+        }
+
+        LEITURA_PAGINAS leitura;
+        iniciar_leitura(&leitura, arquivo);
+        size_t pedidas;
+        while ((pedidas = juntar_paginas(buscas, quantidade, paginas, pedidos)) > 0) {
+                // As buscas avançadas numa leva ficam com o pedido dela e não entram nas seguintes
+                for (size_t inicio = 0; inicio < pedidas; inicio += leva) {
+                        size_t fim = inicio + leva < pedidas ? inicio + leva : pedidas;
+                        for (size_t k = inicio; k < fim; k++)
+                                pedidos[k].dados = memoria + (k - inicio) * TAMANHO_PAGINA;
+                        ler_paginas(&leitura, &pedidos[inicio], fim - inicio);
+                        for (size_t i = 0; i < quantidade; i++)
+                                if (buscas[i].posicao != POSICAO_INVALIDA &&
+                                    buscas[i].pedido >= inicio && buscas[i].pedido < fim)
+                                        avancar_busca(&buscas[i], &pedidos[buscas[i].pedido],
+                                                      codigos[i], raiz, limite, &resultados[i]);
+                }
+        }
+        encerrar_leitura(&leitura);
+
+        free(memoria);
+        free(paginas);
+        free(pedidos);
+        free(buscas);
+        return SUCESSO;
+}
+
+/**
+ * @brief Associa ao handle o anel do io_uring ou as threads de leitura.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO ou ERRO_MEMORIA.
+ */
+int abrir_busca_varios(FILE* arquivo) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        LEITOR_PAGINAS* leitor = calloc(1, sizeof(LEITOR_PAGINAS));
+        if (leitor == NULL) return ERRO_MEMORIA;
+        leitor->arquivo = arquivo;
+
+        pthread_mutex_lock(&mutex_leitores);
+        for (LEITOR_PAGINAS* outro = leitores; outro; outro = outro->proximo)
+                if (outro->arquivo == arquivo) {
+                        pthread_mutex_unlock(&mutex_leitores);
+                        free(leitor);
+                        return SUCESSO;
+                }
+        pthread_mutex_init(&leitor->uso, NULL);
+        montar_leitor(leitor);
+        leitor->proximo = leitores;
+        leitores = leitor;
+        pthread_mutex_unlock(&mutex_leitores);
+        return SUCESSO;
+}
+
+/**
+ * @brief Desfaz a associação e desmonta o anel ou as threads do handle.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_NULO.
+ */
+int fechar_busca_varios(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_leitores);
+        LEITOR_PAGINAS** elo = &leitores;
+        while (*elo && (*elo)->arquivo != arquivo) elo = &(*elo)->proximo;
+        LEITOR_PAGINAS* leitor = *elo;
+        if (leitor) *elo = leitor->proximo;
+        pthread_mutex_unlock(&mutex_leitores);
+        if (leitor == NULL) return ERRO_ARQUIVO_NULO;
+
+        // Espera a chamada que ainda estiver usando o leitor
+        pthread_mutex_lock(&leitor->uso);
+        desmontar_leitor(leitor);
+        pthread_mutex_unlock(&leitor->uso);
+        pthread_mutex_destroy(&leitor->uso);
+        free(leitor);
+        return SUCESSO;
+}
+
+/**
+ * @brief Liga ou desliga o io_uring em abrir_busca_varios().
+ */
+void definir_io_uring(int ativo) {
+        io_uring_ligado = ativo != 0;
+}
+
+/**
+ * @brief Informa se abrir_busca_varios() tenta o io_uring.
+ */
+int io_uring_ativo(void) {
+        return io_uring_ligado;
+}
@@ -0,0 +1,433 @@
+/**
+ * @file catalogo_compactado.c
+ * @brief Implementa o catálogo compactado em blocos para dados frios.
+ */
+
+#include "../include/catalogo_compactado.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/compressao.h"
+#include "../include/erros.h"
+
+#define TAMANHO_BLOCO_BRUTO (LIVROS_POR_BLOCO * sizeof(LIVRO))
+
+/**
+ * Estado da compactação, repassado ao visitante do percurso em ordem.
+ */
+typedef struct {
+        FILE* destino;
+        LIVRO bloco[LIVROS_POR_BLOCO];
+        uint32_t ocupados;
+        unsigned char* comprimido;
+        size_t capacidade_comprimido;
+        ENTRADA_BLOCO* diretorio;
+        uint32_t quantidade_blocos;
+        uint32_t capacidade_diretorio;
+        uint64_t deslocamento;
+        uint64_t quantidade_livros;
+} ESTADO_COMPACTACAO;
+
+/**
+ * @brief Comprime o bloco em formação, grava-o no destino e registra sua entrada no diretório.
+ *
+ * @param estado Estado da compactação.
+ * @return SUCESSO ou código de erro.
+ */
+static int gravar_bloco(ESTADO_COMPACTACAO* estado) {
+        if (estado->ocupados == 0) return SUCESSO;
+
+        if (estado->quantidade_blocos == estado->capacidade_diretorio) {
+                uint32_t nova = estado->capacidade_diretorio ? estado->capacidade_diretorio * 2
+                                                             : 64;
+                ENTRADA_BLOCO* diretorio = realloc(estado->diretorio, nova * sizeof(ENTRADA_BLOCO));
+                if (diretorio == NULL) return ERRO_MEMORIA;
+                estado->diretorio = diretorio;
+                estado->capacidade_diretorio = nova;
+        }
+
+        size_t tamanho_comprimido;
+        int status = comprimir_lz((const unsigned char*)estado->bloco,
+                                  estado->ocupados * sizeof(LIVRO), estado->comprimido,
+                                  estado->capacidade_comprimido, &tamanho_comprimido);
+        if (status != SUCESSO) return status;
+
+        if (fwrite(estado->comprimido, 1, tamanho_comprimido, estado->destino) !=
+            tamanho_comprimido)
+                return ERRO_ARQUIVO_WRITE;
+
+        ENTRADA_BLOCO* entrada = &estado->diretorio[estado->quantidade_blocos++];
+        entrada->primeiro_codigo = estado->bloco[0].codigo;
+        entrada->deslocamento = estado->deslocamento;
+        entrada->tamanho_comprimido = (uint32_t)tamanho_comprimido;
+        entrada->quantidade = estado->ocupados;
+
+        estado->deslocamento += tamanho_comprimido;
+        estado->ocupados = 0;
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Visitante do percurso em ordem: acumula o livro no bloco e grava o bloco quando cheio.
+ */
+static int acumular_livro(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)posicao;
+        ESTADO_COMPACTACAO* estado = contexto;
+
+        estado->bloco[estado->ocupados++] = no->livro;
+        estado->quantidade_livros++;
+
+        if (estado->ocupados == LIVROS_POR_BLOCO) return gravar_bloco(estado);
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê a identidade do arquivo de livros e o seu contador de alterações.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_READ ou erros de ler_alteracoes().
+ */
+static int identificar_origem(FILE* arquivo, uint64_t* dispositivo, uint64_t* inode,
+                              uint64_t* alteracoes) {
+        struct stat estado;
+        if (fstat(fileno(arquivo), &estado) != 0) return ERRO_ARQUIVO_READ;
+        *dispositivo = (uint64_t)estado.st_dev;
+        *inode = (uint64_t)estado.st_ino;
+        return ler_alteracoes(arquivo, alteracoes);
+}
+
+/**
+ * @brief Grava todos os livros da árvore em um arquivo compactado.
+ *
+ * @param arquivo Arquivo binário da árvore, aberto para leitura.
+ * @param destino Arquivo que receberá o catálogo, aberto para escrita binária.
+ * @return SUCESSO ou código de erro.
+ */
+int compactar_catalogo(FILE* arquivo, FILE* destino) {
+        if (arquivo == NULL || destino == NULL) return ERRO_ARQUIVO_NULO;
+
+        ESTADO_COMPACTACAO* estado = calloc(1, sizeof(ESTADO_COMPACTACAO));
+        if (estado == NULL) return ERRO_MEMORIA;
+
+        estado->destino = destino;
+        estado->capacidade_comprimido = limite_comprimido_lz(TAMANHO_BLOCO_BRUTO);
+        estado->comprimido = malloc(estado->capacidade_comprimido);
+        if (estado->comprimido == NULL) {
+                free(estado);
+                return ERRO_MEMORIA;
+        }
+
+        // O cabeçalho definitivo só é conhecido no fim; reserva o espaço agora
+        CABECALHO_COMPACTADO cabecalho = {0};
+        int status = identificar_origem(arquivo, &cabecalho.origem_dispositivo,
+                                        &cabecalho.origem_inode, &cabecalho.origem_alteracoes);
+        if (status == SUCESSO && fseek(destino, 0, SEEK_SET) != 0) status = ERRO_ARQUIVO_SEEK;
+        CABECALHO_COMPACTADO reservado = {0};
+        if (status == SUCESSO && fwrite(&reservado, sizeof(reservado), 1, destino) != 1)
+                status = ERRO_ARQUIVO_WRITE;
+        estado->deslocamento = sizeof(cabecalho);
+
+        if (status == SUCESSO) status = percorrer_em_ordem(arquivo, acumular_livro, estado);
+        if (status == SUCESSO) status = gravar_bloco(estado);
+
+        if (status == SUCESSO && estado->quantidade_blocos > 0 &&
+            fwrite(estado->diretorio, sizeof(ENTRADA_BLOCO), estado->quantidade_blocos,
+                   destino) != estado->quantidade_blocos)
+                status = ERRO_ARQUIVO_WRITE;
+
+        if (status == SUCESSO) {
+                cabecalho.magica = MAGICA_COMPACTADO;
+                cabecalho.versao = VERSAO_COMPACTADO;
+                cabecalho.quantidade_livros = estado->quantidade_livros;
+                cabecalho.livros_por_bloco = LIVROS_POR_BLOCO;
+                cabecalho.quantidade_blocos = estado->quantidade_blocos;
+                cabecalho.posicao_diretorio = estado->deslocamento;
+
+                if (fseek(destino, 0, SEEK_SET) != 0)
+                        status = ERRO_ARQUIVO_SEEK;
+                else if (fwrite(&cabecalho, sizeof(cabecalho), 1, destino) != 1)
+                        status = ERRO_ARQUIVO_WRITE;
+                else if (fflush(destino) != 0)
+                        status = ERRO_ARQUIVO_WRITE;
+        }
+
+        free(estado->diretorio);
+        free(estado->comprimido);
+        free(estado);
+
+        return status;
+}
+
+/**
+ * @brief Abre um catálogo compactado, lendo seu cabeçalho e diretório de blocos.
+ *
+ * @param arquivo Arquivo compactado aberto para leitura binária.
+ * @return Catálogo alocado dinamicamente ou NULL se o arquivo for inválido.
+ */
+CATALOGO_COMPACTADO* abrir_catalogo_compactado(FILE* arquivo) {
+        if (arquivo == NULL) return NULL;
+
+        CATALOGO_COMPACTADO* catalogo = calloc(1, sizeof(CATALOGO_COMPACTADO));
+        if (catalogo == NULL) return NULL;
+        catalogo->arquivo = arquivo;
+
+        for (int i = 0; i < BLOCOS_EM_CACHE; i++) catalogo->cache[i].bloco = POSICAO_INVALIDA;
+
+        if (fseek(arquivo, 0, SEEK_SET) != 0 ||
+            fread(&catalogo->cabecalho, sizeof(CABECALHO_COMPACTADO), 1, arquivo) != 1 ||
+            catalogo->cabecalho.magica != MAGICA_COMPACTADO ||
+            catalogo->cabecalho.versao != VERSAO_COMPACTADO ||
+            catalogo->cabecalho.livros_por_bloco != LIVROS_POR_BLOCO) {
+                free(catalogo);
+                return NULL;
+        }
+        catalogo->bytes_lidos = sizeof(CABECALHO_COMPACTADO);
+
+        uint32_t blocos = catalogo->cabecalho.quantidade_blocos;
+        if (blocos > 0) {
+                catalogo->diretorio = malloc(blocos * sizeof(ENTRADA_BLOCO));
+                if (catalogo->diretorio == NULL ||
+                    fseek(arquivo, (long)catalogo->cabecalho.posicao_diretorio, SEEK_SET) != 0 ||
+                    fread(catalogo->diretorio, sizeof(ENTRADA_BLOCO), blocos, arquivo) != blocos) {
+                        fechar_catalogo_compactado(catalogo);
+                        return NULL;
+                }
+                catalogo->bytes_lidos += blocos * sizeof(ENTRADA_BLOCO);
+        }
+
+        catalogo->capacidade_buffer = limite_comprimido_lz(TAMANHO_BLOCO_BRUTO);
+        catalogo->buffer_comprimido = malloc(catalogo->capacidade_buffer);
+        if (catalogo->buffer_comprimido == NULL) {
+                fechar_catalogo_compactado(catalogo);
+                return NULL;
+        }
+
+        return catalogo;
+}
+
+/**
+ * @brief Informa se o catálogo ainda corresponde ao arquivo de livros de que foi exportado.
+ *
+ * @param catalogo Catálogo aberto.
+ * @param arquivo Arquivo binário da árvore.
+ * @return 1 se for o mesmo arquivo, com o mesmo contador de alterações; 0 caso contrário.
+ */
+int catalogo_compactado_atual(const CATALOGO_COMPACTADO* catalogo, FILE* arquivo) {
+        if (catalogo == NULL || arquivo == NULL) return 0;
+
+        uint64_t dispositivo, inode, alteracoes;
+        if (identificar_origem(arquivo, &dispositivo, &inode, &alteracoes) != SUCESSO) return 0;
+
+        const CABECALHO_COMPACTADO* cabecalho = &catalogo->cabecalho;
+        return cabecalho->origem_dispositivo == dispositivo && cabecalho->origem_inode == inode &&
+               cabecalho->origem_alteracoes == alteracoes;
+}
+
+/**
+ * @brief Libera o catálogo e seu cache. Não fecha o arquivo.
+ *
+ * @param catalogo Catálogo aberto (pode ser NULL).
+ */
+void fechar_catalogo_compactado(CATALOGO_COMPACTADO* catalogo) {
+        if (catalogo == NULL) return;
+
+        for (int i = 0; i < BLOCOS_EM_CACHE; i++) free(catalogo->cache[i].livros);
+        free(catalogo->buffer_comprimido);
+        free(catalogo->diretorio);
+        free(catalogo);
+}
+
+/**
+ * @brief Lê um bloco do disco e o descomprime em `livros`.
+ *
+ * @param catalogo Catálogo aberto.
+ * @param bloco Índice do bloco no diretório.
+ * @param livros Área com espaço para LIVROS_POR_BLOCO registros.
+ * @return SUCESSO ou código de erro.
+ */
+static int carregar_bloco(CATALOGO_COMPACTADO* catalogo, int bloco, LIVRO* livros) {
+        const ENTRADA_BLOCO* entrada = &catalogo->diretorio[bloco];
+
+        if (entrada->tamanho_comprimido > catalogo->capacidade_buffer ||
+            entrada->quantidade > LIVROS_POR_BLOCO)
+                return ERRO_FORMATO_COMPACTADO;
+
+        if (fseek(catalogo->arquivo, (long)entrada->deslocamento, SEEK_SET) != 0)
+                return ERRO_ARQUIVO_SEEK;
+        if (fread(catalogo->buffer_comprimido, 1, entrada->tamanho_comprimido,
+                  catalogo->arquivo) != entrada->tamanho_comprimido)
+                return ERRO_ARQUIVO_READ;
+        catalogo->bytes_lidos += entrada->tamanho_comprimido;
+
+        size_t tamanho;
+        int status = descomprimir_lz(catalogo->buffer_comprimido, entrada->tamanho_comprimido,
+                                     (unsigned char*)livros, TAMANHO_BLOCO_BRUTO, &tamanho);
+        if (status != SUCESSO) return status;
+        if (tamanho != entrada->quantidade * sizeof(LIVRO)) return ERRO_FORMATO_COMPACTADO;
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Devolve os livros de um bloco, descomprimindo-o se não estiver no cache.
+ *
+ * Em caso de falta, substitui a entrada menos recentemente usada.
+ *
+ * @param catalogo Catálogo aberto.
+ * @param bloco Índice do bloco no diretório.
+ * @return Livros do bloco (válidos até a próxima chamada) ou NULL em caso de erro.
+ */
+static const LIVRO* obter_bloco(CATALOGO_COMPACTADO* catalogo, int bloco) {
+        int vitima = 0;
+
+        for (int i = 0; i < BLOCOS_EM_CACHE; i++) {
+                if (catalogo->cache[i].bloco == bloco) {
+                        catalogo->cache[i].uso = ++catalogo->relogio;
+                        return catalogo->cache[i].livros;
+                }
+                if (catalogo->cache[i].uso < catalogo->cache[vitima].uso) vitima = i;
+        }
+
+        BLOCO_EM_CACHE* entrada = &catalogo->cache[vitima];
+        if (entrada->livros == NULL) {
+                entrada->livros = malloc(TAMANHO_BLOCO_BRUTO);
+                if (entrada->livros == NULL) return NULL;
+        }
+
+        entrada->bloco = POSICAO_INVALIDA;
+        if (carregar_bloco(catalogo, bloco, entrada->livros) != SUCESSO) return NULL;
+
+        entrada->bloco = bloco;
+        entrada->uso = ++catalogo->relogio;
+        return entrada->livros;
+}
+
+/**
+ * @brief Localiza o endereço (bloco, slot) de um livro pelo código.
+ *
+ * @param catalogo Catálogo aberto.
+ * @param codigo Código procurado.
+ * @param[out] endereco Endereço do livro, se encontrado.
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO ou erro de leitura.
+ */
+int localizar_livro_compactado(CATALOGO_COMPACTADO* catalogo, size_t codigo,
+                               ENDERECO_COMPACTADO* endereco) {
+        if (catalogo == NULL || endereco == NULL) return ERRO_ARQUIVO_NULO;
+
+        // Último bloco cujo primeiro código é <= codigo
+        int inicio = 0;
+        int fim = (int)catalogo->cabecalho.quantidade_blocos - 1;
+        int bloco = POSICAO_INVALIDA;
+        while (inicio <= fim) {
+                int meio = inicio + (fim - inicio) / 2;
+                if (catalogo->diretorio[meio].primeiro_codigo <= codigo) {
+                        bloco = meio;
+                        inicio = meio + 1;
+                } else {
+                        fim = meio - 1;
+                }
+        }
+        if (bloco == POSICAO_INVALIDA) return ERRO_LIVRO_INVALIDO;
+
+        const LIVRO* livros = obter_bloco(catalogo, bloco);
+        if (livros == NULL) return ERRO_ARQUIVO_READ;
+
+        inicio = 0;
+        fim = (int)catalogo->diretorio[bloco].quantidade - 1;
+        while (inicio <= fim) {
+                int meio = inicio + (fim - inicio) / 2;
+                if (livros[meio].codigo == codigo) {
+                        endereco->bloco = bloco;
+                        endereco->slot = meio;
+                        return SUCESSO;
+                }
+                if (livros[meio].codigo < codigo)
+                        inicio = meio + 1;
+                else
+                        fim = meio - 1;
+        }
+
+        return ERRO_LIVRO_INVALIDO;
+}
+
+/**
+ * @brief Lê o livro armazenado em um endereço do catálogo, passando pelo cache de blocos.
+ *
+ * @param catalogo Catálogo aberto.
+ * @param endereco Endereço devolvido por localizar_livro_compactado().
+ * @param[out] livro Livro lido.
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO ou erro de leitura.
+ */
+int ler_livro_compactado(CATALOGO_COMPACTADO* catalogo, ENDERECO_COMPACTADO endereco,
+                         LIVRO* livro) {
+        if (catalogo == NULL || livro == NULL) return ERRO_ARQUIVO_NULO;
+
+        uint32_t blocos = catalogo->cabecalho.quantidade_blocos;
+        if (endereco.bloco < 0 || (uint32_t)endereco.bloco >= blocos || endereco.slot < 0 ||
+            (uint32_t)endereco.slot >= catalogo->diretorio[endereco.bloco].quantidade)
+                return ERRO_LIVRO_INVALIDO;
+
+        const LIVRO* livros = obter_bloco(catalogo, endereco.bloco);
+        if (livros == NULL) return ERRO_ARQUIVO_READ;
+
+        *livro = livros[endereco.slot];
+        return SUCESSO;
+}
+
+/**
+ * @brief Busca um livro pelo código no catálogo compactado.
+ *
+ * @param catalogo Catálogo aberto.
+ * @param codigo Código procurado.
+ * @param[out] livro Livro encontrado.
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO ou erro de leitura.
+ */
+int buscar_livro_compactado(CATALOGO_COMPACTADO* catalogo, size_t codigo, LIVRO* livro) {
+        ENDERECO_COMPACTADO endereco;
+        int status = localizar_livro_compactado(catalogo, codigo, &endereco);
+        if (status != SUCESSO) return status;
+
+        return ler_livro_compactado(catalogo, endereco, livro);
+}
+
+/**
+ * @brief Imprime todos os livros do catálogo em ordem de código.
+ *
+ * @param catalogo Catálogo aberto.
+ * @return SUCESSO ou código de erro.
+ */
+int imprimir_compactado_em_ordem(CATALOGO_COMPACTADO* catalogo) {
+        if (catalogo == NULL) return ERRO_ARQUIVO_NULO;
+
+        if (catalogo->cabecalho.quantidade_blocos == 0) {
+                printf("Arvore vazia.\n");
+                return SUCESSO;
+        }
+
+        LIVRO* livros = malloc(TAMANHO_BLOCO_BRUTO);
+        if (livros == NULL) return ERRO_MEMORIA;
+
+        for (uint32_t b = 0; b < catalogo->cabecalho.quantidade_blocos; b++) {
+                int status = carregar_bloco(catalogo, (int)b, livros);
+                if (status != SUCESSO) {
+                        free(livros);
+                        return status;
+                }
+
+                for (uint32_t i = 0; i < catalogo->diretorio[b].quantidade; i++) {
+                        printf(
+                            "Codigo: %zu\nTitulo: %s\nAutor: %s\nExemplares: "
+                            "%zu\n\n",
+                            livros[i].codigo, livros[i].titulo, livros[i].autor,
+                            livros[i].exemplares);
+                }
+        }
+
+        free(livros);
+        return SUCESSO;
+}
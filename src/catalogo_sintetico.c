@@ -0,0 +1,292 @@
+/**
+ * @file catalogo_sintetico.c
+ * @brief Implementa a geração de catálogos sintéticos reprodutíveis.
+ */
+
+#include "../include/catalogo_sintetico.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/livro.h"
+#include "../include/utils.h"
+
+/** Termos somados um a um no cálculo de zeta(n); o resto é aproximado pela integral. */
+#define TERMOS_ZETA_EXATOS 1000000
+
+/**
+ * Estado da fonte do caminho rápido: percorre o mapa de códigos em ordem.
+ */
+typedef struct {
+        const CATALOGO_SINTETICO* catalogo; /**< Parâmetros dos livros. */
+        const uint8_t* presentes;           /**< Um bit por código, 1 se algum livro o usa. */
+        size_t proximo;                     /**< Próximo código a examinar. */
+} FONTE_CATALOGO;
+
+/**
+ * @brief Número pseudoaleatório determinado por três valores.
+ */
+static uint64_t sortear(uint64_t semente, uint64_t a, uint64_t b) {
+        return espalhar_codigo((size_t)(espalhar_codigo((size_t)(semente ^ a)) + b));
+}
+
+/**
+ * @brief Fração uniforme em [0, 1) a partir de um sorteio.
+ */
+static double fracao(uint64_t sorteio) {
+        return (double)(sorteio >> 11) / 9007199254740992.0;
+}
+
+/**
+ * @brief Prepara uma permutação de [0, limite) sorteada a partir da semente.
+ */
+static void iniciar_permutacao(PERMUTACAO* permutacao, uint64_t limite, uint64_t semente) {
+        unsigned bits = 2;
+        while (bits < 64 && (UINT64_C(1) << bits) < limite) bits++;
+
+        permutacao->limite = limite;
+        permutacao->mascara = bits == 64 ? UINT64_MAX : (UINT64_C(1) << bits) - 1;
+        permutacao->deslocamento = bits / 2;
+        for (int i = 0; i < RODADAS_PERMUTACAO; i++) {
+                permutacao->multiplicador[i] = sortear(semente, 0x5045524Du, i) | 1;
+                permutacao->soma[i] = sortear(semente, 0x534F4D41u, i);
+        }
+}
+
+/**
+ * @brief Imagem de `x` pela permutação.
+ *
+ * Cada rodada (multiplicação por ímpar, soma e xorshift, tudo módulo 2^bits) é uma bijeção;
+ * valores que caem fora de [0, limite) são permutados de novo até voltar ao intervalo.
+ */
+static uint64_t permutar(const PERMUTACAO* permutacao, uint64_t x) {
+        do {
+                for (int i = 0; i < RODADAS_PERMUTACAO; i++) {
+                        x = (x * permutacao->multiplicador[i] + permutacao->soma[i]) &
+                            permutacao->mascara;
+                        x ^= x >> permutacao->deslocamento;
+                }
+        } while (x >= permutacao->limite);
+        return x;
+}
+
+/**
+ * @brief zeta(n, theta) = soma de 1/i^theta para i de 1 a n.
+ */
+static double zeta(uint64_t n, double theta) {
+        uint64_t exatos = n < TERMOS_ZETA_EXATOS ? n : TERMOS_ZETA_EXATOS;
+        double soma = 0;
+        for (uint64_t i = 1; i <= exatos; i++) soma += pow((double)i, -theta);
+        if (n > exatos)
+                soma += (pow(n + 0.5, 1 - theta) - pow(exatos + 0.5, 1 - theta)) / (1 - theta);
+        return soma;
+}
+
+/**
+ * @brief Calcula as constantes do sorteio Zipf sobre [1, n].
+ */
+static void iniciar_zipf(ZIPF* zipf, uint64_t n, double theta) {
+        double zeta2 = zeta(2, theta);
+        zipf->theta = theta;
+        zipf->zetan = zeta(n, theta);
+        zipf->alfa = 1 / (1 - theta);
+        zipf->eta = (1 - pow(2.0 / n, 1 - theta)) / (1 - zeta2 / zipf->zetan);
+}
+
+/**
+ * @brief Posto em [1, n] com probabilidade proporcional a 1/posto^theta.
+ */
+static uint64_t sortear_zipf(const ZIPF* zipf, uint64_t n, double u) {
+        double uz = u * zipf->zetan;
+        if (uz < 1) return 1;
+        if (uz < 1 + pow(0.5, zipf->theta)) return 2;
+
+        uint64_t posto = 1 + (uint64_t)(n * pow(zipf->eta * u - zipf->eta + 1, zipf->alfa));
+        return posto > n ? n : posto;
+}
+
+/**
+ * @brief Código da linha pela distribuição, sem considerar as duplicatas.
+ */
+static size_t codigo_base(const CATALOGO_SINTETICO* catalogo, size_t linha) {
+        size_t n = catalogo->linhas;
+        switch (catalogo->distribuicao) {
+                case DISTRIBUICAO_ORDENADA:
+                        return linha + 1;
+                case DISTRIBUICAO_REVERSA:
+                        return n - linha;
+                case DISTRIBUICAO_ALEATORIA:
+                        return permutar(&catalogo->permutacao, linha) + 1;
+                case DISTRIBUICAO_AGRUPADA:
+                        return permutar(&catalogo->permutacao, linha / catalogo->grupo) *
+                                   catalogo->grupo +
+                               linha % catalogo->grupo + 1;
+                case DISTRIBUICAO_ZIPF:
+                default: {
+                        double u = fracao(sortear(catalogo->semente, 0x5A495046u, linha));
+                        uint64_t posto = sortear_zipf(&catalogo->zipf, n, u);
+                        return permutar(&catalogo->permutacao, posto - 1) + 1;
+                }
+        }
+}
+
+/**
+ * @brief Código da linha: o da distribuição ou, para a fração de duplicatas, o de uma linha
+ * anterior sorteada.
+ */
+static size_t codigo_da_linha(const CATALOGO_SINTETICO* catalogo, size_t linha) {
+        while (linha > 0 && catalogo->duplicatas > 0) {
+                uint64_t sorteio = sortear(catalogo->semente, 0x44555055u, linha);
+                if (fracao(sorteio) >= catalogo->duplicatas) break;
+                linha = (sorteio >> 8) % linha;
+        }
+        return codigo_base(catalogo, linha);
+}
+
+/**
+ * @brief Maior código que a distribuição pode gerar.
+ */
+static size_t maior_codigo(const CATALOGO_SINTETICO* catalogo) {
+        if (catalogo->distribuicao != DISTRIBUICAO_AGRUPADA) return catalogo->linhas;
+        return (catalogo->linhas + catalogo->grupo - 1) / catalogo->grupo * catalogo->grupo;
+}
+
+/**
+ * @brief Preenche `destino` com palavras pseudoaleatórias de comprimento sorteado.
+ *
+ * @param campo Distingue os campos do mesmo livro.
+ * @param capacidade Maior comprimento do campo, sem o terminador.
+ */
+static void gerar_texto(const CATALOGO_SINTETICO* catalogo, size_t codigo, unsigned campo,
+                        char* destino, size_t capacidade) {
+        static const char* const silabas[] = {"ba", "ca", "de", "fi", "go", "lu", "ma", "ne",
+                                              "po", "ri", "sa", "te", "vo", "xa", "zu", "an",
+                                              "or", "el", "im", "us"};
+        const size_t quantidade_silabas = sizeof(silabas) / sizeof(silabas[0]);
+
+        size_t minimo = catalogo->comprimento_minimo;
+        size_t maximo = catalogo->comprimento_maximo < capacidade ? catalogo->comprimento_maximo
+                                                                  : capacidade;
+        if (minimo > maximo) minimo = maximo;
+        uint64_t base = sortear(catalogo->semente, codigo, campo);
+        double u = fracao(base);
+        if (catalogo->cauda) u = u * u * u;
+        size_t comprimento = minimo + (size_t)(u * (maximo - minimo + 1));
+        if (comprimento > maximo) comprimento = maximo;
+
+        size_t escrito = 0;
+        for (uint64_t i = 0; escrito < comprimento; i++) {
+                uint64_t sorteio = sortear(base, i, 0);
+                // Espaço entre palavras, nunca no início nem no fim do campo.
+                if (escrito > 0 && escrito + 1 < comprimento && sorteio % 4 == 0 &&
+                    destino[escrito - 1] != ' ') {
+                        destino[escrito++] = ' ';
+                        continue;
+                }
+                const char* silaba = silabas[(sorteio >> 8) % quantidade_silabas];
+                for (size_t j = 0; silaba[j] != '\0' && escrito < comprimento; j++)
+                        destino[escrito++] = silaba[j];
+        }
+        if (escrito > 0 && destino[escrito - 1] == ' ') destino[escrito - 1] = 'a';
+        if (escrito > 0) destino[0] = (char)(destino[0] - 'a' + 'A');
+        destino[escrito] = '\0';
+}
+
+/**
+ * @brief Livro do código: os mesmos campos no texto e no caminho rápido.
+ */
+static void gerar_livro(const CATALOGO_SINTETICO* catalogo, size_t codigo, LIVRO* livro) {
+        memset(livro, 0, sizeof(*livro));
+        livro->codigo = codigo;
+        gerar_texto(catalogo, codigo, 1, livro->titulo, MAX_TITULO);
+        gerar_texto(catalogo, codigo, 2, livro->autor, MAX_AUTOR);
+        gerar_texto(catalogo, codigo, 3, livro->editora, MAX_EDITORA);
+
+        uint64_t sorteio = sortear(catalogo->semente, codigo, 0);
+        livro->edicao = sorteio % 9 + 1;
+        livro->ano = 1900 + (sorteio >> 8) % 126;
+        livro->exemplares = (sorteio >> 16) % 51;
+        livro->preco = (double)(500 + (sorteio >> 24) % 29501) / 100;
+}
+
+/**
+ * @brief Sorteia a permutação e, na distribuição zipf, calcula as constantes do sorteio.
+ *
+ * @param theta Expoente da zipf, entre 0 e 1.
+ */
+void preparar_catalogo_sintetico(CATALOGO_SINTETICO* catalogo, double theta) {
+        size_t grupos = catalogo->distribuicao == DISTRIBUICAO_AGRUPADA
+                            ? (catalogo->linhas + catalogo->grupo - 1) / catalogo->grupo
+                            : catalogo->linhas;
+        iniciar_permutacao(&catalogo->permutacao, grupos, catalogo->semente);
+        if (catalogo->distribuicao == DISTRIBUICAO_ZIPF)
+                iniciar_zipf(&catalogo->zipf, catalogo->linhas, theta);
+}
+
+/**
+ * @brief Escreve as linhas do catálogo no formato de importação.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_WRITE.
+ */
+int escrever_catalogo_texto(const CATALOGO_SINTETICO* catalogo, FILE* saida) {
+        for (size_t linha = 0; linha < catalogo->linhas; linha++) {
+                LIVRO livro;
+                gerar_livro(catalogo, codigo_da_linha(catalogo, linha), &livro);
+                size_t centavos = (size_t)(livro.preco * 100 + 0.5);
+                if (fprintf(saida, "%zu;%s;%s;%s;%zu;%zu;%zu;%zu,%02zu\n", livro.codigo,
+                            livro.titulo, livro.autor, livro.editora, livro.edicao, livro.ano,
+                            livro.exemplares, centavos / 100, centavos % 100) < 0)
+                        return ERRO_ARQUIVO_WRITE;
+        }
+        return fflush(saida) == 0 ? SUCESSO : ERRO_ARQUIVO_WRITE;
+}
+
+/**
+ * @brief Fonte de construir_arvore_em_bloco(): o próximo código presente, em ordem.
+ */
+static int proximo_livro(void* contexto, LIVRO* livro) {
+        FONTE_CATALOGO* fonte = contexto;
+        while (!(fonte->presentes[fonte->proximo / 8] & (1u << (fonte->proximo % 8))))
+                fonte->proximo++;
+        gerar_livro(fonte->catalogo, fonte->proximo++, livro);
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava os livros dos códigos distintos do catálogo num arquivo de livros vazio.
+ *
+ * @param[out] distintos Livros gravados.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_MEMORIA ou erros de construir_arvore_em_bloco().
+ */
+int escrever_catalogo_binario(const CATALOGO_SINTETICO* catalogo, const char* caminho,
+                              size_t* distintos) {
+        size_t maior = maior_codigo(catalogo);
+        uint8_t* presentes = calloc(maior / 8 + 1, 1);
+        if (presentes == NULL) return ERRO_MEMORIA;
+
+        *distintos = 0;
+        for (size_t linha = 0; linha < catalogo->linhas; linha++) {
+                size_t codigo = codigo_da_linha(catalogo, linha);
+                if (!(presentes[codigo / 8] & (1u << (codigo % 8)))) {
+                        presentes[codigo / 8] |= (uint8_t)(1u << (codigo % 8));
+                        (*distintos)++;
+                }
+        }
+
+        abrir_ou_criar_arquivo(caminho);
+        FILE* arquivo = fopen(caminho, "rb+");
+        if (arquivo == NULL) {
+                free(presentes);
+                return ERRO_ARQUIVO_NULO;
+        }
+
+        FONTE_CATALOGO fonte = {catalogo, presentes, 1};
+        int status = construir_arvore_em_bloco(arquivo, *distintos, proximo_livro, &fonte);
+        if (fclose(arquivo) != 0 && status == SUCESSO) status = ERRO_ARQUIVO_WRITE;
+        free(presentes);
+        return status;
+}
@@ -0,0 +1,316 @@
+/**
+ * @file cliente.c
+ * @brief Implementa a biblioteca cliente do servidor de consultas.
+ */
+
+#include "../include/cliente.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../include/erros.h"
+
+#define BYTES_POR_LEITURA (64 * 1024)  //!< Bytes pedidos a cada recv
+
+/**
+ * @brief Conecta ao servidor pelo socket de domínio Unix.
+ *
+ * @param caminho_socket Caminho do socket do servidor.
+ * @return Cliente conectado, ou NULL em caso de erro.
+ */
+CLIENTE* conectar_servidor(const char* caminho_socket) {
+        if (caminho_socket == NULL) return NULL;
+
+        struct sockaddr_un endereco = {0};
+        endereco.sun_family = AF_UNIX;
+        if (strlen(caminho_socket) >= sizeof(endereco.sun_path)) return NULL;
+        strcpy(endereco.sun_path, caminho_socket);
+
+        CLIENTE* cliente = calloc(1, sizeof(CLIENTE));
+        if (cliente == NULL) return NULL;
+
+        cliente->descritor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (cliente->descritor < 0) {
+                free(cliente);
+                return NULL;
+        }
+
+        if (connect(cliente->descritor, (struct sockaddr*)&endereco, sizeof(endereco)) != 0) {
+                close(cliente->descritor);
+                free(cliente);
+                return NULL;
+        }
+
+        cliente->proximo_id = 1;
+        return cliente;
+}
+
+/**
+ * @brief Fecha a conexão e libera o cliente.
+ */
+void desconectar_servidor(CLIENTE* cliente) {
+        if (cliente == NULL) return;
+
+        close(cliente->descritor);
+        liberar_buffer(&cliente->entrada);
+        liberar_buffer(&cliente->saida);
+        free(cliente);
+}
+
+/**
+ * @brief Acrescenta um pedido completo (cabeçalho e carga) à fila de saída.
+ */
+static int enfileirar(CLIENTE* cliente, uint16_t operacao, const void* carga, uint32_t tamanho,
+                      uint32_t* id) {
+        if (cliente == NULL) return ERRO_CONEXAO;
+
+        CABECALHO_PEDIDO pedido = {0};
+        pedido.id = cliente->proximo_id++;
+        pedido.operacao = operacao;
+        pedido.tamanho = tamanho;
+
+        if (reservar_buffer(&cliente->saida, sizeof(pedido) + tamanho) == NULL)
+                return ERRO_MEMORIA;
+        acrescentar_buffer(&cliente->saida, &pedido, sizeof(pedido));
+        if (tamanho > 0) acrescentar_buffer(&cliente->saida, carga, tamanho);
+
+        if (id) *id = pedido.id;
+        return SUCESSO;
+}
+
+/**
+ * @brief Enfileira uma busca por código.
+ */
+int enfileirar_busca(CLIENTE* cliente, size_t codigo, uint32_t* id) {
+        uint64_t valor = codigo;
+        return enfileirar(cliente, PEDIDO_BUSCAR, &valor, sizeof(valor), id);
+}
+
+/**
+ * @brief Enfileira o cadastro de um livro.
+ */
+int enfileirar_insercao(CLIENTE* cliente, const LIVRO* livro, uint32_t* id) {
+        if (livro == NULL) return ERRO_LIVRO_INVALIDO;
+        return enfileirar(cliente, PEDIDO_INSERIR, livro, sizeof(LIVRO), id);
+}
+
+/**
+ * @brief Enfileira a remoção de um livro.
+ */
+int enfileirar_remocao(CLIENTE* cliente, size_t codigo, uint32_t* id) {
+        uint64_t valor = codigo;
+        return enfileirar(cliente, PEDIDO_REMOVER, &valor, sizeof(valor), id);
+}
+
+/**
+ * @brief Enfileira uma consulta pelos livros com código em [`inicio`, `fim`].
+ */
+int enfileirar_intervalo(CLIENTE* cliente, size_t inicio, size_t fim, uint32_t limite,
+                         uint32_t* id) {
+        DADOS_INTERVALO dados = {0};
+        dados.inicio = inicio;
+        dados.fim = fim;
+        dados.limite = limite;
+        return enfileirar(cliente, PEDIDO_INTERVALO, &dados, sizeof(dados), id);
+}
+
+/**
+ * @brief Enfileira um pedido de estatísticas.
+ */
+int enfileirar_estatisticas(CLIENTE* cliente, uint32_t* id) {
+        return enfileirar(cliente, PEDIDO_ESTATISTICAS, NULL, 0, id);
+}
+
+/**
+ * @brief Recebe bytes do servidor para o buffer de entrada.
+ *
+ * @param flags Flags de recv (MSG_DONTWAIT para não bloquear).
+ * @return SUCESSO (mesmo sem dados, se não bloqueante) ou ERRO_CONEXAO.
+ */
+static int receber_bytes(CLIENTE* cliente, int flags) {
+        unsigned char* destino = reservar_buffer(&cliente->entrada, BYTES_POR_LEITURA);
+        if (destino == NULL) return ERRO_MEMORIA;
+
+        for (;;) {
+                ssize_t lidos = recv(cliente->descritor, destino, BYTES_POR_LEITURA, flags);
+                if (lidos > 0) {
+                        cliente->entrada.tamanho += (size_t)lidos;
+                        return SUCESSO;
+                }
+                if (lidos == 0) return ERRO_CONEXAO;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return SUCESSO;
+                if (errno != EINTR) return ERRO_CONEXAO;
+        }
+}
+
+/**
+ * @brief Envia todos os pedidos enfileirados.
+ *
+ * @return SUCESSO ou ERRO_CONEXAO.
+ */
+int enviar_pedidos(CLIENTE* cliente) {
+        if (cliente == NULL) return ERRO_CONEXAO;
+
+        BUFFER_BYTES* saida = &cliente->saida;
+        while (pendentes_buffer(saida) > 0) {
+                struct pollfd espera = {cliente->descritor, POLLIN | POLLOUT, 0};
+                if (poll(&espera, 1, -1) < 0) {
+                        if (errno == EINTR) continue;
+                        return ERRO_CONEXAO;
+                }
+
+                // Lê as respostas que já chegaram para o servidor poder continuar escrevendo
+                if (espera.revents & POLLIN) {
+                        int status = receber_bytes(cliente, MSG_DONTWAIT);
+                        if (status != SUCESSO) return status;
+                }
+
+                if (espera.revents & (POLLERR | POLLHUP)) return ERRO_CONEXAO;
+                if (!(espera.revents & POLLOUT)) continue;
+
+                ssize_t enviados = send(cliente->descritor, saida->dados + saida->inicio,
+                                        pendentes_buffer(saida), MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (enviados > 0)
+                        consumir_buffer(saida, (size_t)enviados);
+                else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                        return ERRO_CONEXAO;
+        }
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Espera e devolve a próxima resposta.
+ *
+ * @param[out] resposta Resposta recebida.
+ * @return SUCESSO, ERRO_CONEXAO ou ERRO_PROTOCOLO.
+ */
+int receber_resposta(CLIENTE* cliente, RESPOSTA_CLIENTE* resposta) {
+        if (cliente == NULL || resposta == NULL) return ERRO_CONEXAO;
+
+        BUFFER_BYTES* entrada = &cliente->entrada;
+        CABECALHO_RESPOSTA cabecalho;
+
+        for (;;) {
+                if (pendentes_buffer(entrada) >= sizeof(cabecalho)) {
+                        memcpy(&cabecalho, entrada->dados + entrada->inicio, sizeof(cabecalho));
+                        if (cabecalho.tamanho > TAMANHO_MAXIMO_CARGA) return ERRO_PROTOCOLO;
+                        if (pendentes_buffer(entrada) >= sizeof(cabecalho) + cabecalho.tamanho)
+                                break;
+                }
+
+                int status = receber_bytes(cliente, 0);
+                if (status != SUCESSO) return status;
+        }
+
+        resposta->id = cabecalho.id;
+        resposta->status = cabecalho.status;
+        resposta->tamanho = cabecalho.tamanho;
+        resposta->carga = entrada->dados + entrada->inicio + sizeof(cabecalho);
+
+        // Os bytes continuam no buffer até a próxima recepção
+        consumir_buffer(entrada, sizeof(cabecalho) + cabecalho.tamanho);
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Envia o pedido enfileirado e espera a resposta correspondente.
+ */
+static int trocar(CLIENTE* cliente, uint32_t id, RESPOSTA_CLIENTE* resposta) {
+        int status = enviar_pedidos(cliente);
+        if (status == SUCESSO) status = receber_resposta(cliente, resposta);
+        if (status == SUCESSO && resposta->id != id) status = ERRO_PROTOCOLO;
+        return status == SUCESSO ? resposta->status : status;
+}
+
+/**
+ * @brief Busca um livro pelo código.
+ */
+int cliente_buscar(CLIENTE* cliente, size_t codigo, LIVRO* livro) {
+        uint32_t id;
+        int status = enfileirar_busca(cliente, codigo, &id);
+        if (status != SUCESSO) return status;
+
+        RESPOSTA_CLIENTE resposta;
+        status = trocar(cliente, id, &resposta);
+        if (status != SUCESSO) return status;
+        if (resposta.tamanho != sizeof(LIVRO)) return ERRO_PROTOCOLO;
+
+        if (livro) memcpy(livro, resposta.carga, sizeof(LIVRO));
+        return SUCESSO;
+}
+
+/**
+ * @brief Cadastra um livro.
+ */
+int cliente_inserir(CLIENTE* cliente, const LIVRO* livro) {
+        uint32_t id;
+        int status = enfileirar_insercao(cliente, livro, &id);
+        if (status != SUCESSO) return status;
+
+        RESPOSTA_CLIENTE resposta;
+        return trocar(cliente, id, &resposta);
+}
+
+/**
+ * @brief Remove um livro.
+ */
+int cliente_remover(CLIENTE* cliente, size_t codigo) {
+        uint32_t id;
+        int status = enfileirar_remocao(cliente, codigo, &id);
+        if (status != SUCESSO) return status;
+
+        RESPOSTA_CLIENTE resposta;
+        return trocar(cliente, id, &resposta);
+}
+
+/**
+ * @brief Lista os livros com código em [`inicio`, `fim`], em ordem.
+ */
+int cliente_intervalo(CLIENTE* cliente, size_t inicio, size_t fim, uint32_t limite,
+                      LIVRO** livros, size_t* quantidade) {
+        if (livros == NULL || quantidade == NULL) return ERRO_NO_NULO;
+
+        uint32_t id;
+        int status = enfileirar_intervalo(cliente, inicio, fim, limite, &id);
+        if (status != SUCESSO) return status;
+
+        RESPOSTA_CLIENTE resposta;
+        status = trocar(cliente, id, &resposta);
+        if (status != SUCESSO) return status;
+
+        uint32_t n;
+        if (resposta.tamanho < sizeof(n)) return ERRO_PROTOCOLO;
+        memcpy(&n, resposta.carga, sizeof(n));
+        if (resposta.tamanho != sizeof(n) + (size_t)n * sizeof(LIVRO)) return ERRO_PROTOCOLO;
+
+        *livros = malloc(n ? (size_t)n * sizeof(LIVRO) : 1);
+        if (*livros == NULL) return ERRO_MEMORIA;
+
+        memcpy(*livros, resposta.carga + sizeof(n), (size_t)n * sizeof(LIVRO));
+        *quantidade = n;
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê os contadores do servidor.
+ */
+int cliente_estatisticas(CLIENTE* cliente, ESTATISTICAS_SERVIDOR* estatisticas) {
+        uint32_t id;
+        int status = enfileirar_estatisticas(cliente, &id);
+        if (status != SUCESSO) return status;
+
+        RESPOSTA_CLIENTE resposta;
+        status = trocar(cliente, id, &resposta);
+        if (status != SUCESSO) return status;
+        if (resposta.tamanho != sizeof(ESTATISTICAS_SERVIDOR)) return ERRO_PROTOCOLO;
+
+        if (estatisticas) memcpy(estatisticas, resposta.carga, sizeof(ESTATISTICAS_SERVIDOR));
+        return SUCESSO;
+}
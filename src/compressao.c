@@ -0,0 +1,232 @@
+/**
+ * @file compressao.c
+ * @brief Implementa o codec LZ utilizado pelo catálogo compactado.
+ *
+ * Formato de cada sequência: um token (4 bits altos = literais, 4 bits baixos = repetição - 4),
+ * bytes de extensão 255 quando um dos campos chega a 15, os literais, o deslocamento da
+ * repetição em 16 bits little-endian e a extensão do comprimento da repetição. A última
+ * sequência contém apenas literais.
+ */
+
+#include "../include/compressao.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/erros.h"
+
+#define LZ_REPETICAO_MINIMA 4
+#define LZ_BITS_HASH 12
+#define LZ_TAMANHO_HASH (1 << LZ_BITS_HASH)
+#define LZ_JANELA 65535
+#define LZ_LITERAIS_FINAIS 5  //!< Bytes finais sempre emitidos como literais
+#define LZ_ENTRADA_MINIMA 12  //!< Abaixo disso o bloco inteiro vira literais
+
+/**
+ * @brief Lê 4 bytes sem exigir alinhamento.
+ */
+static uint32_t ler_u32(const unsigned char* p) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+}
+
+/**
+ * @brief Espalha os 4 bytes lidos em um índice da tabela hash (hash multiplicativo de Knuth).
+ */
+static uint32_t hash_sequencia(uint32_t sequencia) {
+        return (sequencia * 2654435761u) >> (32 - LZ_BITS_HASH);
+}
+
+/**
+ * @brief Escreve o excedente de um campo do token como bytes 255 seguidos do resto.
+ *
+ * @return Ponteiro após o último byte escrito ou NULL se faltar espaço.
+ */
+static unsigned char* escrever_extensao(unsigned char* op, const unsigned char* fim, size_t valor) {
+        while (valor >= 255) {
+                if (op >= fim) return NULL;
+                *op++ = 255;
+                valor -= 255;
+        }
+        if (op >= fim) return NULL;
+        *op++ = (unsigned char)valor;
+        return op;
+}
+
+/**
+ * @brief Emite uma sequência: literais de `ancora` até `literais_fim` e, se `comprimento` > 0,
+ * uma repetição de `comprimento` bytes a `deslocamento` bytes atrás.
+ *
+ * @return Ponteiro após a sequência ou NULL se faltar espaço em destino.
+ */
+static unsigned char* emitir_sequencia(unsigned char* op, const unsigned char* fim,
+                                       const unsigned char* ancora, size_t literais,
+                                       size_t deslocamento, size_t comprimento) {
+        if (op >= fim) return NULL;
+
+        size_t repeticao = comprimento ? comprimento - LZ_REPETICAO_MINIMA : 0;
+        unsigned char* token = op++;
+        *token = (unsigned char)(((literais < 15 ? literais : 15) << 4) |
+                                 (repeticao < 15 ? repeticao : 15));
+
+        if (literais >= 15 && (op = escrever_extensao(op, fim, literais - 15)) == NULL) return NULL;
+
+        if ((size_t)(fim - op) < literais) return NULL;
+        memcpy(op, ancora, literais);
+        op += literais;
+
+        if (comprimento == 0) return op;
+
+        if (fim - op < 2) return NULL;
+        *op++ = (unsigned char)(deslocamento & 0xFF);
+        *op++ = (unsigned char)(deslocamento >> 8);
+
+        if (repeticao >= 15 && (op = escrever_extensao(op, fim, repeticao - 15)) == NULL)
+                return NULL;
+
+        return op;
+}
+
+/**
+ * @brief Calcula o tamanho máximo que um bloco de `tamanho` bytes pode ocupar após comprimido.
+ *
+ * @param tamanho Quantidade de bytes da entrada.
+ * @return Capacidade de destino suficiente para qualquer entrada desse tamanho.
+ */
+size_t limite_comprimido_lz(size_t tamanho) {
+        return tamanho + tamanho / 255 + 16;
+}
+
+/**
+ * @brief Comprime um bloco de memória.
+ *
+ * @param[in] origem Bytes a comprimir.
+ * @param[in] tamanho Quantidade de bytes em `origem`.
+ * @param[out] destino Área que receberá o bloco comprimido.
+ * @param[in] capacidade Tamanho de `destino`.
+ * @param[out] tamanho_saida Quantidade de bytes escritos em `destino`.
+ * @return SUCESSO ou ERRO_COMPRESSAO.
+ */
+int comprimir_lz(const unsigned char* origem, size_t tamanho, unsigned char* destino,
+                 size_t capacidade, size_t* tamanho_saida) {
+        if (origem == NULL || destino == NULL || tamanho_saida == NULL) return ERRO_COMPRESSAO;
+
+        // Posições guardadas com +1 para que 0 signifique "vazio"
+        uint32_t tabela[LZ_TAMANHO_HASH] = {0};
+
+        const unsigned char* fim_destino = destino + capacidade;
+        unsigned char* op = destino;
+        size_t ancora = 0;
+        size_t ip = 0;
+
+        if (tamanho >= LZ_ENTRADA_MINIMA) {
+                size_t limite_inicio = tamanho - LZ_ENTRADA_MINIMA;
+                size_t limite_repeticao = tamanho - LZ_LITERAIS_FINAIS;
+
+                while (ip <= limite_inicio) {
+                        uint32_t sequencia = ler_u32(origem + ip);
+                        uint32_t h = hash_sequencia(sequencia);
+                        size_t candidato = tabela[h];
+                        tabela[h] = (uint32_t)(ip + 1);
+
+                        if (candidato == 0 || ip - (candidato - 1) > LZ_JANELA ||
+                            ler_u32(origem + candidato - 1) != sequencia) {
+                                ip++;
+                                continue;
+                        }
+
+                        size_t referencia = candidato - 1;
+                        size_t comprimento = LZ_REPETICAO_MINIMA;
+                        while (ip + comprimento < limite_repeticao &&
+                               origem[referencia + comprimento] == origem[ip + comprimento])
+                                comprimento++;
+
+                        op = emitir_sequencia(op, fim_destino, origem + ancora, ip - ancora,
+                                              ip - referencia, comprimento);
+                        if (op == NULL) return ERRO_COMPRESSAO;
+
+                        ip += comprimento;
+                        ancora = ip;
+                }
+        }
+
+        op = emitir_sequencia(op, fim_destino, origem + ancora, tamanho - ancora, 0, 0);
+        if (op == NULL) return ERRO_COMPRESSAO;
+
+        *tamanho_saida = (size_t)(op - destino);
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê a extensão de um campo do token (bytes 255 acumulados até um byte menor).
+ *
+ * @return Ponteiro após a extensão ou NULL se o bloco terminar antes.
+ */
+static const unsigned char* ler_extensao(const unsigned char* ip, const unsigned char* fim,
+                                         size_t* valor) {
+        unsigned char byte;
+        do {
+                if (ip >= fim) return NULL;
+                byte = *ip++;
+                *valor += byte;
+        } while (byte == 255);
+        return ip;
+}
+
+/**
+ * @brief Descomprime um bloco produzido por comprimir_lz().
+ *
+ * @param[in] origem Bloco comprimido.
+ * @param[in] tamanho Quantidade de bytes em `origem`.
+ * @param[out] destino Área que receberá os bytes originais.
+ * @param[in] capacidade Tamanho de `destino`.
+ * @param[out] tamanho_saida Quantidade de bytes escritos em `destino`.
+ * @return SUCESSO ou ERRO_COMPRESSAO.
+ */
+int descomprimir_lz(const unsigned char* origem, size_t tamanho, unsigned char* destino,
+                    size_t capacidade, size_t* tamanho_saida) {
+        if (origem == NULL || destino == NULL || tamanho_saida == NULL) return ERRO_COMPRESSAO;
+
+        const unsigned char* ip = origem;
+        const unsigned char* fim = origem + tamanho;
+        size_t op = 0;
+
+        while (ip < fim) {
+                unsigned char token = *ip++;
+
+                size_t literais = token >> 4;
+                if (literais == 15 && (ip = ler_extensao(ip, fim, &literais)) == NULL)
+                        return ERRO_COMPRESSAO;
+
+                if ((size_t)(fim - ip) < literais || capacidade - op < literais)
+                        return ERRO_COMPRESSAO;
+                memcpy(destino + op, ip, literais);
+                ip += literais;
+                op += literais;
+
+                // A última sequência não tem repetição
+                if (ip == fim) break;
+
+                if (fim - ip < 2) return ERRO_COMPRESSAO;
+                size_t deslocamento = (size_t)ip[0] | ((size_t)ip[1] << 8);
+                ip += 2;
+                if (deslocamento == 0 || deslocamento > op) return ERRO_COMPRESSAO;
+
+                size_t comprimento = token & 0x0F;
+                if (comprimento == 15 && (ip = ler_extensao(ip, fim, &comprimento)) == NULL)
+                        return ERRO_COMPRESSAO;
+                comprimento += LZ_REPETICAO_MINIMA;
+
+                if (capacidade - op < comprimento) return ERRO_COMPRESSAO;
+
+                // Cópia byte a byte: origem e destino podem se sobrepor (ex.: sequências de zeros)
+                unsigned char* saida = destino + op;
+                const unsigned char* referencia = saida - deslocamento;
+                for (size_t i = 0; i < comprimento; i++) saida[i] = referencia[i];
+                op += comprimento;
+        }
+
+        *tamanho_saida = op;
+        return SUCESSO;
+}
@@ -0,0 +1,423 @@
+/**
+ * @file concorrencia.c
+ * @brief Implementa as travas entre threads (rwlock) e entre processos (fcntl).
+ */
+
+#define _GNU_SOURCE  // F_OFD_SETLKW
+
+#include "../include/concorrencia.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/acesso_direto.h"
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/filtro.h"
+#include "../include/livro.h"
+#include "../include/versoes.h"
+
+/// @brief Latch leitor/escritor do processo.
+static pthread_rwlock_t latch;
+
+/// @brief Garante que o latch seja inicializado uma única vez.
+static pthread_once_t latch_inicializado = PTHREAD_ONCE_INIT;
+
+#ifdef F_OFD_SETLKW
+/// @brief Travas OFD: pertencem à descrição aberta, e não ao processo.
+#define COMANDO_TRAVA F_OFD_SETLKW
+#else
+/// @brief Travas POSIX clássicas: pertencem ao processo e valem para o inode inteiro.
+#define COMANDO_TRAVA F_SETLKW
+#endif
+
+/**
+ * @struct LEITORES_TRAVA
+ * @brief Leitores que compartilham uma mesma trava fcntl.
+ *
+ * Com travas OFD, cada descritor tem a sua e a contagem é por descritor; com travas clássicas,
+ * o processo tem uma só por inode e a contagem é por inode.
+ */
+typedef struct LEITORES_TRAVA {
+        dev_t dispositivo;           /**< Dispositivo do arquivo. */
+        ino_t inode;                 /**< Inode do arquivo. */
+        int descritor;               /**< Descritor que obteve a trava. */
+        int leitores;                /**< Leitores segurando a trava. */
+        struct LEITORES_TRAVA* prox; /**< Próxima contagem. */
+} LEITORES_TRAVA;
+
+/// @brief Protege as contagens de leitores.
+static pthread_mutex_t mutex_leitores = PTHREAD_MUTEX_INITIALIZER;
+
+/// @brief Contagens de leitores, uma por trava compartilhada em uso.
+static LEITORES_TRAVA* leitores_ativos = NULL;
+
+/**
+ * @brief Inicializa o latch dando preferência a escritores, para que um fluxo contínuo de
+ * leitores não impeça a importação de avançar.
+ */
+static void inicializar_latch(void) {
+        pthread_rwlockattr_t atributos;
+        pthread_rwlockattr_init(&atributos);
+#ifdef __GLIBC__
+        pthread_rwlockattr_setkind_np(&atributos, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+        pthread_rwlock_init(&latch, &atributos);
+        pthread_rwlockattr_destroy(&atributos);
+}
+
+/**
+ * @brief Aplica uma trava fcntl sobre o arquivo, esperando se necessário.
+ *
+ * @param descritor Descritor do arquivo.
+ * @param tipo F_RDLCK, F_WRLCK ou F_UNLCK.
+ * @return SUCESSO ou ERRO_TRAVA.
+ */
+static int travar_fcntl(int descritor, short tipo) {
+        struct flock trava = {0};
+        trava.l_type = tipo;
+        trava.l_whence = SEEK_SET;
+        trava.l_start = 0;
+        // Todo o arquivo, inclusive o que ainda for acrescentado, sem as travas das versões
+        trava.l_len = INICIO_TRAVAS_VERSOES;
+
+        while (fcntl(descritor, COMANDO_TRAVA, &trava) == -1) {
+                if (errno != EINTR) return ERRO_TRAVA;
+        }
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Procura a contagem de leitores da trava do descritor.
+ *
+ * Deve ser chamada com mutex_leitores travado.
+ *
+ * @param descritor Descritor do arquivo.
+ * @param info Resultado de fstat() sobre o descritor.
+ * @return Endereço do ponteiro para a contagem (que aponta para NULL se não houver nenhuma).
+ */
+static LEITORES_TRAVA** procurar_leitores(int descritor, const struct stat* info) {
+        LEITORES_TRAVA** atual = &leitores_ativos;
+        while (*atual != NULL) {
+                int mesmo_inode = (*atual)->dispositivo == info->st_dev &&
+                                  (*atual)->inode == info->st_ino;
+#ifdef F_OFD_SETLKW
+                if (mesmo_inode && (*atual)->descritor == descritor) break;
+#else
+                (void)descritor;
+                if (mesmo_inode) break;
+#endif
+                atual = &(*atual)->prox;
+        }
+        return atual;
+}
+
+/**
+ * @brief Entra na trava compartilhada do descritor, obtendo-a se for o primeiro leitor.
+ *
+ * @param descritor Descritor do arquivo.
+ * @return SUCESSO ou ERRO_TRAVA.
+ */
+static int entrar_leitura(int descritor) {
+        struct stat info;
+        if (fstat(descritor, &info) != 0) return ERRO_TRAVA;
+
+        pthread_mutex_lock(&mutex_leitores);
+        int status = SUCESSO;
+        LEITORES_TRAVA** contagem = procurar_leitores(descritor, &info);
+        if (*contagem == NULL) {
+                LEITORES_TRAVA* nova = calloc(1, sizeof(LEITORES_TRAVA));
+                if (nova == NULL) {
+                        status = ERRO_TRAVA;
+                } else {
+                        status = travar_fcntl(descritor, F_RDLCK);
+                        if (status == SUCESSO) {
+                                nova->dispositivo = info.st_dev;
+                                nova->inode = info.st_ino;
+                                nova->descritor = descritor;
+                                *contagem = nova;
+                        } else {
+                                free(nova);
+                        }
+                }
+        }
+        if (status == SUCESSO) (*contagem)->leitores++;
+        pthread_mutex_unlock(&mutex_leitores);
+
+        return status;
+}
+
+/**
+ * @brief Sai da trava compartilhada do descritor, liberando-a se for o último leitor.
+ *
+ * @param descritor Descritor do arquivo.
+ * @return SUCESSO ou ERRO_TRAVA.
+ */
+static int sair_leitura(int descritor) {
+        struct stat info;
+        if (fstat(descritor, &info) != 0) return ERRO_TRAVA;
+
+        pthread_mutex_lock(&mutex_leitores);
+        int status = SUCESSO;
+        LEITORES_TRAVA** contagem = procurar_leitores(descritor, &info);
+        if (*contagem == NULL) {
+                status = ERRO_TRAVA;
+        } else if (--(*contagem)->leitores == 0) {
+                LEITORES_TRAVA* vazia = *contagem;
+                // Com travas clássicas, qualquer descritor do inode libera a trava do processo
+                status = travar_fcntl(vazia->descritor, F_UNLCK);
+                *contagem = vazia->prox;
+                free(vazia);
+        }
+        pthread_mutex_unlock(&mutex_leitores);
+
+        return status;
+}
+
+/**
+ * @brief Obtém o latch e a trava fcntl do descritor no modo pedido.
+ *
+ * @return SUCESSO ou ERRO_TRAVA.
+ */
+static int obter_travas(int descritor, modo_trava modo) {
+        if (modo == TRAVA_ESCRITA) {
+                if (pthread_rwlock_wrlock(&latch) != 0) return ERRO_TRAVA;
+        } else {
+                if (pthread_rwlock_rdlock(&latch) != 0) return ERRO_TRAVA;
+        }
+
+        int status = modo == TRAVA_ESCRITA ? travar_fcntl(descritor, F_WRLCK)
+                                           : entrar_leitura(descritor);
+        if (status != SUCESSO) pthread_rwlock_unlock(&latch);
+        return status;
+}
+
+/**
+ * @brief Libera o que obter_travas() obteve, sem registrar alteração.
+ */
+static void soltar_travas(int descritor, modo_trava modo) {
+        if (modo == TRAVA_ESCRITA)
+                travar_fcntl(descritor, F_UNLCK);
+        else
+                sair_leitura(descritor);
+        pthread_rwlock_unlock(&latch);
+}
+
+/**
+ * @brief Indica se o arquivo do descritor foi trocado por outro no mesmo caminho, como depois
+ * que rebalancear_arquivo() (rebalanceamento.h) faz rename() da cópia sobre ele.
+ *
+ * Só olha o caminho (por /proc/self/fd) quando o arquivo ficou sem ligações; um arquivo
+ * apagado sem substituto, como o de tmpfile(), continua sendo usado.
+ *
+ * @param descritor Descritor do arquivo.
+ * @param[out] caminho Caminho do arquivo novo, se houver troca.
+ * @param tamanho Tamanho de `caminho`.
+ * @return 1 se o caminho tem outro arquivo, 0 caso contrário.
+ */
+static int arquivo_substituido(int descritor, char* caminho, size_t tamanho) {
+        struct stat antigo, novo;
+        if (fstat(descritor, &antigo) != 0 || antigo.st_nlink > 0) return 0;
+
+        char ligacao[32];
+        snprintf(ligacao, sizeof(ligacao), "/proc/self/fd/%d", descritor);
+        ssize_t lidos = readlink(ligacao, caminho, tamanho - 1);
+        if (lidos <= 0) return 0;
+        caminho[lidos] = '\0';
+
+        // O kernel marca assim o caminho de um arquivo sem ligações
+        const char* apagado = " (deleted)";
+        size_t sufixo = strlen(apagado);
+        if ((size_t)lidos > sufixo && strcmp(caminho + lidos - sufixo, apagado) == 0)
+                caminho[lidos - sufixo] = '\0';
+
+        return stat(caminho, &novo) == 0 &&
+               (novo.st_dev != antigo.st_dev || novo.st_ino != antigo.st_ino);
+}
+
+/**
+ * @brief Reabre `caminho` no mesmo descritor do `FILE*`.
+ *
+ * O buffer do `FILE*` é descartado e o pool do acesso direto, que tem o próprio descritor, é
+ * refeito para o arquivo novo.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_SUBSTITUIDO.
+ */
+static int reabrir_arquivo(FILE* arquivo, const char* caminho) {
+        int descritor = fileno(arquivo);
+        int acesso = fcntl(descritor, F_GETFL);
+        int novo = acesso == -1 ? -1 : open(caminho, (acesso & O_ACCMODE) | O_CLOEXEC);
+        if (novo < 0) return ERRO_ARQUIVO_SUBSTITUIDO;
+
+        ESTADO_ACESSO_DIRETO pool;
+        int tinha_pool = consultar_acesso_direto(arquivo, &pool) == SUCESSO;
+        if (tinha_pool) fechar_acesso_direto(arquivo);
+
+        fflush(arquivo);
+        int status = dup2(novo, descritor) == descritor ? SUCESSO : ERRO_ARQUIVO_SUBSTITUIDO;
+        close(novo);
+        if (status != SUCESSO) return status;
+        rewind(arquivo);
+
+        // Sem a trava, o pool pode fixar páginas de uma escrita em andamento; o contador de
+        // alterações o esvazia assim que a trava for obtida
+        if (tinha_pool) abrir_acesso_direto(arquivo, caminho, pool.paginas);
+        return SUCESSO;
+}
+
+/**
+ * @brief Obtém a trava do arquivo no modo pedido, bloqueando até conseguir.
+ *
+ * Se, ao obter a trava, o arquivo do handle tiver sido substituído por outro no mesmo
+ * caminho, a trava é solta, o caminho é reaberto no lugar e a trava é pedida de novo: um
+ * handle aberto antes de um rebalanceamento passa a usar o arquivo novo, em vez de gravar no
+ * antigo, que ninguém mais lê.
+ *
+ * @param arquivo Arquivo binário de livros.
+ * @param modo TRAVA_LEITURA ou TRAVA_ESCRITA.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_TRAVA ou ERRO_ARQUIVO_SUBSTITUIDO.
+ */
+int travar_arquivo(FILE* arquivo, modo_trava modo) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        pthread_once(&latch_inicializado, inicializar_latch);
+        int descritor = fileno(arquivo);
+
+        for (;;) {
+                int status = obter_travas(descritor, modo);
+                if (status != SUCESSO) return status;
+
+                char caminho[PATH_MAX];
+                if (!arquivo_substituido(descritor, caminho, sizeof(caminho))) break;
+
+                soltar_travas(descritor, modo);
+                status = reabrir_arquivo(arquivo, caminho);
+                if (status != SUCESSO) return status;
+        }
+
+        // Descarta leituras em buffer feitas antes de outro processo alterar o arquivo; o pool
+        // do acesso direto, se houver, é esvaziado pelo mesmo motivo
+        fflush(arquivo);
+        conferir_acesso_direto(arquivo);
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Libera a trava obtida com travar_arquivo() no mesmo modo.
+ *
+ * @param arquivo Arquivo binário de livros.
+ * @param modo Modo usado em travar_arquivo().
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_WRITE ou ERRO_TRAVA.
+ */
+int destravar_arquivo(FILE* arquivo, modo_trava modo) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        int descritor = fileno(arquivo);
+        int status = SUCESSO;
+
+        if (modo == TRAVA_ESCRITA) {
+                if (fflush(arquivo) != 0) status = ERRO_ARQUIVO_WRITE;
+                int r = contar_alteracao(arquivo);
+                if (status == SUCESSO) status = r;
+                registrar_acesso_direto(arquivo);
+
+                r = travar_fcntl(descritor, F_UNLCK);
+                if (status == SUCESSO) status = r;
+        } else {
+                status = sair_leitura(descritor);
+        }
+
+        if (pthread_rwlock_unlock(&latch) != 0 && status == SUCESSO) status = ERRO_TRAVA;
+
+        return status;
+}
+
+/**
+ * @brief Procura um código sob trava compartilhada.
+ *
+ * @param arquivo Arquivo binário de livros.
+ * @param codigo Código procurado.
+ * @return Código devolvido por buscar_no_arvore() ou erro de trava.
+ */
+static int existe_codigo(FILE* arquivo, size_t codigo) {
+        int status = travar_arquivo(arquivo, TRAVA_LEITURA);
+        if (status != SUCESSO) return status;
+
+        RESULTADO_BUSCA resultado = {0};
+        status = codigo_certamente_ausente(arquivo, codigo)
+                     ? ERRO_NO_NULO
+                     : buscar_no_arvore(arquivo, codigo, &resultado);
+        free(resultado.no);
+        free(resultado.pai);
+
+        int r = destravar_arquivo(arquivo, TRAVA_LEITURA);
+        return r != SUCESSO ? r : status;
+}
+
+/**
+ * @brief Cadastra um livro segurando a trava exclusiva apenas durante a gravação.
+ *
+ * @param arquivo Arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param livro Livro a cadastrar.
+ * @return Os mesmos códigos de cadastrar_livro(), ou erros de trava.
+ */
+int cadastrar_livro_concorrente(FILE* arquivo, LIVRO livro) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        int status = existe_codigo(arquivo, livro.codigo);
+        if (status == SUCESSO) return ERRO_CODIGO_DUPLICADO;
+        if (status == ERRO_TRAVA) return status;
+
+        status = travar_arquivo(arquivo, TRAVA_ESCRITA);
+        if (status != SUCESSO) return status;
+
+        NO_ARVORE no_novo;
+        no_novo.livro = livro;
+        no_novo.filho_esquerdo = POSICAO_INVALIDA;
+        no_novo.filho_direito = POSICAO_INVALIDA;
+
+        // A inserção refaz a busca e devolve ERRO_CODIGO_DUPLICADO se alguém se antecipou
+        if (modo_cow_ativo())
+                status = inserir_no_arvore_cow(arquivo, &no_novo);
+        else
+                status = inserir_no_arvore(arquivo, &no_novo);
+
+        int r = destravar_arquivo(arquivo, TRAVA_ESCRITA);
+        return status != SUCESSO ? status : r;
+}
+
+/**
+ * @brief Remove um livro segurando a trava exclusiva apenas durante a remoção.
+ *
+ * @param arquivo Arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param codigo Código do livro a remover.
+ * @return Os mesmos códigos de remover_no_arvore(), ou erros de trava.
+ */
+int remover_no_arvore_concorrente(FILE* arquivo, size_t codigo) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        int status = existe_codigo(arquivo, codigo);
+        if (status == ERRO_TRAVA) return status;
+        if (status != SUCESSO) return ERRO_NO_NULO;
+
+        status = travar_arquivo(arquivo, TRAVA_ESCRITA);
+        if (status != SUCESSO) return status;
+
+        if (modo_cow_ativo())
+                status = remover_no_arvore_cow(arquivo, codigo);
+        else
+                status = remover_no_arvore(arquivo, codigo);
+
+        int r = destravar_arquivo(arquivo, TRAVA_ESCRITA);
+        return status != SUCESSO ? status : r;
+}
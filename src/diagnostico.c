@@ -0,0 +1,411 @@
+/**
+ * @file diagnostico.c
+ * @brief Implementa o diagnóstico da forma da árvore e do uso do arquivo de livros.
+ */
+
+#include "../include/diagnostico.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/arquivo.h"
+#include "../include/erros.h"
+#include "../include/versoes.h"
+
+/** Linhas do histograma no relatório de texto. */
+#define LINHAS_HISTOGRAMA 32
+
+/**
+ * Situação de uma posição durante o diagnóstico; os bits altos marcam os filhos aceitos.
+ */
+enum {
+        POSICAO_NAO_VISTA = 0,  /**< Ainda não alcançada. */
+        POSICAO_EMPILHADA = 1,  /**< Na pilha, filhos ainda não examinados. */
+        POSICAO_EXPANDIDA = 2,  /**< Na pilha, filhos empilhados. */
+        POSICAO_VIVA = 3,       /**< Subárvore calculada. */
+        POSICAO_LIVRE = 4,      /**< Na lista livre. */
+        POSICAO_APOSENTADA = 5, /**< Na lista de aposentados do copy-on-write. */
+        MASCARA_SITUACAO = 0x0f,
+        ESQUERDO_ACEITO = 0x10, /**< O filho esquerdo foi empilhado por este nó. */
+        DIREITO_ACEITO = 0x20   /**< O filho direito foi empilhado por este nó. */
+};
+
+/**
+ * Metadados de todas as posições, em vetores paralelos.
+ */
+typedef struct {
+        size_t quantidade;      /**< Posições do arquivo. */
+        int* esquerdo;          /**< Filho esquerdo (ou próximo livre) de cada posição. */
+        int* direito;           /**< Filho direito de cada posição. */
+        uint8_t* situacao;      /**< Situação e filhos aceitos. */
+        uint32_t* profundidade; /**< Profundidade dos nós vivos. */
+        uint32_t* altura;       /**< Altura da subárvore dos nós vivos. */
+        uint32_t* tamanho;      /**< Nós na subárvore dos nós vivos. */
+        int* pilha;             /**< Pilha do percurso; cada posição entra uma vez. */
+        size_t topo_pilha;      /**< Posições na pilha. */
+} MAPA;
+
+/**
+ * @brief Libera os vetores do mapa.
+ */
+static void liberar_mapa(MAPA* mapa) {
+        free(mapa->esquerdo);
+        free(mapa->direito);
+        free(mapa->situacao);
+        free(mapa->profundidade);
+        free(mapa->altura);
+        free(mapa->tamanho);
+        free(mapa->pilha);
+}
+
+/**
+ * @brief Aloca os vetores do mapa para `quantidade` posições.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+static int alocar_mapa(MAPA* mapa, size_t quantidade) {
+        memset(mapa, 0, sizeof(*mapa));
+        mapa->quantidade = quantidade;
+        size_t n = quantidade ? quantidade : 1;
+        mapa->esquerdo = malloc(n * sizeof(int));
+        mapa->direito = malloc(n * sizeof(int));
+        mapa->situacao = calloc(n, sizeof(uint8_t));
+        mapa->profundidade = malloc(n * sizeof(uint32_t));
+        mapa->altura = malloc(n * sizeof(uint32_t));
+        mapa->tamanho = malloc(n * sizeof(uint32_t));
+        mapa->pilha = malloc(n * sizeof(int));
+        if (!mapa->esquerdo || !mapa->direito || !mapa->situacao || !mapa->profundidade ||
+            !mapa->altura || !mapa->tamanho || !mapa->pilha) {
+                liberar_mapa(mapa);
+                return ERRO_MEMORIA;
+        }
+        return SUCESSO;
+}
+
+/**
+ * @brief Percorre a lista livre, marcando as posições e medindo o espalhamento.
+ */
+static void examinar_lista_livre(MAPA* mapa, int livre, DIAGNOSTICO_ARVORE* diagnostico) {
+        uint64_t saltos = 0;
+        int anterior = POSICAO_INVALIDA;
+        for (int posicao = livre; posicao != POSICAO_INVALIDA;
+             posicao = mapa->esquerdo[posicao]) {
+                if (posicao < 0 || (size_t)posicao >= mapa->quantidade ||
+                    mapa->situacao[posicao] != POSICAO_NAO_VISTA) {
+                        diagnostico->ligacoes_invalidas++;
+                        break;
+                }
+                mapa->situacao[posicao] = POSICAO_LIVRE;
+                diagnostico->livres++;
+
+                if (diagnostico->menor_livre < 0 || posicao < diagnostico->menor_livre)
+                        diagnostico->menor_livre = posicao;
+                if (posicao > diagnostico->maior_livre) diagnostico->maior_livre = posicao;
+                if (anterior != POSICAO_INVALIDA)
+                        saltos += (uint64_t)abs(posicao - anterior);
+                anterior = posicao;
+        }
+        if (diagnostico->livres > 1)
+                diagnostico->salto_medio_livres = (double)saltos / (diagnostico->livres - 1);
+}
+
+/**
+ * Contexto de marcar_aposentada().
+ */
+typedef struct {
+        MAPA* mapa;                      /**< Mapa das posições. */
+        DIAGNOSTICO_ARVORE* diagnostico; /**< Contagens. */
+} CONTEXTO_APOSENTADAS;
+
+/**
+ * @brief Marca uma posição da lista de aposentados; posições já vistas são ligações inválidas.
+ */
+static void marcar_aposentada(int posicao, int bloco, void* contexto) {
+        (void)bloco;
+        CONTEXTO_APOSENTADAS* aposentadas = contexto;
+        MAPA* mapa = aposentadas->mapa;
+        if (posicao < 0 || (size_t)posicao >= mapa->quantidade ||
+            mapa->situacao[posicao] != POSICAO_NAO_VISTA) {
+                aposentadas->diagnostico->ligacoes_invalidas++;
+                return;
+        }
+        mapa->situacao[posicao] = POSICAO_APOSENTADA;
+        aposentadas->diagnostico->aposentadas++;
+}
+
+/**
+ * @brief Empilha `filho` se for uma posição válida ainda não alcançada.
+ *
+ * @return 1 se empilhou, 0 caso contrário (filho ausente ou ligação inválida).
+ */
+static int empilhar_filho(MAPA* mapa, int filho, uint32_t profundidade,
+                          DIAGNOSTICO_ARVORE* diagnostico) {
+        if (filho == POSICAO_INVALIDA) return 0;
+        if (filho < 0 || (size_t)filho >= mapa->quantidade ||
+            mapa->situacao[filho] != POSICAO_NAO_VISTA) {
+                diagnostico->ligacoes_invalidas++;
+                return 0;
+        }
+        mapa->situacao[filho] = POSICAO_EMPILHADA;
+        mapa->profundidade[filho] = profundidade;
+        mapa->pilha[mapa->topo_pilha++] = filho;
+        return 1;
+}
+
+/**
+ * @brief Calcula altura e tamanho de cada subárvore em pós-ordem, sem recursão.
+ *
+ * @return Soma das profundidades + 1 dos nós vivos (o total de nós lidos buscando cada um).
+ */
+static uint64_t percorrer_arvore(MAPA* mapa, int raiz, DIAGNOSTICO_ARVORE* diagnostico) {
+        uint64_t soma_caminhos = 0;
+        diagnostico->maior_desbalanceada = POSICAO_INVALIDA;
+        empilhar_filho(mapa, raiz, 0, diagnostico);
+
+        while (mapa->topo_pilha > 0) {
+                int posicao = mapa->pilha[mapa->topo_pilha - 1];
+                uint32_t profundidade = mapa->profundidade[posicao];
+
+                if ((mapa->situacao[posicao] & MASCARA_SITUACAO) == POSICAO_EMPILHADA) {
+                        uint8_t situacao = POSICAO_EXPANDIDA;
+                        if (empilhar_filho(mapa, mapa->esquerdo[posicao], profundidade + 1,
+                                           diagnostico))
+                                situacao |= ESQUERDO_ACEITO;
+                        if (empilhar_filho(mapa, mapa->direito[posicao], profundidade + 1,
+                                           diagnostico))
+                                situacao |= DIREITO_ACEITO;
+                        mapa->situacao[posicao] = situacao;
+                        continue;
+                }
+
+                mapa->topo_pilha--;
+                uint8_t situacao = mapa->situacao[posicao];
+                uint32_t altura_esquerda = 0, altura_direita = 0, tamanho = 1;
+                if (situacao & ESQUERDO_ACEITO) {
+                        altura_esquerda = mapa->altura[mapa->esquerdo[posicao]];
+                        tamanho += mapa->tamanho[mapa->esquerdo[posicao]];
+                }
+                if (situacao & DIREITO_ACEITO) {
+                        altura_direita = mapa->altura[mapa->direito[posicao]];
+                        tamanho += mapa->tamanho[mapa->direito[posicao]];
+                }
+                mapa->altura[posicao] =
+                    1 + (altura_esquerda > altura_direita ? altura_esquerda : altura_direita);
+                mapa->tamanho[posicao] = tamanho;
+                mapa->situacao[posicao] = POSICAO_VIVA;
+
+                diagnostico->vivas++;
+                soma_caminhos += profundidade + 1;
+
+                size_t diferenca = altura_esquerda > altura_direita
+                                       ? altura_esquerda - altura_direita
+                                       : altura_direita - altura_esquerda;
+                if (diferenca > diagnostico->maior_diferenca_altura)
+                        diagnostico->maior_diferenca_altura = diferenca;
+                if (diferenca > 1) {
+                        diagnostico->nos_desbalanceados++;
+                        if (tamanho > diagnostico->tamanho_maior_desbalanceada) {
+                                diagnostico->tamanho_maior_desbalanceada = tamanho;
+                                diagnostico->maior_desbalanceada = posicao;
+                        }
+                }
+        }
+
+        if (diagnostico->vivas > 0) diagnostico->altura = mapa->altura[raiz];
+        return soma_caminhos;
+}
+
+/**
+ * @brief Altura e caminho médio de uma árvore perfeitamente balanceada com `nos` nós.
+ */
+static void calcular_otimo(size_t nos, DIAGNOSTICO_ARVORE* diagnostico) {
+        uint64_t restantes = nos, no_nivel = 1, soma = 0;
+        size_t nivel = 0;
+        while (restantes > 0) {
+                uint64_t neste = restantes < no_nivel ? restantes : no_nivel;
+                nivel++;
+                soma += neste * nivel;
+                restantes -= neste;
+                no_nivel *= 2;
+        }
+        diagnostico->altura_minima = nivel;
+        diagnostico->caminho_medio_minimo = nos ? (double)soma / nos : 0;
+}
+
+/**
+ * @brief Diagnostica a árvore e o arquivo numa passada sequencial.
+ *
+ * @param arquivo Arquivo de livros aberto para leitura.
+ * @param[out] diagnostico Resultado; liberar com liberar_diagnostico().
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO, ERRO_ARQUIVO_SEEK, ERRO_ARQUIVO_READ
+ *         ou ERRO_MEMORIA.
+ */
+int diagnosticar_arvore(FILE* arquivo, DIAGNOSTICO_ARVORE* diagnostico) {
+        if (arquivo == NULL || diagnostico == NULL) return ERRO_ARQUIVO_NULO;
+        memset(diagnostico, 0, sizeof(*diagnostico));
+        diagnostico->menor_livre = POSICAO_INVALIDA;
+        diagnostico->maior_livre = POSICAO_INVALIDA;
+        diagnostico->maior_desbalanceada = POSICAO_INVALIDA;
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+        int raiz = cabecalho->raiz;
+        int livre = cabecalho->livre;
+        diagnostico->posicoes = cabecalho->topo > 0 ? (size_t)cabecalho->topo : 0;
+        diagnostico->livros_cabecalho = cabecalho->quantidade_livros;
+        free(cabecalho);
+
+        MAPA mapa;
+        int status = alocar_mapa(&mapa, diagnostico->posicoes);
+        if (status != SUCESSO) return status;
+        status = ler_filhos_arquivo(arquivo, mapa.quantidade, mapa.esquerdo, mapa.direito);
+        if (status != SUCESSO) {
+                liberar_mapa(&mapa);
+                return status;
+        }
+
+        // A lista livre primeiro: um filho que aponte para posição livre é uma ligação inválida.
+        examinar_lista_livre(&mapa, livre, diagnostico);
+        uint64_t soma_caminhos = percorrer_arvore(&mapa, raiz, diagnostico);
+        CONTEXTO_APOSENTADAS aposentadas = {&mapa, diagnostico};
+        if (percorrer_aposentados(arquivo, marcar_aposentada, &aposentadas) != SUCESSO)
+                diagnostico->ligacoes_invalidas++;
+
+        diagnostico->perdidas = diagnostico->posicoes - diagnostico->vivas - diagnostico->livres -
+                                diagnostico->aposentadas;
+        for (size_t i = diagnostico->posicoes; i > 0; i--) {
+                if (mapa.situacao[i - 1] == POSICAO_VIVA) break;
+                diagnostico->livres_no_fim++;
+        }
+
+        if (diagnostico->altura > 0) {
+                diagnostico->profundidades = calloc(diagnostico->altura, sizeof(size_t));
+                if (diagnostico->profundidades == NULL) {
+                        liberar_mapa(&mapa);
+                        return ERRO_MEMORIA;
+                }
+                for (size_t i = 0; i < diagnostico->posicoes; i++)
+                        if (mapa.situacao[i] == POSICAO_VIVA)
+                                diagnostico->profundidades[mapa.profundidade[i]]++;
+                diagnostico->caminho_medio = (double)soma_caminhos / diagnostico->vivas;
+        }
+        liberar_mapa(&mapa);
+
+        calcular_otimo(diagnostico->vivas, diagnostico);
+        diagnostico->rebalancear =
+            diagnostico->vivas > 0 &&
+            diagnostico->caminho_medio > LIMITE_REBALANCEAR * diagnostico->caminho_medio_minimo;
+        diagnostico->compactar =
+            diagnostico->posicoes > 0 &&
+            (double)(diagnostico->posicoes - diagnostico->vivas) >
+                LIMITE_COMPACTAR * (double)diagnostico->posicoes;
+        return SUCESSO;
+}
+
+/**
+ * @brief Libera o histograma de profundidades do diagnóstico.
+ */
+void liberar_diagnostico(DIAGNOSTICO_ARVORE* diagnostico) {
+        if (diagnostico == NULL) return;
+        free(diagnostico->profundidades);
+        diagnostico->profundidades = NULL;
+}
+
+/**
+ * @brief Escreve o histograma em até LINHAS_HISTOGRAMA faixas de profundidades.
+ */
+static void imprimir_histograma(FILE* saida, const DIAGNOSTICO_ARVORE* d) {
+        size_t largura = (d->altura + LINHAS_HISTOGRAMA - 1) / LINHAS_HISTOGRAMA;
+        for (size_t inicio = 0; inicio < d->altura; inicio += largura) {
+                size_t fim = inicio + largura < d->altura ? inicio + largura : d->altura;
+                size_t nos = 0;
+                for (size_t i = inicio; i < fim; i++) nos += d->profundidades[i];
+
+                char faixa[48];
+                if (fim - inicio == 1)
+                        snprintf(faixa, sizeof(faixa), "%zu", inicio);
+                else
+                        snprintf(faixa, sizeof(faixa), "%zu-%zu", inicio, fim - 1);
+                fprintf(saida, "  %-15s %zu\n", faixa, nos);
+        }
+}
+
+/**
+ * @brief Escreve o diagnóstico em texto.
+ */
+static void imprimir_texto(FILE* saida, const DIAGNOSTICO_ARVORE* d) {
+        fprintf(saida, "posicoes: %zu (vivas %zu, livres %zu, aposentadas %zu, perdidas %zu)\n",
+                d->posicoes, d->vivas, d->livres, d->aposentadas, d->perdidas);
+        fprintf(saida, "livros no cabecalho: %zu\nligacoes invalidas: %zu\n", d->livros_cabecalho,
+                d->ligacoes_invalidas);
+        fprintf(saida, "altura: %zu (minima %zu)\n", d->altura, d->altura_minima);
+        fprintf(saida, "caminho medio de busca: %.2f nos (minimo %.2f)\n", d->caminho_medio,
+                d->caminho_medio_minimo);
+        fprintf(saida, "desequilibrio: maior diferenca de altura %zu, %zu nos desbalanceados\n",
+                d->maior_diferenca_altura, d->nos_desbalanceados);
+        if (d->maior_desbalanceada != POSICAO_INVALIDA)
+                fprintf(saida, "maior subarvore desbalanceada: posicao %d (%zu nos)\n",
+                        d->maior_desbalanceada, d->tamanho_maior_desbalanceada);
+        if (d->livres > 0)
+                fprintf(saida, "lista livre: %zu posicoes entre %d e %d, salto medio %.1f\n",
+                        d->livres, d->menor_livre, d->maior_livre, d->salto_medio_livres);
+        else
+                fprintf(saida, "lista livre: vazia\n");
+        fprintf(saida, "posicoes nao vivas no fim do arquivo: %zu\n", d->livres_no_fim);
+
+        fprintf(saida, "nos por profundidade:\n");
+        imprimir_histograma(saida, d);
+
+        if (!d->rebalancear && !d->compactar)
+                fprintf(saida, "recomendacao: nenhuma\n");
+        else
+                fprintf(saida, "recomendacao: %s%s%s\n", d->rebalancear ? "rebalancear" : "",
+                        d->rebalancear && d->compactar ? ", " : "",
+                        d->compactar ? "compactar" : "");
+}
+
+/**
+ * @brief Escreve o diagnóstico como um objeto JSON numa linha.
+ */
+static void imprimir_json(FILE* saida, const DIAGNOSTICO_ARVORE* d) {
+        fprintf(saida,
+                "{\"posicoes\":%zu,\"vivas\":%zu,\"livres\":%zu,\"aposentadas\":%zu,"
+                "\"perdidas\":%zu,\"livros_cabecalho\":%zu,\"ligacoes_invalidas\":%zu,"
+                "\"altura\":%zu,\"altura_minima\":%zu,\"caminho_medio\":%.4f,"
+                "\"caminho_medio_minimo\":%.4f,\"profundidades\":[",
+                d->posicoes, d->vivas, d->livres, d->aposentadas, d->perdidas, d->livros_cabecalho,
+                d->ligacoes_invalidas, d->altura, d->altura_minima, d->caminho_medio,
+                d->caminho_medio_minimo);
+        for (size_t i = 0; i < d->altura; i++)
+                fprintf(saida, "%s%zu", i ? "," : "", d->profundidades[i]);
+        fprintf(saida,
+                "],\"desequilibrio\":{\"maior_diferenca_altura\":%zu,\"nos_desbalanceados\":%zu,"
+                "\"maior_subarvore\":{\"posicao\":%d,\"tamanho\":%zu}},"
+                "\"lista_livre\":{\"tamanho\":%zu,\"menor\":%d,\"maior\":%d,\"salto_medio\":%.1f,"
+                "\"nao_vivas_no_fim\":%zu},\"rebalancear\":%s,\"compactar\":%s}\n",
+                d->maior_diferenca_altura, d->nos_desbalanceados, d->maior_desbalanceada,
+                d->tamanho_maior_desbalanceada, d->livres, d->menor_livre, d->maior_livre,
+                d->salto_medio_livres, d->livres_no_fim, d->rebalancear ? "true" : "false",
+                d->compactar ? "true" : "false");
+}
+
+/**
+ * @brief Escreve o diagnóstico.
+ *
+ * @param saida Destino do relatório.
+ * @param diagnostico Diagnóstico calculado por diagnosticar_arvore().
+ * @param formato Texto ou JSON.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO ou ERRO_ARQUIVO_WRITE.
+ */
+int imprimir_diagnostico(FILE* saida, const DIAGNOSTICO_ARVORE* diagnostico,
+                         FORMATO_DIAGNOSTICO formato) {
+        if (saida == NULL || diagnostico == NULL) return ERRO_ARQUIVO_NULO;
+
+        if (formato == DIAGNOSTICO_JSON)
+                imprimir_json(saida, diagnostico);
+        else
+                imprimir_texto(saida, diagnostico);
+
+        return fflush(saida) == 0 && !ferror(saida) ? SUCESSO : ERRO_ARQUIVO_WRITE;
+}
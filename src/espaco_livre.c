@@ -0,0 +1,364 @@
+/**
+ * @file espaco_livre.c
+ * @brief Implementa o mapa persistente das posições livres.
+ */
+
+#include "../include/espaco_livre.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/erros.h"
+
+/**
+ * Mapa associado a um handle do arquivo de livros.
+ */
+typedef struct MAPA_LIVRE {
+        FILE* arquivo;              /**< Handle do arquivo de livros. */
+        char* caminho;              /**< Caminho do arquivo do mapa. */
+        int* anterior;              /**< Anterior na lista livre, ou POSICAO_OCUPADA. */
+        size_t posicoes;            /**< Posições em `anterior`. */
+        size_t capacidade;          /**< Espaço alocado em `anterior`. */
+        size_t livres;              /**< Posições na lista livre. */
+        size_t proximas;            /**< Alocações perto da dica desde a abertura. */
+        size_t reconstrucoes;       /**< Reconstruções desde a abertura. */
+        int valido;                 /**< Zero se o mapa deixou de acompanhar o arquivo. */
+        struct MAPA_LIVRE* proximo; /**< Próxima associação. */
+} MAPA_LIVRE;
+
+/// @brief Mapas associados a handles abertos.
+static MAPA_LIVRE* mapas = NULL;
+
+/// @brief Protege a lista de mapas e os mapas nela.
+static pthread_mutex_t mutex_mapas = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Mapa associado ao handle, ou NULL. Chamar com `mutex_mapas` travado.
+ */
+static MAPA_LIVRE* mapa_do_arquivo(FILE* arquivo) {
+        for (MAPA_LIVRE* mapa = mapas; mapa; mapa = mapa->proximo)
+                if (mapa->arquivo == arquivo) return mapa;
+        return NULL;
+}
+
+/**
+ * @brief Garante que o mapa tenha `posicoes` posições; as novas ficam ocupadas.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+static int crescer(MAPA_LIVRE* mapa, size_t posicoes) {
+        if (posicoes <= mapa->posicoes) return SUCESSO;
+        if (posicoes > mapa->capacidade) {
+                size_t nova = mapa->capacidade ? mapa->capacidade : 1024;
+                while (nova < posicoes) nova *= 2;
+                int* anterior = realloc(mapa->anterior, nova * sizeof(int));
+                if (anterior == NULL) return ERRO_MEMORIA;
+                mapa->anterior = anterior;
+                mapa->capacidade = nova;
+        }
+        for (size_t i = mapa->posicoes; i < posicoes; i++) mapa->anterior[i] = POSICAO_OCUPADA;
+        mapa->posicoes = posicoes;
+        return SUCESSO;
+}
+
+/**
+ * @brief Refaz o mapa percorrendo a lista livre do arquivo.
+ *
+ * Em caso de erro, o mapa antigo é mantido.
+ *
+ * @return SUCESSO, ERRO_CABECALHO_NULO, ERRO_MEMORIA ou ERRO_NO_NULO.
+ */
+static int refazer(MAPA_LIVRE* mapa) {
+        CABECALHO* cabecalho = le_cabecalho(mapa->arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+        size_t topo = cabecalho->topo > 0 ? (size_t)cabecalho->topo : 0;
+        int livre = cabecalho->livre;
+        free(cabecalho);
+
+        MAPA_LIVRE novo = {0};
+        int status = crescer(&novo, topo);
+        int anterior = POSICAO_INVALIDA;
+        for (int posicao = livre; status == SUCESSO && posicao != POSICAO_INVALIDA;) {
+                if (posicao < 0 || (size_t)posicao >= topo ||
+                    novo.anterior[posicao] != POSICAO_OCUPADA) {
+                        status = ERRO_NO_NULO;
+                        break;
+                }
+                NO_ARVORE* no = ler_no_arquivo(mapa->arquivo, posicao);
+                if (no == NULL) {
+                        status = ERRO_NO_NULO;
+                        break;
+                }
+                novo.anterior[posicao] = anterior;
+                novo.livres++;
+                anterior = posicao;
+                posicao = no->filho_esquerdo;
+                free(no);
+        }
+        if (status != SUCESSO) {
+                free(novo.anterior);
+                return status;
+        }
+
+        free(mapa->anterior);
+        mapa->anterior = novo.anterior;
+        mapa->posicoes = novo.posicoes;
+        mapa->capacidade = novo.capacidade;
+        mapa->livres = novo.livres;
+        mapa->reconstrucoes++;
+        mapa->valido = 1;
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê o arquivo do mapa, se existir e corresponder ao arquivo de livros como ele está.
+ *
+ * @return SUCESSO, ou um código de erro se o mapa precisar ser refeito.
+ */
+static int carregar(MAPA_LIVRE* mapa) {
+        FILE* origem = fopen(mapa->caminho, "rb");
+        if (origem == NULL) return ERRO_ARQUIVO_NULO;
+
+        CABECALHO_MAPA_LIVRE lido;
+        IDENTIDADE_ARQUIVO atual;
+        int status = SUCESSO;
+        if (fread(&lido, sizeof(lido), 1, origem) != 1 || lido.magica != MAGICA_MAPA_LIVRE ||
+            lido.versao != VERSAO_MAPA_LIVRE || lido.posicoes > (uint64_t)INT32_MAX)
+                status = ERRO_ARQUIVO_READ;
+        if (status == SUCESSO) status = identificar_arquivo(mapa->arquivo, &atual);
+        if (status == SUCESSO && (memcmp(&lido.livros, &atual, sizeof(atual)) != 0 ||
+                                  lido.posicoes != (uint64_t)atual.topo))
+                status = ERRO_ARQUIVO_READ;
+
+        MAPA_LIVRE novo = {0};
+        if (status == SUCESSO) status = crescer(&novo, (size_t)lido.posicoes);
+        if (status == SUCESSO &&
+            (fread(novo.anterior, sizeof(int), novo.posicoes, origem) != novo.posicoes ||
+             fgetc(origem) != EOF))
+                status = ERRO_ARQUIVO_READ;
+        fclose(origem);
+
+        if (status != SUCESSO) {
+                free(novo.anterior);
+                return status;
+        }
+
+        mapa->anterior = novo.anterior;
+        mapa->posicoes = novo.posicoes;
+        mapa->capacidade = novo.capacidade;
+        mapa->livres = (size_t)lido.livres;
+        mapa->valido = 1;
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava o mapa num arquivo temporário e o renomeia sobre o arquivo do mapa.
+ */
+static int gravar(MAPA_LIVRE* mapa) {
+        CABECALHO_MAPA_LIVRE cabecalho;
+        memset(&cabecalho, 0, sizeof(cabecalho));
+        cabecalho.magica = MAGICA_MAPA_LIVRE;
+        cabecalho.versao = VERSAO_MAPA_LIVRE;
+        cabecalho.livres = mapa->livres;
+        int status = identificar_arquivo(mapa->arquivo, &cabecalho.livros);
+        if (status != SUCESSO) return status;
+        // Posições gravadas sem passar pelo mapa (construir_arvore_em_bloco()) estão ocupadas.
+        if (cabecalho.livros.topo < 0 || crescer(mapa, (size_t)cabecalho.livros.topo) != SUCESSO)
+                return ERRO_MEMORIA;
+        cabecalho.posicoes = (uint64_t)cabecalho.livros.topo;
+
+        size_t tamanho = strlen(mapa->caminho);
+        char* temporario = malloc(tamanho + sizeof(".tmp"));
+        if (temporario == NULL) return ERRO_MEMORIA;
+        memcpy(temporario, mapa->caminho, tamanho);
+        memcpy(temporario + tamanho, ".tmp", sizeof(".tmp"));
+
+        size_t posicoes = (size_t)cabecalho.posicoes;
+        FILE* destino = fopen(temporario, "wb");
+        if (destino == NULL) status = ERRO_ARQUIVO_WRITE;
+        if (status == SUCESSO &&
+            (fwrite(&cabecalho, sizeof(cabecalho), 1, destino) != 1 ||
+             fwrite(mapa->anterior, sizeof(int), posicoes, destino) != posicoes))
+                status = ERRO_ARQUIVO_WRITE;
+        if (destino != NULL && fclose(destino) != 0) status = ERRO_ARQUIVO_WRITE;
+        if (status == SUCESSO && rename(temporario, mapa->caminho) != 0)
+                status = ERRO_ARQUIVO_WRITE;
+
+        if (status != SUCESSO) remove(temporario);
+        free(temporario);
+        return status;
+}
+
+/**
+ * @brief Libera um mapa já fora da lista.
+ */
+static void liberar_mapa(MAPA_LIVRE* mapa) {
+        free(mapa->anterior);
+        free(mapa->caminho);
+        free(mapa);
+}
+
+/**
+ * @brief Associa um mapa ao handle, lendo o arquivo do mapa ou refazendo-o pela lista livre.
+ *
+ * Se o handle já tiver mapa, não faz nada.
+ *
+ * @param arquivo Arquivo binário da árvore, já travado pelo chamador.
+ * @param caminho Caminho do arquivo de livros.
+ * @return SUCESSO ou código de erro.
+ */
+int abrir_mapa_livre(FILE* arquivo, const char* caminho) {
+        if (arquivo == NULL || caminho == NULL) return ERRO_ARQUIVO_NULO;
+
+        pthread_mutex_lock(&mutex_mapas);
+        MAPA_LIVRE* existente = mapa_do_arquivo(arquivo);
+        pthread_mutex_unlock(&mutex_mapas);
+        if (existente) return SUCESSO;
+
+        MAPA_LIVRE* mapa = calloc(1, sizeof(MAPA_LIVRE));
+        if (mapa == NULL) return ERRO_MEMORIA;
+        size_t tamanho = strlen(caminho);
+        mapa->caminho = malloc(tamanho + sizeof(SUFIXO_MAPA_LIVRE));
+        if (mapa->caminho == NULL) {
+                free(mapa);
+                return ERRO_MEMORIA;
+        }
+        memcpy(mapa->caminho, caminho, tamanho);
+        memcpy(mapa->caminho + tamanho, SUFIXO_MAPA_LIVRE, sizeof(SUFIXO_MAPA_LIVRE));
+        mapa->arquivo = arquivo;
+
+        int status = carregar(mapa);
+        if (status != SUCESSO) status = refazer(mapa);
+        if (status != SUCESSO) {
+                liberar_mapa(mapa);
+                return status;
+        }
+
+        pthread_mutex_lock(&mutex_mapas);
+        mapa->proximo = mapas;
+        mapas = mapa;
+        pthread_mutex_unlock(&mutex_mapas);
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava o mapa ao lado do arquivo de livros e desfaz a associação.
+ *
+ * Um mapa que deixou de ser válido não é gravado, e o arquivo antigo é apagado.
+ *
+ * @param arquivo Handle passado a abrir_mapa_livre().
+ * @return SUCESSO ou código de erro.
+ */
+int fechar_mapa_livre(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_mapas);
+        MAPA_LIVRE** elo = &mapas;
+        while (*elo && (*elo)->arquivo != arquivo) elo = &(*elo)->proximo;
+        MAPA_LIVRE* mapa = *elo;
+        if (mapa) *elo = mapa->proximo;
+        pthread_mutex_unlock(&mutex_mapas);
+        if (mapa == NULL) return SUCESSO;
+
+        int status = mapa->valido ? gravar(mapa) : SUCESSO;
+        if (status != SUCESSO || !mapa->valido) remove(mapa->caminho);
+
+        liberar_mapa(mapa);
+        return status;
+}
+
+/**
+ * @brief Diz se `posicao` está na lista livre segundo o mapa.
+ */
+static int esta_livre(const MAPA_LIVRE* mapa, long posicao) {
+        return posicao >= 0 && (size_t)posicao < mapa->posicoes &&
+               mapa->anterior[posicao] != POSICAO_OCUPADA;
+}
+
+/**
+ * @brief Escolhe a posição livre mais próxima da dica (à frente primeiro, a favor da leitura
+ * antecipada) ou o topo, a até RAIO_LOCALIDADE posições.
+ *
+ * @return SUCESSO ou ERRO_NO_NULO.
+ */
+int escolher_posicao_livre(FILE* arquivo, int dica, int topo, int* posicao, int* anterior) {
+        if (dica < 0 || posicao == NULL || anterior == NULL) return ERRO_NO_NULO;
+
+        pthread_mutex_lock(&mutex_mapas);
+        MAPA_LIVRE* mapa = mapa_do_arquivo(arquivo);
+        int status = ERRO_NO_NULO;
+        for (long distancia = 1; mapa && mapa->valido && distancia <= RAIO_LOCALIDADE;
+             distancia++) {
+                long candidatas[2] = {(long)dica + distancia, (long)dica - distancia};
+                for (int i = 0; i < 2 && status != SUCESSO; i++) {
+                        if (candidatas[i] == topo) {
+                                *posicao = topo;
+                                *anterior = POSICAO_INVALIDA;
+                                status = SUCESSO;
+                        } else if (esta_livre(mapa, candidatas[i])) {
+                                *posicao = (int)candidatas[i];
+                                *anterior = mapa->anterior[candidatas[i]];
+                                status = SUCESSO;
+                        }
+                }
+                if (status == SUCESSO) {
+                        mapa->proximas++;
+                        break;
+                }
+        }
+        pthread_mutex_unlock(&mutex_mapas);
+        return status;
+}
+
+/**
+ * @brief Registra no mapa que `posicao` saiu da lista livre (ou foi acrescentada no topo).
+ */
+void registrar_alocacao_no_mapa(FILE* arquivo, int posicao, int anterior, int proximo) {
+        pthread_mutex_lock(&mutex_mapas);
+        MAPA_LIVRE* mapa = mapa_do_arquivo(arquivo);
+        if (mapa && mapa->valido) {
+                if (posicao < 0 || crescer(mapa, (size_t)posicao + 1) != SUCESSO) {
+                        mapa->valido = 0;
+                } else {
+                        if (mapa->anterior[posicao] != POSICAO_OCUPADA) mapa->livres--;
+                        mapa->anterior[posicao] = POSICAO_OCUPADA;
+                        if (esta_livre(mapa, proximo)) mapa->anterior[proximo] = anterior;
+                }
+        }
+        pthread_mutex_unlock(&mutex_mapas);
+}
+
+/**
+ * @brief Registra no mapa que `posicao` entrou na cabeça da lista livre, antes de `proximo`.
+ */
+void registrar_liberacao_no_mapa(FILE* arquivo, int posicao, int proximo) {
+        pthread_mutex_lock(&mutex_mapas);
+        MAPA_LIVRE* mapa = mapa_do_arquivo(arquivo);
+        if (mapa && mapa->valido) {
+                if (posicao < 0 || crescer(mapa, (size_t)posicao + 1) != SUCESSO) {
+                        mapa->valido = 0;
+                } else {
+                        if (mapa->anterior[posicao] == POSICAO_OCUPADA) mapa->livres++;
+                        mapa->anterior[posicao] = POSICAO_INVALIDA;
+                        if (esta_livre(mapa, proximo)) mapa->anterior[proximo] = posicao;
+                }
+        }
+        pthread_mutex_unlock(&mutex_mapas);
+}
+
+/**
+ * @brief Lê a situação do mapa associado ao handle.
+ *
+ * @return SUCESSO, ou ERRO_ARQUIVO_NULO sem mapa associado.
+ */
+int consultar_mapa_livre(FILE* arquivo, ESTADO_MAPA_LIVRE* estado) {
+        pthread_mutex_lock(&mutex_mapas);
+        MAPA_LIVRE* mapa = mapa_do_arquivo(arquivo);
+        if (mapa && estado) {
+                estado->posicoes = mapa->posicoes;
+                estado->livres = mapa->livres;
+                estado->proximas = mapa->proximas;
+                estado->reconstrucoes = mapa->reconstrucoes;
+        }
+        pthread_mutex_unlock(&mutex_mapas);
+        return mapa ? SUCESSO : ERRO_ARQUIVO_NULO;
+}
@@ -0,0 +1,350 @@
+/**
+ * @file estatisticas.c
+ * @brief Implementa os contadores de eventos e os histogramas de latência das operações.
+ */
+
+#include "../include/estatisticas.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "../include/erros.h"
+#include "../include/rastro.h"
+#include "../include/utils.h"
+
+/** Baldes lineares do histograma, um por nanossegundo. */
+#define BALDES_LINEARES 16
+
+/** Bits de subdivisão de cada potência de 2 acima dos baldes lineares (8 baldes). */
+#define BITS_SUBDIVISAO 3
+
+/**
+ * Contadores de uma operação, atualizados sem trava.
+ */
+typedef struct {
+        _Atomic uint64_t chamadas;
+        _Atomic uint64_t eventos[QUANTIDADE_EVENTOS];
+        _Atomic uint64_t soma_ns;
+        _Atomic uint64_t maximo_ns;
+        _Atomic uint64_t histograma[BALDES_LATENCIA];
+} CONTADORES_OPERACAO;
+
+/// @brief Contadores de cada operação.
+static CONTADORES_OPERACAO contadores[QUANTIDADE_OPERACOES];
+
+/// @brief Operação medida em andamento na thread, ou -1.
+static _Thread_local int operacao_corrente = -1;
+
+/// @brief Nós lidos e gravados pela operação em andamento na thread, para o rastro.
+static _Thread_local uint64_t nos_corrente[2];
+
+/// @brief Nomes das operações, na ordem de OPERACAO_ESTATISTICA.
+static const char* const nomes_operacoes[QUANTIDADE_OPERACOES] = {
+    "outras", "cadastrar", "inserir", "buscar", "remover", "percorrer"};
+
+/// @brief Nomes dos eventos, na ordem de EVENTO_ESTATISTICA.
+static const char* const nomes_eventos[QUANTIDADE_EVENTOS] = {
+    "leituras_no", "escritas_no", "leituras_cabecalho", "escritas_cabecalho", "seeks",
+    "alocacoes"};
+
+/**
+ * @brief Balde do histograma de uma duração: exato até 15 ns e com erro de até 1/8 acima.
+ */
+static size_t balde_de(uint64_t ns) {
+        if (ns < BALDES_LINEARES) return (size_t)ns;
+        unsigned expoente = 63u - (unsigned)__builtin_clzll(ns);
+        unsigned sub = (unsigned)(ns >> (expoente - BITS_SUBDIVISAO)) & 7u;
+        return BALDES_LINEARES + (expoente - 4) * 8 + sub;
+}
+
+/**
+ * @brief Maior duração que cai no balde.
+ */
+static uint64_t limite_do_balde(size_t balde) {
+        if (balde < BALDES_LINEARES) return balde;
+        unsigned expoente = (unsigned)(balde - BALDES_LINEARES) / 8 + 4;
+        uint64_t sub = (balde - BALDES_LINEARES) % 8;
+        uint64_t largura = (uint64_t)1 << (expoente - BITS_SUBDIVISAO);
+        return (8 + sub) * largura + (largura - 1);
+}
+
+/**
+ * @brief Soma `n` ocorrências do evento à operação em andamento na thread.
+ */
+void contar_eventos(EVENTO_ESTATISTICA evento, uint64_t n) {
+        int operacao = operacao_corrente < 0 ? OPERACAO_OUTRAS : operacao_corrente;
+        if (evento == EVENTO_LEITURA_NO || evento == EVENTO_ESCRITA_NO)
+                nos_corrente[evento == EVENTO_ESCRITA_NO] += n;
+        atomic_fetch_add_explicit(&contadores[operacao].eventos[evento], n,
+                                  memory_order_relaxed);
+}
+
+/**
+ * @brief Inicia a medição de uma operação, se nenhuma outra estiver em andamento na thread.
+ */
+MEDICAO_OPERACAO iniciar_medicao(OPERACAO_ESTATISTICA operacao, uint64_t codigo) {
+        MEDICAO_OPERACAO medicao = {-1, codigo, 0};
+        if (operacao_corrente >= 0) return medicao;
+
+        operacao_corrente = (int)operacao;
+        nos_corrente[0] = nos_corrente[1] = 0;
+        medicao.operacao = (int)operacao;
+        medicao.inicio = agora_ns();
+        return medicao;
+}
+
+/**
+ * @brief Registra a duração e a chamada da operação medida e a encerra, gravando-a no rastro.
+ */
+void concluir_medicao(MEDICAO_OPERACAO* medicao, int status) {
+        if (medicao->operacao < 0) return;
+
+        uint64_t duracao = agora_ns() - medicao->inicio;
+        CONTADORES_OPERACAO* alvo = &contadores[medicao->operacao];
+        atomic_fetch_add_explicit(&alvo->chamadas, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&alvo->soma_ns, duracao, memory_order_relaxed);
+        atomic_fetch_add_explicit(&alvo->histograma[balde_de(duracao)], 1, memory_order_relaxed);
+
+        uint64_t maximo = atomic_load_explicit(&alvo->maximo_ns, memory_order_relaxed);
+        while (duracao > maximo &&
+               !atomic_compare_exchange_weak_explicit(&alvo->maximo_ns, &maximo, duracao,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+        }
+
+        if (rastro_ativo()) {
+                REGISTRO_RASTRO registro = {0};
+                registro.codigo = medicao->codigo;
+                registro.duracao_ns = duracao > UINT32_MAX ? UINT32_MAX : (uint32_t)duracao;
+                registro.leituras = nos_corrente[0] > UINT32_MAX ? UINT32_MAX : nos_corrente[0];
+                registro.escritas = nos_corrente[1] > UINT32_MAX ? UINT32_MAX : nos_corrente[1];
+                registro.operacao = (uint8_t)medicao->operacao;
+                registro.status = (int8_t)(status < INT8_MIN ? INT8_MIN : status);
+                registrar_no_rastro(&registro, medicao->inicio);
+        }
+
+        operacao_corrente = -1;
+}
+
+/**
+ * @brief Diz se o programa foi compilado com a instrumentação.
+ */
+int estatisticas_ativas(void) {
+#ifdef ESTATISTICAS
+        return 1;
+#else
+        return 0;
+#endif
+}
+
+/**
+ * @brief Copia os contadores de todas as operações.
+ */
+void ler_estatisticas(ESTATISTICAS_OPERACAO* destino) {
+        for (int i = 0; i < QUANTIDADE_OPERACOES; i++) {
+                CONTADORES_OPERACAO* origem = &contadores[i];
+                destino[i].chamadas = atomic_load_explicit(&origem->chamadas, memory_order_relaxed);
+                for (int j = 0; j < QUANTIDADE_EVENTOS; j++)
+                        destino[i].eventos[j] =
+                            atomic_load_explicit(&origem->eventos[j], memory_order_relaxed);
+                destino[i].soma_ns = atomic_load_explicit(&origem->soma_ns, memory_order_relaxed);
+                destino[i].maximo_ns =
+                    atomic_load_explicit(&origem->maximo_ns, memory_order_relaxed);
+                for (int j = 0; j < BALDES_LATENCIA; j++)
+                        destino[i].histograma[j] =
+                            atomic_load_explicit(&origem->histograma[j], memory_order_relaxed);
+        }
+}
+
+/**
+ * @brief Zera todos os contadores.
+ */
+void zerar_estatisticas(void) {
+        for (int i = 0; i < QUANTIDADE_OPERACOES; i++) {
+                CONTADORES_OPERACAO* alvo = &contadores[i];
+                atomic_store_explicit(&alvo->chamadas, 0, memory_order_relaxed);
+                for (int j = 0; j < QUANTIDADE_EVENTOS; j++)
+                        atomic_store_explicit(&alvo->eventos[j], 0, memory_order_relaxed);
+                atomic_store_explicit(&alvo->soma_ns, 0, memory_order_relaxed);
+                atomic_store_explicit(&alvo->maximo_ns, 0, memory_order_relaxed);
+                for (int j = 0; j < BALDES_LATENCIA; j++)
+                        atomic_store_explicit(&alvo->histograma[j], 0, memory_order_relaxed);
+        }
+}
+
+/**
+ * @brief Latência abaixo da qual ficam `fracao` das chamadas da operação.
+ */
+uint64_t percentil_latencia(const ESTATISTICAS_OPERACAO* estatisticas, double fracao) {
+        uint64_t total = 0;
+        for (int i = 0; i < BALDES_LATENCIA; i++) total += estatisticas->histograma[i];
+        if (total == 0) return 0;
+
+        // Posição da chamada do percentil, contando de 1.
+        double alvo = fracao * (double)total;
+        uint64_t posicao = alvo < 1 ? 1 : (uint64_t)alvo;
+        if ((double)posicao < alvo) posicao++;
+        if (posicao > total) posicao = total;
+
+        uint64_t acumulado = 0;
+        for (int i = 0; i < BALDES_LATENCIA; i++) {
+                acumulado += estatisticas->histograma[i];
+                if (acumulado >= posicao) {
+                        uint64_t limite = limite_do_balde((size_t)i);
+                        return limite < estatisticas->maximo_ns ? limite : estatisticas->maximo_ns;
+                }
+        }
+        return estatisticas->maximo_ns;
+}
+
+/**
+ * @brief Nome curto da operação.
+ */
+const char* nome_operacao(OPERACAO_ESTATISTICA operacao) {
+        return (unsigned)operacao < QUANTIDADE_OPERACOES ? nomes_operacoes[operacao] : "?";
+}
+
+/**
+ * @brief Nome curto do evento.
+ */
+const char* nome_evento(EVENTO_ESTATISTICA evento) {
+        return (unsigned)evento < QUANTIDADE_EVENTOS ? nomes_eventos[evento] : "?";
+}
+
+/**
+ * @brief Diz se a operação tem algo a relatar.
+ */
+static int tem_dados(const ESTATISTICAS_OPERACAO* estatisticas) {
+        if (estatisticas->chamadas) return 1;
+        for (int j = 0; j < QUANTIDADE_EVENTOS; j++)
+                if (estatisticas->eventos[j]) return 1;
+        return 0;
+}
+
+/**
+ * @brief Escreve a tabela de texto: latências em microssegundos e eventos por chamada.
+ */
+static void imprimir_texto(FILE* saida, const ESTATISTICAS_OPERACAO* estatisticas) {
+        fprintf(saida, "%-10s %10s %9s %9s %9s %9s %9s", "operacao", "chamadas", "media_us",
+                "p50_us", "p99_us", "p999_us", "max_us");
+        for (int j = 0; j < QUANTIDADE_EVENTOS; j++) fprintf(saida, " %s", nomes_eventos[j]);
+        fprintf(saida, "\n");
+
+        for (int i = 0; i < QUANTIDADE_OPERACOES; i++) {
+                const ESTATISTICAS_OPERACAO* op = &estatisticas[i];
+                if (!tem_dados(op)) continue;
+
+                double chamadas = op->chamadas ? (double)op->chamadas : 1;
+                fprintf(saida, "%-10s %10llu %9.2f %9.2f %9.2f %9.2f %9.2f", nomes_operacoes[i],
+                        (unsigned long long)op->chamadas, (double)op->soma_ns / chamadas / 1e3,
+                        (double)percentil_latencia(op, 0.50) / 1e3,
+                        (double)percentil_latencia(op, 0.99) / 1e3,
+                        (double)percentil_latencia(op, 0.999) / 1e3,
+                        (double)op->maximo_ns / 1e3);
+                // Por chamada; em "outras", que não tem chamadas, o total.
+                for (int j = 0; j < QUANTIDADE_EVENTOS; j++)
+                        fprintf(saida, " %*.2f", (int)strlen(nomes_eventos[j]),
+                                (double)op->eventos[j] / chamadas);
+                fprintf(saida, "\n");
+        }
+}
+
+/**
+ * @brief Escreve um objeto JSON com os totais e os percentis em nanossegundos.
+ */
+static void imprimir_json(FILE* saida, const ESTATISTICAS_OPERACAO* estatisticas) {
+        fprintf(saida, "{\"ativas\":%s,\"operacoes\":{", estatisticas_ativas() ? "true" : "false");
+        int primeira = 1;
+        for (int i = 0; i < QUANTIDADE_OPERACOES; i++) {
+                const ESTATISTICAS_OPERACAO* op = &estatisticas[i];
+                if (!tem_dados(op)) continue;
+
+                fprintf(saida,
+                        "%s\"%s\":{\"chamadas\":%llu,\"latencia_ns\":{\"soma\":%llu,\"p50\":%llu,"
+                        "\"p99\":%llu,\"p999\":%llu,\"max\":%llu},\"eventos\":{",
+                        primeira ? "" : ",", nomes_operacoes[i], (unsigned long long)op->chamadas,
+                        (unsigned long long)op->soma_ns,
+                        (unsigned long long)percentil_latencia(op, 0.50),
+                        (unsigned long long)percentil_latencia(op, 0.99),
+                        (unsigned long long)percentil_latencia(op, 0.999),
+                        (unsigned long long)op->maximo_ns);
+                for (int j = 0; j < QUANTIDADE_EVENTOS; j++)
+                        fprintf(saida, "%s\"%s\":%llu", j ? "," : "", nomes_eventos[j],
+                                (unsigned long long)op->eventos[j]);
+                fprintf(saida, "}}");
+                primeira = 0;
+        }
+        fprintf(saida, "}}\n");
+}
+
+/**
+ * @brief Escreve os contadores atuais de todas as operações com chamadas ou eventos.
+ *
+ * @param saida Destino do relatório.
+ * @param formato Tabela de texto ou JSON.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO ou ERRO_ARQUIVO_WRITE.
+ */
+int imprimir_estatisticas(FILE* saida, FORMATO_ESTATISTICAS formato) {
+        if (saida == NULL) return ERRO_ARQUIVO_NULO;
+
+        if (formato == ESTATISTICAS_TEXTO && !estatisticas_ativas()) {
+                fprintf(saida, "Estatisticas desativadas na compilacao (make ESTATISTICAS=1).\n");
+                return fflush(saida) == 0 ? SUCESSO : ERRO_ARQUIVO_WRITE;
+        }
+
+        static ESTATISTICAS_OPERACAO copia[QUANTIDADE_OPERACOES];
+        static pthread_mutex_t mutex_copia = PTHREAD_MUTEX_INITIALIZER;
+
+        // A cópia tem cerca de 20 KB: estática, protegida, em vez de na pilha de quem chama.
+        pthread_mutex_lock(&mutex_copia);
+        ler_estatisticas(copia);
+        if (formato == ESTATISTICAS_JSON)
+                imprimir_json(saida, copia);
+        else
+                imprimir_texto(saida, copia);
+        pthread_mutex_unlock(&mutex_copia);
+
+        return fflush(saida) == 0 && !ferror(saida) ? SUCESSO : ERRO_ARQUIVO_WRITE;
+}
+
+/**
+ * @brief Thread que espera SIGUSR1 e SIGUSR2 e escreve as estatísticas.
+ */
+static void* despejar_por_sinal(void* argumento) {
+        FILE* saida = argumento;
+        sigset_t sinais;
+        sigemptyset(&sinais);
+        sigaddset(&sinais, SIGUSR1);
+        sigaddset(&sinais, SIGUSR2);
+
+        for (;;) {
+                int sinal;
+                if (sigwait(&sinais, &sinal) != 0) continue;
+                imprimir_estatisticas(saida,
+                                      sinal == SIGUSR2 ? ESTATISTICAS_JSON : ESTATISTICAS_TEXTO);
+        }
+        return NULL;
+}
+
+/**
+ * @brief Cria a thread que escreve as estatísticas ao receber SIGUSR1 ou SIGUSR2.
+ *
+ * @param saida Destino dos relatórios.
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+int iniciar_despejo_por_sinal(FILE* saida) {
+        if (saida == NULL) return ERRO_ARQUIVO_NULO;
+
+        sigset_t sinais;
+        sigemptyset(&sinais);
+        sigaddset(&sinais, SIGUSR1);
+        sigaddset(&sinais, SIGUSR2);
+        pthread_sigmask(SIG_BLOCK, &sinais, NULL);
+
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, despejar_por_sinal, saida) != 0) return ERRO_MEMORIA;
+        pthread_detach(thread);
+        return SUCESSO;
+}
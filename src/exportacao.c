@@ -0,0 +1,304 @@
+/**
+ * @file exportacao.c
+ * @brief Implementa a exportação do catálogo para CSV e JSON Lines.
+ */
+
+#include "../include/exportacao.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/livro.h"
+#include "../include/utils.h"
+
+/** Maior registro formatado: textos com todo byte escapado (`\u00XX`) e os cinco números. */
+#define MAXIMO_REGISTRO ((MAX_TITULO + MAX_AUTOR + MAX_EDITORA) * 6 + 512)
+
+/** Pares de algarismos "00".."99", para converter dois dígitos por divisão. */
+static const char pares_de_algarismos[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * Buffer de saída e o estado da exportação.
+ */
+typedef struct {
+        FILE* destino;                  /**< Arquivo texto de saída. */
+        FORMATO_EXPORTACAO formato;     /**< Formato de cada linha. */
+        char* dados;                    /**< Buffer de TAMANHO_BUFFER_EXPORTACAO bytes. */
+        size_t usados;                  /**< Bytes em `dados`. */
+        RELATORIO_EXPORTACAO relatorio; /**< Contadores acumulados. */
+} SAIDA_EXPORTACAO;
+
+/**
+ * @brief Escolhe o formato pela extensão: `.json` e `.jsonl` dão JSON Lines, o resto CSV.
+ */
+FORMATO_EXPORTACAO formato_pelo_caminho(const char* caminho) {
+        const char* ponto = strrchr(caminho, '.');
+        if (ponto && (strcasecmp(ponto, ".jsonl") == 0 || strcasecmp(ponto, ".json") == 0))
+                return EXPORTACAO_JSONL;
+        return EXPORTACAO_CSV;
+}
+
+/**
+ * @brief Envia o buffer ao arquivo.
+ */
+static int descarregar(SAIDA_EXPORTACAO* saida) {
+        if (saida->usados == 0) return SUCESSO;
+        if (fwrite(saida->dados, 1, saida->usados, saida->destino) != saida->usados)
+                return ERRO_ARQUIVO_WRITE;
+        saida->relatorio.bytes += saida->usados;
+        saida->usados = 0;
+        return SUCESSO;
+}
+
+/**
+ * @brief Escreve `valor` em decimal, dois algarismos por divisão.
+ *
+ * @return Posição logo após o último algarismo.
+ */
+static char* escrever_inteiro(char* destino, size_t valor) {
+        char algarismos[24];
+        char* inicio = algarismos + sizeof(algarismos);
+
+        while (valor >= 100) {
+                size_t par = (valor % 100) * 2;
+                valor /= 100;
+                *--inicio = pares_de_algarismos[par + 1];
+                *--inicio = pares_de_algarismos[par];
+        }
+        if (valor >= 10) {
+                *--inicio = pares_de_algarismos[valor * 2 + 1];
+                *--inicio = pares_de_algarismos[valor * 2];
+        } else {
+                *--inicio = (char)('0' + valor);
+        }
+
+        size_t tamanho = (size_t)(algarismos + sizeof(algarismos) - inicio);
+        memcpy(destino, inicio, tamanho);
+        return destino + tamanho;
+}
+
+/**
+ * @brief Escreve o preço de modo que converter_preco() (utils.h) devolva o mesmo double.
+ *
+ * Preços em centavos exatos, o caso comum, saem como `R.CC` sem printf; os demais (frações de
+ * centavo, valores enormes) caem no sprintf com nove casas, sem os zeros à direita. A
+ * importação só aceita até 19 algarismos inteiros; acima de 10^50 o preço sai em notação
+ * científica, que ela também recusa.
+ *
+ * @return Posição logo após o último caractere.
+ */
+static char* escrever_preco(char* destino, double preco) {
+        if (preco >= 0 && preco < 1e15) {
+                size_t centavos = (size_t)(preco * 100 + 0.5);
+                if ((double)centavos / 100 == preco) {
+                        destino = escrever_inteiro(destino, centavos / 100);
+                        *destino++ = '.';
+                        memcpy(destino, &pares_de_algarismos[(centavos % 100) * 2], 2);
+                        return destino + 2;
+                }
+        }
+
+        if (!(preco > -1e50 && preco < 1e50)) return destino + sprintf(destino, "%.17g", preco);
+
+        int tamanho = sprintf(destino, "%.9f", preco);
+        char* fim = destino + tamanho;
+        if (memchr(destino, '.', (size_t)tamanho)) {
+                while (fim[-1] == '0') fim--;
+                if (fim[-1] == '.') fim--;
+        }
+        return fim;
+}
+
+/**
+ * @brief Copia um texto do LIVRO para o CSV, trocando por espaço o que quebraria a linha.
+ *
+ * @return Posição logo após o último byte copiado.
+ */
+static char* escrever_texto_csv(SAIDA_EXPORTACAO* saida, char* destino, const char* texto,
+                                size_t capacidade) {
+        size_t tamanho = strnlen(texto, capacidade);
+        int alterado = 0;
+
+        for (size_t i = 0; i < tamanho; i++) {
+                unsigned char c = (unsigned char)texto[i];
+                if (c == ';' || c < 0x20 || c == 0x7F) {
+                        c = ' ';
+                        alterado = 1;
+                }
+                destino[i] = (char)c;
+        }
+
+        saida->relatorio.campos_alterados += (size_t)alterado;
+        return destino + tamanho;
+}
+
+/**
+ * @brief Copia um texto do LIVRO para o JSON, entre aspas e escapado.
+ *
+ * @return Posição logo após a aspa final.
+ */
+static char* escrever_texto_json(char* destino, const char* texto, size_t capacidade) {
+        static const char hexadecimal[] = "0123456789abcdef";
+        size_t tamanho = strnlen(texto, capacidade);
+
+        *destino++ = '"';
+        for (size_t i = 0; i < tamanho; i++) {
+                unsigned char c = (unsigned char)texto[i];
+                if (c >= 0x20 && c != '"' && c != '\\') {
+                        *destino++ = (char)c;
+                        continue;
+                }
+
+                *destino++ = '\\';
+                switch (c) {
+                        case '"':
+                        case '\\':
+                                *destino++ = (char)c;
+                                break;
+                        case '\n':
+                                *destino++ = 'n';
+                                break;
+                        case '\t':
+                                *destino++ = 't';
+                                break;
+                        case '\r':
+                                *destino++ = 'r';
+                                break;
+                        default:
+                                memcpy(destino, "u00", 3);
+                                destino[3] = hexadecimal[c >> 4];
+                                destino[4] = hexadecimal[c & 0xF];
+                                destino += 5;
+                                break;
+                }
+        }
+        *destino++ = '"';
+        return destino;
+}
+
+/**
+ * @brief Formata o livro como uma linha do CSV de importação.
+ */
+static char* formatar_csv(SAIDA_EXPORTACAO* saida, char* p, const LIVRO* livro) {
+        p = escrever_inteiro(p, livro->codigo);
+        *p++ = ';';
+        p = escrever_texto_csv(saida, p, livro->titulo, sizeof(livro->titulo));
+        *p++ = ';';
+        p = escrever_texto_csv(saida, p, livro->autor, sizeof(livro->autor));
+        *p++ = ';';
+        p = escrever_texto_csv(saida, p, livro->editora, sizeof(livro->editora));
+        *p++ = ';';
+        p = escrever_inteiro(p, livro->edicao);
+        *p++ = ';';
+        p = escrever_inteiro(p, livro->ano);
+        *p++ = ';';
+        p = escrever_inteiro(p, livro->exemplares);
+        *p++ = ';';
+        p = escrever_preco(p, livro->preco);
+        *p++ = '\n';
+        return p;
+}
+
+/**
+ * @brief Copia uma constante de texto (a chave JSON e seus delimitadores).
+ */
+#define ESCREVER_LITERAL(p, literal)                         \
+        do {                                                 \
+                memcpy((p), (literal), sizeof(literal) - 1); \
+                (p) += sizeof(literal) - 1;                  \
+        } while (0)
+
+/**
+ * @brief Formata o livro como um objeto JSON numa linha.
+ */
+static char* formatar_json(char* p, const LIVRO* livro) {
+        ESCREVER_LITERAL(p, "{\"codigo\":");
+        p = escrever_inteiro(p, livro->codigo);
+        ESCREVER_LITERAL(p, ",\"titulo\":");
+        p = escrever_texto_json(p, livro->titulo, sizeof(livro->titulo));
+        ESCREVER_LITERAL(p, ",\"autor\":");
+        p = escrever_texto_json(p, livro->autor, sizeof(livro->autor));
+        ESCREVER_LITERAL(p, ",\"editora\":");
+        p = escrever_texto_json(p, livro->editora, sizeof(livro->editora));
+        ESCREVER_LITERAL(p, ",\"edicao\":");
+        p = escrever_inteiro(p, livro->edicao);
+        ESCREVER_LITERAL(p, ",\"ano\":");
+        p = escrever_inteiro(p, livro->ano);
+        ESCREVER_LITERAL(p, ",\"exemplares\":");
+        p = escrever_inteiro(p, livro->exemplares);
+        ESCREVER_LITERAL(p, ",\"preco\":");
+        // JSON não representa NaN nem infinito.
+        if (isfinite(livro->preco))
+                p = escrever_preco(p, livro->preco);
+        else
+                ESCREVER_LITERAL(p, "null");
+        ESCREVER_LITERAL(p, "}\n");
+        return p;
+}
+
+/**
+ * @brief Visitante da exportação: formata o livro no buffer, descarregando-o antes se preciso.
+ */
+static int exportar_no(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)posicao;
+        SAIDA_EXPORTACAO* saida = contexto;
+
+        // Com espaço para o maior registro possível, a formatação não precisa conferir limites.
+        if (TAMANHO_BUFFER_EXPORTACAO - saida->usados < MAXIMO_REGISTRO) {
+                int status = descarregar(saida);
+                if (status != SUCESSO) return status;
+        }
+
+        char* inicio = saida->dados + saida->usados;
+        char* fim = saida->formato == EXPORTACAO_JSONL ? formatar_json(inicio, &no->livro)
+                                                       : formatar_csv(saida, inicio, &no->livro);
+        saida->usados += (size_t)(fim - inicio);
+        saida->relatorio.livros++;
+        return SUCESSO;
+}
+
+/**
+ * @brief Exporta todos os livros, em ordem de código.
+ *
+ * @param arquivo Arquivo binário da árvore, aberto para leitura.
+ * @param destino Arquivo texto de saída, aberto para escrita.
+ * @param formato Formato de saída.
+ * @param[out] relatorio Contadores da exportação (opcional).
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_MEMORIA, ERRO_ARQUIVO_WRITE ou erros do percurso.
+ */
+int exportar_catalogo(FILE* arquivo, FILE* destino, FORMATO_EXPORTACAO formato,
+                      RELATORIO_EXPORTACAO* relatorio) {
+        if (arquivo == NULL || destino == NULL) return ERRO_ARQUIVO_NULO;
+
+        SAIDA_EXPORTACAO saida;
+        memset(&saida, 0, sizeof(saida));
+        saida.destino = destino;
+        saida.formato = formato;
+        saida.dados = malloc(TAMANHO_BUFFER_EXPORTACAO);
+        if (saida.dados == NULL) return ERRO_MEMORIA;
+
+        double inicio = agora();
+        int status = percorrer_em_ordem(arquivo, exportar_no, &saida);
+        if (status == SUCESSO) status = descarregar(&saida);
+        if (status == SUCESSO && fflush(destino) != 0) status = ERRO_ARQUIVO_WRITE;
+        saida.relatorio.segundos = agora() - inicio;
+
+        free(saida.dados);
+        if (relatorio) *relatorio = saida.relatorio;
+        return status;
+}
@@ -0,0 +1,381 @@
+/**
+ * @file filtro.c
+ * @brief Implementa o filtro de Bloom persistente sobre os códigos do catálogo.
+ */
+
+#include "../include/filtro.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/utils.h"
+
+/** Bits de um bloco do filtro: oito palavras de 32 bits. */
+#define BITS_POR_BLOCO 256
+
+/** Maior quantidade de blocos: o bloco é escolhido por 32 bits do hash. */
+#define BLOCOS_MAXIMOS_FILTRO ((uint64_t)1 << 32)
+
+/** Multiplicadores ímpares que escolhem o bit de cada palavra do bloco (os do Parquet). */
+static const uint32_t sais[8] = {0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+                                 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+
+/**
+ * Bloco do filtro, do tamanho de meia linha de cache.
+ */
+typedef struct {
+        uint32_t palavras[8]; /**< Um bit de cada código do bloco em cada palavra. */
+} BLOCO_FILTRO;
+
+/**
+ * Vetor de bits do filtro.
+ */
+typedef struct {
+        BLOCO_FILTRO* blocos; /**< Blocos do filtro. */
+        size_t quantidade;    /**< Blocos em `blocos` (potência de 2). */
+        size_t registrados;   /**< Códigos marcados. */
+} BITS_FILTRO;
+
+/**
+ * Filtro associado a um handle do arquivo de livros.
+ */
+typedef struct FILTRO_BLOOM {
+        FILE* arquivo;                /**< Handle do arquivo de livros. */
+        char* caminho;                /**< Caminho do arquivo do filtro. */
+        BITS_FILTRO bits;             /**< Vetor de bits. */
+        size_t removidos;             /**< Remoções desde a última reconstrução. */
+        size_t reconstrucoes;         /**< Reconstruções desde a abertura. */
+        int valido;                   /**< Zero se uma reconstrução falhou. */
+        struct FILTRO_BLOOM* proximo; /**< Próxima associação. */
+} FILTRO_BLOOM;
+
+/// @brief Filtros associados a handles abertos.
+static FILTRO_BLOOM* filtros = NULL;
+
+/// @brief Protege a lista de filtros e os filtros nela.
+static pthread_mutex_t mutex_filtros = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Marca o código no vetor de bits: os 32 bits altos do hash escolhem o bloco e os
+ * baixos, multiplicados por cada sal, o bit de cada palavra.
+ */
+static void marcar_codigo(BITS_FILTRO* bits, size_t codigo) {
+        uint64_t hash = espalhar_codigo(codigo);
+        BLOCO_FILTRO* bloco = &bits->blocos[(hash >> 32) & (bits->quantidade - 1)];
+        for (int i = 0; i < 8; i++) bloco->palavras[i] |= 1u << (((uint32_t)hash * sais[i]) >> 27);
+        bits->registrados++;
+}
+
+/**
+ * @brief Diz se todos os bits do código estão marcados.
+ */
+static int contem_codigo(const BITS_FILTRO* bits, size_t codigo) {
+        uint64_t hash = espalhar_codigo(codigo);
+        const BLOCO_FILTRO* bloco = &bits->blocos[(hash >> 32) & (bits->quantidade - 1)];
+        for (int i = 0; i < 8; i++)
+                if (!(bloco->palavras[i] & (1u << (((uint32_t)hash * sais[i]) >> 27)))) return 0;
+        return 1;
+}
+
+/**
+ * @brief Blocos para `codigos` códigos: a menor potência de 2 com BITS_POR_CODIGO_FILTRO bits
+ * por código, respeitados os limites.
+ */
+static size_t blocos_para(size_t codigos) {
+        uint64_t necessarios = ((uint64_t)codigos * BITS_POR_CODIGO_FILTRO + BITS_POR_BLOCO - 1) /
+                               BITS_POR_BLOCO;
+        uint64_t blocos = BLOCOS_MINIMOS_FILTRO;
+        while (blocos < necessarios && blocos < BLOCOS_MAXIMOS_FILTRO) blocos *= 2;
+        return (size_t)blocos;
+}
+
+/**
+ * @brief Códigos que cabem no vetor de bits antes de ele precisar crescer.
+ */
+static size_t capacidade(const BITS_FILTRO* bits) {
+        return bits->quantidade * (BITS_POR_BLOCO / BITS_POR_CODIGO_FILTRO);
+}
+
+/**
+ * @brief Filtro associado ao handle, ou NULL. Chamar com `mutex_filtros` travado.
+ */
+static FILTRO_BLOOM* filtro_do_arquivo(FILE* arquivo) {
+        for (FILTRO_BLOOM* filtro = filtros; filtro; filtro = filtro->proximo)
+                if (filtro->arquivo == arquivo) return filtro;
+        return NULL;
+}
+
+/**
+ * @brief Visitante da reconstrução: marca o código do nó.
+ */
+static int marcar_no(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)posicao;
+        marcar_codigo(contexto, no->livro.codigo);
+        return SUCESSO;
+}
+
+/**
+ * @brief Refaz o vetor de bits percorrendo a árvore, com folga para o dobro dos livros atuais.
+ *
+ * Em caso de erro, o vetor antigo é mantido.
+ */
+static int refazer(FILTRO_BLOOM* filtro) {
+        CABECALHO* cabecalho = le_cabecalho(filtro->arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+        size_t quantidade = cabecalho->quantidade_livros;
+        free(cabecalho);
+
+        BITS_FILTRO bits = {0};
+        bits.quantidade = blocos_para(2 * quantidade);
+        bits.blocos = calloc(bits.quantidade, sizeof(BLOCO_FILTRO));
+        if (bits.blocos == NULL) return ERRO_MEMORIA;
+
+        int status = percorrer_em_ordem(filtro->arquivo, marcar_no, &bits);
+        if (status != SUCESSO) {
+                free(bits.blocos);
+                return status;
+        }
+
+        free(filtro->bits.blocos);
+        filtro->bits = bits;
+        filtro->removidos = 0;
+        filtro->reconstrucoes++;
+        filtro->valido = 1;
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê o arquivo do filtro, se existir e corresponder ao arquivo de livros como ele está.
+ *
+ * @return SUCESSO, ou um código de erro se o filtro precisar ser refeito.
+ */
+static int carregar(FILTRO_BLOOM* filtro) {
+        FILE* origem = fopen(filtro->caminho, "rb");
+        if (origem == NULL) return ERRO_ARQUIVO_NULO;
+
+        CABECALHO_FILTRO lido;
+        IDENTIDADE_ARQUIVO atual;
+        int status = SUCESSO;
+        if (fread(&lido, sizeof(lido), 1, origem) != 1 || lido.magica != MAGICA_FILTRO ||
+            lido.versao != VERSAO_FILTRO || lido.blocos < BLOCOS_MINIMOS_FILTRO ||
+            lido.blocos > BLOCOS_MAXIMOS_FILTRO || (lido.blocos & (lido.blocos - 1)) != 0 ||
+            lido.blocos > SIZE_MAX / sizeof(BLOCO_FILTRO))
+                status = ERRO_ARQUIVO_READ;
+        if (status == SUCESSO) status = identificar_arquivo(filtro->arquivo, &atual);
+        if (status == SUCESSO && memcmp(&lido.livros, &atual, sizeof(atual)) != 0)
+                status = ERRO_ARQUIVO_READ;
+
+        BITS_FILTRO bits = {0};
+        if (status == SUCESSO) {
+                bits.quantidade = (size_t)lido.blocos;
+                bits.registrados = (size_t)lido.registrados;
+                bits.blocos = malloc(bits.quantidade * sizeof(BLOCO_FILTRO));
+                if (bits.blocos == NULL) status = ERRO_MEMORIA;
+        }
+        if (status == SUCESSO &&
+            (fread(bits.blocos, sizeof(BLOCO_FILTRO), bits.quantidade, origem) != bits.quantidade ||
+             fgetc(origem) != EOF))
+                status = ERRO_ARQUIVO_READ;
+        fclose(origem);
+
+        if (status != SUCESSO) {
+                free(bits.blocos);
+                return status;
+        }
+
+        filtro->bits = bits;
+        filtro->removidos = (size_t)lido.removidos;
+        filtro->valido = 1;
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava o filtro num arquivo temporário e o renomeia sobre o arquivo do filtro.
+ */
+static int gravar(FILTRO_BLOOM* filtro) {
+        CABECALHO_FILTRO cabecalho;
+        memset(&cabecalho, 0, sizeof(cabecalho));
+        cabecalho.magica = MAGICA_FILTRO;
+        cabecalho.versao = VERSAO_FILTRO;
+        cabecalho.blocos = filtro->bits.quantidade;
+        cabecalho.registrados = filtro->bits.registrados;
+        cabecalho.removidos = filtro->removidos;
+        int status = identificar_arquivo(filtro->arquivo, &cabecalho.livros);
+        if (status != SUCESSO) return status;
+
+        size_t tamanho = strlen(filtro->caminho);
+        char* temporario = malloc(tamanho + sizeof(".tmp"));
+        if (temporario == NULL) return ERRO_MEMORIA;
+        memcpy(temporario, filtro->caminho, tamanho);
+        memcpy(temporario + tamanho, ".tmp", sizeof(".tmp"));
+
+        FILE* destino = fopen(temporario, "wb");
+        if (destino == NULL) status = ERRO_ARQUIVO_WRITE;
+        if (status == SUCESSO &&
+            (fwrite(&cabecalho, sizeof(cabecalho), 1, destino) != 1 ||
+             fwrite(filtro->bits.blocos, sizeof(BLOCO_FILTRO), filtro->bits.quantidade,
+                    destino) != filtro->bits.quantidade))
+                status = ERRO_ARQUIVO_WRITE;
+        if (destino != NULL && fclose(destino) != 0) status = ERRO_ARQUIVO_WRITE;
+        if (status == SUCESSO && rename(temporario, filtro->caminho) != 0)
+                status = ERRO_ARQUIVO_WRITE;
+
+        if (status != SUCESSO) remove(temporario);
+        free(temporario);
+        return status;
+}
+
+/**
+ * @brief Libera um filtro já fora da lista.
+ */
+static void liberar_filtro(FILTRO_BLOOM* filtro) {
+        free(filtro->bits.blocos);
+        free(filtro->caminho);
+        free(filtro);
+}
+
+/**
+ * @brief Associa um filtro ao handle, lendo o arquivo do filtro ou refazendo-o pela árvore.
+ *
+ * Se o handle já tiver filtro, não faz nada.
+ *
+ * @param arquivo Arquivo binário da árvore, já travado pelo chamador.
+ * @param caminho Caminho do arquivo de livros.
+ * @return SUCESSO ou código de erro.
+ */
+int abrir_filtro(FILE* arquivo, const char* caminho) {
+        if (arquivo == NULL || caminho == NULL) return ERRO_ARQUIVO_NULO;
+
+        pthread_mutex_lock(&mutex_filtros);
+        FILTRO_BLOOM* existente = filtro_do_arquivo(arquivo);
+        pthread_mutex_unlock(&mutex_filtros);
+        if (existente) return SUCESSO;
+
+        FILTRO_BLOOM* filtro = calloc(1, sizeof(FILTRO_BLOOM));
+        if (filtro == NULL) return ERRO_MEMORIA;
+        size_t tamanho = strlen(caminho);
+        filtro->caminho = malloc(tamanho + sizeof(SUFIXO_FILTRO));
+        if (filtro->caminho == NULL) {
+                free(filtro);
+                return ERRO_MEMORIA;
+        }
+        memcpy(filtro->caminho, caminho, tamanho);
+        memcpy(filtro->caminho + tamanho, SUFIXO_FILTRO, sizeof(SUFIXO_FILTRO));
+        filtro->arquivo = arquivo;
+
+        int status = carregar(filtro);
+        if (status != SUCESSO) status = refazer(filtro);
+        if (status != SUCESSO) {
+                liberar_filtro(filtro);
+                return status;
+        }
+
+        pthread_mutex_lock(&mutex_filtros);
+        filtro->proximo = filtros;
+        filtros = filtro;
+        pthread_mutex_unlock(&mutex_filtros);
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava o filtro ao lado do arquivo de livros e desfaz a associação.
+ *
+ * Com muitas remoções desde a última reconstrução, o filtro é refeito antes; um filtro que
+ * deixou de ser válido não é gravado, e o arquivo antigo é apagado.
+ *
+ * @param arquivo Handle passado a abrir_filtro().
+ * @return SUCESSO ou código de erro.
+ */
+int fechar_filtro(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_filtros);
+        FILTRO_BLOOM** elo = &filtros;
+        while (*elo && (*elo)->arquivo != arquivo) elo = &(*elo)->proximo;
+        FILTRO_BLOOM* filtro = *elo;
+        if (filtro) *elo = filtro->proximo;
+        pthread_mutex_unlock(&mutex_filtros);
+        if (filtro == NULL) return SUCESSO;
+
+        int status = SUCESSO;
+        if (filtro->valido && filtro->removidos > filtro->bits.registrados / 4)
+                status = refazer(filtro);
+        if (status == SUCESSO && filtro->valido) status = gravar(filtro);
+        if (status != SUCESSO || !filtro->valido) remove(filtro->caminho);
+
+        liberar_filtro(filtro);
+        return status;
+}
+
+/**
+ * @brief Diz se o código certamente não está na árvore.
+ *
+ * @return 1 se o filtro descarta o código; 0 caso contrário ou sem filtro.
+ */
+int codigo_certamente_ausente(FILE* arquivo, size_t codigo) {
+        pthread_mutex_lock(&mutex_filtros);
+        FILTRO_BLOOM* filtro = filtro_do_arquivo(arquivo);
+        int ausente = filtro && filtro->valido && !contem_codigo(&filtro->bits, codigo);
+        pthread_mutex_unlock(&mutex_filtros);
+        return ausente;
+}
+
+/**
+ * @brief Registra um código recém-inserido, dobrando o filtro quando passa da capacidade.
+ */
+void registrar_codigo_no_filtro(FILE* arquivo, size_t codigo) {
+        pthread_mutex_lock(&mutex_filtros);
+        FILTRO_BLOOM* filtro = filtro_do_arquivo(arquivo);
+        if (filtro && filtro->valido) {
+                marcar_codigo(&filtro->bits, codigo);
+                if (filtro->bits.registrados > capacidade(&filtro->bits) &&
+                    refazer(filtro) != SUCESSO)
+                        filtro->valido = 0;
+        }
+        pthread_mutex_unlock(&mutex_filtros);
+}
+
+/**
+ * @brief Conta uma remoção no filtro associado ao handle, se houver.
+ */
+void registrar_remocao_no_filtro(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_filtros);
+        FILTRO_BLOOM* filtro = filtro_do_arquivo(arquivo);
+        if (filtro) filtro->removidos++;
+        pthread_mutex_unlock(&mutex_filtros);
+}
+
+/**
+ * @brief Refaz o filtro associado ao handle a partir dos códigos da árvore.
+ *
+ * @return SUCESSO (também sem filtro associado) ou código de erro.
+ */
+int reconstruir_filtro(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_filtros);
+        FILTRO_BLOOM* filtro = filtro_do_arquivo(arquivo);
+        int status = filtro ? refazer(filtro) : SUCESSO;
+        if (status != SUCESSO) filtro->valido = 0;
+        pthread_mutex_unlock(&mutex_filtros);
+        return status;
+}
+
+/**
+ * @brief Lê a situação do filtro associado ao handle.
+ *
+ * @return SUCESSO, ou ERRO_ARQUIVO_NULO sem filtro associado.
+ */
+int consultar_filtro(FILE* arquivo, ESTADO_FILTRO* estado) {
+        pthread_mutex_lock(&mutex_filtros);
+        FILTRO_BLOOM* filtro = filtro_do_arquivo(arquivo);
+        if (filtro && estado) {
+                estado->bits = filtro->bits.quantidade * BITS_POR_BLOCO;
+                estado->registrados = filtro->bits.registrados;
+                estado->removidos = filtro->removidos;
+                estado->reconstrucoes = filtro->reconstrucoes;
+        }
+        pthread_mutex_unlock(&mutex_filtros);
+        return filtro ? SUCESSO : ERRO_ARQUIVO_NULO;
+}
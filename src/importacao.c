@@ -0,0 +1,442 @@
+/**
+ * @file importacao.c
+ * @brief Implementa a importação do arquivo texto de livros.
+ */
+
+#include "../include/importacao.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/erros.h"
+#include "../include/utils.h"
+#include "../include/varredura.h"
+
+/** Quantidade de campos de uma linha. */
+#define CAMPOS_LIVRO 8
+
+/** Bytes lidos por vez quando a entrada não pode ser mapeada. */
+#define BLOCO_LEITURA (1 << 16)
+
+/** Buffer do fluxo que grava as linhas rejeitadas. */
+#define BUFFER_REJEITADAS (1 << 16)
+
+/**
+ * Trecho de uma linha, sem terminador nulo.
+ */
+typedef struct {
+        const char* inicio;
+        size_t tamanho;
+} CAMPO;
+
+/**
+ * @brief Lê por inteiro um descritor que não pode ser mapeado (pipe, terminal, ...).
+ */
+static int ler_texto_inteiro(int descritor, TEXTO_MAPEADO* texto) {
+        char* dados = NULL;
+        size_t tamanho = 0;
+        size_t capacidade = 0;
+
+        for (;;) {
+                if (capacidade - tamanho < BLOCO_LEITURA) {
+                        size_t nova = capacidade ? capacidade * 2 : BLOCO_LEITURA;
+                        char* maior = realloc(dados, nova);
+                        if (maior == NULL) {
+                                free(dados);
+                                return ERRO_MEMORIA;
+                        }
+                        dados = maior;
+                        capacidade = nova;
+                }
+
+                ssize_t lidos = read(descritor, dados + tamanho, capacidade - tamanho);
+                if (lidos < 0) {
+                        free(dados);
+                        return ERRO_ARQUIVO_TEXTO;
+                }
+                if (lidos == 0) break;
+                tamanho += (size_t)lidos;
+        }
+
+        texto->dados = dados;
+        texto->tamanho = tamanho;
+        texto->mapeado = 0;
+        return SUCESSO;
+}
+
+/**
+ * @brief Disponibiliza o arquivo texto em memória.
+ *
+ * @param caminho Caminho do arquivo texto.
+ * @param[out] texto Conteúdo, a liberar com liberar_texto().
+ * @return SUCESSO, ERRO_ARQUIVO_TEXTO se o arquivo não puder ser lido ou ERRO_MEMORIA.
+ */
+int mapear_texto(const char* caminho, TEXTO_MAPEADO* texto) {
+        if (caminho == NULL || texto == NULL) return ERRO_ARQUIVO_TEXTO;
+        memset(texto, 0, sizeof(*texto));
+
+        int descritor = open(caminho, O_RDONLY);
+        if (descritor < 0) return ERRO_ARQUIVO_TEXTO;
+
+        struct stat info;
+        if (fstat(descritor, &info) != 0) {
+                close(descritor);
+                return ERRO_ARQUIVO_TEXTO;
+        }
+
+        int status = SUCESSO;
+        if (!S_ISREG(info.st_mode)) {
+                status = ler_texto_inteiro(descritor, texto);
+        } else if (info.st_size > 0) {
+                size_t tamanho = (size_t)info.st_size;
+                void* dados = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, descritor, 0);
+                if (dados == MAP_FAILED) {
+                        status = ERRO_ARQUIVO_TEXTO;
+                } else {
+                        madvise(dados, tamanho, MADV_SEQUENTIAL);
+                        texto->dados = dados;
+                        texto->tamanho = tamanho;
+                        texto->mapeado = 1;
+                }
+        }
+
+        close(descritor);
+        return status;
+}
+
+/**
+ * @brief Desfaz o mapeamento (ou libera a cópia) feito por mapear_texto().
+ */
+void liberar_texto(TEXTO_MAPEADO* texto) {
+        if (texto == NULL || texto->dados == NULL) return;
+
+        if (texto->mapeado)
+                munmap((void*)texto->dados, texto->tamanho);
+        else
+                free((void*)texto->dados);
+
+        texto->dados = NULL;
+        texto->tamanho = 0;
+}
+
+/**
+ * @brief Posiciona o leitor no início de `tamanho` bytes em `dados`.
+ */
+void iniciar_leitor_linhas(LEITOR_LINHAS* leitor, const char* dados, size_t tamanho) {
+        leitor->atual = dados;
+        leitor->fim = dados + tamanho;
+        leitor->numero_linha = 0;
+}
+
+/**
+ * @brief Avança para a próxima linha.
+ *
+ * @param[out] linha Primeiro byte da linha.
+ * @param[out] tamanho Bytes da linha, sem o `\n`.
+ * @return 1 se uma linha foi devolvida, 0 no fim do texto.
+ */
+int proxima_linha(LEITOR_LINHAS* leitor, const char** linha, size_t* tamanho) {
+        if (leitor->atual == NULL || leitor->atual >= leitor->fim) return 0;
+
+        const char* inicio = leitor->atual;
+        const char* quebra = buscar_quebra(inicio, leitor->fim);
+        const char* fim_linha = quebra ? quebra : leitor->fim;
+
+        *linha = inicio;
+        *tamanho = (size_t)(fim_linha - inicio);
+        leitor->atual = quebra ? quebra + 1 : leitor->fim;
+        leitor->numero_linha++;
+        return 1;
+}
+
+/**
+ * @brief Espaço em branco no sentido de isspace() no locale "C", sem consultar o locale.
+ */
+static inline int eh_espaco(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * @brief Remove os espaços nas pontas do campo, só ajustando início e tamanho.
+ */
+static void aparar_campo(CAMPO* campo) {
+        // Quase nenhum campo começa com espaço: só nesse caso vale chamar a varredura.
+        if (campo->tamanho > 0 && eh_espaco(*campo->inicio)) {
+                const char* inicio = pular_espacos(campo->inicio, campo->inicio + campo->tamanho);
+                campo->tamanho -= (size_t)(inicio - campo->inicio);
+                campo->inicio = inicio;
+        }
+        while (campo->tamanho > 0 && eh_espaco(campo->inicio[campo->tamanho - 1]))
+                campo->tamanho--;
+}
+
+/**
+ * @brief Copia o campo para um texto do LIVRO, truncando no tamanho do destino.
+ *
+ * @return 1 se o campo coube inteiro, 0 se foi truncado.
+ */
+static int copiar_campo(char* destino, size_t capacidade, const CAMPO* campo) {
+        size_t tamanho = campo->tamanho < capacidade - 1 ? campo->tamanho : capacidade - 1;
+        memcpy(destino, campo->inicio, tamanho);
+        destino[tamanho] = '\0';
+        return tamanho == campo->tamanho;
+}
+
+/**
+ * @brief Interpreta uma linha do arquivo texto, sem modificá-la.
+ *
+ * @param linha Primeiro byte da linha (não precisa de terminador nulo).
+ * @param tamanho Bytes da linha.
+ * @param[out] livro Livro preenchido.
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO se faltar algum campo ou um campo numérico for
+ *         inválido, ou ERRO_CAMPO_TRUNCADO se um campo de texto não couber.
+ */
+int interpretar_livro(const char* linha, size_t tamanho, LIVRO* livro) {
+        memset(livro, 0, sizeof(LIVRO));
+
+        // Um separador entre cada par de campos e, se houver, o que encerra o preço.
+        const char* separadores[CAMPOS_LIVRO];
+        const char* fim = linha + tamanho;
+        size_t quantidade = buscar_separadores(linha, fim, separadores, CAMPOS_LIVRO);
+        if (quantidade < CAMPOS_LIVRO - 1) return ERRO_LIVRO_INVALIDO;
+
+        CAMPO campos[CAMPOS_LIVRO];
+        const char* inicio = linha;
+        for (size_t i = 0; i < CAMPOS_LIVRO; i++) {
+                const char* fim_campo = i < quantidade ? separadores[i] : fim;
+                campos[i].inicio = inicio;
+                campos[i].tamanho = (size_t)(fim_campo - inicio);
+                aparar_campo(&campos[i]);
+                inicio = fim_campo + 1;
+        }
+
+        if (!converter_size_t(campos[0].inicio, campos[0].tamanho, &livro->codigo) ||
+            !converter_size_t(campos[4].inicio, campos[4].tamanho, &livro->edicao) ||
+            !converter_size_t(campos[5].inicio, campos[5].tamanho, &livro->ano) ||
+            !converter_size_t(campos[6].inicio, campos[6].tamanho, &livro->exemplares) ||
+            !converter_preco(campos[7].inicio, campos[7].tamanho, &livro->preco))
+                return ERRO_LIVRO_INVALIDO;
+
+        int inteiros = copiar_campo(livro->titulo, sizeof(livro->titulo), &campos[1]);
+        inteiros &= copiar_campo(livro->autor, sizeof(livro->autor), &campos[2]);
+        inteiros &= copiar_campo(livro->editora, sizeof(livro->editora), &campos[3]);
+
+        return inteiros ? SUCESSO : ERRO_CAMPO_TRUNCADO;
+}
+
+/**
+ * @brief Verifica se a linha só tem espaços.
+ */
+static int linha_em_branco(const char* linha, size_t tamanho) {
+        return pular_espacos(linha, linha + tamanho) == linha + tamanho;
+}
+
+/**
+ * @brief Motivo de rejeição correspondente ao status de interpretar_livro() ou da gravação.
+ */
+MOTIVO_REJEICAO motivo_rejeicao(int status) {
+        switch (status) {
+                case ERRO_CODIGO_DUPLICADO:
+                        return REJEICAO_REPETIDO;
+                case ERRO_LIVRO_INVALIDO:
+                        return REJEICAO_FORMATO;
+                case ERRO_CAMPO_TRUNCADO:
+                        return REJEICAO_TRUNCADO;
+                default:
+                        return REJEICAO_GRAVACAO;
+        }
+}
+
+/**
+ * @brief Nome curto do motivo ("repetido", "formato", "truncado" ou "gravacao").
+ */
+const char* nome_motivo_rejeicao(MOTIVO_REJEICAO motivo) {
+        static const char* const nomes[QUANTIDADE_MOTIVOS] = {"repetido", "formato", "truncado",
+                                                              "gravacao"};
+        return (unsigned)motivo < QUANTIDADE_MOTIVOS ? nomes[motivo] : "?";
+}
+
+/**
+ * @brief Acrescenta uma linha rejeitada à lista.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+int adicionar_rejeitada(LISTA_REJEITADAS* lista, const char* linha, size_t tamanho,
+                        MOTIVO_REJEICAO motivo) {
+        if (lista->quantidade == lista->capacidade) {
+                size_t nova = lista->capacidade ? lista->capacidade * 2 : 64;
+                LINHA_REJEITADA* maior = realloc(lista->itens, nova * sizeof(LINHA_REJEITADA));
+                if (maior == NULL) return ERRO_MEMORIA;
+                lista->itens = maior;
+                lista->capacidade = nova;
+        }
+
+        LINHA_REJEITADA* item = &lista->itens[lista->quantidade++];
+        item->linha = linha;
+        item->tamanho = tamanho;
+        item->motivo = motivo;
+        return SUCESSO;
+}
+
+/**
+ * @brief Preenche `rejeitados` e `por_motivo` do relatório a partir da lista.
+ */
+void contabilizar_rejeitadas(const LISTA_REJEITADAS* lista, RELATORIO_IMPORTACAO* relatorio) {
+        memset(relatorio->por_motivo, 0, sizeof(relatorio->por_motivo));
+        for (size_t i = 0; i < lista->quantidade; i++)
+                relatorio->por_motivo[lista->itens[i].motivo]++;
+        relatorio->rejeitados = lista->quantidade;
+}
+
+/**
+ * @brief Ordena as linhas rejeitadas pela posição no texto.
+ */
+static int comparar_rejeitadas(const void* a, const void* b) {
+        const LINHA_REJEITADA* x = a;
+        const LINHA_REJEITADA* y = b;
+        return (x->linha > y->linha) - (x->linha < y->linha);
+}
+
+/**
+ * @brief Grava as linhas rejeitadas, com o número de cada uma, num único fluxo bufferizado.
+ *
+ * @param caminho Caminho do arquivo de rejeitadas (sobrescrito).
+ * @param texto Texto de onde as linhas vieram.
+ * @param lista Linhas rejeitadas; é reordenada.
+ * @return SUCESSO, ERRO_ARQUIVO_TEXTO se o arquivo não puder ser criado, ERRO_ARQUIVO_WRITE ou
+ *         ERRO_MEMORIA.
+ */
+int gravar_rejeitadas(const char* caminho, const TEXTO_MAPEADO* texto, LISTA_REJEITADAS* lista) {
+        if (lista->quantidade == 0) return SUCESSO;
+
+        char* buffer = malloc(BUFFER_REJEITADAS);
+        if (buffer == NULL) return ERRO_MEMORIA;
+
+        FILE* saida = fopen(caminho, "w");
+        if (saida == NULL) {
+                free(buffer);
+                return ERRO_ARQUIVO_TEXTO;
+        }
+        setvbuf(saida, buffer, _IOFBF, BUFFER_REJEITADAS);
+
+        // Em ordem de posição, basta contar as quebras entre uma linha rejeitada e a seguinte.
+        qsort(lista->itens, lista->quantidade, sizeof(LINHA_REJEITADA), comparar_rejeitadas);
+        const char* cursor = texto->dados;
+        size_t numero = 1;
+
+        for (size_t i = 0; i < lista->quantidade; i++) {
+                const LINHA_REJEITADA* item = &lista->itens[i];
+                const char* quebra;
+                while ((quebra = buscar_quebra(cursor, item->linha)) != NULL) {
+                        numero++;
+                        cursor = quebra + 1;
+                }
+                cursor = item->linha;
+
+                fprintf(saida, "%zu\t%s\t", numero, nome_motivo_rejeicao(item->motivo));
+                fwrite(item->linha, 1, item->tamanho, saida);
+                fputc('\n', saida);
+        }
+
+        int status = ferror(saida) ? ERRO_ARQUIVO_WRITE : SUCESSO;
+        if (fclose(saida) != 0) status = ERRO_ARQUIVO_WRITE;
+        free(buffer);
+        return status;
+}
+
+/**
+ * @brief Libera os itens da lista e a deixa vazia.
+ */
+void liberar_rejeitadas(LISTA_REJEITADAS* lista) {
+        free(lista->itens);
+        lista->itens = NULL;
+        lista->quantidade = 0;
+        lista->capacidade = 0;
+}
+
+/**
+ * @brief Imprime as rejeições por motivo, numa linha.
+ */
+void imprimir_rejeicoes(FILE* saida, const RELATORIO_IMPORTACAO* relatorio) {
+        fprintf(saida, "  rejeitados:");
+        for (int motivo = 0; motivo < QUANTIDADE_MOTIVOS; motivo++)
+                fprintf(saida, "%s %zu %s", motivo ? "," : "", relatorio->por_motivo[motivo],
+                        nome_motivo_rejeicao((MOTIVO_REJEICAO)motivo));
+        fprintf(saida, "\n");
+}
+
+/**
+ * @brief Percorre as linhas do texto; grava os livros com `cadastrar`, se informado.
+ */
+static int processar_texto(const char* caminho, FILE* arquivo, CADASTRO_LIVRO cadastrar,
+                           const char* rejeitadas, RELATORIO_IMPORTACAO* relatorio) {
+        RELATORIO_IMPORTACAO local = {0};
+        LISTA_REJEITADAS lista = {0};
+        double inicio = agora();
+
+        TEXTO_MAPEADO texto;
+        int status = mapear_texto(caminho, &texto);
+        if (status != SUCESSO) return status;
+
+        LEITOR_LINHAS leitor;
+        iniciar_leitor_linhas(&leitor, texto.dados, texto.tamanho);
+
+        const char* linha;
+        size_t tamanho;
+        while (status == SUCESSO && proxima_linha(&leitor, &linha, &tamanho)) {
+                if (linha_em_branco(linha, tamanho)) continue;
+                local.linhas++;
+
+                LIVRO livro;
+                int resultado = interpretar_livro(linha, tamanho, &livro);
+                if (resultado == SUCESSO && cadastrar != NULL)
+                        resultado = cadastrar(arquivo, livro);
+
+                if (resultado == SUCESSO)
+                        local.cadastrados++;
+                else
+                        status = adicionar_rejeitada(&lista, linha, tamanho,
+                                                     motivo_rejeicao(resultado));
+        }
+
+        contabilizar_rejeitadas(&lista, &local);
+        if (status == SUCESSO && rejeitadas != NULL)
+                status = gravar_rejeitadas(rejeitadas, &texto, &lista);
+
+        local.bytes = texto.tamanho;
+        liberar_rejeitadas(&lista);
+        liberar_texto(&texto);
+
+        local.segundos = agora() - inicio;
+        if (relatorio) *relatorio = local;
+        return status;
+}
+
+/**
+ * @brief Importa todas as linhas do arquivo texto.
+ *
+ * @param caminho Caminho do arquivo texto.
+ * @param arquivo Arquivo binário de livros, repassado a `cadastrar`.
+ * @param cadastrar Função que grava cada livro.
+ * @param rejeitadas Caminho do arquivo de linhas rejeitadas (NULL para não gravá-lo).
+ * @param[out] relatorio Contadores da importação (opcional).
+ * @return SUCESSO, os erros de mapear_texto(), ERRO_MEMORIA ou os de gravar_rejeitadas().
+ */
+int importar_texto(const char* caminho, FILE* arquivo, CADASTRO_LIVRO cadastrar,
+                   const char* rejeitadas, RELATORIO_IMPORTACAO* relatorio) {
+        if (arquivo == NULL || cadastrar == NULL) return ERRO_ARQUIVO_NULO;
+        return processar_texto(caminho, arquivo, cadastrar, rejeitadas, relatorio);
+}
+
+/**
+ * @brief Interpreta todas as linhas do arquivo texto sem gravar nada.
+ *
+ * @return SUCESSO, ou os erros de mapear_texto().
+ */
+int analisar_texto(const char* caminho, RELATORIO_IMPORTACAO* relatorio) {
+        return processar_texto(caminho, NULL, NULL, NULL, relatorio);
+}
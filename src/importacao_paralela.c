@@ -0,0 +1,591 @@
+/**
+ * @file importacao_paralela.c
+ * @brief Implementa a importação do arquivo texto em pipeline.
+ */
+
+#include "../include/importacao_paralela.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/utils.h"
+#include "../include/varredura.h"
+#include "../include/versoes.h"
+
+/** Menor parte entregue a uma thread; arquivos pequenos usam menos threads. */
+#define TAMANHO_MINIMO_PARTE (1 << 20)
+
+/** Registros que cada cursor da intercalação lê de uma corrida por vez. */
+#define REGISTROS_POR_LEITURA 16
+
+/**
+ * Chave de ordenação de um livro dentro da sua corrida.
+ */
+typedef struct {
+        size_t codigo; /**< Código do livro. */
+        size_t indice; /**< Posição do livro na corrida (ordem do arquivo). */
+} CHAVE_LOTE;
+
+/**
+ * Livro interpretado e a linha de onde veio, para o caso de ele ser rejeitado depois.
+ *
+ * Os registros vão para arquivos temporários deste processo; `linha` continua válida porque o
+ * texto fica mapeado até o fim da importação.
+ */
+typedef struct {
+        LIVRO livro;       /**< Livro interpretado. */
+        const char* linha; /**< Linha de origem, dentro do texto mapeado. */
+        size_t tamanho;    /**< Bytes da linha. */
+} REGISTRO_IMPORTADO;
+
+/**
+ * Corrida: registros ordenados por código, contíguos no temporário do lote.
+ */
+typedef struct {
+        size_t inicio;     /**< Primeiro registro da corrida no temporário. */
+        size_t quantidade; /**< Registros na corrida. */
+} CORRIDA;
+
+/**
+ * Parte do texto e as corridas ordenadas que ela produziu.
+ */
+typedef struct {
+        const char* inicio;          /**< Primeiro byte da parte. */
+        const char* fim;             /**< Fim da parte (logo após um `\n`, ou fim do texto). */
+        FILE* temporario;            /**< Registros das corridas, uma após a outra. */
+        CORRIDA* corridas;           /**< Corridas, na ordem do arquivo. */
+        size_t quantidade_corridas;  /**< Corridas em `corridas`. */
+        size_t capacidade_corridas;  /**< Espaço alocado em `corridas`. */
+        size_t quantidade;           /**< Livros interpretados na parte. */
+        size_t linhas;               /**< Linhas não vazias da parte. */
+        LISTA_REJEITADAS rejeitadas; /**< Linhas mal formadas ou com campos truncados. */
+        int status;                  /**< SUCESSO, ERRO_MEMORIA ou ERRO_ARQUIVO_WRITE. */
+} LOTE_IMPORTACAO;
+
+/**
+ * Cursor de uma corrida na intercalação.
+ */
+typedef struct {
+        int descritor;                 /**< Descritor do temporário do lote. */
+        size_t ordem;                  /**< Ordem da corrida no texto (desempata códigos). */
+        size_t proximo;                /**< Próximo registro a ler do temporário. */
+        size_t fim;                    /**< Registro logo após o último da corrida. */
+        REGISTRO_IMPORTADO* registros; /**< Até REGISTROS_POR_LEITURA registros lidos. */
+        size_t lidos;                  /**< Registros em `registros`. */
+        size_t posicao;                /**< Registro atual em `registros`. */
+        size_t codigo;                 /**< Código do registro atual. */
+} CURSOR_CORRIDA;
+
+/**
+ * @brief Ordena por código; códigos iguais ficam na ordem do arquivo.
+ */
+static int comparar_chaves(const void* a, const void* b) {
+        const CHAVE_LOTE* x = a;
+        const CHAVE_LOTE* y = b;
+        if (x->codigo != y->codigo) return x->codigo < y->codigo ? -1 : 1;
+        return x->indice < y->indice ? -1 : x->indice > y->indice;
+}
+
+/**
+ * @brief Ordena os livros pendentes e grava-os como uma corrida no temporário do lote.
+ *
+ * @return SUCESSO, ERRO_MEMORIA ou ERRO_ARQUIVO_WRITE.
+ */
+static int gravar_corrida(LOTE_IMPORTACAO* lote, const REGISTRO_IMPORTADO* registros,
+                          CHAVE_LOTE* chaves, size_t quantidade) {
+        if (lote->quantidade_corridas == lote->capacidade_corridas) {
+                size_t capacidade = lote->capacidade_corridas ? lote->capacidade_corridas * 2 : 8;
+                CORRIDA* maior = realloc(lote->corridas, capacidade * sizeof(CORRIDA));
+                if (maior == NULL) return ERRO_MEMORIA;
+                lote->corridas = maior;
+                lote->capacidade_corridas = capacidade;
+        }
+
+        for (size_t i = 0; i < quantidade; i++) {
+                chaves[i].codigo = registros[i].livro.codigo;
+                chaves[i].indice = i;
+        }
+        qsort(chaves, quantidade, sizeof(CHAVE_LOTE), comparar_chaves);
+
+        for (size_t i = 0; i < quantidade; i++)
+                if (fwrite(&registros[chaves[i].indice], sizeof(REGISTRO_IMPORTADO), 1,
+                           lote->temporario) != 1)
+                        return ERRO_ARQUIVO_WRITE;
+
+        lote->corridas[lote->quantidade_corridas++] = (CORRIDA){lote->quantidade, quantidade};
+        lote->quantidade += quantidade;
+        return SUCESSO;
+}
+
+/**
+ * @brief Thread de interpretação: lê as linhas da parte e grava-as em corridas ordenadas de até
+ * REGISTROS_POR_CORRIDA livros.
+ */
+static void* interpretar_parte(void* argumento) {
+        LOTE_IMPORTACAO* lote = argumento;
+        REGISTRO_IMPORTADO* registros = malloc(REGISTROS_POR_CORRIDA * sizeof(REGISTRO_IMPORTADO));
+        CHAVE_LOTE* chaves = malloc(REGISTROS_POR_CORRIDA * sizeof(CHAVE_LOTE));
+        lote->temporario = tmpfile();
+        if (registros == NULL || chaves == NULL)
+                lote->status = ERRO_MEMORIA;
+        else if (lote->temporario == NULL)
+                lote->status = ERRO_ARQUIVO_WRITE;
+
+        LEITOR_LINHAS leitor;
+        iniciar_leitor_linhas(&leitor, lote->inicio, (size_t)(lote->fim - lote->inicio));
+
+        const char* linha;
+        size_t tamanho;
+        size_t pendentes = 0;
+        while (lote->status == SUCESSO && proxima_linha(&leitor, &linha, &tamanho)) {
+                if (pular_espacos(linha, linha + tamanho) == linha + tamanho) continue;
+                lote->linhas++;
+
+                REGISTRO_IMPORTADO* registro = &registros[pendentes];
+                int resultado = interpretar_livro(linha, tamanho, &registro->livro);
+                if (resultado == SUCESSO) {
+                        registro->linha = linha;
+                        registro->tamanho = tamanho;
+                        if (++pendentes == REGISTROS_POR_CORRIDA) {
+                                lote->status = gravar_corrida(lote, registros, chaves, pendentes);
+                                pendentes = 0;
+                        }
+                } else {
+                        lote->status = adicionar_rejeitada(&lote->rejeitadas, linha, tamanho,
+                                                           motivo_rejeicao(resultado));
+                }
+        }
+
+        if (lote->status == SUCESSO && pendentes > 0)
+                lote->status = gravar_corrida(lote, registros, chaves, pendentes);
+        if (lote->status == SUCESSO && fflush(lote->temporario) != 0)
+                lote->status = ERRO_ARQUIVO_WRITE;
+
+        free(registros);
+        free(chaves);
+        return NULL;
+}
+
+/**
+ * @brief Divide o texto em até `threads` partes, cortando logo após um `\n`.
+ *
+ * @return Quantidade de partes.
+ */
+static int dividir_texto(const TEXTO_MAPEADO* texto, int threads, LOTE_IMPORTACAO* lotes) {
+        size_t partes = (size_t)threads;
+        if (texto->tamanho / TAMANHO_MINIMO_PARTE + 1 < partes)
+                partes = texto->tamanho / TAMANHO_MINIMO_PARTE + 1;
+
+        const char* fim = texto->dados + texto->tamanho;
+        const char* inicio = texto->dados;
+        int quantidade = 0;
+
+        for (size_t i = 0; i < partes && inicio < fim; i++) {
+                const char* corte = fim;
+                if (i + 1 < partes) {
+                        const char* alvo = texto->dados + texto->tamanho / partes * (i + 1);
+                        if (alvo < inicio) alvo = inicio;
+                        const char* quebra = buscar_quebra(alvo, fim);
+                        corte = quebra ? quebra + 1 : fim;
+                }
+
+                memset(&lotes[quantidade], 0, sizeof(LOTE_IMPORTACAO));
+                lotes[quantidade].inicio = inicio;
+                lotes[quantidade].fim = corte;
+                quantidade++;
+                inicio = corte;
+        }
+
+        return quantidade;
+}
+
+/**
+ * @brief Lê do temporário os próximos registros da corrida do cursor.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_READ.
+ */
+static int encher_cursor(CURSOR_CORRIDA* cursor) {
+        size_t quantidade = cursor->fim - cursor->proximo;
+        if (quantidade > REGISTROS_POR_LEITURA) quantidade = REGISTROS_POR_LEITURA;
+
+        size_t bytes = quantidade * sizeof(REGISTRO_IMPORTADO);
+        off_t deslocamento = (off_t)(cursor->proximo * sizeof(REGISTRO_IMPORTADO));
+        if (pread(cursor->descritor, cursor->registros, bytes, deslocamento) != (ssize_t)bytes)
+                return ERRO_ARQUIVO_READ;
+
+        cursor->proximo += quantidade;
+        cursor->lidos = quantidade;
+        cursor->posicao = 0;
+        cursor->codigo = cursor->registros[0].livro.codigo;
+        return SUCESSO;
+}
+
+/**
+ * @brief Verifica se o cursor `a` vem antes de `b` na intercalação.
+ */
+static int cursor_menor(const CURSOR_CORRIDA* a, const CURSOR_CORRIDA* b) {
+        if (a->codigo != b->codigo) return a->codigo < b->codigo;
+        return a->ordem < b->ordem;
+}
+
+/**
+ * @brief Desce o cursor da posição `i` até restaurar o heap de mínimo.
+ */
+static void descer_cursor(CURSOR_CORRIDA* heap, size_t tamanho, size_t i) {
+        for (;;) {
+                size_t menor = i;
+                size_t esquerdo = 2 * i + 1;
+                size_t direito = 2 * i + 2;
+                if (esquerdo < tamanho && cursor_menor(&heap[esquerdo], &heap[menor]))
+                        menor = esquerdo;
+                if (direito < tamanho && cursor_menor(&heap[direito], &heap[menor]))
+                        menor = direito;
+                if (menor == i) return;
+
+                CURSOR_CORRIDA troca = heap[i];
+                heap[i] = heap[menor];
+                heap[menor] = troca;
+                i = menor;
+        }
+}
+
+/**
+ * @brief Intercala as corridas de todos os lotes em `intercalados`, sem códigos repetidos.
+ *
+ * Entre livros de mesmo código, fica o que aparece primeiro no arquivo; os demais vão para
+ * `rejeitadas`. Cada corrida ocupa só REGISTROS_POR_LEITURA registros em memória.
+ *
+ * @param[out] gravados Quantidade de livros em `intercalados`.
+ * @return SUCESSO, ERRO_MEMORIA, ERRO_ARQUIVO_READ ou ERRO_ARQUIVO_WRITE.
+ */
+static int intercalar_lotes(const LOTE_IMPORTACAO* lotes, int quantidade_lotes,
+                            FILE* intercalados, size_t* gravados, LISTA_REJEITADAS* rejeitadas) {
+        size_t total = 0;
+        for (int i = 0; i < quantidade_lotes; i++) total += lotes[i].quantidade_corridas;
+
+        *gravados = 0;
+        if (total == 0) return SUCESSO;
+
+        CURSOR_CORRIDA* heap = malloc(total * sizeof(CURSOR_CORRIDA));
+        REGISTRO_IMPORTADO* memoria =
+                malloc(total * REGISTROS_POR_LEITURA * sizeof(REGISTRO_IMPORTADO));
+        if (heap == NULL || memoria == NULL) {
+                free(heap);
+                free(memoria);
+                return ERRO_MEMORIA;
+        }
+
+        // As corridas são numeradas na ordem do texto: lote a lote, e dentro do lote, em ordem.
+        int status = SUCESSO;
+        size_t tamanho = 0;
+        for (int i = 0; status == SUCESSO && i < quantidade_lotes; i++) {
+                for (size_t j = 0; status == SUCESSO && j < lotes[i].quantidade_corridas; j++) {
+                        const CORRIDA* corrida = &lotes[i].corridas[j];
+                        CURSOR_CORRIDA* cursor = &heap[tamanho];
+                        cursor->descritor = fileno(lotes[i].temporario);
+                        cursor->ordem = tamanho;
+                        cursor->proximo = corrida->inicio;
+                        cursor->fim = corrida->inicio + corrida->quantidade;
+                        cursor->registros = &memoria[tamanho * REGISTROS_POR_LEITURA];
+                        status = encher_cursor(cursor);
+                        tamanho++;
+                }
+        }
+        for (size_t i = tamanho; i-- > 0;) descer_cursor(heap, tamanho, i);
+
+        size_t ultimo = 0;
+        while (status == SUCESSO && tamanho > 0) {
+                CURSOR_CORRIDA* topo = &heap[0];
+                const REGISTRO_IMPORTADO* registro = &topo->registros[topo->posicao];
+
+                if (*gravados > 0 && ultimo == registro->livro.codigo) {
+                        status = adicionar_rejeitada(rejeitadas, registro->linha,
+                                                     registro->tamanho, REJEICAO_REPETIDO);
+                } else if (fwrite(registro, sizeof(REGISTRO_IMPORTADO), 1, intercalados) != 1) {
+                        status = ERRO_ARQUIVO_WRITE;
+                } else {
+                        ultimo = registro->livro.codigo;
+                        (*gravados)++;
+                }
+                if (status != SUCESSO) break;
+
+                if (++topo->posicao < topo->lidos)
+                        topo->codigo = topo->registros[topo->posicao].livro.codigo;
+                else if (topo->proximo < topo->fim)
+                        status = encher_cursor(topo);
+                else
+                        heap[0] = heap[--tamanho];
+                descer_cursor(heap, tamanho, 0);
+        }
+
+        free(heap);
+        free(memoria);
+        if (status == SUCESSO && fflush(intercalados) != 0) status = ERRO_ARQUIVO_WRITE;
+        return status;
+}
+
+/**
+ * @brief Lê o registro `indice` do temporário dos livros intercalados.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_READ.
+ */
+static int ler_intercalado(FILE* intercalados, size_t indice, REGISTRO_IMPORTADO* registro) {
+        off_t deslocamento = (off_t)(indice * sizeof(REGISTRO_IMPORTADO));
+        ssize_t lidos = pread(fileno(intercalados), registro, sizeof(REGISTRO_IMPORTADO),
+                              deslocamento);
+        return lidos == (ssize_t)sizeof(REGISTRO_IMPORTADO) ? SUCESSO : ERRO_ARQUIVO_READ;
+}
+
+/**
+ * @brief Entrega o próximo livro intercalado a construir_arvore_em_bloco().
+ *
+ * O temporário é lido em sequência pelo buffer do `FILE*`, posicionado no início.
+ */
+static int proximo_ordenado(void* contexto, LIVRO* livro) {
+        REGISTRO_IMPORTADO registro;
+        if (fread(&registro, sizeof(registro), 1, (FILE*)contexto) != 1) return ERRO_ARQUIVO_READ;
+        *livro = registro.livro;
+        return SUCESSO;
+}
+
+/**
+ * Estado das inserções por níveis.
+ */
+typedef struct {
+        FILE* arquivo;                /**< Arquivo binário de livros. */
+        FILE* intercalados;           /**< Livros em ordem de código. */
+        LISTA_REJEITADAS* rejeitadas; /**< Recebe os livros recusados. */
+        size_t inseridos;             /**< Livros inseridos até agora. */
+} INSERCAO_NIVEIS;
+
+/**
+ * @brief Insere, da esquerda para a direita, os meios dos intervalos que estão `nivel` níveis
+ * abaixo de [inicio, fim) na árvore balanceada dos livros intercalados.
+ *
+ * @return SUCESSO, ERRO_MEMORIA ou ERRO_ARQUIVO_READ.
+ */
+static int inserir_nivel(INSERCAO_NIVEIS* insercao, size_t inicio, size_t fim, int nivel) {
+        if (inicio >= fim) return SUCESSO;
+        size_t meio = inicio + (fim - inicio) / 2;
+
+        if (nivel > 0) {
+                int status = inserir_nivel(insercao, inicio, meio, nivel - 1);
+                if (status != SUCESSO) return status;
+                return inserir_nivel(insercao, meio + 1, fim, nivel - 1);
+        }
+
+        REGISTRO_IMPORTADO registro;
+        int status = ler_intercalado(insercao->intercalados, meio, &registro);
+        if (status != SUCESSO) return status;
+
+        NO_ARVORE no;
+        no.livro = registro.livro;
+        no.filho_esquerdo = POSICAO_INVALIDA;
+        no.filho_direito = POSICAO_INVALIDA;
+
+        int resultado = modo_cow_ativo() ? inserir_no_arvore_cow(insercao->arquivo, &no)
+                                         : inserir_no_arvore(insercao->arquivo, &no);
+        if (resultado == SUCESSO) {
+                insercao->inseridos++;
+                return SUCESSO;
+        }
+        return adicionar_rejeitada(insercao->rejeitadas, registro.linha, registro.tamanho,
+                                   motivo_rejeicao(resultado));
+}
+
+/**
+ * @brief Insere os livros intercalados um a um, na ordem por níveis da árvore balanceada deles.
+ *
+ * Inserir em ordem crescente transformaria os novos nós numa lista; começando pela mediana e
+ * seguindo por níveis, eles formam uma subárvore balanceada entre si. Cada nível é refeito
+ * descendo a partir da raiz, o que mantém a memória em O(log n) em vez de uma fila por nível.
+ *
+ * @param[out] rejeitadas Recebe os livros recusados (código já cadastrado ou erro de gravação).
+ * @param[out] status SUCESSO, ERRO_MEMORIA ou ERRO_ARQUIVO_READ.
+ * @return Livros inseridos.
+ */
+static size_t inserir_em_ordem_balanceada(FILE* arquivo, FILE* intercalados, size_t quantidade,
+                                          LISTA_REJEITADAS* rejeitadas, int* status) {
+        INSERCAO_NIVEIS insercao = {arquivo, intercalados, rejeitadas, 0};
+
+        // A árvore balanceada de n livros tem tantos níveis quantos bits há em n.
+        int niveis = 0;
+        for (size_t resto = quantidade; resto > 0; resto >>= 1) niveis++;
+
+        *status = SUCESSO;
+        for (int nivel = 0; *status == SUCESSO && nivel < niveis; nivel++)
+                *status = inserir_nivel(&insercao, 0, quantidade, nivel);
+        return insercao.inseridos;
+}
+
+/**
+ * @brief Quantidade de threads a usar quando o chamador não informa.
+ */
+static int threads_padrao(void) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        return cpus > 0 ? (int)cpus : 1;
+}
+
+/**
+ * @brief Etapa de gravação: escolhe entre construção em bloco e inserções.
+ */
+static int gravar_ordenados(FILE* arquivo, FILE* intercalados, size_t quantidade,
+                            LISTA_REJEITADAS* rejeitadas, RELATORIO_PIPELINE* local) {
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+
+        int status = SUCESSO;
+        if (cabecalho->raiz == POSICAO_INVALIDA) {
+                local->construcao_em_bloco = 1;
+                rewind(intercalados);
+                status = construir_arvore_em_bloco(arquivo, quantidade, proximo_ordenado,
+                                                   intercalados);
+                if (status == SUCESSO) {
+                        local->totais.cadastrados = quantidade;
+                } else {
+                        // Nada ficou visível: todos os livros contam como erro de gravação.
+                        REGISTRO_IMPORTADO registro;
+                        for (size_t i = 0; i < quantidade; i++)
+                                if (ler_intercalado(intercalados, i, &registro) != SUCESSO ||
+                                    adicionar_rejeitada(rejeitadas, registro.linha,
+                                                        registro.tamanho,
+                                                        REJEICAO_GRAVACAO) != SUCESSO)
+                                        break;
+                }
+        } else {
+                local->totais.cadastrados = inserir_em_ordem_balanceada(arquivo, intercalados,
+                                                                        quantidade, rejeitadas,
+                                                                        &status);
+        }
+
+        free(cabecalho);
+        return status;
+}
+
+/**
+ * @brief Importa o arquivo texto com o pipeline paralelo.
+ *
+ * @param caminho Caminho do arquivo texto.
+ * @param arquivo Arquivo binário de livros.
+ * @param threads Threads de interpretação (0 usa uma por CPU).
+ * @param rejeitadas Caminho do arquivo de linhas rejeitadas (NULL para não gravá-lo).
+ * @param[out] relatorio Contadores e tempos por etapa (opcional).
+ * @return SUCESSO, ERRO_MEMORIA, os erros de mapear_texto(), erros de leitura e gravação (dos
+ *         temporários ou do arquivo de livros) ou os de gravar_rejeitadas().
+ */
+int importar_texto_paralelo(const char* caminho, FILE* arquivo, int threads,
+                            const char* rejeitadas, RELATORIO_PIPELINE* relatorio) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (threads <= 0) threads = threads_padrao();
+        if (threads > MAXIMO_THREADS_IMPORTACAO) threads = MAXIMO_THREADS_IMPORTACAO;
+
+        RELATORIO_PIPELINE local;
+        memset(&local, 0, sizeof(local));
+        double inicio = agora();
+
+        TEXTO_MAPEADO texto;
+        int status = mapear_texto(caminho, &texto);
+        if (status != SUCESSO) return status;
+        local.totais.bytes = texto.tamanho;
+
+        // Etapa 1 e 2: divisão e interpretação paralela, em corridas ordenadas no disco.
+        LOTE_IMPORTACAO lotes[MAXIMO_THREADS_IMPORTACAO];
+        int quantidade_lotes = dividir_texto(&texto, threads, lotes);
+        pthread_t ids[MAXIMO_THREADS_IMPORTACAO];
+        int iniciadas = 0;
+
+        for (int i = 0; i < quantidade_lotes; i++) {
+                // A thread atual interpreta a última parte, ou todas, se a criação falhar.
+                if (i == quantidade_lotes - 1 ||
+                    pthread_create(&ids[i], NULL, interpretar_parte, &lotes[i]) != 0)
+                        break;
+                iniciadas++;
+        }
+        for (int i = iniciadas; i < quantidade_lotes; i++) interpretar_parte(&lotes[i]);
+        for (int i = 0; i < iniciadas; i++) pthread_join(ids[i], NULL);
+
+        // As rejeitadas de todas as etapas vão para uma lista só, ordenada ao gravar.
+        LISTA_REJEITADAS lista = {0};
+        size_t total = 0;
+        for (int i = 0; i < quantidade_lotes; i++) {
+                if (lotes[i].status != SUCESSO) status = lotes[i].status;
+                local.totais.linhas += lotes[i].linhas;
+                total += lotes[i].quantidade;
+                for (size_t j = 0; status == SUCESSO && j < lotes[i].rejeitadas.quantidade; j++) {
+                        const LINHA_REJEITADA* item = &lotes[i].rejeitadas.itens[j];
+                        status = adicionar_rejeitada(&lista, item->linha, item->tamanho,
+                                                     item->motivo);
+                }
+        }
+        local.threads = quantidade_lotes > 0 ? quantidade_lotes : 1;
+        double fim_analise = agora();
+        local.segundos_analise = fim_analise - inicio;
+
+        // Etapa 3: intercalação das corridas num temporário, já sem repetidos.
+        FILE* intercalados = NULL;
+        size_t quantidade = 0;
+        if (status == SUCESSO && total > 0) {
+                intercalados = tmpfile();
+                if (intercalados == NULL)
+                        status = ERRO_ARQUIVO_WRITE;
+                else
+                        status = intercalar_lotes(lotes, quantidade_lotes, intercalados,
+                                                  &quantidade, &lista);
+        }
+        double fim_intercalacao = agora();
+        local.segundos_intercalacao = fim_intercalacao - fim_analise;
+
+        // Etapa 4: gravação.
+        if (status == SUCESSO && quantidade > 0)
+                status = gravar_ordenados(arquivo, intercalados, quantidade, &lista, &local);
+        local.segundos_gravacao = agora() - fim_intercalacao;
+
+        contabilizar_rejeitadas(&lista, &local.totais);
+        if (status == SUCESSO && rejeitadas != NULL)
+                status = gravar_rejeitadas(rejeitadas, &texto, &lista);
+
+        if (intercalados) fclose(intercalados);
+        for (int i = 0; i < quantidade_lotes; i++) {
+                if (lotes[i].temporario) fclose(lotes[i].temporario);
+                free(lotes[i].corridas);
+                liberar_rejeitadas(&lotes[i].rejeitadas);
+        }
+        liberar_rejeitadas(&lista);
+        liberar_texto(&texto);
+
+        local.totais.segundos = agora() - inicio;
+        if (relatorio) *relatorio = local;
+        return status;
+}
+
+/**
+ * @brief Vazão em unidades por segundo, ou 0 se a etapa não levou tempo mensurável.
+ */
+static double vazao(double quantidade, double segundos) {
+        return segundos > 0 ? quantidade / segundos : 0.0;
+}
+
+/**
+ * @brief Imprime os contadores, a vazão de cada etapa e, se houver, as rejeições por motivo.
+ */
+void imprimir_relatorio_pipeline(FILE* saida, const RELATORIO_PIPELINE* relatorio) {
+        const RELATORIO_IMPORTACAO* totais = &relatorio->totais;
+
+        fprintf(saida, "%zu linhas: %zu cadastrados, %zu rejeitados em %.3f s\n", totais->linhas,
+                totais->cadastrados, totais->rejeitados, totais->segundos);
+        fprintf(saida, "  leitura (%d threads): %.3f s, %.1f MB/s\n", relatorio->threads,
+                relatorio->segundos_analise,
+                vazao(totais->bytes / 1e6, relatorio->segundos_analise));
+        fprintf(saida, "  intercalacao: %.3f s, %.0f livros/s\n", relatorio->segundos_intercalacao,
+                vazao((double)totais->linhas, relatorio->segundos_intercalacao));
+        fprintf(saida, "  gravacao (%s): %.3f s, %.0f livros/s\n",
+                relatorio->construcao_em_bloco ? "em bloco" : "insercoes",
+                relatorio->segundos_gravacao,
+                vazao((double)totais->cadastrados, relatorio->segundos_gravacao));
+        if (totais->rejeitados > 0) imprimir_rejeicoes(saida, totais);
+}
@@ -0,0 +1,633 @@
+/**
+ * @file indice.c
+ * @brief Implementa o índice hash extensível de código para posição do nó.
+ */
+
+#include "../include/indice.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/utils.h"
+
+/** Ocupação média dos baldes na reconstrução: metade, para absorver inserções sem dividir. */
+#define ENTRADAS_POR_BALDE_NA_CONSTRUCAO 128
+
+/**
+ * Índice associado a um handle do arquivo de livros.
+ */
+typedef struct INDICE_HASH {
+        FILE* arquivo;               /**< Handle do arquivo de livros. */
+        FILE* paginas;               /**< Arquivo do índice, aberto enquanto associado. */
+        char* caminho;               /**< Caminho do arquivo do índice. */
+        uint32_t* diretorio;         /**< Página do balde de cada prefixo do hash. */
+        unsigned profundidade;       /**< Bits do hash usados pelo diretório. */
+        size_t baldes;               /**< Baldes no arquivo do índice. */
+        size_t entradas;             /**< Códigos no índice. */
+        BALDE_INDICE balde;          /**< Último balde lido. */
+        uint32_t pagina_balde;       /**< Página de `balde` (0: nenhum). */
+        int balde_alterado;          /**< `balde` tem alterações ainda não gravadas. */
+        size_t divisoes;             /**< Baldes divididos desde a abertura. */
+        size_t leituras;             /**< Páginas lidas desde a abertura. */
+        size_t reconstrucoes;        /**< Reconstruções desde a abertura. */
+        int valido;                  /**< Zero se uma gravação ou reconstrução falhou. */
+        struct INDICE_HASH* proximo; /**< Próxima associação. */
+} INDICE_HASH;
+
+/**
+ * Entradas coletadas da árvore para a reconstrução.
+ */
+typedef struct {
+        ENTRADA_INDICE* itens;
+        size_t tamanho;
+        size_t capacidade;
+} COLETA_INDICE;
+
+/// @brief Índices associados a handles abertos.
+static INDICE_HASH* indices = NULL;
+
+/// @brief Protege a lista de índices e os índices nela.
+static pthread_mutex_t mutex_indices = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Índice associado ao handle, ou NULL. Chamar com `mutex_indices` travado.
+ */
+static INDICE_HASH* indice_do_arquivo(FILE* arquivo) {
+        for (INDICE_HASH* indice = indices; indice; indice = indice->proximo)
+                if (indice->arquivo == arquivo) return indice;
+        return NULL;
+}
+
+/**
+ * @brief Posição no diretório do prefixo de `hash`.
+ */
+static size_t prefixo(const INDICE_HASH* indice, uint64_t hash) {
+        return (size_t)(hash & (((uint64_t)1 << indice->profundidade) - 1));
+}
+
+/**
+ * @brief Lê uma página do arquivo do índice.
+ */
+static int ler_pagina(INDICE_HASH* indice, size_t pagina, void* destino) {
+        if (fseek(indice->paginas, (long)(pagina * TAMANHO_PAGINA_INDICE), SEEK_SET) != 0)
+                return ERRO_ARQUIVO_SEEK;
+        if (fread(destino, TAMANHO_PAGINA_INDICE, 1, indice->paginas) != 1)
+                return ERRO_ARQUIVO_READ;
+        indice->leituras++;
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava uma página do arquivo do índice.
+ */
+static int gravar_pagina(INDICE_HASH* indice, size_t pagina, const void* origem) {
+        if (fseek(indice->paginas, (long)(pagina * TAMANHO_PAGINA_INDICE), SEEK_SET) != 0)
+                return ERRO_ARQUIVO_SEEK;
+        if (fwrite(origem, TAMANHO_PAGINA_INDICE, 1, indice->paginas) != 1)
+                return ERRO_ARQUIVO_WRITE;
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava o balde em memória, se alterado.
+ */
+static int descarregar_balde(INDICE_HASH* indice) {
+        if (!indice->balde_alterado) return SUCESSO;
+        int status = gravar_pagina(indice, indice->pagina_balde, &indice->balde);
+        if (status == SUCESSO) indice->balde_alterado = 0;
+        return status;
+}
+
+/**
+ * @brief Deixa em memória o balde responsável por `hash`.
+ */
+static int carregar_balde(INDICE_HASH* indice, uint64_t hash) {
+        uint32_t pagina = indice->diretorio[prefixo(indice, hash)];
+        if (pagina == indice->pagina_balde) return SUCESSO;
+
+        int status = descarregar_balde(indice);
+        if (status != SUCESSO) return status;
+
+        indice->pagina_balde = 0;
+        status = ler_pagina(indice, pagina, &indice->balde);
+        if (status == SUCESSO && (indice->balde.quantidade > ENTRADAS_POR_BALDE_INDICE ||
+                                  indice->balde.profundidade_local > indice->profundidade))
+                status = ERRO_ARQUIVO_READ;
+        if (status == SUCESSO) indice->pagina_balde = pagina;
+        return status;
+}
+
+/**
+ * @brief Entrada do código no balde em memória, ou NULL.
+ */
+static ENTRADA_INDICE* procurar_no_balde(INDICE_HASH* indice, size_t codigo) {
+        for (uint32_t i = 0; i < indice->balde.quantidade; i++)
+                if (indice->balde.entradas[i].codigo == (uint64_t)codigo)
+                        return &indice->balde.entradas[i];
+        return NULL;
+}
+
+/**
+ * @brief Grava o cabeçalho do índice.
+ *
+ * @param limpo Se diferente de zero, grava também a identidade atual do arquivo de livros.
+ */
+static int gravar_cabecalho(INDICE_HASH* indice, int limpo) {
+        union {
+                CABECALHO_INDICE cabecalho;
+                unsigned char pagina[TAMANHO_PAGINA_INDICE];
+        } pagina;
+        memset(&pagina, 0, sizeof(pagina));
+        pagina.cabecalho.magica = MAGICA_INDICE;
+        pagina.cabecalho.versao = VERSAO_INDICE;
+        pagina.cabecalho.profundidade_global = indice->profundidade;
+        pagina.cabecalho.limpo = limpo ? 1u : 0u;
+        pagina.cabecalho.baldes = indice->baldes;
+        pagina.cabecalho.entradas = indice->entradas;
+        if (limpo) {
+                int status = identificar_arquivo(indice->arquivo, &pagina.cabecalho.livros);
+                if (status != SUCESSO) return status;
+        }
+
+        int status = gravar_pagina(indice, 0, &pagina);
+        if (status == SUCESSO && fflush(indice->paginas) != 0) status = ERRO_ARQUIVO_WRITE;
+        return status;
+}
+
+/**
+ * @brief Divide o balde em memória, que está cheio, dobrando o diretório se preciso.
+ *
+ * As entradas cujo hash tem o bit `profundidade_local` ligado vão para um balde novo, gravado
+ * no fim do arquivo; os prefixos do diretório com esse bit passam a apontar para ele.
+ *
+ * @return SUCESSO, ERRO_MEMORIA (diretório no limite ou sem memória) ou erros de arquivo.
+ */
+static int dividir_balde(INDICE_HASH* indice) {
+        BALDE_INDICE* antigo = &indice->balde;
+        if (antigo->profundidade_local == indice->profundidade) {
+                if (indice->profundidade == PROFUNDIDADE_MAXIMA_INDICE) return ERRO_MEMORIA;
+
+                size_t prefixos = (size_t)1 << indice->profundidade;
+                uint32_t* diretorio = realloc(indice->diretorio, 2 * prefixos * sizeof(uint32_t));
+                if (diretorio == NULL) return ERRO_MEMORIA;
+                memcpy(diretorio + prefixos, diretorio, prefixos * sizeof(uint32_t));
+                indice->diretorio = diretorio;
+                indice->profundidade++;
+        }
+
+        BALDE_INDICE* novo = calloc(1, sizeof(BALDE_INDICE));
+        if (novo == NULL) return ERRO_MEMORIA;
+
+        uint64_t bit = (uint64_t)1 << antigo->profundidade_local;
+        uint32_t mantidas = 0;
+        for (uint32_t i = 0; i < antigo->quantidade; i++) {
+                ENTRADA_INDICE entrada = antigo->entradas[i];
+                if (espalhar_codigo((size_t)entrada.codigo) & bit)
+                        novo->entradas[novo->quantidade++] = entrada;
+                else
+                        antigo->entradas[mantidas++] = entrada;
+        }
+        antigo->quantidade = mantidas;
+        antigo->profundidade_local++;
+        novo->profundidade_local = antigo->profundidade_local;
+
+        uint32_t pagina_nova = (uint32_t)(indice->baldes + 1);
+        int status = gravar_pagina(indice, pagina_nova, novo);
+        free(novo);
+        if (status != SUCESSO) return status;
+
+        indice->baldes++;
+        indice->balde_alterado = 1;
+        indice->divisoes++;
+        for (size_t i = 0; i < ((size_t)1 << indice->profundidade); i++)
+                if (indice->diretorio[i] == indice->pagina_balde && (i & bit))
+                        indice->diretorio[i] = pagina_nova;
+        return SUCESSO;
+}
+
+/**
+ * @brief Registra ou atualiza a posição de um código, dividindo baldes cheios.
+ */
+static int inserir_entrada(INDICE_HASH* indice, size_t codigo, int posicao) {
+        uint64_t hash = espalhar_codigo(codigo);
+        for (;;) {
+                int status = carregar_balde(indice, hash);
+                if (status != SUCESSO) return status;
+
+                ENTRADA_INDICE* entrada = procurar_no_balde(indice, codigo);
+                if (entrada) {
+                        entrada->posicao = posicao;
+                        indice->balde_alterado = 1;
+                        return SUCESSO;
+                }
+
+                if (indice->balde.quantidade < ENTRADAS_POR_BALDE_INDICE) {
+                        entrada = &indice->balde.entradas[indice->balde.quantidade++];
+                        entrada->codigo = (uint64_t)codigo;
+                        entrada->posicao = posicao;
+                        indice->balde_alterado = 1;
+                        indice->entradas++;
+                        return SUCESSO;
+                }
+
+                // Um balde dividido pode continuar cheio se todos os hashes coincidirem no bit
+                // usado: a próxima volta divide de novo.
+                status = dividir_balde(indice);
+                if (status != SUCESSO) return status;
+        }
+}
+
+/**
+ * @brief Visitante da reconstrução: acrescenta o código e a posição do nó à coleta.
+ */
+static int coletar_no(const NO_ARVORE* no, int posicao, void* contexto) {
+        COLETA_INDICE* coleta = contexto;
+        if (coleta->tamanho == coleta->capacidade) {
+                size_t capacidade = coleta->capacidade ? coleta->capacidade * 2 : 1024;
+                ENTRADA_INDICE* itens = realloc(coleta->itens, capacidade * sizeof(ENTRADA_INDICE));
+                if (itens == NULL) return ERRO_MEMORIA;
+                coleta->itens = itens;
+                coleta->capacidade = capacidade;
+        }
+        coleta->itens[coleta->tamanho].codigo = (uint64_t)no->livro.codigo;
+        coleta->itens[coleta->tamanho].posicao = posicao;
+        coleta->tamanho++;
+        return SUCESSO;
+}
+
+/**
+ * @brief Distribui as entradas coletadas pelos 2^profundidade prefixos.
+ *
+ * @param[out] inicios Vetor de 2^profundidade + 1 posições: as entradas do prefixo `i` ficam
+ *             em `ordenadas[inicios[i]]` até `ordenadas[inicios[i + 1] - 1]`.
+ * @return 1 se todo prefixo cabe num balde; 0 se algum transborda.
+ */
+static int distribuir(const COLETA_INDICE* coleta, unsigned profundidade, size_t* inicios,
+                      ENTRADA_INDICE* ordenadas) {
+        size_t prefixos = (size_t)1 << profundidade;
+        uint64_t mascara = prefixos - 1;
+        memset(inicios, 0, (prefixos + 1) * sizeof(size_t));
+
+        for (size_t i = 0; i < coleta->tamanho; i++)
+                inicios[(espalhar_codigo((size_t)coleta->itens[i].codigo) & mascara) + 1]++;
+        for (size_t i = 1; i <= prefixos; i++) {
+                if (inicios[i] > ENTRADAS_POR_BALDE_INDICE) return 0;
+                inicios[i] += inicios[i - 1];
+        }
+
+        // O preenchimento avança cada início até o fim do seu prefixo, que é o início do
+        // seguinte; no final os inícios são deslocados de volta.
+        for (size_t i = 0; i < coleta->tamanho; i++) {
+                size_t p = (size_t)(espalhar_codigo((size_t)coleta->itens[i].codigo) & mascara);
+                ordenadas[inicios[p]++] = coleta->itens[i];
+        }
+        memmove(inicios + 1, inicios, prefixos * sizeof(size_t));
+        inicios[0] = 0;
+        return 1;
+}
+
+/**
+ * @brief Refaz o arquivo do índice percorrendo a árvore.
+ *
+ * Os baldes são montados em memória com cerca de ENTRADAS_POR_BALDE_NA_CONSTRUCAO entradas e
+ * gravados em sequência, um por prefixo do diretório.
+ */
+static int refazer(INDICE_HASH* indice) {
+        indice->valido = 0;
+        indice->pagina_balde = 0;
+        indice->balde_alterado = 0;
+
+        COLETA_INDICE coleta = {0};
+        int status = percorrer_em_ordem(indice->arquivo, coletar_no, &coleta);
+
+        unsigned profundidade = 0;
+        while (((size_t)ENTRADAS_POR_BALDE_NA_CONSTRUCAO << profundidade) < coleta.tamanho &&
+               profundidade < PROFUNDIDADE_MAXIMA_INDICE)
+                profundidade++;
+
+        ENTRADA_INDICE* ordenadas = NULL;
+        size_t* inicios = NULL;
+        if (status == SUCESSO) {
+                ordenadas = malloc((coleta.tamanho ? coleta.tamanho : 1) * sizeof(ENTRADA_INDICE));
+                if (ordenadas == NULL) status = ERRO_MEMORIA;
+        }
+        while (status == SUCESSO) {
+                free(inicios);
+                inicios = malloc((((size_t)1 << profundidade) + 1) * sizeof(size_t));
+                if (inicios == NULL) {
+                        status = ERRO_MEMORIA;
+                        break;
+                }
+                if (distribuir(&coleta, profundidade, inicios, ordenadas)) break;
+                if (profundidade == PROFUNDIDADE_MAXIMA_INDICE) status = ERRO_MEMORIA;
+                profundidade++;
+        }
+
+        size_t prefixos = (size_t)1 << profundidade;
+        uint32_t* diretorio = NULL;
+        if (status == SUCESSO) {
+                diretorio = malloc(prefixos * sizeof(uint32_t));
+                if (diretorio == NULL) status = ERRO_MEMORIA;
+        }
+
+        if (status == SUCESSO) {
+                if (indice->paginas) fclose(indice->paginas);
+                indice->paginas = fopen(indice->caminho, "w+b");
+                if (indice->paginas == NULL) status = ERRO_ARQUIVO_WRITE;
+        }
+        if (status == SUCESSO) {
+                free(indice->diretorio);
+                indice->diretorio = diretorio;
+                diretorio = NULL;
+                indice->profundidade = profundidade;
+                indice->baldes = prefixos;
+                indice->entradas = coleta.tamanho;
+                status = gravar_cabecalho(indice, 0);
+        }
+        for (size_t i = 0; status == SUCESSO && i < prefixos; i++) {
+                BALDE_INDICE* balde = &indice->balde;
+                memset(balde, 0, sizeof(BALDE_INDICE));
+                balde->quantidade = (uint32_t)(inicios[i + 1] - inicios[i]);
+                balde->profundidade_local = profundidade;
+                memcpy(balde->entradas, ordenadas + inicios[i],
+                       balde->quantidade * sizeof(ENTRADA_INDICE));
+                indice->diretorio[i] = (uint32_t)(i + 1);
+                status = gravar_pagina(indice, i + 1, balde);
+        }
+        if (status == SUCESSO) {
+                indice->reconstrucoes++;
+                indice->valido = 1;
+        }
+
+        free(diretorio);
+        free(inicios);
+        free(ordenadas);
+        free(coleta.itens);
+        return status;
+}
+
+/**
+ * @brief Abre o arquivo do índice, se existir, estiver limpo e corresponder ao arquivo de
+ * livros como ele está, e o marca como sujo.
+ *
+ * @return SUCESSO, ou um código de erro se o índice precisar ser refeito.
+ */
+static int carregar(INDICE_HASH* indice) {
+        indice->paginas = fopen(indice->caminho, "r+b");
+        if (indice->paginas == NULL) return ERRO_ARQUIVO_NULO;
+
+        union {
+                CABECALHO_INDICE cabecalho;
+                unsigned char pagina[TAMANHO_PAGINA_INDICE];
+        } pagina;
+        const CABECALHO_INDICE* lido = &pagina.cabecalho;
+        IDENTIDADE_ARQUIVO atual;
+
+        int status = ler_pagina(indice, 0, &pagina);
+        if (status == SUCESSO &&
+            (lido->magica != MAGICA_INDICE || lido->versao != VERSAO_INDICE || lido->limpo != 1 ||
+             lido->profundidade_global > PROFUNDIDADE_MAXIMA_INDICE || lido->baldes == 0 ||
+             lido->baldes > ((uint64_t)1 << lido->profundidade_global)))
+                status = ERRO_ARQUIVO_READ;
+        if (status == SUCESSO) status = identificar_arquivo(indice->arquivo, &atual);
+        if (status == SUCESSO && memcmp(&lido->livros, &atual, sizeof(atual)) != 0)
+                status = ERRO_ARQUIVO_READ;
+
+        size_t prefixos = status == SUCESSO ? (size_t)1 << lido->profundidade_global : 0;
+        if (status == SUCESSO) {
+                indice->diretorio = malloc(prefixos * sizeof(uint32_t));
+                if (indice->diretorio == NULL) status = ERRO_MEMORIA;
+        }
+        if (status == SUCESSO &&
+            (fseek(indice->paginas, (long)((lido->baldes + 1) * TAMANHO_PAGINA_INDICE),
+                   SEEK_SET) != 0 ||
+             fread(indice->diretorio, sizeof(uint32_t), prefixos, indice->paginas) != prefixos ||
+             fgetc(indice->paginas) != EOF))
+                status = ERRO_ARQUIVO_READ;
+        for (size_t i = 0; status == SUCESSO && i < prefixos; i++)
+                if (indice->diretorio[i] == 0 || indice->diretorio[i] > lido->baldes)
+                        status = ERRO_ARQUIVO_READ;
+
+        if (status == SUCESSO) {
+                indice->profundidade = lido->profundidade_global;
+                indice->baldes = (size_t)lido->baldes;
+                indice->entradas = (size_t)lido->entradas;
+                // Sujo até o fechamento: se o processo cair, o índice é refeito.
+                status = gravar_cabecalho(indice, 0);
+        }
+        if (status != SUCESSO) {
+                fclose(indice->paginas);
+                indice->paginas = NULL;
+                free(indice->diretorio);
+                indice->diretorio = NULL;
+                return status;
+        }
+
+        indice->valido = 1;
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava o balde em memória, o diretório depois do último balde e o cabeçalho limpo.
+ */
+static int gravar(INDICE_HASH* indice) {
+        size_t prefixos = (size_t)1 << indice->profundidade;
+        long fim_baldes = (long)((indice->baldes + 1) * TAMANHO_PAGINA_INDICE);
+
+        int status = descarregar_balde(indice);
+        if (status == SUCESSO && fseek(indice->paginas, fim_baldes, SEEK_SET) != 0)
+                status = ERRO_ARQUIVO_SEEK;
+        if (status == SUCESSO &&
+            fwrite(indice->diretorio, sizeof(uint32_t), prefixos, indice->paginas) != prefixos)
+                status = ERRO_ARQUIVO_WRITE;
+        // Um diretório maior gravado antes pode ter deixado bytes além do atual.
+        if (status == SUCESSO &&
+            (fflush(indice->paginas) != 0 ||
+             ftruncate(fileno(indice->paginas),
+                       (off_t)fim_baldes + (off_t)(prefixos * sizeof(uint32_t))) != 0))
+                status = ERRO_ARQUIVO_WRITE;
+        if (status == SUCESSO) status = gravar_cabecalho(indice, 1);
+        return status;
+}
+
+/**
+ * @brief Libera um índice já fora da lista, fechando o arquivo do índice.
+ */
+static int liberar_indice(INDICE_HASH* indice) {
+        int status = SUCESSO;
+        if (indice->paginas && fclose(indice->paginas) != 0) status = ERRO_ARQUIVO_WRITE;
+        free(indice->diretorio);
+        free(indice->caminho);
+        free(indice);
+        return status;
+}
+
+/**
+ * @brief Associa um índice ao handle, abrindo o arquivo do índice ou refazendo-o pela árvore.
+ *
+ * Se o handle já tiver índice, não faz nada.
+ *
+ * @param arquivo Arquivo binário da árvore, já travado pelo chamador.
+ * @param caminho Caminho do arquivo de livros.
+ * @return SUCESSO ou código de erro.
+ */
+int abrir_indice(FILE* arquivo, const char* caminho) {
+        if (arquivo == NULL || caminho == NULL) return ERRO_ARQUIVO_NULO;
+
+        pthread_mutex_lock(&mutex_indices);
+        INDICE_HASH* existente = indice_do_arquivo(arquivo);
+        pthread_mutex_unlock(&mutex_indices);
+        if (existente) return SUCESSO;
+
+        INDICE_HASH* indice = calloc(1, sizeof(INDICE_HASH));
+        if (indice == NULL) return ERRO_MEMORIA;
+        size_t tamanho = strlen(caminho);
+        indice->caminho = malloc(tamanho + sizeof(SUFIXO_INDICE));
+        if (indice->caminho == NULL) {
+                free(indice);
+                return ERRO_MEMORIA;
+        }
+        memcpy(indice->caminho, caminho, tamanho);
+        memcpy(indice->caminho + tamanho, SUFIXO_INDICE, sizeof(SUFIXO_INDICE));
+        indice->arquivo = arquivo;
+
+        int status = carregar(indice);
+        if (status != SUCESSO) status = refazer(indice);
+        if (status != SUCESSO) {
+                remove(indice->caminho);
+                liberar_indice(indice);
+                return status;
+        }
+
+        pthread_mutex_lock(&mutex_indices);
+        indice->proximo = indices;
+        indices = indice;
+        pthread_mutex_unlock(&mutex_indices);
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava o diretório e o cabeçalho do índice e desfaz a associação.
+ *
+ * @param arquivo Handle passado a abrir_indice().
+ * @return SUCESSO ou código de erro.
+ */
+int fechar_indice(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_indices);
+        INDICE_HASH** elo = &indices;
+        while (*elo && (*elo)->arquivo != arquivo) elo = &(*elo)->proximo;
+        INDICE_HASH* indice = *elo;
+        if (indice) *elo = indice->proximo;
+        pthread_mutex_unlock(&mutex_indices);
+        if (indice == NULL) return SUCESSO;
+
+        int status = indice->valido ? gravar(indice) : SUCESSO;
+        int valido = indice->valido && status == SUCESSO;
+        char* caminho = indice->caminho;
+        indice->caminho = NULL;
+
+        if (liberar_indice(indice) != SUCESSO && status == SUCESSO) {
+                status = ERRO_ARQUIVO_WRITE;
+                valido = 0;
+        }
+        // Um arquivo sujo seria refeito de qualquer forma; apagá-lo evita lê-lo à toa.
+        if (!valido) remove(caminho);
+        free(caminho);
+        return status;
+}
+
+/**
+ * @brief Procura a posição do nó de um código no índice associado ao handle.
+ *
+ * @return SUCESSO, ERRO_NO_NULO (código ausente) ou ERRO_ARQUIVO_NULO (sem índice válido).
+ */
+int buscar_no_indice(FILE* arquivo, size_t codigo, int* posicao) {
+        pthread_mutex_lock(&mutex_indices);
+        INDICE_HASH* indice = indice_do_arquivo(arquivo);
+        int status = ERRO_ARQUIVO_NULO;
+        if (indice && indice->valido) {
+                status = carregar_balde(indice, espalhar_codigo(codigo));
+                if (status != SUCESSO) {
+                        indice->valido = 0;
+                        status = ERRO_ARQUIVO_NULO;
+                } else {
+                        ENTRADA_INDICE* entrada = procurar_no_balde(indice, codigo);
+                        if (entrada) *posicao = (int)entrada->posicao;
+                        status = entrada ? SUCESSO : ERRO_NO_NULO;
+                }
+        }
+        pthread_mutex_unlock(&mutex_indices);
+        return status;
+}
+
+/**
+ * @brief Registra (ou atualiza) a posição do nó de um código no índice associado, se houver.
+ */
+void registrar_posicao_no_indice(FILE* arquivo, size_t codigo, int posicao) {
+        pthread_mutex_lock(&mutex_indices);
+        INDICE_HASH* indice = indice_do_arquivo(arquivo);
+        if (indice && indice->valido && inserir_entrada(indice, codigo, posicao) != SUCESSO)
+                indice->valido = 0;
+        pthread_mutex_unlock(&mutex_indices);
+}
+
+/**
+ * @brief Retira um código do índice associado ao handle, se houver.
+ *
+ * Baldes esvaziados não são fundidos: continuam servindo às inserções do mesmo prefixo.
+ */
+void remover_do_indice(FILE* arquivo, size_t codigo) {
+        pthread_mutex_lock(&mutex_indices);
+        INDICE_HASH* indice = indice_do_arquivo(arquivo);
+        if (indice && indice->valido) {
+                if (carregar_balde(indice, espalhar_codigo(codigo)) != SUCESSO) {
+                        indice->valido = 0;
+                } else {
+                        ENTRADA_INDICE* entrada = procurar_no_balde(indice, codigo);
+                        if (entrada) {
+                                *entrada = indice->balde.entradas[--indice->balde.quantidade];
+                                indice->balde_alterado = 1;
+                                indice->entradas--;
+                        }
+                }
+        }
+        pthread_mutex_unlock(&mutex_indices);
+}
+
+/**
+ * @brief Refaz o índice associado ao handle a partir dos nós da árvore.
+ *
+ * @return SUCESSO (também sem índice associado) ou código de erro.
+ */
+int reconstruir_indice(FILE* arquivo) {
+        pthread_mutex_lock(&mutex_indices);
+        INDICE_HASH* indice = indice_do_arquivo(arquivo);
+        int status = indice ? refazer(indice) : SUCESSO;
+        pthread_mutex_unlock(&mutex_indices);
+        return status;
+}
+
+/**
+ * @brief Lê a situação do índice associado ao handle.
+ *
+ * @return SUCESSO, ou ERRO_ARQUIVO_NULO sem índice associado.
+ */
+int consultar_indice(FILE* arquivo, ESTADO_INDICE* estado) {
+        pthread_mutex_lock(&mutex_indices);
+        INDICE_HASH* indice = indice_do_arquivo(arquivo);
+        if (indice && estado) {
+                estado->entradas = indice->entradas;
+                estado->baldes = indice->baldes;
+                estado->profundidade = indice->profundidade;
+                estado->divisoes = indice->divisoes;
+                estado->leituras_de_pagina = indice->leituras;
+                estado->reconstrucoes = indice->reconstrucoes;
+        }
+        pthread_mutex_unlock(&mutex_indices);
+        return indice ? SUCESSO : ERRO_ARQUIVO_NULO;
+}
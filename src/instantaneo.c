@@ -0,0 +1,245 @@
+/**
+ * @file instantaneo.c
+ * @brief Implementa a exportação e a restauração do instantâneo binário do catálogo.
+ */
+
+#include "../include/instantaneo.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/livro.h"
+
+/** Multiplicadores da soma de verificação (primos de 64 bits com bits bem espalhados). */
+#define PRIMO_SOMA_1 0x9E3779B185EBCA87ull
+#define PRIMO_SOMA_2 0xC2B2AE3D27D4EB4Full
+
+// A soma consome palavras de 8 bytes; com registros múltiplos de 8, o resultado não depende de
+// como os registros são agrupados em blocos na exportação e na restauração.
+_Static_assert(sizeof(LIVRO) % 8 == 0, "LIVRO deve ocupar um múltiplo de 8 bytes");
+
+/**
+ * @brief Acumula `tamanho` bytes na soma de verificação, 8 bytes por passo.
+ */
+static uint64_t acumular_soma(uint64_t soma, const void* dados, size_t tamanho) {
+        const unsigned char* bytes = dados;
+        size_t i = 0;
+
+        for (; i + 8 <= tamanho; i += 8) {
+                uint64_t palavra;
+                memcpy(&palavra, bytes + i, 8);
+                soma ^= palavra * PRIMO_SOMA_2;
+                soma = ((soma << 31) | (soma >> 33)) * PRIMO_SOMA_1;
+        }
+        for (; i < tamanho; i++) {
+                soma ^= bytes[i] * PRIMO_SOMA_1;
+                soma = ((soma << 11) | (soma >> 53)) * PRIMO_SOMA_2;
+        }
+
+        return soma;
+}
+
+/**
+ * @brief Soma de verificação dos campos do cabeçalho que a antecedem.
+ */
+static uint64_t soma_do_cabecalho(const CABECALHO_INSTANTANEO* cabecalho) {
+        return acumular_soma(PRIMO_SOMA_2, cabecalho,
+                             offsetof(CABECALHO_INSTANTANEO, soma_cabecalho));
+}
+
+/**
+ * Estado da exportação.
+ */
+typedef struct {
+        FILE* destino;    /**< Destino do instantâneo. */
+        LIVRO* bloco;     /**< Registros aguardando o próximo fwrite(). */
+        size_t pendentes; /**< Registros em `bloco`. */
+        size_t gravados;  /**< Registros já visitados. */
+        size_t esperados; /**< Quantidade informada no cabeçalho. */
+        uint64_t soma;    /**< Soma de verificação dos registros enviados. */
+} EXPORTACAO;
+
+/**
+ * @brief Envia ao destino os registros acumulados.
+ */
+static int descarregar_bloco(EXPORTACAO* exportacao) {
+        size_t bytes = exportacao->pendentes * sizeof(LIVRO);
+        exportacao->soma = acumular_soma(exportacao->soma, exportacao->bloco, bytes);
+
+        size_t enviados = fwrite(exportacao->bloco, sizeof(LIVRO), exportacao->pendentes,
+                                 exportacao->destino);
+        if (enviados != exportacao->pendentes) return ERRO_ARQUIVO_WRITE;
+
+        exportacao->pendentes = 0;
+        return SUCESSO;
+}
+
+/**
+ * @brief Visitante da exportação: copia o livro para o bloco e o envia quando enche.
+ */
+static int exportar_no(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)posicao;
+        EXPORTACAO* exportacao = contexto;
+
+        // Mais nós que o cabeçalho informa: o cabeçalho do instantâneo já foi gravado.
+        if (exportacao->gravados == exportacao->esperados) return ERRO_FORMATO_INSTANTANEO;
+
+        exportacao->bloco[exportacao->pendentes++] = no->livro;
+        exportacao->gravados++;
+        if (exportacao->pendentes == LIVROS_POR_BLOCO_INSTANTANEO)
+                return descarregar_bloco(exportacao);
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava o instantâneo do catálogo, percorrendo a árvore em ordem.
+ *
+ * @param arquivo Arquivo binário da árvore, aberto para leitura.
+ * @param destino Destino do instantâneo, aberto para escrita binária.
+ * @param[out] exportados Livros gravados (opcional).
+ * @return SUCESSO ou código de erro.
+ */
+int exportar_instantaneo(FILE* arquivo, FILE* destino, size_t* exportados) {
+        if (arquivo == NULL || destino == NULL) return ERRO_ARQUIVO_NULO;
+
+        CABECALHO* cabecalho_arvore = le_cabecalho(arquivo);
+        if (cabecalho_arvore == NULL) return ERRO_CABECALHO_NULO;
+
+        CABECALHO_INSTANTANEO cabecalho;
+        memset(&cabecalho, 0, sizeof(cabecalho));
+        cabecalho.magica = MAGICA_INSTANTANEO;
+        cabecalho.versao = VERSAO_INSTANTANEO;
+        cabecalho.tamanho_registro = sizeof(LIVRO);
+        cabecalho.quantidade_livros = cabecalho_arvore->quantidade_livros;
+        cabecalho.soma_cabecalho = soma_do_cabecalho(&cabecalho);
+        free(cabecalho_arvore);
+
+        EXPORTACAO exportacao;
+        exportacao.destino = destino;
+        exportacao.bloco = malloc(LIVROS_POR_BLOCO_INSTANTANEO * sizeof(LIVRO));
+        exportacao.pendentes = 0;
+        exportacao.gravados = 0;
+        exportacao.esperados = cabecalho.quantidade_livros;
+        exportacao.soma = PRIMO_SOMA_1;
+        if (exportacao.bloco == NULL) return ERRO_MEMORIA;
+
+        int status = SUCESSO;
+        if (fwrite(&cabecalho, sizeof(cabecalho), 1, destino) != 1) status = ERRO_ARQUIVO_WRITE;
+        if (status == SUCESSO) status = percorrer_em_ordem(arquivo, exportar_no, &exportacao);
+        if (status == SUCESSO && exportacao.pendentes > 0)
+                status = descarregar_bloco(&exportacao);
+        if (status == SUCESSO && exportacao.gravados != exportacao.esperados)
+                status = ERRO_FORMATO_INSTANTANEO;
+
+        if (status == SUCESSO) {
+                RODAPE_INSTANTANEO rodape = {exportacao.gravados, exportacao.soma};
+                if (fwrite(&rodape, sizeof(rodape), 1, destino) != 1 || fflush(destino) != 0)
+                        status = ERRO_ARQUIVO_WRITE;
+        }
+
+        free(exportacao.bloco);
+        if (exportados) *exportados = exportacao.gravados;
+        return status;
+}
+
+/**
+ * Estado da restauração: a fonte de livros entregue a construir_arvore_em_bloco().
+ */
+typedef struct {
+        FILE* origem;    /**< Instantâneo sendo lido. */
+        LIVRO* bloco;    /**< Último bloco de registros lido. */
+        size_t no_bloco; /**< Registros em `bloco`. */
+        size_t posicao;  /**< Próximo registro de `bloco`. */
+        size_t lidos;    /**< Registros já entregues. */
+        size_t total;    /**< Quantidade informada no cabeçalho. */
+        size_t ultimo;   /**< Código do último registro entregue. */
+        uint64_t soma;   /**< Soma de verificação dos registros lidos. */
+} RESTAURACAO;
+
+/**
+ * @brief Lê o rodapé e confere a quantidade e a soma de verificação.
+ */
+static int conferir_rodape(const RESTAURACAO* restauracao) {
+        RODAPE_INSTANTANEO rodape;
+        if (fread(&rodape, sizeof(rodape), 1, restauracao->origem) != 1)
+                return ERRO_FORMATO_INSTANTANEO;
+        if (rodape.quantidade_livros != restauracao->total) return ERRO_FORMATO_INSTANTANEO;
+        return rodape.soma_livros == restauracao->soma ? SUCESSO : ERRO_SOMA_INSTANTANEO;
+}
+
+/**
+ * @brief Fonte da restauração: entrega o próximo registro, lendo um bloco quando preciso.
+ *
+ * Na entrega do último registro, o rodapé é conferido; se não conferir, a construção é
+ * interrompida antes de o cabeçalho do catálogo ser gravado.
+ */
+static int proximo_registro(void* contexto, LIVRO* livro) {
+        RESTAURACAO* restauracao = contexto;
+
+        if (restauracao->posicao == restauracao->no_bloco) {
+                size_t faltam = restauracao->total - restauracao->lidos;
+                size_t pedir = faltam;
+                if (pedir > LIVROS_POR_BLOCO_INSTANTANEO) pedir = LIVROS_POR_BLOCO_INSTANTANEO;
+                if (fread(restauracao->bloco, sizeof(LIVRO), pedir, restauracao->origem) !=
+                    pedir)
+                        return ERRO_FORMATO_INSTANTANEO;
+                restauracao->soma =
+                    acumular_soma(restauracao->soma, restauracao->bloco, pedir * sizeof(LIVRO));
+                restauracao->no_bloco = pedir;
+                restauracao->posicao = 0;
+        }
+
+        *livro = restauracao->bloco[restauracao->posicao++];
+        if (restauracao->lidos > 0 && livro->codigo <= restauracao->ultimo)
+                return ERRO_FORMATO_INSTANTANEO;
+        restauracao->ultimo = livro->codigo;
+
+        if (++restauracao->lidos == restauracao->total) return conferir_rodape(restauracao);
+        return SUCESSO;
+}
+
+/**
+ * @brief Restaura um instantâneo num catálogo vazio.
+ *
+ * @param origem Instantâneo aberto para leitura binária.
+ * @param arquivo Arquivo binário da árvore, vazio e aberto em modo leitura/escrita ("rb+").
+ * @param[out] restaurados Livros restaurados (opcional).
+ * @return SUCESSO ou código de erro.
+ */
+int restaurar_instantaneo(FILE* origem, FILE* arquivo, size_t* restaurados) {
+        if (origem == NULL || arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (restaurados) *restaurados = 0;
+
+        CABECALHO_INSTANTANEO cabecalho;
+        if (fread(&cabecalho, sizeof(cabecalho), 1, origem) != 1 ||
+            cabecalho.magica != MAGICA_INSTANTANEO || cabecalho.versao != VERSAO_INSTANTANEO ||
+            cabecalho.tamanho_registro != sizeof(LIVRO) ||
+            cabecalho.soma_cabecalho != soma_do_cabecalho(&cabecalho) ||
+            cabecalho.quantidade_livros > SIZE_MAX / sizeof(LIVRO))
+                return ERRO_FORMATO_INSTANTANEO;
+
+        RESTAURACAO restauracao;
+        memset(&restauracao, 0, sizeof(restauracao));
+        restauracao.origem = origem;
+        restauracao.total = cabecalho.quantidade_livros;
+        restauracao.soma = PRIMO_SOMA_1;
+
+        // Sem registros, a fonte nunca é chamada: o rodapé é conferido aqui.
+        int status = restauracao.total == 0 ? conferir_rodape(&restauracao) : SUCESSO;
+
+        if (status == SUCESSO && restauracao.total > 0) {
+                restauracao.bloco = malloc(LIVROS_POR_BLOCO_INSTANTANEO * sizeof(LIVRO));
+                if (restauracao.bloco == NULL) status = ERRO_MEMORIA;
+        }
+        if (status == SUCESSO)
+                status = construir_arvore_em_bloco(arquivo, restauracao.total, proximo_registro,
+                                                   &restauracao);
+
+        free(restauracao.bloco);
+        if (status == SUCESSO && restaurados) *restaurados = restauracao.total;
+        return status;
+}
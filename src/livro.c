@@ -7,6 +7,8 @@
 #include "../include/arquivo.h"
 #include "../include/arvore.h"
 #include "../include/erros.h"
+#include "../include/estatisticas.h"
+#include "../include/filtro.h"
 
 /**
  * @brief Verifica a existência de um livro na árvore binária pelo código.
@@ -23,12 +25,14 @@
  *         - ERRO_NO_NULO: livro não encontrado na árvore.
  *         - Demais códigos de erro vindos de buscar_no_arvore.
  *
+ * @note Se o handle tiver um filtro (filtro.h) que descarte o código, a árvore não é lida.
  * @note Esta função é interna (static) e deve ser utilizada apenas por funções
  *       que precisam validar a existência de um livro antes de realizar operações.
  * @note A função desaloca automaticamente as estruturas utilizadas na busca.
  */
 static int verificar_id_livro(FILE* arquivo, size_t codigo_livro) {
         if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (codigo_certamente_ausente(arquivo, codigo_livro)) return ERRO_NO_NULO;
 
         CABECALHO* cabecalho = le_cabecalho(arquivo);
         if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
@@ -46,23 +50,9 @@ static int verificar_id_livro(FILE* arquivo, size_t codigo_livro) {
 }
 
 /**
- * @brief Cadastra um novo livro na árvore binária de busca.
- *
- * Esta função verifica se já existe um livro com o mesmo código no arquivo,
- * e caso não exista, insere o novo livro na árvore binária de busca.
- *
- * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura/escrita ("rb+").
- * @param livro Estrutura LIVRO com todos os dados preenchidos.
- * @return Código de retorno:
- *         - SUCESSO: livro cadastrado com sucesso.
- *         - ERRO_ARQUIVO_NULO: ponteiro para arquivo é nulo.
- *         - ERRO_CODIGO_DUPLICADO: já existe livro com o mesmo código.
- *         - Demais códigos de erro vindos de verificar_id_livro ou inserir_no_arvore.
- *
- * @note Esta função não fecha o arquivo. O chamador é responsável por
- *       abrir e fechar o arquivo antes e depois da chamada.
+ * @brief Corpo de cadastrar_livro(), sem a medição.
  */
-int cadastrar_livro(FILE* arquivo, LIVRO livro) {
+static int cadastrar(FILE* arquivo, LIVRO livro) {
         if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
 
         // Verifica se já existe livro com o mesmo código
@@ -81,6 +71,30 @@ int cadastrar_livro(FILE* arquivo, LIVRO livro) {
         return inserir_no_arvore(arquivo, &no_novo);
 }
 
+/**
+ * @brief Cadastra um novo livro na árvore binária de busca.
+ *
+ * Esta função verifica se já existe um livro com o mesmo código no arquivo,
+ * e caso não exista, insere o novo livro na árvore binária de busca.
+ *
+ * @param arquivo Ponteiro para o arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param livro Estrutura LIVRO com todos os dados preenchidos.
+ * @return Código de retorno:
+ *         - SUCESSO: livro cadastrado com sucesso.
+ *         - ERRO_ARQUIVO_NULO: ponteiro para arquivo é nulo.
+ *         - ERRO_CODIGO_DUPLICADO: já existe livro com o mesmo código.
+ *         - Demais códigos de erro vindos de verificar_id_livro ou inserir_no_arvore.
+ *
+ * @note Esta função não fecha o arquivo. O chamador é responsável por
+ *       abrir e fechar o arquivo antes e depois da chamada.
+ */
+int cadastrar_livro(FILE* arquivo, LIVRO livro) {
+        INICIAR_MEDICAO(medicao, OPERACAO_CADASTRAR, livro.codigo);
+        int status = cadastrar(arquivo, livro);
+        CONCLUIR_MEDICAO(medicao, status);
+        return status;
+}
+
 /**
  * @brief Imprime na saída padrão os dados de um livro com base em seu código.
  *
@@ -111,7 +125,9 @@ int cadastrar_livro(FILE* arquivo, LIVRO livro) {
 int imprimir_dados(FILE* arquivo, size_t codigo) {
         if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
         RESULTADO_BUSCA res;
-        int status = buscar_no_arvore(arquivo, codigo, &res);
+        int status = codigo_certamente_ausente(arquivo, codigo)
+                         ? ERRO_NO_NULO
+                         : buscar_no_arvore(arquivo, codigo, &res);
         if (status == SUCESSO) {
                 printf(
                     "Codigo: %zu\nTitulo: %s\nAutor: %s\nEditora: %s\nEdicao: %zu\nAno: "
@@ -0,0 +1,267 @@
+/**
+ * @file lote.c
+ * @brief Implementa o modo em lote.
+ */
+
+#include "../include/lote.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/acesso_direto.h"
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/concorrencia.h"
+#include "../include/diagnostico.h"
+#include "../include/erros.h"
+#include "../include/espaco_livre.h"
+#include "../include/exportacao.h"
+#include "../include/filtro.h"
+#include "../include/indice.h"
+#include "../include/importacao.h"
+#include "../include/importacao_paralela.h"
+#include "../include/livro.h"
+#include "../include/utils.h"
+#include "../include/versoes.h"
+
+/**
+ * @brief Cadastra um livro com a variante de inserção do modo ativo.
+ *
+ * O lote já segura a trava de escrita, então usa as funções sem trava.
+ */
+static int inserir_livro(FILE* arquivo, LIVRO livro) {
+        if (livro.codigo == 0) return ERRO_LIVRO_INVALIDO;
+        if (!modo_cow_ativo()) return cadastrar_livro(arquivo, livro);
+
+        NO_ARVORE no;
+        no.livro = livro;
+        no.filho_esquerdo = POSICAO_INVALIDA;
+        no.filho_direito = POSICAO_INVALIDA;
+        return inserir_no_arvore_cow(arquivo, &no);
+}
+
+/**
+ * @brief Converte o argumento em código, rejeitando texto que não seja número positivo ou que
+ * não caiba em size_t.
+ *
+ * @return SUCESSO ou ERRO_LIVRO_INVALIDO.
+ */
+static int ler_codigo(const char* texto, size_t* codigo) {
+        size_t tamanho = strlen(texto);
+        while (tamanho > 0 && isspace((unsigned char)texto[tamanho - 1])) tamanho--;
+        size_t valor;
+        if (!converter_size_t(texto, tamanho, &valor) || valor == 0) return ERRO_LIVRO_INVALIDO;
+
+        *codigo = valor;
+        return SUCESSO;
+}
+
+/**
+ * @brief Comando `get`: imprime o livro no mesmo formato de linha do `add`.
+ */
+static int comando_get(FILE* arquivo, const char* argumento, FILE* saida) {
+        size_t codigo;
+        int status = ler_codigo(argumento, &codigo);
+        if (status != SUCESSO) return status;
+
+        if (codigo_certamente_ausente(arquivo, codigo)) return ERRO_LIVRO_INVALIDO;
+
+        RESULTADO_BUSCA resultado = {0};
+        status = buscar_no_arvore(arquivo, codigo, &resultado);
+        if (status == SUCESSO) {
+                const LIVRO* livro = &resultado.no->livro;
+                fprintf(saida, "%zu;%s;%s;%s;%zu;%zu;%zu;%.2f\n", livro->codigo, livro->titulo,
+                        livro->autor, livro->editora, livro->edicao, livro->ano,
+                        livro->exemplares, livro->preco);
+        } else if (status == ERRO_NO_NULO) {
+                status = ERRO_LIVRO_INVALIDO;
+        }
+
+        free(resultado.no);
+        free(resultado.pai);
+        return status;
+}
+
+/**
+ * @brief Comando `del`.
+ */
+static int comando_del(FILE* arquivo, const char* argumento) {
+        size_t codigo;
+        int status = ler_codigo(argumento, &codigo);
+        if (status != SUCESSO) return status;
+
+        return modo_cow_ativo() ? remover_no_arvore_cow(arquivo, codigo)
+                                : remover_no_arvore(arquivo, codigo);
+}
+
+/**
+ * @brief Comando `load`: importa um arquivo texto com o pipeline paralelo
+ * (importacao_paralela.h), gravando as linhas rejeitadas em `CAMINHO.rejeitados`.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_TEXTO se o arquivo não abrir, ERRO_MEMORIA, ou
+ *         ERRO_CADASTRAR_LIVRO se alguma linha for rejeitada.
+ */
+static int comando_load(FILE* arquivo, const char* caminho, FILE* saida) {
+        char* rejeitadas = malloc(strlen(caminho) + sizeof(SUFIXO_REJEITADAS));
+        if (rejeitadas == NULL) return ERRO_MEMORIA;
+        strcpy(rejeitadas, caminho);
+        strcat(rejeitadas, SUFIXO_REJEITADAS);
+
+        RELATORIO_PIPELINE relatorio;
+        int status = importar_texto_paralelo(caminho, arquivo, 0, rejeitadas, &relatorio);
+        free(rejeitadas);
+        if (status != SUCESSO) return status;
+
+        const size_t* motivos = relatorio.totais.por_motivo;
+        fprintf(saida, "load %s: %zu cadastrados, %zu rejeitados", caminho,
+                relatorio.totais.cadastrados, relatorio.totais.rejeitados);
+        if (relatorio.totais.rejeitados > 0)
+                fprintf(saida, " (%zu repetidos, %zu formato, %zu truncados, %zu gravacao)",
+                        motivos[REJEICAO_REPETIDO], motivos[REJEICAO_FORMATO],
+                        motivos[REJEICAO_TRUNCADO], motivos[REJEICAO_GRAVACAO]);
+        fputc('\n', saida);
+        return relatorio.totais.rejeitados == 0 ? SUCESSO : ERRO_CADASTRAR_LIVRO;
+}
+
+/**
+ * @brief Comando `export`: grava o catálogo em CSV ou JSON Lines (exportacao.h), conforme a
+ * extensão do caminho.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_TEXTO se o destino não abrir, ou os erros de
+ *         exportar_catalogo().
+ */
+static int comando_export(FILE* arquivo, const char* caminho, FILE* saida) {
+        FILE* destino = fopen(caminho, "w");
+        if (destino == NULL) return ERRO_ARQUIVO_TEXTO;
+
+        RELATORIO_EXPORTACAO relatorio;
+        int status = exportar_catalogo(arquivo, destino, formato_pelo_caminho(caminho), &relatorio);
+        if (fclose(destino) != 0 && status == SUCESSO) status = ERRO_ARQUIVO_WRITE;
+        if (status != SUCESSO) return status;
+
+        fprintf(saida, "export %s: %zu livros, %zu bytes\n", caminho, relatorio.livros,
+                relatorio.bytes);
+        return SUCESSO;
+}
+
+/**
+ * @brief Comando `stats`.
+ */
+static int comando_stats(FILE* arquivo, FILE* saida) {
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+
+        fprintf(saida, "livros: %zu\nposicoes_usadas: %d\n", cabecalho->quantidade_livros,
+                cabecalho->topo);
+        free(cabecalho);
+        return SUCESSO;
+}
+
+/**
+ * @brief Comando `health`: diagnóstico da árvore em JSON, numa linha.
+ */
+static int comando_health(FILE* arquivo, FILE* saida) {
+        DIAGNOSTICO_ARVORE diagnostico;
+        int status = diagnosticar_arvore(arquivo, &diagnostico);
+        if (status != SUCESSO) return status;
+
+        status = imprimir_diagnostico(saida, &diagnostico, DIAGNOSTICO_JSON);
+        liberar_diagnostico(&diagnostico);
+        return status;
+}
+
+/**
+ * @brief Executa um comando já separado do argumento.
+ *
+ * @return Código de status do comando; ERRO_COMANDO_INVALIDO para comandos desconhecidos.
+ */
+static int executar_comando(FILE* arquivo, const char* comando, char* argumento, FILE* saida) {
+        if (strcmp(comando, "add") == 0) {
+                LIVRO livro;
+                int status = interpretar_livro(argumento, strlen(argumento), &livro);
+                return status == SUCESSO ? inserir_livro(arquivo, livro) : status;
+        }
+        if (strcmp(comando, "get") == 0) return comando_get(arquivo, argumento, saida);
+        if (strcmp(comando, "del") == 0) return comando_del(arquivo, argumento);
+        if (strcmp(comando, "load") == 0) return comando_load(arquivo, argumento, saida);
+        if (strcmp(comando, "export") == 0) return comando_export(arquivo, argumento, saida);
+        if (strcmp(comando, "stats") == 0) return comando_stats(arquivo, saida);
+        if (strcmp(comando, "health") == 0) return comando_health(arquivo, saida);
+
+        return ERRO_COMANDO_INVALIDO;
+}
+
+/**
+ * @brief Executa todos os comandos de `comandos` sobre um único handle do arquivo de livros.
+ *
+ * @param comandos Arquivo de comandos, um por linha.
+ * @param caminho_livros Caminho do arquivo binário de livros.
+ * @param saida Destino dos resultados de `get`, `load`, `export`, `stats` e `health`.
+ * @param parar_no_erro Se diferente de zero, para no primeiro comando que falhar.
+ * @return SUCESSO se todos os comandos tiveram sucesso; caso contrário, o código do primeiro erro.
+ */
+int executar_lote(FILE* comandos, const char* caminho_livros, FILE* saida, int parar_no_erro) {
+        if (comandos == NULL || saida == NULL) return ERRO_ARQUIVO_NULO;
+
+        FILE* arquivo = fopen(caminho_livros, "rb+");
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        int status = travar_arquivo(arquivo, TRAVA_ESCRITA);
+        if (status != SUCESSO) {
+                fclose(arquivo);
+                return status;
+        }
+
+        // Sem o filtro, o índice, o mapa do espaço livre e o acesso direto os comandos só ficam
+        // mais lentos: uma falha aqui não interrompe o lote.
+        if (paginas_acesso_direto() > 0)
+                abrir_acesso_direto(arquivo, caminho_livros, paginas_acesso_direto());
+        abrir_filtro(arquivo, caminho_livros);
+        abrir_indice(arquivo, caminho_livros);
+        abrir_mapa_livre(arquivo, caminho_livros);
+
+        char* linha = NULL;
+        size_t capacidade = 0;
+        size_t numero_linha = 0;
+        size_t executados = 0;
+        size_t falhas = 0;
+        int primeiro_erro = SUCESSO;
+
+        while (getline(&linha, &capacidade, comandos) != -1) {
+                numero_linha++;
+                linha[strcspn(linha, "\r\n")] = '\0';
+
+                char* comando = linha;
+                while (isspace((unsigned char)*comando)) comando++;
+                if (*comando == '\0' || *comando == '#') continue;
+
+                char* argumento = comando;
+                while (*argumento && !isspace((unsigned char)*argumento)) argumento++;
+                if (*argumento) *argumento++ = '\0';
+                while (isspace((unsigned char)*argumento)) argumento++;
+
+                executados++;
+                status = executar_comando(arquivo, comando, argumento, saida);
+                if (status == SUCESSO) continue;
+
+                falhas++;
+                if (primeiro_erro == SUCESSO) primeiro_erro = status;
+                fprintf(stderr, "linha %zu: %s: erro %d\n", numero_linha, comando, status);
+                if (parar_no_erro) break;
+        }
+
+        free(linha);
+        fechar_mapa_livre(arquivo);
+        fechar_indice(arquivo);
+        fechar_filtro(arquivo);
+        destravar_arquivo(arquivo, TRAVA_ESCRITA);
+        fechar_acesso_direto(arquivo);
+        fclose(arquivo);
+
+        fflush(saida);
+        fprintf(stderr, "%zu comandos executados, %zu com erro\n", executados, falhas);
+
+        return primeiro_erro;
+}
@@ -6,9 +6,21 @@
 
 #include "../include/arquivo.h"
 #include "../include/arvore.h"
+#include "../include/catalogo_compactado.h"
+#include "../include/concorrencia.h"
+#include "../include/diagnostico.h"
 #include "../include/erros.h"
+#include "../include/espaco_livre.h"
+#include "../include/estatisticas.h"
+#include "../include/exportacao.h"
+#include "../include/filtro.h"
+#include "../include/indice.h"
+#include "../include/importacao_paralela.h"
+#include "../include/instantaneo.h"
 #include "../include/livro.h"
+#include "../include/rebalanceamento.h"
 #include "../include/utils.h"
+#include "../include/versoes.h"
 
 /**
  * @brief Remove o caractere de nova linha '\n' do final da string.
@@ -32,6 +44,14 @@ void exibir_menu() {
         printf("6  - CARREGAR ARQUIVO\n");
         printf("7  - IMPRIMIR LISTA DE REGISTROS LIVRES\n");
         printf("8  - IMPRIMIR ARVORE POR NIVEIS\n");
+        printf("9  - COMPACTAR CATALOGO\n");
+        printf("10 - LISTAR CATALOGO COMPACTADO\n");
+        printf("11 - EXPORTAR INSTANTANEO\n");
+        printf("12 - RESTAURAR INSTANTANEO\n");
+        printf("13 - EXPORTAR CATALOGO (CSV/JSON)\n");
+        printf("14 - EXIBIR ESTATISTICAS\n");
+        printf("15 - DIAGNOSTICAR ARVORE\n");
+        printf("16 - REBALANCEAR ARVORE\n");
         printf("0  - SAIR\n");
         printf("========================\n");
 }
@@ -97,7 +117,7 @@ int opcao_cadastrar_livro(char* caminho_livros) {
         if (arquivo == NULL) {
                 return ERRO_ARQUIVO_NULO;
         }
-        if ((resposta = cadastrar_livro(arquivo, livro)) != SUCESSO) {
+        if ((resposta = cadastrar_livro_concorrente(arquivo, livro)) != SUCESSO) {
                 printf("Erro ao cadastrar livro");
                 if (resposta == ERRO_CODIGO_DUPLICADO)
                         printf(": Livro com codigo ja cadastrado\n");
@@ -127,7 +147,11 @@ int opcao_imprimir_dados(char* caminho_livros) {
         FILE* arquivo = fopen(caminho_livros, "rb");
         if (!arquivo) return ERRO_ARQUIVO_NULO;
 
-        int status = imprimir_dados(arquivo, codigo);
+        int status = travar_arquivo(arquivo, TRAVA_LEITURA);
+        if (status == SUCESSO) {
+                status = imprimir_dados(arquivo, codigo);
+                destravar_arquivo(arquivo, TRAVA_LEITURA);
+        }
         fclose(arquivo);
 
         printf("\n");
@@ -135,9 +159,42 @@ int opcao_imprimir_dados(char* caminho_livros) {
         return status;
 }
 
+/**
+ * @brief Visitante que imprime um livro no formato da listagem.
+ */
+static int imprimir_no_listagem(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)posicao;
+        (void)contexto;
+        printf("Codigo: %zu\nTitulo: %s\nAutor: %s\nExemplares: %zu\n\n", no->livro.codigo,
+               no->livro.titulo, no->livro.autor, no->livro.exemplares);
+        return SUCESSO;
+}
+
+/**
+ * @brief Lista os livros de uma versão copy-on-write, sem bloquear escritores.
+ *
+ * @param arquivo Arquivo binário aberto para leitura.
+ * @return int Código de status da operação.
+ */
+static int listar_versao(FILE* arquivo) {
+        VERSAO_ARVORE versao;
+        int status = abrir_versao(arquivo, &versao);
+        if (status != SUCESSO) return status;
+
+        if (versao.raiz == POSICAO_INVALIDA)
+                printf("Arvore vazia.\n");
+        else
+                status = percorrer_versao_em_ordem(arquivo, &versao, imprimir_no_listagem, NULL);
+
+        fechar_versao(&versao);
+        return status;
+}
+
 /**
  * @brief Lista todos os livros presentes no arquivo binário.
  *
+ * No modo copy-on-write, a listagem percorre uma versão consistente sem segurar travas.
+ *
  * @param caminho_livros Caminho do arquivo binário com os livros.
  * @return int Código de status da operação.
  */
@@ -145,7 +202,17 @@ int opcao_listar_todos(char* caminho_livros) {
         FILE* arquivo = fopen(caminho_livros, "rb");
         if (!arquivo) return ERRO_ARQUIVO_NULO;
 
-        int status = imprimir_in_ordem(arquivo);
+        if (modo_cow_ativo()) {
+                int status = listar_versao(arquivo);
+                fclose(arquivo);
+                return status;
+        }
+
+        int status = travar_arquivo(arquivo, TRAVA_LEITURA);
+        if (status == SUCESSO) {
+                status = imprimir_in_ordem(arquivo);
+                destravar_arquivo(arquivo, TRAVA_LEITURA);
+        }
         fclose(arquivo);
 
         return status;
@@ -161,7 +228,12 @@ int opcao_calcular_total(char* caminho_livros) {
         FILE* arquivo = fopen(caminho_livros, "rb");
         if (!arquivo) return ERRO_ARQUIVO_NULO;
 
+        if (travar_arquivo(arquivo, TRAVA_LEITURA) != SUCESSO) {
+                fclose(arquivo);
+                return ERRO_TRAVA;
+        }
         CABECALHO* cab = le_cabecalho(arquivo);
+        destravar_arquivo(arquivo, TRAVA_LEITURA);
         if (!cab) {
                 fclose(arquivo);
                 return ERRO_CABECALHO_NULO;
@@ -190,7 +262,7 @@ int opcao_remover_livro(char* caminho_livros) {
         FILE* arquivo = fopen(caminho_livros, "rb+");
         if (!arquivo) return ERRO_ARQUIVO_NULO;
 
-        int status = remover_no_arvore(arquivo, codigo);
+        int status = remover_no_arvore_concorrente(arquivo, codigo);
         fclose(arquivo);
 
         printf("\n");
@@ -212,7 +284,11 @@ int opcao_imprimir_lista_livre(const char* caminho) {
         }
 
         printf("Lista de nós livres: \n\n");
-        int r = imprimir_lista_livre(arq);
+        int r = travar_arquivo(arq, TRAVA_LEITURA);
+        if (r == SUCESSO) {
+                r = imprimir_lista_livre(arq);
+                destravar_arquivo(arq, TRAVA_LEITURA);
+        }
 
         fclose(arq);
 
@@ -222,80 +298,11 @@ int opcao_imprimir_lista_livre(const char* caminho) {
 }
 
 /**
- * @brief Função auxiliar que lê um arquivo texto já aberto e cadastra os livros no arquivo binário.
+ * @brief Solicita o nome do arquivo texto ao usuário e importa os livros no arquivo binário.
  *
- * @param txt Ponteiro para o arquivo texto aberto para leitura.
- * @param arq_bin Ponteiro para o arquivo binário aberto para leitura/escrita.
- * @return int Código de status da operação.
- */
-static int ler_txt(FILE* txt, FILE* arq_bin) {
-        char linha[512];
-        while (fgets(linha, sizeof(linha), txt)) {
-                LIVRO livro = {0};
-                char preco_str[50];
-                char* token = strtok(linha, ";");
-                if (!token) continue;
-                trim(token);
-                livro.codigo = (size_t)strtoull(token, NULL, 10);
-
-                token = strtok(NULL, ";");
-                if (!token) continue;
-                trim(token);
-                strncpy(livro.titulo, token, sizeof(livro.titulo) - 1);
-                livro.titulo[sizeof(livro.titulo) - 1] = '\0';
-                livro.titulo[strcspn(livro.titulo, "\n")] = '\0';
-
-                token = strtok(NULL, ";");
-                if (!token) continue;
-                trim(token);
-                strncpy(livro.autor, token, sizeof(livro.autor) - 1);
-                livro.autor[sizeof(livro.autor) - 1] = '\0';
-                livro.autor[strcspn(livro.autor, "\n")] = '\0';
-
-                token = strtok(NULL, ";");
-                if (!token) continue;
-                trim(token);
-                strncpy(livro.editora, token, sizeof(livro.editora) - 1);
-                livro.editora[sizeof(livro.editora) - 1] = '\0';
-                livro.editora[strcspn(livro.editora, "\n")] = '\0';
-
-                token = strtok(NULL, ";");
-                if (!token) continue;
-                trim(token);
-                livro.edicao = (size_t)strtoull(token, NULL, 10);
-
-                token = strtok(NULL, ";");
-                if (!token) continue;
-                trim(token);
-                livro.ano = (size_t)strtoull(token, NULL, 10);
-
-                token = strtok(NULL, ";");
-                if (!token) continue;
-                trim(token);
-                livro.exemplares = (size_t)strtoull(token, NULL, 10);
-
-                token = strtok(NULL, ";");
-                if (!token) continue;
-                trim(token);
-                strncpy(preco_str, token, sizeof(preco_str) - 1);
-                preco_str[sizeof(preco_str) - 1] = '\0';
-                for (char* p = preco_str; *p; p++) {
-                        if (*p == ',') *p = '.';
-                }
-                livro.preco = strtod(preco_str, NULL);
-
-                if (cadastrar_livro(arq_bin, livro) != SUCESSO) {
-                        printf("ERRO AO CADASTRAR LIVRO (codigo %zu)\n", livro.codigo);
-                }
-        }
-        printf("Operacao de leitura de arquivo texto concluida!\n");
-
-        return SUCESSO;
-}
-
-/**
- * @brief Abre o arquivo texto, solicita o nome ao usuário e chama a função para carregar os livros
- * no arquivo binário.
+ * Usa o pipeline paralelo (importacao_paralela.h) com uma thread por CPU, segurando a trava
+ * de escrita durante toda a importação, e imprime a vazão de cada etapa e as rejeições por
+ * motivo. As linhas rejeitadas vão para `<arquivo texto>.rejeitados`.
  *
  * @param caminho Caminho do arquivo binário para salvar os livros.
  * @return int Código de status da operação.
@@ -308,22 +315,38 @@ int opcao_carregar_txt(const char* caminho) {
 
         printf("\n");
 
-        FILE* txt = fopen(nome_arquivo, "r");
-        if (!txt) {
-                return ERRO_ARQUIVO_NULO;
-        }
-
         FILE* arq_bin = fopen(caminho, "rb+");
         if (!arq_bin) {
-                fclose(txt);
                 return ERRO_ARQUIVO_NULO;
         }
 
-        int status = ler_txt(txt, arq_bin);
+        char rejeitadas[sizeof(nome_arquivo) + sizeof(SUFIXO_REJEITADAS)];
+        snprintf(rejeitadas, sizeof(rejeitadas), "%s%s", nome_arquivo, SUFIXO_REJEITADAS);
+
+        RELATORIO_PIPELINE relatorio;
+        int status = travar_arquivo(arq_bin, TRAVA_ESCRITA);
+        if (status == SUCESSO) {
+                // Com o filtro, o índice e o mapa abertos, os códigos importados entram no
+                // `.bloom` e no `.hash` do catálogo, e os nós novos ficam perto dos pais.
+                abrir_filtro(arq_bin, caminho);
+                abrir_indice(arq_bin, caminho);
+                abrir_mapa_livre(arq_bin, caminho);
+                status = importar_texto_paralelo(nome_arquivo, arq_bin, 0, rejeitadas, &relatorio);
+                fechar_mapa_livre(arq_bin);
+                fechar_indice(arq_bin);
+                fechar_filtro(arq_bin);
+                destravar_arquivo(arq_bin, TRAVA_ESCRITA);
+        }
 
-        fclose(txt);
         fclose(arq_bin);
 
+        if (status == SUCESSO) {
+                printf("Operacao de leitura de arquivo texto concluida!\n");
+                imprimir_relatorio_pipeline(stdout, &relatorio);
+                if (relatorio.totais.rejeitados > 0)
+                        printf("Linhas rejeitadas gravadas em %s\n", rejeitadas);
+        }
+
         printf("\n");
 
         return status;
@@ -349,11 +372,281 @@ int opcao_imprimir_arvore_por_niveis(const char* caminho) {
         FILE* arquivo = fopen(caminho, "rb");
         if (!arquivo) return ERRO_ARQUIVO_NULO;
 
-        int status = imprimir_arvore_por_niveis(arquivo);
+        int status = travar_arquivo(arquivo, TRAVA_LEITURA);
+        if (status == SUCESSO) {
+                status = imprimir_arvore_por_niveis(arquivo);
+                destravar_arquivo(arquivo, TRAVA_LEITURA);
+        }
+
+        fclose(arquivo);
+
+        printf("\n");
+
+        return status;
+}
+
+/**
+ * @brief Grava o catálogo compactado (dados frios) a partir do arquivo binário de livros.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @param caminho_compactado Caminho do catálogo compactado que será (re)criado.
+ * @return int Código de status da operação.
+ */
+int opcao_compactar_catalogo(const char* caminho, const char* caminho_compactado) {
+        FILE* arquivo = fopen(caminho, "rb");
+        if (!arquivo) return ERRO_ARQUIVO_NULO;
+
+        FILE* destino = fopen(caminho_compactado, "wb");
+        if (!destino) {
+                fclose(arquivo);
+                return ERRO_ARQUIVO_NULO;
+        }
+
+        int status = travar_arquivo(arquivo, TRAVA_LEITURA);
+        if (status == SUCESSO) {
+                status = compactar_catalogo(arquivo, destino);
+                destravar_arquivo(arquivo, TRAVA_LEITURA);
+        }
+
+        fclose(destino);
+        fclose(arquivo);
+
+        if (status == SUCESSO) printf("Catalogo compactado gravado em %s\n\n", caminho_compactado);
+
+        return status;
+}
+
+/**
+ * @brief Lista em ordem de código todos os livros do catálogo compactado, se ele estiver em
+ * dia com o arquivo de livros.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @param caminho_compactado Caminho do catálogo compactado.
+ * @return int Código de status da operação.
+ */
+int opcao_listar_catalogo_compactado(const char* caminho, const char* caminho_compactado) {
+        FILE* arquivo = fopen(caminho_compactado, "rb");
+        if (!arquivo) {
+                printf("Catalogo compactado %s nao encontrado; gere-o com a opcao 9.\n\n",
+                       caminho_compactado);
+                return ERRO_FORMATO_COMPACTADO;
+        }
+        CATALOGO_COMPACTADO* catalogo = abrir_catalogo_compactado(arquivo);
+        if (!catalogo) {
+                fclose(arquivo);
+                return ERRO_FORMATO_COMPACTADO;
+        }
+
+        // Só a conferência precisa do arquivo de livros: o cabeçalho e o contador de alterações
+        FILE* origem = fopen(caminho, "rb");
+        int status = origem ? travar_arquivo(origem, TRAVA_LEITURA) : ERRO_ARQUIVO_NULO;
+        if (status == SUCESSO) {
+                if (!catalogo_compactado_atual(catalogo, origem)) {
+                        printf("Catalogo compactado desatualizado em relacao a %s; gere-o de novo "
+                               "com a opcao 9.\n\n",
+                               caminho);
+                        status = ERRO_COMPACTADO_ANTIGO;
+                }
+                destravar_arquivo(origem, TRAVA_LEITURA);
+        }
+        if (origem) fclose(origem);
+
+        if (status == SUCESSO) status = imprimir_compactado_em_ordem(catalogo);
+        if (status == SUCESSO) {
+                printf("Bytes lidos do disco: %zu (sem compressao: %zu)\n\n",
+                       catalogo->bytes_lidos,
+                       (size_t)catalogo->cabecalho.quantidade_livros * sizeof(NO_ARVORE));
+        }
+
+        fechar_catalogo_compactado(catalogo);
+        fclose(arquivo);
+        return status;
+}
+
+/**
+ * @brief Grava o instantâneo binário (instantaneo.h) do arquivo de livros.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @param caminho_instantaneo Caminho do instantâneo que será (re)criado.
+ * @return int Código de status da operação.
+ */
+int opcao_exportar_instantaneo(const char* caminho, const char* caminho_instantaneo) {
+        FILE* arquivo = fopen(caminho, "rb");
+        if (!arquivo) return ERRO_ARQUIVO_NULO;
+
+        FILE* destino = fopen(caminho_instantaneo, "wb");
+        if (!destino) {
+                fclose(arquivo);
+                return ERRO_ARQUIVO_NULO;
+        }
+
+        size_t exportados = 0;
+        int status = travar_arquivo(arquivo, TRAVA_LEITURA);
+        if (status == SUCESSO) {
+                status = exportar_instantaneo(arquivo, destino, &exportados);
+                destravar_arquivo(arquivo, TRAVA_LEITURA);
+        }
 
+        if (fclose(destino) != 0 && status == SUCESSO) status = ERRO_ARQUIVO_WRITE;
         fclose(arquivo);
 
+        if (status == SUCESSO)
+                printf("%zu livros exportados para %s\n\n", exportados, caminho_instantaneo);
+        else
+                remove(caminho_instantaneo);
+
+        return status;
+}
+
+/**
+ * @brief Substitui o arquivo de livros pelo conteúdo de um instantâneo.
+ *
+ * @param caminho Caminho do arquivo binário de livros.
+ * @param caminho_instantaneo Caminho do instantâneo.
+ * @return int Código de status da operação.
+ */
+int opcao_restaurar_instantaneo(const char* caminho, const char* caminho_instantaneo) {
+        FILE* origem = fopen(caminho_instantaneo, "rb");
+        if (!origem) return ERRO_ARQUIVO_NULO;
+
+        char temporario[512];
+        snprintf(temporario, sizeof(temporario), "%s.restaurando", caminho);
+        remove(temporario);
+        abrir_ou_criar_arquivo(temporario);
+
+        FILE* arquivo = fopen(temporario, "rb+");
+        if (!arquivo) {
+                fclose(origem);
+                return ERRO_ARQUIVO_NULO;
+        }
+
+        size_t restaurados = 0;
+        int status = restaurar_instantaneo(origem, arquivo, &restaurados);
+        if (fclose(arquivo) != 0 && status == SUCESSO) status = ERRO_ARQUIVO_WRITE;
+        fclose(origem);
+
+        if (status == SUCESSO && rename(temporario, caminho) != 0) status = ERRO_ARQUIVO_WRITE;
+        if (status == SUCESSO)
+                printf("%zu livros restaurados de %s\n\n", restaurados, caminho_instantaneo);
+        else
+                remove(temporario);
+
+        return status;
+}
+
+/**
+ * @brief Solicita o nome do arquivo de saída e exporta todos os livros em CSV ou JSON Lines.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @return int Código de status da operação.
+ */
+int opcao_exportar_texto(const char* caminho) {
+        char nome_arquivo[256];
+        printf("Digite o nome do arquivo de saida (.csv, .txt ou .jsonl): ");
+        if (!fgets(nome_arquivo, sizeof(nome_arquivo), stdin)) return ERRO_ARQUIVO_TEXTO;
+        nome_arquivo[strcspn(nome_arquivo, "\n")] = '\0';
+
         printf("\n");
 
+        FILE* arquivo = fopen(caminho, "rb");
+        if (!arquivo) return ERRO_ARQUIVO_NULO;
+
+        FILE* destino = fopen(nome_arquivo, "w");
+        if (!destino) {
+                fclose(arquivo);
+                return ERRO_ARQUIVO_TEXTO;
+        }
+
+        RELATORIO_EXPORTACAO relatorio;
+        int status = travar_arquivo(arquivo, TRAVA_LEITURA);
+        if (status == SUCESSO) {
+                status = exportar_catalogo(arquivo, destino, formato_pelo_caminho(nome_arquivo),
+                                           &relatorio);
+                destravar_arquivo(arquivo, TRAVA_LEITURA);
+        }
+
+        if (fclose(destino) != 0 && status == SUCESSO) status = ERRO_ARQUIVO_WRITE;
+        fclose(arquivo);
+
+        if (status == SUCESSO) {
+                printf("%zu livros exportados para %s (%zu bytes em %.3f s)\n", relatorio.livros,
+                       nome_arquivo, relatorio.bytes, relatorio.segundos);
+                if (relatorio.campos_alterados > 0)
+                        printf("%zu campos tinham ';' ou caracteres de controle, trocados por "
+                               "espaco\n",
+                               relatorio.campos_alterados);
+                printf("\n");
+        }
+
+        return status;
+}
+
+/**
+ * @brief Mostra as estatísticas das operações em texto ou JSON e oferece zerá-las.
+ *
+ * @return int Código de status da operação.
+ */
+int opcao_exibir_estatisticas(void) {
+        printf("Formato (1 - texto, 2 - JSON): ");
+        size_t formato = ler_size_t();
+        printf("\n");
+
+        int status = imprimir_estatisticas(
+            stdout, formato == 2 ? ESTATISTICAS_JSON : ESTATISTICAS_TEXTO);
+        if (status != SUCESSO || !estatisticas_ativas()) return status;
+
+        printf("\nZerar os contadores? (1 - sim, 0 - nao): ");
+        if (ler_size_t() == 1) zerar_estatisticas();
+        printf("\n");
+        return SUCESSO;
+}
+
+/**
+ * @brief Mostra o diagnóstico da árvore e do arquivo em texto ou JSON.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @return int Código de status da operação.
+ */
+int opcao_diagnosticar_arvore(const char* caminho) {
+        printf("Formato (1 - texto, 2 - JSON): ");
+        size_t formato = ler_size_t();
+        printf("\n");
+
+        FILE* arquivo = fopen(caminho, "rb");
+        if (!arquivo) return ERRO_ARQUIVO_NULO;
+
+        DIAGNOSTICO_ARVORE diagnostico;
+        int status = travar_arquivo(arquivo, TRAVA_LEITURA);
+        if (status == SUCESSO) {
+                status = diagnosticar_arvore(arquivo, &diagnostico);
+                destravar_arquivo(arquivo, TRAVA_LEITURA);
+        }
+        fclose(arquivo);
+        if (status != SUCESSO) return status;
+
+        status = imprimir_diagnostico(stdout, &diagnostico,
+                                      formato == 2 ? DIAGNOSTICO_JSON : DIAGNOSTICO_TEXTO);
+        liberar_diagnostico(&diagnostico);
+        printf("\n");
         return status;
 }
+
+/**
+ * @brief Reescreve o arquivo como uma árvore balanceada e mostra o que mudou.
+ *
+ * @param caminho Caminho do arquivo binário com os livros.
+ * @return int Código de status da operação.
+ */
+int opcao_rebalancear_arquivo(const char* caminho) {
+        printf("Aviso: o arquivo sera trocado por uma copia. Outros processos passam a ela na\n"
+               "proxima operacao; leituras --cow ja abertas continuam vendo o arquivo antigo.\n");
+
+        RELATORIO_REBALANCEAMENTO relatorio;
+        int status = rebalancear_arquivo(caminho, &relatorio);
+        if (status != SUCESSO) return status;
+
+        printf("%zu livros regravados em %.3f s\n", relatorio.livros, relatorio.segundos);
+        printf("posicoes: %zu -> %zu\n", relatorio.posicoes_antes, relatorio.livros);
+        printf("altura:   %zu -> %zu\n\n", relatorio.altura_antes, relatorio.altura_depois);
+        return SUCESSO;
+}
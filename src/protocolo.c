@@ -0,0 +1,114 @@
+/**
+ * @file protocolo.c
+ * @brief Implementa o buffer de bytes e as regras de carga do protocolo binário.
+ */
+
+#include "../include/protocolo.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/erros.h"
+#include "../include/livro.h"
+
+/**
+ * @brief Garante espaço para mais `quantidade` bytes no fim do buffer.
+ *
+ * @param buffer Buffer a ampliar.
+ * @param quantidade Bytes que serão acrescentados.
+ * @return Ponteiro para o fim dos bytes válidos, ou NULL se faltar memória.
+ */
+unsigned char* reservar_buffer(BUFFER_BYTES* buffer, size_t quantidade) {
+        if (buffer->capacidade - buffer->tamanho >= quantidade)
+                return buffer->dados + buffer->tamanho;
+
+        // Reaproveita o espaço já consumido antes de pedir mais memória
+        if (buffer->inicio > 0) {
+                size_t pendentes = buffer->tamanho - buffer->inicio;
+                memmove(buffer->dados, buffer->dados + buffer->inicio, pendentes);
+                buffer->inicio = 0;
+                buffer->tamanho = pendentes;
+                if (buffer->capacidade - buffer->tamanho >= quantidade)
+                        return buffer->dados + buffer->tamanho;
+        }
+
+        size_t nova = buffer->capacidade ? buffer->capacidade : 4096;
+        while (nova - buffer->tamanho < quantidade) nova *= 2;
+
+        unsigned char* dados = realloc(buffer->dados, nova);
+        if (dados == NULL) return NULL;
+
+        buffer->dados = dados;
+        buffer->capacidade = nova;
+        return buffer->dados + buffer->tamanho;
+}
+
+/**
+ * @brief Acrescenta bytes ao fim do buffer.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+int acrescentar_buffer(BUFFER_BYTES* buffer, const void* dados, size_t quantidade) {
+        unsigned char* destino = reservar_buffer(buffer, quantidade);
+        if (destino == NULL) return ERRO_MEMORIA;
+
+        memcpy(destino, dados, quantidade);
+        buffer->tamanho += quantidade;
+        return SUCESSO;
+}
+
+/**
+ * @brief Quantidade de bytes ainda não consumidos.
+ */
+size_t pendentes_buffer(const BUFFER_BYTES* buffer) {
+        return buffer->tamanho - buffer->inicio;
+}
+
+/**
+ * @brief Marca `quantidade` bytes do início como consumidos.
+ */
+void consumir_buffer(BUFFER_BYTES* buffer, size_t quantidade) {
+        buffer->inicio += quantidade;
+        if (buffer->inicio == buffer->tamanho) {
+                buffer->inicio = 0;
+                buffer->tamanho = 0;
+        }
+}
+
+/**
+ * @brief Libera a memória do buffer e o deixa vazio.
+ */
+void liberar_buffer(BUFFER_BYTES* buffer) {
+        free(buffer->dados);
+        buffer->dados = NULL;
+        buffer->inicio = 0;
+        buffer->tamanho = 0;
+        buffer->capacidade = 0;
+}
+
+/**
+ * @brief Informa o tamanho de carga que um pedido da operação deve ter.
+ *
+ * @param operacao Operação do pedido.
+ * @param[out] tamanho Tamanho exigido.
+ * @return SUCESSO, ou ERRO_PROTOCOLO se a operação for desconhecida.
+ */
+int tamanho_carga_pedido(uint16_t operacao, uint32_t* tamanho) {
+        switch (operacao) {
+                case PEDIDO_BUSCAR:
+                case PEDIDO_REMOVER:
+                        *tamanho = sizeof(uint64_t);
+                        return SUCESSO;
+                case PEDIDO_INSERIR:
+                        *tamanho = sizeof(LIVRO);
+                        return SUCESSO;
+                case PEDIDO_INTERVALO:
+                        *tamanho = sizeof(DADOS_INTERVALO);
+                        return SUCESSO;
+                case PEDIDO_ESTATISTICAS:
+                        *tamanho = 0;
+                        return SUCESSO;
+                default:
+                        return ERRO_PROTOCOLO;
+        }
+}
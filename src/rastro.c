@@ -0,0 +1,182 @@
+/**
+ * @file rastro.c
+ * @brief Implementa o rastro de operações em anel, num arquivo mapeado em memória.
+ */
+
+#include "../include/rastro.h"
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/erros.h"
+#include "../include/utils.h"
+
+/**
+ * Rastro aberto.
+ */
+typedef struct {
+        CABECALHO_RASTRO* cabecalho; /**< Início do mapeamento. */
+        REGISTRO_RASTRO* registros;  /**< Anel, logo após o cabeçalho. */
+        size_t tamanho;              /**< Bytes mapeados. */
+        uint64_t abertura_ns;        /**< Relógio monotônico em abrir_rastro(). */
+} RASTRO;
+
+/// @brief Rastro aberto, ou NULL; lido sem trava por registrar_no_rastro().
+static RASTRO* _Atomic rastro_aberto = NULL;
+
+/// @brief Última sequência distribuída.
+static _Atomic uint64_t ultima_sequencia = 0;
+
+/**
+ * @brief Cria o arquivo do rastro e passa a registrar as operações.
+ *
+ * @param caminho Caminho do arquivo do rastro.
+ * @param capacidade Registros no anel (0 para o padrão).
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_WRITE ou ERRO_MEMORIA.
+ */
+int abrir_rastro(const char* caminho, size_t capacidade) {
+        if (caminho == NULL) return ERRO_ARQUIVO_NULO;
+        fechar_rastro();
+        if (capacidade == 0) capacidade = REGISTROS_RASTRO_PADRAO;
+
+        int descritor = open(caminho, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (descritor < 0) return ERRO_ARQUIVO_NULO;
+
+        // O arquivo nasce com o tamanho final e zerado: todas as posições vazias.
+        size_t tamanho = sizeof(CABECALHO_RASTRO) + capacidade * sizeof(REGISTRO_RASTRO);
+        if (ftruncate(descritor, (off_t)tamanho) != 0) {
+                close(descritor);
+                return ERRO_ARQUIVO_WRITE;
+        }
+        void* dados = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, descritor, 0);
+        close(descritor);
+        if (dados == MAP_FAILED) return ERRO_MEMORIA;
+
+        RASTRO* rastro = malloc(sizeof(RASTRO));
+        if (rastro == NULL) {
+                munmap(dados, tamanho);
+                return ERRO_MEMORIA;
+        }
+        rastro->cabecalho = dados;
+        rastro->registros = (REGISTRO_RASTRO*)(rastro->cabecalho + 1);
+        rastro->tamanho = tamanho;
+        rastro->abertura_ns = agora_ns();
+        rastro->cabecalho->magica = MAGICA_RASTRO;
+        rastro->cabecalho->versao = VERSAO_RASTRO;
+        rastro->cabecalho->capacidade = capacidade;
+
+        atomic_store(&ultima_sequencia, 0);
+        atomic_store(&rastro_aberto, rastro);
+        return SUCESSO;
+}
+
+/**
+ * @brief Para de registrar, grava o total no cabeçalho e desfaz o mapeamento.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_WRITE.
+ */
+int fechar_rastro(void) {
+        RASTRO* rastro = atomic_exchange(&rastro_aberto, NULL);
+        if (rastro == NULL) return SUCESSO;
+
+        rastro->cabecalho->gravados = atomic_load(&ultima_sequencia);
+        int status = msync(rastro->cabecalho, rastro->tamanho, MS_SYNC) == 0 ? SUCESSO
+                                                                              : ERRO_ARQUIVO_WRITE;
+        munmap(rastro->cabecalho, rastro->tamanho);
+        free(rastro);
+        return status;
+}
+
+/**
+ * @brief Diz se há um rastro aberto.
+ */
+int rastro_ativo(void) {
+        return atomic_load_explicit(&rastro_aberto, memory_order_relaxed) != NULL;
+}
+
+/**
+ * @brief Grava uma operação concluída no anel, se houver rastro aberto.
+ *
+ * @param registro Registro a gravar; sequência e início relativo são preenchidos aqui.
+ * @param inicio_ns Início da operação no relógio monotônico.
+ */
+void registrar_no_rastro(REGISTRO_RASTRO* registro, uint64_t inicio_ns) {
+        RASTRO* rastro = atomic_load_explicit(&rastro_aberto, memory_order_acquire);
+        if (rastro == NULL) return;
+
+        registro->sequencia =
+            atomic_fetch_add_explicit(&ultima_sequencia, 1, memory_order_relaxed) + 1;
+        registro->inicio_us =
+            inicio_ns > rastro->abertura_ns ? (inicio_ns - rastro->abertura_ns) / 1000 : 0;
+        registro->reservado = 0;
+        rastro->registros[(registro->sequencia - 1) % rastro->cabecalho->capacidade] = *registro;
+}
+
+/**
+ * @brief Ordena por sequência, para qsort().
+ */
+static int comparar_sequencias(const void* a, const void* b) {
+        uint64_t x = ((const REGISTRO_RASTRO*)a)->sequencia;
+        uint64_t y = ((const REGISTRO_RASTRO*)b)->sequencia;
+        return (x > y) - (x < y);
+}
+
+/**
+ * @brief Lê os registros ocupados de um arquivo de rastro, em ordem de sequência.
+ *
+ * @param caminho Caminho do arquivo do rastro.
+ * @param[out] registros Vetor alocado com os registros.
+ * @param[out] quantidade Registros lidos.
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_READ, ERRO_MEMORIA ou ERRO_FORMATO_RASTRO.
+ */
+int ler_rastro(const char* caminho, REGISTRO_RASTRO** registros, size_t* quantidade) {
+        if (caminho == NULL || registros == NULL || quantidade == NULL) return ERRO_ARQUIVO_NULO;
+        *registros = NULL;
+        *quantidade = 0;
+
+        FILE* arquivo = fopen(caminho, "rb");
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        CABECALHO_RASTRO cabecalho;
+        struct stat info;
+        if (fread(&cabecalho, sizeof(cabecalho), 1, arquivo) != 1 ||
+            fstat(fileno(arquivo), &info) != 0) {
+                fclose(arquivo);
+                return ERRO_FORMATO_RASTRO;
+        }
+        if (cabecalho.magica != MAGICA_RASTRO || cabecalho.versao != VERSAO_RASTRO ||
+            cabecalho.capacidade == 0 ||
+            (uint64_t)info.st_size !=
+                sizeof(cabecalho) + cabecalho.capacidade * sizeof(REGISTRO_RASTRO)) {
+                fclose(arquivo);
+                return ERRO_FORMATO_RASTRO;
+        }
+
+        REGISTRO_RASTRO* lidos = malloc(cabecalho.capacidade * sizeof(REGISTRO_RASTRO));
+        if (lidos == NULL) {
+                fclose(arquivo);
+                return ERRO_MEMORIA;
+        }
+        size_t capacidade = (size_t)cabecalho.capacidade;
+        if (fread(lidos, sizeof(REGISTRO_RASTRO), capacidade, arquivo) != capacidade) {
+                free(lidos);
+                fclose(arquivo);
+                return ERRO_ARQUIVO_READ;
+        }
+        fclose(arquivo);
+
+        size_t ocupados = 0;
+        for (size_t i = 0; i < capacidade; i++)
+                if (lidos[i].sequencia != 0) lidos[ocupados++] = lidos[i];
+        qsort(lidos, ocupados, sizeof(REGISTRO_RASTRO), comparar_sequencias);
+
+        *registros = lidos;
+        *quantidade = ocupados;
+        return SUCESSO;
+}
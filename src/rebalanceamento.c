@@ -0,0 +1,421 @@
+/**
+ * @file rebalanceamento.c
+ * @brief Implementa o rebalanceamento fora de linha do arquivo de livros e a migração do
+ * formato da versão 1.
+ */
+
+#include "../include/rebalanceamento.h"
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/concorrencia.h"
+#include "../include/erros.h"
+#include "../include/estatisticas.h"
+#include "../include/utils.h"
+
+/** Nós lidos ou gravados por chamada a ler_nos_arquivo() e escrever_nos(). */
+#define NOS_POR_BLOCO 1024
+
+/** Intervalos pendentes no cálculo da forma balanceada; basta um por nível. */
+#define NIVEIS_MAXIMOS 64
+
+/**
+ * Metadados das posições do original, em vetores paralelos.
+ *
+ * `esquerdo` e `direito` são indexados pela posição antiga; depois do percurso, `esquerdo`
+ * guarda o posto de cada nó vivo e `direito` é reaproveitado, indexado pelo posto.
+ */
+typedef struct {
+        size_t posicoes;       /**< Posições do arquivo original. */
+        size_t livros;         /**< Nós vivos. */
+        int* esquerdo;         /**< Filho esquerdo; depois, o posto do nó. */
+        int* direito;          /**< Filho direito; depois, o filho esquerdo novo de cada posto. */
+        int* filho_direito;    /**< Filho direito novo de cada posto. */
+        int* posicao_do_posto; /**< Posição nova de cada posto. */
+        uint8_t* vivo;         /**< Um bit por posição: alcançada a partir da raiz. */
+        void* memoria;         /**< Mapeamento do arquivo temporário com os vetores. */
+        size_t tamanho;        /**< Bytes de `memoria`. */
+} MAPA_REBALANCEAMENTO;
+
+/**
+ * Nó na pilha do percurso em ordem.
+ */
+typedef struct {
+        int posicao;           /**< Posição antiga. */
+        uint32_t profundidade; /**< 0 para a raiz. */
+} ITEM_PILHA;
+
+/**
+ * @brief Libera os vetores do mapa.
+ */
+static void liberar_mapa(MAPA_REBALANCEAMENTO* mapa) {
+        if (mapa->memoria != NULL) munmap(mapa->memoria, mapa->tamanho);
+        mapa->memoria = NULL;
+}
+
+/**
+ * @brief Cria os vetores do mapa para `posicoes` posições num arquivo temporário mapeado em
+ * memória.
+ *
+ * O arquivo fica ao lado do de livros (`<caminho>SUFIXO_MAPA_REBALANCEAMENTO`) e é apagado
+ * logo após ser aberto. Como o mapeamento é compartilhado com um arquivo, o kernel pode
+ * devolver as páginas dos vetores ao disco: a memória usada é limitada pelo cache de páginas,
+ * e não pelo tamanho do arquivo de livros. O arquivo começa esparso e zerado, o que já deixa
+ * `vivo` limpo.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO ou ERRO_MEMORIA.
+ */
+static int alocar_mapa(MAPA_REBALANCEAMENTO* mapa, size_t posicoes, const char* caminho) {
+        memset(mapa, 0, sizeof(*mapa));
+        mapa->posicoes = posicoes;
+        size_t n = posicoes ? posicoes : 1;
+        size_t vetor = n * sizeof(int);
+        mapa->tamanho = 4 * vetor + (n + 7) / 8;
+
+        char temporario[512];
+        snprintf(temporario, sizeof(temporario), "%s%s", caminho, SUFIXO_MAPA_REBALANCEAMENTO);
+        int descritor = open(temporario, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (descritor < 0) return ERRO_ARQUIVO_NULO;
+        unlink(temporario);
+
+        void* memoria = MAP_FAILED;
+        if (ftruncate(descritor, (off_t)mapa->tamanho) == 0)
+                memoria = mmap(NULL, mapa->tamanho, PROT_READ | PROT_WRITE, MAP_SHARED,
+                               descritor, 0);
+        close(descritor);
+        if (memoria == MAP_FAILED) return ERRO_MEMORIA;
+
+        unsigned char* base = memoria;
+        mapa->memoria = memoria;
+        mapa->esquerdo = (int*)base;
+        mapa->direito = (int*)(base + vetor);
+        mapa->filho_direito = (int*)(base + 2 * vetor);
+        mapa->posicao_do_posto = (int*)(base + 3 * vetor);
+        mapa->vivo = base + 4 * vetor;
+        return SUCESSO;
+}
+
+/**
+ * @brief Diz se a posição foi alcançada a partir da raiz.
+ */
+static int esta_vivo(const MAPA_REBALANCEAMENTO* mapa, size_t posicao) {
+        return mapa->vivo[posicao / 8] & (1u << (posicao % 8));
+}
+
+/**
+ * @brief Empilha `posicao` e a marca como viva, recusando elos fora do arquivo ou repetidos.
+ *
+ * @return SUCESSO, ERRO_NO_NULO ou ERRO_MEMORIA.
+ */
+static int empilhar(MAPA_REBALANCEAMENTO* mapa, ITEM_PILHA** pilha, size_t* topo,
+                    size_t* capacidade, int posicao, uint32_t profundidade) {
+        if (posicao < 0 || (size_t)posicao >= mapa->posicoes || esta_vivo(mapa, posicao))
+                return ERRO_NO_NULO;
+        mapa->vivo[posicao / 8] |= (uint8_t)(1u << (posicao % 8));
+
+        if (*topo == *capacidade) {
+                size_t nova = *capacidade ? *capacidade * 2 : 64;
+                ITEM_PILHA* maior = realloc(*pilha, nova * sizeof(ITEM_PILHA));
+                if (maior == NULL) return ERRO_MEMORIA;
+                *pilha = maior;
+                *capacidade = nova;
+        }
+        (*pilha)[(*topo)++] = (ITEM_PILHA){posicao, profundidade};
+        return SUCESSO;
+}
+
+/**
+ * @brief Percorre a árvore antiga em ordem, sem recursão, gravando em `esquerdo` o posto de
+ * cada nó vivo.
+ *
+ * A pilha guarda só o caminho até o nó corrente, e cresce até a altura da árvore.
+ *
+ * @param[out] altura Nós no caminho mais longo.
+ * @return SUCESSO, ERRO_NO_NULO ou ERRO_MEMORIA.
+ */
+static int numerar_em_ordem(MAPA_REBALANCEAMENTO* mapa, int raiz, size_t* altura) {
+        ITEM_PILHA* pilha = NULL;
+        size_t topo = 0, capacidade = 0;
+        int status = SUCESSO;
+        int atual = raiz;
+        uint32_t profundidade = 0;
+        *altura = 0;
+
+        while (status == SUCESSO && (atual != POSICAO_INVALIDA || topo > 0)) {
+                if (atual != POSICAO_INVALIDA) {
+                        status = empilhar(mapa, &pilha, &topo, &capacidade, atual, profundidade);
+                        if (status == SUCESSO) atual = mapa->esquerdo[atual];
+                        profundidade++;
+                        continue;
+                }
+
+                ITEM_PILHA item = pilha[--topo];
+                if (item.profundidade + 1 > *altura) *altura = item.profundidade + 1;
+                mapa->esquerdo[item.posicao] = (int)mapa->livros++;
+                atual = mapa->direito[item.posicao];
+                profundidade = item.profundidade + 1;
+        }
+
+        free(pilha);
+        return status;
+}
+
+/**
+ * @brief Posição nova da raiz da subárvore balanceada dos postos [`inicio`, `fim`).
+ */
+static int raiz_intervalo(const MAPA_REBALANCEAMENTO* mapa, size_t inicio, size_t fim) {
+        if (inicio >= fim) return POSICAO_INVALIDA;
+        return mapa->posicao_do_posto[inicio + (fim - inicio) / 2];
+}
+
+/**
+ * @brief Calcula as posições novas e os filhos de cada posto na árvore balanceada.
+ *
+ * Os vivos são numerados na ordem física do original; a forma é a de
+ * construir_arvore_em_bloco(): cada intervalo de postos tem a mediana como raiz. Os intervalos
+ * são visitados com uma pilha explícita, cada um uma vez.
+ *
+ * @return Posição nova da raiz.
+ */
+static int calcular_forma(MAPA_REBALANCEAMENTO* mapa) {
+        int nova = 0;
+        for (size_t posicao = 0; posicao < mapa->posicoes; posicao++)
+                if (esta_vivo(mapa, posicao))
+                        mapa->posicao_do_posto[mapa->esquerdo[posicao]] = nova++;
+
+        size_t pilha[NIVEIS_MAXIMOS][2];
+        size_t topo = 0;
+        if (mapa->livros > 0) {
+                pilha[0][0] = 0;
+                pilha[0][1] = mapa->livros;
+                topo = 1;
+        }
+        while (topo > 0) {
+                size_t inicio = pilha[topo - 1][0], fim = pilha[topo - 1][1];
+                size_t meio = inicio + (fim - inicio) / 2;
+                topo--;
+                mapa->direito[meio] = raiz_intervalo(mapa, inicio, meio);
+                mapa->filho_direito[meio] = raiz_intervalo(mapa, meio + 1, fim);
+                if (meio + 1 < fim) {
+                        pilha[topo][0] = meio + 1;
+                        pilha[topo++][1] = fim;
+                }
+                if (inicio < meio) {
+                        pilha[topo][0] = inicio;
+                        pilha[topo++][1] = meio;
+                }
+        }
+
+        return raiz_intervalo(mapa, 0, mapa->livros);
+}
+
+/**
+ * @brief Copia os nós vivos para `destino`, na ordem física do original, com os filhos novos.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_SEEK, ERRO_ARQUIVO_READ, ERRO_SOMA_PAGINA, ERRO_ARQUIVO_WRITE ou
+ *         ERRO_MEMORIA.
+ */
+static int copiar_vivos(FILE* origem, FILE* destino, const MAPA_REBALANCEAMENTO* mapa) {
+        NO_ARVORE* entrada = malloc(NOS_POR_BLOCO * sizeof(NO_ARVORE));
+        NO_ARVORE* saida = malloc(NOS_POR_BLOCO * sizeof(NO_ARVORE));
+        int status = entrada && saida ? SUCESSO : ERRO_MEMORIA;
+
+        size_t pendentes = 0, gravados = 0;
+        for (size_t inicio = 0; status == SUCESSO && inicio < mapa->posicoes;
+             inicio += NOS_POR_BLOCO) {
+                size_t pedir = mapa->posicoes - inicio;
+                if (pedir > NOS_POR_BLOCO) pedir = NOS_POR_BLOCO;
+                CONTAR_EVENTOS(EVENTO_LEITURA_NO, pedir);
+                status = ler_nos_arquivo(origem, (int)inicio, pedir, entrada);
+                if (status != SUCESSO) break;
+
+                for (size_t i = 0; i < pedir && status == SUCESSO; i++) {
+                        if (!esta_vivo(mapa, inicio + i)) continue;
+                        int posto = mapa->esquerdo[inicio + i];
+                        saida[pendentes].livro = entrada[i].livro;
+                        saida[pendentes].filho_esquerdo = mapa->direito[posto];
+                        saida[pendentes].filho_direito = mapa->filho_direito[posto];
+                        if (++pendentes < NOS_POR_BLOCO) continue;
+
+                        CONTAR_EVENTOS(EVENTO_ESCRITA_NO, pendentes);
+                        status = escrever_nos(destino, saida, (int)gravados, pendentes);
+                        gravados += pendentes;
+                        pendentes = 0;
+                }
+        }
+
+        if (status == SUCESSO && pendentes > 0) {
+                CONTAR_EVENTOS(EVENTO_ESCRITA_NO, pendentes);
+                status = escrever_nos(destino, saida, (int)gravados, pendentes);
+        }
+
+        free(entrada);
+        free(saida);
+        return status;
+}
+
+/**
+ * @brief Grava a árvore balanceada em `temporario` e a deixa no disco, pronta para a troca.
+ *
+ * @return SUCESSO ou código de erro.
+ */
+static int gravar_copia(FILE* original, const char* temporario, MAPA_REBALANCEAMENTO* mapa) {
+        FILE* copia = fopen(temporario, "wb+");
+        if (copia == NULL) return ERRO_ARQUIVO_NULO;
+
+        CABECALHO cabecalho = {POSICAO_INVALIDA, 0, POSICAO_INVALIDA, 0};
+        cabecalho.raiz = calcular_forma(mapa);
+        cabecalho.topo = (int)mapa->livros;
+        cabecalho.quantidade_livros = mapa->livros;
+
+        int status = copiar_vivos(original, copia, mapa);
+        // O cabeçalho vai por último: uma cópia interrompida nunca parece completa.
+        if (status == SUCESSO) status = escreve_cabecalho(copia, &cabecalho);
+        if (status == SUCESSO && (fflush(copia) != 0 || fsync(fileno(copia)) != 0))
+                status = ERRO_ARQUIVO_WRITE;
+        if (fclose(copia) != 0 && status == SUCESSO) status = ERRO_ARQUIVO_WRITE;
+        return status;
+}
+
+/**
+ * @brief Grava no disco a entrada do diretório de `caminho`, para que a troca feita com
+ * rename() sobreviva a uma queda do sistema.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_WRITE.
+ */
+static int sincronizar_diretorio(const char* caminho) {
+        char copia[512];
+        snprintf(copia, sizeof(copia), "%s", caminho);
+        int diretorio = open(dirname(copia), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (diretorio < 0) return ERRO_ARQUIVO_WRITE;
+
+        int status = fsync(diretorio) == 0 ? SUCESSO : ERRO_ARQUIVO_WRITE;
+        close(diretorio);
+        return status;
+}
+
+int rebalancear_arquivo(const char* caminho, RELATORIO_REBALANCEAMENTO* relatorio) {
+        double inicio = agora();
+        if (caminho == NULL) return ERRO_ARQUIVO_NULO;
+        FILE* original = fopen(caminho, "rb+");
+        if (original == NULL) return ERRO_ARQUIVO_NULO;
+        if (travar_arquivo(original, TRAVA_ESCRITA) != SUCESSO) {
+                fclose(original);
+                return ERRO_TRAVA;
+        }
+
+        RELATORIO_REBALANCEAMENTO local = {0};
+        MAPA_REBALANCEAMENTO mapa;
+        CABECALHO* cabecalho = le_cabecalho(original);
+        int status = cabecalho ? SUCESSO : ERRO_CABECALHO_NULO;
+        if (status == SUCESSO) {
+                local.posicoes_antes = (size_t)cabecalho->topo;
+                status = alocar_mapa(&mapa, local.posicoes_antes, caminho);
+        }
+
+        if (status == SUCESSO) {
+                status = ler_filhos_arquivo(original, mapa.posicoes, mapa.esquerdo, mapa.direito);
+                if (status == SUCESSO)
+                        status = numerar_em_ordem(&mapa, cabecalho->raiz, &local.altura_antes);
+
+                char temporario[512];
+                snprintf(temporario, sizeof(temporario), "%s%s", caminho,
+                         SUFIXO_REBALANCEAMENTO);
+                if (status == SUCESSO) status = gravar_copia(original, temporario, &mapa);
+                // A trava fica no arquivo antigo: quem esperava por ela a obtém depois da troca,
+                // percebe que o arquivo do seu handle ficou sem ligações e reabre o caminho
+                // (travar_arquivo(), concorrencia.h), em vez de gravar no arquivo antigo.
+                if (status == SUCESSO && rename(temporario, caminho) != 0)
+                        status = ERRO_ARQUIVO_WRITE;
+                if (status != SUCESSO)
+                        remove(temporario);
+                else
+                        status = sincronizar_diretorio(caminho);
+
+                local.livros = mapa.livros;
+                for (size_t nivel = local.livros; nivel > 0; nivel /= 2) local.altura_depois++;
+                liberar_mapa(&mapa);
+        }
+
+        free(cabecalho);
+        destravar_arquivo(original, TRAVA_ESCRITA);
+        fclose(original);
+
+        local.segundos = agora() - inicio;
+        if (status == SUCESSO && relatorio != NULL) *relatorio = local;
+        return status;
+}
+
+/**
+ * @brief Copia os nós de um arquivo da versão 1 para `temporario`, nas mesmas posições, e o
+ * deixa no disco, pronto para a troca.
+ *
+ * @return SUCESSO ou código de erro.
+ */
+static int gravar_migracao(FILE* original, const CABECALHO* cabecalho, const char* temporario) {
+        FILE* copia = fopen(temporario, "wb+");
+        if (copia == NULL) return ERRO_ARQUIVO_NULO;
+
+        NO_ARVORE* nos = malloc(NOS_POR_BLOCO * sizeof(NO_ARVORE));
+        int status = nos ? SUCESSO : ERRO_MEMORIA;
+        size_t topo = (size_t)cabecalho->topo;
+        for (size_t inicio = 0; status == SUCESSO && inicio < topo; inicio += NOS_POR_BLOCO) {
+                size_t pedir = topo - inicio;
+                if (pedir > NOS_POR_BLOCO) pedir = NOS_POR_BLOCO;
+                // Na versão 1, o nó `p` fica logo depois do cabeçalho, em p * sizeof(NO_ARVORE).
+                long deslocamento = (long)(sizeof(CABECALHO) + inicio * sizeof(NO_ARVORE));
+                if (fseek(original, deslocamento, SEEK_SET) != 0)
+                        status = ERRO_ARQUIVO_SEEK;
+                else if (fread(nos, sizeof(NO_ARVORE), pedir, original) != pedir)
+                        status = ERRO_ARQUIVO_READ;
+                else
+                        status = escrever_nos(copia, nos, (int)inicio, pedir);
+        }
+        free(nos);
+
+        // Como no rebalanceamento, o cabeçalho vai por último.
+        if (status == SUCESSO) status = escreve_cabecalho(copia, cabecalho);
+        if (status == SUCESSO && (fflush(copia) != 0 || fsync(fileno(copia)) != 0))
+                status = ERRO_ARQUIVO_WRITE;
+        if (fclose(copia) != 0 && status == SUCESSO) status = ERRO_ARQUIVO_WRITE;
+        return status;
+}
+
+int migrar_arquivo(const char* caminho, size_t* livros) {
+        if (caminho == NULL) return ERRO_ARQUIVO_NULO;
+        FILE* original = fopen(caminho, "rb+");
+        if (original == NULL) return ERRO_ARQUIVO_NULO;
+        if (travar_arquivo(original, TRAVA_ESCRITA) != SUCESSO) {
+                fclose(original);
+                return ERRO_TRAVA;
+        }
+
+        CABECALHO cabecalho;
+        int status = arquivo_formato_v1(original, &cabecalho) ? SUCESSO : ERRO_FORMATO_ARQUIVO;
+        if (status == SUCESSO) {
+                char temporario[512];
+                snprintf(temporario, sizeof(temporario), "%s%s", caminho, SUFIXO_MIGRACAO);
+                status = gravar_migracao(original, &cabecalho, temporario);
+                if (status == SUCESSO && rename(temporario, caminho) != 0)
+                        status = ERRO_ARQUIVO_WRITE;
+                if (status != SUCESSO)
+                        remove(temporario);
+                else
+                        status = sincronizar_diretorio(caminho);
+        }
+
+        // O arquivo travado é o antigo, da versão 1: destravar não grava nele o contador.
+        destravar_arquivo(original, TRAVA_ESCRITA);
+        fclose(original);
+
+        if (status == SUCESSO && livros != NULL) *livros = cabecalho.quantidade_livros;
+        return status;
+}
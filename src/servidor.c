@@ -0,0 +1,652 @@
+/**
+ * @file servidor.c
+ * @brief Implementa o servidor de consultas com laço de eventos epoll multi-thread.
+ */
+
+#define _GNU_SOURCE  // accept4
+
+#include "../include/servidor.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../include/acesso_direto.h"
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/concorrencia.h"
+#include "../include/erros.h"
+#include "../include/livro.h"
+#include "../include/protocolo.h"
+#include "../include/versoes.h"
+
+#define EVENTOS_POR_ESPERA 64          //!< Eventos tratados por chamada a epoll_wait
+#define BYTES_POR_LEITURA (64 * 1024)  //!< Bytes pedidos a cada recv
+#define LIMITE_ENTRADA (1024 * 1024)   //!< Entrada acumulada antes de processar e responder
+
+/**
+ * Cliente conectado.
+ */
+typedef struct CONEXAO {
+        int descritor;            /**< Socket do cliente. */
+        int leitura_encerrada;    /**< O cliente fechou o lado de escrita. */
+        BUFFER_BYTES entrada;     /**< Bytes recebidos ainda não processados. */
+        BUFFER_BYTES saida;       /**< Respostas ainda não enviadas. */
+        struct CONEXAO* anterior; /**< Lista de conexões abertas. */
+        struct CONEXAO* proxima;
+} CONEXAO;
+
+/**
+ * Thread do laço de eventos com o seu `FILE*` de leitura.
+ */
+typedef struct {
+        SERVIDOR* servidor;
+        FILE* leitor;
+        pthread_t thread;
+        int iniciada;
+} TRABALHADOR;
+
+struct SERVIDOR {
+        char caminho_socket[sizeof(((struct sockaddr_un*)0)->sun_path)];
+        int escuta;                    /**< Socket de escuta. */
+        int epoll;                     /**< Laço de eventos compartilhado. */
+        int parada;                    /**< eventfd sinalizado para encerrar as threads. */
+        FILE* escritor;                /**< Único `FILE*` usado para escrever. */
+        pthread_mutex_t mutex_escrita; /**< Serializa o uso de `escritor`. */
+        TRABALHADOR* trabalhadores;
+        int quantidade_trabalhadores;
+        pthread_mutex_t mutex_conexoes; /**< Protege `conexoes`. */
+        CONEXAO* conexoes;
+        atomic_ullong conexoes_ativas;
+        atomic_ullong conexoes_aceitas;
+        atomic_ullong pedidos_atendidos;
+        atomic_ullong pedidos_com_erro;
+};
+
+/// @brief Marcadores que identificam o socket de escuta e o eventfd no epoll.
+static char marca_escuta;
+static char marca_parada;
+
+/**
+ * @brief Arma (ou rearma) um descritor no epoll para um único evento.
+ */
+static int armar(SERVIDOR* servidor, int operacao, int descritor, uint32_t eventos, void* dado) {
+        struct epoll_event evento = {0};
+        evento.events = eventos | EPOLLONESHOT;
+        evento.data.ptr = dado;
+        return epoll_ctl(servidor->epoll, operacao, descritor, &evento) == 0 ? SUCESSO
+                                                                                : ERRO_CONEXAO;
+}
+
+/**
+ * @brief Fecha a conexão e a retira da lista do servidor.
+ */
+static void fechar_conexao(SERVIDOR* servidor, CONEXAO* conexao) {
+        pthread_mutex_lock(&servidor->mutex_conexoes);
+        if (conexao->anterior)
+                conexao->anterior->proxima = conexao->proxima;
+        else
+                servidor->conexoes = conexao->proxima;
+        if (conexao->proxima) conexao->proxima->anterior = conexao->anterior;
+        pthread_mutex_unlock(&servidor->mutex_conexoes);
+
+        close(conexao->descritor);  // também o retira do epoll
+        liberar_buffer(&conexao->entrada);
+        liberar_buffer(&conexao->saida);
+        free(conexao);
+        atomic_fetch_sub(&servidor->conexoes_ativas, 1);
+}
+
+/**
+ * @brief Aceita todas as conexões pendentes e rearma o socket de escuta.
+ */
+static void aceitar_conexoes(SERVIDOR* servidor) {
+        for (;;) {
+                int descritor = accept4(servidor->escuta, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (descritor < 0) {
+                        if (errno == EINTR) continue;
+                        break;  // EAGAIN: nada mais a aceitar
+                }
+
+                CONEXAO* conexao = calloc(1, sizeof(CONEXAO));
+                if (conexao == NULL) {
+                        close(descritor);
+                        continue;
+                }
+                conexao->descritor = descritor;
+
+                pthread_mutex_lock(&servidor->mutex_conexoes);
+                conexao->proxima = servidor->conexoes;
+                if (servidor->conexoes) servidor->conexoes->anterior = conexao;
+                servidor->conexoes = conexao;
+                pthread_mutex_unlock(&servidor->mutex_conexoes);
+
+                atomic_fetch_add(&servidor->conexoes_ativas, 1);
+                atomic_fetch_add(&servidor->conexoes_aceitas, 1);
+
+                if (armar(servidor, EPOLL_CTL_ADD, descritor, EPOLLIN | EPOLLRDHUP, conexao) !=
+                    SUCESSO)
+                        fechar_conexao(servidor, conexao);
+        }
+
+        armar(servidor, EPOLL_CTL_MOD, servidor->escuta, EPOLLIN, &marca_escuta);
+}
+
+/**
+ * @brief Abre uma leitura da árvore: uma versão no modo copy-on-write ou a trava compartilhada.
+ *
+ * @param leitor `FILE*` de leitura da thread.
+ * @param[out] versao Raiz e quantidade de livros visíveis para a leitura.
+ * @return SUCESSO ou o erro de abrir_versao()/travar_arquivo()/le_cabecalho().
+ */
+static int iniciar_leitura(FILE* leitor, VERSAO_ARVORE* versao) {
+        if (modo_cow_ativo()) return abrir_versao(leitor, versao);
+
+        int status = travar_arquivo(leitor, TRAVA_LEITURA);
+        if (status != SUCESSO) return status;
+
+        CABECALHO* cabecalho = le_cabecalho(leitor);
+        if (cabecalho == NULL) {
+                destravar_arquivo(leitor, TRAVA_LEITURA);
+                return ERRO_CABECALHO_NULO;
+        }
+
+        versao->raiz = cabecalho->raiz;
+        versao->quantidade = cabecalho->quantidade_livros;
+        versao->numero = 0;
+        versao->descritor = -1;
+        free(cabecalho);
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Encerra a leitura aberta com iniciar_leitura().
+ */
+static void encerrar_leitura(FILE* leitor, VERSAO_ARVORE* versao) {
+        if (modo_cow_ativo())
+                fechar_versao(versao);
+        else
+                destravar_arquivo(leitor, TRAVA_LEITURA);
+}
+
+/**
+ * Estado do visitante de PEDIDO_INTERVALO.
+ */
+typedef struct {
+        BUFFER_BYTES* saida;
+        uint32_t quantidade;
+        uint32_t limite;
+} CONTEXTO_INTERVALO;
+
+/// @brief Código positivo que o visitante devolve para interromper o percurso sem erro.
+#define INTERVALO_COMPLETO 1
+
+/**
+ * @brief Visitante que acrescenta cada livro do intervalo à resposta.
+ */
+static int acrescentar_livro_intervalo(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)posicao;
+        CONTEXTO_INTERVALO* intervalo = contexto;
+
+        if (acrescentar_buffer(intervalo->saida, &no->livro, sizeof(LIVRO)) != SUCESSO)
+                return ERRO_MEMORIA;
+
+        return ++intervalo->quantidade < intervalo->limite ? SUCESSO : INTERVALO_COMPLETO;
+}
+
+/**
+ * @brief Acrescenta à saída os livros de um intervalo, precedidos da quantidade.
+ */
+static int responder_intervalo(FILE* leitor, const DADOS_INTERVALO* dados, BUFFER_BYTES* saida) {
+        CONTEXTO_INTERVALO intervalo = {saida, 0, dados->limite};
+        if (intervalo.limite == 0 || intervalo.limite > LIMITE_INTERVALO)
+                intervalo.limite = LIMITE_INTERVALO;
+
+        size_t deslocamento = pendentes_buffer(saida);
+        if (acrescentar_buffer(saida, &intervalo.quantidade, sizeof(uint32_t)) != SUCESSO)
+                return ERRO_MEMORIA;
+
+        VERSAO_ARVORE versao;
+        int status = iniciar_leitura(leitor, &versao);
+        if (status != SUCESSO) return status;
+
+        status = percorrer_intervalo_em_ordem(leitor, versao.raiz, dados->inicio, dados->fim,
+                                              acrescentar_livro_intervalo, &intervalo);
+        encerrar_leitura(leitor, &versao);
+        if (status == INTERVALO_COMPLETO) status = SUCESSO;
+
+        // A posição é relativa a `inicio`, pois o buffer pode ter sido compactado
+        memcpy(saida->dados + saida->inicio + deslocamento, &intervalo.quantidade,
+               sizeof(uint32_t));
+        return status;
+}
+
+/**
+ * @brief Executa um pedido e acrescenta a resposta completa à saída da conexão.
+ *
+ * @return SUCESSO, ou ERRO_MEMORIA se a resposta não couber na memória (encerra a conexão).
+ */
+static int executar_pedido(TRABALHADOR* trabalhador, const CABECALHO_PEDIDO* pedido,
+                           const unsigned char* carga, BUFFER_BYTES* saida) {
+        SERVIDOR* servidor = trabalhador->servidor;
+        FILE* leitor = trabalhador->leitor;
+
+        CABECALHO_RESPOSTA resposta = {pedido->id, SUCESSO, 0};
+        size_t deslocamento = pendentes_buffer(saida);
+        if (acrescentar_buffer(saida, &resposta, sizeof(resposta)) != SUCESSO) return ERRO_MEMORIA;
+
+        uint32_t esperado = 0;
+        int status = tamanho_carga_pedido(pedido->operacao, &esperado);
+        if (status == SUCESSO && pedido->tamanho != esperado) status = ERRO_PROTOCOLO;
+
+        uint64_t codigo = 0;
+        if (status == SUCESSO &&
+            (pedido->operacao == PEDIDO_BUSCAR || pedido->operacao == PEDIDO_REMOVER))
+                memcpy(&codigo, carga, sizeof(codigo));
+
+        VERSAO_ARVORE versao;
+        LIVRO livro;
+
+        if (status == SUCESSO) {
+                switch (pedido->operacao) {
+                        case PEDIDO_BUSCAR:
+                                status = iniciar_leitura(leitor, &versao);
+                                if (status != SUCESSO) break;
+                                status = buscar_na_versao(leitor, &versao, codigo, &livro);
+                                encerrar_leitura(leitor, &versao);
+                                if (status == SUCESSO)
+                                        status = acrescentar_buffer(saida, &livro, sizeof(LIVRO));
+                                break;
+                        case PEDIDO_INSERIR:
+                                memcpy(&livro, carga, sizeof(LIVRO));
+                                pthread_mutex_lock(&servidor->mutex_escrita);
+                                status = cadastrar_livro_concorrente(servidor->escritor, livro);
+                                pthread_mutex_unlock(&servidor->mutex_escrita);
+                                break;
+                        case PEDIDO_REMOVER:
+                                pthread_mutex_lock(&servidor->mutex_escrita);
+                                status = remover_no_arvore_concorrente(servidor->escritor, codigo);
+                                pthread_mutex_unlock(&servidor->mutex_escrita);
+                                break;
+                        case PEDIDO_INTERVALO: {
+                                DADOS_INTERVALO dados;
+                                memcpy(&dados, carga, sizeof(dados));
+                                status = responder_intervalo(leitor, &dados, saida);
+                                break;
+                        }
+                        case PEDIDO_ESTATISTICAS: {
+                                status = iniciar_leitura(leitor, &versao);
+                                if (status != SUCESSO) break;
+                                encerrar_leitura(leitor, &versao);
+
+                                ESTATISTICAS_SERVIDOR estatisticas;
+                                estatisticas.quantidade_livros = versao.quantidade;
+                                estatisticas.conexoes_ativas = servidor->conexoes_ativas;
+                                estatisticas.conexoes_aceitas = servidor->conexoes_aceitas;
+                                estatisticas.pedidos_atendidos = servidor->pedidos_atendidos;
+                                estatisticas.pedidos_com_erro = servidor->pedidos_com_erro;
+                                status = acrescentar_buffer(saida, &estatisticas,
+                                                            sizeof(estatisticas));
+                                break;
+                        }
+                }
+        }
+
+        atomic_fetch_add(&servidor->pedidos_atendidos, 1);
+        if (status != SUCESSO) atomic_fetch_add(&servidor->pedidos_com_erro, 1);
+
+        size_t inicio_resposta = saida->inicio + deslocamento;
+        if (status == ERRO_MEMORIA) {
+                saida->tamanho = inicio_resposta;
+                return ERRO_MEMORIA;
+        }
+
+        // Em caso de erro, descarta a carga parcial e devolve só o status
+        if (status != SUCESSO) saida->tamanho = inicio_resposta + sizeof(resposta);
+
+        resposta.status = status;
+        resposta.tamanho = (uint32_t)(saida->tamanho - inicio_resposta - sizeof(resposta));
+        memcpy(saida->dados + inicio_resposta, &resposta, sizeof(resposta));
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Executa todos os pedidos completos da entrada, na ordem de chegada.
+ *
+ * @return SUCESSO, ou ERRO_PROTOCOLO/ERRO_MEMORIA se a conexão deve ser encerrada.
+ */
+static int processar_pedidos(TRABALHADOR* trabalhador, CONEXAO* conexao) {
+        BUFFER_BYTES* entrada = &conexao->entrada;
+
+        while (pendentes_buffer(entrada) >= sizeof(CABECALHO_PEDIDO)) {
+                CABECALHO_PEDIDO pedido;
+                memcpy(&pedido, entrada->dados + entrada->inicio, sizeof(pedido));
+                if (pedido.tamanho > TAMANHO_MAXIMO_CARGA) return ERRO_PROTOCOLO;
+
+                size_t total = sizeof(pedido) + pedido.tamanho;
+                if (pendentes_buffer(entrada) < total) break;
+
+                const unsigned char* carga = entrada->dados + entrada->inicio + sizeof(pedido);
+                int status = executar_pedido(trabalhador, &pedido, carga, &conexao->saida);
+                if (status != SUCESSO) return status;
+
+                consumir_buffer(entrada, total);
+        }
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Recebe o que estiver disponível no socket, até LIMITE_ENTRADA bytes acumulados.
+ *
+ * @return SUCESSO, ou ERRO_CONEXAO/ERRO_MEMORIA se a conexão deve ser encerrada.
+ */
+static int receber_pedidos(CONEXAO* conexao) {
+        while (!conexao->leitura_encerrada &&
+               pendentes_buffer(&conexao->entrada) < LIMITE_ENTRADA) {
+                unsigned char* destino = reservar_buffer(&conexao->entrada, BYTES_POR_LEITURA);
+                if (destino == NULL) return ERRO_MEMORIA;
+
+                ssize_t lidos = recv(conexao->descritor, destino, BYTES_POR_LEITURA, 0);
+                if (lidos > 0) {
+                        conexao->entrada.tamanho += (size_t)lidos;
+                } else if (lidos == 0) {
+                        conexao->leitura_encerrada = 1;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        break;
+                } else if (errno != EINTR) {
+                        return ERRO_CONEXAO;
+                }
+        }
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Envia o quanto o socket aceitar das respostas pendentes.
+ *
+ * @return SUCESSO ou ERRO_CONEXAO.
+ */
+static int enviar_respostas(CONEXAO* conexao) {
+        BUFFER_BYTES* saida = &conexao->saida;
+
+        while (pendentes_buffer(saida) > 0) {
+                ssize_t enviados = send(conexao->descritor, saida->dados + saida->inicio,
+                                        pendentes_buffer(saida), MSG_NOSIGNAL);
+                if (enviados > 0) {
+                        consumir_buffer(saida, (size_t)enviados);
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        break;
+                } else if (errno != EINTR) {
+                        return ERRO_CONEXAO;
+                }
+        }
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Atende um evento de uma conexão: lê, executa os pedidos completos e responde.
+ *
+ * Enquanto houver respostas que o cliente ainda não leu, a conexão só é rearmada para escrita,
+ * o que impede um cliente lento de acumular pedidos sem limite.
+ */
+static void atender_conexao(TRABALHADOR* trabalhador, CONEXAO* conexao, uint32_t eventos) {
+        SERVIDOR* servidor = trabalhador->servidor;
+        int status = SUCESSO;
+
+        if (eventos & (EPOLLERR | EPOLLHUP)) status = ERRO_CONEXAO;
+        if (status == SUCESSO && pendentes_buffer(&conexao->saida) == 0)
+                status = receber_pedidos(conexao);
+        if (status == SUCESSO) status = processar_pedidos(trabalhador, conexao);
+        if (status == SUCESSO) status = enviar_respostas(conexao);
+
+        int pendente = pendentes_buffer(&conexao->saida) > 0;
+        if (status != SUCESSO || (conexao->leitura_encerrada && !pendente)) {
+                fechar_conexao(servidor, conexao);
+                return;
+        }
+
+        uint32_t interesse = pendente ? EPOLLOUT : EPOLLIN | EPOLLRDHUP;
+        if (armar(servidor, EPOLL_CTL_MOD, conexao->descritor, interesse, conexao) != SUCESSO)
+                fechar_conexao(servidor, conexao);
+}
+
+/**
+ * @brief Laço de eventos executado por cada thread do servidor.
+ */
+static void* executar_trabalhador(void* argumento) {
+        TRABALHADOR* trabalhador = argumento;
+        SERVIDOR* servidor = trabalhador->servidor;
+        struct epoll_event eventos[EVENTOS_POR_ESPERA];
+
+        for (;;) {
+                int quantidade = epoll_wait(servidor->epoll, eventos, EVENTOS_POR_ESPERA, -1);
+                if (quantidade < 0) {
+                        if (errno == EINTR) continue;
+                        break;
+                }
+
+                for (int i = 0; i < quantidade; i++) {
+                        void* dado = eventos[i].data.ptr;
+                        if (dado == &marca_parada) return NULL;
+
+                        if (dado == &marca_escuta)
+                                aceitar_conexoes(servidor);
+                        else
+                                atender_conexao(trabalhador, dado, eventos[i].events);
+                }
+        }
+
+        return NULL;
+}
+
+/**
+ * @brief Libera tudo o que o servidor tiver aberto (as threads já devem ter terminado).
+ */
+static void liberar_servidor(SERVIDOR* servidor) {
+        while (servidor->conexoes) fechar_conexao(servidor, servidor->conexoes);
+
+        for (int i = 0; i < servidor->quantidade_trabalhadores; i++) {
+                if (servidor->trabalhadores[i].leitor == NULL) continue;
+                fechar_acesso_direto(servidor->trabalhadores[i].leitor);
+                fclose(servidor->trabalhadores[i].leitor);
+        }
+        free(servidor->trabalhadores);
+
+        if (servidor->escuta >= 0) {
+                close(servidor->escuta);
+                unlink(servidor->caminho_socket);
+        }
+        if (servidor->parada >= 0) close(servidor->parada);
+        if (servidor->epoll >= 0) close(servidor->epoll);
+        if (servidor->escritor) {
+                fechar_acesso_direto(servidor->escritor);
+                fclose(servidor->escritor);
+        }
+
+        pthread_mutex_destroy(&servidor->mutex_escrita);
+        pthread_mutex_destroy(&servidor->mutex_conexoes);
+        free(servidor);
+}
+
+/**
+ * @brief Cria o socket de escuta no caminho informado.
+ *
+ * @return SUCESSO ou ERRO_CONEXAO.
+ */
+static int criar_escuta(SERVIDOR* servidor, const char* caminho_socket) {
+        struct sockaddr_un endereco = {0};
+        endereco.sun_family = AF_UNIX;
+        if (strlen(caminho_socket) >= sizeof(endereco.sun_path)) return ERRO_CONEXAO;
+        strcpy(endereco.sun_path, caminho_socket);
+
+        servidor->escuta = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (servidor->escuta < 0) return ERRO_CONEXAO;
+        strcpy(servidor->caminho_socket, caminho_socket);
+
+        unlink(caminho_socket);
+        if (bind(servidor->escuta, (struct sockaddr*)&endereco, sizeof(endereco)) != 0 ||
+            listen(servidor->escuta, SOMAXCONN) != 0)
+                return ERRO_CONEXAO;
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Associa o escritor e os leitores ao mesmo pool do acesso direto (acesso_direto.h).
+ *
+ * Sem o pool, o servidor só fica mais lento: uma falha aqui não impede a partida.
+ */
+static void associar_acesso_direto(SERVIDOR* servidor, const char* caminho_livros) {
+        if (travar_arquivo(servidor->escritor, TRAVA_LEITURA) != SUCESSO) return;
+        int status =
+            abrir_acesso_direto(servidor->escritor, caminho_livros, paginas_acesso_direto());
+        destravar_arquivo(servidor->escritor, TRAVA_LEITURA);
+        if (status != SUCESSO) return;
+
+        for (int i = 0; i < servidor->quantidade_trabalhadores; i++)
+                abrir_acesso_direto(servidor->trabalhadores[i].leitor, caminho_livros,
+                                    paginas_acesso_direto());
+}
+
+/**
+ * @brief Abre o arquivo de livros, cria o socket e inicia as threads do laço de eventos.
+ *
+ * @param caminho_livros Caminho do arquivo binário de livros (já inicializado).
+ * @param caminho_socket Caminho do socket de domínio Unix a criar.
+ * @param quantidade_threads Threads que atendem conexões (no mínimo 1).
+ * @return Servidor em execução, ou NULL em caso de erro.
+ */
+SERVIDOR* iniciar_servidor(const char* caminho_livros, const char* caminho_socket,
+                           int quantidade_threads) {
+        if (caminho_livros == NULL || caminho_socket == NULL) return NULL;
+        if (quantidade_threads < 1) quantidade_threads = 1;
+
+        SERVIDOR* servidor = calloc(1, sizeof(SERVIDOR));
+        if (servidor == NULL) return NULL;
+
+        servidor->escuta = -1;
+        servidor->epoll = -1;
+        servidor->parada = -1;
+        pthread_mutex_init(&servidor->mutex_escrita, NULL);
+        pthread_mutex_init(&servidor->mutex_conexoes, NULL);
+
+        servidor->trabalhadores = calloc((size_t)quantidade_threads, sizeof(TRABALHADOR));
+        servidor->escritor = fopen(caminho_livros, "rb+");
+        if (servidor->trabalhadores == NULL || servidor->escritor == NULL) {
+                liberar_servidor(servidor);
+                return NULL;
+        }
+
+        servidor->quantidade_trabalhadores = quantidade_threads;
+        for (int i = 0; i < quantidade_threads; i++) {
+                servidor->trabalhadores[i].servidor = servidor;
+                servidor->trabalhadores[i].leitor = fopen(caminho_livros, "rb");
+                if (servidor->trabalhadores[i].leitor == NULL) {
+                        liberar_servidor(servidor);
+                        return NULL;
+                }
+        }
+        if (paginas_acesso_direto() > 0) associar_acesso_direto(servidor, caminho_livros);
+
+        servidor->epoll = epoll_create1(EPOLL_CLOEXEC);
+        servidor->parada = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (servidor->epoll < 0 || servidor->parada < 0 ||
+            criar_escuta(servidor, caminho_socket) != SUCESSO ||
+            armar(servidor, EPOLL_CTL_ADD, servidor->escuta, EPOLLIN, &marca_escuta) != SUCESSO) {
+                liberar_servidor(servidor);
+                return NULL;
+        }
+
+        // O eventfd fica sempre legível depois de sinalizado e acorda todas as threads
+        struct epoll_event evento = {0};
+        evento.events = EPOLLIN;
+        evento.data.ptr = &marca_parada;
+        if (epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, servidor->parada, &evento) != 0) {
+                liberar_servidor(servidor);
+                return NULL;
+        }
+
+        for (int i = 0; i < quantidade_threads; i++) {
+                TRABALHADOR* trabalhador = &servidor->trabalhadores[i];
+                if (pthread_create(&trabalhador->thread, NULL, executar_trabalhador, trabalhador) !=
+                    0) {
+                        parar_servidor(servidor);
+                        return NULL;
+                }
+                trabalhador->iniciada = 1;
+        }
+
+        return servidor;
+}
+
+/**
+ * @brief Encerra as threads, fecha as conexões e remove o socket.
+ *
+ * @param servidor Servidor devolvido por iniciar_servidor(); é liberado.
+ */
+void parar_servidor(SERVIDOR* servidor) {
+        if (servidor == NULL) return;
+
+        uint64_t sinal = 1;
+        if (write(servidor->parada, &sinal, sizeof(sinal)) != sizeof(sinal)) {
+                // Só falha se o contador transbordar, e nesse caso já está sinalizado
+        }
+
+        for (int i = 0; i < servidor->quantidade_trabalhadores; i++) {
+                if (servidor->trabalhadores[i].iniciada)
+                        pthread_join(servidor->trabalhadores[i].thread, NULL);
+        }
+
+        liberar_servidor(servidor);
+}
+
+/**
+ * @brief Executa o servidor até receber SIGINT ou SIGTERM.
+ *
+ * @param caminho_livros Caminho do arquivo binário de livros.
+ * @param caminho_socket Caminho do socket de domínio Unix.
+ * @param quantidade_threads Threads que atendem conexões.
+ * @return SUCESSO, ou ERRO_CONEXAO se o servidor não puder ser iniciado.
+ */
+int executar_servidor(const char* caminho_livros, const char* caminho_socket,
+                      int quantidade_threads) {
+        // Os sinais ficam bloqueados em todas as threads e são esperados só por esta
+        sigset_t sinais, anteriores;
+        sigemptyset(&sinais);
+        sigaddset(&sinais, SIGINT);
+        sigaddset(&sinais, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &sinais, &anteriores);
+
+        SERVIDOR* servidor = iniciar_servidor(caminho_livros, caminho_socket, quantidade_threads);
+        if (servidor == NULL) {
+                pthread_sigmask(SIG_SETMASK, &anteriores, NULL);
+                return ERRO_CONEXAO;
+        }
+
+        printf("Servidor atendendo em %s com %d threads (Ctrl+C para encerrar).\n",
+               caminho_socket, quantidade_threads < 1 ? 1 : quantidade_threads);
+        fflush(stdout);
+
+        int sinal;
+        sigwait(&sinais, &sinal);
+
+        parar_servidor(servidor);
+        pthread_sigmask(SIG_SETMASK, &anteriores, NULL);
+        printf("Servidor encerrado.\n");
+
+        return SUCESSO;
+}
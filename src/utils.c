@@ -6,12 +6,11 @@
 #include "../include/utils.h"
 
 #include <ctype.h>
-#include <errno.h>
-#include <float.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 /**
  * @brief Limpa a tela do terminal.
@@ -32,68 +31,136 @@ void limpar_tela(void) {
 #endif
 }
 
+/** Algarismos que sempre cabem em size_t, dispensando o teste de estouro. */
+#define ALGARISMOS_SEGUROS (sizeof(size_t) >= 8 ? 19 : 9)
+
+/** Potências de 10 representadas exatamente em double. */
+static const double potencias_de_10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                         1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                         1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
 /**
- * @brief Verifica se o restante da string após conversão numérica contém apenas espaços ou fim de
- * linha.
+ * @brief Converte um inteiro sem sinal escrito só com dígitos decimais.
+ *
+ * Até ALGARISMOS_SEGUROS dígitos o laço não precisa testar estouro; só números maiores pagam
+ * pela verificação a cada dígito.
  *
- * @param endptr Ponteiro para o caractere após a parte numérica da string.
- * @return int Retorna 1 se o resto for válido, 0 caso contrário.
+ * @param texto Primeiro caractere do número.
+ * @param tamanho Quantidade de caracteres.
+ * @param[out] valor Valor convertido (só alterado em caso de sucesso).
+ * @return int 1 se o texto é um número válido, 0 caso contrário.
  */
-static int resto_eh_valido(char* endptr) {
-        while (isspace((unsigned char)*endptr)) {
-                endptr++;
+int converter_size_t(const char* texto, size_t tamanho, size_t* valor) {
+        if (tamanho == 0) return 0;
+
+        size_t resultado = 0;
+        if (tamanho <= ALGARISMOS_SEGUROS) {
+                for (size_t i = 0; i < tamanho; i++) {
+                        unsigned digito = (unsigned)(unsigned char)texto[i] - '0';
+                        if (digito > 9) return 0;
+                        resultado = resultado * 10 + digito;
+                }
+        } else {
+                for (size_t i = 0; i < tamanho; i++) {
+                        unsigned digito = (unsigned)(unsigned char)texto[i] - '0';
+                        if (digito > 9 || resultado > (SIZE_MAX - digito) / 10) return 0;
+                        resultado = resultado * 10 + digito;
+                }
         }
-        return (*endptr == '\0' || *endptr == '\n');
+
+        *valor = resultado;
+        return 1;
 }
 
 /**
- * @brief Lê um valor do tipo size_t da entrada padrão de forma segura e validada.
+ * @brief Converte um preço decimal não negativo, com vírgula ou ponto como separador.
  *
- * @return size_t Valor lido convertido.
+ * Os algarismos formam uma mantissa inteira e o preço é mantissa / 10^casas. Com mantissa
+ * até 2^53, os dois operandos são exatos e a divisão dá o double mais próximo.
+ *
+ * @param texto Primeiro caractere do número.
+ * @param tamanho Quantidade de caracteres.
+ * @param[out] valor Valor convertido (só alterado em caso de sucesso).
+ * @return int 1 se o texto é um preço válido, 0 caso contrário.
  */
-size_t ler_size_t(void) {
-        char buffer[100];
-        char* endptr;
-        unsigned long long valor;
+int converter_preco(const char* texto, size_t tamanho, double* valor) {
+        unsigned long long mantissa = 0;
+        size_t algarismos = 0;  // Algarismos significativos já na mantissa.
+        size_t casas = 0;       // Casas decimais já na mantissa (no máximo 22).
+        int digitos = 0;
+        int separador = 0;
+
+        for (size_t i = 0; i < tamanho; i++) {
+                char c = texto[i];
+                if (c == ',' || c == '.') {
+                        if (separador) return 0;
+                        separador = 1;
+                        continue;
+                }
 
-        if (!fgets(buffer, sizeof(buffer), stdin)) {
-                fprintf(stderr, "Erro de leitura.\n");
-                exit(EXIT_FAILURE);
-        }
+                unsigned digito = (unsigned)(unsigned char)c - '0';
+                if (digito > 9) return 0;
+                digitos = 1;
 
-        // Se for negativo, retorna 0
-        if (buffer[0] == '-') {
-                return 0;
+                if (algarismos < 19 && casas < 22) {
+                        mantissa = mantissa * 10 + digito;
+                        if (mantissa > 0) algarismos++;
+                        if (separador) casas++;
+                } else if (!separador) {
+                        return 0;  // Parte inteira grande demais.
+                }
         }
+        if (!digitos) return 0;
 
-        errno = 0;
-        valor = strtoull(buffer, &endptr, 10);
-
-        if (errno == ERANGE || valor > SIZE_MAX) {
-                return 0;
-        }
+        // Acima de 2^53 a conversão da mantissa arredonda: erro de no máximo 1 ulp.
+        *valor = (double)mantissa / potencias_de_10[casas];
+        return 1;
+}
 
-        if (endptr == buffer) {
-                return 0;
-        }
+/**
+ * @brief Lê uma linha da entrada padrão e devolve o trecho sem espaços nas pontas.
+ *
+ * @return int 1 se uma linha foi lida, 0 no fim da entrada ou em erro de leitura.
+ */
+static int ler_linha_aparada(char* buffer, size_t capacidade, const char** texto,
+                             size_t* tamanho) {
+        if (!fgets(buffer, (int)capacidade, stdin)) return 0;
+
+        const char* inicio = buffer;
+        const char* fim = buffer + strlen(buffer);
+        while (inicio < fim && isspace((unsigned char)*inicio)) inicio++;
+        while (fim > inicio && isspace((unsigned char)fim[-1])) fim--;
+
+        *texto = inicio;
+        *tamanho = (size_t)(fim - inicio);
+        return 1;
+}
 
-        while (isspace((unsigned char)*endptr)) {
-                endptr++;
-        }
+/**
+ * @brief Lê um valor do tipo size_t da entrada padrão de forma segura e validada.
+ *
+ * @return size_t Valor lido convertido, ou 0 se a entrada não for um número válido.
+ */
+size_t ler_size_t(void) {
+        char buffer[100];
+        const char* texto;
+        size_t tamanho;
+        size_t valor;
 
-        if (*endptr != '\0' && *endptr != '\n') {
-                return 0;
+        if (!ler_linha_aparada(buffer, sizeof(buffer), &texto, &tamanho)) {
+                fprintf(stderr, "Erro de leitura.\n");
+                exit(EXIT_FAILURE);
         }
 
-        return (size_t)valor;
+        return converter_size_t(texto, tamanho, &valor) ? valor : 0;
 }
 
 /**
  * @brief Lê um valor do tipo size_t da entrada padrão de forma segura e validada.
  *
- * Esta função lê uma linha da entrada padrão, remove o caractere de nova linha,
+ * Esta função lê uma linha da entrada padrão, descarta espaços nas pontas,
  * verifica se o conteúdo é um número inteiro não negativo válido (incluindo zero),
- * e converte para size_t.
+ * e converte para size_t com converter_size_t().
  *
  * A função rejeita números negativos, entradas inválidas (letras, símbolos, etc),
  * valores que excedam o máximo permitido para size_t e retorna sucesso ou falha.
@@ -104,70 +171,38 @@ size_t ler_size_t(void) {
  */
 int ler_size_t_com_zero(size_t* saida) {
         char buffer[64];
-        char* endptr;
-        unsigned long long valor;
+        const char* texto;
+        size_t tamanho;
 
-        if (!fgets(buffer, sizeof(buffer), stdin)) {
+        if (!ler_linha_aparada(buffer, sizeof(buffer), &texto, &tamanho)) {
                 return 0;  // erro de leitura
         }
 
-        buffer[strcspn(buffer, "\n")] = '\0';
-
-        if (buffer[0] == '-') {
-                return 0;  // rejeita número negativo
-        }
-
-        errno = 0;
-        valor = strtoull(buffer, &endptr, 10);
-
-        if (endptr == buffer || errno == ERANGE) {
-                return 0;  // erro na conversão
-        }
-
-        while (isspace((unsigned char)*endptr)) {
-                endptr++;
-        }
-
-        if (*endptr != '\0') {
-                return 0;  // caracteres inválidos após número
-        }
-
-        if (valor > SIZE_MAX) {
-                return 0;  // valor maior que size_t máximo
-        }
-
-        *saida = (size_t)valor;
-        return 1;  // sucesso
+        return converter_size_t(texto, tamanho, saida);
 }
 
 /**
- * @brief Lê um valor do tipo double da entrada padrão de forma segura e validada.
+ * @brief Lê um preço da entrada padrão de forma segura e validada.
+ *
+ * Repete a leitura até receber um valor aceito por converter_preco() (vírgula ou ponto como
+ * separador decimal).
  *
  * @return double Valor lido convertido.
  */
 double ler_double(void) {
         char buffer[128];
-        char* endptr;
-        double v;
+        const char* texto;
+        size_t tamanho;
+        double valor;
 
         while (1) {
-                if (!fgets(buffer, sizeof(buffer), stdin)) {
+                if (!ler_linha_aparada(buffer, sizeof(buffer), &texto, &tamanho)) {
                         fprintf(stderr, "Erro de leitura.\n");
                         exit(EXIT_FAILURE);
                 }
 
-                errno = 0;
-                v = strtod(buffer, &endptr);
-
-                if (errno == ERANGE || v > DBL_MAX || v < -DBL_MAX) {
-                        printf("Fora do intervalo de double.\n");
-                        continue;
-                }
-                if (endptr == buffer || !resto_eh_valido(endptr)) {
-                        printf("Entrada inválida.\n");
-                        continue;
-                }
-                return v;
+                if (converter_preco(texto, tamanho, &valor)) return valor;
+                printf("Entrada inválida.\n");
         }
 }
 
@@ -199,3 +234,36 @@ void trim(char* str) {
         // Copiar resultado para o início da string
         if (str != inicio) memmove(str, inicio, fim - inicio + 2);  // +2 pra incluir '\0'
 }
+
+/**
+ * @brief Espalha os bits de um código de livro (finalizador do splitmix64).
+ *
+ * @param codigo Código do livro.
+ * @return Hash de 64 bits do código.
+ */
+uint64_t espalhar_codigo(size_t codigo) {
+        uint64_t x = (uint64_t)codigo + 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+}
+
+/**
+ * @brief Segundos de um relógio monotônico.
+ *
+ * @return Instante atual em segundos, a partir de uma origem arbitrária.
+ */
+double agora(void) {
+        return (double)agora_ns() / 1e9;
+}
+
+/**
+ * @brief Nanossegundos de um relógio monotônico.
+ *
+ * @return Instante atual em nanossegundos, a partir de uma origem arbitrária.
+ */
+uint64_t agora_ns(void) {
+        struct timespec instante;
+        clock_gettime(CLOCK_MONOTONIC, &instante);
+        return (uint64_t)instante.tv_sec * 1000000000u + (uint64_t)instante.tv_nsec;
+}
@@ -0,0 +1,364 @@
+/**
+ * @file varredura.c
+ * @brief Implementa a busca vetorizada de delimitadores e espaços.
+ *
+ * As versões SSE2 e AVX2 são compiladas com `__attribute__((target))`, sem exigir flags de
+ * compilação, e só são chamadas se __builtin_cpu_supports() confirmar a extensão.
+ *
+ * O último bloco, incompleto, é lido inteiro quando não cruza o fim de uma página (a leitura
+ * não pode falhar, e os bytes além de `fim` são descartados pela máscara); quando cruza, vai
+ * para a versão escalar. Como essa leitura passa do fim do buffer, as funções vetoriais ficam
+ * fora da instrumentação do AddressSanitizer.
+ */
+
+#include "../include/varredura.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VARREDURA_X86 1
+#include <immintrin.h>
+#endif
+
+/** Menor página de memória das plataformas suportadas. */
+#define TAMANHO_PAGINA 4096
+
+/**
+ * Bytes procurados por uma varredura.
+ */
+typedef enum {
+        ALVO_QUEBRA,    /**< `\n`. */
+        ALVO_SEPARADOR, /**< `;`. */
+        ALVO_TEXTO,     /**< Qualquer byte que não seja espaço. */
+} ALVO_VARREDURA;
+
+/**
+ * Funções de uma implementação.
+ */
+typedef struct {
+        const char* (*quebra)(const char*, const char*);
+        const char* (*texto)(const char*, const char*);
+        size_t (*separadores)(const char*, const char*, const char**, size_t);
+} FUNCOES_VARREDURA;
+
+/**
+ * @brief Espaço em branco no sentido de isspace() no locale "C".
+ */
+static inline int eh_espaco(char c) {
+        return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+/**
+ * @brief Verifica se o byte é um dos procurados.
+ */
+static inline int eh_alvo(char c, ALVO_VARREDURA alvo) {
+        switch (alvo) {
+                case ALVO_QUEBRA:
+                        return c == '\n';
+                case ALVO_SEPARADOR:
+                        return c == ';';
+                default:
+                        return !eh_espaco(c);
+        }
+}
+
+static inline const char* buscar_escalar(const char* inicio, const char* fim,
+                                         ALVO_VARREDURA alvo) {
+        for (const char* p = inicio; p < fim; p++) {
+                if (eh_alvo(*p, alvo)) return p;
+        }
+        return NULL;
+}
+
+static const char* quebra_escalar(const char* inicio, const char* fim) {
+        return buscar_escalar(inicio, fim, ALVO_QUEBRA);
+}
+
+static const char* texto_escalar(const char* inicio, const char* fim) {
+        return buscar_escalar(inicio, fim, ALVO_TEXTO);
+}
+
+static size_t separadores_escalar(const char* inicio, const char* fim, const char** posicoes,
+                                  size_t maximo) {
+        size_t encontrados = 0;
+        for (const char* p = inicio; p < fim && encontrados < maximo; p++) {
+                if (*p == ';') posicoes[encontrados++] = p;
+        }
+        return encontrados;
+}
+
+static const FUNCOES_VARREDURA funcoes_escalar = {quebra_escalar, texto_escalar,
+                                                  separadores_escalar};
+
+#ifdef VARREDURA_X86
+
+/**
+ * @brief Verifica se `tamanho` bytes a partir de `p` ficam na mesma página.
+ */
+static inline int cabe_na_pagina(const char* p, size_t tamanho) {
+        return ((uintptr_t)p & (TAMANHO_PAGINA - 1)) <= TAMANHO_PAGINA - tamanho;
+}
+
+#define VETORIAL_SSE2 __attribute__((target("sse2"), no_sanitize_address))
+#define VETORIAL_AVX2 __attribute__((target("avx2"), no_sanitize_address))
+
+/*
+ * Espaço é ' ' ou um byte em ['\t', '\r']: subtraindo '\t', o intervalo vira [0, 4], e
+ * min(x, 4) == x testa isso sem comparação com sinal.
+ */
+
+/**
+ * @brief Máscara (um bit por byte) dos bytes procurados em 16 bytes a partir de `p`.
+ */
+VETORIAL_SSE2 static inline unsigned mascara_sse2(const char* p, ALVO_VARREDURA alvo) {
+        __m128i bloco = _mm_loadu_si128((const __m128i*)p);
+        __m128i iguais;
+
+        if (alvo == ALVO_QUEBRA) {
+                iguais = _mm_cmpeq_epi8(bloco, _mm_set1_epi8('\n'));
+        } else if (alvo == ALVO_SEPARADOR) {
+                iguais = _mm_cmpeq_epi8(bloco, _mm_set1_epi8(';'));
+        } else {
+                __m128i deslocado = _mm_sub_epi8(bloco, _mm_set1_epi8('\t'));
+                __m128i faixa = _mm_set1_epi8('\r' - '\t');
+                __m128i controle = _mm_cmpeq_epi8(_mm_min_epu8(deslocado, faixa), deslocado);
+                __m128i espaco =
+                    _mm_or_si128(controle, _mm_cmpeq_epi8(bloco, _mm_set1_epi8(' ')));
+                return ~(unsigned)_mm_movemask_epi8(espaco) & 0xFFFFu;
+        }
+        return (unsigned)_mm_movemask_epi8(iguais);
+}
+
+VETORIAL_SSE2 static inline const char* buscar_sse2(const char* inicio, const char* fim,
+                                                    ALVO_VARREDURA alvo) {
+        const char* p = inicio;
+        for (; fim - p >= 16; p += 16) {
+                unsigned mascara = mascara_sse2(p, alvo);
+                if (mascara) return p + __builtin_ctz(mascara);
+        }
+        if (p == fim) return NULL;
+        if (!cabe_na_pagina(p, 16)) return buscar_escalar(p, fim, alvo);
+
+        unsigned mascara = mascara_sse2(p, alvo) & ((1u << (fim - p)) - 1);
+        return mascara ? p + __builtin_ctz(mascara) : NULL;
+}
+
+VETORIAL_SSE2 static const char* quebra_sse2(const char* inicio, const char* fim) {
+        return buscar_sse2(inicio, fim, ALVO_QUEBRA);
+}
+
+VETORIAL_SSE2 static const char* texto_sse2(const char* inicio, const char* fim) {
+        return buscar_sse2(inicio, fim, ALVO_TEXTO);
+}
+
+VETORIAL_SSE2 static size_t separadores_sse2(const char* inicio, const char* fim,
+                                             const char** posicoes, size_t maximo) {
+        size_t encontrados = 0;
+        for (const char* p = inicio; p < fim && encontrados < maximo; p += 16) {
+                unsigned mascara;
+                if (fim - p >= 16) {
+                        mascara = mascara_sse2(p, ALVO_SEPARADOR);
+                } else if (cabe_na_pagina(p, 16)) {
+                        mascara = mascara_sse2(p, ALVO_SEPARADOR) & ((1u << (fim - p)) - 1);
+                } else {
+                        return encontrados +
+                               separadores_escalar(p, fim, posicoes + encontrados,
+                                                   maximo - encontrados);
+                }
+
+                for (; mascara && encontrados < maximo; mascara &= mascara - 1)
+                        posicoes[encontrados++] = p + __builtin_ctz(mascara);
+        }
+        return encontrados;
+}
+
+/**
+ * @brief Máscara (um bit por byte) dos bytes procurados em 32 bytes a partir de `p`.
+ */
+VETORIAL_AVX2 static inline unsigned mascara_avx2(const char* p, ALVO_VARREDURA alvo) {
+        __m256i bloco = _mm256_loadu_si256((const __m256i*)p);
+        __m256i iguais;
+
+        if (alvo == ALVO_QUEBRA) {
+                iguais = _mm256_cmpeq_epi8(bloco, _mm256_set1_epi8('\n'));
+        } else if (alvo == ALVO_SEPARADOR) {
+                iguais = _mm256_cmpeq_epi8(bloco, _mm256_set1_epi8(';'));
+        } else {
+                __m256i deslocado = _mm256_sub_epi8(bloco, _mm256_set1_epi8('\t'));
+                __m256i faixa = _mm256_set1_epi8('\r' - '\t');
+                __m256i controle =
+                    _mm256_cmpeq_epi8(_mm256_min_epu8(deslocado, faixa), deslocado);
+                __m256i espaco =
+                    _mm256_or_si256(controle, _mm256_cmpeq_epi8(bloco, _mm256_set1_epi8(' ')));
+                return ~(unsigned)_mm256_movemask_epi8(espaco);
+        }
+        return (unsigned)_mm256_movemask_epi8(iguais);
+}
+
+VETORIAL_AVX2 static inline const char* buscar_avx2(const char* inicio, const char* fim,
+                                                    ALVO_VARREDURA alvo) {
+        const char* p = inicio;
+        for (; fim - p >= 32; p += 32) {
+                unsigned mascara = mascara_avx2(p, alvo);
+                if (mascara) return p + __builtin_ctz(mascara);
+        }
+        if (p == fim) return NULL;
+        if (!cabe_na_pagina(p, 32)) return buscar_sse2(p, fim, alvo);
+
+        unsigned mascara = mascara_avx2(p, alvo) & ((1u << (fim - p)) - 1);
+        return mascara ? p + __builtin_ctz(mascara) : NULL;
+}
+
+VETORIAL_AVX2 static const char* quebra_avx2(const char* inicio, const char* fim) {
+        return buscar_avx2(inicio, fim, ALVO_QUEBRA);
+}
+
+VETORIAL_AVX2 static const char* texto_avx2(const char* inicio, const char* fim) {
+        return buscar_avx2(inicio, fim, ALVO_TEXTO);
+}
+
+VETORIAL_AVX2 static size_t separadores_avx2(const char* inicio, const char* fim,
+                                             const char** posicoes, size_t maximo) {
+        size_t encontrados = 0;
+        for (const char* p = inicio; p < fim && encontrados < maximo; p += 32) {
+                unsigned mascara;
+                if (fim - p >= 32) {
+                        mascara = mascara_avx2(p, ALVO_SEPARADOR);
+                } else if (cabe_na_pagina(p, 32)) {
+                        mascara = mascara_avx2(p, ALVO_SEPARADOR) & ((1u << (fim - p)) - 1);
+                } else {
+                        return encontrados + separadores_sse2(p, fim, posicoes + encontrados,
+                                                              maximo - encontrados);
+                }
+
+                for (; mascara && encontrados < maximo; mascara &= mascara - 1)
+                        posicoes[encontrados++] = p + __builtin_ctz(mascara);
+        }
+        return encontrados;
+}
+
+static const FUNCOES_VARREDURA funcoes_sse2 = {quebra_sse2, texto_sse2, separadores_sse2};
+static const FUNCOES_VARREDURA funcoes_avx2 = {quebra_avx2, texto_avx2, separadores_avx2};
+
+#endif  // VARREDURA_X86
+
+static pthread_once_t varredura_iniciada = PTHREAD_ONCE_INIT;
+static const FUNCOES_VARREDURA* funcoes = &funcoes_escalar;
+static IMPLEMENTACAO_VARREDURA ativa = VARREDURA_ESCALAR;
+
+/**
+ * @brief Verifica se a CPU suporta a implementação.
+ */
+static int suportada(IMPLEMENTACAO_VARREDURA implementacao) {
+        switch (implementacao) {
+                case VARREDURA_ESCALAR:
+                        return 1;
+#ifdef VARREDURA_X86
+                case VARREDURA_SSE2:
+                        return __builtin_cpu_supports("sse2");
+                case VARREDURA_AVX2:
+                        return __builtin_cpu_supports("avx2");
+#endif
+                default:
+                        return 0;
+        }
+}
+
+/**
+ * @brief Passa a usar a implementação (já verificada por suportada()).
+ */
+static void usar(IMPLEMENTACAO_VARREDURA implementacao) {
+#ifdef VARREDURA_X86
+        if (implementacao == VARREDURA_AVX2)
+                funcoes = &funcoes_avx2;
+        else if (implementacao == VARREDURA_SSE2)
+                funcoes = &funcoes_sse2;
+        else
+                funcoes = &funcoes_escalar;
+#endif
+        ativa = implementacao;
+}
+
+/**
+ * @brief Escolhe a melhor implementação suportada pela CPU.
+ */
+static void escolher_varredura(void) {
+#ifdef VARREDURA_X86
+        __builtin_cpu_init();
+#endif
+        if (suportada(VARREDURA_AVX2))
+                usar(VARREDURA_AVX2);
+        else if (suportada(VARREDURA_SSE2))
+                usar(VARREDURA_SSE2);
+}
+
+/**
+ * @brief Primeira quebra de linha (`\n`) em [`inicio`, `fim`).
+ *
+ * @return Ponteiro para o byte encontrado, ou NULL.
+ */
+const char* buscar_quebra(const char* inicio, const char* fim) {
+        pthread_once(&varredura_iniciada, escolher_varredura);
+        return funcoes->quebra(inicio, fim);
+}
+
+/**
+ * @brief Posições dos primeiros `;` em [`inicio`, `fim`).
+ *
+ * @return Quantidade de posições gravadas (no máximo `maximo`).
+ */
+size_t buscar_separadores(const char* inicio, const char* fim, const char** posicoes,
+                          size_t maximo) {
+        pthread_once(&varredura_iniciada, escolher_varredura);
+        return funcoes->separadores(inicio, fim, posicoes, maximo);
+}
+
+/**
+ * @brief Primeiro byte que não é espaço em [`inicio`, `fim`).
+ *
+ * @return Ponteiro para o byte encontrado, ou `fim` se só houver espaços.
+ */
+const char* pular_espacos(const char* inicio, const char* fim) {
+        pthread_once(&varredura_iniciada, escolher_varredura);
+        const char* texto = funcoes->texto(inicio, fim);
+        return texto ? texto : fim;
+}
+
+/**
+ * @brief Implementação em uso.
+ */
+IMPLEMENTACAO_VARREDURA varredura_ativa(void) {
+        pthread_once(&varredura_iniciada, escolher_varredura);
+        return ativa;
+}
+
+/**
+ * @brief Força uma implementação (para comparação e testes).
+ *
+ * Não deve ser chamada enquanto outra thread estiver importando.
+ *
+ * @return 1 se a CPU suporta a implementação e ela passou a ser usada, 0 caso contrário.
+ */
+int definir_varredura(IMPLEMENTACAO_VARREDURA implementacao) {
+        pthread_once(&varredura_iniciada, escolher_varredura);
+        if (!suportada(implementacao)) return 0;
+
+        usar(implementacao);
+        return 1;
+}
+
+/**
+ * @brief Nome legível da implementação ("escalar", "sse2" ou "avx2").
+ */
+const char* nome_varredura(IMPLEMENTACAO_VARREDURA implementacao) {
+        switch (implementacao) {
+                case VARREDURA_SSE2:
+                        return "sse2";
+                case VARREDURA_AVX2:
+                        return "avx2";
+                default:
+                        return "escalar";
+        }
+}
@@ -0,0 +1,866 @@
+/**
+ * @file versoes.c
+ * @brief Implementa o modo copy-on-write da árvore e o controle de versões abertas.
+ */
+
+#define _GNU_SOURCE  // F_OFD_SETLK
+
+#include "../include/versoes.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/acesso_direto.h"
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/concorrencia.h"
+#include "../include/erros.h"
+#include "../include/estatisticas.h"
+#include "../include/filtro.h"
+#include "../include/indice.h"
+
+/**
+ * Nó substituído por uma versão nova e ainda não devolvido à lista livre.
+ */
+typedef struct {
+        int32_t posicao;    /**< Posição do nó no arquivo. */
+        uint32_t reservado; /**< Zerado. */
+        uint64_t versao;    /**< Primeira versão que não alcança mais o nó. */
+} NO_APOSENTADO;
+
+/** Nós aposentados guardados em cada bloco da lista. */
+#define APOSENTADOS_POR_BLOCO ((sizeof(NO_ARVORE) - 4 * sizeof(uint32_t)) / sizeof(NO_APOSENTADO))
+
+/**
+ * Bloco da lista de aposentados, gravado numa posição de nó do próprio arquivo.
+ */
+typedef struct {
+        uint32_t inicio;                            /**< Primeiro item ainda não recuperado. */
+        uint32_t fim;                               /**< Itens gravados. */
+        int32_t proximo;                            /**< Próximo bloco, ou POSICAO_INVALIDA. */
+        uint32_t reservado;                         /**< Zerado. */
+        NO_APOSENTADO itens[APOSENTADOS_POR_BLOCO]; /**< Nós aposentados, do mais antigo. */
+} BLOCO_APOSENTADOS;
+
+_Static_assert(sizeof(BLOCO_APOSENTADOS) <= sizeof(NO_ARVORE),
+               "um bloco de aposentados deve caber numa posição de nó");
+
+/**
+ * Primeiro e último blocos da lista de aposentados, como gravados na página 0: posição mais
+ * um, e 0 com a lista vazia (a página 0 de um arquivo novo é toda zerada).
+ */
+typedef struct {
+        int32_t primeiro; /**< Bloco mais antigo. */
+        int32_t ultimo;   /**< Bloco que recebe os próximos nós. */
+} LISTA_APOSENTADOS;
+
+/**
+ * Lista de posições que cresce conforme necessário.
+ */
+typedef struct {
+        int* itens;
+        size_t* codigos; /**< Código do livro de cada posição (só nos nós gravados). */
+        size_t tamanho;
+        size_t capacidade;
+} LISTA_POSICOES;
+
+/**
+ * Nó visitado no caminho a partir da raiz, junto com sua posição.
+ */
+typedef struct {
+        NO_ARVORE no;
+        int posicao;
+} ITEM_CAMINHO;
+
+/**
+ * Caminho a partir da raiz, em ordem de profundidade.
+ */
+typedef struct {
+        ITEM_CAMINHO* itens;
+        size_t tamanho;
+        size_t capacidade;
+} CAMINHO;
+
+/// @brief Indica se o menu deve usar as operações copy-on-write.
+static int cow_ativo = 0;
+
+/**
+ * @brief Ativa ou desativa o modo copy-on-write para as operações do menu.
+ *
+ * @param ativo Diferente de zero para ativar.
+ */
+void definir_modo_cow(int ativo) {
+        cow_ativo = ativo != 0;
+}
+
+/**
+ * @brief Informa se o modo copy-on-write está ativo.
+ *
+ * @return 1 se ativo, 0 caso contrário.
+ */
+int modo_cow_ativo(void) {
+        return cow_ativo;
+}
+
+/**
+ * @brief Acrescenta uma posição à lista, aumentando-a se necessário.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+static int adicionar_posicao(LISTA_POSICOES* lista, int posicao) {
+        if (lista->tamanho == lista->capacidade) {
+                size_t nova = lista->capacidade ? lista->capacidade * 2 : 32;
+                int* itens = realloc(lista->itens, nova * sizeof(int));
+                if (itens == NULL) return ERRO_MEMORIA;
+                lista->itens = itens;
+                lista->capacidade = nova;
+        }
+        lista->itens[lista->tamanho++] = posicao;
+        return SUCESSO;
+}
+
+/**
+ * @brief Acrescenta à lista de nós gravados a posição e o código do livro do nó.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+static int adicionar_gravado(LISTA_POSICOES* lista, int posicao, size_t codigo) {
+        if (lista->tamanho == lista->capacidade) {
+                size_t nova = lista->capacidade ? lista->capacidade * 2 : 32;
+                size_t* codigos = realloc(lista->codigos, nova * sizeof(size_t));
+                if (codigos == NULL) return ERRO_MEMORIA;
+                lista->codigos = codigos;
+        }
+        int status = adicionar_posicao(lista, posicao);
+        if (status == SUCESSO) lista->codigos[lista->tamanho - 1] = codigo;
+        return status;
+}
+
+/**
+ * @brief Aponta o índice (indice.h) para as cópias publicadas: todo livro copiado mudou de nó.
+ */
+static void indexar_gravados(FILE* arquivo, const LISTA_POSICOES* gravados) {
+        for (size_t i = 0; i < gravados->tamanho; i++)
+                registrar_posicao_no_indice(arquivo, gravados->codigos[i], gravados->itens[i]);
+}
+
+/**
+ * @brief Lê o nó em `posicao` e o acrescenta ao caminho.
+ *
+ * @return SUCESSO, ERRO_NO_NULO ou ERRO_MEMORIA.
+ */
+static int empilhar_no(FILE* arquivo, CAMINHO* caminho, int posicao) {
+        if (caminho->tamanho == caminho->capacidade) {
+                size_t nova = caminho->capacidade ? caminho->capacidade * 2 : 32;
+                ITEM_CAMINHO* itens = realloc(caminho->itens, nova * sizeof(ITEM_CAMINHO));
+                if (itens == NULL) return ERRO_MEMORIA;
+                caminho->itens = itens;
+                caminho->capacidade = nova;
+        }
+
+        NO_ARVORE* no = ler_no_arquivo(arquivo, posicao);
+        if (no == NULL) return ERRO_NO_NULO;
+
+        caminho->itens[caminho->tamanho].no = *no;
+        caminho->itens[caminho->tamanho].posicao = posicao;
+        caminho->tamanho++;
+        free(no);
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê da página 0 o primeiro e o último blocos da lista de aposentados.
+ *
+ * @param[out] primeiro Bloco mais antigo, ou POSICAO_INVALIDA.
+ * @param[out] ultimo Bloco mais novo, ou POSICAO_INVALIDA.
+ * @return SUCESSO ou ERRO_ARQUIVO_READ.
+ */
+static int ler_lista_aposentados(FILE* arquivo, int* primeiro, int* ultimo) {
+        LISTA_APOSENTADOS lista = {0};
+        ssize_t lidos = pread(fileno(arquivo), &lista, sizeof(lista), DESLOCAMENTO_APOSENTADOS);
+        if (lidos < 0) return ERRO_ARQUIVO_READ;
+        if (lidos != (ssize_t)sizeof(lista)) lista = (LISTA_APOSENTADOS){0};
+
+        *primeiro = lista.primeiro - 1;
+        *ultimo = lista.ultimo - 1;
+        return SUCESSO;
+}
+
+/**
+ * @brief Grava na página 0 o primeiro e o último blocos da lista de aposentados.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_WRITE.
+ */
+static int gravar_lista_aposentados(FILE* arquivo, int primeiro, int ultimo) {
+        if (fflush(arquivo) != 0) return ERRO_ARQUIVO_WRITE;
+
+        LISTA_APOSENTADOS lista = {.primeiro = primeiro + 1, .ultimo = ultimo + 1};
+        if (pwrite(fileno(arquivo), &lista, sizeof(lista), DESLOCAMENTO_APOSENTADOS) !=
+            (ssize_t)sizeof(lista))
+                return ERRO_ARQUIVO_WRITE;
+        return SUCESSO;
+}
+
+/**
+ * @brief Lê o bloco de aposentados da posição `posicao`.
+ *
+ * @return SUCESSO ou ERRO_NO_NULO.
+ */
+static int ler_bloco(FILE* arquivo, int posicao, BLOCO_APOSENTADOS* bloco) {
+        NO_ARVORE* no = ler_no_arquivo(arquivo, posicao);
+        if (no == NULL) return ERRO_NO_NULO;
+        memcpy(bloco, no, sizeof(*bloco));
+        free(no);
+        return SUCESSO;
+}
+
+/**
+ * @brief Copia o bloco para um nó zerado, no formato gravado no arquivo.
+ */
+static NO_ARVORE no_do_bloco(const BLOCO_APOSENTADOS* bloco) {
+        NO_ARVORE no;
+        memset(&no, 0, sizeof(no));
+        memcpy(&no, bloco, sizeof(*bloco));
+        return no;
+}
+
+/**
+ * @brief Grava o bloco de aposentados na posição `posicao`.
+ *
+ * @return SUCESSO ou erros de escrever_no().
+ */
+static int gravar_bloco(FILE* arquivo, int posicao, const BLOCO_APOSENTADOS* bloco) {
+        NO_ARVORE no = no_do_bloco(bloco);
+        return escrever_no(arquivo, &no, posicao);
+}
+
+/**
+ * @brief Acrescenta os nós substituídos ao fim da lista de aposentados do arquivo.
+ *
+ * Os blocos novos são tirados da lista livre; o cabeçalho é gravado antes da página 0 apontar
+ * para eles, de modo que uma interrupção no meio só deixe de recuperar alguns nós.
+ *
+ * @param versao Primeira versão que não alcança os nós.
+ * @return SUCESSO ou erros de arquivo.
+ */
+static int aposentar(FILE* arquivo, CABECALHO* cabecalho, const LISTA_POSICOES* substituidos,
+                     uint64_t versao) {
+        int primeiro, ultimo;
+        int status = ler_lista_aposentados(arquivo, &primeiro, &ultimo);
+        if (status != SUCESSO) return status;
+
+        BLOCO_APOSENTADOS bloco = {0};
+        if (ultimo != POSICAO_INVALIDA) status = ler_bloco(arquivo, ultimo, &bloco);
+
+        int alocou = 0;
+        for (size_t i = 0; status == SUCESSO && i < substituidos->tamanho; i++) {
+                if (ultimo == POSICAO_INVALIDA || bloco.fim == APOSENTADOS_POR_BLOCO) {
+                        BLOCO_APOSENTADOS novo = {.proximo = POSICAO_INVALIDA};
+                        NO_ARVORE no = no_do_bloco(&novo);
+                        int posicao;
+                        status = alocar_no_arquivo(arquivo, cabecalho, &no, &posicao);
+                        if (status != SUCESSO) break;
+                        alocou = 1;
+
+                        if (ultimo == POSICAO_INVALIDA) {
+                                primeiro = posicao;
+                        } else {
+                                bloco.proximo = posicao;
+                                status = gravar_bloco(arquivo, ultimo, &bloco);
+                        }
+                        ultimo = posicao;
+                        bloco = novo;
+                }
+                bloco.itens[bloco.fim].posicao = substituidos->itens[i];
+                bloco.itens[bloco.fim].versao = versao;
+                bloco.fim++;
+        }
+
+        if (status == SUCESSO) status = gravar_bloco(arquivo, ultimo, &bloco);
+        if (status == SUCESSO && alocou) status = escreve_cabecalho(arquivo, cabecalho);
+        if (status == SUCESSO) status = gravar_lista_aposentados(arquivo, primeiro, ultimo);
+        return status;
+}
+
+/**
+ * @brief Menor número de versão ainda aberta, em qualquer processo.
+ *
+ * Cada versão aberta segura uma trava compartilhada no byte INICIO_TRAVAS_VERSOES + número
+ * (abrir_versao()). F_OFD_GETLK devolve uma trava qualquer da faixa pedida; a faixa é
+ * estreitada até não sobrar nenhuma antes da última encontrada.
+ *
+ * @return O menor número, UINT64_MAX sem versões abertas, ou 0 se a consulta falhar (nada é
+ *         recuperado).
+ */
+static uint64_t menor_versao_aberta(FILE* arquivo) {
+        uint64_t menor = UINT64_MAX;
+        off_t fim = 0;  // 0: até o fim
+        for (;;) {
+                struct flock trava = {0};
+                trava.l_type = F_WRLCK;
+                trava.l_whence = SEEK_SET;
+                trava.l_start = INICIO_TRAVAS_VERSOES;
+                trava.l_len = fim ? fim - INICIO_TRAVAS_VERSOES : 0;
+                if (fcntl(fileno(arquivo), F_OFD_GETLK, &trava) == -1) return 0;
+                if (trava.l_type == F_UNLCK) break;
+                if (trava.l_start <= INICIO_TRAVAS_VERSOES) return 0;
+
+                menor = (uint64_t)(trava.l_start - INICIO_TRAVAS_VERSOES);
+                fim = trava.l_start;
+        }
+        return menor;
+}
+
+/**
+ * @brief Devolve à lista livre os nós que nenhuma versão aberta alcança, gravando o
+ * cabeçalho se algum voltou.
+ *
+ * Um nó aposentado ao publicar a versão v pertence apenas às versões anteriores a v, então pode
+ * ser recuperado quando a menor versão aberta for maior ou igual a v. Como a lista está em
+ * ordem de versão, a recuperação para no primeiro nó que ainda é alcançado. A página 0 deixa
+ * de apontar para os nós antes de eles voltarem à lista livre: uma interrupção no meio perde
+ * nós, mas nunca os libera duas vezes.
+ *
+ * @return SUCESSO ou erros de arquivo.
+ */
+static int recuperar_em(FILE* arquivo, CABECALHO* cabecalho) {
+        int primeiro, ultimo;
+        int status = ler_lista_aposentados(arquivo, &primeiro, &ultimo);
+        if (status != SUCESSO || primeiro == POSICAO_INVALIDA) return status;
+
+        uint64_t menor = menor_versao_aberta(arquivo);
+        LISTA_POSICOES liberar = {0};
+        BLOCO_APOSENTADOS bloco;
+        int alterado = POSICAO_INVALIDA;
+
+        while (status == SUCESSO && primeiro != POSICAO_INVALIDA) {
+                status = ler_bloco(arquivo, primeiro, &bloco);
+                uint32_t inicio = bloco.inicio;
+                while (status == SUCESSO && bloco.inicio < bloco.fim &&
+                       bloco.itens[bloco.inicio].versao <= menor) {
+                        status = adicionar_posicao(&liberar, bloco.itens[bloco.inicio].posicao);
+                        bloco.inicio++;
+                }
+                if (status != SUCESSO || bloco.inicio < bloco.fim) {
+                        if (bloco.inicio != inicio) alterado = primeiro;
+                        break;
+                }
+
+                // Bloco esgotado: ele também volta à lista livre
+                status = adicionar_posicao(&liberar, primeiro);
+                if (primeiro == ultimo) ultimo = POSICAO_INVALIDA;
+                primeiro = bloco.proximo;
+        }
+
+        if (status == SUCESSO && alterado != POSICAO_INVALIDA)
+                status = gravar_bloco(arquivo, alterado, &bloco);
+        if (status == SUCESSO && liberar.tamanho > 0)
+                status = gravar_lista_aposentados(arquivo, primeiro, ultimo);
+        for (size_t i = 0; status == SUCESSO && i < liberar.tamanho; i++)
+                status = liberar_no_arquivo(arquivo, cabecalho, liberar.itens[i]);
+        if (status == SUCESSO && liberar.tamanho > 0) {
+                status = escreve_cabecalho(arquivo, cabecalho);
+                if (status == SUCESSO && fflush(arquivo) != 0) status = ERRO_ARQUIVO_WRITE;
+        }
+
+        free(liberar.itens);
+        return status;
+}
+
+/**
+ * @brief Publica o cabeçalho com a nova raiz e aposenta os nós substituídos.
+ *
+ * Os nós novos são descarregados antes do cabeçalho, de modo que um leitor que veja a nova raiz
+ * sempre encontre os nós que ela alcança. O contador de alterações (arquivo.h) avança antes da
+ * publicação: um leitor que viu o valor `w` antes dela, e por isso pode ter ficado com a raiz
+ * antiga, abre a versão `w`, e os nós substituídos são marcados com `w + 1`. Nós que nenhuma
+ * versão aberta alcança são recuperados logo em seguida.
+ *
+ * @return SUCESSO ou erros de arquivo.
+ */
+static int publicar_versao(FILE* arquivo, CABECALHO* cabecalho,
+                           const LISTA_POSICOES* substituidos) {
+        if (fflush(arquivo) != 0) return ERRO_ARQUIVO_WRITE;
+
+        uint64_t versao = 0;
+        int status = contar_alteracao(arquivo);
+        if (status == SUCESSO) status = ler_alteracoes(arquivo, &versao);
+        if (status == SUCESSO) status = escreve_cabecalho(arquivo, cabecalho);
+        if (status == SUCESSO && fflush(arquivo) != 0) status = ERRO_ARQUIVO_WRITE;
+        if (status != SUCESSO) return status;
+
+        // O pool deste processo já tem as páginas gravadas: só o contador é registrado
+        registrar_acesso_direto(arquivo);
+
+        // A versão nova está publicada: uma falha daqui em diante apenas deixa de recuperar nós
+        if (substituidos->tamanho > 0) aposentar(arquivo, cabecalho, substituidos, versao + 1);
+        recuperar_em(arquivo, cabecalho);
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Desfaz uma escrita que falhou antes da publicação.
+ *
+ * Os nós já gravados ocupam posições que o cabeçalho em disco ainda considera livres (e cujo
+ * encadeamento foi sobrescrito), então elas são devolvidas à lista livre e o cabeçalho é
+ * gravado com a raiz antiga.
+ */
+static void descartar_escrita(FILE* arquivo, CABECALHO* cabecalho, const LISTA_POSICOES* gravados) {
+        for (size_t i = 0; i < gravados->tamanho; i++) {
+                liberar_no_arquivo(arquivo, cabecalho, gravados->itens[i]);
+        }
+        escreve_cabecalho(arquivo, cabecalho);
+        fflush(arquivo);
+}
+
+/**
+ * @brief Grava uma cópia do nó em posição livre, registrando-a em `gravados`.
+ *
+ * @return SUCESSO, ERRO_MEMORIA ou erros de arquivo.
+ */
+static int gravar_copia(FILE* arquivo, CABECALHO* cabecalho, const NO_ARVORE* no,
+                        LISTA_POSICOES* gravados, int* posicao) {
+        int status = alocar_no_arquivo(arquivo, cabecalho, no, posicao);
+        if (status != SUCESSO) return status;
+        return adicionar_gravado(gravados, *posicao, no->livro.codigo);
+}
+
+/**
+ * @brief Copia, de baixo para cima, os `n` primeiros nós do caminho, ligando cada cópia ao
+ * filho copiado logo abaixo dela.
+ *
+ * @param codigo Código que guiou a descida (define o lado de cada filho).
+ * @param filho Posição da subárvore nova que substitui o nível abaixo do caminho.
+ * @param[out] nova_raiz Posição da cópia da raiz (ou `filho`, se `n` for 0).
+ * @return SUCESSO, ERRO_MEMORIA ou erros de arquivo.
+ */
+static int copiar_caminho(FILE* arquivo, CABECALHO* cabecalho, const CAMINHO* caminho, size_t n,
+                          size_t codigo, int filho, LISTA_POSICOES* gravados,
+                          LISTA_POSICOES* substituidos, int* nova_raiz) {
+        for (size_t i = n; i-- > 0;) {
+                NO_ARVORE copia = caminho->itens[i].no;
+                if (codigo < copia.livro.codigo)
+                        copia.filho_esquerdo = filho;
+                else
+                        copia.filho_direito = filho;
+
+                int status = gravar_copia(arquivo, cabecalho, &copia, gravados, &filho);
+                if (status != SUCESSO) return status;
+
+                status = adicionar_posicao(substituidos, caminho->itens[i].posicao);
+                if (status != SUCESSO) return status;
+        }
+
+        *nova_raiz = filho;
+        return SUCESSO;
+}
+
+/**
+ * @brief Abre a versão publicada mais recente da árvore para leitura.
+ *
+ * A versão é registrada com uma trava compartilhada no byte INICIO_TRAVAS_VERSOES + número,
+ * numa descrição aberta só para ela: escritores de qualquer processo a encontram com
+ * F_OFD_GETLK, e fechar outros descritores do arquivo não a desfaz. O número é lido antes da
+ * trava, e o cabeçalho depois dela.
+ *
+ * @param arquivo Arquivo binário aberto para leitura.
+ * @param[out] versao Versão aberta; deve ser fechada com fechar_versao().
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_CABECALHO_NULO, ERRO_ARQUIVO_READ ou ERRO_TRAVA.
+ */
+int abrir_versao(FILE* arquivo, VERSAO_ARVORE* versao) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (versao == NULL) return ERRO_NO_NULO;
+
+        // Descarta dados em buffer anteriores à última publicação
+        fflush(arquivo);
+
+        char caminho[32];
+        snprintf(caminho, sizeof(caminho), "/proc/self/fd/%d", fileno(arquivo));
+        int descritor = open(caminho, O_RDONLY | O_CLOEXEC);
+        if (descritor < 0) return ERRO_ARQUIVO_NULO;
+
+        uint64_t numero = 0;
+        int status = ler_alteracoes(arquivo, &numero);
+
+        struct flock trava = {0};
+        trava.l_type = F_RDLCK;
+        trava.l_whence = SEEK_SET;
+        trava.l_start = INICIO_TRAVAS_VERSOES + (off_t)numero;
+        trava.l_len = 1;
+        if (status == SUCESSO && fcntl(descritor, F_OFD_SETLK, &trava) == -1) status = ERRO_TRAVA;
+
+        CABECALHO* cabecalho = status == SUCESSO ? le_cabecalho(arquivo) : NULL;
+        if (status == SUCESSO && cabecalho == NULL) status = ERRO_CABECALHO_NULO;
+        if (status != SUCESSO) {
+                close(descritor);
+                return status;
+        }
+
+        // Sem trava, o pool do acesso direto é conferido aqui, depois da raiz ser lida
+        conferir_acesso_direto(arquivo);
+
+        versao->raiz = cabecalho->raiz;
+        versao->quantidade = cabecalho->quantidade_livros;
+        versao->numero = numero;
+        versao->descritor = descritor;
+        free(cabecalho);
+
+        return SUCESSO;
+}
+
+/**
+ * @brief Encerra a leitura de uma versão, permitindo recuperar os nós que só ela usava.
+ *
+ * @param versao Versão aberta com abrir_versao().
+ */
+void fechar_versao(VERSAO_ARVORE* versao) {
+        if (versao == NULL) return;
+
+        // Fechar a descrição desfaz a trava que registrava a versão
+        if (versao->descritor >= 0) close(versao->descritor);
+        versao->descritor = -1;
+        versao->raiz = POSICAO_INVALIDA;
+}
+
+/**
+ * @brief Busca um livro pelo código dentro de uma versão.
+ *
+ * @param arquivo Arquivo binário aberto para leitura.
+ * @param versao Versão aberta.
+ * @param codigo Código procurado.
+ * @param[out] livro Livro encontrado.
+ * @return SUCESSO, ERRO_LIVRO_INVALIDO ou ERRO_NO_NULO.
+ */
+int buscar_na_versao(FILE* arquivo, const VERSAO_ARVORE* versao, size_t codigo, LIVRO* livro) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (versao == NULL || livro == NULL) return ERRO_NO_NULO;
+
+        int posicao = versao->raiz;
+        while (posicao != POSICAO_INVALIDA) {
+                NO_ARVORE* no = ler_no_arquivo(arquivo, posicao);
+                if (no == NULL) return ERRO_NO_NULO;
+
+                if (no->livro.codigo == codigo) {
+                        *livro = no->livro;
+                        free(no);
+                        return SUCESSO;
+                }
+
+                posicao = codigo < no->livro.codigo ? no->filho_esquerdo : no->filho_direito;
+                free(no);
+        }
+
+        return ERRO_LIVRO_INVALIDO;
+}
+
+/**
+ * @brief Percorre em ordem de código todos os livros de uma versão.
+ *
+ * @param arquivo Arquivo binário aberto para leitura.
+ * @param versao Versão aberta.
+ * @param visitar Função chamada para cada nó.
+ * @param contexto Ponteiro repassado a `visitar`.
+ * @return Os mesmos códigos de percorrer_subarvore_em_ordem().
+ */
+int percorrer_versao_em_ordem(FILE* arquivo, const VERSAO_ARVORE* versao, VISITANTE_NO visitar,
+                              void* contexto) {
+        if (versao == NULL) return ERRO_NO_NULO;
+        return percorrer_subarvore_em_ordem(arquivo, versao->raiz, visitar, contexto);
+}
+
+/**
+ * @brief Corpo de inserir_no_arvore_cow(), sem a medição.
+ */
+static int inserir_cow(FILE* arquivo, NO_ARVORE* novo) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+        if (novo == NULL) return ERRO_NO_NULO;
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+
+        int status = recuperar_em(arquivo, cabecalho);
+
+        size_t codigo = novo->livro.codigo;
+        CAMINHO caminho = {0};
+        LISTA_POSICOES gravados = {0};
+        LISTA_POSICOES substituidos = {0};
+
+        int posicao = cabecalho->raiz;
+        while (status == SUCESSO && posicao != POSICAO_INVALIDA) {
+                status = empilhar_no(arquivo, &caminho, posicao);
+                if (status != SUCESSO) break;
+
+                const NO_ARVORE* no = &caminho.itens[caminho.tamanho - 1].no;
+                if (no->livro.codigo == codigo) status = ERRO_CODIGO_DUPLICADO;
+
+                posicao = codigo < no->livro.codigo ? no->filho_esquerdo : no->filho_direito;
+        }
+
+        NO_ARVORE folha = *novo;
+        folha.filho_esquerdo = POSICAO_INVALIDA;
+        folha.filho_direito = POSICAO_INVALIDA;
+
+        int nova_raiz = POSICAO_INVALIDA;
+        if (status == SUCESSO)
+                status = gravar_copia(arquivo, cabecalho, &folha, &gravados, &posicao);
+        if (status == SUCESSO)
+                status = copiar_caminho(arquivo, cabecalho, &caminho, caminho.tamanho, codigo,
+                                        posicao, &gravados, &substituidos, &nova_raiz);
+
+        if (status == SUCESSO) {
+                int raiz_antiga = cabecalho->raiz;
+                cabecalho->raiz = nova_raiz;
+                cabecalho->quantidade_livros++;
+                status = publicar_versao(arquivo, cabecalho, &substituidos);
+                if (status != SUCESSO) {
+                        cabecalho->raiz = raiz_antiga;
+                        cabecalho->quantidade_livros--;
+                }
+        }
+        if (status == SUCESSO) {
+                registrar_codigo_no_filtro(arquivo, codigo);
+                indexar_gravados(arquivo, &gravados);
+        }
+
+        if (status != SUCESSO && gravados.tamanho > 0)
+                descartar_escrita(arquivo, cabecalho, &gravados);
+
+        free(caminho.itens);
+        free(gravados.itens);
+        free(gravados.codigos);
+        free(substituidos.itens);
+        free(cabecalho);
+
+        return status;
+}
+
+/**
+ * @brief Insere um nó copiando o caminho da raiz até o ponto de inserção.
+ *
+ * @param arquivo Arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param novo Nó a inserir (os filhos são ignorados).
+ * @return SUCESSO, ERRO_CODIGO_DUPLICADO, ERRO_MEMORIA ou erros de arquivo.
+ */
+int inserir_no_arvore_cow(FILE* arquivo, NO_ARVORE* novo) {
+        INICIAR_MEDICAO(medicao, OPERACAO_INSERIR, novo != NULL ? novo->livro.codigo : 0);
+        int status = inserir_cow(arquivo, novo);
+        CONCLUIR_MEDICAO(medicao, status);
+        return status;
+}
+
+/**
+ * @brief Monta a subárvore que substitui um nó removido com dois filhos.
+ *
+ * Copia o caminho da raiz da subárvore direita até o sucessor, religando o filho direito do
+ * sucessor no lugar dele, e grava uma cópia do nó removido contendo o livro do sucessor.
+ *
+ * @param removido Nó que está sendo removido.
+ * @param[out] nova_posicao Posição da cópia que substitui o nó removido.
+ * @return SUCESSO, ERRO_MEMORIA ou erros de arquivo.
+ */
+static int substituir_por_sucessor(FILE* arquivo, CABECALHO* cabecalho, const NO_ARVORE* removido,
+                                   LISTA_POSICOES* gravados, LISTA_POSICOES* substituidos,
+                                   int* nova_posicao) {
+        CAMINHO sucessores = {0};
+        int status = SUCESSO;
+
+        int posicao = removido->filho_direito;
+        while (status == SUCESSO && posicao != POSICAO_INVALIDA) {
+                status = empilhar_no(arquivo, &sucessores, posicao);
+                if (status == SUCESSO)
+                        posicao = sucessores.itens[sucessores.tamanho - 1].no.filho_esquerdo;
+        }
+
+        if (status == SUCESSO) {
+                const ITEM_CAMINHO* sucessor = &sucessores.itens[sucessores.tamanho - 1];
+                int filho = sucessor->no.filho_direito;
+                status = adicionar_posicao(substituidos, sucessor->posicao);
+
+                for (size_t j = sucessores.tamanho - 1; status == SUCESSO && j-- > 0;) {
+                        NO_ARVORE copia = sucessores.itens[j].no;
+                        copia.filho_esquerdo = filho;
+                        status = gravar_copia(arquivo, cabecalho, &copia, gravados, &filho);
+                        if (status == SUCESSO)
+                                status = adicionar_posicao(substituidos,
+                                                           sucessores.itens[j].posicao);
+                }
+
+                if (status == SUCESSO) {
+                        NO_ARVORE copia = *removido;
+                        copia.livro = sucessor->no.livro;
+                        copia.filho_direito = filho;
+                        status = gravar_copia(arquivo, cabecalho, &copia, gravados, nova_posicao);
+                }
+        }
+
+        free(sucessores.itens);
+        return status;
+}
+
+/**
+ * @brief Corpo de remover_no_arvore_cow(), sem a medição.
+ */
+static int remover_cow(FILE* arquivo, size_t codigo) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+
+        int status = recuperar_em(arquivo, cabecalho);
+
+        CAMINHO caminho = {0};
+        LISTA_POSICOES gravados = {0};
+        LISTA_POSICOES substituidos = {0};
+        int encontrado = 0;
+
+        int posicao = cabecalho->raiz;
+        while (status == SUCESSO && posicao != POSICAO_INVALIDA) {
+                status = empilhar_no(arquivo, &caminho, posicao);
+                if (status != SUCESSO) break;
+
+                const NO_ARVORE* no = &caminho.itens[caminho.tamanho - 1].no;
+                if (no->livro.codigo == codigo) {
+                        encontrado = 1;
+                        break;
+                }
+
+                posicao = codigo < no->livro.codigo ? no->filho_esquerdo : no->filho_direito;
+        }
+        if (status == SUCESSO && !encontrado) status = ERRO_NO_NULO;
+
+        int nova_raiz = POSICAO_INVALIDA;
+        if (status == SUCESSO) {
+                const ITEM_CAMINHO* alvo = &caminho.itens[caminho.tamanho - 1];
+                int filho;
+
+                status = adicionar_posicao(&substituidos, alvo->posicao);
+
+                if (alvo->no.filho_esquerdo == POSICAO_INVALIDA ||
+                    alvo->no.filho_direito == POSICAO_INVALIDA) {
+                        filho = alvo->no.filho_esquerdo != POSICAO_INVALIDA
+                                    ? alvo->no.filho_esquerdo
+                                    : alvo->no.filho_direito;
+                } else if (status == SUCESSO) {
+                        status = substituir_por_sucessor(arquivo, cabecalho, &alvo->no, &gravados,
+                                                         &substituidos, &filho);
+                }
+
+                if (status == SUCESSO)
+                        status = copiar_caminho(arquivo, cabecalho, &caminho, caminho.tamanho - 1,
+                                                codigo, filho, &gravados, &substituidos,
+                                                &nova_raiz);
+        }
+
+        if (status == SUCESSO) {
+                int raiz_antiga = cabecalho->raiz;
+                cabecalho->raiz = nova_raiz;
+                cabecalho->quantidade_livros--;
+                status = publicar_versao(arquivo, cabecalho, &substituidos);
+                if (status != SUCESSO) {
+                        cabecalho->raiz = raiz_antiga;
+                        cabecalho->quantidade_livros++;
+                }
+        }
+        if (status == SUCESSO) {
+                registrar_remocao_no_filtro(arquivo);
+                remover_do_indice(arquivo, codigo);
+                indexar_gravados(arquivo, &gravados);
+        }
+
+        if (status != SUCESSO && gravados.tamanho > 0)
+                descartar_escrita(arquivo, cabecalho, &gravados);
+
+        free(caminho.itens);
+        free(gravados.itens);
+        free(gravados.codigos);
+        free(substituidos.itens);
+        free(cabecalho);
+
+        return status;
+}
+
+/**
+ * @brief Remove um livro copiando o caminho alterado e publicando uma nova raiz.
+ *
+ * @param arquivo Arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @param codigo Código do livro a remover.
+ * @return SUCESSO, ERRO_NO_NULO, ERRO_MEMORIA ou erros de arquivo.
+ */
+int remover_no_arvore_cow(FILE* arquivo, size_t codigo) {
+        INICIAR_MEDICAO(medicao, OPERACAO_REMOVER, codigo);
+        int status = remover_cow(arquivo, codigo);
+        CONCLUIR_MEDICAO(medicao, status);
+        return status;
+}
+
+/**
+ * @brief Devolve à lista livre os nós aposentados que nenhuma versão aberta alcança mais.
+ *
+ * @param arquivo Arquivo binário aberto em modo leitura/escrita ("rb+").
+ * @return SUCESSO ou erros de arquivo.
+ */
+int recuperar_versoes_antigas(FILE* arquivo) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        if (cabecalho == NULL) return ERRO_CABECALHO_NULO;
+
+        int status = recuperar_em(arquivo, cabecalho);
+
+        free(cabecalho);
+        return status;
+}
+
+/**
+ * @brief Visita os blocos da lista de aposentados e os nós guardados neles.
+ *
+ * @param arquivo Arquivo binário aberto para leitura.
+ * @param visitar Chamada para cada posição, com `bloco` diferente de zero nos blocos.
+ * @param contexto Ponteiro repassado a `visitar`.
+ * @return SUCESSO, ERRO_ARQUIVO_READ ou ERRO_NO_NULO.
+ */
+int percorrer_aposentados(FILE* arquivo, VISITANTE_APOSENTADO visitar, void* contexto) {
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        int primeiro, ultimo;
+        int status = ler_lista_aposentados(arquivo, &primeiro, &ultimo);
+        for (int posicao = primeiro; status == SUCESSO && posicao != POSICAO_INVALIDA;) {
+                BLOCO_APOSENTADOS bloco;
+                status = ler_bloco(arquivo, posicao, &bloco);
+                if (status != SUCESSO || bloco.fim > APOSENTADOS_POR_BLOCO) {
+                        status = ERRO_NO_NULO;
+                        break;
+                }
+                visitar(posicao, 1, contexto);
+                for (uint32_t i = bloco.inicio; i < bloco.fim; i++)
+                        visitar(bloco.itens[i].posicao, 0, contexto);
+                posicao = posicao == ultimo ? POSICAO_INVALIDA : bloco.proximo;
+        }
+        return status;
+}
+
+/**
+ * @brief Visitante que conta os nós aposentados, sem os blocos.
+ */
+static void contar_aposentado(int posicao, int bloco, void* contexto) {
+        (void)posicao;
+        if (!bloco) (*(size_t*)contexto)++;
+}
+
+/**
+ * @brief Quantidade de nós aposentados ainda aguardando recuperação.
+ *
+ * @param arquivo Arquivo binário aberto para leitura.
+ * @return Número de nós na lista de aposentados do arquivo (0 se ela não puder ser lida).
+ */
+size_t quantidade_nos_aposentados(FILE* arquivo) {
+        size_t quantidade = 0;
+        if (percorrer_aposentados(arquivo, contar_aposentado, &quantidade) != SUCESSO) return 0;
+        return quantidade;
+}
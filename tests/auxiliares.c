@@ -0,0 +1,109 @@
+/**
+ * @file auxiliares.c
+ * @brief Implementa os auxiliares comuns aos testes que montam catálogos em /tmp.
+ */
+
+#include "auxiliares.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/livro.h"
+
+/**
+ * @brief Cria e abre um arquivo de livros vazio.
+ */
+FILE* aux_arquivo_vazio(const char* caminho) {
+        remove(caminho);
+        abrir_ou_criar_arquivo(caminho);
+        FILE* arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+        return arquivo;
+}
+
+/**
+ * @brief Cria e abre um arquivo de livros vazio em /tmp.
+ */
+FILE* aux_criar_arquivo(char* caminho, size_t tamanho, const char* modulo, const char* nome) {
+        if (nome != NULL)
+                snprintf(caminho, tamanho, "/tmp/test_%s_%s_%d.bin", modulo, nome, getpid());
+        else
+                snprintf(caminho, tamanho, "/tmp/test_%s_%d.bin", modulo, getpid());
+        return aux_arquivo_vazio(caminho);
+}
+
+/**
+ * @brief Cadastra o livro de código `codigo`.
+ */
+void aux_cadastrar(FILE* arquivo, size_t codigo) {
+        LIVRO livro = {0};
+        livro.codigo = codigo;
+        snprintf(livro.titulo, sizeof(livro.titulo), "Livro %zu", codigo);
+        assert_int_equal(cadastrar_livro(arquivo, livro), SUCESSO);
+}
+
+/**
+ * @brief Confere a presença e o título do livro `codigo`.
+ */
+void aux_conferir_livro(FILE* arquivo, size_t codigo, int presente) {
+        RESULTADO_BUSCA resultado = {0};
+        int status = buscar_no_arvore(arquivo, codigo, &resultado);
+        if (presente) {
+                char titulo[sizeof(resultado.no->livro.titulo)];
+                snprintf(titulo, sizeof(titulo), "Livro %zu", codigo);
+                assert_int_equal(status, SUCESSO);
+                assert_string_equal(resultado.no->livro.titulo, titulo);
+        } else {
+                assert_int_not_equal(status, SUCESSO);
+        }
+        free(resultado.no);
+        free(resultado.pai);
+}
+
+/**
+ * @brief Copia o livro do nó para a coleta.
+ */
+int aux_coletar(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)posicao;
+        COLETA* coleta = contexto;
+        coleta->livros[coleta->quantidade++] = no->livro;
+        return SUCESSO;
+}
+
+/**
+ * @brief Altura da subárvore com raiz em `posicao`.
+ */
+int aux_altura(FILE* arquivo, int posicao) {
+        if (posicao == POSICAO_INVALIDA) return 0;
+        NO_ARVORE* no = ler_no_arquivo(arquivo, posicao);
+        assert_non_null(no);
+        int esquerda = aux_altura(arquivo, no->filho_esquerdo);
+        int direita = aux_altura(arquivo, no->filho_direito);
+        free(no);
+        return 1 + (esquerda > direita ? esquerda : direita);
+}
+
+/**
+ * @brief `i`-ésimo código da ordem embaralhada.
+ */
+size_t aux_codigo_embaralhado(size_t i, size_t livros, size_t passo) {
+        return passo * ((i * EMBARALHADOR_CATALOGO) % livros + 1);
+}
+
+/**
+ * @brief Cadastra `livros` códigos múltiplos de `passo` em ordem embaralhada.
+ */
+void aux_cadastrar_embaralhados(FILE* arquivo, size_t livros, size_t passo) {
+        assert_true(livros % EMBARALHADOR_CATALOGO != 0);
+        for (size_t i = 0; i < livros; i++)
+                aux_cadastrar(arquivo, aux_codigo_embaralhado(i, livros, passo));
+}
@@ -0,0 +1,78 @@
+/**
+ * @file auxiliares.h
+ * @brief Auxiliares comuns aos testes que montam catálogos em /tmp.
+ */
+
+#ifndef AUXILIARES_H
+#define AUXILIARES_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "../include/arquivo.h"
+#include "../include/livro.h"
+
+/**
+ * Multiplicador que embaralha a ordem de cadastro. Como é primo, i·617 mod n percorre todos os
+ * restos para qualquer n que não seja múltiplo dele.
+ */
+#define EMBARALHADOR_CATALOGO 617
+
+/**
+ * Livros copiados por um percurso em ordem com aux_coletar().
+ */
+typedef struct {
+        LIVRO* livros;     /**< Destino, com espaço para todos os livros do percurso. */
+        size_t quantidade; /**< Livros copiados até aqui. */
+} COLETA;
+
+/**
+ * @brief Cria um arquivo de livros vazio em `caminho`, apagando o que houver lá, e o abre para
+ * leitura e escrita.
+ *
+ * @return Arquivo aberto; o teste falha se não for possível abri-lo.
+ */
+FILE* aux_arquivo_vazio(const char* caminho);
+
+/**
+ * @brief Cria um arquivo de livros vazio em `/tmp/test_<modulo>_<nome>_<pid>.bin` (sem
+ * `_<nome>` se `nome` for NULL) e o abre para leitura e escrita.
+ *
+ * @param[out] caminho Caminho do arquivo criado.
+ * @param tamanho Bytes de `caminho`.
+ * @return Arquivo aberto; o teste falha se não for possível abri-lo.
+ */
+FILE* aux_criar_arquivo(char* caminho, size_t tamanho, const char* modulo, const char* nome);
+
+/**
+ * @brief Cadastra o livro de código `codigo`, com o código também no título ("Livro <codigo>").
+ */
+void aux_cadastrar(FILE* arquivo, size_t codigo);
+
+/**
+ * @brief Confere se o livro `codigo` está (ou não) no arquivo, com o título de aux_cadastrar().
+ */
+void aux_conferir_livro(FILE* arquivo, size_t codigo, int presente);
+
+/**
+ * @brief Visitante de percorrer_em_ordem() que copia cada livro para a COLETA do `contexto`.
+ */
+int aux_coletar(const NO_ARVORE* no, int posicao, void* contexto);
+
+/**
+ * @brief Altura da subárvore com raiz em `posicao`, lida nó a nó do arquivo.
+ */
+int aux_altura(FILE* arquivo, int posicao);
+
+/**
+ * @brief `i`-ésimo código da ordem embaralhada de `passo`, 2·`passo`, …, `livros`·`passo`.
+ */
+size_t aux_codigo_embaralhado(size_t i, size_t livros, size_t passo);
+
+/**
+ * @brief Cadastra os códigos `passo`, 2·`passo`, …, `livros`·`passo` na ordem embaralhada por
+ * EMBARALHADOR_CATALOGO, para que a árvore não degenere numa lista.
+ */
+void aux_cadastrar_embaralhados(FILE* arquivo, size_t livros, size_t passo);
+
+#endif  // AUXILIARES_H
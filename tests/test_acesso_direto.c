@@ -0,0 +1,270 @@
+/**
+ * @file test_acesso_direto.c
+ * @brief Testes unitários para o pool de páginas do acesso direto.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/acesso_direto.h"
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/concorrencia.h"
+#include "../include/diagnostico.h"
+#include "../include/erros.h"
+#include "../include/livro.h"
+#include "auxiliares.h"
+
+/** Livros do catálogo do teste da varredura: 500 páginas de dados. */
+#define LIVROS_VARREDURA 4000
+
+/** Quadros do pool no teste da varredura, metade das páginas do catálogo. */
+#define PAGINAS_VARREDURA 256
+
+/** Códigos buscados repetidamente: o conjunto quente. */
+static const size_t codigos_quentes[] = {1, 1001, 2001, 3001, 3999};
+
+/**
+ * @brief Auxiliar: visitante que só conta os nós.
+ */
+static int aux_contar(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)no;
+        (void)posicao;
+        (*(size_t*)contexto)++;
+        return SUCESSO;
+}
+
+/**
+ * @brief Auxiliar: busca o conjunto quente e retorna as faltas do pool depois disso.
+ */
+static size_t aux_buscar_quentes(FILE* arquivo) {
+        for (size_t i = 0; i < sizeof(codigos_quentes) / sizeof(codigos_quentes[0]); i++)
+                aux_conferir_livro(arquivo, codigos_quentes[i], 1);
+        ESTADO_ACESSO_DIRETO estado;
+        assert_int_equal(consultar_acesso_direto(arquivo, &estado), SUCESSO);
+        return estado.faltas;
+}
+
+/**
+ * @test Os níveis superiores ficam fixados, o conjunto quente sobrevive a um percurso completo
+ * (que vai pelo anel) e as mesmas leituras fora da varredura expulsam páginas.
+ */
+static void test_pool_resiste_a_varredura(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "acesso_direto", "varredura");
+        aux_cadastrar_embaralhados(arquivo, LIVROS_VARREDURA, 1);
+
+        assert_int_equal(abrir_acesso_direto(arquivo, caminho, PAGINAS_VARREDURA), SUCESSO);
+        ESTADO_ACESSO_DIRETO estado;
+        assert_int_equal(consultar_acesso_direto(arquivo, &estado), SUCESSO);
+        assert_int_equal(estado.paginas, PAGINAS_VARREDURA);
+        assert_int_equal(estado.handles, 1);
+        assert_true(estado.fixadas > 0 && estado.fixadas <= PAGINAS_VARREDURA / 4);
+        assert_int_equal(estado.ocupadas, estado.fixadas);
+
+        // Depois do aquecimento, o conjunto quente não falta mais
+        size_t faltas = aux_buscar_quentes(arquivo);
+        assert_int_equal(aux_buscar_quentes(arquivo), faltas);
+
+        size_t visitados = 0;
+        assert_int_equal(percorrer_em_ordem(arquivo, aux_contar, &visitados), SUCESSO);
+        assert_int_equal(visitados, LIVROS_VARREDURA);
+        NO_ARVORE* nos = malloc(LIVROS_VARREDURA * sizeof(NO_ARVORE));
+        assert_non_null(nos);
+        assert_int_equal(ler_nos_arquivo(arquivo, 0, LIVROS_VARREDURA, nos), SUCESSO);
+        free(nos);
+        assert_int_equal(consultar_acesso_direto(arquivo, &estado), SUCESSO);
+        assert_true(estado.faltas_varredura >= LIVROS_VARREDURA / NOS_POR_PAGINA);
+        assert_int_equal(estado.faltas, faltas);
+        assert_int_equal(estado.expulsoes, 0);
+        assert_int_equal(aux_buscar_quentes(arquivo), faltas);
+
+        // Fora da varredura, o mesmo percurso enche o pool e expulsa páginas; as fixadas ficam
+        for (int posicao = 0; posicao < LIVROS_VARREDURA; posicao++) {
+                NO_ARVORE* no = ler_no_arquivo(arquivo, posicao);
+                assert_non_null(no);
+                free(no);
+        }
+        size_t fixadas = estado.fixadas;
+        assert_int_equal(consultar_acesso_direto(arquivo, &estado), SUCESSO);
+        assert_true(estado.expulsoes > 0);
+        assert_int_equal(estado.ocupadas, PAGINAS_VARREDURA);
+        assert_int_equal(estado.fixadas, fixadas);
+
+        assert_int_equal(fechar_acesso_direto(arquivo), SUCESSO);
+        assert_int_equal(consultar_acesso_direto(arquivo, &estado), ERRO_ARQUIVO_NULO);
+        assert_int_equal(fechar_acesso_direto(arquivo), ERRO_ARQUIVO_NULO);
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @test Cadastros e remoções com um pool pequeno chegam ao disco: outro handle, sem pool, vê a
+ * árvore íntegra.
+ */
+static void test_gravacao_direta(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "acesso_direto", "gravacao");
+        aux_cadastrar_embaralhados(arquivo, 1000, 1);
+
+        assert_int_equal(abrir_acesso_direto(arquivo, caminho, PAGINAS_ANEL_VARREDURA), SUCESSO);
+        assert_int_equal(travar_arquivo(arquivo, TRAVA_ESCRITA), SUCESSO);
+        for (size_t codigo = 1001; codigo <= 1200; codigo++) aux_cadastrar(arquivo, codigo);
+        for (size_t codigo = 2; codigo <= 200; codigo += 2)
+                assert_int_equal(remover_no_arvore(arquivo, codigo), SUCESSO);
+        assert_int_equal(destravar_arquivo(arquivo, TRAVA_ESCRITA), SUCESSO);
+
+        ESTADO_ACESSO_DIRETO estado;
+        assert_int_equal(consultar_acesso_direto(arquivo, &estado), SUCESSO);
+        assert_true(estado.expulsoes > 0);
+        assert_int_equal(estado.invalidacoes, 0);
+
+        FILE* leitor = fopen(caminho, "rb");
+        assert_non_null(leitor);
+        DIAGNOSTICO_ARVORE diagnostico;
+        assert_int_equal(diagnosticar_arvore(leitor, &diagnostico), SUCESSO);
+        assert_int_equal(diagnostico.vivas, 1100);
+        assert_int_equal(diagnostico.livres, 100);
+        assert_int_equal(diagnostico.perdidas, 0);
+        assert_int_equal(diagnostico.ligacoes_invalidas, 0);
+        liberar_diagnostico(&diagnostico);
+        for (size_t codigo = 1; codigo <= 1200; codigo += 7)
+                aux_conferir_livro(leitor, codigo, codigo > 200 || codigo % 2 != 0);
+        fclose(leitor);
+
+        assert_int_equal(fechar_acesso_direto(arquivo), SUCESSO);
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @test Handles do mesmo arquivo compartilham o pool, que é esvaziado quando outro handle sem
+ * pool muda o arquivo.
+ */
+static void test_pool_compartilhado_e_invalidado(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "acesso_direto", "invalidado");
+        aux_cadastrar_embaralhados(arquivo, 500, 1);
+        FILE* outro = fopen(caminho, "rb");
+        assert_non_null(outro);
+
+        assert_int_equal(abrir_acesso_direto(arquivo, caminho, 64), SUCESSO);
+        assert_int_equal(abrir_acesso_direto(outro, caminho, 64), SUCESSO);
+        ESTADO_ACESSO_DIRETO estado;
+        assert_int_equal(consultar_acesso_direto(outro, &estado), SUCESSO);
+        assert_int_equal(estado.handles, 2);
+        assert_int_equal(fechar_acesso_direto(outro), SUCESSO);
+        assert_int_equal(consultar_acesso_direto(arquivo, &estado), SUCESSO);
+        assert_int_equal(estado.handles, 1);
+        fclose(outro);
+
+        assert_int_equal(travar_arquivo(arquivo, TRAVA_LEITURA), SUCESSO);
+        aux_conferir_livro(arquivo, 250, 1);
+        assert_int_equal(destravar_arquivo(arquivo, TRAVA_LEITURA), SUCESSO);
+
+        // Um escritor sem pool remove 250 e faz o arquivo crescer
+        FILE* escritor = fopen(caminho, "rb+");
+        assert_non_null(escritor);
+        assert_int_equal(travar_arquivo(escritor, TRAVA_ESCRITA), SUCESSO);
+        assert_int_equal(remover_no_arvore(escritor, 250), SUCESSO);
+        for (size_t codigo = 501; codigo <= 540; codigo++) aux_cadastrar(escritor, codigo);
+        assert_int_equal(destravar_arquivo(escritor, TRAVA_ESCRITA), SUCESSO);
+        fclose(escritor);
+
+        assert_int_equal(travar_arquivo(arquivo, TRAVA_LEITURA), SUCESSO);
+        assert_int_equal(consultar_acesso_direto(arquivo, &estado), SUCESSO);
+        assert_int_equal(estado.invalidacoes, 1);
+        assert_true(estado.fixadas > 0);
+        aux_conferir_livro(arquivo, 250, 0);
+        aux_conferir_livro(arquivo, 540, 1);
+        assert_int_equal(destravar_arquivo(arquivo, TRAVA_LEITURA), SUCESSO);
+
+        // O caminho tem de ser do mesmo arquivo
+        assert_int_equal(fechar_acesso_direto(arquivo), SUCESSO);
+        assert_int_equal(abrir_acesso_direto(arquivo, "/tmp/nao/existe.bin", 64),
+                         ERRO_ARQUIVO_NULO);
+        assert_int_equal(consultar_acesso_direto(arquivo, &estado), ERRO_ARQUIVO_NULO);
+
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @test Uma regravação no lugar, que não muda o tamanho nem a data de modificação do arquivo,
+ * ainda esvazia o pool: quem avisa é o contador de alterações.
+ */
+static void test_pool_invalidado_sem_mudar_data(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "acesso_direto", "no_lugar");
+        aux_cadastrar_embaralhados(arquivo, 500, 1);
+        assert_int_equal(abrir_acesso_direto(arquivo, caminho, 64), SUCESSO);
+        assert_int_equal(travar_arquivo(arquivo, TRAVA_LEITURA), SUCESSO);
+        aux_conferir_livro(arquivo, 250, 1);
+        assert_int_equal(destravar_arquivo(arquivo, TRAVA_LEITURA), SUCESSO);
+
+        struct stat antes;
+        assert_int_equal(stat(caminho, &antes), 0);
+
+        // Outro handle troca o título do 250 no lugar e devolve a data de modificação
+        FILE* escritor = fopen(caminho, "rb+");
+        assert_non_null(escritor);
+        assert_int_equal(travar_arquivo(escritor, TRAVA_ESCRITA), SUCESSO);
+        RESULTADO_BUSCA resultado = {0};
+        assert_int_equal(buscar_no_arvore(escritor, 250, &resultado), SUCESSO);
+        snprintf(resultado.no->livro.titulo, sizeof(resultado.no->livro.titulo), "Trocado");
+        assert_int_equal(escrever_no(escritor, resultado.no, resultado.posicao_no), SUCESSO);
+        free(resultado.no);
+        free(resultado.pai);
+        assert_int_equal(destravar_arquivo(escritor, TRAVA_ESCRITA), SUCESSO);
+        const struct timespec datas[2] = {antes.st_atim, antes.st_mtim};
+        assert_int_equal(futimens(fileno(escritor), datas), 0);
+        fclose(escritor);
+
+        struct stat depois;
+        assert_int_equal(stat(caminho, &depois), 0);
+        assert_int_equal(depois.st_size, antes.st_size);
+        assert_int_equal(depois.st_mtim.tv_nsec, antes.st_mtim.tv_nsec);
+
+        assert_int_equal(travar_arquivo(arquivo, TRAVA_LEITURA), SUCESSO);
+        ESTADO_ACESSO_DIRETO estado;
+        assert_int_equal(consultar_acesso_direto(arquivo, &estado), SUCESSO);
+        assert_int_equal(estado.invalidacoes, 1);
+        assert_int_equal(buscar_no_arvore(arquivo, 250, &resultado), SUCESSO);
+        assert_string_equal(resultado.no->livro.titulo, "Trocado");
+        free(resultado.no);
+        free(resultado.pai);
+        assert_int_equal(destravar_arquivo(arquivo, TRAVA_LEITURA), SUCESSO);
+
+        assert_int_equal(fechar_acesso_direto(arquivo), SUCESSO);
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @brief Retorna a lista de testes do acesso direto a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* acesso_direto_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_pool_resiste_a_varredura),
+            cmocka_unit_test(test_gravacao_direta),
+            cmocka_unit_test(test_pool_compartilhado_e_invalidado),
+            cmocka_unit_test(test_pool_invalidado_sem_mudar_data)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
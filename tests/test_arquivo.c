@@ -13,9 +13,13 @@
 
 #include <cmocka.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/diagnostico.h"
 #include "../include/erros.h"
+#include "../include/indice.h"
 
 /// @brief Arquivo temporário utilizado nos testes.
 static FILE* arquivo_valido = NULL;
@@ -58,7 +62,7 @@ static int setup_arquivo_valido(void** state) {
         cabecalho.topo = 3;
         cabecalho.quantidade_livros = 4;
 
-        fwrite(&cabecalho, sizeof(CABECALHO), 1, arquivo_valido);
+        escreve_cabecalho(arquivo_valido, &cabecalho);
 
         *state = arquivo_valido;
 
@@ -169,7 +173,7 @@ static int setup_criar_arquivo_valido_sem_lista_livre(void** state) {
         cabecalho.topo = 0;
         cabecalho.quantidade_livros = 0;
 
-        if (fwrite(&cabecalho, sizeof(CABECALHO), 1, arquivo_valido) != 1) {
+        if (escreve_cabecalho(arquivo_valido, &cabecalho) != SUCESSO) {
                 fclose(arquivo_valido);
                 return -1;
         }
@@ -210,7 +214,7 @@ static void test_inserir_no_valido_sem_lista_livre(void** state) {
         assert_int_equal(cabecalho.quantidade_livros, 1);
 
         NO_ARVORE no_lido = {0};
-        fseek(arquivo, sizeof(CABECALHO) + (cabecalho.raiz) * sizeof(NO_ARVORE), SEEK_SET);
+        fseek(arquivo, deslocamento_no(posicao_inserido), SEEK_SET);
         fread(&no_lido, sizeof(NO_ARVORE), 1, arquivo);
 
         assert_int_equal(no_lido.filho_direito, -1);
@@ -236,7 +240,7 @@ static int setup_criar_arquivo_valido_com_lista_livre(void** state) {
         cabecalho.topo = 2;
         cabecalho.quantidade_livros = 0;
 
-        if (fwrite(&cabecalho, sizeof(CABECALHO), 1, arquivo_valido) != 1) {
+        if (escreve_cabecalho(arquivo_valido, &cabecalho) != SUCESSO) {
                 fclose(arquivo_valido);
                 return -1;
         }
@@ -249,8 +253,8 @@ static int setup_criar_arquivo_valido_com_lista_livre(void** state) {
         no_removido_1.filho_esquerdo = POSICAO_INVALIDA;
         no_removido_1.filho_direito = POSICAO_INVALIDA;
 
-        if (fwrite(&no_removido_0, sizeof(NO_ARVORE), 1, arquivo_valido) != 1 ||
-            fwrite(&no_removido_1, sizeof(NO_ARVORE), 1, arquivo_valido) != 1) {
+        if (escrever_no(arquivo_valido, &no_removido_0, 0) != SUCESSO ||
+            escrever_no(arquivo_valido, &no_removido_1, 1) != SUCESSO) {
                 fclose(arquivo_valido);
                 return -1;
         }
@@ -292,7 +296,7 @@ static void test_inserir_no_valido_com_lista_livre(void** state) {
         assert_int_equal(cabecalho.livre, 1);
 
         NO_ARVORE no_lido = {0};
-        fseek(arquivo, sizeof(CABECALHO) + 0 * sizeof(NO_ARVORE), SEEK_SET);
+        fseek(arquivo, deslocamento_no(0), SEEK_SET);
         fread(&no_lido, sizeof(NO_ARVORE), 1, arquivo);
 
         assert_int_equal(no_lido.filho_direito, -1);
@@ -337,6 +341,67 @@ static void test_ler_no_arquivo_valido(void** state) {
         free(no_lido);
 }
 
+/**
+ * @test Nenhum nó atravessa a divisa de uma página; a soma de verificação acusa um byte
+ * trocado no disco, e um arquivo sem a descrição do formato é recusado.
+ */
+static void test_paginas_e_somas(void** state) {
+        (void)state;
+        for (int posicao = 0; posicao < 100; posicao++) {
+                long deslocamento = deslocamento_no(posicao);
+                assert_true(deslocamento >= TAMANHO_PAGINA);
+                assert_true(deslocamento % TAMANHO_PAGINA + (long)sizeof(NO_ARVORE) <=
+                            TAMANHO_PAGINA);
+        }
+
+        FILE* arquivo = tmpfile();
+        assert_non_null(arquivo);
+        assert_int_equal(inicializar_arquivo_cabecalho(arquivo), SUCESSO);
+        // Três páginas de dados, a última pela metade.
+        size_t quantidade = 2 * NOS_POR_PAGINA + NOS_POR_PAGINA / 2;
+        NO_ARVORE nos[3 * NOS_POR_PAGINA];
+        memset(nos, 0, sizeof(nos));
+        for (size_t i = 0; i < quantidade; i++) {
+                nos[i].livro = aux_criar_livro_valido((int)i + 1);
+                nos[i].filho_esquerdo = nos[i].filho_direito = POSICAO_INVALIDA;
+        }
+        assert_int_equal(escrever_nos(arquivo, nos, 0, quantidade), SUCESSO);
+
+        NO_ARVORE lidos[3 * NOS_POR_PAGINA];
+        assert_int_equal(ler_nos_arquivo(arquivo, 0, quantidade, lidos), SUCESSO);
+        assert_memory_equal(lidos, nos, quantidade * sizeof(NO_ARVORE));
+        // Um trecho que começa no meio de uma página e termina no meio de outra.
+        assert_int_equal(ler_nos_arquivo(arquivo, 3, NOS_POR_PAGINA, lidos), SUCESSO);
+        assert_memory_equal(lidos, &nos[3], NOS_POR_PAGINA * sizeof(NO_ARVORE));
+
+        // Um byte do título do nó 9 trocado por fora da API.
+        long byte = deslocamento_no(9) + (long)offsetof(LIVRO, titulo);
+        assert_int_equal(fseek(arquivo, byte, SEEK_SET), 0);
+        assert_int_equal(fputc('#', arquivo), '#');
+        assert_null(ler_no_arquivo(arquivo, 9));
+        assert_int_equal(ler_nos_arquivo(arquivo, 0, quantidade, lidos), ERRO_SOMA_PAGINA);
+        NO_ARVORE* vizinho = ler_no_arquivo(arquivo, 10);
+        assert_non_null(vizinho);
+        free(vizinho);
+        // Regravar o nó refaz a soma.
+        assert_int_equal(escrever_no(arquivo, &nos[9], 9), SUCESSO);
+        NO_ARVORE* regravado = ler_no_arquivo(arquivo, 9);
+        assert_non_null(regravado);
+        assert_int_equal(regravado->livro.codigo, 10);
+        free(regravado);
+        fclose(arquivo);
+
+        // Formato antigo: o cabeçalho seguido direto dos nós.
+        arquivo = tmpfile();
+        assert_non_null(arquivo);
+        CABECALHO antigo = {0, 1, POSICAO_INVALIDA, 1};
+        assert_int_equal(fwrite(&antigo, sizeof(antigo), 1, arquivo), 1);
+        assert_int_equal(fwrite(&nos[0], sizeof(NO_ARVORE), 1, arquivo), 1);
+        assert_int_equal(inicializar_arquivo_cabecalho(arquivo), SUCESSO);
+        assert_null(le_cabecalho(arquivo));
+        fclose(arquivo);
+}
+
 /**
  * @test Verifica se remover_no_arquivo remove corretamente um nó e atualiza a lista livre.
  */
@@ -363,11 +428,135 @@ static void test_remover_no_arquivo_valido(void** state) {
         assert_int_equal(cabecalho.livre, 0);
 
         NO_ARVORE no_removido = {0};
-        fseek(arquivo, sizeof(CABECALHO) + 0 * sizeof(NO_ARVORE), SEEK_SET);
+        fseek(arquivo, deslocamento_no(0), SEEK_SET);
         fread(&no_removido, sizeof(NO_ARVORE), 1, arquivo);
         assert_int_equal(no_removido.filho_esquerdo, POSICAO_INVALIDA);
 }
 
+/**
+ * @test Remover um nó cujo sucessor é o próprio filho direito preserva o resto da árvore.
+ */
+static void test_remover_no_arvore_sucessor_filho_direito(void** state) {
+        (void)state;
+        FILE* arquivo = tmpfile();
+        assert_non_null(arquivo);
+        assert_int_equal(inicializar_arquivo_cabecalho(arquivo), SUCESSO);
+
+        const size_t codigos[] = {50, 30, 70, 80};
+        for (size_t i = 0; i < sizeof(codigos) / sizeof(codigos[0]); i++) {
+                NO_ARVORE no = {0};
+                no.livro = aux_criar_livro_valido(codigos[i]);
+                no.filho_esquerdo = no.filho_direito = POSICAO_INVALIDA;
+                assert_int_equal(inserir_no_arvore(arquivo, &no), SUCESSO);
+        }
+
+        // 70 não tem filho esquerdo: é o sucessor de 50.
+        assert_int_equal(remover_no_arvore(arquivo, 50), SUCESSO);
+
+        for (size_t i = 0; i < sizeof(codigos) / sizeof(codigos[0]); i++) {
+                RESULTADO_BUSCA resultado;
+                int esperado = codigos[i] == 50 ? ERRO_NO_NULO : SUCESSO;
+                assert_int_equal(buscar_no_arvore(arquivo, codigos[i], &resultado), esperado);
+                free(resultado.no);
+                free(resultado.pai);
+        }
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        assert_int_equal(cabecalho->quantidade_livros, 3);
+        free(cabecalho);
+        fclose(arquivo);
+}
+
+/**
+ * @brief Auxiliar: insere o código com inserir_no_arvore().
+ */
+static void aux_inserir_codigo(FILE* arquivo, size_t codigo) {
+        NO_ARVORE no = {0};
+        no.livro = aux_criar_livro_valido((int)codigo);
+        no.filho_esquerdo = no.filho_direito = POSICAO_INVALIDA;
+        assert_int_equal(inserir_no_arvore(arquivo, &no), SUCESSO);
+}
+
+/**
+ * @brief Auxiliar: altura da árvore, pelo diagnóstico.
+ */
+static size_t aux_altura(FILE* arquivo) {
+        DIAGNOSTICO_ARVORE diagnostico;
+        assert_int_equal(diagnosticar_arvore(arquivo, &diagnostico), SUCESSO);
+        assert_int_equal(diagnostico.ligacoes_invalidas, 0);
+        assert_int_equal(diagnostico.perdidas, 0);
+        size_t altura = diagnostico.altura;
+        liberar_diagnostico(&diagnostico);
+        return altura;
+}
+
+/**
+ * @test Com a reconstrução parcial, inserções em ordem crescente e decrescente mantêm a altura
+ * em até ⌊1,5·log2 n⌋ + 1 níveis, e a busca, o índice e as remoções continuam corretos.
+ */
+static void test_inserir_no_arvore_reconstrucao_parcial(void** state) {
+        (void)state;
+        char caminho[80];
+        snprintf(caminho, sizeof(caminho), "/tmp/test_arquivo_reconstrucao_%d.bin", getpid());
+        remove(caminho);
+        abrir_ou_criar_arquivo(caminho);
+        FILE* arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+        assert_int_equal(abrir_indice(arquivo, caminho), SUCESSO);
+
+        definir_reconstrucao_parcial(1);
+        assert_true(reconstrucao_parcial_ativa());
+        for (size_t codigo = 1001; codigo <= 2000; codigo++) aux_inserir_codigo(arquivo, codigo);
+        // 1000 livros: ⌊1,5·log2 1000⌋ = 14 arestas, 15 níveis.
+        assert_true(aux_altura(arquivo) <= 15);
+
+        for (size_t codigo = 1000; codigo >= 1; codigo--) aux_inserir_codigo(arquivo, codigo);
+        for (size_t codigo = 2; codigo <= 2000; codigo += 2)
+                assert_int_equal(remover_no_arvore(arquivo, codigo), SUCESSO);
+        for (size_t codigo = 2001; codigo <= 2500; codigo++) aux_inserir_codigo(arquivo, codigo);
+        definir_reconstrucao_parcial(0);
+        // 1500 livros: ⌊1,5·log2 1500⌋ = 15, e remoções não aprofundam a árvore.
+        assert_true(aux_altura(arquivo) <= 16);
+
+        for (size_t codigo = 1; codigo <= 2500; codigo++) {
+                int presente = codigo > 2000 || codigo % 2 == 1;
+                RESULTADO_BUSCA resultado = {0};
+                assert_int_equal(buscar_no_arvore(arquivo, codigo, &resultado),
+                                 presente ? SUCESSO : ERRO_NO_NULO);
+                free(resultado.no);
+                free(resultado.pai);
+
+                // O índice acompanha os nós movidos pelas reconstruções.
+                int posicao;
+                if (!presente) continue;
+                assert_int_equal(buscar_no_indice(arquivo, codigo, &posicao), SUCESSO);
+                NO_ARVORE* no = ler_no_arquivo(arquivo, posicao);
+                assert_non_null(no);
+                assert_int_equal(no->livro.codigo, codigo);
+                free(no);
+        }
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        assert_int_equal(cabecalho->quantidade_livros, 1500);
+        free(cabecalho);
+        fechar_indice(arquivo);
+        fclose(arquivo);
+        char sufixado[96];
+        snprintf(sufixado, sizeof(sufixado), "%s%s", caminho, SUFIXO_INDICE);
+        remove(sufixado);
+        remove(caminho);
+
+        // Sem a reconstrução, a mesma inserção em ordem vira uma lista.
+        arquivo = tmpfile();
+        assert_non_null(arquivo);
+        assert_int_equal(inicializar_arquivo_cabecalho(arquivo), SUCESSO);
+        for (size_t codigo = 1; codigo <= 100; codigo++) aux_inserir_codigo(arquivo, codigo);
+        assert_int_equal(aux_altura(arquivo), 100);
+        fclose(arquivo);
+}
+
 /**
  * @brief Retorna a lista de testes de arquivo a serem executados.
  *
@@ -391,9 +580,12 @@ const struct CMUnitTest* arquivo_tests(int* n) {
             cmocka_unit_test_setup_teardown(test_ler_no_arquivo_valido,
                                             setup_criar_arquivo_valido_sem_lista_livre,
                                             teardown_arquivo_valido),
+            cmocka_unit_test(test_paginas_e_somas),
             cmocka_unit_test_setup_teardown(test_remover_no_arquivo_valido,
                                             setup_criar_arquivo_valido_sem_lista_livre,
-                                            teardown_arquivo_valido)};
+                                            teardown_arquivo_valido),
+            cmocka_unit_test(test_remover_no_arvore_sucessor_filho_direito),
+            cmocka_unit_test(test_inserir_no_arvore_reconstrucao_parcial)};
 
         *n = sizeof(tests) / sizeof(tests[0]);
         return tests;
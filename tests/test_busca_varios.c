@@ -0,0 +1,179 @@
+/**
+ * @file test_busca_varios.c
+ * @brief Testes unitários para a busca de vários códigos por nível.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+
+#include "../include/acesso_direto.h"
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/busca_varios.h"
+#include "../include/erros.h"
+#include "../include/livro.h"
+#include "auxiliares.h"
+
+/** Livros do catálogo dos testes. */
+#define LIVROS_CATALOGO 2000
+
+/** Códigos buscados de uma vez: presentes, removidos, ausentes e repetidos. */
+#define CODIGOS_BUSCADOS 1000
+
+/**
+ * @brief Auxiliar: cria em /tmp um catálogo com os códigos 1 a LIVROS_CATALOGO, cadastrados
+ * numa ordem embaralhada, sem os múltiplos de 10.
+ */
+static FILE* aux_criar_catalogo(char* caminho, size_t tamanho, const char* nome) {
+        FILE* arquivo = aux_criar_arquivo(caminho, tamanho, "busca_varios", nome);
+        aux_cadastrar_embaralhados(arquivo, LIVROS_CATALOGO, 1);
+        for (size_t codigo = 10; codigo <= LIVROS_CATALOGO; codigo += 10)
+                assert_int_equal(remover_no_arvore(arquivo, codigo), SUCESSO);
+        return arquivo;
+}
+
+/**
+ * @brief Auxiliar: preenche os códigos buscados, fora de ordem, com repetições e com códigos
+ * fora do catálogo.
+ */
+static void aux_preencher_codigos(size_t codigos[]) {
+        for (size_t i = 0; i < CODIGOS_BUSCADOS; i++) codigos[i] = (i * 7919) % 2500;
+        codigos[CODIGOS_BUSCADOS - 1] = codigos[0];
+}
+
+/**
+ * @brief Auxiliar: busca os códigos de uma vez e confere cada resultado com buscar_no_arvore().
+ */
+static void aux_conferir_com_busca_unica(FILE* arquivo, const size_t codigos[]) {
+        RESULTADO_VARIOS* resultados = malloc(CODIGOS_BUSCADOS * sizeof(RESULTADO_VARIOS));
+        assert_non_null(resultados);
+        assert_int_equal(buscar_varios(arquivo, codigos, CODIGOS_BUSCADOS, resultados), SUCESSO);
+
+        size_t encontrados = 0;
+        for (size_t i = 0; i < CODIGOS_BUSCADOS; i++) {
+                RESULTADO_BUSCA esperado = {0};
+                int status = buscar_no_arvore(arquivo, codigos[i], &esperado);
+                if (status == SUCESSO) {
+                        char titulo[sizeof(resultados[i].livro.titulo)];
+                        snprintf(titulo, sizeof(titulo), "Livro %zu", codigos[i]);
+                        assert_int_equal(resultados[i].status, SUCESSO);
+                        assert_int_equal(resultados[i].posicao, esperado.posicao_no);
+                        assert_int_equal(resultados[i].livro.codigo, codigos[i]);
+                        assert_string_equal(resultados[i].livro.titulo, titulo);
+                        encontrados++;
+                } else {
+                        assert_int_equal(resultados[i].status, ERRO_NO_NULO);
+                        assert_int_equal(resultados[i].posicao, POSICAO_INVALIDA);
+                }
+                free(esperado.no);
+                free(esperado.pai);
+        }
+        assert_true(encontrados > 0 && encontrados < CODIGOS_BUSCADOS);
+        free(resultados);
+}
+
+/**
+ * @test Pelo io_uring, pelas threads e sem nenhum dos dois, os resultados são os mesmos das
+ * buscas uma a uma; o anel e as threads do handle servem a várias chamadas.
+ */
+static void test_buscar_varios_igual_busca_unica(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_catalogo(caminho, sizeof(caminho), "unica");
+        size_t codigos[CODIGOS_BUSCADOS];
+        aux_preencher_codigos(codigos);
+
+        aux_conferir_com_busca_unica(arquivo, codigos);
+
+        assert_true(io_uring_ativo());
+        assert_int_equal(abrir_busca_varios(arquivo), SUCESSO);
+        assert_int_equal(abrir_busca_varios(arquivo), SUCESSO);
+        aux_conferir_com_busca_unica(arquivo, codigos);
+        aux_conferir_com_busca_unica(arquivo, codigos);
+        assert_int_equal(fechar_busca_varios(arquivo), SUCESSO);
+        assert_int_equal(fechar_busca_varios(arquivo), ERRO_ARQUIVO_NULO);
+
+        definir_io_uring(0);
+        assert_false(io_uring_ativo());
+        assert_int_equal(abrir_busca_varios(arquivo), SUCESSO);
+        aux_conferir_com_busca_unica(arquivo, codigos);
+        aux_conferir_com_busca_unica(arquivo, codigos);
+        assert_int_equal(fechar_busca_varios(arquivo), SUCESSO);
+        definir_io_uring(1);
+
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @test Com o pool do acesso direto, as páginas vêm dele e os resultados continuam certos.
+ */
+static void test_buscar_varios_pelo_pool(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_catalogo(caminho, sizeof(caminho), "pool");
+        size_t codigos[CODIGOS_BUSCADOS];
+        aux_preencher_codigos(codigos);
+
+        assert_int_equal(abrir_acesso_direto(arquivo, caminho, 64), SUCESSO);
+        ESTADO_ACESSO_DIRETO antes, depois;
+        assert_int_equal(consultar_acesso_direto(arquivo, &antes), SUCESSO);
+        aux_conferir_com_busca_unica(arquivo, codigos);
+        assert_int_equal(consultar_acesso_direto(arquivo, &depois), SUCESSO);
+        assert_true(depois.acertos > antes.acertos);
+
+        assert_int_equal(fechar_acesso_direto(arquivo), SUCESSO);
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @test Casos de borda: árvore vazia, lista vazia, um código só e argumentos nulos.
+ */
+static void test_buscar_varios_bordas(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "busca_varios", "bordas");
+
+        size_t codigos[] = {1, 2, 3};
+        RESULTADO_VARIOS resultados[3];
+        assert_int_equal(buscar_varios(NULL, codigos, 3, resultados), ERRO_ARQUIVO_NULO);
+        assert_int_equal(abrir_busca_varios(NULL), ERRO_ARQUIVO_NULO);
+        assert_int_equal(buscar_varios(arquivo, codigos, 0, resultados), SUCESSO);
+        assert_int_equal(buscar_varios(arquivo, NULL, 3, resultados), ERRO_RESULTADO_BUSCA_NULO);
+
+        assert_int_equal(buscar_varios(arquivo, codigos, 3, resultados), SUCESSO);
+        for (size_t i = 0; i < 3; i++) assert_int_equal(resultados[i].status, ERRO_NO_NULO);
+
+        LIVRO livro = {0};
+        livro.codigo = 2;
+        assert_int_equal(cadastrar_livro(arquivo, livro), SUCESSO);
+        assert_int_equal(buscar_varios(arquivo, &codigos[1], 1, resultados), SUCESSO);
+        assert_int_equal(resultados[0].status, SUCESSO);
+        assert_int_equal(resultados[0].livro.codigo, 2);
+
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @brief Retorna a lista de testes da busca de vários códigos a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* busca_varios_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_buscar_varios_igual_busca_unica),
+            cmocka_unit_test(test_buscar_varios_pelo_pool),
+            cmocka_unit_test(test_buscar_varios_bordas)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file test_catalogo_sintetico.c
+ * @brief Testes unitários para o gerador de catálogos sintéticos.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/catalogo_sintetico.h"
+#include "../include/erros.h"
+#include "../include/importacao.h"
+#include "../include/importacao_paralela.h"
+#include "../include/livro.h"
+
+/** Linhas dos catálogos dos testes. */
+#define LINHAS_CATALOGO 3000
+
+/**
+ * Livros de um arquivo, na ordem do percurso em ordem.
+ */
+typedef struct {
+        LIVRO* livros;     /**< Livros lidos. */
+        size_t quantidade; /**< Livros em `livros`. */
+        size_t capacidade; /**< Espaço alocado em `livros`. */
+} DESPEJO;
+
+/**
+ * @brief Visitante que acrescenta o livro do nó ao despejo.
+ */
+static int despejar_no(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)posicao;
+        DESPEJO* despejo = contexto;
+        if (despejo->quantidade == despejo->capacidade) {
+                despejo->capacidade = despejo->capacidade ? despejo->capacidade * 2 : 256;
+                despejo->livros = realloc(despejo->livros, despejo->capacidade * sizeof(LIVRO));
+                assert_non_null(despejo->livros);
+        }
+        despejo->livros[despejo->quantidade++] = no->livro;
+        return SUCESSO;
+}
+
+/**
+ * @brief Auxiliar: lê os livros do arquivo em ordem de código.
+ */
+static DESPEJO aux_despejar(const char* caminho) {
+        DESPEJO despejo = {0};
+        FILE* arquivo = fopen(caminho, "rb");
+        assert_non_null(arquivo);
+        assert_int_equal(percorrer_em_ordem(arquivo, despejar_no, &despejo), SUCESSO);
+        fclose(arquivo);
+        return despejo;
+}
+
+/**
+ * @brief Auxiliar: confere que os dois despejos têm os mesmos livros, campo a campo.
+ */
+static void aux_comparar_despejos(const DESPEJO* a, const DESPEJO* b) {
+        assert_int_equal(a->quantidade, b->quantidade);
+        for (size_t i = 0; i < a->quantidade; i++) {
+                const LIVRO* x = &a->livros[i];
+                const LIVRO* y = &b->livros[i];
+                assert_int_equal(x->codigo, y->codigo);
+                assert_string_equal(x->titulo, y->titulo);
+                assert_string_equal(x->autor, y->autor);
+                assert_string_equal(x->editora, y->editora);
+                assert_int_equal(x->edicao, y->edicao);
+                assert_int_equal(x->ano, y->ano);
+                assert_int_equal(x->exemplares, y->exemplares);
+                assert_true(x->preco == y->preco);
+        }
+}
+
+/**
+ * @brief Auxiliar: gera o catálogo em texto e em binário e confere que importar o texto, um a
+ * um ou pelo pipeline, dá os mesmos livros que o caminho rápido.
+ */
+static void aux_texto_igual_binario(DISTRIBUICAO_CATALOGO distribuicao, double duplicatas) {
+        CATALOGO_SINTETICO catalogo = {0};
+        catalogo.linhas = LINHAS_CATALOGO;
+        catalogo.semente = 7;
+        catalogo.distribuicao = distribuicao;
+        catalogo.grupo = 64;
+        catalogo.duplicatas = duplicatas;
+        catalogo.comprimento_minimo = 5;
+        catalogo.comprimento_maximo = 220;
+        catalogo.cauda = 1;
+        preparar_catalogo_sintetico(&catalogo, 0.99);
+
+        char caminho_txt[64], caminho_rapido[64], caminho_serial[64], caminho_pipeline[64];
+        snprintf(caminho_txt, sizeof(caminho_txt), "/tmp/test_sintetico_%d.txt", getpid());
+        snprintf(caminho_rapido, sizeof(caminho_rapido), "/tmp/test_sintetico_b_%d.bin",
+                 getpid());
+        snprintf(caminho_serial, sizeof(caminho_serial), "/tmp/test_sintetico_s_%d.bin",
+                 getpid());
+        snprintf(caminho_pipeline, sizeof(caminho_pipeline), "/tmp/test_sintetico_p_%d.bin",
+                 getpid());
+        remove(caminho_rapido);
+        remove(caminho_serial);
+        remove(caminho_pipeline);
+
+        FILE* txt = fopen(caminho_txt, "w");
+        assert_non_null(txt);
+        assert_int_equal(escrever_catalogo_texto(&catalogo, txt), SUCESSO);
+        fclose(txt);
+
+        size_t distintos = 0;
+        assert_int_equal(escrever_catalogo_binario(&catalogo, caminho_rapido, &distintos),
+                         SUCESSO);
+        assert_true(distintos > 0 && distintos <= LINHAS_CATALOGO);
+        if (duplicatas > 0 || distribuicao == DISTRIBUICAO_ZIPF)
+                assert_true(distintos < LINHAS_CATALOGO);
+
+        abrir_ou_criar_arquivo(caminho_serial);
+        FILE* serial = fopen(caminho_serial, "rb+");
+        assert_non_null(serial);
+        RELATORIO_IMPORTACAO relatorio;
+        assert_int_equal(importar_texto(caminho_txt, serial, cadastrar_livro, NULL, &relatorio),
+                         SUCESSO);
+        assert_int_equal(relatorio.cadastrados, distintos);
+        assert_int_equal(relatorio.rejeitados, LINHAS_CATALOGO - distintos);
+        fclose(serial);
+
+        abrir_ou_criar_arquivo(caminho_pipeline);
+        FILE* pipeline = fopen(caminho_pipeline, "rb+");
+        assert_non_null(pipeline);
+        RELATORIO_PIPELINE relatorio_pipeline;
+        assert_int_equal(importar_texto_paralelo(caminho_txt, pipeline, 2, NULL,
+                                                 &relatorio_pipeline),
+                         SUCESSO);
+        assert_int_equal(relatorio_pipeline.totais.cadastrados, distintos);
+        fclose(pipeline);
+
+        DESPEJO rapido = aux_despejar(caminho_rapido);
+        DESPEJO importado = aux_despejar(caminho_serial);
+        DESPEJO paralelo = aux_despejar(caminho_pipeline);
+        assert_int_equal(rapido.quantidade, distintos);
+        aux_comparar_despejos(&rapido, &importado);
+        aux_comparar_despejos(&rapido, &paralelo);
+
+        free(rapido.livros);
+        free(importado.livros);
+        free(paralelo.livros);
+        remove(caminho_txt);
+        remove(caminho_rapido);
+        remove(caminho_serial);
+        remove(caminho_pipeline);
+}
+
+/**
+ * @test Sem duplicatas, o texto importado e o binário do caminho rápido têm os mesmos livros.
+ */
+static void test_texto_igual_binario(void** state) {
+        (void)state;
+        aux_texto_igual_binario(DISTRIBUICAO_ALEATORIA, 0);
+        aux_texto_igual_binario(DISTRIBUICAO_REVERSA, 0);
+}
+
+/**
+ * @test Com códigos repetidos (`-r` e zipf), a importação fica com um livro por código, o mesmo
+ *       que o caminho rápido grava.
+ */
+static void test_texto_igual_binario_com_duplicatas(void** state) {
+        (void)state;
+        aux_texto_igual_binario(DISTRIBUICAO_ALEATORIA, 0.3);
+        aux_texto_igual_binario(DISTRIBUICAO_AGRUPADA, 0.1);
+        aux_texto_igual_binario(DISTRIBUICAO_ZIPF, 0.2);
+}
+
+/**
+ * @test O mesmo catálogo gera sempre o mesmo texto; outra semente gera outro.
+ */
+static void test_catalogo_reprodutivel(void** state) {
+        (void)state;
+        char* textos[3];
+        size_t tamanhos[3];
+        for (int i = 0; i < 3; i++) {
+                CATALOGO_SINTETICO catalogo = {0};
+                catalogo.linhas = 200;
+                catalogo.semente = i < 2 ? 1 : 2;
+                catalogo.distribuicao = DISTRIBUICAO_ZIPF;
+                catalogo.comprimento_minimo = 10;
+                catalogo.comprimento_maximo = 60;
+                catalogo.duplicatas = 0.1;
+                preparar_catalogo_sintetico(&catalogo, 0.99);
+
+                FILE* saida = open_memstream(&textos[i], &tamanhos[i]);
+                assert_non_null(saida);
+                assert_int_equal(escrever_catalogo_texto(&catalogo, saida), SUCESSO);
+                fclose(saida);
+        }
+        assert_int_equal(tamanhos[0], tamanhos[1]);
+        assert_memory_equal(textos[0], textos[1], tamanhos[0]);
+        assert_true(tamanhos[0] != tamanhos[2] || memcmp(textos[0], textos[2], tamanhos[0]) != 0);
+        for (int i = 0; i < 3; i++) free(textos[i]);
+}
+
+/**
+ * @brief Retorna a lista de testes do catálogo sintético a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* catalogo_sintetico_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_texto_igual_binario),
+            cmocka_unit_test(test_texto_igual_binario_com_duplicatas),
+            cmocka_unit_test(test_catalogo_reprodutivel)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -0,0 +1,214 @@
+/**
+ * @file test_compressao.c
+ * @brief Testes unitários para o codec LZ e o catálogo compactado.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+
+#include "../include/arquivo.h"
+#include "../include/catalogo_compactado.h"
+#include "../include/compressao.h"
+#include "../include/concorrencia.h"
+#include "../include/erros.h"
+
+/**
+ * @brief Auxiliar: comprime e descomprime `tamanho` bytes, verificando que voltam iguais.
+ *
+ * @param[in] dados Bytes de entrada.
+ * @param[in] tamanho Quantidade de bytes.
+ * @return Tamanho do bloco comprimido.
+ */
+static size_t aux_ida_e_volta(const unsigned char* dados, size_t tamanho) {
+        size_t capacidade = limite_comprimido_lz(tamanho);
+        unsigned char* comprimido = malloc(capacidade);
+        unsigned char* restaurado = malloc(tamanho + 1);
+        assert_non_null(comprimido);
+        assert_non_null(restaurado);
+
+        size_t tamanho_comprimido = 0;
+        assert_int_equal(comprimir_lz(dados, tamanho, comprimido, capacidade, &tamanho_comprimido),
+                         SUCESSO);
+
+        size_t tamanho_restaurado = 0;
+        assert_int_equal(descomprimir_lz(comprimido, tamanho_comprimido, restaurado, tamanho + 1,
+                                         &tamanho_restaurado),
+                         SUCESSO);
+        assert_int_equal(tamanho_restaurado, tamanho);
+        assert_memory_equal(restaurado, dados, tamanho);
+
+        free(comprimido);
+        free(restaurado);
+        return tamanho_comprimido;
+}
+
+/**
+ * @test Dados repetitivos (como um LIVRO com campos preenchidos com zeros) comprimem bem.
+ */
+static void test_lz_dados_repetitivos(void** state) {
+        (void)state;
+        unsigned char dados[4096] = {0};
+        memcpy(dados, "Dom Casmurro;Machado de Assis", 29);
+        memcpy(dados + 2048, "Dom Casmurro;Machado de Assis", 29);
+
+        size_t tamanho = aux_ida_e_volta(dados, sizeof(dados));
+        assert_true(tamanho < sizeof(dados) / 10);
+}
+
+/**
+ * @test Dados pseudoaleatórios não comprimem, mas não ultrapassam o limite calculado.
+ */
+static void test_lz_dados_aleatorios(void** state) {
+        (void)state;
+        unsigned char dados[5000];
+        unsigned int semente = 12345;
+        for (size_t i = 0; i < sizeof(dados); i++) {
+                semente = semente * 1103515245u + 12345u;
+                dados[i] = (unsigned char)(semente >> 16);
+        }
+
+        size_t tamanho = aux_ida_e_volta(dados, sizeof(dados));
+        assert_true(tamanho <= limite_comprimido_lz(sizeof(dados)));
+}
+
+/**
+ * @test Entradas vazias e menores que uma repetição mínima viram apenas literais.
+ */
+static void test_lz_entradas_pequenas(void** state) {
+        (void)state;
+        const unsigned char dados[] = "abc";
+        aux_ida_e_volta(dados, 0);
+        aux_ida_e_volta(dados, 3);
+}
+
+/**
+ * @test Um bloco com deslocamento apontando antes do início é rejeitado.
+ */
+static void test_lz_bloco_corrompido(void** state) {
+        (void)state;
+        // Token: 1 literal e repetição; deslocamento 5 com apenas 1 byte já produzido
+        const unsigned char corrompido[] = {0x10, 'a', 0x05, 0x00};
+        unsigned char saida[64];
+        size_t tamanho;
+        assert_int_equal(descomprimir_lz(corrompido, sizeof(corrompido), saida, sizeof(saida),
+                                         &tamanho),
+                         ERRO_COMPRESSAO);
+}
+
+/**
+ * @test Compacta uma árvore com vários blocos, busca por endereço e confirma a economia de bytes.
+ */
+static void test_catalogo_compactado_busca(void** state) {
+        (void)state;
+        FILE* arquivo = tmpfile();
+        FILE* destino = tmpfile();
+        assert_non_null(arquivo);
+        assert_non_null(destino);
+        assert_int_equal(inicializar_arquivo_cabecalho(arquivo), SUCESSO);
+
+        // Ordem embaralhada para a árvore não degenerar
+        const size_t total = 3 * LIVROS_POR_BLOCO + 5;
+        for (size_t i = 0; i < total; i++) {
+                NO_ARVORE no = {0};
+                no.livro.codigo = ((i * 37) % total) * 2 + 1;
+                snprintf(no.livro.titulo, sizeof(no.livro.titulo), "Titulo %zu", no.livro.codigo);
+                no.filho_esquerdo = POSICAO_INVALIDA;
+                no.filho_direito = POSICAO_INVALIDA;
+                assert_int_equal(inserir_no_arvore(arquivo, &no), SUCESSO);
+        }
+
+        assert_int_equal(compactar_catalogo(arquivo, destino), SUCESSO);
+
+        CATALOGO_COMPACTADO* catalogo = abrir_catalogo_compactado(destino);
+        assert_non_null(catalogo);
+        assert_int_equal(catalogo->cabecalho.quantidade_livros, total);
+        assert_int_equal(catalogo->cabecalho.quantidade_blocos, 4);
+
+        ENDERECO_COMPACTADO endereco;
+        size_t codigo = 2 * (LIVROS_POR_BLOCO + LIVROS_POR_BLOCO / 2) + 1;
+        assert_int_equal(localizar_livro_compactado(catalogo, codigo, &endereco), SUCESSO);
+        assert_int_equal(endereco.bloco, 1);
+        assert_int_equal(endereco.slot, LIVROS_POR_BLOCO / 2);
+
+        LIVRO livro;
+        assert_int_equal(buscar_livro_compactado(catalogo, 99, &livro), SUCESSO);
+        assert_string_equal(livro.titulo, "Titulo 99");
+        assert_int_equal(buscar_livro_compactado(catalogo, 100, &livro), ERRO_LIVRO_INVALIDO);
+        assert_int_equal(buscar_livro_compactado(catalogo, 0, &livro), ERRO_LIVRO_INVALIDO);
+
+        // Cabeçalho + diretório + todos os blocos devem ser bem menores que os nós brutos
+        fseek(destino, 0, SEEK_END);
+        assert_true((size_t)ftell(destino) * 4 < total * sizeof(NO_ARVORE));
+
+        fechar_catalogo_compactado(catalogo);
+        fclose(destino);
+        fclose(arquivo);
+}
+
+/**
+ * @test O catálogo deixa de ser atual quando o arquivo de origem é alterado, e não vale para
+ * outro arquivo de livros.
+ */
+static void test_catalogo_compactado_desatualizado(void** state) {
+        (void)state;
+        FILE* arquivo = tmpfile();
+        FILE* outro = tmpfile();
+        FILE* destino = tmpfile();
+        assert_non_null(arquivo);
+        assert_non_null(outro);
+        assert_non_null(destino);
+        assert_int_equal(inicializar_arquivo_cabecalho(arquivo), SUCESSO);
+        assert_int_equal(inicializar_arquivo_cabecalho(outro), SUCESSO);
+
+        LIVRO livro = {0};
+        livro.codigo = 1;
+        assert_int_equal(cadastrar_livro_concorrente(arquivo, livro), SUCESSO);
+        assert_int_equal(compactar_catalogo(arquivo, destino), SUCESSO);
+
+        CATALOGO_COMPACTADO* catalogo = abrir_catalogo_compactado(destino);
+        assert_non_null(catalogo);
+        assert_true(catalogo_compactado_atual(catalogo, arquivo));
+        assert_false(catalogo_compactado_atual(catalogo, outro));
+        assert_false(catalogo_compactado_atual(NULL, arquivo));
+
+        livro.codigo = 2;
+        assert_int_equal(cadastrar_livro_concorrente(arquivo, livro), SUCESSO);
+        assert_false(catalogo_compactado_atual(catalogo, arquivo));
+        fechar_catalogo_compactado(catalogo);
+
+        assert_int_equal(compactar_catalogo(arquivo, destino), SUCESSO);
+        catalogo = abrir_catalogo_compactado(destino);
+        assert_non_null(catalogo);
+        assert_true(catalogo_compactado_atual(catalogo, arquivo));
+        assert_int_equal(catalogo->cabecalho.quantidade_livros, 2);
+
+        fechar_catalogo_compactado(catalogo);
+        fclose(destino);
+        fclose(outro);
+        fclose(arquivo);
+}
+
+/**
+ * @brief Retorna a lista de testes de compressão a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* compressao_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_lz_dados_repetitivos),
+            cmocka_unit_test(test_lz_dados_aleatorios),
+            cmocka_unit_test(test_lz_entradas_pequenas),
+            cmocka_unit_test(test_lz_bloco_corrompido),
+            cmocka_unit_test(test_catalogo_compactado_busca),
+            cmocka_unit_test(test_catalogo_compactado_desatualizado)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
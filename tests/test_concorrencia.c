@@ -0,0 +1,182 @@
+/**
+ * @file test_concorrencia.c
+ * @brief Testes unitários para as travas entre leitores e escritores.
+ */
+
+#define _GNU_SOURCE  // F_OFD_GETLK
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/concorrencia.h"
+#include "../include/erros.h"
+
+/// @brief Caminho do arquivo dos testes.
+static char caminho[80];
+
+/**
+ * @brief Setup: cria um arquivo de livros vazio em /tmp.
+ */
+static int setup_arquivo(void** state) {
+        (void)state;
+        snprintf(caminho, sizeof(caminho), "/tmp/test_concorrencia_%d.bin", getpid());
+        remove(caminho);
+        abrir_ou_criar_arquivo(caminho);
+        return 0;
+}
+
+/**
+ * @brief Teardown: apaga o arquivo dos testes.
+ */
+static int teardown_arquivo(void** state) {
+        (void)state;
+        remove(caminho);
+        return 0;
+}
+
+/**
+ * @brief Auxiliar: tipo da trava que impede `tipo` numa descrição aberta nova do arquivo.
+ *
+ * @return F_UNLCK se nada impede, ou F_RDLCK/F_WRLCK da trava em conflito.
+ */
+static short aux_trava_em_conflito(short tipo) {
+        int descritor = open(caminho, O_RDWR);
+        assert_true(descritor >= 0);
+
+        struct flock trava = {0};
+        trava.l_type = tipo;
+        trava.l_whence = SEEK_SET;
+        assert_int_equal(fcntl(descritor, F_OFD_GETLK, &trava), 0);
+
+        close(descritor);
+        return trava.l_type;
+}
+
+/**
+ * @brief Auxiliar: em outro processo, tenta obter `tipo` sem esperar.
+ *
+ * @return 1 se o outro processo conseguiu, 0 se a trava estava ocupada.
+ */
+static int aux_outro_processo_consegue(short tipo) {
+        pid_t filho = fork();
+        assert_true(filho >= 0);
+        if (filho == 0) {
+                int descritor = open(caminho, O_RDWR);
+                struct flock trava = {0};
+                trava.l_type = tipo;
+                trava.l_whence = SEEK_SET;
+                _exit(descritor >= 0 && fcntl(descritor, F_SETLK, &trava) == 0 ? 1 : 0);
+        }
+
+        int situacao = 0;
+        assert_int_equal(waitpid(filho, &situacao, 0), filho);
+        assert_true(WIFEXITED(situacao));
+        return WEXITSTATUS(situacao);
+}
+
+/**
+ * @test Leitores não impedem leitores, mas impedem escritores, neste e em outros processos.
+ */
+static void test_leitura_exclui_escrita(void** state) {
+        (void)state;
+        FILE* arquivo = fopen(caminho, "rb");
+        assert_non_null(arquivo);
+
+        assert_int_equal(travar_arquivo(arquivo, TRAVA_LEITURA), SUCESSO);
+        assert_int_equal(aux_trava_em_conflito(F_RDLCK), F_UNLCK);
+        assert_int_equal(aux_trava_em_conflito(F_WRLCK), F_RDLCK);
+        assert_int_equal(aux_outro_processo_consegue(F_RDLCK), 1);
+        assert_int_equal(aux_outro_processo_consegue(F_WRLCK), 0);
+
+        assert_int_equal(destravar_arquivo(arquivo, TRAVA_LEITURA), SUCESSO);
+        assert_int_equal(aux_trava_em_conflito(F_WRLCK), F_UNLCK);
+        assert_int_equal(aux_outro_processo_consegue(F_WRLCK), 1);
+        fclose(arquivo);
+}
+
+/**
+ * @test O escritor exclui leitores e escritores de outras descrições e de outros processos.
+ */
+static void test_escrita_exclui_todos(void** state) {
+        (void)state;
+        FILE* arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+
+        assert_int_equal(travar_arquivo(arquivo, TRAVA_ESCRITA), SUCESSO);
+        assert_int_equal(aux_trava_em_conflito(F_RDLCK), F_WRLCK);
+        assert_int_equal(aux_outro_processo_consegue(F_RDLCK), 0);
+
+        assert_int_equal(destravar_arquivo(arquivo, TRAVA_ESCRITA), SUCESSO);
+        assert_int_equal(aux_trava_em_conflito(F_WRLCK), F_UNLCK);
+        fclose(arquivo);
+}
+
+/**
+ * @test Com dois `FILE*` do mesmo arquivo, cada um guarda a sua trava: o primeiro a terminar
+ * não libera a do outro, e fechar um terceiro `FILE*` não libera nenhuma.
+ */
+static void test_dois_arquivos_mesmo_inode(void** state) {
+        (void)state;
+        FILE* primeiro = fopen(caminho, "rb");
+        FILE* segundo = fopen(caminho, "rb");
+        assert_non_null(primeiro);
+        assert_non_null(segundo);
+
+        assert_int_equal(travar_arquivo(primeiro, TRAVA_LEITURA), SUCESSO);
+        assert_int_equal(travar_arquivo(segundo, TRAVA_LEITURA), SUCESSO);
+        assert_int_equal(travar_arquivo(segundo, TRAVA_LEITURA), SUCESSO);
+
+        FILE* terceiro = fopen(caminho, "rb");
+        assert_non_null(terceiro);
+        fclose(terceiro);
+        assert_int_equal(aux_trava_em_conflito(F_WRLCK), F_RDLCK);
+
+        assert_int_equal(destravar_arquivo(primeiro, TRAVA_LEITURA), SUCESSO);
+        fclose(primeiro);
+        assert_int_equal(aux_trava_em_conflito(F_WRLCK), F_RDLCK);
+        assert_int_equal(aux_outro_processo_consegue(F_WRLCK), 0);
+
+        assert_int_equal(destravar_arquivo(segundo, TRAVA_LEITURA), SUCESSO);
+        assert_int_equal(aux_trava_em_conflito(F_WRLCK), F_RDLCK);
+        assert_int_equal(destravar_arquivo(segundo, TRAVA_LEITURA), SUCESSO);
+        assert_int_equal(aux_trava_em_conflito(F_WRLCK), F_UNLCK);
+        fclose(segundo);
+}
+
+/**
+ * @test Argumentos nulos.
+ */
+static void test_travar_bordas(void** state) {
+        (void)state;
+        assert_int_equal(travar_arquivo(NULL, TRAVA_LEITURA), ERRO_ARQUIVO_NULO);
+        assert_int_equal(destravar_arquivo(NULL, TRAVA_ESCRITA), ERRO_ARQUIVO_NULO);
+}
+
+/**
+ * @brief Retorna a lista de testes das travas a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* concorrencia_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test_setup_teardown(test_leitura_exclui_escrita, setup_arquivo,
+                                            teardown_arquivo),
+            cmocka_unit_test_setup_teardown(test_escrita_exclui_todos, setup_arquivo,
+                                            teardown_arquivo),
+            cmocka_unit_test_setup_teardown(test_dois_arquivos_mesmo_inode, setup_arquivo,
+                                            teardown_arquivo),
+            cmocka_unit_test(test_travar_bordas)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file test_diagnostico.c
+ * @brief Testes unitários para o diagnóstico da árvore de diagnostico.h.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/diagnostico.h"
+#include "../include/erros.h"
+#include "../include/livro.h"
+#include "auxiliares.h"
+
+/** Livros da árvore degenerada. */
+#define LIVROS_EM_FILA 10
+
+/**
+ * @test Árvore perfeita de 7 nós: altura e caminho médio mínimos, sem desequilíbrio.
+ */
+static void test_diagnostico_arvore_perfeita(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "diagnostico", "perfeita");
+
+        const size_t codigos[] = {4, 2, 6, 1, 3, 5, 7};
+        for (size_t i = 0; i < 7; i++) aux_cadastrar(arquivo, codigos[i]);
+
+        DIAGNOSTICO_ARVORE diagnostico;
+        assert_int_equal(diagnosticar_arvore(arquivo, &diagnostico), SUCESSO);
+        assert_int_equal(diagnostico.posicoes, 7);
+        assert_int_equal(diagnostico.vivas, 7);
+        assert_int_equal(diagnostico.livres, 0);
+        assert_int_equal(diagnostico.perdidas, 0);
+        assert_int_equal(diagnostico.ligacoes_invalidas, 0);
+        assert_int_equal(diagnostico.altura, 3);
+        assert_int_equal(diagnostico.altura_minima, 3);
+        assert_int_equal(diagnostico.profundidades[0], 1);
+        assert_int_equal(diagnostico.profundidades[1], 2);
+        assert_int_equal(diagnostico.profundidades[2], 4);
+        assert_true(diagnostico.caminho_medio == 17.0 / 7);
+        assert_true(diagnostico.caminho_medio_minimo == 17.0 / 7);
+        assert_int_equal(diagnostico.maior_diferenca_altura, 0);
+        assert_int_equal(diagnostico.nos_desbalanceados, 0);
+        assert_int_equal(diagnostico.maior_desbalanceada, POSICAO_INVALIDA);
+        assert_false(diagnostico.rebalancear);
+        assert_false(diagnostico.compactar);
+
+        FILE* json = tmpfile();
+        assert_non_null(json);
+        assert_int_equal(imprimir_diagnostico(json, &diagnostico, DIAGNOSTICO_JSON), SUCESSO);
+        rewind(json);
+        char linha[1024];
+        assert_non_null(fgets(linha, sizeof(linha), json));
+        fclose(json);
+        assert_int_equal(strncmp(linha, "{\"posicoes\":7,\"vivas\":7,\"livres\":0,", 35), 0);
+        assert_non_null(strstr(linha, "\"profundidades\":[1,2,4]"));
+        assert_non_null(strstr(linha, "\"rebalancear\":false,\"compactar\":false}"));
+
+        liberar_diagnostico(&diagnostico);
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @test Árvore em fila com remoções: altura, desequilíbrio, lista livre e recomendações.
+ */
+static void test_diagnostico_arvore_em_fila(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "diagnostico", "fila");
+
+        // Inserção ordenada: cada nó é o filho direito do anterior, na posição codigo - 1.
+        for (size_t codigo = 1; codigo <= LIVROS_EM_FILA; codigo++)
+                aux_cadastrar(arquivo, codigo);
+
+        DIAGNOSTICO_ARVORE diagnostico;
+        assert_int_equal(diagnosticar_arvore(arquivo, &diagnostico), SUCESSO);
+        assert_int_equal(diagnostico.vivas, LIVROS_EM_FILA);
+        assert_int_equal(diagnostico.altura, LIVROS_EM_FILA);
+        assert_int_equal(diagnostico.altura_minima, 4);
+        assert_true(diagnostico.caminho_medio == 5.5);
+        assert_int_equal(diagnostico.maior_diferenca_altura, LIVROS_EM_FILA - 1);
+        // Todos menos os dois últimos têm uma subárvore vazia e outra com altura de 2 ou mais.
+        assert_int_equal(diagnostico.nos_desbalanceados, LIVROS_EM_FILA - 2);
+        assert_int_equal(diagnostico.maior_desbalanceada, 0);
+        assert_int_equal(diagnostico.tamanho_maior_desbalanceada, LIVROS_EM_FILA);
+        for (size_t i = 0; i < LIVROS_EM_FILA; i++)
+                assert_int_equal(diagnostico.profundidades[i], 1);
+        assert_true(diagnostico.rebalancear);
+        assert_false(diagnostico.compactar);
+        liberar_diagnostico(&diagnostico);
+
+        // Remover as folhas 10, 9 e 8 e os livros 2 e 4 libera as posições 9, 8, 7, 1 e 3.
+        const size_t removidos[] = {10, 9, 8, 2, 4};
+        for (size_t i = 0; i < 5; i++)
+                assert_int_equal(remover_no_arvore(arquivo, removidos[i]), SUCESSO);
+
+        assert_int_equal(diagnosticar_arvore(arquivo, &diagnostico), SUCESSO);
+        assert_int_equal(diagnostico.posicoes, LIVROS_EM_FILA);
+        assert_int_equal(diagnostico.vivas, 5);
+        assert_int_equal(diagnostico.livres, 5);
+        assert_int_equal(diagnostico.perdidas, 0);
+        assert_int_equal(diagnostico.ligacoes_invalidas, 0);
+        assert_int_equal(diagnostico.altura, 5);
+        assert_int_equal(diagnostico.menor_livre, 1);
+        assert_int_equal(diagnostico.maior_livre, 9);
+        // Lista livre, do último liberado ao primeiro: 3, 1, 7, 8, 9.
+        assert_true(diagnostico.salto_medio_livres == (2.0 + 6 + 1 + 1) / 4);
+        assert_int_equal(diagnostico.livres_no_fim, 3);
+        assert_true(diagnostico.compactar);
+        liberar_diagnostico(&diagnostico);
+
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @test Arquivo vazio: tudo zerado e nenhuma recomendação.
+ */
+static void test_diagnostico_arvore_vazia(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "diagnostico", "vazia");
+
+        DIAGNOSTICO_ARVORE diagnostico;
+        assert_int_equal(diagnosticar_arvore(arquivo, &diagnostico), SUCESSO);
+        assert_int_equal(diagnostico.posicoes, 0);
+        assert_int_equal(diagnostico.altura, 0);
+        assert_null(diagnostico.profundidades);
+        assert_false(diagnostico.rebalancear);
+        assert_false(diagnostico.compactar);
+        assert_int_equal(diagnosticar_arvore(NULL, &diagnostico), ERRO_ARQUIVO_NULO);
+
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @brief Retorna a lista de testes do diagnóstico a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* diagnostico_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_diagnostico_arvore_perfeita),
+            cmocka_unit_test(test_diagnostico_arvore_em_fila),
+            cmocka_unit_test(test_diagnostico_arvore_vazia)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file test_espaco_livre.c
+ * @brief Testes unitários para o mapa persistente das posições livres.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/diagnostico.h"
+#include "../include/erros.h"
+#include "../include/espaco_livre.h"
+#include "../include/livro.h"
+#include "auxiliares.h"
+
+/** Livros cadastrados antes das remoções; códigos pares, fora de ordem. */
+#define LIVROS_INICIAIS 1000
+
+/** Livros cadastrados depois das remoções; códigos ímpares. */
+#define LIVROS_NOVOS 50
+
+/**
+ * @brief Auxiliar: cria em /tmp um catálogo com LIVROS_INICIAIS códigos pares, cadastrados
+ * numa ordem embaralhada, e remove um em cada quatro.
+ *
+ * As posições livres ficam espalhadas pelo arquivo, e a cabeça da lista livre é a última
+ * removida.
+ */
+static FILE* aux_criar_catalogo(char* caminho, size_t tamanho, const char* nome) {
+        FILE* arquivo = aux_criar_arquivo(caminho, tamanho, "espaco_livre", nome);
+        char mapa[128];
+        snprintf(mapa, sizeof(mapa), "%s%s", caminho, SUFIXO_MAPA_LIVRE);
+        remove(mapa);
+
+        aux_cadastrar_embaralhados(arquivo, LIVROS_INICIAIS, 2);
+        for (size_t codigo = 8; codigo <= 2 * LIVROS_INICIAIS; codigo += 8)
+                assert_int_equal(remover_no_arvore(arquivo, codigo), SUCESSO);
+        return arquivo;
+}
+
+/**
+ * @brief Auxiliar: confere a lista livre e a árvore pelo diagnóstico.
+ */
+static void aux_conferir_arquivo(FILE* arquivo, size_t livros, size_t livres) {
+        DIAGNOSTICO_ARVORE diagnostico;
+        assert_int_equal(diagnosticar_arvore(arquivo, &diagnostico), SUCESSO);
+        assert_int_equal(diagnostico.livros_cabecalho, livros);
+        assert_int_equal(diagnostico.vivas, livros);
+        assert_int_equal(diagnostico.livres, livres);
+        assert_int_equal(diagnostico.perdidas, 0);
+        assert_int_equal(diagnostico.ligacoes_invalidas, 0);
+        liberar_diagnostico(&diagnostico);
+}
+
+/**
+ * @brief Auxiliar: cadastra `codigo` e retorna a distância entre a posição dele e a do pai.
+ */
+static int aux_distancia_ao_pai(FILE* arquivo, size_t codigo) {
+        aux_cadastrar(arquivo, codigo);
+        RESULTADO_BUSCA resultado = {0};
+        assert_int_equal(buscar_no_arvore(arquivo, codigo, &resultado), SUCESSO);
+        assert_non_null(resultado.pai);
+        int distancia = abs(resultado.posicao_no - resultado.posicao_pai);
+        free(resultado.no);
+        free(resultado.pai);
+        return distancia;
+}
+
+/**
+ * @test Com o mapa, os nós novos ficam a até RAIO_LOCALIDADE posições do pai e a lista livre
+ * continua íntegra; sem ele, o primeiro vai para a cabeça da lista.
+ */
+static void test_alocacao_perto_do_pai(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_catalogo(caminho, sizeof(caminho), "perto");
+        size_t livros = LIVROS_INICIAIS - LIVROS_INICIAIS / 4;
+        size_t livres = LIVROS_INICIAIS / 4;
+        aux_conferir_arquivo(arquivo, livros, livres);
+
+        assert_int_equal(abrir_mapa_livre(arquivo, caminho), SUCESSO);
+        ESTADO_MAPA_LIVRE estado;
+        assert_int_equal(consultar_mapa_livre(arquivo, &estado), SUCESSO);
+        assert_int_equal(estado.posicoes, LIVROS_INICIAIS);
+        assert_int_equal(estado.livres, livres);
+        assert_int_equal(estado.reconstrucoes, 1);
+
+        // O código ímpar logo abaixo do cadastrado na posição 20·i fica perto dela na árvore:
+        // os pais se espalham pelo arquivo.
+        for (size_t i = 0; i < LIVROS_NOVOS; i++) {
+                size_t codigo = aux_codigo_embaralhado(20 * i, LIVROS_INICIAIS, 2) - 1;
+                assert_true(aux_distancia_ao_pai(arquivo, codigo) <= RAIO_LOCALIDADE);
+        }
+        assert_int_equal(consultar_mapa_livre(arquivo, &estado), SUCESSO);
+        assert_int_equal(estado.proximas, LIVROS_NOVOS);
+        assert_int_equal(estado.livres, livres - LIVROS_NOVOS);
+        aux_conferir_arquivo(arquivo, livros + LIVROS_NOVOS, livres - LIVROS_NOVOS);
+        assert_int_equal(fechar_mapa_livre(arquivo), SUCESSO);
+        assert_int_equal(consultar_mapa_livre(arquivo, &estado), ERRO_ARQUIVO_NULO);
+
+        // Sem o mapa, a alocação volta a usar a cabeça da lista livre.
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        int cabeca = cabecalho->livre;
+        free(cabecalho);
+        aux_cadastrar(arquivo, 2 * LIVROS_INICIAIS + 1);
+        RESULTADO_BUSCA resultado = {0};
+        assert_int_equal(buscar_no_arvore(arquivo, 2 * LIVROS_INICIAIS + 1, &resultado), SUCESSO);
+        assert_int_equal(resultado.posicao_no, cabeca);
+        free(resultado.no);
+        free(resultado.pai);
+        aux_conferir_arquivo(arquivo, livros + LIVROS_NOVOS + 1, livres - LIVROS_NOVOS - 1);
+
+        fclose(arquivo);
+        char mapa[128];
+        snprintf(mapa, sizeof(mapa), "%s%s", caminho, SUFIXO_MAPA_LIVRE);
+        remove(mapa);
+        remove(caminho);
+}
+
+/**
+ * @test O mapa gravado é lido sem reconstrução; depois de uma mudança feita sem ele, é
+ * refeito pela lista livre.
+ */
+static void test_mapa_persistente(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_catalogo(caminho, sizeof(caminho), "persistente");
+        size_t livres = LIVROS_INICIAIS / 4;
+
+        assert_int_equal(abrir_mapa_livre(arquivo, caminho), SUCESSO);
+        // As remoções com o mapa aberto entram nele.
+        for (size_t codigo = 4; codigo <= 40; codigo += 8)
+                assert_int_equal(remover_no_arvore(arquivo, codigo), SUCESSO);
+        livres += 5;
+        assert_int_equal(fechar_mapa_livre(arquivo), SUCESSO);
+        char mapa[128];
+        snprintf(mapa, sizeof(mapa), "%s%s", caminho, SUFIXO_MAPA_LIVRE);
+        assert_int_equal(access(mapa, F_OK), 0);
+
+        ESTADO_MAPA_LIVRE estado;
+        assert_int_equal(abrir_mapa_livre(arquivo, caminho), SUCESSO);
+        assert_int_equal(consultar_mapa_livre(arquivo, &estado), SUCESSO);
+        assert_int_equal(estado.reconstrucoes, 0);
+        assert_int_equal(estado.livres, livres);
+        assert_int_equal(fechar_mapa_livre(arquivo), SUCESSO);
+
+        // Uma remoção sem o mapa muda a identidade do arquivo: o mapa gravado fica velho.
+        assert_int_equal(remover_no_arvore(arquivo, 2), SUCESSO);
+        livres++;
+        assert_int_equal(abrir_mapa_livre(arquivo, caminho), SUCESSO);
+        assert_int_equal(consultar_mapa_livre(arquivo, &estado), SUCESSO);
+        assert_int_equal(estado.reconstrucoes, 1);
+        assert_int_equal(estado.livres, livres);
+        assert_int_equal(fechar_mapa_livre(arquivo), SUCESSO);
+
+        // Lista livre com ciclo: o mapa não é associado.
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        NO_ARVORE* no = ler_no_arquivo(arquivo, cabecalho->livre);
+        assert_non_null(no);
+        no->filho_esquerdo = cabecalho->livre;
+        assert_int_equal(escrever_no(arquivo, no, cabecalho->livre), SUCESSO);
+        free(no);
+        free(cabecalho);
+        assert_int_equal(abrir_mapa_livre(arquivo, caminho), ERRO_NO_NULO);
+        assert_int_equal(consultar_mapa_livre(arquivo, &estado), ERRO_ARQUIVO_NULO);
+
+        fclose(arquivo);
+        remove(mapa);
+        remove(caminho);
+}
+
+/**
+ * @brief Retorna a lista de testes do mapa do espaço livre a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* espaco_livre_tests(int* n) {
+        static const struct CMUnitTest tests[] = {cmocka_unit_test(test_alocacao_perto_do_pai),
+                                                  cmocka_unit_test(test_mapa_persistente)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
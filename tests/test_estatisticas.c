@@ -0,0 +1,132 @@
+/**
+ * @file test_estatisticas.c
+ * @brief Testes unitários para os contadores e histogramas de estatisticas.h.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/estatisticas.h"
+#include "../include/livro.h"
+
+/** Livros cadastrados e buscados. */
+#define LIVROS_MEDIDOS 100
+
+/** Livros removidos ao final. */
+#define LIVROS_REMOVIDOS 10
+
+/**
+ * @test Cada operação conta só as próprias chamadas externas; as buscas internas do cadastro
+ *       entram nos eventos do cadastro, e o relatório JSON traz os totais.
+ */
+static void test_estatisticas_por_operacao(void** state) {
+        (void)state;
+        // Compilado sem ESTATISTICAS, não há o que medir.
+        if (!estatisticas_ativas()) return;
+
+        char caminho[64];
+        snprintf(caminho, sizeof(caminho), "/tmp/test_estatisticas_%d.bin", getpid());
+        remove(caminho);
+        abrir_ou_criar_arquivo(caminho);
+        FILE* arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+
+        zerar_estatisticas();
+        for (size_t i = 0; i < LIVROS_MEDIDOS; i++) {
+                LIVRO livro = {0};
+                livro.codigo = i * 37 % LIVROS_MEDIDOS + 1;
+                assert_int_equal(cadastrar_livro(arquivo, livro), SUCESSO);
+        }
+        for (size_t codigo = 1; codigo <= LIVROS_MEDIDOS; codigo++) {
+                RESULTADO_BUSCA resultado;
+                assert_int_equal(buscar_no_arvore(arquivo, codigo, &resultado), SUCESSO);
+                free(resultado.no);
+                free(resultado.pai);
+        }
+        for (size_t codigo = 1; codigo <= LIVROS_REMOVIDOS; codigo++)
+                assert_int_equal(remover_no_arvore(arquivo, codigo), SUCESSO);
+
+        ESTATISTICAS_OPERACAO estatisticas[QUANTIDADE_OPERACOES];
+        ler_estatisticas(estatisticas);
+        const ESTATISTICAS_OPERACAO* cadastrar = &estatisticas[OPERACAO_CADASTRAR];
+        const ESTATISTICAS_OPERACAO* buscar = &estatisticas[OPERACAO_BUSCAR];
+        assert_int_equal(cadastrar->chamadas, LIVROS_MEDIDOS);
+        assert_int_equal(estatisticas[OPERACAO_INSERIR].chamadas, 0);
+        assert_int_equal(buscar->chamadas, LIVROS_MEDIDOS);
+        assert_int_equal(estatisticas[OPERACAO_REMOVER].chamadas, LIVROS_REMOVIDOS);
+
+        // Cada cadastro grava o nó novo e cada busca lê ao menos o nó encontrado.
+        assert_true(cadastrar->eventos[EVENTO_ESCRITA_NO] >= LIVROS_MEDIDOS);
+        assert_true(buscar->eventos[EVENTO_LEITURA_NO] >= LIVROS_MEDIDOS);
+        assert_true(buscar->eventos[EVENTO_SEEK] >= buscar->eventos[EVENTO_LEITURA_NO]);
+        assert_int_equal(buscar->eventos[EVENTO_ESCRITA_NO], 0);
+
+        uint64_t p50 = percentil_latencia(buscar, 0.50);
+        uint64_t p99 = percentil_latencia(buscar, 0.99);
+        assert_true(p50 > 0);
+        assert_true(p50 <= p99);
+        assert_true(p99 <= buscar->maximo_ns);
+
+        FILE* json = tmpfile();
+        assert_non_null(json);
+        assert_int_equal(imprimir_estatisticas(json, ESTATISTICAS_JSON), SUCESSO);
+        rewind(json);
+        char linha[4096];
+        assert_non_null(fgets(linha, sizeof(linha), json));
+        fclose(json);
+        assert_int_equal(strncmp(linha, "{\"ativas\":true,\"operacoes\":{", 28), 0);
+        assert_non_null(strstr(linha, "\"buscar\":{\"chamadas\":100,"));
+        assert_non_null(strstr(linha, "\"remover\":{\"chamadas\":10,"));
+        assert_null(strstr(linha, "\"inserir\""));
+
+        zerar_estatisticas();
+        ler_estatisticas(estatisticas);
+        assert_int_equal(estatisticas[OPERACAO_BUSCAR].chamadas, 0);
+        assert_int_equal(estatisticas[OPERACAO_BUSCAR].eventos[EVENTO_LEITURA_NO], 0);
+
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @test Percentis pelo histograma: durações abaixo de 16 ns caem em baldes exatos.
+ */
+static void test_percentil_latencia(void** state) {
+        (void)state;
+        ESTATISTICAS_OPERACAO estatisticas;
+        memset(&estatisticas, 0, sizeof(estatisticas));
+        assert_int_equal(percentil_latencia(&estatisticas, 0.5), 0);
+
+        estatisticas.histograma[5] = 999;
+        estatisticas.histograma[12] = 1;
+        estatisticas.chamadas = 1000;
+        estatisticas.maximo_ns = 12;
+        assert_int_equal(percentil_latencia(&estatisticas, 0.50), 5);
+        assert_int_equal(percentil_latencia(&estatisticas, 0.999), 5);
+        assert_int_equal(percentil_latencia(&estatisticas, 1.0), 12);
+        assert_int_equal(percentil_latencia(&estatisticas, 0.0), 5);
+}
+
+/**
+ * @brief Retorna a lista de testes das estatísticas a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* estatisticas_tests(int* n) {
+        static const struct CMUnitTest tests[] = {cmocka_unit_test(test_estatisticas_por_operacao),
+                                                  cmocka_unit_test(test_percentil_latencia)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file test_exportacao.c
+ * @brief Testes unitários para a exportação do catálogo em CSV e JSON Lines.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/exportacao.h"
+#include "../include/importacao.h"
+#include "../include/livro.h"
+#include "auxiliares.h"
+
+/** Livros do teste de ida e volta: o bastante para encher o buffer de saída mais de uma vez. */
+#define LIVROS_IDA_E_VOLTA 6000
+
+/**
+ * @test O CSV exportado, importado de volta num catálogo vazio, reproduz todos os campos de
+ *       todos os livros; só o `;` dentro de um título vira espaço.
+ */
+static void test_csv_ida_e_volta(void** state) {
+        (void)state;
+        char caminho_origem[64];
+        char caminho_destino[64];
+        char caminho_csv[64];
+        snprintf(caminho_origem, sizeof(caminho_origem), "/tmp/test_exp_orig_%d.bin", getpid());
+        snprintf(caminho_destino, sizeof(caminho_destino), "/tmp/test_exp_dest_%d.bin",
+                 getpid());
+        snprintf(caminho_csv, sizeof(caminho_csv), "/tmp/test_exp_%d.csv", getpid());
+
+        // Preços em centavos, com frações de centavo e de 18 algarismos: todos voltam idênticos.
+        static const double precos[] = {0.0, 0.1, 19.9, 1234567.89, 0.125, 3.0625, 1e17};
+        FILE* origem = aux_arquivo_vazio(caminho_origem);
+        for (size_t i = 0; i < LIVROS_IDA_E_VOLTA; i++) {
+                LIVRO livro = {0};
+                livro.codigo = i * 7919 % LIVROS_IDA_E_VOLTA + 1;
+                snprintf(livro.titulo, sizeof(livro.titulo), "Titulo %zu", livro.codigo);
+                snprintf(livro.autor, sizeof(livro.autor), "Autor \"%zu\" \\ Ç", livro.codigo % 97);
+                snprintf(livro.editora, sizeof(livro.editora), "Editora");
+                livro.edicao = livro.codigo % 7;
+                livro.ano = 1900 + livro.codigo % 125;
+                livro.exemplares = livro.codigo * 1000003;
+                livro.preco = precos[livro.codigo % 7] + (double)(livro.codigo % 100);
+                if (livro.codigo == 42) strcpy(livro.titulo, "Um;dois");
+                assert_int_equal(cadastrar_livro(origem, livro), SUCESSO);
+        }
+
+        FILE* csv = fopen(caminho_csv, "w");
+        assert_non_null(csv);
+        RELATORIO_EXPORTACAO relatorio;
+        assert_int_equal(exportar_catalogo(origem, csv, EXPORTACAO_CSV, &relatorio), SUCESSO);
+        fclose(csv);
+        assert_int_equal(relatorio.livros, LIVROS_IDA_E_VOLTA);
+        assert_int_equal(relatorio.campos_alterados, 1);
+        assert_true(relatorio.bytes > TAMANHO_BUFFER_EXPORTACAO / 4);
+
+        FILE* destino = aux_arquivo_vazio(caminho_destino);
+        RELATORIO_IMPORTACAO importacao;
+        assert_int_equal(importar_texto(caminho_csv, destino, cadastrar_livro, NULL, &importacao),
+                         SUCESSO);
+        assert_int_equal(importacao.cadastrados, LIVROS_IDA_E_VOLTA);
+        assert_int_equal(importacao.rejeitados, 0);
+
+        COLETA esperada = {calloc(LIVROS_IDA_E_VOLTA, sizeof(LIVRO)), 0};
+        COLETA obtida = {calloc(LIVROS_IDA_E_VOLTA, sizeof(LIVRO)), 0};
+        assert_int_equal(percorrer_em_ordem(origem, aux_coletar, &esperada), SUCESSO);
+        assert_int_equal(percorrer_em_ordem(destino, aux_coletar, &obtida), SUCESSO);
+        assert_int_equal(obtida.quantidade, LIVROS_IDA_E_VOLTA);
+        for (size_t i = 0; i < LIVROS_IDA_E_VOLTA; i++) {
+                const LIVRO* a = &esperada.livros[i];
+                const LIVRO* b = &obtida.livros[i];
+                assert_int_equal(b->codigo, a->codigo);
+                assert_string_equal(b->titulo, a->codigo == 42 ? "Um dois" : a->titulo);
+                assert_string_equal(b->autor, a->autor);
+                assert_string_equal(b->editora, a->editora);
+                assert_int_equal(b->edicao, a->edicao);
+                assert_int_equal(b->ano, a->ano);
+                assert_int_equal(b->exemplares, a->exemplares);
+                assert_true(b->preco == a->preco);
+        }
+        free(esperada.livros);
+        free(obtida.livros);
+
+        fclose(origem);
+        fclose(destino);
+        remove(caminho_origem);
+        remove(caminho_destino);
+        remove(caminho_csv);
+}
+
+/**
+ * @test Cada linha do JSON Lines tem os oito campos, com textos escapados e números sem
+ *       printf nos extremos (0 e SIZE_MAX).
+ */
+static void test_jsonl(void** state) {
+        (void)state;
+        char caminho_bin[64];
+        char caminho_json[64];
+        snprintf(caminho_bin, sizeof(caminho_bin), "/tmp/test_exp_json_%d.bin", getpid());
+        snprintf(caminho_json, sizeof(caminho_json), "/tmp/test_exp_%d.jsonl", getpid());
+        assert_int_equal(formato_pelo_caminho(caminho_json), EXPORTACAO_JSONL);
+        assert_int_equal(formato_pelo_caminho("catalogo.JSON"), EXPORTACAO_JSONL);
+        assert_int_equal(formato_pelo_caminho("catalogo.csv"), EXPORTACAO_CSV);
+        assert_int_equal(formato_pelo_caminho("catalogo"), EXPORTACAO_CSV);
+
+        FILE* arquivo = aux_arquivo_vazio(caminho_bin);
+        LIVRO livro = {0};
+        livro.codigo = SIZE_MAX;
+        strcpy(livro.titulo, "Aspas \" barra \\ tab\t fim\x01");
+        strcpy(livro.autor, "Ágata");
+        livro.ano = 2024;
+        livro.preco = 1234.5;
+        assert_int_equal(cadastrar_livro(arquivo, livro), SUCESSO);
+
+        memset(&livro, 0, sizeof(livro));
+        livro.codigo = 7;
+        livro.edicao = 10;
+        livro.exemplares = 99;
+        livro.preco = 0.005;
+        assert_int_equal(cadastrar_livro(arquivo, livro), SUCESSO);
+
+        FILE* json = fopen(caminho_json, "w");
+        assert_non_null(json);
+        assert_int_equal(exportar_catalogo(arquivo, json, formato_pelo_caminho(caminho_json),
+                                           NULL),
+                         SUCESSO);
+        fclose(json);
+
+        json = fopen(caminho_json, "r");
+        assert_non_null(json);
+        char linha[512];
+        assert_non_null(fgets(linha, sizeof(linha), json));
+        assert_string_equal(linha,
+                            "{\"codigo\":7,\"titulo\":\"\",\"autor\":\"\",\"editora\":\"\","
+                            "\"edicao\":10,\"ano\":0,\"exemplares\":99,\"preco\":0.005}\n");
+        assert_non_null(fgets(linha, sizeof(linha), json));
+        assert_string_equal(linha,
+                            "{\"codigo\":18446744073709551615,"
+                            "\"titulo\":\"Aspas \\\" barra \\\\ tab\\t fim\\u0001\","
+                            "\"autor\":\"Ágata\",\"editora\":\"\",\"edicao\":0,\"ano\":2024,"
+                            "\"exemplares\":0,\"preco\":1234.50}\n");
+        assert_null(fgets(linha, sizeof(linha), json));
+        fclose(json);
+
+        fclose(arquivo);
+        remove(caminho_bin);
+        remove(caminho_json);
+}
+
+/**
+ * @brief Retorna a lista de testes da exportação a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* exportacao_tests(int* n) {
+        static const struct CMUnitTest tests[] = {cmocka_unit_test(test_csv_ida_e_volta),
+                                                  cmocka_unit_test(test_jsonl)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file test_filtro.c
+ * @brief Testes unitários para o filtro de Bloom dos códigos.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/filtro.h"
+#include "../include/livro.h"
+#include "auxiliares.h"
+
+/** Livros cadastrados antes de abrir o filtro (códigos pares). */
+#define LIVROS_INICIAIS 2000
+
+/** Livros cadastrados com o filtro aberto: fazem o filtro crescer. */
+#define LIVROS_ADICIONAIS 6000
+
+/**
+ * @brief Auxiliar: situação do filtro associado ao handle.
+ */
+static ESTADO_FILTRO aux_estado(FILE* arquivo) {
+        ESTADO_FILTRO estado;
+        assert_int_equal(consultar_filtro(arquivo, &estado), SUCESSO);
+        return estado;
+}
+
+/**
+ * @test Códigos cadastrados nunca são descartados e quase todos os ausentes são; o filtro
+ *       cresce com as inserções, é gravado ao fechar e relido sem reconstrução.
+ */
+static void test_filtro_descarta_ausentes(void** state) {
+        (void)state;
+        char caminho[64];
+        char caminho_filtro[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "filtro", NULL);
+        snprintf(caminho_filtro, sizeof(caminho_filtro), "%s%s", caminho, SUFIXO_FILTRO);
+        remove(caminho_filtro);
+        aux_cadastrar_embaralhados(arquivo, LIVROS_INICIAIS, 2);
+
+        // Sem filtro associado, nada é descartado.
+        assert_int_equal(codigo_certamente_ausente(arquivo, 1), 0);
+        assert_int_equal(consultar_filtro(arquivo, NULL), ERRO_ARQUIVO_NULO);
+
+        // Sem arquivo do filtro, ele é refeito pela árvore.
+        assert_int_equal(abrir_filtro(arquivo, caminho), SUCESSO);
+        ESTADO_FILTRO estado = aux_estado(arquivo);
+        assert_int_equal(estado.reconstrucoes, 1);
+        assert_int_equal(estado.registrados, LIVROS_INICIAIS);
+        size_t bits_iniciais = estado.bits;
+
+        size_t descartados = 0;
+        for (size_t codigo = 1; codigo <= 2 * LIVROS_INICIAIS; codigo++) {
+                int ausente = codigo_certamente_ausente(arquivo, codigo);
+                if (codigo % 2 == 0) assert_int_equal(ausente, 0);
+                descartados += (size_t)ausente;
+        }
+        // Com 10 bits por código, a taxa de falsos positivos fica perto de 1%.
+        assert_true(descartados >= LIVROS_INICIAIS * 95 / 100);
+
+        // Cadastros passam pelo filtro e o fazem crescer.
+        for (size_t codigo = 1; codigo <= LIVROS_ADICIONAIS; codigo++)
+                aux_cadastrar(arquivo, 10000 + codigo);
+        estado = aux_estado(arquivo);
+        assert_true(estado.bits > bits_iniciais);
+        assert_int_equal(estado.reconstrucoes, 2);
+        for (size_t codigo = 1; codigo <= LIVROS_ADICIONAIS; codigo++)
+                assert_int_equal(codigo_certamente_ausente(arquivo, 10000 + codigo), 0);
+        LIVRO duplicado = {0};
+        duplicado.codigo = 10001;
+        assert_int_equal(cadastrar_livro(arquivo, duplicado), ERRO_CODIGO_DUPLICADO);
+
+        assert_int_equal(remover_no_arvore(arquivo, 10001), SUCESSO);
+        assert_int_equal(aux_estado(arquivo).removidos, 1);
+        assert_int_equal(fechar_filtro(arquivo), SUCESSO);
+        assert_int_equal(access(caminho_filtro, F_OK), 0);
+
+        // O arquivo do filtro corresponde ao catálogo: é lido, sem percorrer a árvore.
+        assert_int_equal(abrir_filtro(arquivo, caminho), SUCESSO);
+        estado = aux_estado(arquivo);
+        assert_int_equal(estado.reconstrucoes, 0);
+        assert_int_equal(estado.removidos, 1);
+        for (size_t codigo = 2; codigo <= 2 * LIVROS_INICIAIS; codigo += 2)
+                assert_int_equal(codigo_certamente_ausente(arquivo, codigo), 0);
+        assert_int_equal(fechar_filtro(arquivo), SUCESSO);
+
+        fclose(arquivo);
+        remove(caminho);
+        remove(caminho_filtro);
+}
+
+/**
+ * @test Um catálogo alterado sem o filtro, ou um arquivo do filtro truncado, leva à
+ *       reconstrução; muitas remoções refazem o filtro ao fechar.
+ */
+static void test_filtro_desatualizado(void** state) {
+        (void)state;
+        char caminho[64];
+        char caminho_filtro[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "filtro", "des");
+        snprintf(caminho_filtro, sizeof(caminho_filtro), "%s%s", caminho, SUFIXO_FILTRO);
+        remove(caminho_filtro);
+        assert_int_equal(abrir_filtro(arquivo, caminho), SUCESSO);
+        for (size_t codigo = 1; codigo <= 100; codigo++) aux_cadastrar(arquivo, codigo);
+        assert_int_equal(fechar_filtro(arquivo), SUCESSO);
+
+        // Cadastro sem o filtro: o arquivo do filtro não confere mais.
+        aux_cadastrar(arquivo, 500);
+        assert_int_equal(abrir_filtro(arquivo, caminho), SUCESSO);
+        assert_int_equal(aux_estado(arquivo).reconstrucoes, 1);
+        assert_int_equal(codigo_certamente_ausente(arquivo, 500), 0);
+
+        // Remover mais de um quarto dos códigos refaz o filtro ao fechar.
+        for (size_t codigo = 1; codigo <= 50; codigo++)
+                assert_int_equal(remover_no_arvore(arquivo, codigo), SUCESSO);
+        assert_int_equal(fechar_filtro(arquivo), SUCESSO);
+        assert_int_equal(abrir_filtro(arquivo, caminho), SUCESSO);
+        ESTADO_FILTRO estado = aux_estado(arquivo);
+        assert_int_equal(estado.reconstrucoes, 0);
+        assert_int_equal(estado.registrados, 51);
+        assert_int_equal(estado.removidos, 0);
+        assert_int_equal(fechar_filtro(arquivo), SUCESSO);
+
+        // Arquivo do filtro truncado.
+        assert_int_equal(truncate(caminho_filtro, (off_t)sizeof(CABECALHO_FILTRO) + 100), 0);
+        assert_int_equal(abrir_filtro(arquivo, caminho), SUCESSO);
+        assert_int_equal(aux_estado(arquivo).reconstrucoes, 1);
+        for (size_t codigo = 51; codigo <= 100; codigo++)
+                assert_int_equal(codigo_certamente_ausente(arquivo, codigo), 0);
+        assert_int_equal(fechar_filtro(arquivo), SUCESSO);
+
+        fclose(arquivo);
+        remove(caminho);
+        remove(caminho_filtro);
+}
+
+/**
+ * @brief Retorna a lista de testes do filtro a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* filtro_tests(int* n) {
+        static const struct CMUnitTest tests[] = {cmocka_unit_test(test_filtro_descarta_ausentes),
+                                                  cmocka_unit_test(test_filtro_desatualizado)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
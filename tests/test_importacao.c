@@ -0,0 +1,142 @@
+/**
+ * @file test_importacao.c
+ * @brief Testes unitários para a importação do arquivo texto.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/importacao.h"
+#include "../include/livro.h"
+
+/**
+ * @test Campos são interpretados sem terminador nulo, com espaços aparados e preço com vírgula.
+ */
+static void test_interpretar_livro(void** state) {
+        (void)state;
+        // A linha continua depois do tamanho informado: o leitor não pode passar dele.
+        const char linha[] = " 42 ; Dom Casmurro ;Machado;Garnier;3;1899;7; 19,90 \r;lixo";
+        LIVRO livro;
+
+        assert_int_equal(interpretar_livro(linha, strlen(linha) - 5, &livro), SUCESSO);
+        assert_int_equal(livro.codigo, 42);
+        assert_string_equal(livro.titulo, "Dom Casmurro");
+        assert_string_equal(livro.autor, "Machado");
+        assert_string_equal(livro.editora, "Garnier");
+        assert_int_equal(livro.edicao, 3);
+        assert_int_equal(livro.ano, 1899);
+        assert_int_equal(livro.exemplares, 7);
+        assert_true(livro.preco > 19.89 && livro.preco < 19.91);
+
+        assert_int_equal(interpretar_livro("1;A;B;C;1;1;1", 13, &livro), ERRO_LIVRO_INVALIDO);
+        assert_int_equal(interpretar_livro("1x;A;B;C;1;1;1;1", 16, &livro), ERRO_LIVRO_INVALIDO);
+        assert_int_equal(interpretar_livro("1;A;B;C;1;1;1;-2", 16, &livro), ERRO_LIVRO_INVALIDO);
+        assert_int_equal(interpretar_livro("", 0, &livro), ERRO_LIVRO_INVALIDO);
+
+        char longa[sizeof(livro.autor) + 32];
+        int tamanho = snprintf(longa, sizeof(longa), "7;T;%0*d;E;1;1;1;1",
+                               (int)sizeof(livro.autor), 0);
+        assert_int_equal(interpretar_livro(longa, (size_t)tamanho, &livro), ERRO_CAMPO_TRUNCADO);
+        assert_int_equal(strlen(livro.autor), sizeof(livro.autor) - 1);
+}
+
+/**
+ * @test A importação aceita linhas maiores que o antigo buffer de 512 bytes, ignora linhas em
+ *       branco, conta as rejeitadas por motivo e grava-as com o número da linha.
+ */
+static void test_importar_texto(void** state) {
+        (void)state;
+        char caminho_txt[64];
+        char caminho_bin[64];
+        char caminho_rejeitadas[80];
+        snprintf(caminho_txt, sizeof(caminho_txt), "/tmp/test_importacao_%d.txt", getpid());
+        snprintf(caminho_bin, sizeof(caminho_bin), "/tmp/test_importacao_%d.bin", getpid());
+        snprintf(caminho_rejeitadas, sizeof(caminho_rejeitadas), "%s%s", caminho_txt,
+                 SUFIXO_REJEITADAS);
+
+        FILE* txt = fopen(caminho_txt, "w");
+        assert_non_null(txt);
+        fprintf(txt, "2;Curto;Autor;Editora;1;2000;1;10.5\n\n");
+        fprintf(txt, "1;Longo;");
+        for (int i = 0; i < 2000; i++) fputc('a', txt);
+        fprintf(txt, ";Editora;1;2000;1;10.5\n");
+        fprintf(txt, "incompleta;sem campos\n");
+        fprintf(txt, "3;Com espacos;Autor;Editora;1;2000;1;1\n");
+        fprintf(txt, "2;Duplicado;Autor;Editora;1;2000;1;1");  // Sem '\n' no fim.
+        fclose(txt);
+
+        remove(caminho_bin);
+        abrir_ou_criar_arquivo(caminho_bin);
+        FILE* arquivo = fopen(caminho_bin, "rb+");
+        assert_non_null(arquivo);
+
+        RELATORIO_IMPORTACAO relatorio;
+        remove(caminho_rejeitadas);
+        assert_int_equal(importar_texto(caminho_txt, arquivo, cadastrar_livro,
+                                        caminho_rejeitadas, &relatorio),
+                         SUCESSO);
+        assert_int_equal(relatorio.linhas, 5);
+        assert_int_equal(relatorio.cadastrados, 2);
+        assert_int_equal(relatorio.rejeitados, 3);
+        assert_int_equal(relatorio.por_motivo[REJEICAO_REPETIDO], 1);
+        assert_int_equal(relatorio.por_motivo[REJEICAO_FORMATO], 1);
+        assert_int_equal(relatorio.por_motivo[REJEICAO_TRUNCADO], 1);
+        assert_int_equal(relatorio.por_motivo[REJEICAO_GRAVACAO], 0);
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        assert_int_equal(cabecalho->quantidade_livros, 2);
+        free(cabecalho);
+
+        // Uma linha por rejeitada, em ordem, com o número da linha no arquivo (a 2 é vazia).
+        FILE* rejeitadas = fopen(caminho_rejeitadas, "r");
+        assert_non_null(rejeitadas);
+        char linha[4096];
+        assert_non_null(fgets(linha, sizeof(linha), rejeitadas));
+        assert_int_equal(strncmp(linha, "3\ttruncado\t1;Longo;aaa", 22), 0);
+        assert_int_equal(strlen(linha), strlen("3\ttruncado\t1;Longo;\n") + 2000 +
+                                                 strlen(";Editora;1;2000;1;10.5"));
+        assert_non_null(fgets(linha, sizeof(linha), rejeitadas));
+        assert_string_equal(linha, "4\tformato\tincompleta;sem campos\n");
+        assert_non_null(fgets(linha, sizeof(linha), rejeitadas));
+        assert_string_equal(linha, "6\trepetido\t2;Duplicado;Autor;Editora;1;2000;1;1\n");
+        assert_null(fgets(linha, sizeof(linha), rejeitadas));
+        fclose(rejeitadas);
+
+        assert_int_equal(analisar_texto(caminho_txt, &relatorio), SUCESSO);
+        assert_int_equal(relatorio.cadastrados, 3);
+        assert_int_equal(relatorio.rejeitados, 2);
+
+        assert_int_equal(importar_texto("/tmp/nao_existe.txt", arquivo, cadastrar_livro, NULL,
+                                        NULL),
+                         ERRO_ARQUIVO_TEXTO);
+
+        fclose(arquivo);
+        remove(caminho_txt);
+        remove(caminho_bin);
+        remove(caminho_rejeitadas);
+}
+
+/**
+ * @brief Retorna a lista de testes da importação a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* importacao_tests(int* n) {
+        static const struct CMUnitTest tests[] = {cmocka_unit_test(test_interpretar_livro),
+                                                  cmocka_unit_test(test_importar_texto)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
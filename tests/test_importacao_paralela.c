@@ -0,0 +1,253 @@
+/**
+ * @file test_importacao_paralela.c
+ * @brief Testes unitários para a importação em pipeline.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/importacao_paralela.h"
+#include "auxiliares.h"
+
+/** Linhas do arquivo grande: o bastante para dividi-lo entre várias threads. */
+#define LINHAS_GRANDE 40000
+
+/**
+ * Estado do percurso de verificação.
+ */
+typedef struct {
+        size_t quantidade;
+        size_t ultimo;
+        int ordenado;
+} VERIFICACAO;
+
+/**
+ * @brief Visitante que confere se os códigos chegam em ordem estritamente crescente.
+ */
+static int verificar_ordem(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)posicao;
+        VERIFICACAO* verificacao = contexto;
+        if (verificacao->quantidade > 0 && no->livro.codigo <= verificacao->ultimo)
+                verificacao->ordenado = 0;
+        verificacao->ultimo = no->livro.codigo;
+        verificacao->quantidade++;
+        return SUCESSO;
+}
+
+/**
+ * @test Com a árvore vazia, o arquivo grande (fora de ordem, com repetidos e linhas
+ *       inválidas) vira uma árvore balanceada, e o primeiro livro de cada código é o que fica.
+ *       As rejeitadas de partes diferentes saem com o número da linha no arquivo inteiro.
+ */
+static void test_pipeline_construcao_em_bloco(void** state) {
+        (void)state;
+        char caminho_txt[64];
+        char caminho_bin[64];
+        char caminho_rejeitadas[80];
+        snprintf(caminho_txt, sizeof(caminho_txt), "/tmp/test_pipeline_%d.txt", getpid());
+        snprintf(caminho_bin, sizeof(caminho_bin), "/tmp/test_pipeline_%d.bin", getpid());
+        snprintf(caminho_rejeitadas, sizeof(caminho_rejeitadas), "%s%s", caminho_txt,
+                 SUFIXO_REJEITADAS);
+
+        FILE* txt = fopen(caminho_txt, "w");
+        assert_non_null(txt);
+        fprintf(txt, "5;Repetido no inicio;Autor;Editora;1;2000;1;1\n");
+        for (size_t i = 0; i < LINHAS_GRANDE; i++) {
+                // Permutação de 1..LINHAS_GRANDE (7919 é primo e não divide LINHAS_GRANDE).
+                size_t codigo = i * 7919 % LINHAS_GRANDE + 1;
+                fprintf(txt, "%zu;Titulo %zu;Autor;Editora;1;2000;1;9,90\n", codigo, codigo);
+                if (i == LINHAS_GRANDE / 2) fprintf(txt, "\n");
+        }
+        fprintf(txt, "linha invalida\n");
+        fprintf(txt, "5;Repetido;Autor;Editora;1;2000;1;1\n");
+        fclose(txt);
+
+        FILE* arquivo = aux_arquivo_vazio(caminho_bin);
+        RELATORIO_PIPELINE relatorio;
+        assert_int_equal(importar_texto_paralelo(caminho_txt, arquivo, 4, caminho_rejeitadas,
+                                                 &relatorio),
+                         SUCESSO);
+
+        assert_true(relatorio.threads > 1);
+        assert_true(relatorio.construcao_em_bloco);
+        assert_int_equal(relatorio.totais.linhas, LINHAS_GRANDE + 3);
+        assert_int_equal(relatorio.totais.cadastrados, LINHAS_GRANDE);
+        assert_int_equal(relatorio.totais.rejeitados, 3);
+        assert_int_equal(relatorio.totais.por_motivo[REJEICAO_REPETIDO], 2);
+        assert_int_equal(relatorio.totais.por_motivo[REJEICAO_FORMATO], 1);
+
+        // O código 5 aparece antes na linha 1; a permutação o põe no início da segunda metade.
+        size_t linha_do_5 = 0;
+        for (size_t i = 0; i < LINHAS_GRANDE; i++)
+                if (i * 7919 % LINHAS_GRANDE + 1 == 5) linha_do_5 = i + 2 + (i > LINHAS_GRANDE / 2);
+        char esperado[128];
+        snprintf(esperado, sizeof(esperado), "%zu\trepetido\t5;Titulo 5;", linha_do_5);
+
+        FILE* rejeitadas = fopen(caminho_rejeitadas, "r");
+        assert_non_null(rejeitadas);
+        char linha[256];
+        assert_non_null(fgets(linha, sizeof(linha), rejeitadas));
+        assert_int_equal(strncmp(linha, esperado, strlen(esperado)), 0);
+        snprintf(esperado, sizeof(esperado), "%d\tformato\tlinha invalida\n", LINHAS_GRANDE + 3);
+        assert_non_null(fgets(linha, sizeof(linha), rejeitadas));
+        assert_string_equal(linha, esperado);
+        snprintf(esperado, sizeof(esperado), "%d\trepetido\t5;Repetido;", LINHAS_GRANDE + 4);
+        assert_non_null(fgets(linha, sizeof(linha), rejeitadas));
+        assert_int_equal(strncmp(linha, esperado, strlen(esperado)), 0);
+        assert_null(fgets(linha, sizeof(linha), rejeitadas));
+        fclose(rejeitadas);
+        remove(caminho_rejeitadas);
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        assert_int_equal(cabecalho->quantidade_livros, LINHAS_GRANDE);
+        assert_int_equal(cabecalho->topo, LINHAS_GRANDE);
+        // 40000 nós balanceados: altura mínima é 16.
+        assert_int_equal(aux_altura(arquivo, cabecalho->raiz), 16);
+        free(cabecalho);
+
+        VERIFICACAO verificacao = {0, 0, 1};
+        assert_int_equal(percorrer_em_ordem(arquivo, verificar_ordem, &verificacao), SUCESSO);
+        assert_int_equal(verificacao.quantidade, LINHAS_GRANDE);
+        assert_true(verificacao.ordenado);
+
+        RESULTADO_BUSCA resultado = {0};
+        assert_int_equal(buscar_no_arvore(arquivo, 5, &resultado), SUCESSO);
+        assert_string_equal(resultado.no->livro.titulo, "Repetido no inicio");
+        free(resultado.no);
+        free(resultado.pai);
+
+        fclose(arquivo);
+        remove(caminho_txt);
+        remove(caminho_bin);
+}
+
+/**
+ * @test Com a árvore já populada, os livros são inseridos um a um e os códigos já
+ *       cadastrados são rejeitados.
+ */
+static void test_pipeline_insercoes(void** state) {
+        (void)state;
+        char caminho_txt[64];
+        char caminho_bin[64];
+        snprintf(caminho_txt, sizeof(caminho_txt), "/tmp/test_pipeline_ins_%d.txt", getpid());
+        snprintf(caminho_bin, sizeof(caminho_bin), "/tmp/test_pipeline_ins_%d.bin", getpid());
+
+        FILE* arquivo = aux_arquivo_vazio(caminho_bin);
+        LIVRO existente = {0};
+        existente.codigo = 50;
+        assert_int_equal(cadastrar_livro(arquivo, existente), SUCESSO);
+
+        FILE* txt = fopen(caminho_txt, "w");
+        assert_non_null(txt);
+        for (size_t codigo = 1; codigo <= 127; codigo++)
+                fprintf(txt, "%zu;T;A;E;1;2000;1;1\n", codigo);
+        fclose(txt);
+
+        RELATORIO_PIPELINE relatorio;
+        assert_int_equal(importar_texto_paralelo(caminho_txt, arquivo, 0, NULL, &relatorio),
+                         SUCESSO);
+        assert_false(relatorio.construcao_em_bloco);
+        assert_int_equal(relatorio.totais.cadastrados, 126);
+        assert_int_equal(relatorio.totais.rejeitados, 1);
+        assert_int_equal(relatorio.totais.por_motivo[REJEICAO_REPETIDO], 1);
+
+        VERIFICACAO verificacao = {0, 0, 1};
+        assert_int_equal(percorrer_em_ordem(arquivo, verificar_ordem, &verificacao), SUCESSO);
+        assert_int_equal(verificacao.quantidade, 127);
+        assert_true(verificacao.ordenado);
+
+        // Inseridos por níveis, os 126 novos não formam uma lista.
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        assert_true(aux_altura(arquivo, cabecalho->raiz) <= 9);
+        free(cabecalho);
+
+        fclose(arquivo);
+        remove(caminho_txt);
+        remove(caminho_bin);
+}
+
+/**
+ * @test Com uma thread só, a parte vira várias corridas no disco: um código repetido entre
+ *       corridas mantém a primeira linha, e as inserções por níveis continuam balanceadas.
+ */
+static void test_pipeline_varias_corridas(void** state) {
+        (void)state;
+        char caminho_txt[64];
+        char caminho_bin[64];
+        snprintf(caminho_txt, sizeof(caminho_txt), "/tmp/test_pipeline_cor_%d.txt", getpid());
+        snprintf(caminho_bin, sizeof(caminho_bin), "/tmp/test_pipeline_cor_%d.bin", getpid());
+        const size_t linhas = 3 * REGISTROS_POR_CORRIDA + 100;
+
+        FILE* arquivo = aux_arquivo_vazio(caminho_bin);
+        LIVRO existente = {0};
+        existente.codigo = linhas + 1;
+        assert_int_equal(cadastrar_livro(arquivo, existente), SUCESSO);
+
+        // Em ordem decrescente: cada corrida, ordenada, fica toda abaixo da anterior.
+        FILE* txt = fopen(caminho_txt, "w");
+        assert_non_null(txt);
+        for (size_t codigo = linhas; codigo >= 1; codigo--)
+                fprintf(txt, "%zu;Titulo %zu;A;E;1;2000;1;1\n", codigo, codigo);
+        fprintf(txt, "%zu;Repetido na ultima corrida;A;E;1;2000;1;1\n", linhas);
+        fclose(txt);
+
+        RELATORIO_PIPELINE relatorio;
+        assert_int_equal(importar_texto_paralelo(caminho_txt, arquivo, 1, NULL, &relatorio),
+                         SUCESSO);
+        assert_int_equal(relatorio.threads, 1);
+        assert_false(relatorio.construcao_em_bloco);
+        assert_int_equal(relatorio.totais.cadastrados, linhas);
+        assert_int_equal(relatorio.totais.rejeitados, 1);
+        assert_int_equal(relatorio.totais.por_motivo[REJEICAO_REPETIDO], 1);
+
+        VERIFICACAO verificacao = {0, 0, 1};
+        assert_int_equal(percorrer_em_ordem(arquivo, verificar_ordem, &verificacao), SUCESSO);
+        assert_int_equal(verificacao.quantidade, linhas + 1);
+        assert_true(verificacao.ordenado);
+
+        RESULTADO_BUSCA resultado = {0};
+        assert_int_equal(buscar_no_arvore(arquivo, linhas, &resultado), SUCESSO);
+        char titulo[32];
+        snprintf(titulo, sizeof(titulo), "Titulo %zu", linhas);
+        assert_string_equal(resultado.no->livro.titulo, titulo);
+        free(resultado.no);
+        free(resultado.pai);
+
+        // 12388 novos balanceados têm 14 níveis, abaixo do livro que já era a raiz.
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        assert_int_equal(aux_altura(arquivo, cabecalho->raiz), 15);
+        free(cabecalho);
+
+        fclose(arquivo);
+        remove(caminho_txt);
+        remove(caminho_bin);
+}
+
+/**
+ * @brief Retorna a lista de testes da importação em pipeline a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* importacao_paralela_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_pipeline_construcao_em_bloco),
+            cmocka_unit_test(test_pipeline_insercoes),
+            cmocka_unit_test(test_pipeline_varias_corridas)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file test_indice.c
+ * @brief Testes unitários para o índice hash de código para posição.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/indice.h"
+#include "../include/livro.h"
+#include "../include/versoes.h"
+#include "auxiliares.h"
+
+/** Livros cadastrados antes de abrir o índice. */
+#define LIVROS_INICIAIS 3000
+
+/** Livros cadastrados com o índice aberto: fazem baldes se dividirem. */
+#define LIVROS_ADICIONAIS 5000
+
+/** Livros da construção em bloco. */
+#define LIVROS_EM_BLOCO 1000
+
+/**
+ * @brief Auxiliar: confere que a busca encontra o livro do código pelo índice, sem descer a
+ * árvore (o pai fica vazio).
+ */
+static void aux_encontrar(FILE* arquivo, size_t codigo) {
+        RESULTADO_BUSCA resultado;
+        assert_int_equal(buscar_no_arvore(arquivo, codigo, &resultado), SUCESSO);
+        assert_non_null(resultado.no);
+        assert_null(resultado.pai);
+        assert_int_equal(resultado.no->livro.codigo, codigo);
+        char titulo[32];
+        snprintf(titulo, sizeof(titulo), "Livro %zu", codigo);
+        assert_string_equal(resultado.no->livro.titulo, titulo);
+        free(resultado.no);
+}
+
+/**
+ * @brief Auxiliar: confere que a busca não encontra o código.
+ */
+static void aux_ausente(FILE* arquivo, size_t codigo) {
+        RESULTADO_BUSCA resultado;
+        assert_int_equal(buscar_no_arvore(arquivo, codigo, &resultado), ERRO_NO_NULO);
+        assert_null(resultado.no);
+        free(resultado.pai);
+}
+
+/**
+ * @brief Auxiliar: situação do índice associado ao handle.
+ */
+static ESTADO_INDICE aux_estado(FILE* arquivo) {
+        ESTADO_INDICE estado;
+        assert_int_equal(consultar_indice(arquivo, &estado), SUCESSO);
+        return estado;
+}
+
+/**
+ * @brief Fonte da construção em bloco: códigos 10, 20, 30...
+ */
+static int proximo_livro(void* contexto, LIVRO* livro) {
+        size_t* codigo = contexto;
+        memset(livro, 0, sizeof(*livro));
+        *codigo += 10;
+        livro->codigo = *codigo;
+        snprintf(livro->titulo, sizeof(livro->titulo), "Livro %zu", *codigo);
+        return SUCESSO;
+}
+
+/**
+ * @test O índice é refeito pela árvore, acompanha inserções (dividindo baldes), remoções com
+ *       troca pelo sucessor e as operações copy-on-write, e é relido ao ser reaberto, com no
+ *       máximo uma página lida por busca.
+ */
+static void test_indice_busca_pontual(void** state) {
+        (void)state;
+        char caminho[64];
+        char caminho_indice[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "indice", NULL);
+        snprintf(caminho_indice, sizeof(caminho_indice), "%s%s", caminho, SUFIXO_INDICE);
+        remove(caminho_indice);
+        aux_cadastrar_embaralhados(arquivo, LIVROS_INICIAIS, 2);
+        assert_int_equal(consultar_indice(arquivo, NULL), ERRO_ARQUIVO_NULO);
+
+        // Sem arquivo do índice, ele é refeito pela árvore.
+        assert_int_equal(abrir_indice(arquivo, caminho), SUCESSO);
+        ESTADO_INDICE estado = aux_estado(arquivo);
+        assert_int_equal(estado.reconstrucoes, 1);
+        assert_int_equal(estado.entradas, LIVROS_INICIAIS);
+        for (size_t codigo = 1; codigo <= 2 * LIVROS_INICIAIS; codigo++) {
+                if (codigo % 2 == 0)
+                        aux_encontrar(arquivo, codigo);
+                else
+                        aux_ausente(arquivo, codigo);
+        }
+
+        // Cadastros com o índice aberto o fazem crescer.
+        for (size_t codigo = 1; codigo <= LIVROS_ADICIONAIS; codigo++)
+                aux_cadastrar(arquivo, 100000 + codigo);
+        estado = aux_estado(arquivo);
+        assert_int_equal(estado.entradas, LIVROS_INICIAIS + LIVROS_ADICIONAIS);
+        assert_true(estado.divisoes > 0);
+        for (size_t codigo = 1; codigo <= LIVROS_ADICIONAIS; codigo++)
+                aux_encontrar(arquivo, 100000 + codigo);
+
+        // A raiz tem dois filhos: o livro do sucessor passa para o nó dela.
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        NO_ARVORE* raiz = ler_no_arquivo(arquivo, cabecalho->raiz);
+        assert_non_null(raiz);
+        size_t codigo_raiz = raiz->livro.codigo;
+        free(raiz);
+        free(cabecalho);
+        assert_int_equal(remover_no_arvore(arquivo, codigo_raiz), SUCESSO);
+        aux_ausente(arquivo, codigo_raiz);
+        for (size_t codigo = 2; codigo <= 2 * LIVROS_INICIAIS; codigo += 2)
+                if (codigo != codigo_raiz) aux_encontrar(arquivo, codigo);
+
+        // Copy-on-write: todo o caminho copiado muda de posição.
+        NO_ARVORE novo = {0};
+        novo.livro.codigo = 1;
+        strcpy(novo.livro.titulo, "Livro 1");
+        assert_int_equal(inserir_no_arvore_cow(arquivo, &novo), SUCESSO);
+        assert_int_equal(remover_no_arvore_cow(arquivo, 100001), SUCESSO);
+        aux_encontrar(arquivo, 1);
+        aux_ausente(arquivo, 100001);
+        for (size_t codigo = 2; codigo <= 2 * LIVROS_INICIAIS; codigo += 2)
+                if (codigo != codigo_raiz) aux_encontrar(arquivo, codigo);
+        for (size_t codigo = 2; codigo <= LIVROS_ADICIONAIS; codigo++)
+                aux_encontrar(arquivo, 100000 + codigo);
+        size_t entradas = aux_estado(arquivo).entradas;
+        assert_int_equal(entradas, LIVROS_INICIAIS + LIVROS_ADICIONAIS - 1);
+        assert_int_equal(fechar_indice(arquivo), SUCESSO);
+        assert_int_equal(access(caminho_indice, F_OK), 0);
+
+        // O arquivo do índice corresponde ao catálogo: é lido, sem percorrer a árvore.
+        assert_int_equal(abrir_indice(arquivo, caminho), SUCESSO);
+        estado = aux_estado(arquivo);
+        assert_int_equal(estado.reconstrucoes, 0);
+        assert_int_equal(estado.entradas, entradas);
+        size_t buscas = 0;
+        for (size_t codigo = 1; codigo <= LIVROS_ADICIONAIS; codigo++, buscas++)
+                aux_encontrar(arquivo, 100000 + codigo + (codigo == 1));
+        assert_true(aux_estado(arquivo).leituras_de_pagina <= buscas);
+        assert_int_equal(fechar_indice(arquivo), SUCESSO);
+
+        fclose(arquivo);
+        remove(caminho);
+        remove(caminho_indice);
+}
+
+/**
+ * @test Um catálogo alterado sem o índice, um índice que não foi fechado ou um arquivo do
+ *       índice truncado levam à reconstrução; a construção em bloco refaz o índice aberto.
+ */
+static void test_indice_desatualizado(void** state) {
+        (void)state;
+        char caminho[64];
+        char caminho_indice[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "indice", "des");
+        snprintf(caminho_indice, sizeof(caminho_indice), "%s%s", caminho, SUFIXO_INDICE);
+        remove(caminho_indice);
+        assert_int_equal(abrir_indice(arquivo, caminho), SUCESSO);
+        size_t codigo = 0;
+        assert_int_equal(construir_arvore_em_bloco(arquivo, LIVROS_EM_BLOCO, proximo_livro,
+                                                   &codigo),
+                         SUCESSO);
+        assert_int_equal(aux_estado(arquivo).reconstrucoes, 2);
+        assert_int_equal(aux_estado(arquivo).entradas, LIVROS_EM_BLOCO);
+        for (codigo = 10; codigo <= 10 * LIVROS_EM_BLOCO; codigo += 10)
+                aux_encontrar(arquivo, codigo);
+        assert_int_equal(fechar_indice(arquivo), SUCESSO);
+
+        // Cadastro sem o índice: o arquivo do índice não confere mais.
+        aux_cadastrar(arquivo, 5);
+        assert_int_equal(abrir_indice(arquivo, caminho), SUCESSO);
+        assert_int_equal(aux_estado(arquivo).reconstrucoes, 1);
+        aux_encontrar(arquivo, 5);
+        assert_int_equal(fechar_indice(arquivo), SUCESSO);
+
+        // Índice marcado como sujo, como se o processo tivesse caído com ele aberto.
+        FILE* paginas = fopen(caminho_indice, "rb+");
+        assert_non_null(paginas);
+        unsigned int sujo = 0;
+        assert_int_equal(fseek(paginas, offsetof(CABECALHO_INDICE, limpo), SEEK_SET), 0);
+        assert_int_equal(fwrite(&sujo, sizeof(sujo), 1, paginas), 1);
+        fclose(paginas);
+        assert_int_equal(abrir_indice(arquivo, caminho), SUCESSO);
+        assert_int_equal(aux_estado(arquivo).reconstrucoes, 1);
+        assert_int_equal(fechar_indice(arquivo), SUCESSO);
+
+        // Arquivo do índice truncado.
+        assert_int_equal(truncate(caminho_indice, TAMANHO_PAGINA_INDICE + 100), 0);
+        assert_int_equal(abrir_indice(arquivo, caminho), SUCESSO);
+        assert_int_equal(aux_estado(arquivo).reconstrucoes, 1);
+        for (codigo = 10; codigo <= 10 * LIVROS_EM_BLOCO; codigo += 10)
+                aux_encontrar(arquivo, codigo);
+        aux_ausente(arquivo, 15);
+        assert_int_equal(fechar_indice(arquivo), SUCESSO);
+
+        fclose(arquivo);
+        remove(caminho);
+        remove(caminho_indice);
+}
+
+/**
+ * @brief Retorna a lista de testes do índice a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* indice_tests(int* n) {
+        static const struct CMUnitTest tests[] = {cmocka_unit_test(test_indice_busca_pontual),
+                                                  cmocka_unit_test(test_indice_desatualizado)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
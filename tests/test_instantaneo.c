@@ -0,0 +1,208 @@
+/**
+ * @file test_instantaneo.c
+ * @brief Testes unitários para o instantâneo binário do catálogo.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/instantaneo.h"
+#include "../include/livro.h"
+#include "auxiliares.h"
+
+/** Livros do catálogo de origem: mais de um bloco de LIVROS_POR_BLOCO_INSTANTANEO. */
+#define LIVROS_ORIGEM 2500
+
+/**
+ * @brief Auxiliar: raiz gravada no cabeçalho do arquivo.
+ */
+static int aux_raiz(FILE* arquivo) {
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        int raiz = cabecalho->raiz;
+        free(cabecalho);
+        return raiz;
+}
+
+/**
+ * @brief Auxiliar: troca um byte do arquivo na posição informada.
+ */
+static void aux_corromper(const char* caminho, long posicao) {
+        FILE* arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+        assert_int_equal(fseek(arquivo, posicao, SEEK_SET), 0);
+        int byte = fgetc(arquivo);
+        assert_int_equal(fseek(arquivo, posicao, SEEK_SET), 0);
+        fputc(byte ^ 0x01, arquivo);
+        fclose(arquivo);
+}
+
+/**
+ * @test Um catálogo com remoções (e, portanto, lista de livres) é exportado e restaurado num
+ *       arquivo novo: os livros chegam na mesma ordem e a árvore restaurada é balanceada.
+ */
+static void test_exportar_restaurar(void** state) {
+        (void)state;
+        char caminho_origem[64];
+        char caminho_destino[64];
+        char caminho_instantaneo[64];
+        snprintf(caminho_origem, sizeof(caminho_origem), "/tmp/test_inst_orig_%d.bin", getpid());
+        snprintf(caminho_destino, sizeof(caminho_destino), "/tmp/test_inst_dest_%d.bin",
+                 getpid());
+        snprintf(caminho_instantaneo, sizeof(caminho_instantaneo), "/tmp/test_inst_%d.inst",
+                 getpid());
+
+        FILE* origem = aux_arquivo_vazio(caminho_origem);
+        for (size_t i = 0; i < LIVROS_ORIGEM; i++) {
+                LIVRO livro = {0};
+                livro.codigo = i * 7919 % LIVROS_ORIGEM + 1;
+                snprintf(livro.titulo, sizeof(livro.titulo), "Titulo %zu", livro.codigo);
+                livro.preco = (double)livro.codigo / 4;
+                assert_int_equal(cadastrar_livro(origem, livro), SUCESSO);
+        }
+        for (size_t codigo = 10; codigo <= LIVROS_ORIGEM; codigo += 10)
+                assert_int_equal(remover_no_arvore(origem, codigo), SUCESSO);
+        size_t restantes = LIVROS_ORIGEM - LIVROS_ORIGEM / 10;
+
+        FILE* instantaneo = fopen(caminho_instantaneo, "wb");
+        assert_non_null(instantaneo);
+        size_t exportados = 0;
+        assert_int_equal(exportar_instantaneo(origem, instantaneo, &exportados), SUCESSO);
+        assert_int_equal(exportados, restantes);
+        fclose(instantaneo);
+
+        FILE* destino = aux_arquivo_vazio(caminho_destino);
+        instantaneo = fopen(caminho_instantaneo, "rb");
+        assert_non_null(instantaneo);
+        size_t restaurados = 0;
+        assert_int_equal(restaurar_instantaneo(instantaneo, destino, &restaurados), SUCESSO);
+        assert_int_equal(restaurados, restantes);
+        fclose(instantaneo);
+
+        COLETA esperada = {calloc(LIVROS_ORIGEM, sizeof(LIVRO)), 0};
+        COLETA obtida = {calloc(LIVROS_ORIGEM, sizeof(LIVRO)), 0};
+        assert_int_equal(percorrer_em_ordem(origem, aux_coletar, &esperada), SUCESSO);
+        assert_int_equal(percorrer_em_ordem(destino, aux_coletar, &obtida), SUCESSO);
+        assert_int_equal(obtida.quantidade, restantes);
+        assert_memory_equal(obtida.livros, esperada.livros, restantes * sizeof(LIVRO));
+        free(esperada.livros);
+        free(obtida.livros);
+
+        CABECALHO* cabecalho = le_cabecalho(destino);
+        assert_non_null(cabecalho);
+        assert_int_equal(cabecalho->quantidade_livros, restantes);
+        assert_int_equal(cabecalho->topo, (int)restantes);
+        assert_int_equal(cabecalho->livre, POSICAO_INVALIDA);
+        // 2250 nós balanceados: altura mínima é 12.
+        assert_int_equal(aux_altura(destino, cabecalho->raiz), 12);
+        free(cabecalho);
+
+        // O destino já tem livros: uma nova restauração é recusada sem tocá-lo.
+        instantaneo = fopen(caminho_instantaneo, "rb");
+        assert_non_null(instantaneo);
+        assert_int_equal(restaurar_instantaneo(instantaneo, destino, NULL),
+                         ERRO_ARVORE_NAO_VAZIA);
+        fclose(instantaneo);
+
+        fclose(origem);
+        fclose(destino);
+        remove(caminho_origem);
+        remove(caminho_destino);
+        remove(caminho_instantaneo);
+}
+
+/**
+ * @test Instantâneos corrompidos, truncados ou de outro formato são recusados e o catálogo
+ *       continua vazio; um catálogo vazio vai e volta.
+ */
+static void test_instantaneo_invalido(void** state) {
+        (void)state;
+        char caminho_origem[64];
+        char caminho_destino[64];
+        char caminho_instantaneo[64];
+        snprintf(caminho_origem, sizeof(caminho_origem), "/tmp/test_inv_orig_%d.bin", getpid());
+        snprintf(caminho_destino, sizeof(caminho_destino), "/tmp/test_inv_dest_%d.bin",
+                 getpid());
+        snprintf(caminho_instantaneo, sizeof(caminho_instantaneo), "/tmp/test_inv_%d.inst",
+                 getpid());
+
+        // Catálogo vazio: só cabeçalho e rodapé.
+        FILE* origem = aux_arquivo_vazio(caminho_origem);
+        FILE* instantaneo = fopen(caminho_instantaneo, "wb");
+        assert_int_equal(exportar_instantaneo(origem, instantaneo, NULL), SUCESSO);
+        fclose(instantaneo);
+        FILE* destino = aux_arquivo_vazio(caminho_destino);
+        instantaneo = fopen(caminho_instantaneo, "rb");
+        assert_int_equal(restaurar_instantaneo(instantaneo, destino, NULL), SUCESSO);
+        fclose(instantaneo);
+        assert_int_equal(aux_raiz(destino), POSICAO_INVALIDA);
+        fclose(destino);
+
+        for (size_t codigo = 1; codigo <= 100; codigo++) {
+                LIVRO livro = {0};
+                livro.codigo = codigo;
+                assert_int_equal(cadastrar_livro(origem, livro), SUCESSO);
+        }
+        instantaneo = fopen(caminho_instantaneo, "wb");
+        assert_int_equal(exportar_instantaneo(origem, instantaneo, NULL), SUCESSO);
+        fclose(instantaneo);
+        fclose(origem);
+
+        // Um bit trocado no meio dos registros: a soma não confere.
+        long registro_50 = (long)(sizeof(CABECALHO_INSTANTANEO) + 50 * sizeof(LIVRO));
+        aux_corromper(caminho_instantaneo, registro_50 + (long)offsetof(LIVRO, titulo));
+        destino = aux_arquivo_vazio(caminho_destino);
+        instantaneo = fopen(caminho_instantaneo, "rb");
+        assert_int_equal(restaurar_instantaneo(instantaneo, destino, NULL),
+                         ERRO_SOMA_INSTANTANEO);
+        fclose(instantaneo);
+        assert_int_equal(aux_raiz(destino), POSICAO_INVALIDA);
+        aux_corromper(caminho_instantaneo, registro_50 + (long)offsetof(LIVRO, titulo));
+
+        // Um bit trocado na quantidade do cabeçalho.
+        aux_corromper(caminho_instantaneo, offsetof(CABECALHO_INSTANTANEO, quantidade_livros));
+        instantaneo = fopen(caminho_instantaneo, "rb");
+        assert_int_equal(restaurar_instantaneo(instantaneo, destino, NULL),
+                         ERRO_FORMATO_INSTANTANEO);
+        fclose(instantaneo);
+        aux_corromper(caminho_instantaneo, offsetof(CABECALHO_INSTANTANEO, quantidade_livros));
+
+        // Sem o rodapé.
+        assert_int_equal(truncate(caminho_instantaneo, (off_t)(sizeof(CABECALHO_INSTANTANEO) +
+                                                               100 * sizeof(LIVRO))),
+                         0);
+        instantaneo = fopen(caminho_instantaneo, "rb");
+        assert_int_equal(restaurar_instantaneo(instantaneo, destino, NULL),
+                         ERRO_FORMATO_INSTANTANEO);
+        fclose(instantaneo);
+        assert_int_equal(aux_raiz(destino), POSICAO_INVALIDA);
+
+        fclose(destino);
+        remove(caminho_origem);
+        remove(caminho_destino);
+        remove(caminho_instantaneo);
+}
+
+/**
+ * @brief Retorna a lista de testes do instantâneo a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* instantaneo_tests(int* n) {
+        static const struct CMUnitTest tests[] = {cmocka_unit_test(test_exportar_restaurar),
+                                                  cmocka_unit_test(test_instantaneo_invalido)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
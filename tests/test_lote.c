@@ -0,0 +1,134 @@
+/**
+ * @file test_lote.c
+ * @brief Testes unitários para o modo em lote.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/erros.h"
+#include "../include/espaco_livre.h"
+#include "../include/filtro.h"
+#include "../include/indice.h"
+#include "../include/lote.h"
+
+/**
+ * @brief Auxiliar: executa `script` sobre um arquivo de livros novo e devolve a saída.
+ *
+ * @param[out] saida_texto Buffer que recebe a saída do lote.
+ * @return Código devolvido por executar_lote().
+ */
+static int aux_executar(const char* script, int parar_no_erro, char* saida_texto,
+                        size_t tamanho) {
+        char caminho[64];
+        char caminho_filtro[80];
+        char caminho_indice[80];
+        char caminho_mapa[80];
+        snprintf(caminho, sizeof(caminho), "/tmp/test_lote_%d.bin", getpid());
+        snprintf(caminho_filtro, sizeof(caminho_filtro), "%s%s", caminho, SUFIXO_FILTRO);
+        snprintf(caminho_indice, sizeof(caminho_indice), "%s%s", caminho, SUFIXO_INDICE);
+        snprintf(caminho_mapa, sizeof(caminho_mapa), "%s%s", caminho, SUFIXO_MAPA_LIVRE);
+        remove(caminho);
+        remove(caminho_filtro);
+        remove(caminho_indice);
+        remove(caminho_mapa);
+        abrir_ou_criar_arquivo(caminho);
+
+        FILE* comandos = tmpfile();
+        FILE* saida = tmpfile();
+        assert_non_null(comandos);
+        assert_non_null(saida);
+        fputs(script, comandos);
+        rewind(comandos);
+
+        int status = executar_lote(comandos, caminho, saida, parar_no_erro);
+
+        rewind(saida);
+        size_t lidos = fread(saida_texto, 1, tamanho - 1, saida);
+        saida_texto[lidos] = '\0';
+
+        fclose(comandos);
+        fclose(saida);
+        remove(caminho);
+        remove(caminho_filtro);
+        remove(caminho_indice);
+        remove(caminho_mapa);
+        return status;
+}
+
+/**
+ * @test Comandos válidos produzem a saída esperada; erros não interrompem o lote por padrão.
+ */
+static void test_lote_comandos(void** state) {
+        (void)state;
+        char saida[512];
+        int status = aux_executar("# comentario\n"
+                                  "add 7;Titulo;Autor;Editora;2;2001;4;12,50\n"
+                                  "add 3;Outro;Autor;Editora;1;1999;1;5\n"
+                                  "get 7\n"
+                                  "del 3\n"
+                                  "get 3\n"
+                                  "\n"
+                                  "stats\n",
+                                  0, saida, sizeof(saida));
+
+        assert_int_equal(status, ERRO_LIVRO_INVALIDO);
+        assert_string_equal(saida,
+                            "7;Titulo;Autor;Editora;2;2001;4;12.50\n"
+                            "livros: 1\n"
+                            "posicoes_usadas: 2\n");
+}
+
+/**
+ * @test Um código que não cabe em size_t é rejeitado, e não lido como o maior código possível.
+ */
+static void test_lote_codigo_grande_demais(void** state) {
+        (void)state;
+        char saida[256];
+        int status = aux_executar("add 18446744073709551615;Maximo;Autor;Editora;1;1;1;1\n"
+                                  "get 99999999999999999999999\n"
+                                  "del 18446744073709551616\n"
+                                  "get 18446744073709551615\n",
+                                  0, saida, sizeof(saida));
+
+        assert_int_equal(status, ERRO_LIVRO_INVALIDO);
+        assert_string_equal(saida, "18446744073709551615;Maximo;Autor;Editora;1;1;1;1.00\n");
+}
+
+/**
+ * @test Com parar_no_erro, o lote termina no primeiro comando que falha.
+ */
+static void test_lote_parar_no_erro(void** state) {
+        (void)state;
+        char saida[256];
+        int status = aux_executar("add 1;A;B;C;1;1;1;1\n"
+                                  "remove 1\n"
+                                  "get 1\n",
+                                  1, saida, sizeof(saida));
+
+        assert_int_equal(status, ERRO_COMANDO_INVALIDO);
+        assert_string_equal(saida, "");
+}
+
+/**
+ * @brief Retorna a lista de testes do modo em lote a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* lote_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_lote_comandos), cmocka_unit_test(test_lote_codigo_grande_demais),
+            cmocka_unit_test(test_lote_parar_no_erro)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
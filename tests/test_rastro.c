@@ -0,0 +1,138 @@
+/**
+ * @file test_rastro.c
+ * @brief Testes unitários para o rastro de operações de rastro.h.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/estatisticas.h"
+#include "../include/livro.h"
+#include "../include/rastro.h"
+
+/** Registros no anel do teste. */
+#define CAPACIDADE_TESTE 8
+
+/** Livros cadastrados antes das buscas. */
+#define LIVROS_RASTREADOS 6
+
+/**
+ * @test O anel guarda só as últimas operações, em ordem, com código, status e nós lidos.
+ */
+static void test_rastro_em_anel(void** state) {
+        (void)state;
+        // Compilado sem ESTATISTICAS, nenhuma operação é medida nem rastreada.
+        if (!estatisticas_ativas()) return;
+
+        char caminho[64], caminho_rastro[64];
+        snprintf(caminho, sizeof(caminho), "/tmp/test_rastro_%d.bin", getpid());
+        snprintf(caminho_rastro, sizeof(caminho_rastro), "/tmp/test_rastro_%d.rastro", getpid());
+        remove(caminho);
+        abrir_ou_criar_arquivo(caminho);
+        FILE* arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+
+        assert_int_equal(abrir_rastro(caminho_rastro, CAPACIDADE_TESTE), SUCESSO);
+        assert_true(rastro_ativo());
+
+        // 6 cadastros, 6 buscas (a última falha) e 1 remoção: 13 operações, ficam as 8 últimas.
+        for (size_t codigo = 1; codigo <= LIVROS_RASTREADOS; codigo++) {
+                LIVRO livro = {0};
+                livro.codigo = codigo;
+                assert_int_equal(cadastrar_livro(arquivo, livro), SUCESSO);
+        }
+        for (size_t codigo = 2; codigo <= LIVROS_RASTREADOS + 1; codigo++) {
+                // Na falha, o resultado traz o pai para uma inserção.
+                RESULTADO_BUSCA resultado = {0};
+                buscar_no_arvore(arquivo, codigo, &resultado);
+                free(resultado.no);
+                free(resultado.pai);
+        }
+        assert_int_equal(remover_no_arvore(arquivo, 3), SUCESSO);
+
+        assert_int_equal(fechar_rastro(), SUCESSO);
+        assert_false(rastro_ativo());
+
+        REGISTRO_RASTRO* registros = NULL;
+        size_t quantidade = 0;
+        assert_int_equal(ler_rastro(caminho_rastro, &registros, &quantidade), SUCESSO);
+        assert_int_equal(quantidade, CAPACIDADE_TESTE);
+
+        for (size_t i = 0; i < quantidade; i++) {
+                assert_int_equal(registros[i].sequencia, 13 - CAPACIDADE_TESTE + 1 + i);
+                if (i + 1 < quantidade) {
+                        assert_true(registros[i].inicio_us <= registros[i + 1].inicio_us);
+                }
+        }
+        // Sequências 6 a 13: o último cadastro, as buscas de 2 a 7 e a remoção.
+        assert_int_equal(registros[0].operacao, OPERACAO_CADASTRAR);
+        assert_int_equal(registros[0].codigo, LIVROS_RASTREADOS);
+        assert_true(registros[0].escritas > 0);
+        for (size_t i = 1; i <= LIVROS_RASTREADOS; i++) {
+                assert_int_equal(registros[i].operacao, OPERACAO_BUSCAR);
+                assert_int_equal(registros[i].codigo, i + 1);
+                assert_true(registros[i].leituras > 0);
+                assert_int_equal(registros[i].escritas, 0);
+        }
+        assert_int_equal(registros[LIVROS_RASTREADOS - 1].status, SUCESSO);
+        assert_int_equal(registros[LIVROS_RASTREADOS].status, ERRO_NO_NULO);
+        assert_int_equal(registros[7].operacao, OPERACAO_REMOVER);
+        assert_int_equal(registros[7].codigo, 3);
+        assert_int_equal(registros[7].status, SUCESSO);
+
+        free(registros);
+        fclose(arquivo);
+        remove(caminho);
+        remove(caminho_rastro);
+}
+
+/**
+ * @test Um arquivo que não é rastro é recusado.
+ */
+static void test_ler_rastro_invalido(void** state) {
+        (void)state;
+        char caminho[64];
+        snprintf(caminho, sizeof(caminho), "/tmp/test_rastro_invalido_%d", getpid());
+        FILE* arquivo = fopen(caminho, "wb");
+        assert_non_null(arquivo);
+        fputs("isto nao e um rastro de operacoes", arquivo);
+        fclose(arquivo);
+
+        REGISTRO_RASTRO* registros = NULL;
+        size_t quantidade = 0;
+        assert_int_equal(ler_rastro(caminho, &registros, &quantidade), ERRO_FORMATO_RASTRO);
+        assert_null(registros);
+        assert_int_equal(quantidade, 0);
+
+        // Um rastro válido truncado também é recusado.
+        assert_int_equal(abrir_rastro(caminho, CAPACIDADE_TESTE), SUCESSO);
+        assert_int_equal(fechar_rastro(), SUCESSO);
+        assert_int_equal(truncate(caminho, sizeof(CABECALHO_RASTRO) + sizeof(REGISTRO_RASTRO)), 0);
+        assert_int_equal(ler_rastro(caminho, &registros, &quantidade), ERRO_FORMATO_RASTRO);
+
+        remove(caminho);
+}
+
+/**
+ * @brief Retorna a lista de testes do rastro a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* rastro_tests(int* n) {
+        static const struct CMUnitTest tests[] = {cmocka_unit_test(test_rastro_em_anel),
+                                                  cmocka_unit_test(test_ler_rastro_invalido)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
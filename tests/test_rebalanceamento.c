@@ -0,0 +1,302 @@
+/**
+ * @file test_rebalanceamento.c
+ * @brief Testes unitários para o rebalanceamento fora de linha de rebalanceamento.h.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/concorrencia.h"
+#include "../include/diagnostico.h"
+#include "../include/erros.h"
+#include "../include/livro.h"
+#include "../include/rebalanceamento.h"
+#include "auxiliares.h"
+
+/** Livros cadastrados em ordem em cada teste. */
+#define LIVROS_EM_FILA 300
+
+/**
+ * @brief Diagnostica `caminho` e confere uma árvore perfeita e compacta com `livros` livros.
+ */
+static void conferir_balanceada(const char* caminho, size_t livros) {
+        FILE* arquivo = fopen(caminho, "rb");
+        assert_non_null(arquivo);
+        DIAGNOSTICO_ARVORE diagnostico;
+        assert_int_equal(diagnosticar_arvore(arquivo, &diagnostico), SUCESSO);
+        assert_int_equal(diagnostico.posicoes, livros);
+        assert_int_equal(diagnostico.livros_cabecalho, livros);
+        assert_int_equal(diagnostico.vivas, livros);
+        assert_int_equal(diagnostico.livres, 0);
+        assert_int_equal(diagnostico.perdidas, 0);
+        assert_int_equal(diagnostico.ligacoes_invalidas, 0);
+        assert_int_equal(diagnostico.altura, diagnostico.altura_minima);
+        assert_true(diagnostico.caminho_medio == diagnostico.caminho_medio_minimo);
+        liberar_diagnostico(&diagnostico);
+        fclose(arquivo);
+}
+
+/**
+ * @test Lista à direita com remoções: vira uma árvore perfeita, sem posições livres, com os
+ * mesmos livros.
+ */
+static void test_rebalancear_fila_crescente(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "rebalanceamento", "crescente");
+        for (size_t codigo = 1; codigo <= LIVROS_EM_FILA; codigo++)
+                aux_cadastrar(arquivo, codigo);
+        // Múltiplos de 7 saem: posições livres no meio e no fim da fila.
+        for (size_t codigo = 7; codigo <= LIVROS_EM_FILA; codigo += 7)
+                assert_int_equal(remover_no_arvore(arquivo, codigo), SUCESSO);
+        fclose(arquivo);
+
+        RELATORIO_REBALANCEAMENTO relatorio;
+        assert_int_equal(rebalancear_arquivo(caminho, &relatorio), SUCESSO);
+        size_t restantes = LIVROS_EM_FILA - LIVROS_EM_FILA / 7;
+        assert_int_equal(relatorio.livros, restantes);
+        assert_int_equal(relatorio.posicoes_antes, LIVROS_EM_FILA);
+        assert_int_equal(relatorio.altura_antes, restantes);
+        assert_int_equal(relatorio.altura_depois, 9);
+        conferir_balanceada(caminho, restantes);
+
+        arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+        for (size_t codigo = 1; codigo <= LIVROS_EM_FILA; codigo++)
+                aux_conferir_livro(arquivo, codigo, codigo % 7 != 0);
+        // A árvore nova continua aceitando cadastros e remoções.
+        aux_cadastrar(arquivo, LIVROS_EM_FILA + 1);
+        assert_int_equal(remover_no_arvore(arquivo, 1), SUCESSO);
+        aux_conferir_livro(arquivo, LIVROS_EM_FILA + 1, 1);
+        aux_conferir_livro(arquivo, 1, 0);
+        fclose(arquivo);
+
+        char temporario[128];
+        snprintf(temporario, sizeof(temporario), "%s%s", caminho, SUFIXO_REBALANCEAMENTO);
+        assert_int_not_equal(access(temporario, F_OK), 0);
+        remove(caminho);
+}
+
+/**
+ * @test Lista à esquerda (cadastros decrescentes): a pilha do percurso cresce até a altura.
+ */
+static void test_rebalancear_fila_decrescente(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo =
+            aux_criar_arquivo(caminho, sizeof(caminho), "rebalanceamento", "decrescente");
+        for (size_t codigo = LIVROS_EM_FILA; codigo >= 1; codigo--)
+                aux_cadastrar(arquivo, codigo);
+        fclose(arquivo);
+
+        RELATORIO_REBALANCEAMENTO relatorio;
+        assert_int_equal(rebalancear_arquivo(caminho, &relatorio), SUCESSO);
+        assert_int_equal(relatorio.altura_antes, LIVROS_EM_FILA);
+        conferir_balanceada(caminho, LIVROS_EM_FILA);
+
+        arquivo = fopen(caminho, "rb");
+        assert_non_null(arquivo);
+        for (size_t codigo = 1; codigo <= LIVROS_EM_FILA; codigo++)
+                aux_conferir_livro(arquivo, codigo, 1);
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @test Arquivo vazio continua vazio; um ciclo na árvore é recusado e o original fica intacto.
+ */
+static void test_rebalancear_vazio_e_ciclo(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "rebalanceamento", "ciclo");
+        fclose(arquivo);
+
+        RELATORIO_REBALANCEAMENTO relatorio;
+        assert_int_equal(rebalancear_arquivo(caminho, &relatorio), SUCESSO);
+        assert_int_equal(relatorio.livros, 0);
+        assert_int_equal(relatorio.altura_depois, 0);
+        conferir_balanceada(caminho, 0);
+
+        // O filho direito do segundo nó aponta de volta para a raiz.
+        arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+        aux_cadastrar(arquivo, 1);
+        aux_cadastrar(arquivo, 2);
+        NO_ARVORE* no = ler_no_arquivo(arquivo, 1);
+        assert_non_null(no);
+        no->filho_direito = 0;
+        assert_int_equal(escrever_no(arquivo, no, 1), SUCESSO);
+        free(no);
+        fclose(arquivo);
+
+        assert_int_equal(rebalancear_arquivo(caminho, &relatorio), ERRO_NO_NULO);
+        arquivo = fopen(caminho, "rb");
+        assert_non_null(arquivo);
+        no = ler_no_arquivo(arquivo, 1);
+        assert_non_null(no);
+        assert_int_equal(no->filho_direito, 0);
+        free(no);
+        fclose(arquivo);
+
+        assert_int_equal(rebalancear_arquivo("/tmp/nao/existe.bin", &relatorio),
+                         ERRO_ARQUIVO_NULO);
+        remove(caminho);
+}
+
+/**
+ * @test Um handle aberto antes da troca passa ao arquivo novo ao obter a trava: o cadastro
+ * feito por ele aparece para quem abre o caminho depois.
+ */
+static void test_rebalancear_handle_aberto(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* arquivo = aux_criar_arquivo(caminho, sizeof(caminho), "rebalanceamento", "handle");
+        for (size_t codigo = 1; codigo <= LIVROS_EM_FILA; codigo++)
+                aux_cadastrar(arquivo, codigo);
+        assert_int_equal(fflush(arquivo), 0);
+
+        assert_int_equal(rebalancear_arquivo(caminho, NULL), SUCESSO);
+
+        LIVRO livro = {0};
+        livro.codigo = LIVROS_EM_FILA + 1;
+        snprintf(livro.titulo, sizeof(livro.titulo), "Livro %zu", livro.codigo);
+        assert_int_equal(cadastrar_livro_concorrente(arquivo, livro), SUCESSO);
+        aux_conferir_livro(arquivo, 1, 1);
+        fclose(arquivo);
+
+        arquivo = fopen(caminho, "rb");
+        assert_non_null(arquivo);
+        aux_conferir_livro(arquivo, LIVROS_EM_FILA + 1, 1);
+        aux_conferir_livro(arquivo, LIVROS_EM_FILA, 1);
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @brief Lê o arquivo inteiro para comparar o conteúdo antes e depois de uma operação.
+ */
+static unsigned char* ler_conteudo(const char* caminho, size_t* tamanho) {
+        FILE* arquivo = fopen(caminho, "rb");
+        assert_non_null(arquivo);
+        assert_int_equal(fseek(arquivo, 0, SEEK_END), 0);
+        *tamanho = (size_t)ftell(arquivo);
+        rewind(arquivo);
+        unsigned char* conteudo = malloc(*tamanho + 1);
+        assert_non_null(conteudo);
+        assert_int_equal(fread(conteudo, 1, *tamanho, arquivo), *tamanho);
+        fclose(arquivo);
+        return conteudo;
+}
+
+/**
+ * @test Um arquivo da versão 1 (cabeçalho seguido dos nós, sem páginas) é recusado pelo
+ * le_cabecalho(), não é alterado por quem trava e destrava para escrita, e migrar_arquivo() o
+ * converte com os mesmos nós nas mesmas posições, lista livre incluída.
+ */
+static void test_migrar_arquivo_v1(void** state) {
+        (void)state;
+        char caminho[80];
+        FILE* atual =
+            aux_criar_arquivo(caminho, sizeof(caminho), "rebalanceamento", "formato_atual");
+        // 7 é primo com LIVROS_EM_FILA: os códigos entram fora de ordem.
+        for (size_t i = 0; i < LIVROS_EM_FILA; i++) aux_cadastrar(atual, i * 7 % 300 + 1);
+        for (size_t codigo = 5; codigo <= LIVROS_EM_FILA; codigo += 50)
+                assert_int_equal(remover_no_arvore(atual, codigo), SUCESSO);
+        CABECALHO* esperado = le_cabecalho(atual);
+        assert_non_null(esperado);
+        assert_int_not_equal(esperado->livre, POSICAO_INVALIDA);
+        size_t topo = (size_t)esperado->topo;
+        NO_ARVORE* nos = malloc(topo * sizeof(NO_ARVORE));
+        NO_ARVORE* migrados = malloc(topo * sizeof(NO_ARVORE));
+        assert_non_null(nos);
+        assert_non_null(migrados);
+        assert_int_equal(ler_nos_arquivo(atual, 0, topo, nos), SUCESSO);
+        fclose(atual);
+        remove(caminho);
+
+        snprintf(caminho, sizeof(caminho), "/tmp/test_rebalanceamento_v1_%d.bin", getpid());
+        FILE* v1 = fopen(caminho, "wb");
+        assert_non_null(v1);
+        assert_int_equal(fwrite(esperado, sizeof(CABECALHO), 1, v1), 1);
+        assert_int_equal(fwrite(nos, sizeof(NO_ARVORE), topo, v1), topo);
+        fclose(v1);
+
+        size_t tamanho_antes, tamanho_depois;
+        unsigned char* antes = ler_conteudo(caminho, &tamanho_antes);
+        v1 = fopen(caminho, "rb+");
+        assert_non_null(v1);
+        assert_null(le_cabecalho(v1));
+        assert_int_equal(arquivo_formato_v1(v1, NULL), 1);
+        assert_int_equal(travar_arquivo(v1, TRAVA_ESCRITA), SUCESSO);
+        assert_int_equal(destravar_arquivo(v1, TRAVA_ESCRITA), SUCESSO);
+        fclose(v1);
+        unsigned char* depois = ler_conteudo(caminho, &tamanho_depois);
+        assert_int_equal(tamanho_depois, tamanho_antes);
+        assert_memory_equal(depois, antes, tamanho_antes);
+        free(antes);
+        free(depois);
+
+        size_t livros = 0;
+        assert_int_equal(migrar_arquivo(caminho, &livros), SUCESSO);
+        assert_int_equal(livros, esperado->quantidade_livros);
+
+        FILE* migrado = fopen(caminho, "rb");
+        assert_non_null(migrado);
+        assert_int_equal(arquivo_formato_v1(migrado, NULL), 0);
+        CABECALHO* cabecalho = le_cabecalho(migrado);
+        assert_non_null(cabecalho);
+        assert_int_equal(cabecalho->raiz, esperado->raiz);
+        assert_int_equal(cabecalho->topo, esperado->topo);
+        assert_int_equal(cabecalho->livre, esperado->livre);
+        assert_int_equal(cabecalho->quantidade_livros, esperado->quantidade_livros);
+        assert_int_equal(ler_nos_arquivo(migrado, 0, topo, migrados), SUCESSO);
+        assert_memory_equal(migrados, nos, topo * sizeof(NO_ARVORE));
+        for (size_t codigo = 1; codigo <= LIVROS_EM_FILA; codigo++)
+                aux_conferir_livro(migrado, codigo, codigo % 50 != 5);
+        fclose(migrado);
+
+        // Já no formato atual, ou sem ser um arquivo de livros, não há o que migrar.
+        assert_int_equal(migrar_arquivo(caminho, NULL), ERRO_FORMATO_ARQUIVO);
+        FILE* lixo = fopen(caminho, "wb");
+        assert_non_null(lixo);
+        fprintf(lixo, "nao e um arquivo de livros, nem da versao 1\n");
+        fclose(lixo);
+        assert_int_equal(migrar_arquivo(caminho, NULL), ERRO_FORMATO_ARQUIVO);
+
+        char temporario[96];
+        snprintf(temporario, sizeof(temporario), "%s%s", caminho, SUFIXO_MIGRACAO);
+        assert_int_not_equal(access(temporario, F_OK), 0);
+
+        free(cabecalho);
+        free(esperado);
+        free(nos);
+        free(migrados);
+        remove(caminho);
+}
+
+/**
+ * @brief Retorna a lista de testes do rebalanceamento a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* rebalanceamento_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_rebalancear_fila_crescente),
+            cmocka_unit_test(test_rebalancear_fila_decrescente),
+            cmocka_unit_test(test_rebalancear_vazio_e_ciclo),
+            cmocka_unit_test(test_rebalancear_handle_aberto),
+            cmocka_unit_test(test_migrar_arquivo_v1)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -18,6 +18,111 @@
 /// @return Vetor de testes para o módulo de arquivo.
 extern const struct CMUnitTest* arquivo_tests(int*);
 
+/// @brief Declaração externa dos testes do módulo de compressão.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o módulo de compressão.
+extern const struct CMUnitTest* compressao_tests(int*);
+
+/// @brief Declaração externa dos testes do módulo de versões.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o módulo de versões.
+extern const struct CMUnitTest* versoes_tests(int*);
+
+/// @brief Declaração externa dos testes do servidor de consultas.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o servidor e a biblioteca cliente.
+extern const struct CMUnitTest* servidor_tests(int*);
+
+/// @brief Declaração externa dos testes do modo em lote.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o modo em lote.
+extern const struct CMUnitTest* lote_tests(int*);
+
+/// @brief Declaração externa dos testes da importação de texto.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para a importação de texto.
+extern const struct CMUnitTest* importacao_tests(int*);
+
+/// @brief Declaração externa dos testes da varredura vetorizada.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para a varredura vetorizada.
+extern const struct CMUnitTest* varredura_tests(int*);
+
+/// @brief Declaração externa dos testes da importação em pipeline.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para a importação em pipeline.
+extern const struct CMUnitTest* importacao_paralela_tests(int*);
+
+/// @brief Declaração externa dos testes das conversões numéricas.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para as conversões de utils.
+extern const struct CMUnitTest* utils_tests(int*);
+
+/// @brief Declaração externa dos testes do instantâneo binário.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o instantâneo.
+extern const struct CMUnitTest* instantaneo_tests(int*);
+
+/// @brief Declaração externa dos testes da exportação em CSV e JSON Lines.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para a exportação.
+extern const struct CMUnitTest* exportacao_tests(int*);
+
+/// @brief Declaração externa dos testes do filtro de Bloom dos códigos.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o filtro.
+extern const struct CMUnitTest* filtro_tests(int*);
+
+/// @brief Declaração externa dos testes do índice hash de código para posição.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o índice.
+extern const struct CMUnitTest* indice_tests(int*);
+
+/// @brief Declaração externa dos testes dos contadores e histogramas das operações.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para as estatísticas.
+extern const struct CMUnitTest* estatisticas_tests(int*);
+
+/// @brief Declaração externa dos testes do rastro de operações.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o rastro.
+extern const struct CMUnitTest* rastro_tests(int*);
+
+/// @brief Declaração externa dos testes do diagnóstico da árvore.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o diagnóstico.
+extern const struct CMUnitTest* diagnostico_tests(int*);
+
+/// @brief Declaração externa dos testes do rebalanceamento fora de linha.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o rebalanceamento.
+extern const struct CMUnitTest* rebalanceamento_tests(int*);
+
+/// @brief Declaração externa dos testes do mapa do espaço livre.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o mapa do espaço livre.
+extern const struct CMUnitTest* espaco_livre_tests(int*);
+
+/// @brief Declaração externa dos testes do acesso direto.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o acesso direto.
+extern const struct CMUnitTest* acesso_direto_tests(int*);
+
+/// @brief Declaração externa dos testes da busca de vários códigos.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para a busca de vários códigos.
+extern const struct CMUnitTest* busca_varios_tests(int*);
+
+/// @brief Declaração externa dos testes das travas entre leitores e escritores.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para as travas.
+extern const struct CMUnitTest* concorrencia_tests(int*);
+
+/// @brief Declaração externa dos testes do gerador de catálogos sintéticos.
+/// @param[out] n Quantidade de testes retornados.
+/// @return Vetor de testes para o catálogo sintético.
+extern const struct CMUnitTest* catalogo_sintetico_tests(int*);
+
 /**
  * @brief Função principal que executa todos os testes unitários com CMocka.
  *
@@ -32,12 +137,105 @@ int main(void) {
         int n_arquivo = 0;
         const struct CMUnitTest* arquivo = arquivo_tests(&n_arquivo);
 
-        total_tests = n_arquivo;
+        int n_compressao = 0;
+        const struct CMUnitTest* compressao = compressao_tests(&n_compressao);
+
+        int n_versoes = 0;
+        const struct CMUnitTest* versoes = versoes_tests(&n_versoes);
+
+        int n_servidor = 0;
+        const struct CMUnitTest* servidor = servidor_tests(&n_servidor);
+
+        int n_lote = 0;
+        const struct CMUnitTest* lote = lote_tests(&n_lote);
+
+        int n_importacao = 0;
+        const struct CMUnitTest* importacao = importacao_tests(&n_importacao);
+
+        int n_varredura = 0;
+        const struct CMUnitTest* varredura = varredura_tests(&n_varredura);
+
+        int n_importacao_paralela = 0;
+        const struct CMUnitTest* importacao_paralela =
+            importacao_paralela_tests(&n_importacao_paralela);
+
+        int n_utils = 0;
+        const struct CMUnitTest* utils = utils_tests(&n_utils);
+
+        int n_instantaneo = 0;
+        const struct CMUnitTest* instantaneo = instantaneo_tests(&n_instantaneo);
+
+        int n_exportacao = 0;
+        const struct CMUnitTest* exportacao = exportacao_tests(&n_exportacao);
+
+        int n_filtro = 0;
+        const struct CMUnitTest* filtro = filtro_tests(&n_filtro);
+
+        int n_indice = 0;
+        const struct CMUnitTest* indice = indice_tests(&n_indice);
+
+        int n_estatisticas = 0;
+        const struct CMUnitTest* estatisticas = estatisticas_tests(&n_estatisticas);
+
+        int n_rastro = 0;
+        const struct CMUnitTest* rastro = rastro_tests(&n_rastro);
+
+        int n_diagnostico = 0;
+        const struct CMUnitTest* diagnostico = diagnostico_tests(&n_diagnostico);
+
+        int n_rebalanceamento = 0;
+        const struct CMUnitTest* rebalanceamento = rebalanceamento_tests(&n_rebalanceamento);
+
+        int n_espaco_livre = 0;
+        const struct CMUnitTest* espaco_livre = espaco_livre_tests(&n_espaco_livre);
+
+        int n_acesso_direto = 0;
+        const struct CMUnitTest* acesso_direto = acesso_direto_tests(&n_acesso_direto);
+
+        int n_busca_varios = 0;
+        const struct CMUnitTest* busca_varios = busca_varios_tests(&n_busca_varios);
+
+        int n_concorrencia = 0;
+        const struct CMUnitTest* concorrencia = concorrencia_tests(&n_concorrencia);
+
+        int n_catalogo_sintetico = 0;
+        const struct CMUnitTest* catalogo_sintetico =
+            catalogo_sintetico_tests(&n_catalogo_sintetico);
+
+        total_tests = n_arquivo + n_compressao + n_versoes + n_servidor + n_lote +
+                      n_importacao + n_varredura + n_importacao_paralela +
+                      n_utils + n_instantaneo + n_exportacao +
+                      n_filtro + n_indice + n_estatisticas + n_rastro + n_diagnostico +
+                      n_rebalanceamento + n_espaco_livre + n_acesso_direto + n_busca_varios +
+                      n_concorrencia + n_catalogo_sintetico;
 
         struct CMUnitTest all_tests[total_tests];
         int i = 0;
 
         for (int j = 0; j < n_arquivo; j++) all_tests[i++] = arquivo[j];
+        for (int j = 0; j < n_compressao; j++) all_tests[i++] = compressao[j];
+        for (int j = 0; j < n_versoes; j++) all_tests[i++] = versoes[j];
+        for (int j = 0; j < n_servidor; j++) all_tests[i++] = servidor[j];
+        for (int j = 0; j < n_lote; j++) all_tests[i++] = lote[j];
+        for (int j = 0; j < n_importacao; j++) all_tests[i++] = importacao[j];
+        for (int j = 0; j < n_varredura; j++) all_tests[i++] = varredura[j];
+        for (int j = 0; j < n_importacao_paralela; j++)
+                all_tests[i++] = importacao_paralela[j];
+        for (int j = 0; j < n_utils; j++) all_tests[i++] = utils[j];
+        for (int j = 0; j < n_instantaneo; j++) all_tests[i++] = instantaneo[j];
+        for (int j = 0; j < n_exportacao; j++) all_tests[i++] = exportacao[j];
+        for (int j = 0; j < n_filtro; j++) all_tests[i++] = filtro[j];
+        for (int j = 0; j < n_indice; j++) all_tests[i++] = indice[j];
+        for (int j = 0; j < n_estatisticas; j++) all_tests[i++] = estatisticas[j];
+        for (int j = 0; j < n_rastro; j++) all_tests[i++] = rastro[j];
+        for (int j = 0; j < n_diagnostico; j++) all_tests[i++] = diagnostico[j];
+        for (int j = 0; j < n_rebalanceamento; j++) all_tests[i++] = rebalanceamento[j];
+        for (int j = 0; j < n_espaco_livre; j++) all_tests[i++] = espaco_livre[j];
+        for (int j = 0; j < n_acesso_direto; j++) all_tests[i++] = acesso_direto[j];
+        for (int j = 0; j < n_busca_varios; j++) all_tests[i++] = busca_varios[j];
+        for (int j = 0; j < n_concorrencia; j++) all_tests[i++] = concorrencia[j];
+        for (int j = 0; j < n_catalogo_sintetico; j++)
+                all_tests[i++] = catalogo_sintetico[j];
 
         return cmocka_run_group_tests(all_tests, NULL, NULL);
 }
@@ -0,0 +1,136 @@
+/**
+ * @file test_servidor.c
+ * @brief Testes do servidor de consultas e da biblioteca cliente.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/cliente.h"
+#include "../include/erros.h"
+#include "../include/servidor.h"
+
+/// @brief Caminhos do arquivo de livros e do socket usados pelo teste.
+static char caminho_livros[64];
+static char caminho_socket[64];
+
+/**
+ * @brief Auxiliar: cria um arquivo de livros vazio e inicia um servidor sobre ele.
+ */
+static SERVIDOR* aux_iniciar(void) {
+        snprintf(caminho_livros, sizeof(caminho_livros), "/tmp/test_servidor_%d.bin", getpid());
+        snprintf(caminho_socket, sizeof(caminho_socket), "/tmp/test_servidor_%d.sock", getpid());
+        remove(caminho_livros);
+        abrir_ou_criar_arquivo(caminho_livros);
+
+        SERVIDOR* servidor = iniciar_servidor(caminho_livros, caminho_socket, 3);
+        assert_non_null(servidor);
+        return servidor;
+}
+
+/**
+ * @test Pedidos enviados em pipeline são respondidos em ordem, com o resultado de cada um.
+ */
+static void test_servidor_pipeline(void** state) {
+        (void)state;
+        SERVIDOR* servidor = aux_iniciar();
+        CLIENTE* cliente = conectar_servidor(caminho_socket);
+        assert_non_null(cliente);
+
+        // Cadastros e buscas intercalados, todos enviados de uma vez
+        const size_t total = 300;
+        for (size_t i = 0; i < total; i++) {
+                LIVRO livro = {0};
+                livro.codigo = (i * 7919) % total + 1;
+                snprintf(livro.titulo, sizeof(livro.titulo), "Livro %zu", livro.codigo);
+                assert_int_equal(enfileirar_insercao(cliente, &livro, NULL), SUCESSO);
+                assert_int_equal(enfileirar_busca(cliente, livro.codigo, NULL), SUCESSO);
+        }
+        assert_int_equal(enfileirar_busca(cliente, total + 1, NULL), SUCESSO);
+        assert_int_equal(enviar_pedidos(cliente), SUCESSO);
+
+        RESPOSTA_CLIENTE resposta;
+        for (uint32_t id = 1; id <= 2 * total; id++) {
+                assert_int_equal(receber_resposta(cliente, &resposta), SUCESSO);
+                assert_int_equal(resposta.id, id);
+                assert_int_equal(resposta.status, SUCESSO);
+        }
+        assert_int_equal(receber_resposta(cliente, &resposta), SUCESSO);
+        assert_int_equal(resposta.status, ERRO_LIVRO_INVALIDO);
+
+        LIVRO* livros = NULL;
+        size_t quantidade = 0;
+        assert_int_equal(cliente_intervalo(cliente, 101, 200, 0, &livros, &quantidade), SUCESSO);
+        assert_int_equal(quantidade, 100);
+        for (size_t i = 0; i < quantidade; i++) assert_int_equal(livros[i].codigo, 101 + i);
+        free(livros);
+
+        LIVRO livro = {0};
+        livro.codigo = 1;
+        assert_int_equal(cliente_inserir(cliente, &livro), ERRO_CODIGO_DUPLICADO);
+        assert_int_equal(cliente_remover(cliente, 150), SUCESSO);
+        assert_int_equal(cliente_buscar(cliente, 150, &livro), ERRO_LIVRO_INVALIDO);
+
+        ESTATISTICAS_SERVIDOR estatisticas;
+        assert_int_equal(cliente_estatisticas(cliente, &estatisticas), SUCESSO);
+        assert_int_equal(estatisticas.quantidade_livros, total - 1);
+        assert_int_equal(estatisticas.conexoes_ativas, 1);
+
+        desconectar_servidor(cliente);
+        parar_servidor(servidor);
+        assert_int_not_equal(access(caminho_socket, F_OK), 0);
+        remove(caminho_livros);
+}
+
+/**
+ * @test Um pedido com operação desconhecida recebe ERRO_PROTOCOLO sem derrubar a conexão.
+ */
+static void test_servidor_operacao_desconhecida(void** state) {
+        (void)state;
+        SERVIDOR* servidor = aux_iniciar();
+        CLIENTE* cliente = conectar_servidor(caminho_socket);
+        assert_non_null(cliente);
+
+        CABECALHO_PEDIDO pedido = {0};
+        pedido.id = 77;
+        pedido.operacao = 99;
+        pedido.tamanho = 3;
+        assert_int_equal(acrescentar_buffer(&cliente->saida, &pedido, sizeof(pedido)), SUCESSO);
+        assert_int_equal(acrescentar_buffer(&cliente->saida, "abc", 3), SUCESSO);
+        assert_int_equal(enviar_pedidos(cliente), SUCESSO);
+
+        RESPOSTA_CLIENTE resposta;
+        assert_int_equal(receber_resposta(cliente, &resposta), SUCESSO);
+        assert_int_equal(resposta.id, 77);
+        assert_int_equal(resposta.status, ERRO_PROTOCOLO);
+
+        LIVRO livro;
+        assert_int_equal(cliente_buscar(cliente, 1, &livro), ERRO_LIVRO_INVALIDO);
+
+        desconectar_servidor(cliente);
+        parar_servidor(servidor);
+        remove(caminho_livros);
+}
+
+/**
+ * @brief Retorna a lista de testes do servidor a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* servidor_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_servidor_pipeline),
+            cmocka_unit_test(test_servidor_operacao_desconhecida)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
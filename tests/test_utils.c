@@ -0,0 +1,110 @@
+/**
+ * @file test_utils.c
+ * @brief Testes unitários para as conversões numéricas de utils.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+
+#include "../include/utils.h"
+
+/**
+ * @brief Auxiliar: converter_size_t() sobre uma string terminada em nulo.
+ */
+static int aux_size_t(const char* texto, size_t* valor) {
+        return converter_size_t(texto, strlen(texto), valor);
+}
+
+/**
+ * @brief Auxiliar: converter_preco() sobre uma string terminada em nulo.
+ */
+static int aux_preco(const char* texto, double* valor) {
+        return converter_preco(texto, strlen(texto), valor);
+}
+
+/**
+ * @test Inteiros válidos, lixo e estouro de size_t.
+ */
+static void test_converter_size_t(void** state) {
+        (void)state;
+        size_t valor = 0;
+
+        assert_true(aux_size_t("0", &valor));
+        assert_int_equal(valor, 0);
+        assert_true(aux_size_t("2024", &valor));
+        assert_int_equal(valor, 2024);
+        assert_true(aux_size_t("18446744073709551615", &valor));
+        assert_true(valor == SIZE_MAX);
+        assert_true(aux_size_t("00000000000000000000000042", &valor));
+        assert_int_equal(valor, 42);
+
+        valor = 7;
+        assert_false(aux_size_t("18446744073709551616", &valor));
+        assert_false(aux_size_t("", &valor));
+        assert_false(aux_size_t("12a", &valor));
+        assert_false(aux_size_t("-1", &valor));
+        assert_false(aux_size_t("+1", &valor));
+        assert_false(aux_size_t(" 1", &valor));
+        assert_int_equal(valor, 7);
+
+        // Sem terminador nulo: só os caracteres informados contam.
+        assert_true(converter_size_t("123456", 3, &valor));
+        assert_int_equal(valor, 123);
+}
+
+/**
+ * @test Preços com vírgula ou ponto, arredondamento correto e entradas inválidas.
+ */
+static void test_converter_preco(void** state) {
+        (void)state;
+        double valor = 0;
+
+        assert_true(aux_preco("12,50", &valor));
+        assert_true(valor == 12.5);
+        assert_true(aux_preco("19.90", &valor));
+        assert_true(valor == 19.90);
+        assert_true(aux_preco("0.1", &valor));
+        assert_true(valor == 0.1);
+        assert_true(aux_preco("7", &valor));
+        assert_true(valor == 7.0);
+        assert_true(aux_preco(",5", &valor));
+        assert_true(valor == 0.5);
+        assert_true(aux_preco("3.", &valor));
+        assert_true(valor == 3.0);
+        assert_true(aux_preco("123456789012.345", &valor));
+        assert_true(valor == 123456789012.345);
+        assert_true(aux_preco("0.0000000000000000000000001", &valor));
+        assert_true(valor == 0.0);
+
+        valor = 1;
+        assert_false(aux_preco("", &valor));
+        assert_false(aux_preco(".", &valor));
+        assert_false(aux_preco("1,2,3", &valor));
+        assert_false(aux_preco("1.2.3", &valor));
+        assert_false(aux_preco("-1", &valor));
+        assert_false(aux_preco("1e3", &valor));
+        assert_false(aux_preco("12 ", &valor));
+        assert_false(aux_preco("12345678901234567890", &valor));
+        assert_true(valor == 1);
+}
+
+/**
+ * @brief Retorna a lista de testes de utils a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* utils_tests(int* n) {
+        static const struct CMUnitTest tests[] = {cmocka_unit_test(test_converter_size_t),
+                                                  cmocka_unit_test(test_converter_preco)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file test_varredura.c
+ * @brief Testes unitários para a varredura vetorizada.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../include/varredura.h"
+
+/** Bytes examinados em cada comparação. */
+#define TAMANHO_AMOSTRA 200
+
+/**
+ * @brief Referência byte a byte para buscar_quebra().
+ */
+static const char* quebra_referencia(const char* inicio, const char* fim) {
+        for (const char* p = inicio; p < fim; p++) {
+                if (*p == '\n') return p;
+        }
+        return NULL;
+}
+
+/**
+ * @brief Referência byte a byte para pular_espacos().
+ */
+static const char* texto_referencia(const char* inicio, const char* fim) {
+        const char* p = inicio;
+        while (p < fim && strchr(" \t\n\v\f\r", *p) && *p) p++;
+        return p;
+}
+
+/**
+ * @brief Compara a implementação ativa com as referências em todos os recortes de `dados`.
+ */
+static void comparar_recortes(const char* dados, size_t tamanho) {
+        for (size_t inicio = 0; inicio < tamanho; inicio++) {
+                for (size_t fim = inicio; fim <= tamanho; fim++) {
+                        const char* a = dados + inicio;
+                        const char* b = dados + fim;
+
+                        assert_ptr_equal(buscar_quebra(a, b), quebra_referencia(a, b));
+                        assert_ptr_equal(pular_espacos(a, b), texto_referencia(a, b));
+
+                        const char* posicoes[8];
+                        size_t achados = buscar_separadores(a, b, posicoes, 8);
+                        size_t esperados = 0;
+                        for (const char* p = a; p < b && esperados < 8; p++) {
+                                if (*p != ';') continue;
+                                assert_true(esperados < achados);
+                                assert_ptr_equal(posicoes[esperados], p);
+                                esperados++;
+                        }
+                        assert_int_equal(achados, esperados);
+                }
+        }
+}
+
+/**
+ * @test Todas as implementações suportadas concordam com a referência escalar, inclusive em
+ *       textos que terminam exatamente no fim de uma página seguida de uma página protegida.
+ */
+static void test_varredura_implementacoes(void** state) {
+        (void)state;
+        size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+        char* paginas = mmap(NULL, 2 * pagina, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                             -1, 0);
+        assert_true(paginas != MAP_FAILED);
+        assert_int_equal(mprotect(paginas + pagina, pagina, PROT_NONE), 0);
+
+        // Mistura de texto, separadores, quebras e espaços, encostada na página protegida.
+        char* dados = paginas + pagina - TAMANHO_AMOSTRA;
+        const char alfabeto[] = "ab;\n \t\r;xyz  ";
+        srand(7);
+        for (size_t i = 0; i < TAMANHO_AMOSTRA; i++)
+                dados[i] = alfabeto[rand() % (sizeof(alfabeto) - 1)];
+
+        IMPLEMENTACAO_VARREDURA padrao = varredura_ativa();
+        const IMPLEMENTACAO_VARREDURA implementacoes[] = {VARREDURA_ESCALAR, VARREDURA_SSE2,
+                                                          VARREDURA_AVX2};
+        for (size_t i = 0; i < sizeof(implementacoes) / sizeof(implementacoes[0]); i++) {
+                if (!definir_varredura(implementacoes[i])) continue;
+                comparar_recortes(dados, TAMANHO_AMOSTRA);
+        }
+
+        assert_true(definir_varredura(padrao));
+        munmap(paginas, 2 * pagina);
+}
+
+/**
+ * @brief Retorna a lista de testes da varredura a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* varredura_tests(int* n) {
+        static const struct CMUnitTest tests[] = {cmocka_unit_test(test_varredura_implementacoes)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -0,0 +1,263 @@
+/**
+ * @file test_versoes.c
+ * @brief Testes unitários para o modo copy-on-write e as versões de leitura.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/diagnostico.h"
+#include "../include/erros.h"
+#include "../include/versoes.h"
+
+/**
+ * @brief Auxiliar: insere os códigos dados com inserir_no_arvore_cow().
+ */
+static void aux_inserir_cow(FILE* arquivo, const size_t* codigos, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+                NO_ARVORE no = {0};
+                no.livro.codigo = codigos[i];
+                assert_int_equal(inserir_no_arvore_cow(arquivo, &no), SUCESSO);
+        }
+}
+
+/**
+ * @brief Auxiliar: visitante que acumula os códigos visitados.
+ */
+static int aux_coletar(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)posicao;
+        size_t* codigos = contexto;
+        codigos[++codigos[0]] = no->livro.codigo;
+        return SUCESSO;
+}
+
+/**
+ * @test Uma versão aberta continua vendo a árvore antiga após inserções e remoções.
+ */
+static void test_versao_isolada_de_escritas(void** state) {
+        (void)state;
+        FILE* arquivo = tmpfile();
+        assert_non_null(arquivo);
+        assert_int_equal(inicializar_arquivo_cabecalho(arquivo), SUCESSO);
+
+        const size_t codigos[] = {50, 30, 70, 20, 40, 60, 80};
+        aux_inserir_cow(arquivo, codigos, 7);
+
+        VERSAO_ARVORE antiga;
+        assert_int_equal(abrir_versao(arquivo, &antiga), SUCESSO);
+        assert_int_equal(antiga.quantidade, 7);
+
+        // Remove a raiz (dois filhos), uma folha e insere um código novo
+        assert_int_equal(remover_no_arvore_cow(arquivo, 50), SUCESSO);
+        assert_int_equal(remover_no_arvore_cow(arquivo, 20), SUCESSO);
+        assert_int_equal(remover_no_arvore_cow(arquivo, 99), ERRO_NO_NULO);
+        const size_t novo[] = {45};
+        aux_inserir_cow(arquivo, novo, 1);
+
+        LIVRO livro;
+        assert_int_equal(buscar_na_versao(arquivo, &antiga, 50, &livro), SUCESSO);
+        assert_int_equal(buscar_na_versao(arquivo, &antiga, 45, &livro), ERRO_LIVRO_INVALIDO);
+
+        size_t vistos[16] = {0};
+        assert_int_equal(percorrer_versao_em_ordem(arquivo, &antiga, aux_coletar, vistos), SUCESSO);
+        assert_int_equal(vistos[0], 7);
+        assert_int_equal(vistos[1], 20);
+        assert_int_equal(vistos[7], 80);
+
+        VERSAO_ARVORE atual;
+        assert_int_equal(abrir_versao(arquivo, &atual), SUCESSO);
+        assert_int_equal(atual.quantidade, 6);
+
+        const size_t esperado[] = {30, 40, 45, 60, 70, 80};
+        size_t atuais[16] = {0};
+        assert_int_equal(percorrer_versao_em_ordem(arquivo, &atual, aux_coletar, atuais), SUCESSO);
+        assert_int_equal(atuais[0], 6);
+        for (size_t i = 0; i < 6; i++) assert_int_equal(atuais[i + 1], esperado[i]);
+
+        fechar_versao(&atual);
+        fechar_versao(&antiga);
+        assert_int_equal(recuperar_versoes_antigas(arquivo), SUCESSO);
+        fclose(arquivo);
+}
+
+/**
+ * @test Nós substituídos só voltam à lista livre depois que a versão que os usa é fechada.
+ */
+static void test_recuperacao_apos_fechar_versao(void** state) {
+        (void)state;
+        FILE* arquivo = tmpfile();
+        assert_non_null(arquivo);
+        assert_int_equal(inicializar_arquivo_cabecalho(arquivo), SUCESSO);
+        assert_int_equal(recuperar_versoes_antigas(arquivo), SUCESSO);
+
+        const size_t codigos[] = {10, 5, 15};
+        aux_inserir_cow(arquivo, codigos, 3);
+
+        VERSAO_ARVORE versao;
+        assert_int_equal(abrir_versao(arquivo, &versao), SUCESSO);
+        assert_int_equal(remover_no_arvore_cow(arquivo, 5), SUCESSO);
+
+        // Com a versão aberta, nada que ela alcança pode ser recuperado
+        assert_int_equal(recuperar_versoes_antigas(arquivo), SUCESSO);
+        assert_true(quantidade_nos_aposentados(arquivo) >= 2);
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        int topo = cabecalho->topo;
+        free(cabecalho);
+
+        fechar_versao(&versao);
+        assert_int_equal(recuperar_versoes_antigas(arquivo), SUCESSO);
+        assert_int_equal(quantidade_nos_aposentados(arquivo), 0);
+
+        // A próxima inserção reaproveita posições livres em vez de crescer o arquivo
+        const size_t novo[] = {7};
+        aux_inserir_cow(arquivo, novo, 1);
+        cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        assert_int_equal(cabecalho->topo, topo);
+        assert_int_equal(cabecalho->quantidade_livros, 3);
+        free(cabecalho);
+
+        fclose(arquivo);
+}
+
+/**
+ * @test Uma versão aberta por outro processo também impede a recuperação dos nós que ela
+ * alcança, e a leitura dela continua certa depois das escritas.
+ */
+static void test_versao_de_outro_processo(void** state) {
+        (void)state;
+        char caminho[80];
+        snprintf(caminho, sizeof(caminho), "/tmp/test_versoes_processo_%d.bin", getpid());
+        remove(caminho);
+        abrir_ou_criar_arquivo(caminho);
+        FILE* arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+
+        const size_t codigos[] = {10, 5, 15, 3, 7};
+        aux_inserir_cow(arquivo, codigos, 5);
+
+        int aberta[2], continuar[2];
+        assert_int_equal(pipe(aberta), 0);
+        assert_int_equal(pipe(continuar), 0);
+        pid_t filho = fork();
+        assert_true(filho >= 0);
+        if (filho == 0) {
+                FILE* leitor = fopen(caminho, "rb");
+                VERSAO_ARVORE versao;
+                char sinal = 0;
+                int ok = leitor != NULL && abrir_versao(leitor, &versao) == SUCESSO;
+                ok = write(aberta[1], &sinal, 1) == 1 && ok;
+                ok = read(continuar[0], &sinal, 1) == 1 && ok;
+
+                size_t vistos[16] = {0};
+                ok = ok && percorrer_versao_em_ordem(leitor, &versao, aux_coletar, vistos) ==
+                               SUCESSO;
+                ok = ok && vistos[0] == 5 && vistos[1] == 3 && vistos[5] == 15;
+                if (ok) fechar_versao(&versao);
+                _exit(ok ? 0 : 1);
+        }
+
+        char sinal = 0;
+        assert_int_equal(read(aberta[0], &sinal, 1), 1);
+        assert_int_equal(remover_no_arvore_cow(arquivo, 3), SUCESSO);
+        assert_int_equal(remover_no_arvore_cow(arquivo, 10), SUCESSO);
+        const size_t novos[] = {1, 2, 4, 6};
+        aux_inserir_cow(arquivo, novos, 4);
+        assert_true(quantidade_nos_aposentados(arquivo) >= 2);
+
+        // Os nós aposentados aparecem no diagnóstico, e nenhum é dado como perdido
+        DIAGNOSTICO_ARVORE diagnostico;
+        assert_int_equal(diagnosticar_arvore(arquivo, &diagnostico), SUCESSO);
+        assert_true(diagnostico.aposentadas > quantidade_nos_aposentados(arquivo));
+        assert_int_equal(diagnostico.perdidas, 0);
+        assert_int_equal(diagnostico.ligacoes_invalidas, 0);
+        liberar_diagnostico(&diagnostico);
+
+        assert_int_equal(write(continuar[1], &sinal, 1), 1);
+        int situacao = 0;
+        assert_int_equal(waitpid(filho, &situacao, 0), filho);
+        assert_true(WIFEXITED(situacao));
+        assert_int_equal(WEXITSTATUS(situacao), 0);
+        close(aberta[0]);
+        close(aberta[1]);
+        close(continuar[0]);
+        close(continuar[1]);
+
+        assert_int_equal(recuperar_versoes_antigas(arquivo), SUCESSO);
+        assert_int_equal(quantidade_nos_aposentados(arquivo), 0);
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @test Nós aposentados com uma versão aberta ficam no arquivo e são recuperados depois que
+ * ele é fechado e reaberto.
+ */
+static void test_aposentados_persistem_no_arquivo(void** state) {
+        (void)state;
+        char caminho[80];
+        snprintf(caminho, sizeof(caminho), "/tmp/test_versoes_persistencia_%d.bin", getpid());
+        remove(caminho);
+        abrir_ou_criar_arquivo(caminho);
+        FILE* arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+
+        const size_t codigos[] = {20, 10, 30};
+        aux_inserir_cow(arquivo, codigos, 3);
+        VERSAO_ARVORE versao;
+        assert_int_equal(abrir_versao(arquivo, &versao), SUCESSO);
+        assert_int_equal(remover_no_arvore_cow(arquivo, 10), SUCESSO);
+        size_t aposentados = quantidade_nos_aposentados(arquivo);
+        assert_true(aposentados >= 2);
+
+        CABECALHO* cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        int topo = cabecalho->topo;
+        free(cabecalho);
+        fclose(arquivo);
+        fechar_versao(&versao);
+
+        arquivo = fopen(caminho, "rb+");
+        assert_non_null(arquivo);
+        assert_int_equal(quantidade_nos_aposentados(arquivo), aposentados);
+        assert_int_equal(recuperar_versoes_antigas(arquivo), SUCESSO);
+        assert_int_equal(quantidade_nos_aposentados(arquivo), 0);
+
+        const size_t novo[] = {15};
+        aux_inserir_cow(arquivo, novo, 1);
+        cabecalho = le_cabecalho(arquivo);
+        assert_non_null(cabecalho);
+        assert_int_equal(cabecalho->topo, topo);
+        assert_int_equal(cabecalho->quantidade_livros, 3);
+        free(cabecalho);
+
+        fclose(arquivo);
+        remove(caminho);
+}
+
+/**
+ * @brief Retorna a lista de testes de versões a serem executados.
+ *
+ * @param[out] n Número de testes.
+ * @return Vetor com os testes definidos.
+ */
+const struct CMUnitTest* versoes_tests(int* n) {
+        static const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_versao_isolada_de_escritas),
+            cmocka_unit_test(test_recuperacao_apos_fechar_versao),
+            cmocka_unit_test(test_versao_de_outro_processo),
+            cmocka_unit_test(test_aposentados_persistem_no_arquivo)};
+
+        *n = sizeof(tests) / sizeof(tests[0]);
+        return tests;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file cliente.c
+ * @brief Linha de comando que conversa com o servidor de consultas.
+ *
+ * Uso:
+ * @code
+ *   cliente [-s SOCKET] buscar CODIGO...
+ *   cliente [-s SOCKET] remover CODIGO...
+ *   cliente [-s SOCKET] inserir "codigo;titulo;autor;editora;edicao;ano;exemplares;preco"...
+ *   cliente [-s SOCKET] intervalo INICIO FIM [LIMITE]
+ *   cliente [-s SOCKET] estatisticas
+ * @endcode
+ *
+ * Vários códigos (ou livros) na mesma chamada são enviados de uma vez, em pipeline, e as
+ * respostas são impressas na ordem dos argumentos.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/cliente.h"
+#include "../include/erros.h"
+#include "../include/importacao.h"
+#include "../include/livro.h"
+#include "../include/servidor.h"
+#include "../include/utils.h"
+
+/**
+ * @brief Imprime a forma de uso na saída de erro.
+ */
+static void imprimir_uso(const char* programa) {
+        fprintf(stderr,
+                "Uso: %s [-s SOCKET] COMANDO [ARGUMENTOS]\n"
+                "  buscar CODIGO...\n"
+                "  remover CODIGO...\n"
+                "  inserir \"codigo;titulo;autor;editora;edicao;ano;exemplares;preco\"...\n"
+                "  intervalo INICIO FIM [LIMITE]\n"
+                "  estatisticas\n",
+                programa);
+}
+
+/**
+ * @brief Converte um argumento em código, rejeitando texto que não seja número positivo ou que
+ * não caiba em size_t.
+ *
+ * @return 1 se válido, 0 caso contrário.
+ */
+static int ler_codigo(const char* texto, size_t* codigo) {
+        size_t valor;
+        if (!converter_size_t(texto, strlen(texto), &valor) || valor == 0) return 0;
+
+        *codigo = valor;
+        return 1;
+}
+
+/**
+ * @brief Lê os argumentos de `intervalo`: INICIO FIM e, se `quantidade` for 3, LIMITE.
+ *
+ * @return 1 se todos forem números válidos (LIMITE até UINT32_MAX), 0 caso contrário.
+ */
+static int ler_intervalo(int quantidade, char* argv[], size_t* inicio, size_t* fim,
+                         uint32_t* limite) {
+        size_t valor = 0;
+        if (!converter_size_t(argv[0], strlen(argv[0]), inicio) ||
+            !converter_size_t(argv[1], strlen(argv[1]), fim))
+                return 0;
+        if (quantidade == 3 &&
+            (!converter_size_t(argv[2], strlen(argv[2]), &valor) || valor > UINT32_MAX))
+                return 0;
+
+        *limite = (uint32_t)valor;
+        return 1;
+}
+
+/**
+ * @brief Lê um livro no mesmo formato de linha do arquivo texto de importação.
+ *
+ * @return 1 se válido, 0 caso contrário.
+ */
+static int ler_livro_argumento(const char* texto, LIVRO* livro) {
+        return interpretar_livro(texto, strlen(texto), livro) == SUCESSO && livro->codigo > 0;
+}
+
+/**
+ * @brief Imprime um livro no mesmo formato do menu.
+ */
+static void imprimir_livro(const LIVRO* livro) {
+        printf("Codigo: %zu\nTitulo: %s\nAutor: %s\nEditora: %s\nEdicao: %zu\nAno: %zu\n"
+               "Exemplares: %zu\nPreco: %.2f\n\n",
+               livro->codigo, livro->titulo, livro->autor, livro->editora, livro->edicao,
+               livro->ano, livro->exemplares, livro->preco);
+}
+
+/**
+ * @brief Envia em pipeline um pedido por argumento e imprime as respostas em ordem.
+ *
+ * @return 0 se todos os pedidos tiveram sucesso, 1 caso contrário.
+ */
+static int executar_em_lote(CLIENTE* cliente, const char* comando, int argc, char* argv[]) {
+        for (int i = 0; i < argc; i++) {
+                size_t codigo;
+                LIVRO livro;
+                int status;
+
+                if (strcmp(comando, "inserir") == 0) {
+                        if (!ler_livro_argumento(argv[i], &livro)) {
+                                fprintf(stderr, "Livro invalido: %s\n", argv[i]);
+                                return 1;
+                        }
+                        status = enfileirar_insercao(cliente, &livro, NULL);
+                } else {
+                        if (!ler_codigo(argv[i], &codigo)) {
+                                fprintf(stderr, "Codigo invalido: %s\n", argv[i]);
+                                return 1;
+                        }
+                        status = strcmp(comando, "buscar") == 0
+                                     ? enfileirar_busca(cliente, codigo, NULL)
+                                     : enfileirar_remocao(cliente, codigo, NULL);
+                }
+
+                if (status != SUCESSO) {
+                        fprintf(stderr, "Erro ao preparar pedido (%d)\n", status);
+                        return 1;
+                }
+        }
+
+        if (enviar_pedidos(cliente) != SUCESSO) {
+                fprintf(stderr, "Erro ao enviar pedidos\n");
+                return 1;
+        }
+
+        int falhas = 0;
+        for (int i = 0; i < argc; i++) {
+                RESPOSTA_CLIENTE resposta;
+                if (receber_resposta(cliente, &resposta) != SUCESSO) {
+                        fprintf(stderr, "Conexao encerrada pelo servidor\n");
+                        return 1;
+                }
+
+                if (resposta.status != SUCESSO) {
+                        printf("%s: erro %d\n", argv[i], resposta.status);
+                        falhas++;
+                } else if (strcmp(comando, "buscar") == 0 && resposta.tamanho == sizeof(LIVRO)) {
+                        LIVRO livro;
+                        memcpy(&livro, resposta.carga, sizeof(LIVRO));
+                        imprimir_livro(&livro);
+                } else {
+                        printf("%s: ok\n", argv[i]);
+                }
+        }
+
+        return falhas > 0;
+}
+
+/**
+ * @brief Ponto de entrada do cliente de linha de comando.
+ */
+int main(int argc, char* argv[]) {
+        const char* caminho_socket = CAMINHO_SOCKET_PADRAO;
+        int i = 1;
+
+        if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+                caminho_socket = argv[i + 1];
+                i += 2;
+        }
+        if (i >= argc) {
+                imprimir_uso(argv[0]);
+                return 2;
+        }
+
+        const char* comando = argv[i++];
+        CLIENTE* cliente = conectar_servidor(caminho_socket);
+        if (cliente == NULL) {
+                fprintf(stderr, "Nao foi possivel conectar a %s\n", caminho_socket);
+                return 1;
+        }
+
+        int resultado = 0;
+        size_t inicio, fim;
+        uint32_t limite;
+
+        if (strcmp(comando, "buscar") == 0 || strcmp(comando, "remover") == 0 ||
+            strcmp(comando, "inserir") == 0) {
+                resultado = i < argc ? executar_em_lote(cliente, comando, argc - i, argv + i) : 2;
+        } else if (strcmp(comando, "intervalo") == 0 && (argc - i == 2 || argc - i == 3) &&
+                   ler_intervalo(argc - i, argv + i, &inicio, &fim, &limite)) {
+                LIVRO* livros = NULL;
+                size_t quantidade = 0;
+                int status = cliente_intervalo(cliente, inicio, fim, limite, &livros, &quantidade);
+                if (status == SUCESSO) {
+                        for (size_t j = 0; j < quantidade; j++) imprimir_livro(&livros[j]);
+                        printf("%zu livro(s)\n", quantidade);
+                } else {
+                        fprintf(stderr, "Erro na consulta (%d)\n", status);
+                        resultado = 1;
+                }
+                free(livros);
+        } else if (strcmp(comando, "estatisticas") == 0 && i == argc) {
+                ESTATISTICAS_SERVIDOR estatisticas;
+                int status = cliente_estatisticas(cliente, &estatisticas);
+                if (status == SUCESSO) {
+                        printf("livros: %llu\nconexoes_ativas: %llu\nconexoes_aceitas: %llu\n"
+                               "pedidos_atendidos: %llu\npedidos_com_erro: %llu\n",
+                               (unsigned long long)estatisticas.quantidade_livros,
+                               (unsigned long long)estatisticas.conexoes_ativas,
+                               (unsigned long long)estatisticas.conexoes_aceitas,
+                               (unsigned long long)estatisticas.pedidos_atendidos,
+                               (unsigned long long)estatisticas.pedidos_com_erro);
+                } else {
+                        fprintf(stderr, "Erro ao ler estatisticas (%d)\n", status);
+                        resultado = 1;
+                }
+        } else {
+                resultado = 2;
+        }
+
+        if (resultado == 2) imprimir_uso(argv[0]);
+        desconectar_servidor(cliente);
+        return resultado;
+}
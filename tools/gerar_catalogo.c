@@ -0,0 +1,197 @@
+/**
+ * @file gerar_catalogo.c
+ * @brief Gera catálogos sintéticos reprodutíveis, em texto de importação ou direto em binário.
+ *
+ * Uso:
+ * @code
+ *   gerar_catalogo [-n LINHAS] [-s SEMENTE] [-d DISTRIBUICAO] [-z THETA] [-g GRUPO]
+ *                  [-l MIN:MAX[:cauda]] [-r DUPLICATAS] [-o TEXTO] [-b BINARIO]
+ * @endcode
+ *
+ * Cada linha segue o formato de importação `codigo;titulo;autor;editora;edicao;ano;exemplares;
+ * preco`. A ordem dos códigos segue a distribuição escolhida com `-d`:
+ *
+ * - ordenada e reversa: 1..LINHAS, crescente ou decrescente;
+ * - aleatoria: uma permutação de 1..LINHAS;
+ * - agrupada: grupos de GRUPO códigos consecutivos, com os grupos em ordem aleatória;
+ * - zipf: códigos sorteados de 1..LINHAS com popularidade Zipf de expoente THETA e espalhados
+ *   pela permutação, como o "scrambled zipfian" do YCSB; códigos populares se repetem.
+ *
+ * `-r` faz uma fração das linhas repetir o código de uma linha anterior (a importação as
+ * rejeita como duplicadas). Os campos de texto têm comprimento sorteado entre MIN e MAX
+ * (limitado ao tamanho de cada campo), uniforme ou, com `:cauda`, concentrado perto de MIN.
+ *
+ * Tudo é função da semente e do número da linha, sem estado: a mesma linha de comando gera
+ * sempre o mesmo arquivo, e a memória usada não depende de LINHAS (exceto com `-b`). A geração
+ * fica em catalogo_sintetico.h; esta ferramenta só interpreta as opções.
+ *
+ * `-b` grava o arquivo de livros pelo caminho rápido, escrever_catalogo_binario(): os códigos
+ * distintos, com os mesmos livros do texto, numa árvore balanceada escrita sequencialmente. O
+ * formato da árvore não depende da ordem de `-d`, só do conjunto de códigos. Sem `-o` nem
+ * `-b`, o texto vai para a saída padrão.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/catalogo_sintetico.h"
+#include "../include/erros.h"
+
+/** Expoente Zipf padrão, o mesmo do YCSB. */
+#define THETA_PADRAO 0.99
+
+/** Códigos consecutivos por grupo da distribuição agrupada, se `-g` não for dado. */
+#define GRUPO_PADRAO 1000
+
+/** Buffer da saída de texto. */
+#define TAMANHO_BUFFER_SAIDA (1 << 20)
+
+/**
+ * @brief Converte o nome da distribuição.
+ *
+ * @return 1 se reconhecido, 0 caso contrário.
+ */
+static int ler_distribuicao(const char* nome, DISTRIBUICAO_CATALOGO* distribuicao) {
+        static const char* const nomes[] = {"ordenada", "reversa", "aleatoria", "agrupada",
+                                            "zipf"};
+        for (size_t i = 0; i < sizeof(nomes) / sizeof(nomes[0]); i++) {
+                if (strcmp(nome, nomes[i]) == 0) {
+                        *distribuicao = (DISTRIBUICAO_CATALOGO)i;
+                        return 1;
+                }
+        }
+        return 0;
+}
+
+/**
+ * @brief Converte `MIN:MAX` ou `MIN:MAX:cauda`.
+ *
+ * @return 1 se válido, 0 caso contrário.
+ */
+static int ler_comprimentos(const char* texto, CATALOGO_SINTETICO* catalogo) {
+        char* fim;
+        catalogo->comprimento_minimo = strtoul(texto, &fim, 10);
+        if (*fim != ':') return 0;
+        catalogo->comprimento_maximo = strtoul(fim + 1, &fim, 10);
+        catalogo->cauda = strcmp(fim, ":cauda") == 0;
+        return (*fim == '\0' || catalogo->cauda) && catalogo->comprimento_minimo > 0 &&
+               catalogo->comprimento_minimo <= catalogo->comprimento_maximo;
+}
+
+/**
+ * @brief Imprime a forma de uso na saída de erro.
+ */
+static void imprimir_uso(const char* programa) {
+        fprintf(stderr,
+                "Uso: %s [opcoes]\n"
+                "  -n LINHAS           linhas do catalogo (padrao 1000000)\n"
+                "  -s SEMENTE          semente dos sorteios (padrao 1)\n"
+                "  -d DISTRIBUICAO     ordenada, reversa, aleatoria, agrupada ou zipf\n"
+                "  -z THETA            expoente da zipf, entre 0 e 1 (padrao %.2f)\n"
+                "  -g GRUPO            codigos por grupo da agrupada (padrao %d)\n"
+                "  -l MIN:MAX[:cauda]  comprimento dos campos de texto (padrao 10:60)\n"
+                "  -r DUPLICATAS       fracao de linhas com codigo repetido (padrao 0)\n"
+                "  -o TEXTO            arquivo texto de importacao (padrao: saida padrao)\n"
+                "  -b BINARIO          arquivo de livros vazio a preencher pelo caminho rapido\n",
+                programa, THETA_PADRAO, GRUPO_PADRAO);
+}
+
+/**
+ * @brief Ponto de entrada do gerador.
+ */
+int main(int argc, char* argv[]) {
+        CATALOGO_SINTETICO catalogo = {0};
+        catalogo.linhas = 1000000;
+        catalogo.semente = 1;
+        catalogo.distribuicao = DISTRIBUICAO_ALEATORIA;
+        catalogo.grupo = GRUPO_PADRAO;
+        catalogo.comprimento_minimo = 10;
+        catalogo.comprimento_maximo = 60;
+        double theta = THETA_PADRAO;
+        const char* caminho_texto = NULL;
+        const char* caminho_binario = NULL;
+
+        int valido = 1;
+        for (int i = 1; i < argc && valido; i++) {
+                const char* opcao = argv[i];
+                const char* valor = i + 1 < argc ? argv[i + 1] : NULL;
+                if (valor == NULL || opcao[0] != '-' || opcao[1] == '\0' || opcao[2] != '\0') {
+                        valido = 0;
+                        break;
+                }
+                i++;
+                switch (opcao[1]) {
+                        case 'n':
+                                catalogo.linhas = strtoull(valor, NULL, 10);
+                                valido = catalogo.linhas > 0;
+                                break;
+                        case 's':
+                                catalogo.semente = strtoull(valor, NULL, 10);
+                                break;
+                        case 'd':
+                                valido = ler_distribuicao(valor, &catalogo.distribuicao);
+                                break;
+                        case 'z':
+                                theta = strtod(valor, NULL);
+                                valido = theta > 0 && theta < 1;
+                                break;
+                        case 'g':
+                                catalogo.grupo = strtoull(valor, NULL, 10);
+                                valido = catalogo.grupo > 0;
+                                break;
+                        case 'l':
+                                valido = ler_comprimentos(valor, &catalogo);
+                                break;
+                        case 'r':
+                                catalogo.duplicatas = strtod(valor, NULL);
+                                valido = catalogo.duplicatas >= 0 && catalogo.duplicatas < 1;
+                                break;
+                        case 'o':
+                                caminho_texto = valor;
+                                break;
+                        case 'b':
+                                caminho_binario = valor;
+                                break;
+                        default:
+                                valido = 0;
+                }
+        }
+        if (!valido) {
+                imprimir_uso(argv[0]);
+                return 2;
+        }
+
+        preparar_catalogo_sintetico(&catalogo, theta);
+
+        if (caminho_texto != NULL || caminho_binario == NULL) {
+                FILE* saida = caminho_texto != NULL ? fopen(caminho_texto, "w") : stdout;
+                if (saida == NULL) {
+                        fprintf(stderr, "Nao foi possivel criar %s\n", caminho_texto);
+                        return 1;
+                }
+                setvbuf(saida, NULL, _IOFBF, TAMANHO_BUFFER_SAIDA);
+                int status = escrever_catalogo_texto(&catalogo, saida);
+                if (saida != stdout && fclose(saida) != 0) status = ERRO_ARQUIVO_WRITE;
+                if (status != SUCESSO) {
+                        fprintf(stderr, "Erro ao gravar o texto (%d)\n", status);
+                        return 1;
+                }
+        }
+
+        if (caminho_binario != NULL) {
+                size_t distintos;
+                int status = escrever_catalogo_binario(&catalogo, caminho_binario, &distintos);
+                if (status == ERRO_ARVORE_NAO_VAZIA) {
+                        fprintf(stderr, "%s ja tem livros\n", caminho_binario);
+                        return 1;
+                }
+                if (status != SUCESSO) {
+                        fprintf(stderr, "Erro ao gravar %s (%d)\n", caminho_binario, status);
+                        return 1;
+                }
+                fprintf(stderr, "%s: %zu livros distintos\n", caminho_binario, distintos);
+        }
+
+        return 0;
+}
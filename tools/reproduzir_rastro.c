@@ -0,0 +1,433 @@
+/**
+ * @file reproduzir_rastro.c
+ * @brief Reexecuta um rastro de operações (rastro.h) sobre uma cópia do arquivo de livros e
+ * compara as durações com as originais.
+ *
+ * Uso:
+ * @code
+ *   reproduzir_rastro [-j] [-s SAIDA] RASTRO ARQUIVO_BIN
+ * @endcode
+ *
+ * ARQUIVO_BIN deve estar no estado em que a captura começou (por exemplo, um instantâneo
+ * restaurado ou uma cópia feita antes de `--rastro`); ele não é alterado, as operações rodam
+ * sobre uma cópia temporária. Cada registro é repetido em ordem de sequência, sem as pausas
+ * originais, com o próprio rastro aberto, de modo que as durações e os nós lidos da repetição
+ * são medidos como os da captura. Como no lote, a cópia ganha o filtro (filtro.h) e o índice
+ * (indice.h), reconstruídos a partir da árvore. Os cadastros repetidos usam livros só com o
+ * código.
+ *
+ * O relatório traz, por operação, as contagens, os percentis p50/p99 e o máximo de cada lado,
+ * os nós lidos em média e as operações cujo status mudou; e as 10 operações mais lentas da
+ * captura ao lado da duração repetida. `-j` troca o texto por um objeto JSON numa linha, e
+ * `-s` guarda o rastro da repetição (que por padrão é descartado).
+ *
+ * Precisa ser compilado com ESTATISTICAS, que é quem mede as operações.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arquivo.h"
+#include "../include/arvore.h"
+#include "../include/erros.h"
+#include "../include/espaco_livre.h"
+#include "../include/estatisticas.h"
+#include "../include/filtro.h"
+#include "../include/indice.h"
+#include "../include/livro.h"
+#include "../include/rastro.h"
+
+/** Operações mais lentas listadas no relatório. */
+#define MAIS_LENTAS 10
+
+/**
+ * Durações e contagens de uma operação, num dos lados da comparação.
+ */
+typedef struct {
+        uint32_t* duracoes; /**< Durações em ns, ordenadas antes do relatório. */
+        size_t quantidade;  /**< Registros da operação. */
+        uint64_t leituras;  /**< Soma dos nós lidos. */
+} LADO;
+
+/**
+ * Comparação de uma operação entre a captura e a repetição.
+ */
+typedef struct {
+        LADO original;      /**< Registros capturados. */
+        LADO repetido;      /**< Registros da repetição. */
+        size_t divergentes; /**< Registros com status diferente na repetição. */
+} COMPARACAO;
+
+/**
+ * @brief Visitante do percurso repetido; só percorre.
+ */
+static int visitar(const NO_ARVORE* no, int posicao, void* contexto) {
+        (void)no;
+        (void)posicao;
+        (void)contexto;
+        return SUCESSO;
+}
+
+/**
+ * @brief Repete uma operação registrada no arquivo aberto.
+ */
+static void repetir(FILE* arquivo, const REGISTRO_RASTRO* registro) {
+        size_t codigo = (size_t)registro->codigo;
+        switch (registro->operacao) {
+                case OPERACAO_CADASTRAR: {
+                        LIVRO livro = {0};
+                        livro.codigo = codigo;
+                        cadastrar_livro(arquivo, livro);
+                        break;
+                }
+                case OPERACAO_INSERIR: {
+                        NO_ARVORE no = {0};
+                        no.livro.codigo = codigo;
+                        no.filho_esquerdo = POSICAO_INVALIDA;
+                        no.filho_direito = POSICAO_INVALIDA;
+                        inserir_no_arvore(arquivo, &no);
+                        break;
+                }
+                case OPERACAO_BUSCAR: {
+                        RESULTADO_BUSCA resultado = {0};
+                        buscar_no_arvore(arquivo, codigo, &resultado);
+                        free(resultado.no);
+                        free(resultado.pai);
+                        break;
+                }
+                case OPERACAO_REMOVER:
+                        remover_no_arvore(arquivo, codigo);
+                        break;
+                case OPERACAO_PERCORRER:
+                        percorrer_em_ordem(arquivo, visitar, NULL);
+                        break;
+                default:
+                        break;
+        }
+}
+
+/**
+ * @brief Copia o arquivo `origem` para `destino`.
+ *
+ * @return SUCESSO, ERRO_ARQUIVO_NULO, ERRO_ARQUIVO_READ ou ERRO_ARQUIVO_WRITE.
+ */
+static int copiar_arquivo(const char* origem, const char* destino) {
+        FILE* entrada = fopen(origem, "rb");
+        if (entrada == NULL) return ERRO_ARQUIVO_NULO;
+        FILE* saida = fopen(destino, "wb");
+        if (saida == NULL) {
+                fclose(entrada);
+                return ERRO_ARQUIVO_NULO;
+        }
+
+        char bloco[1 << 16];
+        size_t lidos;
+        int status = SUCESSO;
+        while ((lidos = fread(bloco, 1, sizeof(bloco), entrada)) > 0)
+                if (fwrite(bloco, 1, lidos, saida) != lidos) status = ERRO_ARQUIVO_WRITE;
+        if (ferror(entrada)) status = ERRO_ARQUIVO_READ;
+        fclose(entrada);
+        if (fclose(saida) != 0) status = ERRO_ARQUIVO_WRITE;
+        return status;
+}
+
+/**
+ * @brief Executa os registros sobre o arquivo em `caminho_copia`, rastreando em `saida`, e lê
+ * o rastro resultante.
+ *
+ * @return SUCESSO ou o erro de abertura ou leitura.
+ */
+static int reproduzir(const REGISTRO_RASTRO* registros, size_t quantidade,
+                      const char* caminho_copia, const char* saida,
+                      REGISTRO_RASTRO** repetidos, size_t* quantidade_repetidos) {
+        FILE* arquivo = fopen(caminho_copia, "rb+");
+        if (arquivo == NULL) return ERRO_ARQUIVO_NULO;
+
+        // Sem eles as operações só ficam mais lentas, como no lote.
+        abrir_filtro(arquivo, caminho_copia);
+        abrir_indice(arquivo, caminho_copia);
+        abrir_mapa_livre(arquivo, caminho_copia);
+
+        int status = abrir_rastro(saida, quantidade);
+        if (status == SUCESSO) {
+                for (size_t i = 0; i < quantidade; i++) repetir(arquivo, &registros[i]);
+                status = fechar_rastro();
+        }
+        fechar_mapa_livre(arquivo);
+        fechar_indice(arquivo);
+        fechar_filtro(arquivo);
+        fclose(arquivo);
+        if (status != SUCESSO) return status;
+
+        return ler_rastro(saida, repetidos, quantidade_repetidos);
+}
+
+/**
+ * @brief Acrescenta uma duração e as leituras de um registro a um lado da comparação.
+ */
+static void acumular(LADO* lado, const REGISTRO_RASTRO* registro) {
+        lado->duracoes[lado->quantidade++] = registro->duracao_ns;
+        lado->leituras += registro->leituras;
+}
+
+/**
+ * @brief Ordena crescentemente, para qsort().
+ */
+static int comparar_duracoes(const void* a, const void* b) {
+        uint32_t x = *(const uint32_t*)a;
+        uint32_t y = *(const uint32_t*)b;
+        return (x > y) - (x < y);
+}
+
+/**
+ * @brief Duração, em microssegundos, abaixo da qual ficam `fracao` das operações do lado.
+ *
+ * As durações precisam estar ordenadas.
+ */
+static double percentil_us(const LADO* lado, double fracao) {
+        if (lado->quantidade == 0) return 0;
+
+        size_t indice = (size_t)(fracao * lado->quantidade + 0.999999);
+        if (indice > 0) indice--;
+        if (indice >= lado->quantidade) indice = lado->quantidade - 1;
+        return lado->duracoes[indice] / 1e3;
+}
+
+/**
+ * @brief Nós lidos por operação, em média.
+ */
+static double leituras_medias(const LADO* lado) {
+        return lado->quantidade ? (double)lado->leituras / lado->quantidade : 0;
+}
+
+/**
+ * @brief Guarda em `lentas` os índices dos registros mais lentos, do mais lento ao menos.
+ *
+ * @return Quantidade de índices guardados (até MAIS_LENTAS).
+ */
+static size_t selecionar_mais_lentas(const REGISTRO_RASTRO* registros, size_t quantidade,
+                                     size_t lentas[MAIS_LENTAS]) {
+        size_t guardadas = 0;
+        for (size_t i = 0; i < quantidade; i++) {
+                size_t j = guardadas < MAIS_LENTAS ? guardadas++ : MAIS_LENTAS;
+                // Inserção ordenada; o último é descartado quando a lista está cheia.
+                while (j > 0 && registros[lentas[j - 1]].duracao_ns < registros[i].duracao_ns) {
+                        if (j < MAIS_LENTAS) lentas[j] = lentas[j - 1];
+                        j--;
+                }
+                if (j < MAIS_LENTAS) lentas[j] = i;
+        }
+        return guardadas;
+}
+
+/**
+ * @brief Escreve o relatório da comparação.
+ */
+static void imprimir_relatorio(FILE* saida, int json, const REGISTRO_RASTRO* originais,
+                               const REGISTRO_RASTRO* repetidos, size_t quantidade,
+                               const COMPARACAO* comparacoes, const size_t* lentas,
+                               size_t quantidade_lentas) {
+        if (json) {
+                fprintf(saida, "{\"registros\":%zu,\"operacoes\":{", quantidade);
+        } else {
+                fprintf(saida, "%zu operacoes reproduzidas (duracoes em us)\n\n", quantidade);
+                fprintf(saida, "%-10s %8s %10s %10s %10s %10s %10s %10s %7s %7s %6s\n",
+                        "operacao", "n", "orig p50", "rep p50", "orig p99", "rep p99",
+                        "orig max", "rep max", "lidos", "rep", "div");
+        }
+
+        int primeira = 1;
+        for (int operacao = 0; operacao < QUANTIDADE_OPERACOES; operacao++) {
+                const COMPARACAO* c = &comparacoes[operacao];
+                if (c->original.quantidade == 0) continue;
+                if (json) {
+                        fprintf(saida,
+                                "%s\"%s\":{\"quantidade\":%zu,\"original\":{\"p50_us\":%.3f,"
+                                "\"p99_us\":%.3f,\"max_us\":%.3f,\"leituras\":%.2f},"
+                                "\"repetido\":{\"p50_us\":%.3f,\"p99_us\":%.3f,\"max_us\":%.3f,"
+                                "\"leituras\":%.2f},\"status_divergentes\":%zu}",
+                                primeira ? "" : ",", nome_operacao(operacao),
+                                c->original.quantidade, percentil_us(&c->original, 0.50),
+                                percentil_us(&c->original, 0.99), percentil_us(&c->original, 1.0),
+                                leituras_medias(&c->original), percentil_us(&c->repetido, 0.50),
+                                percentil_us(&c->repetido, 0.99), percentil_us(&c->repetido, 1.0),
+                                leituras_medias(&c->repetido), c->divergentes);
+                } else {
+                        fprintf(saida,
+                                "%-10s %8zu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f %7.2f %7.2f "
+                                "%6zu\n",
+                                nome_operacao(operacao), c->original.quantidade,
+                                percentil_us(&c->original, 0.50), percentil_us(&c->repetido, 0.50),
+                                percentil_us(&c->original, 0.99), percentil_us(&c->repetido, 0.99),
+                                percentil_us(&c->original, 1.0), percentil_us(&c->repetido, 1.0),
+                                leituras_medias(&c->original), leituras_medias(&c->repetido),
+                                c->divergentes);
+                }
+                primeira = 0;
+        }
+
+        if (json) {
+                fprintf(saida, "},\"mais_lentas\":[");
+        } else {
+                fprintf(saida, "\nMais lentas na captura:\n%-10s %12s %20s %10s %10s %7s %7s\n",
+                        "operacao", "sequencia", "codigo", "orig us", "rep us", "lidos", "rep");
+        }
+        for (size_t i = 0; i < quantidade_lentas; i++) {
+                const REGISTRO_RASTRO* original = &originais[lentas[i]];
+                const REGISTRO_RASTRO* repetido = &repetidos[lentas[i]];
+                if (json) {
+                        fprintf(saida,
+                                "%s{\"operacao\":\"%s\",\"sequencia\":%llu,\"codigo\":%llu,"
+                                "\"original_us\":%.3f,\"repetido_us\":%.3f,\"leituras\":%u,"
+                                "\"leituras_repetidas\":%u}",
+                                i ? "," : "", nome_operacao(original->operacao),
+                                (unsigned long long)original->sequencia,
+                                (unsigned long long)original->codigo, original->duracao_ns / 1e3,
+                                repetido->duracao_ns / 1e3, original->leituras,
+                                repetido->leituras);
+                } else {
+                        fprintf(saida, "%-10s %12llu %20llu %10.2f %10.2f %7u %7u\n",
+                                nome_operacao(original->operacao),
+                                (unsigned long long)original->sequencia,
+                                (unsigned long long)original->codigo, original->duracao_ns / 1e3,
+                                repetido->duracao_ns / 1e3, original->leituras,
+                                repetido->leituras);
+                }
+        }
+        if (json) fprintf(saida, "]}\n");
+}
+
+/**
+ * @brief Compara os registros originais com os repetidos, par a par, e imprime o relatório.
+ *
+ * @return SUCESSO ou ERRO_MEMORIA.
+ */
+static int comparar(FILE* saida, int json, const REGISTRO_RASTRO* originais,
+                    const REGISTRO_RASTRO* repetidos, size_t quantidade) {
+        COMPARACAO comparacoes[QUANTIDADE_OPERACOES];
+        memset(comparacoes, 0, sizeof(comparacoes));
+        uint32_t* duracoes = malloc(2 * quantidade * sizeof(uint32_t) + 1);
+        if (duracoes == NULL) return ERRO_MEMORIA;
+
+        // Cada operação recebe uma fatia de `duracoes` do tamanho da sua contagem.
+        size_t por_operacao[QUANTIDADE_OPERACOES] = {0};
+        for (size_t i = 0; i < quantidade; i++)
+                if (originais[i].operacao < QUANTIDADE_OPERACOES)
+                        por_operacao[originais[i].operacao]++;
+        uint32_t* livre = duracoes;
+        for (int operacao = 0; operacao < QUANTIDADE_OPERACOES; operacao++) {
+                comparacoes[operacao].original.duracoes = livre;
+                comparacoes[operacao].repetido.duracoes = livre + por_operacao[operacao];
+                livre += 2 * por_operacao[operacao];
+        }
+
+        for (size_t i = 0; i < quantidade; i++) {
+                if (originais[i].operacao >= QUANTIDADE_OPERACOES) continue;
+                COMPARACAO* c = &comparacoes[originais[i].operacao];
+                acumular(&c->original, &originais[i]);
+                acumular(&c->repetido, &repetidos[i]);
+                if (originais[i].status != repetidos[i].status) c->divergentes++;
+        }
+        for (int operacao = 0; operacao < QUANTIDADE_OPERACOES; operacao++) {
+                COMPARACAO* c = &comparacoes[operacao];
+                qsort(c->original.duracoes, c->original.quantidade, sizeof(uint32_t),
+                      comparar_duracoes);
+                qsort(c->repetido.duracoes, c->repetido.quantidade, sizeof(uint32_t),
+                      comparar_duracoes);
+        }
+
+        size_t lentas[MAIS_LENTAS];
+        size_t quantidade_lentas = selecionar_mais_lentas(originais, quantidade, lentas);
+        imprimir_relatorio(saida, json, originais, repetidos, quantidade, comparacoes, lentas,
+                           quantidade_lentas);
+        free(duracoes);
+        return SUCESSO;
+}
+
+/**
+ * @brief Mostra como usar a ferramenta.
+ */
+static void imprimir_uso(const char* programa) {
+        fprintf(stderr,
+                "Uso: %s [-j] [-s SAIDA] RASTRO ARQUIVO_BIN\n"
+                "  -j        relatorio em JSON\n"
+                "  -s SAIDA  guarda o rastro da repeticao em SAIDA\n",
+                programa);
+}
+
+/**
+ * @brief Reproduz o rastro e compara as durações.
+ */
+int main(int argc, char* argv[]) {
+        int json = 0;
+        const char* saida = NULL;
+        const char* caminhos[2] = {NULL, NULL};
+        int posicionais = 0;
+
+        int valido = 1;
+        for (int i = 1; i < argc && valido; i++) {
+                if (strcmp(argv[i], "-j") == 0) {
+                        json = 1;
+                } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+                        saida = argv[++i];
+                } else if (argv[i][0] != '-' && posicionais < 2) {
+                        caminhos[posicionais++] = argv[i];
+                } else {
+                        valido = 0;
+                }
+        }
+        if (!valido || posicionais != 2) {
+                imprimir_uso(argv[0]);
+                return 2;
+        }
+        if (!estatisticas_ativas()) {
+                fprintf(stderr, "Compilado sem ESTATISTICAS: as operacoes nao sao medidas\n");
+                return 1;
+        }
+
+        REGISTRO_RASTRO* originais = NULL;
+        size_t quantidade = 0;
+        int status = ler_rastro(caminhos[0], &originais, &quantidade);
+        if (status != SUCESSO) {
+                fprintf(stderr, "Erro %d ao ler o rastro %s\n", status, caminhos[0]);
+                return 1;
+        }
+        if (quantidade == 0) {
+                fprintf(stderr, "Rastro %s vazio\n", caminhos[0]);
+                free(originais);
+                return 1;
+        }
+
+        char caminho_copia[64], rastro_temporario[64], anexo[80];
+        snprintf(caminho_copia, sizeof(caminho_copia), "/tmp/reproduzir_rastro_%d.bin", getpid());
+        snprintf(rastro_temporario, sizeof(rastro_temporario), "/tmp/reproduzir_rastro_%d.rastro",
+                 getpid());
+        if (saida == NULL) saida = rastro_temporario;
+
+        REGISTRO_RASTRO* repetidos = NULL;
+        size_t quantidade_repetidos = 0;
+        status = copiar_arquivo(caminhos[1], caminho_copia);
+        if (status == SUCESSO)
+                status = reproduzir(originais, quantidade, caminho_copia, saida, &repetidos,
+                                    &quantidade_repetidos);
+        remove(caminho_copia);
+        snprintf(anexo, sizeof(anexo), "%s%s", caminho_copia, SUFIXO_FILTRO);
+        remove(anexo);
+        snprintf(anexo, sizeof(anexo), "%s%s", caminho_copia, SUFIXO_INDICE);
+        remove(anexo);
+        snprintf(anexo, sizeof(anexo), "%s%s", caminho_copia, SUFIXO_MAPA_LIVRE);
+        remove(anexo);
+        remove(rastro_temporario);
+
+        // Cada registro repetido gera exatamente um registro, na mesma ordem.
+        if (status == SUCESSO && quantidade_repetidos != quantidade) status = ERRO_FORMATO_RASTRO;
+        if (status == SUCESSO) status = comparar(stdout, json, originais, repetidos, quantidade);
+        if (status != SUCESSO) fprintf(stderr, "Erro %d ao reproduzir %s\n", status, caminhos[0]);
+
+        free(originais);
+        free(repetidos);
+        return status == SUCESSO ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file varredura_bench.c
+ * @brief Compara as implementações de varredura.h sobre o mesmo arquivo texto.
+ *
+ * Uso:
+ * @code
+ *   varredura_bench [ARQUIVO_TEXTO]
+ * @endcode
+ *
+ * Sem argumento, gera um catálogo sintético temporário de ~64 MB. Para cada implementação
+ * suportada pela CPU, mede a vazão (MB/s) da busca de quebras de linha, da busca de
+ * separadores e da interpretação completa do arquivo (analisar_texto()), sem gravar na árvore.
+ * A implementação escalar é a referência: examina um byte por iteração, como o antigo leitor.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../include/erros.h"
+#include "../include/importacao.h"
+#include "../include/utils.h"
+#include "../include/varredura.h"
+
+/** Repetições de cada medida; vale a melhor. */
+#define REPETICOES 5
+
+/** Linhas do catálogo sintético. */
+#define LINHAS_SINTETICAS 750000
+
+/**
+ * @brief Grava um catálogo sintético com espaços ao redor de alguns campos.
+ *
+ * @return SUCESSO ou ERRO_ARQUIVO_TEXTO.
+ */
+static int gerar_catalogo(const char* caminho) {
+        FILE* arquivo = fopen(caminho, "w");
+        if (arquivo == NULL) return ERRO_ARQUIVO_TEXTO;
+
+        for (size_t i = 1; i <= LINHAS_SINTETICAS; i++) {
+                fprintf(arquivo,
+                        "%zu; Titulo do livro numero %zu ;Autor %zu;  Editora %zu;"
+                        "%zu;%zu;%zu;%zu,%02zu\n",
+                        i, i, i % 977, i % 31, i % 9 + 1, 1900 + i % 120, i % 50, i % 300,
+                        i % 100);
+        }
+
+        return fclose(arquivo) == 0 ? SUCESSO : ERRO_ARQUIVO_TEXTO;
+}
+
+/**
+ * @brief Conta as quebras de linha com buscar_quebra().
+ */
+static size_t contar_quebras(const char* inicio, const char* fim) {
+        size_t total = 0;
+        for (const char* p = inicio; (p = buscar_quebra(p, fim)) != NULL; p++) total++;
+        return total;
+}
+
+/**
+ * @brief Conta os `;` com buscar_separadores(), de 64 em 64.
+ */
+static size_t contar_separadores(const char* inicio, const char* fim) {
+        const char* posicoes[64];
+        size_t total = 0;
+        size_t achados;
+        for (const char* p = inicio; (achados = buscar_separadores(p, fim, posicoes, 64)) > 0;
+             p = posicoes[achados - 1] + 1)
+                total += achados;
+        return total;
+}
+
+/**
+ * @brief Melhor vazão em MB/s de `contar` sobre o texto, em REPETICOES execuções.
+ */
+static double medir(size_t (*contar)(const char*, const char*), const TEXTO_MAPEADO* texto,
+                    size_t* resultado) {
+        double melhor = 0;
+        for (int i = 0; i < REPETICOES; i++) {
+                double inicio = agora();
+                *resultado = contar(texto->dados, texto->dados + texto->tamanho);
+                double segundos = agora() - inicio;
+                if (segundos > 0 && texto->tamanho / 1e6 / segundos > melhor)
+                        melhor = texto->tamanho / 1e6 / segundos;
+        }
+        return melhor;
+}
+
+/**
+ * @brief Melhor vazão em MB/s de analisar_texto() sobre o arquivo.
+ */
+static double medir_analise(const char* caminho) {
+        double melhor = 0;
+        for (int i = 0; i < REPETICOES; i++) {
+                RELATORIO_IMPORTACAO relatorio;
+                if (analisar_texto(caminho, &relatorio) != SUCESSO) return 0;
+                if (relatorio.segundos > 0 && relatorio.bytes / 1e6 / relatorio.segundos > melhor)
+                        melhor = relatorio.bytes / 1e6 / relatorio.segundos;
+        }
+        return melhor;
+}
+
+/**
+ * @brief Ponto de entrada do microbenchmark.
+ */
+int main(int argc, char* argv[]) {
+        char temporario[64] = "";
+        const char* caminho = argc > 1 ? argv[1] : NULL;
+
+        if (caminho == NULL) {
+                snprintf(temporario, sizeof(temporario), "/tmp/varredura_bench_%d.txt", getpid());
+                if (gerar_catalogo(temporario) != SUCESSO) {
+                        fprintf(stderr, "Nao foi possivel gerar %s\n", temporario);
+                        return 1;
+                }
+                caminho = temporario;
+        }
+
+        TEXTO_MAPEADO texto;
+        if (mapear_texto(caminho, &texto) != SUCESSO) {
+                fprintf(stderr, "Nao foi possivel ler %s\n", caminho);
+                if (*temporario) remove(temporario);
+                return 1;
+        }
+
+        IMPLEMENTACAO_VARREDURA padrao = varredura_ativa();
+        printf("arquivo: %s (%zu bytes), padrao: %s\n", caminho, texto.tamanho,
+               nome_varredura(padrao));
+        printf("%-8s %12s %12s %12s\n", "impl", "quebra", "separadores", "analise");
+
+        const IMPLEMENTACAO_VARREDURA implementacoes[] = {VARREDURA_ESCALAR, VARREDURA_SSE2,
+                                                          VARREDURA_AVX2};
+        int falhou = 0;
+        size_t referencia[2] = {0};
+
+        for (size_t i = 0; i < sizeof(implementacoes) / sizeof(implementacoes[0]); i++) {
+                if (!definir_varredura(implementacoes[i])) continue;
+
+                size_t contagem[2];
+                double quebra = medir(contar_quebras, &texto, &contagem[0]);
+                double separadores = medir(contar_separadores, &texto, &contagem[1]);
+                double analise = medir_analise(caminho);
+
+                printf("%-8s %7.0f MB/s %7.0f MB/s %7.0f MB/s\n", nome_varredura(implementacoes[i]),
+                       quebra, separadores, analise);
+
+                // Todas as implementações precisam achar exatamente os mesmos bytes.
+                for (int j = 0; j < 2; j++) {
+                        if (i == 0) referencia[j] = contagem[j];
+                        if (contagem[j] != referencia[j]) falhou = 1;
+                }
+        }
+
+        definir_varredura(padrao);
+        liberar_texto(&texto);
+        if (*temporario) remove(temporario);
+
+        if (falhou) fprintf(stderr, "As implementacoes divergiram nas contagens\n");
+        return falhou;
+}